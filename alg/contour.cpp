@@ -35,12 +35,17 @@
 #include <cstring>
 
 #include <algorithm>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
+#include "gdal_alg_priv.h"
 #include "gdal_priv.h"
 #include "gdal_priv_templates.hpp"
 #include "ogr_api.h"
@@ -58,59 +63,117 @@ constexpr double FUDGE_EXACT = 0.001;
 
 constexpr double JOIN_DIST = 0.0001;
 
+// The size of the cells of the grid on which line ends are hashed.  Two ends
+// within JOIN_DIST of each other are in the same or in adjacent cells.
+
+constexpr double JOIN_CELL = 2 * JOIN_DIST;
+
 /************************************************************************/
-/*                           GDALContourItem                            */
+/*                           GDALContourPath                            */
+/*                                                                      */
+/*      A contour line under construction.  The points added before     */
+/*      the first segment are kept in reverse order in adfHeadX/Y, so   */
+/*      that both ends of the line grow in constant time.               */
 /************************************************************************/
-class GDALContourItem
+class GDALContourPath
 {
 public:
-    bool bRecentlyAccessed;
+    int    iLevel;
     double dfLevel;
 
-    int nPoints;
-    int nMaxPoints;
-    double *padfX;
-    double *padfY;
+    bool   bLeftIsHigh;
+    bool   bClosed;
+    bool   bMerged;
+
+    std::vector<double> adfHeadX;
+    std::vector<double> adfHeadY;
+    std::vector<double> adfTailX;
+    std::vector<double> adfTailY;
+
+    GDALContourPath( int iLevelIn, double dfLevelIn, bool bLeftIsHighIn );
+
+    size_t GetPointCount() const { return adfHeadX.size() + adfTailX.size(); }
+    double GetX( size_t i ) const;
+    double GetY( size_t i ) const;
+    void   AddPoint( bool bTail, double dfX, double dfY );
+    void   Splice( bool bTail, const GDALContourPath *poOther,
+                   bool bFromTail );
+    void   Export( std::vector<double> &adfX,
+                   std::vector<double> &adfY ) const;
+};
 
-    bool bLeftIsHigh;
+/************************************************************************/
+/*                            GDALContourEnd                            */
+/************************************************************************/
+struct GDALContourEnd
+{
+    GDALContourPath *poPath;
+    bool             bTail;
+    double           dfX;
+    double           dfY;
+};
 
-    double dfTailX;
+/************************************************************************/
+/*                            GDALContourKey                            */
+/************************************************************************/
+struct GDALContourKey
+{
+    int     iLevel;
+    GIntBig nX;
+    GIntBig nY;
 
-    explicit GDALContourItem( double dfLevel );
-    ~GDALContourItem();
+    bool operator==( const GDALContourKey &oOther ) const
+    {
+        return iLevel == oOther.iLevel && nX == oOther.nX && nY == oOther.nY;
+    }
+};
 
-    int    AddSegment( double dfXStart, double dfYStart,
-                       double dfXEnd, double dfYEnd, int bLeftHigh );
-    void   MakeRoomFor( int );
-    int    Merge( GDALContourItem * );
-    static double DistanceSqr( double x0, double y0, double x1, double y1 );
-    static int MergeCase( double ax0, double ay0, double ax1, double ay1,
-                          double bx0, double by0, double bx1, double by1);
-    void   PrepareEjection();
+struct GDALContourKeyHash
+{
+    size_t operator()( const GDALContourKey &oKey ) const
+    {
+        return static_cast<size_t>(
+            (static_cast<GUIntBig>(oKey.nX) * 0x9E3779B97F4A7C15ULL) ^
+            (static_cast<GUIntBig>(oKey.nY) * 0xC2B2AE3D27D4EB4FULL) ^
+            static_cast<GUIntBig>(oKey.iLevel));
+    }
 };
 
 /************************************************************************/
-/*                           GDALContourLevel                           */
+/*                          GDALContourPathSet                          */
+/*                                                                      */
+/*      The contour lines that are still open, with their ends hashed   */
+/*      by level and location so that new segments, or lines traced     */
+/*      in a neighbouring strip, are joined without searching.          */
 /************************************************************************/
-class GDALContourLevel
+class GDALContourPathSet
 {
-    double dfLevel;
+    typedef std::unordered_multimap<GDALContourKey, GDALContourEnd,
+                                    GDALContourKeyHash> EndMap;
 
-    int nEntryMax;
-    int nEntryCount;
-    GDALContourItem **papoEntries;
+    EndMap oEnds;
+    std::vector<GDALContourPath *> apoPaths;
+
+    static GDALContourKey GetKey( int iLevel, double dfX, double dfY );
+    bool   FindEnd( int iLevel, double dfX, double dfY,
+                    GDALContourEnd &sEnd ) const;
+    void   RegisterEnd( GDALContourPath *poPath, bool bTail );
+    void   UnregisterEnd( GDALContourPath *poPath, bool bTail );
+    GDALContourPath *Join( GDALContourPath *poPath, bool bTail,
+                           GDALContourPath *poOther, bool bOtherTail );
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALContourPathSet)
 
 public:
-    explicit GDALContourLevel( double );
-    ~GDALContourLevel();
-
-    double GetLevel() const { return dfLevel; }
-    int    GetContourCount() const { return nEntryCount; }
-    GDALContourItem *GetContour( int i) { return papoEntries[i]; }
-    void   AdjustContour( int );
-    void   RemoveContour( int );
-    int    FindContour( double dfX, double dfY );
-    int    InsertContour( GDALContourItem * );
+    GDALContourPathSet() {}
+    ~GDALContourPathSet();
+
+    void   AddSegment( int iLevel, double dfLevel,
+                       double dfXStart, double dfYStart,
+                       double dfXEnd, double dfYEnd, bool bLeftHigh );
+    void   AddPath( GDALContourPath *poPath );
+    void   Flush( double dfSeamY1, double dfSeamY2,
+                  std::vector<GDALContourPath *> &apoDone );
 };
 
 /************************************************************************/
@@ -125,9 +188,9 @@ class GDALContourGenerator
     double *padfLastLine;
     double *padfThisLine;
 
-    int    nLevelMax;
-    int    nLevelCount;
-    GDALContourLevel **papoLevels;
+    GDALContourPathSet oPaths;
+
+    std::vector<double> adfFixedLevels;
 
     bool   bNoDataActive;
     double dfNoDataValue;
@@ -136,24 +199,24 @@ class GDALContourGenerator
     double dfContourInterval;
     double dfContourOffset;
 
-    CPLErr AddSegment( double dfLevel,
-                       double dfXStart, double dfYStart,
-                       double dfXEnd, double dfYEnd, int bLeftHigh );
-
     template<EMULATED_BOOL bNoDataIsNan> inline bool
         IsNoData( double dfVal ) const;
 
-    template<EMULATED_BOOL bNoDataIsNan> CPLErr ProcessPixel( int iPixel );
-    CPLErr ProcessRect( double, double, double,
+    template<EMULATED_BOOL bNoDataIsNan> CPLErr
+        ProcessPixel( GDALContourPathSet &oPathSet,
+                      const double *padfUpLine, const double *padfLoLine,
+                      int iRow, int iPixel ) const;
+    CPLErr ProcessRect( GDALContourPathSet &oPathSet,
+                        double, double, double,
                         double, double, double,
                         double, double, double,
-                        double, double, double );
+                        double, double, double ) const;
 
     static void Intersect( double, double, double,
                            double, double, double,
                            double, double, int *, double *, double * );
 
-    GDALContourLevel *FindLevel( double dfLevel );
+    CPL_DISALLOW_COPY_ASSIGN(GDALContourGenerator)
 
 public:
     GDALContourWriter pfnWriter;
@@ -172,8 +235,13 @@ public:
           dfContourOffset = dfContourOffsetIn; }
 
     void                SetFixedLevels( int, double * );
+    void                PerturbLine( double *padfLine ) const;
+    CPLErr              ProcessLine( GDALContourPathSet &oPathSet,
+                                     const double *padfUpLine,
+                                     const double *padfLoLine,
+                                     int iRow ) const;
+    CPLErr              WritePaths( std::vector<GDALContourPath *> &apoDone );
     CPLErr              FeedLine( double *padfScanline );
-    CPLErr              EjectContours( int bOnlyUnused = FALSE );
 };
 
 template<> inline bool GDALContourGenerator::IsNoData<true>(double dfVal) const
@@ -253,9 +321,6 @@ GDALContourGenerator::GDALContourGenerator( int nWidthIn, int nHeightIn,
     iLine(-1),
     padfLastLine(nullptr),
     padfThisLine(nullptr),
-    nLevelMax(0),
-    nLevelCount(0),
-    papoLevels(nullptr),
     bNoDataActive(false),
     dfNoDataValue(-1000000.0),
     bFixedLevels(false),
@@ -272,10 +337,6 @@ GDALContourGenerator::GDALContourGenerator( int nWidthIn, int nHeightIn,
 GDALContourGenerator::~GDALContourGenerator()
 
 {
-    for( int i = 0; i < nLevelCount; i++ )
-        delete papoLevels[i];
-    CPLFree( papoLevels );
-
     CPLFree( padfLastLine );
     CPLFree( padfThisLine );
 }
@@ -302,8 +363,12 @@ void GDALContourGenerator::SetFixedLevels( int nFixedLevelCount,
 
 {
     bFixedLevels = true;
-    for( int i = 0; i < nFixedLevelCount; i++ )
-        FindLevel( padfFixedLevels[i] );
+    adfFixedLevels.insert( adfFixedLevels.end(), padfFixedLevels,
+                           padfFixedLevels + nFixedLevelCount );
+    std::sort( adfFixedLevels.begin(), adfFixedLevels.end() );
+    adfFixedLevels.erase( std::unique( adfFixedLevels.begin(),
+                                       adfFixedLevels.end() ),
+                          adfFixedLevels.end() );
 }
 
 /************************************************************************/
@@ -319,10 +384,16 @@ void GDALContourGenerator::SetNoData( double dfNewValue )
 
 /************************************************************************/
 /*                            ProcessPixel()                            */
+/*                                                                      */
+/*      Process the rectangle whose corners are the centers of pixels   */
+/*      iPixel-1 and iPixel of the lines above and below row iRow.      */
 /************************************************************************/
 
 template<EMULATED_BOOL bNoDataIsNan> CPLErr
-GDALContourGenerator::ProcessPixel( int iPixel )
+GDALContourGenerator::ProcessPixel( GDALContourPathSet &oPathSet,
+                                    const double *padfUpLine,
+                                    const double *padfLoLine,
+                                    int iRow, int iPixel ) const
 
 {
     bool bSubdivide = false;
@@ -332,11 +403,11 @@ GDALContourGenerator::ProcessPixel( int iPixel )
 /*      of the scanline are taken from the nearest pixel on the         */
 /*      scanline itself.                                                */
 /* -------------------------------------------------------------------- */
-    const double dfUpLeft = padfLastLine[std::max(0, iPixel-1)];
-    const double dfUpRight = padfLastLine[std::min(nWidth - 1, iPixel)];
+    const double dfUpLeft = padfUpLine[std::max(0, iPixel-1)];
+    const double dfUpRight = padfUpLine[std::min(nWidth - 1, iPixel)];
 
-    const double dfLoLeft = padfThisLine[std::max(0, iPixel - 1)];
-    const double dfLoRight = padfThisLine[std::min(nWidth - 1, iPixel)];
+    const double dfLoLeft = padfLoLine[std::max(0, iPixel - 1)];
+    const double dfLoRight = padfLoLine[std::min(nWidth - 1, iPixel)];
 
 /* -------------------------------------------------------------------- */
 /*      Check if we have any nodata values.                             */
@@ -355,12 +426,13 @@ GDALContourGenerator::ProcessPixel( int iPixel )
 /*      code.                                                           */
 /* -------------------------------------------------------------------- */
     if( iPixel > 0 && iPixel < nWidth
-        && iLine > 0 && iLine < nHeight && !bSubdivide )
+        && iRow > 0 && iRow < nHeight && !bSubdivide )
     {
-        return ProcessRect( dfUpLeft, iPixel - 0.5, iLine - 0.5,
-                            dfLoLeft, iPixel - 0.5, iLine + 0.5,
-                            dfLoRight, iPixel + 0.5, iLine + 0.5,
-                            dfUpRight, iPixel + 0.5, iLine - 0.5 );
+        return ProcessRect( oPathSet,
+                            dfUpLeft, iPixel - 0.5, iRow - 0.5,
+                            dfLoLeft, iPixel - 0.5, iRow + 0.5,
+                            dfLoRight, iPixel + 0.5, iRow + 0.5,
+                            dfUpRight, iPixel + 0.5, iRow - 0.5 );
     }
 
 /* -------------------------------------------------------------------- */
@@ -444,38 +516,43 @@ GDALContourGenerator::ProcessPixel( int iPixel )
 /* -------------------------------------------------------------------- */
     CPLErr eErr = CE_None;
 
-    if( !IsNoData<bNoDataIsNan>(dfUpLeft) && iPixel > 0 && iLine > 0 )
+    if( !IsNoData<bNoDataIsNan>(dfUpLeft) && iPixel > 0 && iRow > 0 )
     {
-        eErr = ProcessRect( dfUpLeft, iPixel - 0.5, iLine - 0.5,
-                            dfLeft, iPixel - 0.5, iLine,
-                            dfCenter, iPixel, iLine,
-                            dfTop, iPixel, iLine - 0.5 );
+        eErr = ProcessRect( oPathSet,
+                            dfUpLeft, iPixel - 0.5, iRow - 0.5,
+                            dfLeft, iPixel - 0.5, iRow,
+                            dfCenter, iPixel, iRow,
+                            dfTop, iPixel, iRow - 0.5 );
     }
 
     if( !IsNoData<bNoDataIsNan>(dfLoLeft) && eErr == CE_None
-        && iPixel > 0 && iLine < nHeight )
+        && iPixel > 0 && iRow < nHeight )
     {
-        eErr = ProcessRect( dfLeft, iPixel - 0.5, iLine,
-                            dfLoLeft, iPixel - 0.5, iLine + 0.5,
-                            dfBottom, iPixel, iLine + 0.5,
-                            dfCenter, iPixel, iLine );
+        eErr = ProcessRect( oPathSet,
+                            dfLeft, iPixel - 0.5, iRow,
+                            dfLoLeft, iPixel - 0.5, iRow + 0.5,
+                            dfBottom, iPixel, iRow + 0.5,
+                            dfCenter, iPixel, iRow );
     }
 
-    if( !IsNoData<bNoDataIsNan>(dfLoRight) &&
-        iPixel < nWidth && iLine < nHeight )
+    if( !IsNoData<bNoDataIsNan>(dfLoRight) && eErr == CE_None
+        && iPixel < nWidth && iRow < nHeight )
     {
-        eErr = ProcessRect( dfCenter, iPixel, iLine,
-                            dfBottom, iPixel, iLine + 0.5,
-                            dfLoRight, iPixel + 0.5, iLine + 0.5,
-                            dfRight, iPixel + 0.5, iLine );
+        eErr = ProcessRect( oPathSet,
+                            dfCenter, iPixel, iRow,
+                            dfBottom, iPixel, iRow + 0.5,
+                            dfLoRight, iPixel + 0.5, iRow + 0.5,
+                            dfRight, iPixel + 0.5, iRow );
     }
 
-    if( !IsNoData<bNoDataIsNan>(dfUpRight) && iPixel < nWidth && iLine > 0 )
+    if( !IsNoData<bNoDataIsNan>(dfUpRight) && eErr == CE_None
+        && iPixel < nWidth && iRow > 0 )
     {
-        eErr = ProcessRect( dfTop, iPixel, iLine - 0.5,
-                            dfCenter, iPixel, iLine,
-                            dfRight, iPixel + 0.5, iLine,
-                            dfUpRight, iPixel + 0.5, iLine - 0.5 );
+        eErr = ProcessRect( oPathSet,
+                            dfTop, iPixel, iRow - 0.5,
+                            dfCenter, iPixel, iRow,
+                            dfRight, iPixel + 0.5, iRow,
+                            dfUpRight, iPixel + 0.5, iRow - 0.5 );
     }
 
     return eErr;
@@ -486,10 +563,11 @@ GDALContourGenerator::ProcessPixel( int iPixel )
 /************************************************************************/
 
 CPLErr GDALContourGenerator::ProcessRect(
+    GDALContourPathSet &oPathSet,
     double dfUpLeft, double dfUpLeftX, double dfUpLeftY,
     double dfLoLeft, double dfLoLeftX, double dfLoLeftY,
     double dfLoRight, double dfLoRightX, double dfLoRightY,
-    double dfUpRight, double dfUpRightX, double dfUpRightY )
+    double dfUpRight, double dfUpRightX, double dfUpRightY ) const
 
 {
 /* -------------------------------------------------------------------- */
@@ -510,40 +588,19 @@ CPLErr GDALContourGenerator::ProcessRect(
     // If we are using fixed levels, then find the min/max in the levels table.
     if( bFixedLevels )
     {
-        int nStart = 0;
-        int nEnd = nLevelCount-1;
+        const int nLevelCount = static_cast<int>(adfFixedLevels.size());
 
-        iStartLevel = -1;
-        while( nStart <= nEnd )
-        {
-            const int nMiddle = (nEnd + nStart) / 2;
-
-            const double dfMiddleLevel = papoLevels[nMiddle]->GetLevel();
+        iStartLevel = static_cast<int>(
+            std::lower_bound(adfFixedLevels.begin(), adfFixedLevels.end(),
+                             dfMin) - adfFixedLevels.begin());
 
-            if( dfMiddleLevel < dfMin )
-                nStart = nMiddle + 1;
-            else if( dfMiddleLevel > dfMin )
-                nEnd = nMiddle - 1;
-            else
-            {
-                iStartLevel = nMiddle;
-                break;
-            }
-        }
-
-        if( iStartLevel == -1 )
-            iStartLevel = nEnd + 1;
+        if( iStartLevel >= nLevelCount )
+            return CE_None;
 
         iEndLevel = iStartLevel;
         while( iEndLevel < nLevelCount-1
-               && papoLevels[iEndLevel+1]->GetLevel() < dfMax )
+               && adfFixedLevels[iEndLevel+1] < dfMax )
             iEndLevel++;
-
-        if( iStartLevel >= nLevelCount )
-            return CE_None;
-
-        CPLAssert( iStartLevel >= 0 && iStartLevel < nLevelCount );
-        CPLAssert( iEndLevel >= 0 && iEndLevel < nLevelCount );
     }
     // Otherwise figure out the start and end using the base and offset.
     else
@@ -561,7 +618,7 @@ CPLErr GDALContourGenerator::ProcessRect(
             return CE_Failure;
         }
         iStartLevel = static_cast<int>(dfStartLevel);
-        iEndLevel = static_cast<int>(dfStartLevel);
+        iEndLevel = static_cast<int>(dfEndLevel);
     }
 
     if( iStartLevel > iEndLevel )
@@ -574,7 +631,7 @@ CPLErr GDALContourGenerator::ProcessRect(
     {
         const double dfLevel =
             bFixedLevels
-            ? papoLevels[iLevel]->GetLevel()
+            ? adfFixedLevels[iLevel]
             : iLevel * dfContourInterval + dfContourOffset;
 
         int nPoints = 0;
@@ -602,58 +659,53 @@ CPLErr GDALContourGenerator::ProcessRect(
         if( nPoints == 1 || nPoints == 3 )
             CPLDebug( "CONTOUR", "Got nPoints = %d", nPoints );
 
-        CPLErr eErr = CE_None;
-
         if( nPoints >= 2 )
         {
             if( nPoints1 == 1 && nPoints2 == 2 ) // left + bottom
             {
-                eErr = AddSegment( dfLevel,
-                                   adfX[0], adfY[0], adfX[1], adfY[1],
-                                   dfUpRight > dfLoLeft );
+                oPathSet.AddSegment( iLevel, dfLevel,
+                                     adfX[0], adfY[0], adfX[1], adfY[1],
+                                     dfUpRight > dfLoLeft );
             }
             else if( nPoints1 == 1 && nPoints3 == 2 ) // left + right
             {
-                eErr = AddSegment( dfLevel,
-                                   adfX[0], adfY[0], adfX[1], adfY[1],
-                                   dfUpLeft > dfLoRight );
+                oPathSet.AddSegment( iLevel, dfLevel,
+                                     adfX[0], adfY[0], adfX[1], adfY[1],
+                                     dfUpLeft > dfLoRight );
             }
             else if( nPoints1 == 1 && nPoints == 2 ) // left + top
             {
                 // Do not do vertical contours on the left, due to symmetry.
                 if( !(dfUpLeft == dfLevel && dfLoLeft == dfLevel) )
-                    eErr = AddSegment( dfLevel,
-                                       adfX[0], adfY[0], adfX[1], adfY[1],
-                                       dfUpLeft > dfLoRight );
+                    oPathSet.AddSegment( iLevel, dfLevel,
+                                         adfX[0], adfY[0], adfX[1], adfY[1],
+                                         dfUpLeft > dfLoRight );
             }
             else if( nPoints2 == 1 && nPoints3 == 2 ) // bottom + right
             {
-                eErr = AddSegment( dfLevel,
-                                   adfX[0], adfY[0], adfX[1], adfY[1],
-                                   dfUpLeft > dfLoRight );
+                oPathSet.AddSegment( iLevel, dfLevel,
+                                     adfX[0], adfY[0], adfX[1], adfY[1],
+                                     dfUpLeft > dfLoRight );
             }
             else if( nPoints2 == 1 && nPoints == 2 ) // bottom + top
             {
-                eErr = AddSegment( dfLevel,
-                                   adfX[0], adfY[0], adfX[1], adfY[1],
-                                   dfLoLeft > dfUpRight );
+                oPathSet.AddSegment( iLevel, dfLevel,
+                                     adfX[0], adfY[0], adfX[1], adfY[1],
+                                     dfLoLeft > dfUpRight );
             }
             else if( nPoints3 == 1 && nPoints == 2 ) // right + top
             {
                 // Do not do horizontal contours on upside, due to symmetry.
                 if( !(dfUpRight == dfLevel && dfUpLeft == dfLevel) )
-                    eErr = AddSegment( dfLevel,
-                                       adfX[0], adfY[0], adfX[1], adfY[1],
-                                       dfLoLeft > dfUpRight );
+                    oPathSet.AddSegment( iLevel, dfLevel,
+                                         adfX[0], adfY[0], adfX[1], adfY[1],
+                                         dfLoLeft > dfUpRight );
             }
             else
             {
                 // If we get here it is a serious error!
                 CPLDebug( "CONTOUR", "Contour state not implemented!");
             }
-
-            if( eErr != CE_None )
-                 return eErr;
         }
 
         if( nPoints == 4 )
@@ -668,11 +720,9 @@ CPLErr GDALContourGenerator::ProcessRect(
 /*          We do not do a diagonal check here as we are dealing with   */
 /*          a saddle point.                                             */
 /* -------------------------------------------------------------------- */
-            eErr = AddSegment( dfLevel,
-                               adfX[2], adfY[2], adfX[3], adfY[3],
-                               ( dfLoRight > dfUpRight) );
-            if( eErr != CE_None )
-                return eErr;
+            oPathSet.AddSegment( iLevel, dfLevel,
+                                 adfX[2], adfY[2], adfX[3], adfY[3],
+                                 dfLoRight > dfUpRight );
           }
         }
     }
@@ -716,50 +766,89 @@ void GDALContourGenerator::Intersect( double dfVal1, double dfX1, double dfY1,
 }
 
 /************************************************************************/
-/*                             AddSegment()                             */
+/*                            PerturbLine()                             */
+/*                                                                      */
+/*      Perturb any values that occur exactly on level boundaries.      */
 /************************************************************************/
 
-CPLErr GDALContourGenerator::AddSegment( double dfLevel,
-                                         double dfX1, double dfY1,
-                                         double dfX2, double dfY2,
-                                         int bLeftHigh)
+void GDALContourGenerator::PerturbLine( double *padfLine ) const
 
 {
-    GDALContourLevel *poLevel = FindLevel( dfLevel );
-    GDALContourItem *poTarget = nullptr;
-
-/* -------------------------------------------------------------------- */
-/*      Check all active contours for any that this might attach        */
-/*      to. Eventually this should be recoded to find the contours      */
-/*      of the correct level more efficiently.                          */
-/* -------------------------------------------------------------------- */
+    for( int iPixel = 0; iPixel < nWidth; iPixel++ )
+    {
+        if( bNoDataActive && padfLine[iPixel] == dfNoDataValue )
+            continue;
 
-    const int iTarget =
-        dfY1 < dfY2
-        ? poLevel->FindContour(dfX1, dfY1)
-        : poLevel->FindContour(dfX2, dfY2);
+        const double dfLevel =
+            (padfLine[iPixel] - dfContourOffset) / dfContourInterval;
 
-    if( iTarget != -1 )
-    {
-        poTarget = poLevel->GetContour( iTarget );
+        if( dfLevel - static_cast<int>(dfLevel) == 0.0 )
+        {
+            padfLine[iPixel] += dfContourInterval * FUDGE_EXACT;
+        }
+    }
+}
 
-        poTarget->AddSegment( dfX1, dfY1, dfX2, dfY2, bLeftHigh );
+/************************************************************************/
+/*                            ProcessLine()                             */
+/*                                                                      */
+/*      Add the segments of the row of rectangles between two           */
+/*      (perturbed) lines.  Row iRow lies between lines iRow-1 and      */
+/*      iRow, rows 0 and nHeight being the half pixel borders of the    */
+/*      raster.  This only reads the generator settings, so several     */
+/*      rows can be processed at once into different path sets.         */
+/************************************************************************/
 
-        poLevel->AdjustContour( iTarget );
+CPLErr GDALContourGenerator::ProcessLine( GDALContourPathSet &oPathSet,
+                                          const double *padfUpLine,
+                                          const double *padfLoLine,
+                                          int iRow ) const
 
-        return CE_None;
+{
+    const bool bNoDataIsNan = CPL_TO_BOOL(CPLIsNan(dfNoDataValue));
+    for( int iPixel = 0; iPixel < nWidth + 1; iPixel++ )
+    {
+        const CPLErr eErr =
+            bNoDataIsNan
+            ? ProcessPixel<true>( oPathSet, padfUpLine, padfLoLine,
+                                  iRow, iPixel )
+            : ProcessPixel<false>( oPathSet, padfUpLine, padfLoLine,
+                                   iRow, iPixel );
+        if( eErr != CE_None )
+            return eErr;
     }
 
-/* -------------------------------------------------------------------- */
-/*      No existing contour found, lets create a new one.               */
-/* -------------------------------------------------------------------- */
-    poTarget = new GDALContourItem( dfLevel );
+    return CE_None;
+}
 
-    poTarget->AddSegment( dfX1, dfY1, dfX2, dfY2, bLeftHigh );
+/************************************************************************/
+/*                             WritePaths()                             */
+/*                                                                      */
+/*      Pass completed contours to the writer, and destroy them.        */
+/************************************************************************/
 
-    poLevel->InsertContour( poTarget );
+CPLErr GDALContourGenerator::WritePaths(
+    std::vector<GDALContourPath *> &apoDone )
 
-    return CE_None;
+{
+    CPLErr eErr = CE_None;
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+
+    for( size_t i = 0; i < apoDone.size(); i++ )
+    {
+        if( eErr == CE_None && pfnWriter != nullptr )
+        {
+            apoDone[i]->Export( adfX, adfY );
+            eErr = pfnWriter( apoDone[i]->dfLevel,
+                              static_cast<int>(adfX.size()),
+                              &adfX[0], &adfY[0], pWriterCBData );
+        }
+        delete apoDone[i];
+    }
+    apoDone.clear();
+
+    return eErr;
 }
 
 /************************************************************************/
@@ -790,24 +879,7 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
         memcpy( padfThisLine, padfScanline, sizeof(double) * nWidth );
     }
 
-/* -------------------------------------------------------------------- */
-/*      Perturb any values that occur exactly on level boundaries.      */
-/* -------------------------------------------------------------------- */
-    int iPixel = 0;  // Used after for.
-
-    for( ; iPixel < nWidth; iPixel++ )
-    {
-        if( bNoDataActive && padfThisLine[iPixel] == dfNoDataValue )
-            continue;
-
-        const double dfLevel =
-            (padfThisLine[iPixel] - dfContourOffset) / dfContourInterval;
-
-        if( dfLevel - static_cast<int>(dfLevel) == 0.0 )
-        {
-            padfThisLine[iPixel] += dfContourInterval * FUDGE_EXACT;
-        }
-    }
+    PerturbLine( padfThisLine );
 
 /* -------------------------------------------------------------------- */
 /*      If this is the first line we need to initialize the previous    */
@@ -820,36 +892,21 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
     }
 
 /* -------------------------------------------------------------------- */
-/*      Clear the recently used flags on the contours so we can         */
-/*      check later which ones were touched for this scanline.          */
+/*      Process each pixel, then write out the contours that do not     */
+/*      reach the bottom of this row, as nothing can be added to them   */
+/*      anymore.                                                        */
 /* -------------------------------------------------------------------- */
-    for( int iLevel = 0; iLevel < nLevelCount; iLevel++ )
-    {
-        GDALContourLevel *poLevel = papoLevels[iLevel];
-
-        for( int iContour = 0;
-             iContour < poLevel->GetContourCount();
-             iContour++ )
-            poLevel->GetContour( iContour )->bRecentlyAccessed = false;
-    }
+    CPLErr eErr = ProcessLine( oPaths, padfLastLine, padfThisLine, iLine );
 
-/* -------------------------------------------------------------------- */
-/*      Process each pixel.                                             */
-/* -------------------------------------------------------------------- */
-    const bool bNoDataIsNan = CPL_TO_BOOL(CPLIsNan(dfNoDataValue));
-    for( iPixel = 0; iPixel < nWidth + 1; iPixel++ )
+    if( eErr == CE_None )
     {
-        const CPLErr eErr = bNoDataIsNan ? ProcessPixel<true>( iPixel ) :
-                                           ProcessPixel<false>( iPixel );
-        if( eErr != CE_None )
-            return eErr;
+        const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+        std::vector<GDALContourPath *> apoDone;
+        oPaths.Flush( padfScanline != nullptr ? iLine + 0.5 : dfNaN, dfNaN,
+                      apoDone );
+        eErr = WritePaths( apoDone );
     }
 
-/* -------------------------------------------------------------------- */
-/*      eject any pending contours.                                     */
-/* -------------------------------------------------------------------- */
-    CPLErr eErr = EjectContours( padfScanline != nullptr );
-
     iLine++;
 
     if( iLine == nHeight && eErr == CE_None )
@@ -859,598 +916,455 @@ CPLErr GDALContourGenerator::FeedLine( double *padfScanline )
 }
 
 /************************************************************************/
-/*                           EjectContours()                            */
+/* ==================================================================== */
+/*                          GDALContourPathSet                          */
+/* ==================================================================== */
+/************************************************************************/
+
+/************************************************************************/
+/*                        ~GDALContourPathSet()                         */
 /************************************************************************/
 
-CPLErr GDALContourGenerator::EjectContours( int bOnlyUnused )
+GDALContourPathSet::~GDALContourPathSet()
 
 {
-    CPLErr eErr = CE_None;
+    for( size_t i = 0; i < apoPaths.size(); i++ )
+        delete apoPaths[i];
+}
 
-/* -------------------------------------------------------------------- */
-/*      Process all contours of all levels that match our criteria      */
-/* -------------------------------------------------------------------- */
-    for( int iLevel = 0; iLevel < nLevelCount && eErr == CE_None; iLevel++ )
-    {
-        GDALContourLevel *poLevel = papoLevels[iLevel];
+/************************************************************************/
+/*                               GetKey()                               */
+/************************************************************************/
 
-        for( int iContour = 0;
-             iContour < poLevel->GetContourCount() && eErr == CE_None;
-             /* increment in loop if we don't consume it. */ )
-        {
-            GDALContourItem *poTarget = poLevel->GetContour( iContour );
+GDALContourKey GDALContourPathSet::GetKey( int iLevel,
+                                           double dfX, double dfY )
 
-            if( bOnlyUnused && poTarget->bRecentlyAccessed )
-            {
-                iContour++;
-                continue;
-            }
+{
+    GDALContourKey oKey;
+    oKey.iLevel = iLevel;
+    oKey.nX = static_cast<GIntBig>(floor(dfX / JOIN_CELL));
+    oKey.nY = static_cast<GIntBig>(floor(dfY / JOIN_CELL));
+    return oKey;
+}
 
-            poLevel->RemoveContour( iContour );
+/************************************************************************/
+/*                              FindEnd()                               */
+/*                                                                      */
+/*      Find the end of an open contour of the level within JOIN_DIST   */
+/*      of the passed location.  Only the cell of the location, and     */
+/*      the neighbouring cells on the side of the location, can         */
+/*      contain it.                                                     */
+/************************************************************************/
 
-            // Try to find another contour we can merge with in this level.
+bool GDALContourPathSet::FindEnd( int iLevel, double dfX, double dfY,
+                                  GDALContourEnd &sEnd ) const
 
-            int iC2 = 0;  // Used after for.
-            for( ; iC2 < poLevel->GetContourCount(); iC2++ )
-            {
-                GDALContourItem *poOther = poLevel->GetContour( iC2 );
+{
+    if( oEnds.empty() )
+        return false;
 
-                if( poOther->Merge( poTarget ) )
-                    break;
-            }
+    const GDALContourKey oKey = GetKey( iLevel, dfX, dfY );
+    const GIntBig nOtherX =
+        dfX / JOIN_CELL - oKey.nX < 0.5 ? oKey.nX - 1 : oKey.nX + 1;
+    const GIntBig nOtherY =
+        dfY / JOIN_CELL - oKey.nY < 0.5 ? oKey.nY - 1 : oKey.nY + 1;
 
-            // If we didn't merge it, then eject (write) it out.
-            if( iC2 == poLevel->GetContourCount() )
+    for( int iCell = 0; iCell < 4; iCell++ )
+    {
+        GDALContourKey oCellKey = oKey;
+        if( iCell & 1 )
+            oCellKey.nX = nOtherX;
+        if( iCell & 2 )
+            oCellKey.nY = nOtherY;
+
+        const auto oRange = oEnds.equal_range( oCellKey );
+        for( auto oIter = oRange.first; oIter != oRange.second; ++oIter )
+        {
+            if( fabs(oIter->second.dfX - dfX) < JOIN_DIST &&
+                fabs(oIter->second.dfY - dfY) < JOIN_DIST )
             {
-                if( pfnWriter != nullptr )
-                {
-                    // If direction is wrong, then reverse before ejecting.
-                    poTarget->PrepareEjection();
-
-                    eErr = pfnWriter( poTarget->dfLevel, poTarget->nPoints,
-                                      poTarget->padfX, poTarget->padfY,
-                                      pWriterCBData );
-                }
+                sEnd = oIter->second;
+                return true;
             }
-
-            delete poTarget;
         }
     }
 
-    return eErr;
+    return false;
 }
 
 /************************************************************************/
-/*                             FindLevel()                              */
+/*                            RegisterEnd()                             */
 /************************************************************************/
 
-GDALContourLevel *GDALContourGenerator::FindLevel( double dfLevel )
+void GDALContourPathSet::RegisterEnd( GDALContourPath *poPath, bool bTail )
 
 {
-    int nStart = 0;
-    int nEnd = nLevelCount - 1;
+    const size_t i = bTail ? poPath->GetPointCount() - 1 : 0;
 
-/* -------------------------------------------------------------------- */
-/*      Binary search to find the requested level.                      */
-/* -------------------------------------------------------------------- */
-    while( nStart <= nEnd )
-    {
-        const int nMiddle = (nEnd + nStart) / 2;
+    GDALContourEnd sEnd;
+    sEnd.poPath = poPath;
+    sEnd.bTail = bTail;
+    sEnd.dfX = poPath->GetX(i);
+    sEnd.dfY = poPath->GetY(i);
 
-        const double dfMiddleLevel = papoLevels[nMiddle]->GetLevel();
+    oEnds.insert(
+        std::make_pair(GetKey(poPath->iLevel, sEnd.dfX, sEnd.dfY), sEnd) );
+}
 
-        if( dfMiddleLevel < dfLevel )
-            nStart = nMiddle + 1;
-        else if( dfMiddleLevel > dfLevel )
-            nEnd = nMiddle - 1;
-        else
-            return papoLevels[nMiddle];
-    }
+/************************************************************************/
+/*                           UnregisterEnd()                            */
+/*                                                                      */
+/*      Must be called before the end of the path is modified.          */
+/************************************************************************/
 
-/* -------------------------------------------------------------------- */
-/*      Didn't find the level, create a new one and insert it in        */
-/*      order.                                                          */
-/* -------------------------------------------------------------------- */
-    GDALContourLevel *poLevel = new GDALContourLevel( dfLevel );
+void GDALContourPathSet::UnregisterEnd( GDALContourPath *poPath, bool bTail )
+
+{
+    const size_t i = bTail ? poPath->GetPointCount() - 1 : 0;
+    const auto oRange = oEnds.equal_range(
+        GetKey(poPath->iLevel, poPath->GetX(i), poPath->GetY(i)) );
 
-    if( nLevelMax == nLevelCount )
+    for( auto oIter = oRange.first; oIter != oRange.second; ++oIter )
     {
-        nLevelMax = nLevelMax * 2 + 10;
-        papoLevels = static_cast<GDALContourLevel **>(
-            CPLRealloc(papoLevels, sizeof(void*) * nLevelMax));
+        if( oIter->second.poPath == poPath && oIter->second.bTail == bTail )
+        {
+            oEnds.erase( oIter );
+            return;
+        }
     }
 
-    if( nLevelCount - nEnd - 1 > 0 )
-        memmove( papoLevels + nEnd + 2, papoLevels + nEnd + 1,
-                 (nLevelCount - nEnd - 1) * sizeof(void*) );
-    papoLevels[nEnd+1] = poLevel;
-    nLevelCount++;
-
-    return poLevel;
+    CPLAssert( false );
 }
 
 /************************************************************************/
-/* ==================================================================== */
-/*                           GDALContourLevel                           */
-/* ==================================================================== */
+/*                                Join()                                */
+/*                                                                      */
+/*      Join two paths by ends at the same location, which have         */
+/*      already been unregistered.  The shorter path is appended to     */
+/*      the longer one, which is returned.                              */
 /************************************************************************/
 
-/************************************************************************/
-/*                          GDALContourLevel()                          */
-/************************************************************************/
+GDALContourPath *GDALContourPathSet::Join( GDALContourPath *poPath,
+                                           bool bTail,
+                                           GDALContourPath *poOther,
+                                           bool bOtherTail )
 
-GDALContourLevel::GDALContourLevel( double dfLevelIn ) :
-    dfLevel(dfLevelIn),
-    nEntryMax(0),
-    nEntryCount(0),
-    papoEntries(nullptr)
-{}
+{
+    if( poPath->GetPointCount() < poOther->GetPointCount() )
+    {
+        std::swap( poPath, poOther );
+        std::swap( bTail, bOtherTail );
+    }
 
-/************************************************************************/
-/*                         ~GDALContourLevel()                          */
-/************************************************************************/
+    UnregisterEnd( poOther, !bOtherTail );
+    poPath->Splice( bTail, poOther, bOtherTail );
+    RegisterEnd( poPath, bTail );
 
-GDALContourLevel::~GDALContourLevel()
+    poOther->bMerged = true;
+    std::vector<double>().swap( poOther->adfHeadX );
+    std::vector<double>().swap( poOther->adfHeadY );
+    std::vector<double>().swap( poOther->adfTailX );
+    std::vector<double>().swap( poOther->adfTailY );
 
-{
-    CPLAssert( nEntryCount == 0 );
-    CPLFree( papoEntries );
+    return poPath;
 }
 
 /************************************************************************/
-/*                           AdjustContour()                            */
-/*                                                                      */
-/*      Assume the indicated contour's tail may have changed, and       */
-/*      adjust it up or down in the list of contours to re-establish    */
-/*      proper ordering.                                                */
+/*                             AddSegment()                             */
 /************************************************************************/
 
-void GDALContourLevel::AdjustContour( int iChanged )
+void GDALContourPathSet::AddSegment( int iLevel, double dfLevel,
+                                     double dfXStart, double dfYStart,
+                                     double dfXEnd, double dfYEnd,
+                                     bool bLeftHigh )
 
 {
-    while( iChanged > 0
-         && papoEntries[iChanged]->dfTailX < papoEntries[iChanged-1]->dfTailX )
+    // Segments degenerated to a point, for instance at the corner of a
+    // nodata area, do not contribute anything.
+    if( dfXStart == dfXEnd && dfYStart == dfYEnd )
+        return;
+
+    GDALContourEnd sStart;
+    GDALContourEnd sEnd;
+    const bool bStartFound = FindEnd( iLevel, dfXStart, dfYStart, sStart );
+    bool bEndFound = FindEnd( iLevel, dfXEnd, dfYEnd, sEnd );
+
+/* -------------------------------------------------------------------- */
+/*      The segment closes a ring.                                      */
+/* -------------------------------------------------------------------- */
+    if( bStartFound && bEndFound && sStart.poPath == sEnd.poPath )
     {
-        GDALContourItem *poTemp = papoEntries[iChanged];
-        papoEntries[iChanged] = papoEntries[iChanged-1];
-        papoEntries[iChanged-1] = poTemp;
-        iChanged--;
+        if( sStart.bTail == sEnd.bTail )
+        {
+            bEndFound = false;
+        }
+        else
+        {
+            GDALContourPath *poPath = sStart.poPath;
+            UnregisterEnd( poPath, false );
+            UnregisterEnd( poPath, true );
+            poPath->AddPoint( sStart.bTail, dfXEnd, dfYEnd );
+            poPath->bClosed = true;
+            return;
+        }
     }
 
-    while( iChanged < nEntryCount-1
-         && papoEntries[iChanged]->dfTailX > papoEntries[iChanged+1]->dfTailX )
+/* -------------------------------------------------------------------- */
+/*      Extend the paths ending at the segment ends, and join them if   */
+/*      both ends match.                                                */
+/* -------------------------------------------------------------------- */
+    if( bStartFound )
+    {
+        UnregisterEnd( sStart.poPath, sStart.bTail );
+        sStart.poPath->AddPoint( sStart.bTail, dfXEnd, dfYEnd );
+        if( bEndFound )
+        {
+            UnregisterEnd( sEnd.poPath, sEnd.bTail );
+            Join( sStart.poPath, sStart.bTail, sEnd.poPath, sEnd.bTail );
+        }
+        else
+        {
+            RegisterEnd( sStart.poPath, sStart.bTail );
+        }
+    }
+    else if( bEndFound )
     {
-        GDALContourItem *poTemp = papoEntries[iChanged];
-        papoEntries[iChanged] = papoEntries[iChanged+1];
-        papoEntries[iChanged+1] = poTemp;
-        iChanged++;
+        UnregisterEnd( sEnd.poPath, sEnd.bTail );
+        sEnd.poPath->AddPoint( sEnd.bTail, dfXStart, dfYStart );
+        RegisterEnd( sEnd.poPath, sEnd.bTail );
     }
-}
-
-/************************************************************************/
-/*                           RemoveContour()                            */
-/************************************************************************/
 
-void GDALContourLevel::RemoveContour( int iTarget )
-
-{
-    if( iTarget < nEntryCount )
-        memmove( papoEntries + iTarget, papoEntries + iTarget + 1,
-                 (nEntryCount - iTarget - 1) * sizeof(void*) );
-    nEntryCount--;
+/* -------------------------------------------------------------------- */
+/*      No existing contour found, lets create a new one.               */
+/* -------------------------------------------------------------------- */
+    else
+    {
+        GDALContourPath *poPath =
+            new GDALContourPath( iLevel, dfLevel, bLeftHigh );
+        poPath->AddPoint( true, dfXStart, dfYStart );
+        poPath->AddPoint( true, dfXEnd, dfYEnd );
+        RegisterEnd( poPath, false );
+        RegisterEnd( poPath, true );
+        apoPaths.push_back( poPath );
+    }
 }
 
 /************************************************************************/
-/*                            FindContour()                             */
+/*                              AddPath()                               */
 /*                                                                      */
-/*      Perform a binary search to find the requested "tail"            */
-/*      location.  If not available return -1.  In theory there can     */
-/*      be more than one contour with the same tail X and different     */
-/*      Y tails ... ensure we check against them all.                   */
+/*      Add an open path traced by another path set, joining it to      */
+/*      the paths ending at its ends.  Takes ownership of the path.     */
 /************************************************************************/
 
-int GDALContourLevel::FindContour( double dfX, double dfY )
+void GDALContourPathSet::AddPath( GDALContourPath *poPath )
 
 {
-    int nStart = 0;
-    int nEnd = nEntryCount - 1;
-
-    while( nEnd >= nStart )
-    {
-        int nMiddle = (nEnd + nStart) / 2;
+    apoPaths.push_back( poPath );
 
-        const double dfMiddleX = papoEntries[nMiddle]->dfTailX;
+    const size_t nLast = poPath->GetPointCount() - 1;
+    GDALContourEnd sHead;
+    GDALContourEnd sTail;
+    const bool bHeadFound = FindEnd( poPath->iLevel, poPath->GetX(0),
+                                     poPath->GetY(0), sHead );
+    bool bTailFound = FindEnd( poPath->iLevel, poPath->GetX(nLast),
+                               poPath->GetY(nLast), sTail );
 
-        if( dfMiddleX < dfX )
-            nStart = nMiddle + 1;
-        else if( dfMiddleX > dfX )
-            nEnd = nMiddle - 1;
+/* -------------------------------------------------------------------- */
+/*      The path closes a ring with a single other path.                */
+/* -------------------------------------------------------------------- */
+    if( bHeadFound && bTailFound && sHead.poPath == sTail.poPath )
+    {
+        if( sHead.bTail == sTail.bTail )
+        {
+            bTailFound = false;
+        }
         else
         {
-            while( nMiddle > 0
-                   && fabs(papoEntries[nMiddle]->dfTailX-dfX) < JOIN_DIST )
-                nMiddle--;
+            GDALContourPath *poOther = sHead.poPath;
+            UnregisterEnd( poOther, false );
+            UnregisterEnd( poOther, true );
+            poOther->Splice( sHead.bTail, poPath, false );
+            poOther->bClosed = true;
+            poPath->bMerged = true;
+            return;
+        }
+    }
 
-            while( nMiddle < nEntryCount
-                   && fabs(papoEntries[nMiddle]->dfTailX-dfX) < JOIN_DIST )
-            {
-                if( fabs(papoEntries[nMiddle]->
-                         padfY[papoEntries[nMiddle]->nPoints-1] - dfY) <
-                    JOIN_DIST )
-                    return nMiddle;
-                nMiddle++;
-            }
+    RegisterEnd( poPath, false );
+    RegisterEnd( poPath, true );
 
-            return -1;
+/* -------------------------------------------------------------------- */
+/*      Join the head, then the tail, wherever it ended up.             */
+/* -------------------------------------------------------------------- */
+    GDALContourPath *poTailOwner = poPath;
+    bool bTailOwnerEnd = true;
+
+    if( bHeadFound )
+    {
+        UnregisterEnd( sHead.poPath, sHead.bTail );
+        UnregisterEnd( poPath, false );
+        GDALContourPath *poJoined =
+            Join( sHead.poPath, sHead.bTail, poPath, false );
+        if( poJoined != poPath )
+        {
+            poTailOwner = poJoined;
+            bTailOwnerEnd = sHead.bTail;
         }
     }
 
-    return -1;
+    if( bTailFound )
+    {
+        UnregisterEnd( sTail.poPath, sTail.bTail );
+        UnregisterEnd( poTailOwner, bTailOwnerEnd );
+        Join( poTailOwner, bTailOwnerEnd, sTail.poPath, sTail.bTail );
+    }
 }
 
 /************************************************************************/
-/*                           InsertContour()                            */
+/*                               Flush()                                */
 /*                                                                      */
-/*      Ensure the newly added contour is placed in order according     */
-/*      to the X value relative to the other contours.                  */
+/*      Move to apoDone the paths that are closed, or whose ends are    */
+/*      not on one of the seam lines (NaN if unused) along which        */
+/*      contours may still be continued.                                */
 /************************************************************************/
 
-int GDALContourLevel::InsertContour( GDALContourItem *poNewContour )
+void GDALContourPathSet::Flush( double dfSeamY1, double dfSeamY2,
+                                std::vector<GDALContourPath *> &apoDone )
 
 {
-/* -------------------------------------------------------------------- */
-/*      Find where to insert by binary search.                          */
-/* -------------------------------------------------------------------- */
-    int nStart = 0;
-    int nEnd = nEntryCount - 1;
+    size_t nKept = 0;
 
-    while( nEnd >= nStart )
+    for( size_t i = 0; i < apoPaths.size(); i++ )
     {
-        const int nMiddle = (nEnd + nStart) / 2;
-
-        const double dfMiddleX = papoEntries[nMiddle]->dfTailX;
+        GDALContourPath *poPath = apoPaths[i];
+        if( poPath->bMerged )
+        {
+            delete poPath;
+            continue;
+        }
 
-        if( dfMiddleX < poNewContour->dfLevel )
-            nStart = nMiddle + 1;
-        else if( dfMiddleX > poNewContour->dfLevel )
-            nEnd = nMiddle - 1;
-        else
+        if( !poPath->bClosed )
         {
-            nEnd = nMiddle - 1;
-            break;
+            const double dfHeadY = poPath->GetY(0);
+            const double dfTailY =
+                poPath->GetY(poPath->GetPointCount() - 1);
+            if( fabs(dfHeadY - dfSeamY1) < JOIN_DIST ||
+                fabs(dfHeadY - dfSeamY2) < JOIN_DIST ||
+                fabs(dfTailY - dfSeamY1) < JOIN_DIST ||
+                fabs(dfTailY - dfSeamY2) < JOIN_DIST )
+            {
+                apoPaths[nKept++] = poPath;
+                continue;
+            }
+
+            UnregisterEnd( poPath, false );
+            UnregisterEnd( poPath, true );
         }
-    }
 
-/* -------------------------------------------------------------------- */
-/*      Do we need to grow the array?                                   */
-/* -------------------------------------------------------------------- */
-    if( nEntryMax == nEntryCount )
-    {
-        nEntryMax = nEntryMax * 2 + 10;
-        papoEntries = static_cast<GDALContourItem **>(
-            CPLRealloc(papoEntries, sizeof(void*) * nEntryMax));
+        apoDone.push_back( poPath );
     }
 
-/* -------------------------------------------------------------------- */
-/*      Insert the new contour at the appropriate location.             */
-/* -------------------------------------------------------------------- */
-    if( nEntryCount - nEnd - 1 > 0 )
-        memmove( papoEntries + nEnd + 2, papoEntries + nEnd + 1,
-                 (nEntryCount - nEnd - 1) * sizeof(void*) );
-    papoEntries[nEnd+1] = poNewContour;
-    nEntryCount++;
-
-    return nEnd+1;
+    apoPaths.resize( nKept );
 }
 
 /************************************************************************/
 /* ==================================================================== */
-/*                           GDALContourItem                            */
+/*                           GDALContourPath                            */
 /* ==================================================================== */
 /************************************************************************/
 
 /************************************************************************/
-/*                          GDALContourItem()                           */
+/*                          GDALContourPath()                           */
 /************************************************************************/
 
-GDALContourItem::GDALContourItem( double dfLevelIn ) :
-    bRecentlyAccessed(false),
+GDALContourPath::GDALContourPath( int iLevelIn, double dfLevelIn,
+                                  bool bLeftIsHighIn ) :
+    iLevel(iLevelIn),
     dfLevel(dfLevelIn),
-    nPoints(0),
-    nMaxPoints(0),
-    padfX(nullptr),
-    padfY(nullptr),
-    bLeftIsHigh(false),
-    dfTailX(0.0)
+    bLeftIsHigh(bLeftIsHighIn),
+    bClosed(false),
+    bMerged(false)
 {}
 
 /************************************************************************/
-/*                          ~GDALContourItem()                          */
+/*                             GetX() / GetY()                          */
 /************************************************************************/
 
-GDALContourItem::~GDALContourItem()
+double GDALContourPath::GetX( size_t i ) const
 
 {
-    CPLFree( padfX );
-    CPLFree( padfY );
+    const size_t nHead = adfHeadX.size();
+    return i < nHead ? adfHeadX[nHead - 1 - i] : adfTailX[i - nHead];
 }
 
-/************************************************************************/
-/*                             AddSegment()                             */
-/************************************************************************/
-
-int GDALContourItem::AddSegment( double dfXStart, double dfYStart,
-                                 double dfXEnd, double dfYEnd,
-                                 int bLeftHigh)
+double GDALContourPath::GetY( size_t i ) const
 
 {
-    MakeRoomFor( nPoints + 1 );
-
-/* -------------------------------------------------------------------- */
-/*      If there are no segments, just add now.                         */
-/* -------------------------------------------------------------------- */
-    if( nPoints == 0 )
-    {
-        nPoints = 2;
-
-        padfX[0] = dfXStart;
-        padfY[0] = dfYStart;
-        padfX[1] = dfXEnd;
-        padfY[1] = dfYEnd;
-        bRecentlyAccessed = true;
-
-        dfTailX = padfX[1];
-
-        // Here we know that the left of this vector is the high side.
-        bLeftIsHigh = CPL_TO_BOOL(bLeftHigh);
-
-        return TRUE;
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Try to matching up with one of the ends, and insert.            */
-/* -------------------------------------------------------------------- */
-    if( fabs(padfX[nPoints-1]-dfXStart) < JOIN_DIST
-             && fabs(padfY[nPoints-1]-dfYStart) < JOIN_DIST )
-    {
-        padfX[nPoints] = dfXEnd;
-        padfY[nPoints] = dfYEnd;
-        nPoints++;
-
-        bRecentlyAccessed = true;
-
-        dfTailX = dfXEnd;
-
-        return TRUE;
-    }
-    else if( fabs(padfX[nPoints-1]-dfXEnd) < JOIN_DIST
-             && fabs(padfY[nPoints-1]-dfYEnd) < JOIN_DIST )
-    {
-        padfX[nPoints] = dfXStart;
-        padfY[nPoints] = dfYStart;
-        nPoints++;
-
-        bRecentlyAccessed = true;
-
-        dfTailX = dfXStart;
-
-        return TRUE;
-    }
-
-    return FALSE;
+    const size_t nHead = adfHeadY.size();
+    return i < nHead ? adfHeadY[nHead - 1 - i] : adfTailY[i - nHead];
 }
 
 /************************************************************************/
-/*                               DistanceSqr()                          */
+/*                              AddPoint()                              */
 /************************************************************************/
 
-double GDALContourItem::DistanceSqr(
-   double x0, double y0, double x1, double y1 )
-{
-// --------------------------------------------------------------------
-// Coumpute the square of the euclidian distance between
-// (x0;y0)-(x1;y1)
-// --------------------------------------------------------------------
-   const double dx = x0 - x1;
-   const double dy = y0 - y1;
-
-   return dx * dx + dy * dy;
-}
-
-/************************************************************************/
-/*                               MergeCase()                            */
-/************************************************************************/
+void GDALContourPath::AddPoint( bool bTail, double dfX, double dfY )
 
-int GDALContourItem::MergeCase(
-   double ax0, double ay0, double ax1, double ay1,
-   double bx0, double by0, double bx1, double by1
-)
 {
-// --------------------------------------------------------------------
-// Try to find a match case between line ends.
-// Calculate all possible distances and choose the closest
-// if less than JOIN_DIST.
-// --------------------------------------------------------------------
-
-    // Avoid sqrt().
-    const double jds = JOIN_DIST * JOIN_DIST;
-
-    // Case 1 e-b.
-    int cs = 1;
-    double dmin = DistanceSqr( ax1, ay1, bx0, by0 );
-
-    // Case 2 b-e.
-    double dd = DistanceSqr( ax0, ay0, bx1, by1 );
-    if( dd < dmin )
-    {
-        dmin = dd;
-        cs   = 2;
-    }
-
-    // Case 3 e-e.
-    dd = DistanceSqr( ax1, ay1, bx1, by1 );
-    if( dd < dmin )
+    if( bTail )
     {
-        dmin = dd;
-        cs   = 3;
+        adfTailX.push_back( dfX );
+        adfTailY.push_back( dfY );
     }
-
-    // Case 4 b-b.
-    dd = DistanceSqr (ax0, ay0, bx0, by0);
-    if( dd < dmin )
+    else
     {
-        dmin = dd;
-        cs   = 4;
+        adfHeadX.push_back( dfX );
+        adfHeadY.push_back( dfY );
     }
-
-    if( dmin > jds )
-        cs = 0;
-
-    return cs;
 }
 
 /************************************************************************/
-/*                               Merge()                                */
+/*                               Splice()                               */
+/*                                                                      */
+/*      Add the points of another path, starting at its bFromTail end   */
+/*      which is at the same location as our bTail end.                 */
 /************************************************************************/
 
-int GDALContourItem::Merge( GDALContourItem *poOther )
+void GDALContourPath::Splice( bool bTail, const GDALContourPath *poOther,
+                              bool bFromTail )
 
 {
-    if( poOther->dfLevel != dfLevel )
-        return FALSE;
-
-/* -------------------------------------------------------------------- */
-/*      Try to matching up with one of the ends, and insert.            */
-/* -------------------------------------------------------------------- */
-
-    const int mc = MergeCase(
-        padfX[0],                           padfY[0],
-        padfX[nPoints-1],                   padfY[nPoints-1],
-        poOther->padfX[0],                  poOther->padfY[0],
-        poOther->padfX[poOther->nPoints-1], poOther->padfY[poOther->nPoints-1]
-    );
-
-    bool rc = false;
-    switch( mc )
+    const size_t nOtherPoints = poOther->GetPointCount();
+    for( size_t i = 1; i < nOtherPoints; i++ )
     {
-        case 0:
-            break;
-
-        case 1:  // Case 1 e-b.
-            MakeRoomFor( nPoints + poOther->nPoints - 1 );
-
-            memcpy( padfX + nPoints, poOther->padfX + 1,
-                    sizeof(double) * (poOther->nPoints-1) );
-            memcpy( padfY + nPoints, poOther->padfY + 1,
-                    sizeof(double) * (poOther->nPoints-1) );
-            nPoints += poOther->nPoints - 1;
-
-            bRecentlyAccessed = true;
-
-            dfTailX = padfX[nPoints-1];
-
-            rc = true;
-            break;
-
-        case 2:  // Case 2 b-e.
-            MakeRoomFor( nPoints + poOther->nPoints - 1 );
-
-            memmove( padfX + poOther->nPoints - 1, padfX,
-                    sizeof(double) * nPoints );
-            memmove( padfY + poOther->nPoints - 1, padfY,
-                    sizeof(double) * nPoints );
-            memcpy( padfX, poOther->padfX,
-                    sizeof(double) * (poOther->nPoints-1) );
-            memcpy( padfY, poOther->padfY,
-                    sizeof(double) * (poOther->nPoints-1) );
-            nPoints += poOther->nPoints - 1;
-
-            bRecentlyAccessed = true;
-
-            dfTailX = padfX[nPoints-1];
-
-            rc = true;
-            break;
-
-        case 3:  // Case 3 e-e
-            MakeRoomFor( nPoints + poOther->nPoints - 1 );
-
-            for( int i = 0; i < poOther->nPoints-1; i++ )
-            {
-                padfX[i+nPoints] = poOther->padfX[poOther->nPoints-i-2];
-                padfY[i+nPoints] = poOther->padfY[poOther->nPoints-i-2];
-            }
-
-            nPoints += poOther->nPoints - 1;
-
-            bRecentlyAccessed = true;
-
-            dfTailX = padfX[nPoints-1];
-
-            rc = true;
-            break;
-
-        case 4:  // Case 3 b-b.
-            MakeRoomFor( nPoints + poOther->nPoints - 1 );
-
-            memmove( padfX + poOther->nPoints - 1, padfX,
-                    sizeof(double) * nPoints );
-            memmove( padfY + poOther->nPoints - 1, padfY,
-                    sizeof(double) * nPoints );
-
-            for( int i = 0; i < poOther->nPoints-1; i++ )
-            {
-                padfX[i] = poOther->padfX[poOther->nPoints - i - 1];
-                padfY[i] = poOther->padfY[poOther->nPoints - i - 1];
-            }
-
-            nPoints += poOther->nPoints - 1;
-
-            bRecentlyAccessed = true;
-
-            dfTailX = padfX[nPoints-1];
-
-            rc = true;
-            break;
-
-        default:
-            CPLAssert(false);
-            break;
+        const size_t j = bFromTail ? nOtherPoints - 1 - i : i;
+        AddPoint( bTail, poOther->GetX(j), poOther->GetY(j) );
     }
-
-    return rc;
 }
 
 /************************************************************************/
-/*                            MakeRoomFor()                             */
+/*                               Export()                               */
 /************************************************************************/
 
-void GDALContourItem::MakeRoomFor( int nNewPoints )
+void GDALContourPath::Export( std::vector<double> &adfX,
+                              std::vector<double> &adfY ) const
 
 {
-    if( nNewPoints > nMaxPoints )
+    const size_t nPoints = GetPointCount();
+    adfX.resize( nPoints );
+    adfY.resize( nPoints );
+    for( size_t i = 0; i < nPoints; i++ )
     {
-        nMaxPoints = nNewPoints * 2 + 50;
-        padfX = static_cast<double *>(
-            CPLRealloc(padfX, sizeof(double) * nMaxPoints));
-        padfY = static_cast<double *>(
-            CPLRealloc(padfY, sizeof(double) * nMaxPoints));
+        adfX[i] = GetX(i);
+        adfY[i] = GetY(i);
     }
-}
-
-/************************************************************************/
-/*                          PrepareEjection()                           */
-/************************************************************************/
-
-void GDALContourItem::PrepareEjection()
 
-{
     // If left side is the high side, then reverse to get curve normal
     // pointing downwards.
     if( bLeftIsHigh )
     {
-        std::reverse(padfX, padfX + nPoints);
-        std::reverse(padfY, padfY + nPoints);
+        std::reverse( adfX.begin(), adfX.end() );
+        std::reverse( adfY.begin(), adfY.end() );
     }
 }
 
@@ -1509,6 +1423,82 @@ CPLErr OGRContourWriter( double dfLevel,
     return eErr == OGRERR_NONE ? CE_None : CE_Failure;
 }
 
+/************************************************************************/
+/*                         GDALContourStripJob                          */
+/************************************************************************/
+
+struct GDALContourStripJob
+{
+    const GDALContourGenerator *poCG;
+
+    // Buffer of (perturbed) lines, starting with line nBufFirstLine.
+    const double *padfLines;
+    int           nBufFirstLine;
+    int           nXSize;
+    int           nYSize;
+
+    // Rows of rectangles to process, see ProcessLine().
+    int           iRowStart;
+    int           iRowEnd;
+
+    // Contours completed within the strip, and contours reaching the
+    // first or last line of the strip, to be joined with the neighbouring
+    // strips.
+    std::vector<GDALContourPath *> apoDone;
+    std::vector<GDALContourPath *> apoOpen;
+
+    CPLErr        eErr;
+};
+
+/************************************************************************/
+/*                      GDALContourStripJobFunc()                       */
+/************************************************************************/
+
+static void GDALContourStripJobFunc( void *pData )
+
+{
+    GDALContourStripJob *psJob = static_cast<GDALContourStripJob *>(pData);
+    const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+    const double dfTopSeamY =
+        psJob->iRowStart > 0 ? psJob->iRowStart - 0.5 : dfNaN;
+
+    GDALContourPathSet oPathSet;
+
+    psJob->eErr = CE_None;
+    for( int iRow = psJob->iRowStart;
+         psJob->eErr == CE_None && iRow < psJob->iRowEnd;
+         iRow++ )
+    {
+        const int iUpLine = std::max(0, iRow - 1);
+        const int iLoLine = std::min(psJob->nYSize - 1, iRow);
+        psJob->eErr = psJob->poCG->ProcessLine(
+            oPathSet,
+            psJob->padfLines + static_cast<size_t>(iUpLine -
+                                    psJob->nBufFirstLine) * psJob->nXSize,
+            psJob->padfLines + static_cast<size_t>(iLoLine -
+                                    psJob->nBufFirstLine) * psJob->nXSize,
+            iRow );
+
+        oPathSet.Flush( dfTopSeamY,
+                        iRow < psJob->nYSize ? iRow + 0.5 : dfNaN,
+                        psJob->apoDone );
+    }
+
+    oPathSet.Flush( dfNaN, dfNaN, psJob->apoOpen );
+}
+
+/************************************************************************/
+/*                       GDALContourDeletePaths()                       */
+/************************************************************************/
+
+static void GDALContourDeletePaths( std::vector<GDALContourPath *> &apoPaths )
+
+{
+    for( size_t i = 0; i < apoPaths.size(); i++ )
+        delete apoPaths[i];
+    apoPaths.clear();
+}
+
 /************************************************************************/
 /*                        GDALContourGenerate()                         */
 /************************************************************************/
@@ -1603,6 +1593,17 @@ an averaged value from the two nearby points (in this case (12+3+5)/3).
 
 \endverbatim
 
+Threading:
+
+The raster is traced by strips of lines, in parallel according to the
+\ref gdal_utilities_num_threads "GDAL_NUM_THREADS" configuration option
+(GDAL >= 2.4).  Line ends are hashed by level and location, so
+contours reaching the edge of a strip are joined to the ones of the previous
+strip without searching, and each contour is written as soon as it cannot be
+continued any further.  The order in which the features are written depends
+on the number of threads.  So may the way lines are joined where several
+contours of a level meet at a single point.
+
  *
  * @param hBand The band to read raster data from.  The whole band will be
  * processed.
@@ -1687,16 +1688,13 @@ CPLErr GDALContourGenerate( GDALRasterBandH hBand,
     oCWI.nNextID = 0;
 
 /* -------------------------------------------------------------------- */
-/*      Setup contour generator.                                        */
+/*      Setup contour generator.  Its line buffers are not needed as    */
+/*      the lines are fed by strips below.                              */
 /* -------------------------------------------------------------------- */
     const int nXSize = GDALGetRasterBandXSize( hBand );
     const int nYSize = GDALGetRasterBandYSize( hBand );
 
     GDALContourGenerator oCG( nXSize, nYSize, OGRContourWriter, &oCWI );
-    if( !oCG.Init() )
-    {
-        return CE_Failure;
-    }
 
     if( nFixedLevelCount > 0 )
         oCG.SetFixedLevels( nFixedLevelCount, padfFixedLevels );
@@ -1707,25 +1705,146 @@ CPLErr GDALContourGenerate( GDALRasterBandH hBand,
         oCG.SetNoData( dfNoDataValue );
 
 /* -------------------------------------------------------------------- */
-/*      Feed the data into the contour generator.                       */
+/*      Set up the strips of rows and the worker threads.  There is     */
+/*      one more row than lines, the first and last rows being the      */
+/*      half pixel borders of the raster.                               */
 /* -------------------------------------------------------------------- */
-    double *padfScanline =
-        static_cast<double *>(VSI_MALLOC2_VERBOSE(sizeof(double), nXSize));
-    if( padfScanline == nullptr )
+    const int nRows = nYSize + 1;
+
+    const int nThreads = CPLGetNumThreads(nullptr);
+
+    const int nStripHeight = GDALGetStripHeight(nXSize, nRows, 16);
+    const int nStrips = (nRows + nStripHeight - 1) / nStripHeight;
+
+    CPLWorkerThreadPool *poThreadPool =
+        CPLCreateWorkerThreadPool(std::min(nThreads, nStrips));
+    const int nBatchStrips = poThreadPool ? std::min(nThreads, nStrips) : 1;
+    const int nBatchRows = nBatchStrips * nStripHeight;
+
+    // The lines of a batch, preceded by the last line of the previous one.
+    double *padfLines = static_cast<double *>(
+        VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nBatchRows + 1));
+    if( padfLines == nullptr )
     {
+        delete poThreadPool;
         return CE_Failure;
     }
 
+    std::vector<GDALContourStripJob> asJobs(nBatchStrips);
+    for( int i = 0; i < nBatchStrips; i++ )
+    {
+        asJobs[i].poCG = &oCG;
+        asJobs[i].padfLines = padfLines;
+        asJobs[i].nBufFirstLine = 0;
+        asJobs[i].nXSize = nXSize;
+        asJobs[i].nYSize = nYSize;
+        asJobs[i].iRowStart = 0;
+        asJobs[i].iRowEnd = 0;
+        asJobs[i].eErr = CE_None;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Process the rows by batches of strips.  The lines are read and  */
+/*      the contours written in this thread, in order, while the        */
+/*      strips are traced by the worker threads.  The contours reaching */
+/*      the edges of their strip are then joined to the ones traced     */
+/*      before, and written as soon as they cannot be continued.        */
+/* -------------------------------------------------------------------- */
+    const double dfNaN = std::numeric_limits<double>::quiet_NaN();
+    GDALContourPathSet oSeamPaths;
+    std::vector<GDALContourPath *> apoDone;
+    int nBufFirstLine = 0;
+    int nLinesRead = 0;
     CPLErr eErr = CE_None;
-    for( int iLine = 0; iLine < nYSize && eErr == CE_None; iLine++ )
+
+    for( int iBatchRow = 0;
+         eErr == CE_None && iBatchRow < nRows;
+         iBatchRow += nBatchRows )
     {
-        eErr = GDALRasterIO( hBand, GF_Read, 0, iLine, nXSize, 1,
-                      padfScanline, nXSize, 1, GDT_Float64, 0, 0 );
-        if( eErr == CE_None )
-            eErr = oCG.FeedLine( padfScanline );
+        const int iBatchRowEnd = std::min(nRows, iBatchRow + nBatchRows);
+
+        // Row iRow is between lines iRow-1 and iRow, clamped to the raster.
+        const int iFirstLine = std::max(0, iBatchRow - 1);
+        const int iLastLine = std::min(nYSize - 1, iBatchRowEnd - 1);
+
+        if( nLinesRead > iFirstLine )
+        {
+            memmove( padfLines,
+                     padfLines + static_cast<size_t>(iFirstLine -
+                                                     nBufFirstLine) * nXSize,
+                     sizeof(double) * nXSize );
+        }
+        nBufFirstLine = iFirstLine;
+
+        const int nNewLines = iLastLine + 1 - nLinesRead;
+        if( nNewLines > 0 )
+        {
+            double *padfNewLines = padfLines +
+                static_cast<size_t>(nLinesRead - nBufFirstLine) * nXSize;
+            eErr = GDALRasterIO( hBand, GF_Read, 0, nLinesRead,
+                                 nXSize, nNewLines,
+                                 padfNewLines, nXSize, nNewLines,
+                                 GDT_Float64, 0, 0 );
+            for( int i = 0; eErr == CE_None && i < nNewLines; i++ )
+                oCG.PerturbLine( padfNewLines +
+                                 static_cast<size_t>(i) * nXSize );
+            nLinesRead += nNewLines;
+        }
+        if( eErr != CE_None )
+            break;
+
+        int nJobs = 0;
+        for( int iRow = iBatchRow; iRow < iBatchRowEnd; iRow += nStripHeight )
+        {
+            asJobs[nJobs].nBufFirstLine = nBufFirstLine;
+            asJobs[nJobs].iRowStart = iRow;
+            asJobs[nJobs].iRowEnd = std::min(iBatchRowEnd, iRow + nStripHeight);
+            nJobs++;
+        }
+
+        if( poThreadPool != nullptr && nJobs > 1 )
+        {
+            std::vector<void*> apJobs;
+            for( int i = 0; i < nJobs; i++ )
+                apJobs.push_back(&asJobs[i]);
+            poThreadPool->SubmitJobs(GDALContourStripJobFunc, apJobs);
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( int i = 0; i < nJobs; i++ )
+                GDALContourStripJobFunc(&asJobs[i]);
+        }
+
+        for( int iJob = 0; iJob < nJobs; iJob++ )
+        {
+            GDALContourStripJob &oJob = asJobs[iJob];
+            if( eErr == CE_None )
+                eErr = oJob.eErr;
+            if( eErr != CE_None )
+            {
+                GDALContourDeletePaths( oJob.apoDone );
+                GDALContourDeletePaths( oJob.apoOpen );
+                continue;
+            }
+
+            eErr = oCG.WritePaths( oJob.apoDone );
+
+            for( size_t i = 0; i < oJob.apoOpen.size(); i++ )
+                oSeamPaths.AddPath( oJob.apoOpen[i] );
+            oJob.apoOpen.clear();
+
+            oSeamPaths.Flush( oJob.iRowEnd < nRows ?
+                                    oJob.iRowEnd - 0.5 : dfNaN,
+                              dfNaN, apoDone );
+            if( eErr == CE_None )
+                eErr = oCG.WritePaths( apoDone );
+            else
+                GDALContourDeletePaths( apoDone );
+        }
 
         if( eErr == CE_None &&
-            !pfnProgress((iLine + 1) / static_cast<double>(nYSize),
+            !pfnProgress(iBatchRowEnd / static_cast<double>(nRows),
                          "", pProgressArg) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -1733,7 +1852,8 @@ CPLErr GDALContourGenerate( GDALRasterBandH hBand,
         }
     }
 
-    CPLFree( padfScanline );
+    delete poThreadPool;
+    CPLFree( padfLines );
 
     return eErr;
 }
@@ -99,6 +99,12 @@ void GDALdllImageFilledPolygon( int nRasterXSize, int nRasterYSize,
 
 CPL_C_END
 
+/************************************************************************/
+/*      Strip based processing.                                         */
+/************************************************************************/
+
+int GDALGetStripHeight( int nXSize, int nYSize, int nMinHeight );
+
 /************************************************************************/
 /*                          Polygon Enumerator                          */
 /************************************************************************/
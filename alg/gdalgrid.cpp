@@ -31,6 +31,7 @@
 #include "gdalgrid.h"
 #include "gdalgrid_priv.h"
 
+#include <algorithm>
 #include <cfloat>
 #include <climits>
 #include <cmath>
@@ -39,14 +40,15 @@
 
 #include <limits>
 #include <map>
+#include <new>
 #include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_cpu_features.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_progress.h"
-#include "cpl_quad_tree.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
 #include "cpl_worker_thread_pool.h"
@@ -57,20 +59,304 @@ CPL_CVSID("$Id: gdalgrid.cpp 9ff327806cd64df6d73a6c91f92d12ca0c5e07df 2018-04-07
 constexpr double TO_RADIANS = M_PI / 180.0;
 
 /************************************************************************/
-/*                        GDALGridGetPointBounds()                      */
+/*                            GDALGridKDTree                            */
+/*                                                                      */
+/*      Static 2D kd-tree of the input points, shared read-only by all  */
+/*      the worker threads.  Each node covers a range of the reordered  */
+/*      points and keeps their bounding box.  Nodes are split at the    */
+/*      median of their widest dimension, down to small leaves.         */
 /************************************************************************/
 
-static void GDALGridGetPointBounds( const void* hFeature, CPLRectObj* pBounds )
+// Result buffers of the searches, one per thread.
+struct GDALGridKDTreeBuffers
 {
-    const GDALGridPoint* psPoint = static_cast<const GDALGridPoint*>(hFeature);
-    GDALGridXYArrays* psXYArrays = psPoint->psXYArrays;
-    const int i = psPoint->i;
-    const double dfX = psXYArrays->padfX[i];
-    const double dfY = psXYArrays->padfY[i];
-    pBounds->minx = dfX;
-    pBounds->miny = dfY;
-    pBounds->maxx = dfX;
-    pBounds->maxy = dfY;
+    std::vector<GUInt32>                     anPoints;
+    std::vector<std::pair<double, GUInt32> > asNeighbours;
+};
+
+class GDALGridKDTree
+{
+    struct Node
+    {
+        double  dfMinX;
+        double  dfMinY;
+        double  dfMaxX;
+        double  dfMaxY;
+        GUInt32 nBegin;
+        GUInt32 nEnd;
+        GUInt32 nLeft;  // 0 for a leaf.
+        GUInt32 nRight;
+    };
+
+    static const GUInt32 knLeafSize = 16;
+    // Deep enough for the balanced tree of 2^32 points.
+    static const int     knMaxDepth = 64;
+
+    std::vector<Node>    m_asNodes;
+    std::vector<GUInt32> m_anIndex;
+    std::vector<double>  m_adfX;
+    std::vector<double>  m_adfY;
+
+    GUInt32 BuildNode( GUInt32 nBegin, GUInt32 nEnd,
+                       const double *padfX, const double *padfY );
+
+    static double GetDistance2( const Node &sNode, double dfX, double dfY )
+    {
+        const double dfDX =
+            std::max(0.0, std::max(sNode.dfMinX - dfX, dfX - sNode.dfMaxX));
+        const double dfDY =
+            std::max(0.0, std::max(sNode.dfMinY - dfY, dfY - sNode.dfMaxY));
+        return dfDX * dfDX + dfDY * dfDY;
+    }
+
+  public:
+    bool Build( GUInt32 nPoints, const double *padfX, const double *padfY );
+
+    void SearchRadius( double dfX, double dfY, double dfRadius2,
+                       std::vector<GUInt32> &anPoints ) const;
+    void SearchNearest( double dfX, double dfY,
+                        GUInt32 nMaxCount, double dfMaxDistance2,
+                        std::vector<std::pair<double, GUInt32> > &asNeighbours )
+        const;
+};
+
+/************************************************************************/
+/*                      GDALGridKDTree::Build()                         */
+/************************************************************************/
+
+bool GDALGridKDTree::Build( GUInt32 nPoints,
+                            const double *padfX, const double *padfY )
+{
+    try
+    {
+        // Points with a NaN coordinate are never within a search area.
+        m_anIndex.reserve( nPoints );
+        for( GUInt32 i = 0; i < nPoints; i++ )
+        {
+            if( !CPLIsNan(padfX[i]) && !CPLIsNan(padfY[i]) )
+                m_anIndex.push_back( i );
+        }
+
+        const GUInt32 nIndexed = static_cast<GUInt32>(m_anIndex.size());
+        if( nIndexed > 0 )
+        {
+            m_asNodes.reserve( 2 * (nIndexed / knLeafSize) + 1 );
+            BuildNode( 0, nIndexed, padfX, padfY );
+        }
+
+        // Copy the coordinates in tree order, for locality of the searches.
+        m_adfX.resize( nIndexed );
+        m_adfY.resize( nIndexed );
+        for( GUInt32 k = 0; k < nIndexed; k++ )
+        {
+            m_adfX[k] = padfX[m_anIndex[k]];
+            m_adfY[k] = padfY[m_anIndex[k]];
+        }
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate the index of the points" );
+        return false;
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                    GDALGridKDTree::BuildNode()                       */
+/************************************************************************/
+
+GUInt32 GDALGridKDTree::BuildNode( GUInt32 nBegin, GUInt32 nEnd,
+                                   const double *padfX, const double *padfY )
+{
+    const GUInt32 iNode = static_cast<GUInt32>(m_asNodes.size());
+    m_asNodes.push_back( Node() );
+
+    Node sNode;
+    sNode.dfMinX = padfX[m_anIndex[nBegin]];
+    sNode.dfMinY = padfY[m_anIndex[nBegin]];
+    sNode.dfMaxX = sNode.dfMinX;
+    sNode.dfMaxY = sNode.dfMinY;
+    for( GUInt32 k = nBegin + 1; k < nEnd; k++ )
+    {
+        const GUInt32 i = m_anIndex[k];
+        sNode.dfMinX = std::min(sNode.dfMinX, padfX[i]);
+        sNode.dfMinY = std::min(sNode.dfMinY, padfY[i]);
+        sNode.dfMaxX = std::max(sNode.dfMaxX, padfX[i]);
+        sNode.dfMaxY = std::max(sNode.dfMaxY, padfY[i]);
+    }
+    sNode.nBegin = nBegin;
+    sNode.nEnd = nEnd;
+    sNode.nLeft = 0;
+    sNode.nRight = 0;
+
+    if( nEnd - nBegin > knLeafSize )
+    {
+        const GUInt32 nMiddle = nBegin + (nEnd - nBegin) / 2;
+        const double *padfAxis =
+            sNode.dfMaxX - sNode.dfMinX >= sNode.dfMaxY - sNode.dfMinY ?
+            padfX : padfY;
+        std::nth_element( m_anIndex.begin() + nBegin,
+                          m_anIndex.begin() + nMiddle,
+                          m_anIndex.begin() + nEnd,
+                          [padfAxis](GUInt32 i, GUInt32 j)
+                          { return padfAxis[i] < padfAxis[j]; } );
+
+        sNode.nLeft = BuildNode( nBegin, nMiddle, padfX, padfY );
+        sNode.nRight = BuildNode( nMiddle, nEnd, padfX, padfY );
+    }
+
+    // The recursion may have reallocated m_asNodes.
+    m_asNodes[iNode] = sNode;
+    return iNode;
+}
+
+/************************************************************************/
+/*                   GDALGridKDTree::SearchRadius()                     */
+/*                                                                      */
+/*      Return in ascending order the points whose squared distance     */
+/*      to (dfX, dfY) is at most dfRadius2.  The distance is computed   */
+/*      in the same way as by the gridding functions.                  */
+/************************************************************************/
+
+void GDALGridKDTree::SearchRadius( double dfX, double dfY, double dfRadius2,
+                                   std::vector<GUInt32> &anPoints ) const
+{
+    anPoints.clear();
+    if( m_asNodes.empty() )
+        return;
+
+    GUInt32 anStack[knMaxDepth];
+    int nStackSize = 0;
+    anStack[nStackSize++] = 0;
+
+    while( nStackSize > 0 )
+    {
+        const Node &sNode = m_asNodes[anStack[--nStackSize]];
+        if( GetDistance2(sNode, dfX, dfY) > dfRadius2 )
+            continue;
+
+        if( sNode.nLeft != 0 )
+        {
+            anStack[nStackSize++] = sNode.nLeft;
+            anStack[nStackSize++] = sNode.nRight;
+            continue;
+        }
+
+        for( GUInt32 k = sNode.nBegin; k < sNode.nEnd; k++ )
+        {
+            const double dfRX = m_adfX[k] - dfX;
+            const double dfRY = m_adfY[k] - dfY;
+            if( dfRX * dfRX + dfRY * dfRY <= dfRadius2 )
+                anPoints.push_back( m_anIndex[k] );
+        }
+    }
+
+    std::sort( anPoints.begin(), anPoints.end() );
+}
+
+/************************************************************************/
+/*                   GDALGridKDTree::SearchNearest()                    */
+/*                                                                      */
+/*      Return the (squared distance, point) pairs of the nMaxCount     */
+/*      points nearest to (dfX, dfY) within the squared distance        */
+/*      dfMaxDistance2, in ascending order.                             */
+/************************************************************************/
+
+void GDALGridKDTree::SearchNearest(
+    double dfX, double dfY, GUInt32 nMaxCount, double dfMaxDistance2,
+    std::vector<std::pair<double, GUInt32> > &asNeighbours ) const
+{
+    asNeighbours.clear();
+    if( m_asNodes.empty() || nMaxCount == 0 )
+        return;
+
+    // Depth first, nearest child first.  asNeighbours is a max-heap of the
+    // best points found so far.
+    GUInt32 anStack[knMaxDepth];
+    int nStackSize = 0;
+    anStack[nStackSize++] = 0;
+
+    while( nStackSize > 0 )
+    {
+        const Node &sNode = m_asNodes[anStack[--nStackSize]];
+        const double dfBound = asNeighbours.size() < nMaxCount ?
+            dfMaxDistance2 : asNeighbours.front().first;
+        if( GetDistance2(sNode, dfX, dfY) > dfBound )
+            continue;
+
+        if( sNode.nLeft != 0 )
+        {
+            const bool bLeftFirst =
+                GetDistance2(m_asNodes[sNode.nLeft], dfX, dfY) <=
+                GetDistance2(m_asNodes[sNode.nRight], dfX, dfY);
+            anStack[nStackSize++] = bLeftFirst ? sNode.nRight : sNode.nLeft;
+            anStack[nStackSize++] = bLeftFirst ? sNode.nLeft : sNode.nRight;
+            continue;
+        }
+
+        for( GUInt32 k = sNode.nBegin; k < sNode.nEnd; k++ )
+        {
+            const double dfRX = m_adfX[k] - dfX;
+            const double dfRY = m_adfY[k] - dfY;
+            const std::pair<double, GUInt32> oNeighbour(
+                dfRX * dfRX + dfRY * dfRY, m_anIndex[k] );
+            if( oNeighbour.first > dfMaxDistance2 )
+                continue;
+
+            if( asNeighbours.size() < nMaxCount )
+            {
+                asNeighbours.push_back( oNeighbour );
+                std::push_heap( asNeighbours.begin(), asNeighbours.end() );
+            }
+            else if( oNeighbour < asNeighbours.front() )
+            {
+                std::pop_heap( asNeighbours.begin(), asNeighbours.end() );
+                asNeighbours.back() = oNeighbour;
+                std::push_heap( asNeighbours.begin(), asNeighbours.end() );
+            }
+        }
+    }
+
+    std::sort_heap( asNeighbours.begin(), asNeighbours.end() );
+}
+
+/************************************************************************/
+/*                       GDALGridSearchEllipse()                        */
+/*                                                                      */
+/*      If the points are indexed and the search ellipse is bounded,    */
+/*      return in ascending order the points that may be inside of     */
+/*      it, that is within its circumscribed circle.  Otherwise return  */
+/*      false, and all the points must be tested.                       */
+/************************************************************************/
+
+static bool GDALGridSearchEllipse( void *hExtraParamsIn,
+                                   std::vector<GUInt32> &anLocalPoints,
+                                   double dfRadius1, double dfRadius2,
+                                   double dfXPoint, double dfYPoint,
+                                   const GUInt32 **ppanPoints,
+                                   GUInt32 *pnPointCount )
+{
+    const GDALGridExtraParameters *psExtraParams =
+        static_cast<const GDALGridExtraParameters *>(hExtraParamsIn);
+    if( psExtraParams == nullptr || psExtraParams->poKDTree == nullptr ||
+        !(dfRadius1 > 0.0) || !(dfRadius2 > 0.0) )
+        return false;
+
+    std::vector<GUInt32> &anPoints = psExtraParams->psKDTreeBuffers ?
+        psExtraParams->psKDTreeBuffers->anPoints : anLocalPoints;
+
+    // Leave some room for the rounding errors of the rotation done by the
+    // exact test of the callers.
+    const double dfRadius = std::max(dfRadius1, dfRadius2);
+    psExtraParams->poKDTree->SearchRadius( dfXPoint, dfYPoint,
+                                           dfRadius * dfRadius * (1 + 1e-9),
+                                           anPoints );
+
+    *ppanPoints = anPoints.empty() ? nullptr : &anPoints[0];
+    *pnPointCount = static_cast<GUInt32>(anPoints.size());
+    return true;
 }
 
 /************************************************************************/
@@ -118,7 +404,7 @@ static void GDALGridGetPointBounds( const void* hFeature, CPLRectObj* pBounds )
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -129,7 +415,7 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
                                  const double *padfZ,
                                  double dfXPoint, double dfYPoint,
                                  double *pdfValue,
-                                 CPL_UNUSED void* hExtraParamsIn)
+                                 void* hExtraParamsIn)
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -156,8 +442,19 @@ GDALGridInverseDistanceToAPower( const void *poOptionsIn, GUInt32 nPoints,
     double dfDenominator = 0.0;
     GUInt32 n = 0;
 
-    for( GUInt32 i = 0; i < nPoints; i++ )
+    // Only the points of the circle around the search ellipse, in the
+    // original order, if they are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
         const double dfR2 =
@@ -270,7 +567,6 @@ GDALGridInverseDistanceToAPowerNearestNeighbor(
       static_cast<
           const GDALGridInverseDistanceToAPowerNearestNeighborOptions *>(
           poOptionsIn);
-    const double dfRadius = poOptions->dfRadius;
     const double dfSmoothing = poOptions->dfSmoothing;
     const double dfSmoothing2 = dfSmoothing * dfSmoothing;
 
@@ -278,54 +574,50 @@ GDALGridInverseDistanceToAPowerNearestNeighbor(
 
     GDALGridExtraParameters* psExtraParams =
         static_cast<GDALGridExtraParameters *>(hExtraParamsIn);
-    CPLQuadTree* phQuadTree = psExtraParams->hQuadTree;
 
     const double dfRPower2 = psExtraParams->dfRadiusPower2PreComp;
     const double dfRPower4 = psExtraParams->dfRadiusPower4PreComp;
 
     const double dfPowerDiv2 = psExtraParams->dfPowerDiv2PreComp;
 
-    std::multimap<double, double> oMapDistanceToZValues;
-    if( phQuadTree != nullptr )
-    {
-        const double dfSearchRadius = dfRadius;
-        CPLRectObj sAoi;
-        sAoi.minx = dfXPoint - dfSearchRadius;
-        sAoi.miny = dfYPoint - dfSearchRadius;
-        sAoi.maxx = dfXPoint + dfSearchRadius;
-        sAoi.maxy = dfYPoint + dfSearchRadius;
-        int nFeatureCount = 0;
-        GDALGridPoint** papsPoints = reinterpret_cast<GDALGridPoint **>(
-                CPLQuadTreeSearch(phQuadTree, &sAoi, &nFeatureCount) );
-        if( nFeatureCount != 0 )
+    double dfNominator = 0.0;
+    double dfDenominator = 0.0;
+    GUInt32 n = 0;
+
+    if( psExtraParams->poKDTree != nullptr )
+    {
+        // The nMaxPoints nearest points within the radius, nearest first.
+        std::vector<std::pair<double, GUInt32> > asLocalNeighbours;
+        std::vector<std::pair<double, GUInt32> > &asNeighbours =
+            psExtraParams->psKDTreeBuffers ?
+            psExtraParams->psKDTreeBuffers->asNeighbours : asLocalNeighbours;
+        psExtraParams->poKDTree->SearchNearest(
+            dfXPoint, dfYPoint,
+            nMaxPoints > 0 ? nMaxPoints : std::numeric_limits<GUInt32>::max(),
+            dfRPower2, asNeighbours );
+
+        // If the nearest point is close to the grid node, use the point
+        // value directly as a node value to avoid singularity.
+        if( !asNeighbours.empty() &&
+            asNeighbours[0].first + dfSmoothing2 < 0.0000000000001 )
         {
-            for( int k = 0; k < nFeatureCount; k++ )
-            {
-                const int i = papsPoints[k]->i;
-                const double dfRX = padfX[i] - dfXPoint;
-                const double dfRY = padfY[i] - dfYPoint;
+            *pdfValue = padfZ[asNeighbours[0].second];
+            return CE_None;
+        }
 
-                const double dfR2 = dfRX * dfRX + dfRY * dfRY;
-                // real distance + smoothing
-                const double dfRsmoothed2 = dfR2 + dfSmoothing2;
-                if( dfRsmoothed2 < 0.0000000000001 )
-                {
-                    *pdfValue = padfZ[i];
-                    CPLFree(papsPoints);
-                    return CE_None;
-                }
-                // is point within real distance?
-                if( dfR2 <= dfRPower2 )
-                {
-                    oMapDistanceToZValues.insert(
-                        std::make_pair(dfRsmoothed2, padfZ[i]) );
-                }
-            }
+        for( size_t k = 0; k < asNeighbours.size(); k++ )
+        {
+            const double dfW =
+                pow(asNeighbours[k].first + dfSmoothing2, dfPowerDiv2);
+            const double dfInvW = 1.0 / dfW;
+            dfNominator += dfInvW * padfZ[asNeighbours[k].second];
+            dfDenominator += dfInvW;
+            n++;
         }
-        CPLFree(papsPoints);
     }
     else
     {
+        std::multimap<double, double> oMapDistanceToZValues;
         for( GUInt32 i = 0; i < nPoints; i++ )
         {
             const double dfRX = padfX[i] - dfXPoint;
@@ -347,31 +639,27 @@ GDALGridInverseDistanceToAPowerNearestNeighbor(
                 oMapDistanceToZValues.insert(std::make_pair(dfRsmoothed2, padfZ[i]) );
             }
         }
-    }
-
-    double dfNominator = 0.0;
-    double dfDenominator = 0.0;
-    GUInt32 n = 0;
 
-    // Examine all "neighbors" within the radius (sorted by distance via the
-    // multimap), and use the closest n points based on distance until the max
-    // is reached.
-    for( std::multimap<double, double>::iterator oMapDistanceToZValuesIter =
-             oMapDistanceToZValues.begin();
-         oMapDistanceToZValuesIter != oMapDistanceToZValues.end();
-         ++oMapDistanceToZValuesIter)
-    {
-        const double dfR2 = oMapDistanceToZValuesIter->first;
-        const double dfZ = oMapDistanceToZValuesIter->second;
-
-        const double dfW = pow(dfR2, dfPowerDiv2);
-        const double dfInvW = 1.0 / dfW;
-        dfNominator += dfInvW * dfZ;
-        dfDenominator += dfInvW;
-        n++;
-        if( nMaxPoints > 0 && n >= nMaxPoints )
+        // Examine all "neighbors" within the radius (sorted by distance via
+        // the multimap), and use the closest n points based on distance until
+        // the max is reached.
+        for( std::multimap<double, double>::iterator oMapDistanceToZValuesIter =
+                 oMapDistanceToZValues.begin();
+             oMapDistanceToZValuesIter != oMapDistanceToZValues.end();
+             ++oMapDistanceToZValuesIter)
         {
-            break;
+            const double dfR2 = oMapDistanceToZValuesIter->first;
+            const double dfZ = oMapDistanceToZValuesIter->second;
+
+            const double dfW = pow(dfR2, dfPowerDiv2);
+            const double dfInvW = 1.0 / dfW;
+            dfNominator += dfInvW * dfZ;
+            dfDenominator += dfInvW;
+            n++;
+            if( nMaxPoints > 0 && n >= nMaxPoints )
+            {
+                break;
+            }
         }
     }
 
@@ -533,7 +821,7 @@ GDALGridInverseDistanceToAPowerNoSearch(
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -543,7 +831,7 @@ GDALGridMovingAverage( const void *poOptionsIn, GUInt32 nPoints,
                        const double *padfX, const double *padfY,
                        const double *padfZ,
                        double dfXPoint, double dfYPoint, double *pdfValue,
-                       CPL_UNUSED void * hExtraParamsIn )
+                       void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -566,8 +854,19 @@ GDALGridMovingAverage( const void *poOptionsIn, GUInt32 nPoints,
 
     GUInt32 n = 0;  // Used after for.
 
-    for( GUInt32 i = 0; i < nPoints; i++ )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -642,10 +941,9 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
     // Pre-compute search ellipse parameters.
     const double dfRadius1 = poOptions->dfRadius1 * poOptions->dfRadius1;
     const double dfRadius2 = poOptions->dfRadius2 * poOptions->dfRadius2;
-    double dfR12 = dfRadius1 * dfRadius2;
+    const double dfR12 = dfRadius1 * dfRadius2;
     GDALGridExtraParameters* psExtraParams =
         static_cast<GDALGridExtraParameters *>(hExtraParamsIn);
-    CPLQuadTree* hQuadTree = psExtraParams->hQuadTree;
 
     // Compute coefficients for coordinate system rotation.
     const double dfAngle = TO_RADIANS * poOptions->dfAngle;
@@ -655,63 +953,41 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
 
     // If the nearest point will not be found, its value remains as NODATA.
     double dfNearestValue = poOptions->dfNoDataValue;
-    // Nearest distance will be initialized with the distance to the first
-    // point in array.
-    double dfNearestR = std::numeric_limits<double>::max();
-    GUInt32 i = 0;
-
-    double dfSearchRadius = psExtraParams->dfInitialSearchRadius;
-    if( hQuadTree != nullptr && dfRadius1 == dfRadius2 && dfSearchRadius > 0 )
-    {
-        if( dfRadius1 > 0 )
-            dfSearchRadius = poOptions->dfRadius1;
-        CPLRectObj sAoi;
-        while( dfSearchRadius > 0 )
-        {
-            sAoi.minx = dfXPoint - dfSearchRadius;
-            sAoi.miny = dfYPoint - dfSearchRadius;
-            sAoi.maxx = dfXPoint + dfSearchRadius;
-            sAoi.maxy = dfYPoint + dfSearchRadius;
-            int nFeatureCount = 0;
-            GDALGridPoint** papsPoints = reinterpret_cast<GDALGridPoint **>(
-                    CPLQuadTreeSearch(hQuadTree, &sAoi, &nFeatureCount) );
-            if( nFeatureCount != 0 )
-            {
-                if( dfRadius1 > 0 )
-                    dfNearestR = dfRadius1;
-                for( int k = 0; k < nFeatureCount; k++)
-                {
-                    const int idx = papsPoints[k]->i;
-                    const double dfRX = padfX[idx] - dfXPoint;
-                    const double dfRY = padfY[idx] - dfYPoint;
-
-                    const double dfR2 = dfRX * dfRX + dfRY * dfRY;
-                    if( dfR2 <= dfNearestR )
-                    {
-                        dfNearestR = dfR2;
-                        dfNearestValue = padfZ[idx];
-                    }
-                }
-
-                CPLFree(papsPoints);
-                break;
-            }
 
-            CPLFree(papsPoints);
-            if( dfRadius1 > 0 )
-                break;
-            dfSearchRadius *= 2;
-#if DEBUG_VERBOSE
-            CPLDebug(
-                "GDAL_GRID", "Increasing search radius to %.16g",
-                dfSearchRadius);
-#endif
-        }
+    if( psExtraParams != nullptr && psExtraParams->poKDTree != nullptr &&
+        dfRadius1 == dfRadius2 )
+    {
+        // Search circle, or no search area at all.
+        std::vector<std::pair<double, GUInt32> > asLocalNeighbours;
+        std::vector<std::pair<double, GUInt32> > &asNeighbours =
+            psExtraParams->psKDTreeBuffers ?
+            psExtraParams->psKDTreeBuffers->asNeighbours : asLocalNeighbours;
+        psExtraParams->poKDTree->SearchNearest(
+            dfXPoint, dfYPoint, 1,
+            dfRadius1 > 0 ? dfRadius1 :
+                            std::numeric_limits<double>::infinity(),
+            asNeighbours );
+        if( !asNeighbours.empty() )
+            dfNearestValue = padfZ[asNeighbours[0].second];
     }
     else
     {
-        while( i < nPoints )
+        // Nearest distance will be initialized with the distance to the first
+        // point in array.
+        double dfNearestR = std::numeric_limits<double>::max();
+
+        std::vector<GUInt32> anLocalPoints;
+        const GUInt32 *panPoints = nullptr;
+        GUInt32 nCandidates = nPoints;
+        const bool bIndexed =
+            GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                                   poOptions->dfRadius1, poOptions->dfRadius2,
+                                   dfXPoint, dfYPoint,
+                                   &panPoints, &nCandidates );
+
+        for( GUInt32 k = 0; k < nCandidates; k++ )
         {
+            const GUInt32 i = bIndexed ? panPoints[k] : k;
             double dfRX = padfX[i] - dfXPoint;
             double dfRY = padfY[i] - dfYPoint;
 
@@ -734,8 +1010,6 @@ GDALGridNearestNeighbor( const void *poOptionsIn, GUInt32 nPoints,
                     dfNearestValue = padfZ[i];
                 }
             }
-
-            i++;
         }
     }
 
@@ -785,7 +1059,7 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void * hExtraParamsIn )
+                           void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -805,11 +1079,21 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfMinimumValue=0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -836,8 +1120,6 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints || n == 0 )
@@ -883,7 +1165,7 @@ GDALGridDataMetricMinimum( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -893,7 +1175,7 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
                            const double *padfX, const double *padfY,
                            const double *padfZ,
                            double dfXPoint, double dfYPoint, double *pdfValue,
-                           CPL_UNUSED void* hExtraParamsIn )
+                           void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -913,11 +1195,21 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfMaximumValue=0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -944,8 +1236,6 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints
@@ -993,7 +1283,7 @@ GDALGridDataMetricMaximum( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1003,7 +1293,7 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          const double *padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void * hExtraParamsIn )
+                         void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1023,11 +1313,21 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
 
     double dfMaximumValue = 0.0;
     double dfMinimumValue = 0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1057,8 +1357,6 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
             }
             n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints || n == 0 )
@@ -1102,7 +1400,7 @@ GDALGridDataMetricRange( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1112,7 +1410,7 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
                          const double *padfX, const double *padfY,
                          CPL_UNUSED const double * padfZ,
                          double dfXPoint, double dfYPoint, double *pdfValue,
-                         CPL_UNUSED void * hExtraParamsIn )
+                         void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1131,11 +1429,21 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff1 = bRotated ? cos(dfAngle) : 0.0;
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1153,8 +1461,6 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
         {
             n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints )
@@ -1202,7 +1508,7 @@ GDALGridDataMetricCount( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1213,7 +1519,7 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
                                    CPL_UNUSED const double * padfZ,
                                    double dfXPoint, double dfYPoint,
                                    double *pdfValue,
-                                   CPL_UNUSED void * hExtraParamsIn )
+                                   void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1233,11 +1539,21 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
     double dfAccumulator = 0.0;
-    GUInt32 i = 0;
     GUInt32 n = 0;
 
-    while( i < nPoints )
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    for( GUInt32 k = 0; k < nCandidates; k++ )
     {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
         double dfRX = padfX[i] - dfXPoint;
         double dfRY = padfY[i] - dfYPoint;
 
@@ -1256,8 +1572,6 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
             dfAccumulator += sqrt( dfRX * dfRX + dfRY * dfRY );
             n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints || n == 0 )
@@ -1307,7 +1621,7 @@ GDALGridDataMetricAverageDistance( const void *poOptionsIn, GUInt32 nPoints,
  * @param dfYPoint Y coordinate of the point to compute.
  * @param pdfValue Pointer to variable where the computed grid node value
  * will be returned.
- * @param hExtraParamsIn extra parameters (unused)
+ * @param hExtraParamsIn extra parameters.
  *
  * @return CE_None on success or CE_Failure if something goes wrong.
  */
@@ -1318,7 +1632,7 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
                                       CPL_UNUSED const double * padfZ,
                                       double dfXPoint, double dfYPoint,
                                       double *pdfValue,
-                                      CPL_UNUSED void * hExtraParamsIn )
+                                      void * hExtraParamsIn )
 {
     // TODO: For optimization purposes pre-computed parameters should be moved
     // out of this routine to the calling function.
@@ -1336,59 +1650,54 @@ GDALGridDataMetricAverageDistancePts( const void *poOptionsIn, GUInt32 nPoints,
     const double dfCoeff1 = bRotated ? cos(dfAngle) : 0.0;
     const double dfCoeff2 = bRotated ? sin(dfAngle) : 0.0;
 
-    double dfAccumulator = 0.0;
-    GUInt32 i = 0;
-    GUInt32 n = 0;
-
-    // Search for the first point within the search ellipse.
-    while( i < nPoints - 1 )
-    {
-        double dfRX1 = padfX[i] - dfXPoint;
-        double dfRY1 = padfY[i] - dfYPoint;
+    // Only the points of the circle around the search ellipse, if they
+    // are indexed.
+    std::vector<GUInt32> anLocalPoints;
+    const GUInt32 *panPoints = nullptr;
+    GUInt32 nCandidates = nPoints;
+    const bool bIndexed =
+        GDALGridSearchEllipse( hExtraParamsIn, anLocalPoints,
+                               poOptions->dfRadius1, poOptions->dfRadius2,
+                               dfXPoint, dfYPoint, &panPoints, &nCandidates );
+
+    // Collect the points within the search ellipse first, so that the
+    // distances between them are computed only once.
+    std::vector<GUInt32> anInside;
+    for( GUInt32 k = 0; k < nCandidates; k++ )
+    {
+        const GUInt32 i = bIndexed ? panPoints[k] : k;
+        double dfRX = padfX[i] - dfXPoint;
+        double dfRY = padfY[i] - dfYPoint;
 
         if( bRotated )
         {
-            const double dfRXRotated = dfRX1 * dfCoeff1 + dfRY1 * dfCoeff2;
-            const double dfRYRotated = dfRY1 * dfCoeff1 - dfRX1 * dfCoeff2;
+            const double dfRXRotated = dfRX * dfCoeff1 + dfRY * dfCoeff2;
+            const double dfRYRotated = dfRY * dfCoeff1 - dfRX * dfCoeff2;
 
-            dfRX1 = dfRXRotated;
-            dfRY1 = dfRYRotated;
+            dfRX = dfRXRotated;
+            dfRY = dfRYRotated;
         }
 
         // Is this point located inside the search ellipse?
-        if( dfRadius2 * dfRX1 * dfRX1 + dfRadius1 * dfRY1 * dfRY1 <= dfR12 )
-        {
-            // Search all the remaining points within the ellipse and compute
-            // distances between them and the first point.
-            for( GUInt32 j = i + 1; j < nPoints; j++ )
-            {
-                double dfRX2 = padfX[j] - dfXPoint;
-                double dfRY2 = padfY[j] - dfYPoint;
-
-                if( bRotated )
-                {
-                    const double dfRXRotated =
-                        dfRX2 * dfCoeff1 + dfRY2 * dfCoeff2;
-                    const double dfRYRotated =
-                        dfRY2 * dfCoeff1 - dfRX2 * dfCoeff2;
+        if( dfRadius2 * dfRX * dfRX + dfRadius1 * dfRY * dfRY <= dfR12 )
+            anInside.push_back( i );
+    }
 
-                    dfRX2 = dfRXRotated;
-                    dfRY2 = dfRYRotated;
-                }
+    double dfAccumulator = 0.0;
+    GUInt32 n = 0;
 
-                if( dfRadius2 * dfRX2 * dfRX2 + dfRadius1 * dfRY2 * dfRY2
-                    <= dfR12 )
-                {
-                    const double dfRX = padfX[j] - padfX[i];
-                    const double dfRY = padfY[j] - padfY[i];
+    for( size_t k1 = 0; k1 + 1 < anInside.size(); k1++ )
+    {
+        const GUInt32 i = anInside[k1];
+        for( size_t k2 = k1 + 1; k2 < anInside.size(); k2++ )
+        {
+            const GUInt32 j = anInside[k2];
+            const double dfRX = padfX[j] - padfX[i];
+            const double dfRY = padfY[j] - padfY[i];
 
-                    dfAccumulator += sqrt( dfRX * dfRX + dfRY * dfRY );
-                    n++;
-                }
-            }
+            dfAccumulator += sqrt( dfRX * dfRX + dfRY * dfRY );
+            n++;
         }
-
-        i++;
     }
 
     if( n < poOptions->nMinPoints || n == 0 )
@@ -1613,8 +1922,10 @@ static void GDALGridJobProcess( void* user_data )
     const void *poOptions = psJob->poOptions;
     GDALGridFunction pfnGDALGridMethod = psJob->pfnGDALGridMethod;
     // Have a local copy of sExtraParameters since we want to modify
-    // nInitialFacetIdx.
+    // nInitialFacetIdx, and to give the job its own search buffers.
     GDALGridExtraParameters sExtraParameters = *psJob->psExtraParameters;
+    GDALGridKDTreeBuffers sKDTreeBuffers;
+    sExtraParameters.psKDTreeBuffers = &sKDTreeBuffers;
     const GDALDataType eType = psJob->eType;
 
     const int nDataTypeSize = GDALGetDataTypeSizeBytes(eType);
@@ -1655,6 +1966,17 @@ static void GDALGridJobProcess( void* user_data )
     CPLFree(padfValues);
 }
 
+/************************************************************************/
+/*                  GDALGridMetricsHasSearchEllipse()                   */
+/************************************************************************/
+
+static bool GDALGridMetricsHasSearchEllipse( const void *poOptions )
+{
+    const GDALGridDataMetricsOptions * const poMetrics =
+        static_cast<const GDALGridDataMetricsOptions *>(poOptions);
+    return poMetrics->dfRadius1 > 0.0 && poMetrics->dfRadius2 > 0.0;
+}
+
 /************************************************************************/
 /*                        GDALGridContextCreate()                       */
 /************************************************************************/
@@ -1666,8 +1988,7 @@ struct GDALGridContext
     GDALGridFunction    pfnGDALGridMethod;
 
     GUInt32             nPoints;
-    GDALGridPoint      *pasGridPoints;
-    GDALGridXYArrays    sXYArrays;
+    GDALGridKDTree     *poKDTree;
 
     GDALGridExtraParameters sExtraParameters;
     double*             padfX;
@@ -1678,7 +1999,7 @@ struct GDALGridContext
     CPLWorkerThreadPool *poWorkerThreadPool;
 };
 
-static void GDALGridContextCreateQuadTree( GDALGridContext* psContext );
+static bool GDALGridContextCreateKDTree( GDALGridContext* psContext );
 
 /**
  * Creates a context to do regular gridding from the scattered data.
@@ -1699,6 +2020,10 @@ static void GDALGridContextCreateQuadTree( GDALGridContext* psContext );
  * instruction set. This can be disabled by setting the GDAL_USE_AVX
  * configuration option to NO.
  *
+ * When the algorithm only considers the points within a search ellipse or
+ * radius, or the nearest points, these are indexed in a kd-tree shared by all
+ * the threads, so that only the points close to each grid node are examined.
+ *
  * It is possible to set the GDAL_NUM_THREADS
  * configuration option to parallelize the processing. The value to set is
  * the number of worker threads, or ALL_CPUS to use all the cores/CPUs of the
@@ -1732,7 +2057,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
     CPLAssert( padfX );
     CPLAssert( padfY );
     CPLAssert( padfZ );
-    bool bCreateQuadTree = false;
+    bool bCreateKDTree = false;
 
     // Starting address aligned on 32-byte boundary for AVX.
     float* pafXAligned = nullptr;
@@ -1850,6 +2175,8 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             else
             {
                 pfnGDALGridMethod = GDALGridInverseDistanceToAPower;
+                bCreateKDTree = poPower->dfRadius1 > 0.0 &&
+                                poPower->dfRadius2 > 0.0;
             }
             break;
         }
@@ -1862,7 +2189,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                        GDALGridInverseDistanceToAPowerNearestNeighborOptions));
 
             pfnGDALGridMethod = GDALGridInverseDistanceToAPowerNearestNeighbor;
-            bCreateQuadTree = TRUE;
+            bCreateKDTree = true;
             break;
         }
         case GGA_MovingAverage:
@@ -1873,6 +2200,11 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                    sizeof(GDALGridMovingAverageOptions));
 
             pfnGDALGridMethod = GDALGridMovingAverage;
+            bCreateKDTree =
+                static_cast<const GDALGridMovingAverageOptions *>(
+                    poOptions)->dfRadius1 > 0.0 &&
+                static_cast<const GDALGridMovingAverageOptions *>(
+                    poOptions)->dfRadius2 > 0.0;
             break;
         }
         case GGA_NearestNeighbor:
@@ -1882,9 +2214,11 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
                    sizeof(GDALGridNearestNeighborOptions));
 
             pfnGDALGridMethod = GDALGridNearestNeighbor;
-            bCreateQuadTree = (nPoints > 100 &&
-                static_cast<const GDALGridNearestNeighborOptions *>(poOptions)->dfRadius1 ==
-                static_cast<const GDALGridNearestNeighborOptions *>(poOptions)->dfRadius2);
+            const GDALGridNearestNeighborOptions * const poNeighbour =
+                static_cast<const GDALGridNearestNeighborOptions *>(poOptions);
+            bCreateKDTree = poNeighbour->dfRadius1 == poNeighbour->dfRadius2 ||
+                            (poNeighbour->dfRadius1 > 0.0 &&
+                             poNeighbour->dfRadius2 > 0.0);
             break;
         }
         case GGA_MetricMinimum:
@@ -1893,6 +2227,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMinimum;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_MetricMaximum:
@@ -1901,6 +2236,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricMaximum;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_MetricRange:
@@ -1909,6 +2245,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricRange;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_MetricCount:
@@ -1917,6 +2254,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricCount;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_MetricAverageDistance:
@@ -1925,6 +2263,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistance;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_MetricAverageDistancePts:
@@ -1933,6 +2272,7 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
             memcpy(poOptionsNew, poOptions, sizeof(GDALGridDataMetricsOptions));
 
             pfnGDALGridMethod = GDALGridDataMetricAverageDistancePts;
+            bCreateKDTree = GDALGridMetricsHasSearchEllipse(poOptions);
             break;
         }
         case GGA_Linear:
@@ -1978,11 +2318,9 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
     psContext->poOptions = poOptionsNew;
     psContext->pfnGDALGridMethod = pfnGDALGridMethod;
     psContext->nPoints = nPoints;
-    psContext->pasGridPoints = nullptr;
-    psContext->sXYArrays.padfX = padfX;
-    psContext->sXYArrays.padfY = padfY;
-    psContext->sExtraParameters.hQuadTree = nullptr;
-    psContext->sExtraParameters.dfInitialSearchRadius = 0.0;
+    psContext->poKDTree = nullptr;
+    psContext->sExtraParameters.poKDTree = nullptr;
+    psContext->sExtraParameters.psKDTreeBuffers = nullptr;
     psContext->sExtraParameters.pafX = pafXAligned;
     psContext->sExtraParameters.pafY = pafYAligned;
     psContext->sExtraParameters.pafZ = pafZAligned;
@@ -1995,11 +2333,12 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
         pafXAligned ? false : !bCallerWillKeepPointArraysAlive;
 
 /* -------------------------------------------------------------------- */
-/*  Create quadtree if requested and possible.                          */
+/*  Index the points if the algorithm searches them around the nodes.   */
 /* -------------------------------------------------------------------- */
-    if( bCreateQuadTree )
+    if( bCreateKDTree && !GDALGridContextCreateKDTree(psContext) )
     {
-        GDALGridContextCreateQuadTree(psContext);
+        GDALGridContextFree(psContext);
+        return nullptr;
     }
 
     /* -------------------------------------------------------------------- */
@@ -2061,50 +2400,26 @@ GDALGridContextCreate( GDALGridAlgorithm eAlgorithm, const void *poOptions,
 }
 
 /************************************************************************/
-/*                      GDALGridContextCreateQuadTree()                 */
+/*                      GDALGridContextCreateKDTree()                   */
 /************************************************************************/
 
-void GDALGridContextCreateQuadTree( GDALGridContext* psContext )
+bool GDALGridContextCreateKDTree( GDALGridContext* psContext )
 {
-    const GUInt32 nPoints = psContext->nPoints;
-    psContext->pasGridPoints = static_cast<GDALGridPoint *>(
-            VSI_MALLOC2_VERBOSE(nPoints, sizeof(GDALGridPoint)) );
-    if( psContext->pasGridPoints != nullptr )
-    {
-        const double * const padfX = psContext->padfX;
-        const double * const padfY = psContext->padfY;
-
-        // Determine point extents.
-        CPLRectObj sRect;
-        sRect.minx = padfX[0];
-        sRect.miny = padfY[0];
-        sRect.maxx = padfX[0];
-        sRect.maxy = padfY[0];
-        for( GUInt32 i = 1; i < nPoints; i++ )
-        {
-            if( padfX[i] < sRect.minx ) sRect.minx = padfX[i];
-            if( padfY[i] < sRect.miny ) sRect.miny = padfY[i];
-            if( padfX[i] > sRect.maxx ) sRect.maxx = padfX[i];
-            if( padfY[i] > sRect.maxy ) sRect.maxy = padfY[i];
-        }
-
-        // Initial value for search radius is the typical dimension of a
-        // "pixel" of the point array (assuming rather uniform distribution).
-        psContext->sExtraParameters.dfInitialSearchRadius =
-            sqrt((sRect.maxx - sRect.minx) *
-                 (sRect.maxy - sRect.miny) / nPoints);
-
-        psContext->sExtraParameters.hQuadTree =
-            CPLQuadTreeCreate(&sRect, GDALGridGetPointBounds );
-
-        for( GUInt32 i = 0; i < nPoints; i++ )
-        {
-            psContext->pasGridPoints[i].psXYArrays = &(psContext->sXYArrays);
-            psContext->pasGridPoints[i].i = i;
-            CPLQuadTreeInsert(psContext->sExtraParameters.hQuadTree,
-                                psContext->pasGridPoints + i);
-        }
+    GDALGridKDTree *poKDTree = new (std::nothrow) GDALGridKDTree();
+    if( poKDTree == nullptr ||
+        !poKDTree->Build( psContext->nPoints,
+                          psContext->padfX, psContext->padfY ) )
+    {
+        if( poKDTree == nullptr )
+            CPLError( CE_Failure, CPLE_OutOfMemory,
+                      "Cannot allocate the index of the points" );
+        delete poKDTree;
+        return false;
     }
+
+    psContext->poKDTree = poKDTree;
+    psContext->sExtraParameters.poKDTree = poKDTree;
+    return true;
 }
 
 /************************************************************************/
@@ -2123,9 +2438,7 @@ void GDALGridContextFree( GDALGridContext* psContext )
     if( psContext )
     {
         CPLFree( psContext->poOptions );
-        CPLFree( psContext->pasGridPoints );
-        if( psContext->sExtraParameters.hQuadTree != nullptr )
-            CPLQuadTreeDestroy( psContext->sExtraParameters.hQuadTree );
+        delete psContext->poKDTree;
         if( psContext->bFreePadfXYZArrays )
         {
             CPLFree(psContext->padfX);
@@ -2195,7 +2508,7 @@ CPLErr GDALGridContextProcess(
     // by sampling along the edges.  If all points on edges are within
     // triangles, then interior points will also be.
     if( psContext->eAlgorithm == GGA_Linear &&
-        psContext->sExtraParameters.hQuadTree == nullptr )
+        psContext->poKDTree == nullptr )
     {
         bool bNeedNearest = false;
         int nStartLeft = 0;
@@ -2253,7 +2566,8 @@ CPLErr GDALGridContextProcess(
         if( bNeedNearest )
         {
             CPLDebug("GDAL_GRID", "Will need nearest neighbour");
-            GDALGridContextCreateQuadTree(psContext);
+            if( !GDALGridContextCreateKDTree(psContext) )
+                return CE_Failure;
         }
     }
 
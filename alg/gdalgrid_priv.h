@@ -31,26 +31,17 @@
 #define GDALGRID_PRIV_H
 
 #include "cpl_error.h"
-#include "cpl_quad_tree.h"
 
 //! @cond Doxygen_Suppress
 
-typedef struct
-{
-    const double* padfX;
-    const double* padfY;
-} GDALGridXYArrays;
-
-typedef struct
-{
-    GDALGridXYArrays* psXYArrays;
-    int               i;
-} GDALGridPoint;
+// Point index of gdalgrid.cpp, and per-thread buffers for its searches.
+class GDALGridKDTree;
+struct GDALGridKDTreeBuffers;
 
 typedef struct
 {
-    CPLQuadTree* hQuadTree;
-    double       dfInitialSearchRadius;
+    const GDALGridKDTree*  poKDTree;
+    GDALGridKDTreeBuffers* psKDTreeBuffers;
     float *pafX; // Aligned to be usable with AVX
     float *pafY;
     float *pafZ;
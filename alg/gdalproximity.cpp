@@ -34,21 +34,148 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <limits>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
+#include "gdal_alg_priv.h"
 
 CPL_CVSID("$Id: gdalproximity.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 2017-12-11 19:08:47Z Even Rouault $")
 
-static CPLErr
-ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
-                      int bForward, int iLine, int nXSize, double nMaxDist,
-                      float *pafProximity, double *pdfSrcNoDataValue,
-                      int nTargetValues, int *panTargetValues );
+/************************************************************************/
+/*                        UpdateColumnDistance()                        */
+/*                                                                      */
+/*      Returns the vertical distance of a pixel to the nearest target  */
+/*      in its column, on the side already scanned, given that of the   */
+/*      previously scanned pixel.  -1 means none within dfMaxDist.      */
+/************************************************************************/
+
+static int UpdateColumnDistance( int nPrevDist, GInt32 nValue,
+                                 double dfMaxDist,
+                                 int nTargetValues,
+                                 const int *panTargetValues )
+{
+    if( nTargetValues == 0 )
+    {
+        if( nValue != 0 )
+            return 0;
+    }
+    else
+    {
+        for( int i = 0; i < nTargetValues; i++ )
+        {
+            if( nValue == panTargetValues[i] )
+                return 0;
+        }
+    }
+
+    if( nPrevDist < 0 || nPrevDist + 1 > dfMaxDist )
+        return -1;
+    return nPrevDist + 1;
+}
+
+/************************************************************************/
+/*                          ProcessLineDistance()                       */
+/*                                                                      */
+/*      Computes the exact squared distance of each pixel of a line to  */
+/*      the nearest target, from the squared vertical distances to the  */
+/*      nearest target in each column (negative if none).  This is the */
+/*      lower envelope of the parabolas rooted at each column, as in    */
+/*      Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled    */
+/*      Functions", and is linear in the line width.                    */
+/************************************************************************/
+
+static void ProcessLineDistance( const double *padfColDistSq, int nXSize,
+                                 int *panParabola, double *padfBoundary,
+                                 double *padfDistSq )
+{
+    // Build the lower envelope: panParabola[0..k] are the columns of the
+    // parabolas it is made of, and parabola k is the lowest one between
+    // padfBoundary[k] and padfBoundary[k+1].
+    int k = -1;
+    for( int q = 0; q < nXSize; q++ )
+    {
+        const double dfQ = padfColDistSq[q];
+        if( dfQ < 0.0 )
+            continue;
+        if( k < 0 )
+        {
+            k = 0;
+            panParabola[0] = q;
+            padfBoundary[0] = -std::numeric_limits<double>::infinity();
+            padfBoundary[1] = std::numeric_limits<double>::infinity();
+            continue;
+        }
+
+        double dfS = 0.0;
+        while( true )
+        {
+            const int p = panParabola[k];
+            dfS = ((dfQ + static_cast<double>(q) * q) -
+                   (padfColDistSq[p] + static_cast<double>(p) * p)) /
+                  (2.0 * (q - p));
+            if( dfS > padfBoundary[k] )
+                break;
+            k--;
+        }
+        k++;
+        panParabola[k] = q;
+        padfBoundary[k] = dfS;
+        padfBoundary[k+1] = std::numeric_limits<double>::infinity();
+    }
+
+    if( k < 0 )
+    {
+        for( int q = 0; q < nXSize; q++ )
+            padfDistSq[q] = -1.0;
+        return;
+    }
+
+    // Sample it.
+    k = 0;
+    for( int q = 0; q < nXSize; q++ )
+    {
+        while( padfBoundary[k+1] < q )
+            k++;
+        const double dfDX = static_cast<double>(q - panParabola[k]);
+        padfDistSq[q] = dfDX * dfDX + padfColDistSq[panParabola[k]];
+    }
+}
+
+/************************************************************************/
+/*                         GDALProximityJobFunc()                       */
+/************************************************************************/
+
+namespace {
+struct GDALProximityJob
+{
+    int           nXSize;
+    int           nLines;
+    const double *padfColDistSq;
+    double       *padfDistSq;
+};
+}  // namespace
+
+static void GDALProximityJobFunc( void *pData )
+{
+    GDALProximityJob *psJob = static_cast<GDALProximityJob *>(pData);
+    std::vector<int> anParabola(psJob->nXSize);
+    std::vector<double> adfBoundary(psJob->nXSize + 1);
+
+    for( int iLine = 0; iLine < psJob->nLines; iLine++ )
+    {
+        const size_t nOffset = static_cast<size_t>(iLine) * psJob->nXSize;
+        ProcessLineDistance( psJob->padfColDistSq + nOffset, psJob->nXSize,
+                             &anParabola[0], &adfBoundary[0],
+                             psJob->padfDistSq + nOffset );
+    }
+}
 
 /************************************************************************/
 /*                        GDALComputeProximity()                        */
@@ -106,6 +233,19 @@ the proximity output.
 
 If this option is set, all pixels within the MAXDIST threadhold are
 set to this fixed value instead of to a proximity distance.
+
+  NUM_THREADS=n
+
+(GDAL >= 2.4) Number of worker threads, or ALL_CPUS, used to compute
+the distances along each line.  Defaults to the value of the
+GDAL_NUM_THREADS configuration option, or 1.
+
+Distances are exact euclidean distances to the nearest target pixel
+center.  They are computed in two passes over the image, the first one
+computing the vertical distance to the nearest target in each column
+and the second one the distance along each line, so that the time
+spent is linear in the number of pixels whatever the value of MAXDIST,
+and the memory used is proportional to the image width.
 */
 
 CPLErr CPL_STDCALL
@@ -254,9 +394,11 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      We need a signed type for the working proximity values kept     */
-/*      on disk.  If our proximity band is not signed, then create a    */
-/*      temporary file for this purpose.                                */
+/*      The vertical distance of each pixel to the nearest target       */
+/*      above it is kept on disk between the two passes.  This needs    */
+/*      a signed type able to hold line numbers exactly: if our         */
+/*      proximity band cannot, then create a temporary file for this    */
+/*      purpose.                                                        */
 /* -------------------------------------------------------------------- */
     GDALRasterBandH hWorkProximityBand = hProximityBand;
     GDALDatasetH hWorkProximityDS = nullptr;
@@ -265,14 +407,20 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 
     // TODO(schwehr): Localize after removing gotos.
     float *pafProximity = nullptr;
-    int *panNearX = nullptr;
-    int *panNearY = nullptr;
     GInt32 *panSrcScanline = nullptr;
+    int *panNearAbove = nullptr;
+    int *panNearBelow = nullptr;
+    double *padfColDistSq = nullptr;
+    double *padfDistSq = nullptr;
+    CPLWorkerThreadPool *poThreadPool = nullptr;
+    std::vector<GDALProximityJob> asJobs;
+    int nThreads = 1;
+    int nBlockLines = 1;
     bool bTempFileAlreadyDeleted = false;
 
-    if( eProxType == GDT_Byte
-        || eProxType == GDT_UInt16
-        || eProxType == GDT_UInt32 )
+    if( eProxType != GDT_Int32
+        && eProxType != GDT_Float32
+        && eProxType != GDT_Float64 )
     {
         GDALDriverH hDriver = GDALGetDriverByName("GTiff");
         if( hDriver == nullptr )
@@ -299,67 +447,80 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Allocate buffer for two scanlines of distances as floats        */
-/*      (the current and last line).                                    */
+/*      Lines are processed in blocks of about one million pixels.      */
+/*      The horizontal pass of the lines of a block is shared between   */
+/*      the worker threads, if any.                                     */
 /* -------------------------------------------------------------------- */
-    pafProximity =
-        static_cast<float *>(VSI_MALLOC2_VERBOSE(sizeof(float), nXSize));
-    panNearX =
+    nThreads =
+        CPLGetNumThreads(CSLFetchNameValue(papszOptions, "NUM_THREADS"));
+    nBlockLines = GDALGetStripHeight(nXSize, nYSize, nThreads);
+
+    if( nBlockLines > 1 )
+        poThreadPool = CPLCreateWorkerThreadPool(nThreads);
+
+    pafProximity = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(sizeof(float), nXSize, nBlockLines));
+    panSrcScanline = static_cast<GInt32 *>(
+        VSI_MALLOC3_VERBOSE(sizeof(GInt32), nXSize, nBlockLines));
+    panNearAbove =
         static_cast<int *>(VSI_MALLOC2_VERBOSE(sizeof(int), nXSize));
-    panNearY =
+    panNearBelow =
         static_cast<int *>(VSI_MALLOC2_VERBOSE(sizeof(int), nXSize));
-    panSrcScanline =
-        static_cast<GInt32 *>(VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
+    padfColDistSq = static_cast<double *>(
+        VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nBlockLines));
+    padfDistSq = static_cast<double *>(
+        VSI_MALLOC3_VERBOSE(sizeof(double), nXSize, nBlockLines));
 
     if( pafProximity == nullptr
-        || panNearX == nullptr
-        || panNearY == nullptr
-        || panSrcScanline == nullptr)
+        || panSrcScanline == nullptr
+        || panNearAbove == nullptr
+        || panNearBelow == nullptr
+        || padfColDistSq == nullptr
+        || padfDistSq == nullptr )
     {
         eErr = CE_Failure;
         goto end;
     }
 
 /* -------------------------------------------------------------------- */
-/*      Loop from top to bottom of the image.                           */
+/*      Loop from top to bottom of the image, computing the vertical    */
+/*      distance to the nearest target above each pixel (-1 if there    */
+/*      is none within MAXDIST).                                        */
 /* -------------------------------------------------------------------- */
-
     for( int i = 0; i < nXSize; i++ )
-    {
-        panNearX[i] = -1;
-        panNearY[i] = -1;
-    }
+        panNearAbove[i] = -1;
 
-    for( int iLine = 0; eErr == CE_None && iLine < nYSize; iLine++ )
+    for( int iBlock = 0; eErr == CE_None && iBlock < nYSize;
+         iBlock += nBlockLines )
     {
+        const int nLines = std::min(nBlockLines, nYSize - iBlock);
+
         // Read for target values.
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
-                             panSrcScanline, nXSize, 1, GDT_Int32, 0, 0 );
+        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iBlock, nXSize, nLines,
+                             panSrcScanline, nXSize, nLines,
+                             GDT_Int32, 0, 0 );
         if( eErr != CE_None )
             break;
 
-        for( int i = 0; i < nXSize; i++ )
-            pafProximity[i] = -1.0;
-
-        // Left to right.
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              TRUE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
-
-        // Right to Left.
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              FALSE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
+        for( size_t i = 0; i < static_cast<size_t>(nXSize) * nLines; i++ )
+        {
+            const int iPixel = static_cast<int>(i % nXSize);
+            panNearAbove[iPixel] =
+                UpdateColumnDistance( panNearAbove[iPixel],
+                                      panSrcScanline[i], dfMaxDist,
+                                      nTargetValues, panTargetValues );
+            pafProximity[i] = static_cast<float>(panNearAbove[iPixel]);
+        }
 
         // Write out results.
         eErr =
-            GDALRasterIO( hWorkProximityBand, GF_Write, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
-
+            GDALRasterIO( hWorkProximityBand, GF_Write, 0, iBlock,
+                          nXSize, nLines, pafProximity, nXSize, nLines,
+                          GDT_Float32, 0, 0 );
         if( eErr != CE_None )
             break;
 
-        if( !pfnProgress( 0.5 * (iLine+1) / static_cast<double>(nYSize),
+        if( !pfnProgress( 0.5 * (iBlock + nLines) / static_cast<double>(nYSize),
                           "", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -368,66 +529,111 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Loop from bottom to top of the image.                           */
+/*      Loop from bottom to top of the image.  Once the nearest target  */
+/*      below is known, the vertical distance to the nearest target in */
+/*      the column is final, and the exact distance can be computed     */
+/*      along each line.                                                */
 /* -------------------------------------------------------------------- */
     for( int i = 0; i < nXSize; i++ )
-    {
-        panNearX[i] = -1;
-        panNearY[i] = -1;
-    }
+        panNearBelow[i] = -1;
 
-    for( int iLine = nYSize-1; eErr == CE_None && iLine >= 0; iLine-- )
+    for( int iBlockEnd = nYSize; eErr == CE_None && iBlockEnd > 0;
+         iBlockEnd -= nBlockLines )
     {
-        // Read first pass proximity.
-        eErr =
-            GDALRasterIO( hWorkProximityBand, GF_Read, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
+        const int iBlock = std::max(0, iBlockEnd - nBlockLines);
+        const int nLines = iBlockEnd - iBlock;
 
+        // Read first pass distances.
+        eErr =
+            GDALRasterIO( hWorkProximityBand, GF_Read, 0, iBlock,
+                          nXSize, nLines, pafProximity, nXSize, nLines,
+                          GDT_Float32, 0, 0 );
         if( eErr != CE_None )
             break;
 
         // Read pixel values.
-
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iLine, nXSize, 1,
-                             panSrcScanline, nXSize, 1, GDT_Int32, 0, 0 );
+        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iBlock, nXSize, nLines,
+                             panSrcScanline, nXSize, nLines,
+                             GDT_Int32, 0, 0 );
         if( eErr != CE_None )
             break;
 
-        // Right to left.
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              FALSE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
+        for( int iLine = nLines - 1; iLine >= 0; iLine-- )
+        {
+            const size_t nOffset = static_cast<size_t>(iLine) * nXSize;
+            for( int i = 0; i < nXSize; i++ )
+            {
+                panNearBelow[i] =
+                    UpdateColumnDistance( panNearBelow[i],
+                                          panSrcScanline[nOffset + i],
+                                          dfMaxDist,
+                                          nTargetValues, panTargetValues );
+                const int nAbove = static_cast<int>(pafProximity[nOffset + i]);
+                int nNear = panNearBelow[i];
+                if( nAbove >= 0 && (nNear < 0 || nAbove < nNear) )
+                    nNear = nAbove;
+                padfColDistSq[nOffset + i] =
+                    nNear < 0 ? -1.0 : static_cast<double>(nNear) * nNear;
+            }
+        }
 
-        // Left to right.
-        ProcessProximityLine( panSrcScanline, panNearX, panNearY,
-                              TRUE, iLine, nXSize, dfMaxDist, pafProximity,
-                              pdfSrcNoData, nTargetValues, panTargetValues );
+        // Exact distances along each line.
+        const int nJobs = std::min(nThreads, nLines);
+        asJobs.resize(nJobs);
+        std::vector<void*> apJobs;
+        for( int iJob = 0; iJob < nJobs; iJob++ )
+        {
+            const int iFirstLine =
+                static_cast<int>(static_cast<GIntBig>(nLines) * iJob / nJobs);
+            const int iLastLine = static_cast<int>(
+                static_cast<GIntBig>(nLines) * (iJob + 1) / nJobs);
+            const size_t nOffset = static_cast<size_t>(iFirstLine) * nXSize;
+            asJobs[iJob].nXSize = nXSize;
+            asJobs[iJob].nLines = iLastLine - iFirstLine;
+            asJobs[iJob].padfColDistSq = padfColDistSq + nOffset;
+            asJobs[iJob].padfDistSq = padfDistSq + nOffset;
+            apJobs.push_back(&asJobs[iJob]);
+        }
+        if( poThreadPool != nullptr && nJobs > 1 )
+        {
+            poThreadPool->SubmitJobs(GDALProximityJobFunc, apJobs);
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( int iJob = 0; iJob < nJobs; iJob++ )
+                GDALProximityJobFunc(apJobs[iJob]);
+        }
 
         // Final post processing of distances.
-        for( int i = 0; i < nXSize; i++ )
+        const double dfMaxDistSq = dfMaxDist * dfMaxDist;
+        for( size_t i = 0; i < static_cast<size_t>(nXSize) * nLines; i++ )
         {
-            if( pafProximity[i] < 0.0 )
+            const double dfDistSq = padfDistSq[i];
+            if( dfDistSq < 0.0 || dfDistSq > dfMaxDistSq )
                 pafProximity[i] = fNoDataValue;
-            else if( pafProximity[i] > 0.0 )
-            {
-                if( bFixedBufVal )
-                    pafProximity[i] = static_cast<float>( dfFixedBufVal );
-                else
-                    pafProximity[i] =
-                        static_cast<float>(pafProximity[i] * dfDistMult);
-            }
+            else if( dfDistSq == 0.0 )
+                pafProximity[i] = 0.0f;
+            else if( pdfSrcNoData != nullptr
+                     && panSrcScanline[i] == *pdfSrcNoData )
+                pafProximity[i] = fNoDataValue;
+            else if( bFixedBufVal )
+                pafProximity[i] = static_cast<float>( dfFixedBufVal );
+            else
+                pafProximity[i] =
+                    static_cast<float>(sqrt(dfDistSq) * dfDistMult);
         }
 
         // Write out results.
         eErr =
-            GDALRasterIO( hProximityBand, GF_Write, 0, iLine, nXSize, 1,
-                          pafProximity, nXSize, 1, GDT_Float32, 0, 0 );
-
+            GDALRasterIO( hProximityBand, GF_Write, 0, iBlock,
+                          nXSize, nLines, pafProximity, nXSize, nLines,
+                          GDT_Float32, 0, 0 );
         if( eErr != CE_None )
             break;
 
         if( !pfnProgress( 0.5 +
-                          0.5 * (nYSize-iLine) / static_cast<double>( nYSize ),
+                          0.5 * (nYSize-iBlock) / static_cast<double>( nYSize ),
                           "", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -439,10 +645,13 @@ GDALComputeProximity( GDALRasterBandH hSrcBand,
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
 end:
-    CPLFree( panNearX );
-    CPLFree( panNearY );
+    delete poThreadPool;
+    CPLFree( panNearAbove );
+    CPLFree( panNearBelow );
     CPLFree( panSrcScanline );
     CPLFree( pafProximity );
+    CPLFree( padfColDistSq );
+    CPLFree( padfDistSq );
     CPLFree( panTargetValues );
 
     if( hWorkProximityDS != nullptr )
@@ -457,138 +666,3 @@ end:
 
     return eErr;
 }
-
-/************************************************************************/
-/*                         SquareDistance()                             */
-/************************************************************************/
-
-static double SquareDistance(double dfX1, double dfX2,
-                             double dfY1, double dfY2)
-{
-    const double dfDX = dfX1 - dfX2;
-    const double dfDY = dfY1 - dfY2;
-    return dfDX * dfDX + dfDY * dfDY;
-}
-
-/************************************************************************/
-/*                        ProcessProximityLine()                        */
-/************************************************************************/
-
-static CPLErr
-ProcessProximityLine( GInt32 *panSrcScanline, int *panNearX, int *panNearY,
-                      int bForward, int iLine, int nXSize, double dfMaxDist,
-                      float *pafProximity, double *pdfSrcNoDataValue,
-                      int nTargetValues, int *panTargetValues )
-
-{
-    const int iStart = bForward ? 0 : nXSize - 1;
-    const int iEnd = bForward ? nXSize : -1;
-    const int iStep = bForward ? 1 : -1;
-
-    for( int iPixel = iStart; iPixel != iEnd; iPixel += iStep )
-    {
-        bool bIsTarget = false;
-
-/* -------------------------------------------------------------------- */
-/*      Is the current pixel a target pixel?                            */
-/* -------------------------------------------------------------------- */
-        if( nTargetValues == 0 )
-        {
-            bIsTarget = panSrcScanline[iPixel] != 0;
-        }
-        else
-        {
-            for( int i = 0; i < nTargetValues; i++ )
-            {
-                if( panSrcScanline[iPixel] == panTargetValues[i] )
-                    bIsTarget = TRUE;
-            }
-        }
-
-        if( bIsTarget )
-        {
-            pafProximity[iPixel] = 0.0;
-            panNearX[iPixel] = iPixel;
-            panNearY[iPixel] = iLine;
-            continue;
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the above (below)      */
-/*      pixel?                                                          */
-/* -------------------------------------------------------------------- */
-        double dfNearDistSq =
-                std::max(dfMaxDist, static_cast<double>(nXSize)) *
-                std::max(dfMaxDist, static_cast<double>(nXSize)) * 2.0;
-
-        if( panNearX[iPixel] != -1 )
-        {
-            const double dfDistSq =
-                SquareDistance(panNearX[iPixel], iPixel,
-                               panNearY[iPixel], iLine);
-
-            if( dfDistSq < dfNearDistSq )
-            {
-                dfNearDistSq = dfDistSq;
-            }
-            else
-            {
-                panNearX[iPixel] = -1;
-                panNearY[iPixel] = -1;
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the left (right)       */
-/*      pixel?                                                          */
-/* -------------------------------------------------------------------- */
-        const int iLast = iPixel - iStep;
-
-        if( iPixel != iStart && panNearX[iLast] != -1 )
-        {
-            const double dfDistSq =
-                SquareDistance(panNearX[iLast], iPixel,
-                               panNearY[iLast], iLine);
-
-            if( dfDistSq < dfNearDistSq )
-            {
-                dfNearDistSq = dfDistSq;
-                panNearX[iPixel] = panNearX[iLast];
-                panNearY[iPixel] = panNearY[iLast];
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Are we near(er) to the closest target to the topright           */
-/*      (bottom left) pixel?                                            */
-/* -------------------------------------------------------------------- */
-        const int iTR = iPixel + iStep;
-
-        if( iTR != iEnd && panNearX[iTR] != -1 )
-        {
-            const double dfDistSq =
-                SquareDistance(panNearX[iTR], iPixel,
-                               panNearY[iTR], iLine);
-
-            if( dfDistSq < dfNearDistSq )
-            {
-                dfNearDistSq = dfDistSq;
-                panNearX[iPixel] = panNearX[iTR];
-                panNearY[iPixel] = panNearY[iTR];
-            }
-        }
-
-/* -------------------------------------------------------------------- */
-/*      Update our proximity value.                                     */
-/* -------------------------------------------------------------------- */
-        if( panNearX[iPixel] != -1
-            && (pdfSrcNoDataValue == nullptr
-                || panSrcScanline[iPixel] != *pdfSrcNoDataValue)
-            && dfNearDistSq <= dfMaxDist * dfMaxDist
-            && (pafProximity[iPixel] < 0
-                || dfNearDistSq < pafProximity[iPixel] * pafProximity[iPixel]) )
-            pafProximity[iPixel] = static_cast<float>(sqrt(dfNearDistSq));
-    }
-
-    return CE_None;
-}
@@ -32,9 +32,11 @@
 #include "gdal_alg_priv.h"
 
 #include <climits>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <vector>
 #include <algorithm>
 
@@ -43,6 +45,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_api.h"
@@ -324,6 +327,83 @@ static void GDALCollectRingsFromGeometry(
     }
 }
 
+/************************************************************************/
+/*                      gvFlattenPolygonVariant()                       */
+/*                                                                      */
+/*      Polygons are filled using the variant of their first point.     */
+/*      Revert all the variants to that value so that the outline      */
+/*      burnt in ALL_TOUCHED mode matches the fill.  Should be removed  */
+/*      when the code to fill polygons more appropriately is added.     */
+/************************************************************************/
+
+static void gvFlattenPolygonVariant( OGRwkbGeometryType eFlatType,
+                                     double *padfVariant, size_t nCount )
+{
+    if( eFlatType == wkbPoint || eFlatType == wkbMultiPoint ||
+        eFlatType == wkbLineString || eFlatType == wkbMultiLineString )
+        return;
+
+    for( size_t i = 1; i < nCount; i++ )
+        padfVariant[i] = padfVariant[0];
+}
+
+/************************************************************************/
+/*                          gvRasterizeParts()                          */
+/*                                                                      */
+/*      Burn the parts of one shape, already in pixel/line coordinates  */
+/*      relative to the buffer described by psInfo.  The point arrays   */
+/*      are not modified.                                               */
+/************************************************************************/
+
+static void gvRasterizeParts( GDALRasterizeInfo *psInfo,
+                              OGRwkbGeometryType eFlatType, int bAllTouched,
+                              int nPartCount, int *panPartSize,
+                              double *padfX, double *padfY,
+                              double *padfVariant )
+{
+    switch( eFlatType )
+    {
+      case wkbPoint:
+      case wkbMultiPoint:
+        GDALdllImagePoint( psInfo->nXSize, psInfo->nYSize,
+                           nPartCount, panPartSize,
+                           padfX, padfY, padfVariant,
+                           gvBurnPoint, psInfo );
+        break;
+      case wkbLineString:
+      case wkbMultiLineString:
+      {
+          if( bAllTouched )
+              GDALdllImageLineAllTouched( psInfo->nXSize, psInfo->nYSize,
+                                          nPartCount, panPartSize,
+                                          padfX, padfY, padfVariant,
+                                          gvBurnPoint, psInfo );
+          else
+              GDALdllImageLine( psInfo->nXSize, psInfo->nYSize,
+                                nPartCount, panPartSize,
+                                padfX, padfY, padfVariant,
+                                gvBurnPoint, psInfo );
+      }
+      break;
+
+      default:
+      {
+          GDALdllImageFilledPolygon( psInfo->nXSize, psInfo->nYSize,
+                                     nPartCount, panPartSize,
+                                     padfX, padfY, padfVariant,
+                                     gvBurnScanline, psInfo );
+          // The variants were reverted to the value of the first point by
+          // gvFlattenPolygonVariant().
+          if( bAllTouched )
+              GDALdllImageLineAllTouched( psInfo->nXSize, psInfo->nYSize,
+                                          nPartCount, panPartSize,
+                                          padfX, padfY, padfVariant,
+                                          gvBurnPoint, psInfo );
+      }
+      break;
+    }
+}
+
 /************************************************************************/
 /*                       gv_rasterize_one_shape()                       */
 /************************************************************************/
@@ -387,94 +467,21 @@ gv_rasterize_one_shape( unsigned char *pabyChunkBuf, int nXOff, int nYOff,
 
 /* -------------------------------------------------------------------- */
 /*      Perform the rasterization.                                      */
-/*      According to the C++ Standard/23.2.4, elements of a vector are  */
-/*      stored in continuous memory block.                              */
 /* -------------------------------------------------------------------- */
+    if( aPartSize.empty() )
+        return;
 
-    // TODO - mloskot: Check if vectors are empty, otherwise it may
-    // lead to undefined behavior by returning non-referencable pointer.
-    // if( !aPointX.empty() )
-    //    // Fill polygon.
-    // else
-    //    // How to report this problem?
-    switch( wkbFlatten(poShape->getGeometryType()) )
-    {
-      case wkbPoint:
-      case wkbMultiPoint:
-        GDALdllImagePoint( sInfo.nXSize, nYSize,
-                           static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                           &(aPointX[0]), &(aPointY[0]),
-                           (eBurnValueSrc == GBV_UserBurnValue)?
-                           nullptr : &(aPointVariant[0]),
-                           gvBurnPoint, &sInfo );
-        break;
-      case wkbLineString:
-      case wkbMultiLineString:
-      {
-          if( bAllTouched )
-              GDALdllImageLineAllTouched( sInfo.nXSize, nYSize,
-                                          static_cast<int>(aPartSize.size()),
-                                          &(aPartSize[0]),
-                                          &(aPointX[0]), &(aPointY[0]),
-                                          (eBurnValueSrc == GBV_UserBurnValue)?
-                                          nullptr : &(aPointVariant[0]),
-                                          gvBurnPoint, &sInfo );
-          else
-              GDALdllImageLine( sInfo.nXSize, nYSize,
-                                static_cast<int>(aPartSize.size()),
-                                &(aPartSize[0]),
-                                &(aPointX[0]), &(aPointY[0]),
-                                (eBurnValueSrc == GBV_UserBurnValue)?
-                                nullptr : &(aPointVariant[0]),
-                                gvBurnPoint, &sInfo );
-      }
-      break;
+    const OGRwkbGeometryType eFlatType =
+        wkbFlatten(poShape->getGeometryType());
+    if( bAllTouched && eBurnValueSrc != GBV_UserBurnValue )
+        gvFlattenPolygonVariant( eFlatType, &(aPointVariant[0]),
+                                 aPointVariant.size() );
 
-      default:
-      {
-          GDALdllImageFilledPolygon(
-              sInfo.nXSize, nYSize,
-              static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-              &(aPointX[0]), &(aPointY[0]),
-              (eBurnValueSrc == GBV_UserBurnValue)?
-              nullptr : &(aPointVariant[0]),
-              gvBurnScanline, &sInfo );
-          if( bAllTouched )
-          {
-              // Reverting the variants to the first value because the
-              // polygon is filled using the variant from the first point of
-              // the first segment. Should be removed when the code to full
-              // polygons more appropriately is added.
-              if( eBurnValueSrc == GBV_UserBurnValue )
-              {
-                  GDALdllImageLineAllTouched(
-                      sInfo.nXSize, nYSize,
+    gvRasterizeParts( &sInfo, eFlatType, bAllTouched,
                       static_cast<int>(aPartSize.size()), &(aPartSize[0]),
                       &(aPointX[0]), &(aPointY[0]),
-                      nullptr,
-                      gvBurnPoint, &sInfo );
-              }
-              else
-              {
-                  for( unsigned int i = 0, n = 0;
-                       i < static_cast<unsigned int>(aPartSize.size());
-                       i++ )
-                  {
-                      for( int j = 0; j < aPartSize[i]; j++ )
-                          aPointVariant[n++] = aPointVariant[0];
-                  }
-
-                  GDALdllImageLineAllTouched(
-                      sInfo.nXSize, nYSize,
-                      static_cast<int>(aPartSize.size()), &(aPartSize[0]),
-                      &(aPointX[0]), &(aPointY[0]),
-                      &(aPointVariant[0]),
-                      gvBurnPoint, &sInfo );
-              }
-          }
-      }
-      break;
-    }
+                      (eBurnValueSrc == GBV_UserBurnValue)?
+                      nullptr : &(aPointVariant[0]) );
 }
 
 /************************************************************************/
@@ -566,6 +573,389 @@ static CPLErr GDALRasterizeOptions( char **papszOptions,
     return CE_None;
 }
 
+/************************************************************************/
+/*                         GDALRasterizeBatch                           */
+/************************************************************************/
+
+// A geometry of a GDALRasterizeBatch, as ranges of its arrays.
+struct GDALRasterizeShape
+{
+    OGRwkbGeometryType eFlatType;
+    int                nPartCount;
+    size_t             iFirstPart;
+    size_t             iFirstPoint;
+    size_t             nPointCount;
+    size_t             iFirstBurnValue;
+};
+
+// Geometries read from the layers, transformed into pixel/line coordinates,
+// with their burn values.  For each strip of lines of the raster, the
+// geometries whose envelope intersects it are listed in reading order.
+struct GDALRasterizeBatch
+{
+    std::vector<double>               adfX;
+    std::vector<double>               adfY;
+    std::vector<double>               adfVariant;
+    std::vector<int>                  anPartSize;
+    std::vector<double>               adfBurnValues;
+    std::vector<GDALRasterizeShape>   asShapes;
+    std::vector<std::vector<size_t> > aanStripShapes;
+
+    GIntBig                           nFeatures;
+    GIntBig                           nMemory;
+};
+
+/************************************************************************/
+/*                       GDALRasterizeBatchAdd()                        */
+/************************************************************************/
+
+static void GDALRasterizeBatchAdd( GDALRasterizeBatch &oBatch,
+                                   OGRGeometry *poShape,
+                                   const double *padfBurnValues,
+                                   int nBandCount, int bAllTouched,
+                                   GDALBurnValueSrc eBurnValueSrc,
+                                   GDALTransformerFunc pfnTransformer,
+                                   void *pTransformArg,
+                                   int nXSize, int nYSize, int nStripHeight )
+{
+    oBatch.nFeatures++;
+
+    if( poShape == nullptr || poShape->IsEmpty() )
+        return;
+
+    const size_t iFirstPart = oBatch.anPartSize.size();
+    const size_t iFirstPoint = oBatch.adfX.size();
+
+    GDALCollectRingsFromGeometry( poShape, oBatch.adfX, oBatch.adfY,
+                                  oBatch.adfVariant, oBatch.anPartSize,
+                                  eBurnValueSrc );
+
+    const size_t nPartCount = oBatch.anPartSize.size() - iFirstPart;
+    const size_t nPointCount = oBatch.adfX.size() - iFirstPoint;
+    const OGRwkbGeometryType eFlatType =
+        wkbFlatten(poShape->getGeometryType());
+
+/* -------------------------------------------------------------------- */
+/*      Transform points if needed.                                     */
+/* -------------------------------------------------------------------- */
+    if( pfnTransformer != nullptr && nPointCount > 0 )
+    {
+        int *panSuccess =
+            static_cast<int *>(CPLCalloc(sizeof(int), nPointCount));
+
+        // TODO: We need to add all appropriate error checking at some point.
+        pfnTransformer( pTransformArg, FALSE, static_cast<int>(nPointCount),
+                        &(oBatch.adfX[iFirstPoint]),
+                        &(oBatch.adfY[iFirstPoint]), nullptr, panSuccess );
+        CPLFree( panSuccess );
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Find the lines the shape may touch.  The rasterizers round      */
+/*      the coordinates in various ways, so keep one line and one       */
+/*      column of margin.  Shapes entirely outside of the raster are    */
+/*      dropped.                                                        */
+/* -------------------------------------------------------------------- */
+    double dfMinX = std::numeric_limits<double>::infinity();
+    double dfMaxX = -dfMinX;
+    double dfMinY = dfMinX;
+    double dfMaxY = -dfMinX;
+    for( size_t i = iFirstPoint; i < iFirstPoint + nPointCount; i++ )
+    {
+        dfMinX = std::min(dfMinX, oBatch.adfX[i]);
+        dfMaxX = std::max(dfMaxX, oBatch.adfX[i]);
+        dfMinY = std::min(dfMinY, oBatch.adfY[i]);
+        dfMaxY = std::max(dfMaxY, oBatch.adfY[i]);
+    }
+
+    const double dfFirstLine = std::max(0.0, floor(dfMinY) - 1);
+    const double dfLastLine = std::min(nYSize - 1.0, floor(dfMaxY) + 1);
+
+    if( nPartCount == 0 || nPointCount == 0 ||
+        !(dfFirstLine <= dfLastLine) ||
+        !(dfMaxX >= -1.0 && dfMinX <= nXSize + 1.0) )
+    {
+        oBatch.anPartSize.resize( iFirstPart );
+        oBatch.adfX.resize( iFirstPoint );
+        oBatch.adfY.resize( iFirstPoint );
+        if( eBurnValueSrc != GBV_UserBurnValue )
+            oBatch.adfVariant.resize( iFirstPoint );
+        return;
+    }
+
+    if( bAllTouched && eBurnValueSrc != GBV_UserBurnValue )
+        gvFlattenPolygonVariant( eFlatType, &(oBatch.adfVariant[iFirstPoint]),
+                                 nPointCount );
+
+/* -------------------------------------------------------------------- */
+/*      Record the shape and bin it into the strips.                    */
+/* -------------------------------------------------------------------- */
+    GDALRasterizeShape sShape;
+    sShape.eFlatType = eFlatType;
+    sShape.nPartCount = static_cast<int>(nPartCount);
+    sShape.iFirstPart = iFirstPart;
+    sShape.iFirstPoint = iFirstPoint;
+    sShape.nPointCount = nPointCount;
+    sShape.iFirstBurnValue = oBatch.adfBurnValues.size();
+
+    oBatch.adfBurnValues.insert( oBatch.adfBurnValues.end(),
+                                 padfBurnValues, padfBurnValues + nBandCount );
+
+    const size_t iShape = oBatch.asShapes.size();
+    oBatch.asShapes.push_back( sShape );
+
+    const int iFirstStrip = static_cast<int>(dfFirstLine) / nStripHeight;
+    const int iLastStrip = static_cast<int>(dfLastLine) / nStripHeight;
+    for( int iStrip = iFirstStrip; iStrip <= iLastStrip; iStrip++ )
+        oBatch.aanStripShapes[iStrip].push_back( iShape );
+
+    oBatch.nMemory +=
+        sizeof(double) * nPointCount *
+            (eBurnValueSrc != GBV_UserBurnValue ? 3 : 2) +
+        sizeof(int) * nPartCount +
+        sizeof(double) * nBandCount +
+        sizeof(GDALRasterizeShape) +
+        sizeof(size_t) * (iLastStrip - iFirstStrip + 1);
+}
+
+/************************************************************************/
+/*                       GDALRasterizeBatchClear()                      */
+/************************************************************************/
+
+static void GDALRasterizeBatchClear( GDALRasterizeBatch &oBatch )
+{
+    oBatch.adfX.clear();
+    oBatch.adfY.clear();
+    oBatch.adfVariant.clear();
+    oBatch.anPartSize.clear();
+    oBatch.adfBurnValues.clear();
+    oBatch.asShapes.clear();
+    for( size_t i = 0; i < oBatch.aanStripShapes.size(); i++ )
+        oBatch.aanStripShapes[i].clear();
+    oBatch.nFeatures = 0;
+    oBatch.nMemory = 0;
+}
+
+/************************************************************************/
+/*                        GDALRasterizeStripJob                         */
+/************************************************************************/
+
+struct GDALRasterizeStripJob
+{
+    // Read only during the jobs.
+    GDALRasterizeBatch *poBatch;
+    int                 bAllTouched;
+
+    // Strip of the batch, and chunk buffer lines it covers.  The line
+    // nYOff of the raster is the first line of sInfo.pabyChunkBuf.
+    int                 iStrip;
+    int                 nYOff;
+    GDALRasterizeInfo   sInfo;
+
+    // Scratch copy of the line coordinates of a shape.
+    std::vector<double> adfY;
+};
+
+/************************************************************************/
+/*                     GDALRasterizeStripJobFunc()                      */
+/************************************************************************/
+
+static void GDALRasterizeStripJobFunc( void *pData )
+
+{
+    GDALRasterizeStripJob *psJob = static_cast<GDALRasterizeStripJob *>(pData);
+    GDALRasterizeBatch *poBatch = psJob->poBatch;
+    const std::vector<size_t> &anShapes =
+        poBatch->aanStripShapes[psJob->iStrip];
+
+    for( size_t i = 0; i < anShapes.size(); i++ )
+    {
+        const GDALRasterizeShape &sShape = poBatch->asShapes[anShapes[i]];
+
+        psJob->adfY.resize( sShape.nPointCount );
+        for( size_t j = 0; j < sShape.nPointCount; j++ )
+            psJob->adfY[j] =
+                poBatch->adfY[sShape.iFirstPoint + j] - psJob->nYOff;
+
+        psJob->sInfo.padfBurnValue =
+            &(poBatch->adfBurnValues[sShape.iFirstBurnValue]);
+
+        gvRasterizeParts( &psJob->sInfo, sShape.eFlatType, psJob->bAllTouched,
+                          sShape.nPartCount,
+                          &(poBatch->anPartSize[sShape.iFirstPart]),
+                          &(poBatch->adfX[sShape.iFirstPoint]),
+                          &(psJob->adfY[0]),
+                          poBatch->adfVariant.empty() ? nullptr :
+                              &(poBatch->adfVariant[sShape.iFirstPoint]) );
+    }
+}
+
+/************************************************************************/
+/*                         GDALRasterizeStrips                          */
+/************************************************************************/
+
+// Division of the raster chunks into strips, and the jobs burning them.
+struct GDALRasterizeStrips
+{
+    int                                nYChunkSize;
+    int                                nStripHeight;
+    CPLWorkerThreadPool               *poThreadPool;
+    std::vector<GDALRasterizeStripJob> asJobs;
+};
+
+/************************************************************************/
+/*                       GDALRasterizeStripsInit()                      */
+/*                                                                      */
+/*      The chunks are divided into strips of about one million         */
+/*      pixels, burnt concurrently by the worker threads.  Chunks are   */
+/*      shrunk to start on a strip boundary.                            */
+/************************************************************************/
+
+static void GDALRasterizeStripsInit( GDALRasterizeStrips &oStrips,
+                                     char **papszOptions,
+                                     int nXSize, int nYSize, int nYChunkSize,
+                                     int nBandCount, GDALDataType eType,
+                                     int bAllTouched,
+                                     GDALBurnValueSrc eBurnValueSource,
+                                     GDALRasterMergeAlg eMergeAlg )
+{
+    const int nThreads =
+        CPLGetNumThreads(CSLFetchNameValue(papszOptions, "NUM_THREADS"));
+
+    oStrips.nStripHeight = GDALGetStripHeight(nXSize, nYChunkSize, 16);
+    if( nYChunkSize < nYSize )
+        nYChunkSize -= nYChunkSize % oStrips.nStripHeight;
+    oStrips.nYChunkSize = nYChunkSize;
+    const int nChunkStrips =
+        (nYChunkSize + oStrips.nStripHeight - 1) / oStrips.nStripHeight;
+
+    oStrips.poThreadPool =
+        CPLCreateWorkerThreadPool(std::min(nThreads, nChunkStrips));
+
+    oStrips.asJobs.resize(nChunkStrips);
+    for( int i = 0; i < nChunkStrips; i++ )
+    {
+        GDALRasterizeStripJob &oJob = oStrips.asJobs[i];
+        oJob.poBatch = nullptr;
+        oJob.bAllTouched = bAllTouched;
+        oJob.iStrip = 0;
+        oJob.nYOff = 0;
+        oJob.sInfo.nXSize = nXSize;
+        oJob.sInfo.nYSize = 0;
+        oJob.sInfo.nBands = nBandCount;
+        oJob.sInfo.pabyChunkBuf = nullptr;
+        oJob.sInfo.eType = eType;
+        oJob.sInfo.padfBurnValue = nullptr;
+        oJob.sInfo.eBurnValueSource = eBurnValueSource;
+        oJob.sInfo.eMergeAlg = eMergeAlg;
+    }
+}
+
+/************************************************************************/
+/*                       GDALRasterizeBatchBurn()                       */
+/*                                                                      */
+/*      Burn a batch of shapes, chunk by chunk.  The chunks without     */
+/*      any shape are not read nor written.  Within a chunk, each       */
+/*      strip is burnt by a job, concurrently if there is a thread      */
+/*      pool.  As the shapes of a strip are burnt in reading order,     */
+/*      the result does not depend on the number of threads.            */
+/************************************************************************/
+
+static CPLErr GDALRasterizeBatchBurn( GDALRasterizeBatch &oBatch,
+                                      GDALDataset *poDS,
+                                      int nBandCount, int *panBandList,
+                                      GDALDataType eType,
+                                      unsigned char *pabyChunkBuf,
+                                      GDALRasterizeStrips &oStrips,
+                                      double dfProgressStart,
+                                      double dfProgressEnd,
+                                      GDALProgressFunc pfnProgress,
+                                      void *pProgressArg )
+{
+    const int nXSize = poDS->GetRasterXSize();
+    const int nYSize = poDS->GetRasterYSize();
+    const int nYChunkSize = oStrips.nYChunkSize;
+    const int nStripHeight = oStrips.nStripHeight;
+    const size_t nLineBytes = static_cast<size_t>(nBandCount) * nXSize *
+                              GDALGetDataTypeSizeBytes(eType);
+    CPLErr eErr = CE_None;
+
+    for( int iY = 0; iY < nYSize && eErr == CE_None; iY += nYChunkSize )
+    {
+        const int nThisYChunkSize = std::min(nYChunkSize, nYSize - iY);
+        const int iFirstStrip = iY / nStripHeight;
+        const int nStrips =
+            (nThisYChunkSize + nStripHeight - 1) / nStripHeight;
+
+        bool bEmpty = true;
+        for( int i = 0; bEmpty && i < nStrips; i++ )
+            bEmpty = oBatch.aanStripShapes[iFirstStrip + i].empty();
+
+        // Only re-read image if not a single chunk is being rendered.
+        if( !bEmpty && nYChunkSize < nYSize )
+        {
+            eErr = poDS->RasterIO( GF_Read, 0, iY, nXSize, nThisYChunkSize,
+                                   pabyChunkBuf, nXSize, nThisYChunkSize,
+                                   eType, nBandCount, panBandList,
+                                   0, 0, 0, nullptr );
+            if( eErr != CE_None )
+                break;
+        }
+
+        if( !bEmpty )
+        {
+            std::vector<void*> apJobs;
+            for( int i = 0; i < nStrips; i++ )
+            {
+                GDALRasterizeStripJob &oJob = oStrips.asJobs[i];
+                const int nStripYOff = i * nStripHeight;
+                oJob.poBatch = &oBatch;
+                oJob.iStrip = iFirstStrip + i;
+                oJob.nYOff = iY + nStripYOff;
+                oJob.sInfo.nYSize =
+                    std::min(nStripHeight, nThisYChunkSize - nStripYOff);
+                oJob.sInfo.pabyChunkBuf = pabyChunkBuf + nStripYOff * nLineBytes;
+                if( !oBatch.aanStripShapes[oJob.iStrip].empty() )
+                    apJobs.push_back(&oJob);
+            }
+
+            if( oStrips.poThreadPool != nullptr && apJobs.size() > 1 )
+            {
+                oStrips.poThreadPool->SubmitJobs(GDALRasterizeStripJobFunc,
+                                                 apJobs);
+                oStrips.poThreadPool->WaitCompletion();
+            }
+            else
+            {
+                for( size_t i = 0; i < apJobs.size(); i++ )
+                    GDALRasterizeStripJobFunc(apJobs[i]);
+            }
+        }
+
+        // Only write image if not a single chunk is being rendered.
+        if( !bEmpty && nYChunkSize < nYSize )
+        {
+            eErr = poDS->RasterIO( GF_Write, 0, iY, nXSize, nThisYChunkSize,
+                                   pabyChunkBuf, nXSize, nThisYChunkSize,
+                                   eType, nBandCount, panBandList,
+                                   0, 0, 0, nullptr );
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress(dfProgressStart + (dfProgressEnd - dfProgressStart) *
+                         (iY + nThisYChunkSize) / static_cast<double>(nYSize),
+                         "", pProgressArg) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    GDALRasterizeBatchClear( oBatch );
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                      GDALRasterizeGeometries()                       */
 /************************************************************************/
@@ -620,6 +1010,10 @@ static CPLErr GDALRasterizeOptions( char **papszOptions,
  * used. Default size will be estimated based on the GDAL cache buffer size
  * using formula: cache_size_bytes/scanline_size_bytes, so the chunk will
  * not exceed the cache. Not used in OPTIM=RASTER mode.</li>
+ * <li>"NUM_THREADS": (GDAL >= 2.4) Number of worker threads, or ALL_CPUS,
+ * each one burning a strip of lines of the current chunk in OPTIM=RASTER
+ * mode.  Defaults to the value of the GDAL_NUM_THREADS configuration option,
+ * or 1.  The result does not depend on the number of threads.</li>
  * </ul>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -741,8 +1135,8 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
     {
 /* -------------------------------------------------------------------- */
 /*      Establish a chunksize to operate on.  The larger the chunk      */
-/*      size the less times we need to make a pass through all the      */
-/*      shapes.                                                         */
+/*      size the less times we need to read and write the raster for   */
+/*      each batch of shapes.                                           */
 /* -------------------------------------------------------------------- */
         const GDALDataType eType =
             poBand->GetRasterDataType() == GDT_Byte ? GDT_Byte : GDT_Float64;
@@ -765,69 +1159,83 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
         if( nYChunkSize > poDS->GetRasterYSize() )
             nYChunkSize = poDS->GetRasterYSize();
 
+        const int nXSize = poDS->GetRasterXSize();
+        const int nYSize = poDS->GetRasterYSize();
+
+        GDALRasterizeStrips oStrips;
+        GDALRasterizeStripsInit( oStrips, papszOptions, nXSize, nYSize,
+                                 nYChunkSize, nBandCount, eType, bAllTouched,
+                                 eBurnValueSource, eMergeAlg );
+        nYChunkSize = oStrips.nYChunkSize;
+
         CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines.",
-                  (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize,
+                  (nYSize + nYChunkSize - 1) / nYChunkSize,
                   nYChunkSize );
 
         pabyChunkBuf = static_cast<unsigned char *>(
             VSI_MALLOC2_VERBOSE(nYChunkSize, nScanlineBytes));
         if( pabyChunkBuf == nullptr )
         {
+            delete oStrips.poThreadPool;
             if( bNeedToFreeTransformer )
                 GDALDestroyTransformer( pTransformArg );
             return CE_Failure;
         }
 
-/* ==================================================================== */
-/*      Loop over image in designated chunks.                           */
-/* ==================================================================== */
         pfnProgress( 0.0, nullptr, pProgressArg );
 
-        for( int iY = 0;
-             iY < poDS->GetRasterYSize() && eErr == CE_None;
-             iY += nYChunkSize )
-        {
-            int nThisYChunkSize = nYChunkSize;
-            if( nThisYChunkSize + iY > poDS->GetRasterYSize() )
-                nThisYChunkSize = poDS->GetRasterYSize() - iY;
-
-            eErr =
-                poDS->RasterIO(GF_Read,
-                               0, iY, poDS->GetRasterXSize(), nThisYChunkSize,
-                               pabyChunkBuf,
-                               poDS->GetRasterXSize(), nThisYChunkSize,
-                               eType, nBandCount, panBandList,
-                               0, 0, 0, nullptr);
-            if( eErr != CE_None )
-                break;
+        // Read the image once if it is rendered in a single chunk.
+        if( nYChunkSize == nYSize )
+            eErr = poDS->RasterIO( GF_Read, 0, 0, nXSize, nYSize,
+                                   pabyChunkBuf, nXSize, nYSize,
+                                   eType, nBandCount, panBandList,
+                                   0, 0, 0, nullptr );
 
-            for( int iShape = 0; iShape < nGeomCount; iShape++ )
+/* ==================================================================== */
+/*      Transform the geometries once, binning them by strip of lines,  */
+/*      and burn them into the chunks by batches of at most the cache   */
+/*      size.                                                           */
+/* ==================================================================== */
+        GDALRasterizeBatch oBatch;
+        oBatch.aanStripShapes.resize(
+            (nYSize + oStrips.nStripHeight - 1) / oStrips.nStripHeight );
+        oBatch.nFeatures = 0;
+        oBatch.nMemory = 0;
+
+        const GIntBig nMaxBatchMemory =
+            std::max(GDALGetCacheMax64(),
+                     static_cast<GIntBig>(64 * 1024 * 1024));
+
+        int iFirstBatchShape = 0;
+        for( int iShape = 0; iShape < nGeomCount && eErr == CE_None; iShape++ )
+        {
+            GDALRasterizeBatchAdd( oBatch,
+                                   reinterpret_cast<OGRGeometry *>(
+                                                       pahGeometries[iShape]),
+                                   padfGeomBurnValue + iShape*nBandCount,
+                                   nBandCount, bAllTouched, eBurnValueSource,
+                                   pfnTransformer, pTransformArg,
+                                   nXSize, nYSize, oStrips.nStripHeight );
+
+            if( oBatch.nMemory >= nMaxBatchMemory || iShape == nGeomCount - 1 )
             {
-                gv_rasterize_one_shape( pabyChunkBuf, 0, iY,
-                                        poDS->GetRasterXSize(), nThisYChunkSize,
-                                        nBandCount, eType, bAllTouched,
-                                        reinterpret_cast<OGRGeometry *>(
-                                                            pahGeometries[iShape]),
-                                        padfGeomBurnValue + iShape*nBandCount,
-                                        eBurnValueSource, eMergeAlg,
-                                        pfnTransformer, pTransformArg );
+                eErr = GDALRasterizeBatchBurn(
+                    oBatch, poDS, nBandCount, panBandList, eType,
+                    pabyChunkBuf, oStrips,
+                    iFirstBatchShape / static_cast<double>(nGeomCount),
+                    (iShape + 1) / static_cast<double>(nGeomCount),
+                    pfnProgress, pProgressArg );
+                iFirstBatchShape = iShape + 1;
             }
+        }
 
-            eErr =
-                poDS->RasterIO( GF_Write, 0, iY,
-                                poDS->GetRasterXSize(), nThisYChunkSize,
-                                pabyChunkBuf,
-                                poDS->GetRasterXSize(), nThisYChunkSize,
-                                eType, nBandCount, panBandList, 0, 0, 0, nullptr);
+        if( eErr == CE_None && nYChunkSize == nYSize )
+            eErr = poDS->RasterIO( GF_Write, 0, 0, nXSize, nYSize,
+                                   pabyChunkBuf, nXSize, nYSize,
+                                   eType, nBandCount, panBandList,
+                                   0, 0, 0, nullptr );
 
-            if( !pfnProgress((iY + nThisYChunkSize) /
-                             static_cast<double>(poDS->GetRasterYSize()),
-                             "", pProgressArg ) )
-            {
-                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                eErr = CE_Failure;
-            }
-        }
+        delete oStrips.poThreadPool;
     }
 /* -------------------------------------------------------------------- */
 /*      The new algorithm                                               */
@@ -1007,6 +1415,11 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
  * may be improved in the future.  An explicit list of burn values for
  * each layer for each band must be passed in.
  *
+ * The layers are read only once.  Their geometries are transformed and kept
+ * in memory, binned by strip of lines of the raster, until they use about
+ * the GDAL cache size (at least 64 MB).  Each such batch is then burnt into
+ * the raster, chunk by chunk, skipping the chunks it does not intersect.
+ *
  * @param hDS output data, must be opened in update mode.
  * @param nBandCount the number of bands to be updated.
  * @param panBandList the list of bands to be updated.
@@ -1025,8 +1438,8 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
  * bands. If specified, padfLayerBurnValues will not be used and can be a NULL
  * pointer.</li>
  * <li>"CHUNKYSIZE": The height in lines of the chunk to operate on.
- * The larger the chunk size the less times we need to make a pass through all
- * the shapes. If it is not set or set to zero the default chunk size will be
+ * The larger the chunk size the less times we need to read and write the
+ * raster. If it is not set or set to zero the default chunk size will be
  * used. Default size will be estimated based on the GDAL cache buffer size
  * using formula: cache_size_bytes/scanline_size_bytes, so the chunk will
  * not exceed the cache.</li>
@@ -1042,6 +1455,10 @@ CPLErr GDALRasterizeGeometries( GDALDatasetH hDS,
  * <li>"MERGE_ALG": May be REPLACE (the default) or ADD.  REPLACE results in
  * overwriting of value, while ADD adds the new value to the existing raster,
  * suitable for heatmaps for instance.</li>
+ * <li>"NUM_THREADS": (GDAL >= 2.4) Number of worker threads, or ALL_CPUS,
+ * each one burning a strip of lines of the current chunk.  Defaults to the
+ * value of the GDAL_NUM_THREADS configuration option, or 1.  The result does
+ * not depend on the number of threads.</li>
  * </ul>
  * @param pfnProgress the progress function to report completion.
  * @param pProgressArg callback data for progress function.
@@ -1094,8 +1511,8 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 
 /* -------------------------------------------------------------------- */
 /*      Establish a chunksize to operate on.  The larger the chunk      */
-/*      size the less times we need to make a pass through all the      */
-/*      shapes.                                                         */
+/*      size the less times we need to read and write the raster for   */
+/*      each batch of shapes.                                           */
 /* -------------------------------------------------------------------- */
     const char  *pszYChunkSize =
         CSLFetchNameValue( papszOptions, "CHUNKYSIZE" );
@@ -1103,8 +1520,10 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
     const GDALDataType eType =
         poBand->GetRasterDataType() == GDT_Byte ? GDT_Byte : GDT_Float64;
 
+    const int nXSize = poDS->GetRasterXSize();
+    const int nYSize = poDS->GetRasterYSize();
     const int nScanlineBytes =
-        nBandCount * poDS->GetRasterXSize() * GDALGetDataTypeSizeBytes(eType);
+        nBandCount * nXSize * GDALGetDataTypeSizeBytes(eType);
 
     int nYChunkSize = 0;
     if( !(pszYChunkSize && ((nYChunkSize = atoi(pszYChunkSize))) != 0) )
@@ -1119,16 +1538,24 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 
     if( nYChunkSize < 1 )
         nYChunkSize = 1;
-    if( nYChunkSize > poDS->GetRasterYSize() )
-        nYChunkSize = poDS->GetRasterYSize();
+    if( nYChunkSize > nYSize )
+        nYChunkSize = nYSize;
+
+    GDALRasterizeStrips oStrips;
+    GDALRasterizeStripsInit( oStrips, papszOptions, nXSize, nYSize,
+                             nYChunkSize, nBandCount, eType, bAllTouched,
+                             eBurnValueSource, eMergeAlg );
+    nYChunkSize = oStrips.nYChunkSize;
+    const int nStripHeight = oStrips.nStripHeight;
 
     CPLDebug( "GDAL", "Rasterizer operating on %d swaths of %d scanlines.",
-              (poDS->GetRasterYSize() + nYChunkSize - 1) / nYChunkSize,
+              (nYSize + nYChunkSize - 1) / nYChunkSize,
               nYChunkSize );
     unsigned char *pabyChunkBuf = static_cast<unsigned char *>(
         VSI_MALLOC2_VERBOSE(nYChunkSize, nScanlineBytes));
     if( pabyChunkBuf == nullptr )
     {
+        delete oStrips.poThreadPool;
         return CE_Failure;
     }
 
@@ -1136,29 +1563,56 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
 /*      Read the image once for all layers if user requested to render  */
 /*      the whole raster in single chunk.                               */
 /* -------------------------------------------------------------------- */
-    if( nYChunkSize == poDS->GetRasterYSize() )
+    if( nYChunkSize == nYSize )
     {
-        if( poDS->RasterIO( GF_Read, 0, 0, poDS->GetRasterXSize(),
+        if( poDS->RasterIO( GF_Read, 0, 0, nXSize,
                             nYChunkSize, pabyChunkBuf,
-                            poDS->GetRasterXSize(), nYChunkSize,
+                            nXSize, nYChunkSize,
                             eType, nBandCount, panBandList, 0, 0, 0, nullptr )
              != CE_None )
         {
+            delete oStrips.poThreadPool;
             CPLFree( pabyChunkBuf );
             return CE_Failure;
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      The shapes are read once, and kept in memory by batches of at   */
+/*      most the cache size, so the raster is read and written once     */
+/*      per batch.  The progress is estimated from the number of        */
+/*      features burnt, when known.                                     */
+/* -------------------------------------------------------------------- */
+    GDALRasterizeBatch oBatch;
+    oBatch.aanStripShapes.resize( (nYSize + nStripHeight - 1) / nStripHeight );
+    oBatch.nFeatures = 0;
+    oBatch.nMemory = 0;
+
+    const GIntBig nMaxBatchMemory =
+        std::max(GDALGetCacheMax64(), static_cast<GIntBig>(64 * 1024 * 1024));
+
+    GIntBig nTotalFeatures = 0;
+    for( int iLayer = 0; iLayer < nLayerCount; iLayer++ )
+    {
+        OGRLayer *poLayer = reinterpret_cast<OGRLayer *>(pahLayers[iLayer]);
+        const GIntBig nLayerFeatures =
+            poLayer ? poLayer->GetFeatureCount(FALSE) : 0;
+        if( nLayerFeatures < 0 || nTotalFeatures < 0 )
+            nTotalFeatures = -1;
+        else
+            nTotalFeatures += nLayerFeatures;
+    }
+    GIntBig nFeaturesBurnt = 0;
+
 /* ==================================================================== */
-/*      Read the specified layers transforming and rasterizing          */
-/*      geometries.                                                     */
+/*      Read the specified layers transforming and binning geometries.  */
 /* ==================================================================== */
     CPLErr eErr = CE_None;
     const char *pszBurnAttribute = CSLFetchNameValue(papszOptions, "ATTRIBUTE");
 
     pfnProgress( 0.0, nullptr, pProgressArg );
 
-    for( int iLayer = 0; iLayer < nLayerCount; iLayer++ )
+    for( int iLayer = 0; iLayer < nLayerCount && eErr == CE_None; iLayer++ )
     {
         OGRLayer *poLayer = reinterpret_cast<OGRLayer *>(pahLayers[iLayer]);
 
@@ -1246,6 +1700,7 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
             CSLDestroy( papszTransformerOptions );
             if( pTransformArg == nullptr )
             {
+                delete oStrips.poThreadPool;
                 CPLFree( pabyChunkBuf );
                 return CE_Failure;
             }
@@ -1254,82 +1709,52 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
         poLayer->ResetReading();
 
 /* -------------------------------------------------------------------- */
-/*      Loop over image in designated chunks.                           */
+/*      Collect the shapes, burning them each time a batch is full.     */
+/*      The transformer is only used in this thread.                    */
 /* -------------------------------------------------------------------- */
-
         double *padfAttrValues = static_cast<double *>(
             VSI_MALLOC_VERBOSE(sizeof(double) * nBandCount));
         if( padfAttrValues == nullptr )
             eErr = CE_Failure;
 
-        for( int iY = 0;
-             iY < poDS->GetRasterYSize() && eErr == CE_None;
-             iY += nYChunkSize )
+        OGRFeature *poFeat = nullptr;
+        while( eErr == CE_None &&
+               (poFeat = poLayer->GetNextFeature()) != nullptr )
         {
-            int nThisYChunkSize = nYChunkSize;
-            if( nThisYChunkSize + iY > poDS->GetRasterYSize() )
-                nThisYChunkSize = poDS->GetRasterYSize() - iY;
+            OGRGeometry *poGeom = poFeat->GetGeometryRef();
 
-            // Only re-read image if not a single chunk is being rendered.
-            if( nYChunkSize < poDS->GetRasterYSize() )
+            if( pszBurnAttribute )
             {
-                eErr =
-                    poDS->RasterIO( GF_Read, 0, iY,
-                                    poDS->GetRasterXSize(), nThisYChunkSize,
-                                    pabyChunkBuf,
-                                    poDS->GetRasterXSize(), nThisYChunkSize,
-                                    eType, nBandCount, panBandList,
-                                    0, 0, 0, nullptr );
-                if( eErr != CE_None )
-                    break;
-            }
-
-            OGRFeature *poFeat = nullptr;
-            while( (poFeat = poLayer->GetNextFeature()) != nullptr )
-            {
-                OGRGeometry *poGeom = poFeat->GetGeometryRef();
-
-                if( pszBurnAttribute )
-                {
-                    const double dfAttrValue =
-                        poFeat->GetFieldAsDouble( iBurnField );
-                    for( int iBand = 0 ; iBand < nBandCount ; iBand++)
-                        padfAttrValues[iBand] = dfAttrValue;
+                const double dfAttrValue =
+                    poFeat->GetFieldAsDouble( iBurnField );
+                for( int iBand = 0 ; iBand < nBandCount ; iBand++)
+                    padfAttrValues[iBand] = dfAttrValue;
 
-                    padfBurnValues = padfAttrValues;
-                }
-
-                gv_rasterize_one_shape( pabyChunkBuf, 0, iY,
-                                        poDS->GetRasterXSize(),
-                                        nThisYChunkSize,
-                                        nBandCount, eType, bAllTouched, poGeom,
-                                        padfBurnValues, eBurnValueSource,
-                                        eMergeAlg,
-                                        pfnTransformer, pTransformArg );
-
-                delete poFeat;
+                padfBurnValues = padfAttrValues;
             }
 
-            // Only write image if not a single chunk is being rendered.
-            if( nYChunkSize < poDS->GetRasterYSize() )
-            {
-                eErr =
-                    poDS->RasterIO( GF_Write, 0, iY,
-                                    poDS->GetRasterXSize(), nThisYChunkSize,
-                                    pabyChunkBuf,
-                                    poDS->GetRasterXSize(), nThisYChunkSize,
-                                    eType, nBandCount, panBandList,
-                                    0, 0, 0, nullptr );
-            }
+            GDALRasterizeBatchAdd( oBatch, poGeom, padfBurnValues,
+                                   nBandCount, bAllTouched, eBurnValueSource,
+                                   pfnTransformer, pTransformArg,
+                                   nXSize, nYSize, nStripHeight );
 
-            poLayer->ResetReading();
+            delete poFeat;
 
-            if( !pfnProgress((iY + nThisYChunkSize) /
-                             static_cast<double>(poDS->GetRasterYSize()),
-                             "", pProgressArg) )
+            if( oBatch.nMemory >= nMaxBatchMemory )
             {
-                CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-                eErr = CE_Failure;
+                const GIntBig nBatchFeatures = oBatch.nFeatures;
+                eErr = GDALRasterizeBatchBurn(
+                    oBatch, poDS, nBandCount, panBandList, eType,
+                    pabyChunkBuf, oStrips,
+                    nTotalFeatures > 0 ?
+                        std::min(1.0, static_cast<double>(nFeaturesBurnt) /
+                                      nTotalFeatures) : 0.0,
+                    nTotalFeatures > 0 ?
+                        std::min(1.0, static_cast<double>(nFeaturesBurnt +
+                                                          nBatchFeatures) /
+                                      nTotalFeatures) : 1.0,
+                    pfnProgress, pProgressArg );
+                nFeaturesBurnt += nBatchFeatures;
             }
         }
 
@@ -1343,22 +1768,37 @@ CPLErr GDALRasterizeLayers( GDALDatasetH hDS,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Burn the last batch.                                            */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None )
+    {
+        eErr = GDALRasterizeBatchBurn(
+            oBatch, poDS, nBandCount, panBandList, eType,
+            pabyChunkBuf, oStrips,
+            nTotalFeatures > 0 ?
+                std::min(1.0, static_cast<double>(nFeaturesBurnt) /
+                              nTotalFeatures) : 0.0,
+            1.0, pfnProgress, pProgressArg );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Write out the image once for all layers if user requested       */
 /*      to render the whole raster in single chunk.                     */
 /* -------------------------------------------------------------------- */
-    if( eErr == CE_None && nYChunkSize == poDS->GetRasterYSize() )
+    if( eErr == CE_None && nYChunkSize == nYSize )
     {
         eErr = poDS->RasterIO( GF_Write, 0, 0,
-                                poDS->GetRasterXSize(), nYChunkSize,
+                                nXSize, nYChunkSize,
                                 pabyChunkBuf,
-                                poDS->GetRasterXSize(), nYChunkSize,
+                                nXSize, nYChunkSize,
                                 eType, nBandCount, panBandList, 0, 0, 0, nullptr );
     }
 
 /* -------------------------------------------------------------------- */
 /*      cleanup                                                         */
 /* -------------------------------------------------------------------- */
+    delete oStrips.poThreadPool;
     VSIFree( pabyChunkBuf );
 
     return eErr;
@@ -34,13 +34,16 @@
 
 #include <algorithm>
 #include <set>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
+#include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_alg_priv.h"
 
@@ -51,99 +54,397 @@ CPL_CVSID("$Id: gdalsievefilter.cpp 7e07230bbff24eb333608de4dbd460b7312839d0 201
 /*
  * General Plan
  *
- * 1) make a pass with the polygon enumerator to build up the
- *    polygon map array.  Also accumulate polygon size information.
+ * The raster is processed in strips of lines, several strips at a time,
+ * each one by a worker thread.
  *
- * 2) Identify the polygons that need to be merged.
+ * 1) Label the connected polygons of each strip with a union-find, and
+ *    accumulate their sizes.  Polygons of neighbouring strips that touch
+ *    are then merged in a global union-find, so that every polygon gets
+ *    its final id and size.
  *
- * 3) Make a pass with the polygon enumerator.  For each "to be merged"
- *    polygon keep track of its largest neighbour.
+ * 2) Label the strips again, and for each polygon smaller than the sieve
+ *    threshold keep track of its largest neighbour.  In case of ties, the
+ *    first neighbour met in raster order is kept.
  *
- * 4) Fix up remappings that would go to polygons smaller than the seive
+ * 3) Fix up remappings that would go to polygons smaller than the seive
  *    size.  Ensure these in term map to the largest neighbour of the
  *    "to be sieved" polygons.
  *
- * 5) Make another pass with the polygon enumerator. This time we remap
- *    the actual pixel values of all polygons to be merged.
+ * 4) Label the strips a last time, and remap the actual pixel values of
+ *    all polygons to be merged.
+ *
+ * Only the strips being processed are kept in memory, in addition to
+ * about 16 bytes per polygon.
  */
 
 /************************************************************************/
-/*                          GPMaskImageData()                           */
+/*                             GSFindRoot()                             */
+/************************************************************************/
+
+static int GSFindRoot( std::vector<int> &anParent, int nId )
+{
+    int nRoot = nId;
+    while( anParent[nRoot] != nRoot )
+        nRoot = anParent[nRoot];
+
+    // Map the whole chain to the root.
+    while( anParent[nId] != nRoot )
+    {
+        const int nNextId = anParent[nId];
+        anParent[nId] = nRoot;
+        nId = nNextId;
+    }
+    return nRoot;
+}
+
+/************************************************************************/
+/*                               GSUnion()                              */
 /*                                                                      */
-/*      Mask out image pixels to a special nodata value if the mask     */
-/*      band is zero.                                                   */
+/*      Merge two polygons.  The smallest id becomes the root.          */
 /************************************************************************/
 
-static CPLErr
-GPMaskImageData( GDALRasterBandH hMaskBand, GByte *pabyMaskLine,
-                 int iY, int nXSize,
-                 GInt32 *panImageLine )
+static void GSUnion( std::vector<int> &anParent, int nId1, int nId2 )
+{
+    nId1 = GSFindRoot(anParent, nId1);
+    nId2 = GSFindRoot(anParent, nId2);
+    if( nId1 < nId2 )
+        anParent[nId2] = nId1;
+    else if( nId2 < nId1 )
+        anParent[nId1] = nId2;
+}
+
+/************************************************************************/
+/*                              GSStripJob                              */
+/************************************************************************/
 
+namespace {
+struct GSStripJob
 {
-    const CPLErr eErr =
-        GDALRasterIO( hMaskBand, GF_Read, 0, iY, nXSize, 1,
-                      pabyMaskLine, nXSize, 1, GDT_Byte, 0, 0 );
-    if( eErr == CE_None )
+    int                 nXSize;
+    int                 nLines;
+    int                 nConnectedness;
+
+    // Pixel values, with nodata pixels set to GP_NODATA_MARKER, and the
+    // unmasked values for the last pass.
+    std::vector<GInt32> anValues;
+    std::vector<GInt32> anRawValues;
+
+    // Polygon ids of the pixels: local to the strip, numbered from 0 in
+    // raster order, or global once nIdOffset and panGlobalParent are set.
+    // -1 for nodata pixels.
+    std::vector<GInt32> anIds;
+    int                 nPolygons;
+    std::vector<int>    anParent;
+
+    // Outputs of the first pass.
+    std::vector<int>    anSizes;
+    std::vector<GInt32> anPolyValues;
+
+    // Inputs of the next passes.
+    int                 nIdOffset;
+    const int          *panGlobalParent;
+    const int          *panPolySizes;
+    const GInt32       *panPolyValues;
+    int                 nSizeThreshold;
+
+    // Second pass: the global ids of the line above the strip, or NULL,
+    // and the largest neighbour in the strip of each small polygon.
+    const GInt32       *panAboveIds;
+    std::unordered_map<int, int> oMapBigNeighbour;
+
+    // Third pass.
+    const int          *panBigNeighbour;
+};
+}  // namespace
+
+/************************************************************************/
+/*                            GSLabelStrip()                            */
+/*                                                                      */
+/*      Assign ids to the connected polygons of a strip, numbered in    */
+/*      the order of their first pixel.  If the global union-find is    */
+/*      known, ids are then translated to the final global ids.         */
+/************************************************************************/
+
+static void GSLabelStrip( GSStripJob *psJob )
+{
+    const int nXSize = psJob->nXSize;
+    const bool b8Connected = psJob->nConnectedness == 8;
+    const GInt32 *panVal = &psJob->anValues[0];
+    GInt32 *panId = &psJob->anIds[0];
+    std::vector<int> &anParent = psJob->anParent;
+    anParent.clear();
+
+    for( int iY = 0; iY < psJob->nLines; iY++ )
     {
-        for( int i = 0; i < nXSize; i++ )
+        for( int iX = 0; iX < nXSize; iX++ )
         {
-            if( pabyMaskLine[i] == 0 )
-                panImageLine[i] = GP_NODATA_MARKER;
+            const size_t i = static_cast<size_t>(iY) * nXSize + iX;
+            const GInt32 nVal = panVal[i];
+            if( nVal == GP_NODATA_MARKER )
+            {
+                panId[i] = -1;
+                continue;
+            }
+
+            int nId = -1;
+            const auto Connect = [&](size_t j)
+            {
+                if( panVal[j] != nVal )
+                    return;
+                if( nId < 0 )
+                    nId = panId[j];
+                else if( panId[j] != nId )
+                    GSUnion( anParent, nId, panId[j] );
+            };
+
+            if( iX > 0 )
+                Connect(i - 1);
+            if( iY > 0 )
+            {
+                Connect(i - nXSize);
+                if( b8Connected && iX > 0 )
+                    Connect(i - nXSize - 1);
+                if( b8Connected && iX < nXSize - 1 )
+                    Connect(i - nXSize + 1);
+            }
+
+            if( nId < 0 )
+            {
+                nId = static_cast<int>(anParent.size());
+                anParent.push_back(nId);
+            }
+            panId[i] = nId;
         }
     }
 
-    return eErr;
+/* -------------------------------------------------------------------- */
+/*      Number the polygons in the order of their first pixel.          */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anPolyIndex(anParent.size(), -1);
+    int nPolygons = 0;
+    const size_t nPixels = static_cast<size_t>(psJob->nLines) * nXSize;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        if( panId[i] < 0 )
+            continue;
+        const int nRoot = GSFindRoot( anParent, panId[i] );
+        if( anPolyIndex[nRoot] < 0 )
+            anPolyIndex[nRoot] = nPolygons++;
+        panId[i] = anPolyIndex[nRoot];
+    }
+    psJob->nPolygons = nPolygons;
+
+    if( psJob->panGlobalParent != nullptr )
+    {
+        for( size_t i = 0; i < nPixels; i++ )
+        {
+            if( panId[i] >= 0 )
+                panId[i] = psJob->panGlobalParent[psJob->nIdOffset + panId[i]];
+        }
+    }
 }
 
-// TODO: What is "eaches" supposed to be?
+/************************************************************************/
+/*                          GSFirstPassJobFunc()                        */
+/************************************************************************/
+
+static void GSFirstPassJobFunc( void *pData )
+{
+    GSStripJob *psJob = static_cast<GSStripJob *>(pData);
+    GSLabelStrip( psJob );
+
+    psJob->anSizes.assign( psJob->nPolygons, 0 );
+    psJob->anPolyValues.resize( psJob->nPolygons );
+    const size_t nPixels =
+        static_cast<size_t>(psJob->nLines) * psJob->nXSize;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        const int iPoly = psJob->anIds[i];
+        if( iPoly < 0 )
+            continue;
+        if( psJob->anSizes[iPoly] < MY_MAX_INT )
+            psJob->anSizes[iPoly] += 1;
+        psJob->anPolyValues[iPoly] = psJob->anValues[i];
+    }
+}
+
+/************************************************************************/
+/*                          GSLabelJobFunc()                            */
+/************************************************************************/
+
+static void GSLabelJobFunc( void *pData )
+{
+    GSLabelStrip( static_cast<GSStripJob *>(pData) );
+}
 
 /************************************************************************/
 /*                          CompareNeighbour()                          */
 /*                                                                      */
-/*      Compare two neighbouring polygons, and update eaches            */
-/*      "biggest neighbour" if the other is larger than its current     */
-/*      largest neighbour.                                              */
-/*                                                                      */
-/*      Note that this should end up with each polygon knowing the      */
-/*      id of its largest neighbour.  No attempt is made to             */
-/*      restrict things to small polygons that we will be merging,      */
-/*      nor to exclude assigning "biggest neighbours" that are still    */
-/*      smaller than our sieve threshold.                               */
+/*      Compare two neighbouring polygons, and update the "biggest      */
+/*      neighbour" of each of them that is smaller than the sieve       */
+/*      threshold if the other is larger than its current largest       */
+/*      neighbour.                                                      */
 /************************************************************************/
 
-static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
-                                     int *panPolyIdMap,
-                                     int * /* panPolyValue */,
-                                     std::vector<int> &anPolySizes,
-                                     std::vector<int> &anBigNeighbour )
+static inline void CompareNeighbour( GSStripJob *psJob,
+                                     int nPolyId1, int nPolyId2 )
 
 {
     // Nodata polygon do not need neighbours, and cannot be neighbours
     // to valid polygons.
-    if( nPolyId1 < 0 || nPolyId2 < 0 )
+    if( nPolyId1 < 0 || nPolyId2 < 0 || nPolyId1 == nPolyId2 )
         return;
 
-    // Make sure we are working with the final merged polygon ids.
-    nPolyId1 = panPolyIdMap[nPolyId1];
-    nPolyId2 = panPolyIdMap[nPolyId2];
+    const int *panPolySizes = psJob->panPolySizes;
+    for( int iSide = 0; iSide < 2; iSide++ )
+    {
+        if( panPolySizes[nPolyId1] < psJob->nSizeThreshold )
+        {
+            auto oIter = psJob->oMapBigNeighbour.find(nPolyId1);
+            if( oIter == psJob->oMapBigNeighbour.end() )
+                psJob->oMapBigNeighbour[nPolyId1] = nPolyId2;
+            else if( panPolySizes[oIter->second] < panPolySizes[nPolyId2] )
+                oIter->second = nPolyId2;
+        }
+        std::swap(nPolyId1, nPolyId2);
+    }
+}
 
-    if( nPolyId1 == nPolyId2 )
-        return;
+/************************************************************************/
+/*                         GSNeighbourJobFunc()                         */
+/************************************************************************/
 
-    // Nodata polygon do not need neighbours, and cannot be neighbours
-    // to valid polygons.
-    // Should no longer happen with r28826 optimization.
-    // if( panPolyValue[nPolyId1] == GP_NODATA_MARKER
-    //    || panPolyValue[nPolyId2] == GP_NODATA_MARKER )
-    //    return;
-
-    if( anBigNeighbour[nPolyId1] == -1
-        || anPolySizes[anBigNeighbour[nPolyId1]] < anPolySizes[nPolyId2] )
-        anBigNeighbour[nPolyId1] = nPolyId2;
-
-    if( anBigNeighbour[nPolyId2] == -1
-        || anPolySizes[anBigNeighbour[nPolyId2]] < anPolySizes[nPolyId1] )
-        anBigNeighbour[nPolyId2] = nPolyId1;
+static void GSNeighbourJobFunc( void *pData )
+{
+    GSStripJob *psJob = static_cast<GSStripJob *>(pData);
+    const int nXSize = psJob->nXSize;
+    const bool b8Connected = psJob->nConnectedness == 8;
+    psJob->oMapBigNeighbour.clear();
+
+    for( int iY = 0; iY < psJob->nLines; iY++ )
+    {
+        const GInt32 *panThisLineId =
+            &psJob->anIds[static_cast<size_t>(iY) * nXSize];
+        const GInt32 *panLastLineId =
+            iY > 0 ? panThisLineId - nXSize : psJob->panAboveIds;
+
+        for( int iX = 0; iX < nXSize; iX++ )
+        {
+            if( panLastLineId != nullptr )
+            {
+                CompareNeighbour( psJob, panThisLineId[iX],
+                                  panLastLineId[iX] );
+
+                if( iX > 0 && b8Connected )
+                    CompareNeighbour( psJob, panThisLineId[iX],
+                                      panLastLineId[iX-1] );
+
+                if( iX < nXSize-1 && b8Connected )
+                    CompareNeighbour( psJob, panThisLineId[iX],
+                                      panLastLineId[iX+1] );
+            }
+
+            if( iX > 0 )
+                CompareNeighbour( psJob, panThisLineId[iX],
+                                  panThisLineId[iX-1] );
+
+            // We don't need to compare to next pixel or next line
+            // since they will be compared to us.
+        }
+    }
+}
+
+/************************************************************************/
+/*                           GSRemapJobFunc()                           */
+/************************************************************************/
+
+static void GSRemapJobFunc( void *pData )
+{
+    GSStripJob *psJob = static_cast<GSStripJob *>(pData);
+    GSLabelStrip( psJob );
+
+    const size_t nPixels =
+        static_cast<size_t>(psJob->nLines) * psJob->nXSize;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        const int iThisPoly = psJob->anIds[i];
+        if( iThisPoly >= 0 && psJob->panBigNeighbour[iThisPoly] != -1 )
+        {
+            psJob->anRawValues[i] =
+                psJob->panPolyValues[psJob->panBigNeighbour[iThisPoly]];
+        }
+    }
+}
+
+/************************************************************************/
+/*                            GSReadStrip()                             */
+/*                                                                      */
+/*      Read the lines of a strip, and mask out image pixels to a       */
+/*      special nodata value if the mask band is zero.                  */
+/************************************************************************/
+
+static CPLErr GSReadStrip( GDALRasterBandH hSrcBand,
+                           GDALRasterBandH hMaskBand,
+                           int iYOff, bool bKeepRawValues,
+                           std::vector<GByte> &abyMask,
+                           GSStripJob *psJob )
+{
+    const int nXSize = psJob->nXSize;
+    const size_t nPixels = static_cast<size_t>(psJob->nLines) * nXSize;
+    psJob->anValues.resize(nPixels);
+    psJob->anIds.resize(nPixels);
+
+    CPLErr eErr =
+        GDALRasterIO( hSrcBand, GF_Read, 0, iYOff, nXSize, psJob->nLines,
+                      &psJob->anValues[0], nXSize, psJob->nLines,
+                      GDT_Int32, 0, 0 );
+    if( eErr != CE_None )
+        return eErr;
+
+    if( bKeepRawValues )
+        psJob->anRawValues = psJob->anValues;
+
+    if( hMaskBand != nullptr )
+    {
+        abyMask.resize(nPixels);
+        eErr = GDALRasterIO( hMaskBand, GF_Read, 0, iYOff,
+                             nXSize, psJob->nLines,
+                             &abyMask[0], nXSize, psJob->nLines,
+                             GDT_Byte, 0, 0 );
+        if( eErr != CE_None )
+            return eErr;
+
+        for( size_t i = 0; i < nPixels; i++ )
+        {
+            if( abyMask[i] == 0 )
+                psJob->anValues[i] = GP_NODATA_MARKER;
+        }
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                             GSRunJobs()                              */
+/************************************************************************/
+
+static void GSRunJobs( CPLWorkerThreadPool *poThreadPool,
+                       CPLThreadFunc pfnFunc,
+                       std::vector<GSStripJob> &asJobs, int nJobs )
+{
+    if( poThreadPool != nullptr && nJobs > 1 )
+    {
+        std::vector<void*> apJobs;
+        for( int i = 0; i < nJobs; i++ )
+            apJobs.push_back(&asJobs[i]);
+        poThreadPool->SubmitJobs(pfnFunc, apJobs);
+        poThreadPool->WaitCompletion();
+    }
+    else
+    {
+        for( int i = 0; i < nJobs; i++ )
+            pfnFunc(&asJobs[i]);
+    }
 }
 
 /************************************************************************/
@@ -157,9 +458,8 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * threshold size (in pixels) and replaces replaces them with the pixel value
  * of the largest neighbour polygon.
  *
- * Polygon are determined (per GDALRasterPolygonEnumerator) as regions of
- * the raster where the pixels all have the same value, and that are contiguous
- * (connected).
+ * Polygon are determined as regions of the raster where the pixels all have
+ * the same value, and that are contiguous (connected).
  *
  * Pixels determined to be "nodata" per hMaskBand will not be treated as part
  * of a polygon regardless of their pixel values.  Nodata areas will never be
@@ -169,13 +469,14 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * as the threshold will not be altered.  Polygons surrounded by nodata areas
  * will therefore not be altered.
  *
- * The algorithm makes three passes over the input file to enumerate the
- * polygons and collect limited information about them.  Memory use is
- * proportional to the number of polygons (roughly 24 bytes per polygon), but
- * is not directly related to the size of the raster.  So very large raster
- * files can be processed effectively if there aren't too many polygons.  But
- * extremely noisy rasters with many one pixel polygons will end up being
- * expensive (in memory) to process.
+ * The algorithm makes three passes over the input file, strip of lines by
+ * strip of lines, to label the polygons and collect limited information
+ * about them.  Memory use is proportional to the size of the strips being
+ * processed and to the number of polygons (roughly 16 bytes per polygon),
+ * but is not directly related to the size of the raster.  So very large
+ * raster files can be processed effectively if there aren't too many
+ * polygons.  But extremely noisy rasters with many one pixel polygons will
+ * end up being expensive (in memory) to process.
  *
  * @param hSrcBand the source raster band to be processed.
  * @param hMaskBand an optional mask band.  All pixels in the mask band with a
@@ -187,8 +488,13 @@ static inline void CompareNeighbour( int nPolyId1, int nPolyId2,
  * @param nConnectedness either 4 indicating that diagonal pixels are not
  * considered directly adjacent for polygon membership purposes or 8
  * indicating they are.
- * @param papszOptions algorithm options in name=value list form.  None
- * currently supported.
+ * @param papszOptions algorithm options in name=value list form.
+ * <dl>
+ * <dt>"NUM_THREADS":</dt> (GDAL >= 2.4) Number of worker threads, or
+ * ALL_CPUS, each one processing a strip of lines.  Defaults to the value of
+ * the GDAL_NUM_THREADS configuration option, or 1.  The result does not
+ * depend on the number of threads.
+ * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
  * @param pProgressArg callback argument passed to pfnProgress.
@@ -200,7 +506,7 @@ CPLErr CPL_STDCALL
 GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
                  GDALRasterBandH hDstBand,
                  int nSizeThreshold, int nConnectedness,
-                 CPL_UNUSED char **papszOptions,
+                 char **papszOptions,
                  GDALProgressFunc pfnProgress,
                  void * pProgressArg )
 {
@@ -211,92 +517,132 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
         pfnProgress = GDALDummyProgress;
 
 /* -------------------------------------------------------------------- */
-/*      Allocate working buffers.                                       */
+/*      Set up the strips and the worker threads.                       */
 /* -------------------------------------------------------------------- */
-    int nXSize = GDALGetRasterBandXSize( hSrcBand );
-    int nYSize = GDALGetRasterBandYSize( hSrcBand );
-    GInt32 *panLastLineVal = static_cast<GInt32 *>(
-        VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
-    GInt32 *panThisLineVal = static_cast<GInt32 *>(
-        VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
-    GInt32 *panLastLineId = static_cast<GInt32 *>(
-        VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
-    GInt32 *panThisLineId = static_cast<GInt32 *>(
-        VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
-    GInt32 *panThisLineWriteVal = static_cast<GInt32 *>(
-        VSI_MALLOC2_VERBOSE(sizeof(GInt32), nXSize));
-    GByte *pabyMaskLine =
-        hMaskBand != nullptr
-        ? static_cast<GByte *>(VSI_MALLOC_VERBOSE(nXSize))
-        : nullptr;
-    if( panLastLineVal == nullptr || panThisLineVal == nullptr ||
-        panLastLineId == nullptr || panThisLineId == nullptr ||
-        panThisLineWriteVal == nullptr ||
-        (hMaskBand != nullptr && pabyMaskLine == nullptr) )
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+
+    const int nThreads =
+        CPLGetNumThreads(CSLFetchNameValue(papszOptions, "NUM_THREADS"));
+
+    const int nStripHeight = GDALGetStripHeight(nXSize, nYSize, 16);
+    const int nStrips = (nYSize + nStripHeight - 1) / nStripHeight;
+
+    CPLWorkerThreadPool *poThreadPool =
+        CPLCreateWorkerThreadPool(std::min(nThreads, nStrips));
+    const int nBatchStrips = poThreadPool ? std::min(nThreads, nStrips) : 1;
+
+    std::vector<GSStripJob> asJobs(nBatchStrips);
+    for( int i = 0; i < nBatchStrips; i++ )
     {
-        CPLFree( panThisLineId );
-        CPLFree( panLastLineId );
-        CPLFree( panThisLineVal );
-        CPLFree( panLastLineVal );
-        CPLFree( panThisLineWriteVal );
-        CPLFree( pabyMaskLine );
-        return CE_Failure;
+        asJobs[i].nXSize = nXSize;
+        asJobs[i].nLines = 0;
+        asJobs[i].nConnectedness = nConnectedness;
+        asJobs[i].nPolygons = 0;
+        asJobs[i].nIdOffset = 0;
+        asJobs[i].panGlobalParent = nullptr;
+        asJobs[i].panPolySizes = nullptr;
+        asJobs[i].panPolyValues = nullptr;
+        asJobs[i].nSizeThreshold = nSizeThreshold;
+        asJobs[i].panAboveIds = nullptr;
+        asJobs[i].panBigNeighbour = nullptr;
     }
+    std::vector<GByte> abyMask;
 
-/* -------------------------------------------------------------------- */
-/*      The first pass over the raster is only used to build up the     */
-/*      polygon id map so we will know in advance what polygons are     */
-/*      what on the second pass.                                        */
-/* -------------------------------------------------------------------- */
-    GDALRasterPolygonEnumerator oFirstEnum( nConnectedness );
+    // Global polygon id of the first polygon of each strip.
+    std::vector<int> anStripIdOffset(nStrips + 1, 0);
+
+    // Per polygon information, indexed by global polygon ids.
+    std::vector<int> anParent;
     std::vector<int> anPolySizes;
+    std::vector<GInt32> anPolyValues;
 
+    // Values and ids of the last line of the previous strip.
+    std::vector<GInt32> anLastLineVal(nXSize);
+    std::vector<GInt32> anLastLineId(nXSize);
+
+/* ==================================================================== */
+/*      The first pass over the raster is only used to label the        */
+/*      polygons and accumulate their sizes, so we will know in         */
+/*      advance what polygons are what on the second pass.              */
+/* ==================================================================== */
     CPLErr eErr = CE_None;
-    for( int iY = 0; eErr == CE_None && iY < nYSize; iY++ )
+    for( int iBatch = 0; eErr == CE_None && iBatch < nStrips;
+         iBatch += nBatchStrips )
     {
-        eErr = GDALRasterIO(
-            hSrcBand,
-            GF_Read, 0, iY, nXSize, 1,
-            panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-        if( eErr == CE_None && hMaskBand != nullptr )
-            eErr = GPMaskImageData(hMaskBand, pabyMaskLine, iY, nXSize,
-                                   panThisLineVal);
-
-        if( iY == 0 )
-            oFirstEnum.ProcessLine(
-                nullptr, panThisLineVal, nullptr, panThisLineId, nXSize );
-        else
-            oFirstEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
+        const int nJobs = std::min(nBatchStrips, nStrips - iBatch);
+        for( int iJob = 0; eErr == CE_None && iJob < nJobs; iJob++ )
+        {
+            const int iYOff = (iBatch + iJob) * nStripHeight;
+            asJobs[iJob].nLines = std::min(nStripHeight, nYSize - iYOff);
+            eErr = GSReadStrip( hSrcBand, hMaskBand, iYOff, false,
+                                abyMask, &asJobs[iJob] );
+        }
+        if( eErr != CE_None )
+            break;
+
+        GSRunJobs( poThreadPool, GSFirstPassJobFunc, asJobs, nJobs );
 
 /* -------------------------------------------------------------------- */
-/*      Accumulate polygon sizes.                                       */
+/*      Append the polygons of the strips, and merge the polygons       */
+/*      touching the previous strip.                                    */
 /* -------------------------------------------------------------------- */
-        if( oFirstEnum.nNextPolygonId > static_cast<int>(anPolySizes.size()) )
-            anPolySizes.resize( oFirstEnum.nNextPolygonId );
-
-        for( int iX = 0; iX < nXSize; iX++ )
+        for( int iJob = 0; eErr == CE_None && iJob < nJobs; iJob++ )
         {
-            const int iPoly = panThisLineId[iX];
+            GSStripJob &oJob = asJobs[iJob];
+            const int iStrip = iBatch + iJob;
+            const int nIdOffset = anStripIdOffset[iStrip];
+            if( oJob.nPolygons > MY_MAX_INT - nIdOffset )
+            {
+                CPLError( CE_Failure, CPLE_NotSupported,
+                          "Too many polygons" );
+                eErr = CE_Failure;
+                break;
+            }
+            anStripIdOffset[iStrip + 1] = nIdOffset + oJob.nPolygons;
+            for( int iPoly = 0; iPoly < oJob.nPolygons; iPoly++ )
+                anParent.push_back(nIdOffset + iPoly);
+            anPolySizes.insert( anPolySizes.end(),
+                                oJob.anSizes.begin(), oJob.anSizes.end() );
+            anPolyValues.insert( anPolyValues.end(),
+                                 oJob.anPolyValues.begin(),
+                                 oJob.anPolyValues.end() );
+
+            const GInt32 *panThisLineVal = &oJob.anValues[0];
+            const GInt32 *panThisLineId = &oJob.anIds[0];
+            for( int iX = 0; iStrip > 0 && iX < nXSize; iX++ )
+            {
+                const GInt32 nVal = panThisLineVal[iX];
+                if( nVal == GP_NODATA_MARKER )
+                    continue;
+                const int nId = nIdOffset + panThisLineId[iX];
+                for( int iLastX = iX - 1; iLastX <= iX + 1; iLastX++ )
+                {
+                    if( iLastX < 0 || iLastX >= nXSize ||
+                        (nConnectedness != 8 && iLastX != iX) )
+                        continue;
+                    if( anLastLineVal[iLastX] == nVal )
+                        GSUnion( anParent, nId, anLastLineId[iLastX] );
+                }
+            }
 
-            if( iPoly >= 0 && anPolySizes[iPoly] < MY_MAX_INT )
-                anPolySizes[iPoly] += 1;
+            const size_t nLastLine =
+                static_cast<size_t>(oJob.nLines - 1) * nXSize;
+            memcpy( &anLastLineVal[0], &oJob.anValues[nLastLine],
+                    nXSize * sizeof(GInt32) );
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                const GInt32 nId = oJob.anIds[nLastLine + iX];
+                anLastLineId[iX] = nId < 0 ? -1 : nIdOffset + nId;
+            }
         }
 
-/* -------------------------------------------------------------------- */
-/*      swap this/last lines.                                           */
-/* -------------------------------------------------------------------- */
-        std::swap(panLastLineVal, panThisLineVal);
-        std::swap(panLastLineId, panThisLineId);
-
 /* -------------------------------------------------------------------- */
 /*      Report progress, and support interrupts.                        */
 /* -------------------------------------------------------------------- */
+        const int iYEnd = std::min(nYSize, (iBatch + nJobs) * nStripHeight);
         if( eErr == CE_None
-            && !pfnProgress( 0.25 * ((iY+1) / static_cast<double>(nYSize)),
+            && !pfnProgress( 0.25 * (iYEnd / static_cast<double>(nYSize)),
                              "", pProgressArg ) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -305,130 +651,111 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Make a pass through the maps, ensuring every polygon id         */
-/*      points to the final id it should use, not an intermediate       */
-/*      value.                                                          */
-/* -------------------------------------------------------------------- */
-    oFirstEnum.CompleteMerges();
-
+/*      Make every polygon id point to its final id, and push the       */
+/*      sizes of merged polygon fragments into the final polygon's      */
+/*      count.                                                          */
 /* -------------------------------------------------------------------- */
-/*      Push the sizes of merged polygon fragments into the             */
-/*      merged polygon id's count.                                      */
-/* -------------------------------------------------------------------- */
-    for( int iPoly = 0; oFirstEnum.panPolyIdMap != nullptr && // for Coverity
-                        iPoly < oFirstEnum.nNextPolygonId; iPoly++ )
+    const int nPolyIds = static_cast<int>(anParent.size());
+    int nFinalPolyCount = 0;
+    for( int iPoly = 0; eErr == CE_None && iPoly < nPolyIds; iPoly++ )
     {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
+        const int nRoot = GSFindRoot( anParent, iPoly );
+        if( nRoot == iPoly )
         {
-            GIntBig nSize = anPolySizes[oFirstEnum.panPolyIdMap[iPoly]];
-
-            nSize += anPolySizes[iPoly];
-
-            if( nSize > MY_MAX_INT )
-                nSize = MY_MAX_INT;
-
-            anPolySizes[oFirstEnum.panPolyIdMap[iPoly]] =
-                static_cast<int>(nSize);
-            anPolySizes[iPoly] = 0;
+            nFinalPolyCount++;
+            continue;
         }
-    }
 
-/* -------------------------------------------------------------------- */
-/*      We will use a new enumerator for the second pass primarily      */
-/*      so we can preserve the first pass map.                          */
-/* -------------------------------------------------------------------- */
-    GDALRasterPolygonEnumerator oSecondEnum( nConnectedness );
-
-    std::vector<int> anBigNeighbour;
-    anBigNeighbour.resize( anPolySizes.size() );
+        GIntBig nSize = anPolySizes[nRoot];
+        nSize += anPolySizes[iPoly];
+        if( nSize > MY_MAX_INT )
+            nSize = MY_MAX_INT;
+        anPolySizes[nRoot] = static_cast<int>(nSize);
+        anPolySizes[iPoly] = 0;
+    }
 
-    for( int iPoly = 0; iPoly < static_cast<int>(anPolySizes.size()); iPoly++ )
-        anBigNeighbour[iPoly] = -1;
+    CPLDebug( "GDALSieveFilter",
+              "Counted %d polygon fragments forming %d final polygons.",
+              nPolyIds, nFinalPolyCount );
 
 /* ==================================================================== */
 /*      Second pass ... identify the largest neighbour for each         */
-/*      polygon.                                                        */
+/*      polygon smaller than the threshold.                             */
 /* ==================================================================== */
-    for( int iY = 0; eErr == CE_None && iY < nYSize; iY++ )
-    {
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1,
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
+    std::vector<int> anBigNeighbour;
+    if( eErr == CE_None )
+        anBigNeighbour.assign( nPolyIds, -1 );
 
-        if( eErr == CE_None && hMaskBand != nullptr )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize,
-                                    panThisLineVal );
+    for( int i = 0; i < nBatchStrips; i++ )
+    {
+        asJobs[i].panGlobalParent = anParent.empty() ? nullptr : &anParent[0];
+        asJobs[i].panPolySizes =
+            anPolySizes.empty() ? nullptr : &anPolySizes[0];
+        asJobs[i].panPolyValues =
+            anPolyValues.empty() ? nullptr : &anPolyValues[0];
+        asJobs[i].panBigNeighbour =
+            anBigNeighbour.empty() ? nullptr : &anBigNeighbour[0];
+    }
 
+    for( int iBatch = 0; eErr == CE_None && iBatch < nStrips;
+         iBatch += nBatchStrips )
+    {
+        const int nJobs = std::min(nBatchStrips, nStrips - iBatch);
+        for( int iJob = 0; eErr == CE_None && iJob < nJobs; iJob++ )
+        {
+            const int iYOff = (iBatch + iJob) * nStripHeight;
+            asJobs[iJob].nLines = std::min(nStripHeight, nYSize - iYOff);
+            asJobs[iJob].nIdOffset = anStripIdOffset[iBatch + iJob];
+            eErr = GSReadStrip( hSrcBand, hMaskBand, iYOff, false,
+                                abyMask, &asJobs[iJob] );
+        }
         if( eErr != CE_None )
-            continue;
+            break;
 
-/* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
-/* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine(
-                nullptr, panThisLineVal, nullptr, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
+        // Determine what polygon the various pixels belong to (redoing
+        // the same thing done in the first pass above).
+        GSRunJobs( poThreadPool, GSLabelJobFunc, asJobs, nJobs );
 
-/* -------------------------------------------------------------------- */
-/*      Check our neighbours, and update our biggest neighbour map      */
-/*      as appropriate.                                                 */
-/* -------------------------------------------------------------------- */
-        for( int iX = 0; iX < nXSize; iX++ )
+        // Check our neighbours, including those of the line above the
+        // strip.
+        for( int iJob = 0; iJob < nJobs; iJob++ )
         {
-            if( iY > 0 )
+            if( iJob > 0 )
+                asJobs[iJob].panAboveIds = &asJobs[iJob-1].anIds[
+                    static_cast<size_t>(asJobs[iJob-1].nLines - 1) * nXSize];
+            else
+                asJobs[iJob].panAboveIds =
+                    iBatch > 0 ? &anLastLineId[0] : nullptr;
+        }
+        GSRunJobs( poThreadPool, GSNeighbourJobFunc, asJobs, nJobs );
+
+        // Merge the largest neighbours found in each strip, in raster
+        // order, so that the first one met wins in case of ties.
+        for( int iJob = 0; iJob < nJobs; iJob++ )
+        {
+            for( const auto &oIter : asJobs[iJob].oMapBigNeighbour )
             {
-                CompareNeighbour( panThisLineId[iX],
-                                  panLastLineId[iX],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
-
-                if( iX > 0 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX],
-                                      panLastLineId[iX-1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
-
-                if( iX < nXSize-1 && nConnectedness == 8 )
-                    CompareNeighbour( panThisLineId[iX],
-                                      panLastLineId[iX+1],
-                                      oFirstEnum.panPolyIdMap,
-                                      oFirstEnum.panPolyValue,
-                                      anPolySizes, anBigNeighbour );
+                const int iPoly = oIter.first;
+                const int iNeighbour = oIter.second;
+                if( anBigNeighbour[iPoly] == -1
+                    || anPolySizes[anBigNeighbour[iPoly]] <
+                                                anPolySizes[iNeighbour] )
+                    anBigNeighbour[iPoly] = iNeighbour;
             }
-
-            if( iX > 0 )
-                CompareNeighbour( panThisLineId[iX],
-                                  panThisLineId[iX-1],
-                                  oFirstEnum.panPolyIdMap,
-                                  oFirstEnum.panPolyValue,
-                                  anPolySizes, anBigNeighbour );
-
-            // We don't need to compare to next pixel or next line
-            // since they will be compared to us.
+            asJobs[iJob].oMapBigNeighbour.clear();
         }
 
-/* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
-/* -------------------------------------------------------------------- */
-        std::swap(panLastLineVal, panThisLineVal);
-        std::swap(panLastLineId, panThisLineId);
+        const GSStripJob &oLastJob = asJobs[nJobs - 1];
+        memcpy( &anLastLineId[0],
+                &oLastJob.anIds[static_cast<size_t>(oLastJob.nLines - 1) *
+                                nXSize],
+                nXSize * sizeof(GInt32) );
 
 /* -------------------------------------------------------------------- */
 /*      Report progress, and support interrupts.                        */
 /* -------------------------------------------------------------------- */
-        if( eErr == CE_None &&
-            !pfnProgress(0.25 + 0.25 * ((iY + 1) / static_cast<double>(nYSize)),
+        const int iYEnd = std::min(nYSize, (iBatch + nJobs) * nStripHeight);
+        if( !pfnProgress(0.25 + 0.25 * (iYEnd / static_cast<double>(nYSize)),
                          "", pProgressArg) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -445,15 +772,9 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
     int nIsolatedSmall = 0;
     int nSieveTargets = 0;
 
-    for( int iPoly = 0; oFirstEnum.panPolyIdMap != nullptr && // for Coverity
-                        oFirstEnum.panPolyValue != nullptr && // for Coverity
-                        iPoly < static_cast<int>(anPolySizes.size()); iPoly++ )
+    for( int iPoly = 0; eErr == CE_None && iPoly < nPolyIds; iPoly++ )
     {
-        if( oFirstEnum.panPolyIdMap[iPoly] != iPoly )
-            continue;
-
-        // Ignore nodata polygons.
-        if( oFirstEnum.panPolyValue[iPoly] == GP_NODATA_MARKER )
+        if( anParent[iPoly] != iPoly )
             continue;
 
         // Don't try to merge polygons larger than the threshold.
@@ -521,80 +842,44 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
 
 /* ==================================================================== */
 /*      Make a third pass over the image, actually applying the         */
-/*      merges.  We reuse the second enumerator but preserve the        */
-/*      "final maps" from the first.                                    */
+/*      merges.                                                         */
 /* ==================================================================== */
-    oSecondEnum.Clear();
-
-    for( int iY = 0; oFirstEnum.panPolyIdMap != nullptr && // for Coverity
-                     eErr == CE_None && iY < nYSize; iY++ )
+    for( int iBatch = 0; eErr == CE_None && iBatch < nStrips;
+         iBatch += nBatchStrips )
     {
-/* -------------------------------------------------------------------- */
-/*      Read the image data.                                            */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hSrcBand, GF_Read, 0, iY, nXSize, 1,
-                             panThisLineVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-        memcpy( panThisLineWriteVal, panThisLineVal, 4 * nXSize );
-
-        if( eErr == CE_None && hMaskBand != nullptr )
-            eErr = GPMaskImageData( hMaskBand, pabyMaskLine, iY, nXSize,
-                                    panThisLineVal );
-
+        const int nJobs = std::min(nBatchStrips, nStrips - iBatch);
+        for( int iJob = 0; eErr == CE_None && iJob < nJobs; iJob++ )
+        {
+            const int iYOff = (iBatch + iJob) * nStripHeight;
+            asJobs[iJob].nLines = std::min(nStripHeight, nYSize - iYOff);
+            asJobs[iJob].nIdOffset = anStripIdOffset[iBatch + iJob];
+            eErr = GSReadStrip( hSrcBand, hMaskBand, iYOff, true,
+                                abyMask, &asJobs[iJob] );
+        }
         if( eErr != CE_None )
-            continue;
+            break;
 
-/* -------------------------------------------------------------------- */
-/*      Determine what polygon the various pixels belong to (redoing    */
-/*      the same thing done in the first pass above).                   */
-/* -------------------------------------------------------------------- */
-        if( iY == 0 )
-            oSecondEnum.ProcessLine(
-                nullptr, panThisLineVal, nullptr, panThisLineId, nXSize );
-        else
-            oSecondEnum.ProcessLine(
-                panLastLineVal, panThisLineVal,
-                panLastLineId,  panThisLineId,
-                nXSize );
+        GSRunJobs( poThreadPool, GSRemapJobFunc, asJobs, nJobs );
 
 /* -------------------------------------------------------------------- */
-/*      Reprocess the actual pixel values according to the polygon      */
-/*      merging, and write out this line of image data.                 */
+/*      Write the update data out.                                      */
 /* -------------------------------------------------------------------- */
-        for( int iX = 0; iX < nXSize; iX++ )
+        for( int iJob = 0; eErr == CE_None && iJob < nJobs; iJob++ )
         {
-            int iThisPoly = panThisLineId[iX];
-            if( iThisPoly >= 0 )
-            {
-                iThisPoly = oFirstEnum.panPolyIdMap[iThisPoly];
-
-                if( anBigNeighbour[iThisPoly] != -1 )
-                {
-                    panThisLineWriteVal[iX] =
-                        oFirstEnum.panPolyValue[
-                            anBigNeighbour[iThisPoly]];
-                }
-            }
+            const int iYOff = (iBatch + iJob) * nStripHeight;
+            eErr = GDALRasterIO( hDstBand, GF_Write, 0, iYOff,
+                                 nXSize, asJobs[iJob].nLines,
+                                 &asJobs[iJob].anRawValues[0],
+                                 nXSize, asJobs[iJob].nLines,
+                                 GDT_Int32, 0, 0 );
         }
 
-/* -------------------------------------------------------------------- */
-/*      Write the update data out.                                      */
-/* -------------------------------------------------------------------- */
-        eErr = GDALRasterIO( hDstBand, GF_Write, 0, iY, nXSize, 1,
-                             panThisLineWriteVal, nXSize, 1, GDT_Int32, 0, 0 );
-
-/* -------------------------------------------------------------------- */
-/*      Swap pixel value, and polygon id lines to be ready for the      */
-/*      next line.                                                      */
-/* -------------------------------------------------------------------- */
-        std::swap(panLastLineVal, panThisLineVal);
-        std::swap(panLastLineId, panThisLineId);
-
 /* -------------------------------------------------------------------- */
 /*      Report progress, and support interrupts.                        */
 /* -------------------------------------------------------------------- */
+        const int iYEnd = std::min(nYSize, (iBatch + nJobs) * nStripHeight);
         if( eErr == CE_None
-            && !pfnProgress(0.5 + 0.5 * ((iY+1) / static_cast<double>(nYSize)),
+            && !pfnProgress(0.5 + 0.5 * (iYEnd / static_cast<double>(nYSize)),
                             "", pProgressArg) )
         {
             CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
@@ -605,12 +890,22 @@ GDALSieveFilter( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
 /* -------------------------------------------------------------------- */
 /*      Cleanup                                                         */
 /* -------------------------------------------------------------------- */
-    CPLFree( panThisLineId );
-    CPLFree( panLastLineId );
-    CPLFree( panThisLineVal );
-    CPLFree( panLastLineVal );
-    CPLFree( panThisLineWriteVal );
-    CPLFree( pabyMaskLine );
+    delete poThreadPool;
 
     return eErr;
 }
+
+/************************************************************************/
+/*                         GDALGetStripHeight()                         */
+/*                                                                      */
+/*      Height of the strips of about one million pixels in which the   */
+/*      algorithms working on several strips in parallel split a        */
+/*      raster of nXSize by nYSize pixels, with at least nMinHeight     */
+/*      lines, and at most nYSize.                                      */
+/************************************************************************/
+
+int GDALGetStripHeight( int nXSize, int nYSize, int nMinHeight )
+{
+    return std::max(1, std::min(nYSize,
+        std::max(nMinHeight, 1024 * 1024 / std::max(1, nXSize))));
+}
@@ -42,7 +42,12 @@
 #include <cstring>
 
 #include <algorithm>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
 
+#include "cpl_atomic_ops.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_list.h"
@@ -2587,6 +2592,8 @@ GDALDeserializeReprojectionTransformer( CPLXMLNode *psTree )
 /* ==================================================================== */
 /************************************************************************/
 
+typedef struct GDALApproxGridCache GDALApproxGridCache;
+
 typedef struct
 {
     GDALTransformerInfo sTI;
@@ -2597,8 +2604,345 @@ typedef struct
     double dfMaxErrorReverse;
 
     int bOwnSubtransformer;
+
+    // Shared between the clones of the transformer. NULL if disabled.
+    GDALApproxGridCache *psGridCache;
 } ApproxTransformInfo;
 
+/************************************************************************/
+/* ==================================================================== */
+/*      Grid cache of the approximate transformer.                      */
+/*                                                                      */
+/*      The input space is divided in square cells of a fixed step,     */
+/*      whose corners are exactly transformed the first time a point    */
+/*      falls into them. If the bilinear interpolation of the corners   */
+/*      is not accurate enough at the middle of the cell and of its     */
+/*      edges, the cell is split in 4, up to a few levels, after which  */
+/*      points are transformed exactly. Cells are never modified once   */
+/*      built, so they can be shared by the clones of the transformer   */
+/*      used by the different warping threads and chunks.               */
+/* ==================================================================== */
+/************************************************************************/
+
+// Number of times a cell of the grid may be split in 4.
+constexpr int APPROX_GRID_MAX_DEPTH = 4;
+
+namespace {
+struct GDALApproxGridCell
+{
+    // Exactly transformed corners: top-left, top-right, bottom-left
+    // and bottom-right.
+    double adfX[4] = {0, 0, 0, 0};
+    double adfY[4] = {0, 0, 0, 0};
+    double adfZ[4] = {0, 0, 0, 0};
+
+    // Points of the cell must be exactly transformed.
+    bool bExact = false;
+
+    // Set if the cell is split, in the same order as the corners.
+    std::unique_ptr<GDALApproxGridCell> apoChildren[4];
+};
+} // namespace
+
+struct GDALApproxGridCache
+{
+    volatile int nRefCount = 1;
+    double dfStep = 0.0;
+    CPLMutex *hMutex = nullptr;
+    // Top level cells, indexed by bDstToSrc.
+    std::map<std::pair<int, int>,
+             std::unique_ptr<GDALApproxGridCell>> aoCells[2];
+};
+
+/************************************************************************/
+/*                      GDALApproxGridCacheCreate()                     */
+/************************************************************************/
+
+static GDALApproxGridCache *GDALApproxGridCacheCreate( double dfStep )
+{
+    GDALApproxGridCache *psCache = new GDALApproxGridCache();
+    psCache->dfStep = dfStep;
+    return psCache;
+}
+
+/************************************************************************/
+/*                      GDALApproxGridCacheRelease()                    */
+/************************************************************************/
+
+static void GDALApproxGridCacheRelease( GDALApproxGridCache *psCache )
+{
+    if( psCache == nullptr || CPLAtomicDec(&(psCache->nRefCount)) != 0 )
+        return;
+    if( psCache->hMutex )
+        CPLDestroyMutex(psCache->hMutex);
+    delete psCache;
+}
+
+/************************************************************************/
+/*                       GDALApproxGridBuildCell()                      */
+/************************************************************************/
+
+// The corners of poCell must be set.
+static void GDALApproxGridBuildCell( ApproxTransformInfo *psATInfo,
+                                     int bDstToSrc,
+                                     double dfX0, double dfY0, double dfSize,
+                                     int nDepth,
+                                     GDALApproxGridCell *poCell )
+{
+/* -------------------------------------------------------------------- */
+/*      Exactly transform the middle of the cell and of its edges:      */
+/*      center, top, left, right and bottom.                            */
+/* -------------------------------------------------------------------- */
+    const double dfHalf = dfSize / 2;
+    double adfX[5] = { dfX0 + dfHalf, dfX0 + dfHalf, dfX0,
+                       dfX0 + dfSize, dfX0 + dfHalf };
+    double adfY[5] = { dfY0 + dfHalf, dfY0, dfY0 + dfHalf,
+                       dfY0 + dfHalf, dfY0 + dfSize };
+    double adfZ[5] = { 0, 0, 0, 0, 0 };
+    int anSuccess[5] = { FALSE, FALSE, FALSE, FALSE, FALSE };
+    if( !psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc, 5,
+                                       adfX, adfY, adfZ, anSuccess ) ||
+        !anSuccess[0] || !anSuccess[1] || !anSuccess[2] ||
+        !anSuccess[3] || !anSuccess[4] )
+    {
+        poCell->bExact = true;
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Compare with the interpolation of the corners.                  */
+/* -------------------------------------------------------------------- */
+    // Pairs of corners whose average approximates each test point.
+    // The center uses the average of the 4 corners.
+    static const int anEdgeCorners[4][2] = { {0, 1}, {0, 2}, {1, 3}, {2, 3} };
+
+    const double* padfCX = poCell->adfX;
+    const double* padfCY = poCell->adfY;
+    double dfError =
+        fabs((padfCX[0] + padfCX[1] + padfCX[2] + padfCX[3]) / 4 - adfX[0]) +
+        fabs((padfCY[0] + padfCY[1] + padfCY[2] + padfCY[3]) / 4 - adfY[0]);
+    for( int i = 0; i < 4; i++ )
+    {
+        const int iA = anEdgeCorners[i][0];
+        const int iB = anEdgeCorners[i][1];
+        dfError = std::max(dfError,
+            fabs((padfCX[iA] + padfCX[iB]) / 2 - adfX[i + 1]) +
+            fabs((padfCY[iA] + padfCY[iB]) / 2 - adfY[i + 1]));
+    }
+
+    const double dfMaxError = bDstToSrc ? psATInfo->dfMaxErrorReverse :
+                                          psATInfo->dfMaxErrorForward;
+    if( dfError <= dfMaxError )
+        return;
+
+    if( nDepth == APPROX_GRID_MAX_DEPTH )
+    {
+        poCell->bExact = true;
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Split the cell. The corners of the children are the corners     */
+/*      of the cell and the points we have just transformed, laid out   */
+/*      as a 3x3 grid.                                                  */
+/* -------------------------------------------------------------------- */
+    const double adfGridX[9] = { padfCX[0], adfX[1], padfCX[1],
+                                 adfX[2], adfX[0], adfX[3],
+                                 padfCX[2], adfX[4], padfCX[3] };
+    const double adfGridY[9] = { padfCY[0], adfY[1], padfCY[1],
+                                 adfY[2], adfY[0], adfY[3],
+                                 padfCY[2], adfY[4], padfCY[3] };
+    const double adfGridZ[9] = { poCell->adfZ[0], adfZ[1], poCell->adfZ[1],
+                                 adfZ[2], adfZ[0], adfZ[3],
+                                 poCell->adfZ[2], adfZ[4], poCell->adfZ[3] };
+
+    for( int iChild = 0; iChild < 4; iChild++ )
+    {
+        const int iChildX = iChild % 2;
+        const int iChildY = iChild / 2;
+        GDALApproxGridCell *poChild = new GDALApproxGridCell();
+        poCell->apoChildren[iChild].reset(poChild);
+        for( int iCorner = 0; iCorner < 4; iCorner++ )
+        {
+            const int iGrid =
+                (iChildY + iCorner / 2) * 3 + iChildX + iCorner % 2;
+            poChild->adfX[iCorner] = adfGridX[iGrid];
+            poChild->adfY[iCorner] = adfGridY[iGrid];
+            poChild->adfZ[iCorner] = adfGridZ[iGrid];
+        }
+        GDALApproxGridBuildCell( psATInfo, bDstToSrc,
+                                 dfX0 + iChildX * dfHalf,
+                                 dfY0 + iChildY * dfHalf,
+                                 dfHalf, nDepth + 1, poChild );
+    }
+}
+
+/************************************************************************/
+/*                        GDALApproxGridGetCell()                       */
+/************************************************************************/
+
+static const GDALApproxGridCell *
+GDALApproxGridGetCell( ApproxTransformInfo *psATInfo, int bDstToSrc,
+                       int nCellX, int nCellY )
+{
+    GDALApproxGridCache *psCache = psATInfo->psGridCache;
+    const std::pair<int, int> oKey(nCellX, nCellY);
+    std::map<std::pair<int, int>,
+             std::unique_ptr<GDALApproxGridCell>>& oCells =
+        psCache->aoCells[bDstToSrc ? 1 : 0];
+
+    {
+        CPLMutexHolderD( &(psCache->hMutex) );
+        auto oIter = oCells.find(oKey);
+        if( oIter != oCells.end() )
+            return oIter->second.get();
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Build the cell without holding the mutex, as the base           */
+/*      transformer may be slow. If another thread has built it in      */
+/*      the meantime, ours is discarded.                                */
+/* -------------------------------------------------------------------- */
+    const double dfStep = psCache->dfStep;
+    const double dfX0 = nCellX * dfStep;
+    const double dfY0 = nCellY * dfStep;
+    std::unique_ptr<GDALApproxGridCell> poCell(new GDALApproxGridCell());
+    double adfX[4] = { dfX0, dfX0 + dfStep, dfX0, dfX0 + dfStep };
+    double adfY[4] = { dfY0, dfY0, dfY0 + dfStep, dfY0 + dfStep };
+    double adfZ[4] = { 0, 0, 0, 0 };
+    int anSuccess[4] = { FALSE, FALSE, FALSE, FALSE };
+    if( !psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc, 4,
+                                       adfX, adfY, adfZ, anSuccess ) ||
+        !anSuccess[0] || !anSuccess[1] || !anSuccess[2] || !anSuccess[3] )
+    {
+        poCell->bExact = true;
+    }
+    else
+    {
+        memcpy(poCell->adfX, adfX, sizeof(adfX));
+        memcpy(poCell->adfY, adfY, sizeof(adfY));
+        memcpy(poCell->adfZ, adfZ, sizeof(adfZ));
+        GDALApproxGridBuildCell( psATInfo, bDstToSrc, dfX0, dfY0, dfStep,
+                                 0, poCell.get() );
+    }
+
+    CPLMutexHolderD( &(psCache->hMutex) );
+    auto oIter = oCells.find(oKey);
+    if( oIter != oCells.end() )
+        return oIter->second.get();
+    const GDALApproxGridCell *poRet = poCell.get();
+    oCells[oKey] = std::move(poCell);
+    return poRet;
+}
+
+/************************************************************************/
+/*                        GDALApproxTransformGrid()                     */
+/************************************************************************/
+
+static int GDALApproxTransformGrid( ApproxTransformInfo *psATInfo,
+                                    int bDstToSrc, int nPoints,
+                                    double *x, double *y, double *z,
+                                    int *panSuccess )
+{
+    const double dfStep = psATInfo->psGridCache->dfStep;
+    std::vector<int> anExact;
+
+    // Consecutive points generally fall in the same cell.
+    const GDALApproxGridCell *poLastCell = nullptr;
+    int nLastCellX = 0;
+    int nLastCellY = 0;
+
+    for( int i = 0; i < nPoints; i++ )
+    {
+        const double dfCellX = floor(x[i] / dfStep);
+        const double dfCellY = floor(y[i] / dfStep);
+        if( !(fabs(dfCellX) < INT_MAX && fabs(dfCellY) < INT_MAX) )
+        {
+            anExact.push_back(i);
+            continue;
+        }
+        const int nCellX = static_cast<int>(dfCellX);
+        const int nCellY = static_cast<int>(dfCellY);
+        if( poLastCell == nullptr || nCellX != nLastCellX ||
+            nCellY != nLastCellY )
+        {
+            poLastCell = GDALApproxGridGetCell( psATInfo, bDstToSrc,
+                                                nCellX, nCellY );
+            nLastCellX = nCellX;
+            nLastCellY = nCellY;
+        }
+
+        // Walk down to the leaf containing the point.
+        const GDALApproxGridCell *poCell = poLastCell;
+        double dfU = x[i] / dfStep - dfCellX;
+        double dfV = y[i] / dfStep - dfCellY;
+        while( poCell->apoChildren[0] )
+        {
+            const int iChildX = dfU >= 0.5 ? 1 : 0;
+            const int iChildY = dfV >= 0.5 ? 1 : 0;
+            poCell = poCell->apoChildren[iChildY * 2 + iChildX].get();
+            dfU = dfU * 2 - iChildX;
+            dfV = dfV * 2 - iChildY;
+        }
+        if( poCell->bExact )
+        {
+            anExact.push_back(i);
+            continue;
+        }
+
+        const double dfW0 = (1 - dfU) * (1 - dfV);
+        const double dfW1 = dfU * (1 - dfV);
+        const double dfW2 = (1 - dfU) * dfV;
+        const double dfW3 = dfU * dfV;
+        x[i] = dfW0 * poCell->adfX[0] + dfW1 * poCell->adfX[1] +
+               dfW2 * poCell->adfX[2] + dfW3 * poCell->adfX[3];
+        y[i] = dfW0 * poCell->adfY[0] + dfW1 * poCell->adfY[1] +
+               dfW2 * poCell->adfY[2] + dfW3 * poCell->adfY[3];
+        z[i] = dfW0 * poCell->adfZ[0] + dfW1 * poCell->adfZ[1] +
+               dfW2 * poCell->adfZ[2] + dfW3 * poCell->adfZ[3];
+        panSuccess[i] = TRUE;
+    }
+
+    if( anExact.empty() )
+        return TRUE;
+
+/* -------------------------------------------------------------------- */
+/*      Transform exactly, in one go, the points of the cells where     */
+/*      interpolation is not accurate enough.                           */
+/* -------------------------------------------------------------------- */
+    if( static_cast<int>(anExact.size()) == nPoints )
+    {
+        return psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData,
+                                             bDstToSrc, nPoints,
+                                             x, y, z, panSuccess );
+    }
+
+    const size_t nExact = anExact.size();
+    std::vector<double> adfX(nExact);
+    std::vector<double> adfY(nExact);
+    std::vector<double> adfZ(nExact);
+    std::vector<int> anSuccess(nExact);
+    for( size_t i = 0; i < nExact; i++ )
+    {
+        adfX[i] = x[anExact[i]];
+        adfY[i] = y[anExact[i]];
+        adfZ[i] = z[anExact[i]];
+    }
+    const int bRet =
+        psATInfo->pfnBaseTransformer( psATInfo->pBaseCBData, bDstToSrc,
+                                      static_cast<int>(nExact),
+                                      &adfX[0], &adfY[0], &adfZ[0],
+                                      &anSuccess[0] );
+    for( size_t i = 0; i < nExact; i++ )
+    {
+        x[anExact[i]] = adfX[i];
+        y[anExact[i]] = adfY[i];
+        z[anExact[i]] = adfZ[i];
+        panSuccess[anExact[i]] = anSuccess[i];
+    }
+    return bRet;
+}
+
 /************************************************************************/
 /*                  GDALCreateSimilarApproxTransformer()                */
 /************************************************************************/
@@ -2631,6 +2975,20 @@ GDALCreateSimilarApproxTransformer( void *hTransformArg,
     }
     psClonedInfo->bOwnSubtransformer = TRUE;
 
+    // Clones of the same transformer share the grid cache.
+    if( psInfo->psGridCache != nullptr )
+    {
+        if( dfSrcRatioX == 1.0 && dfSrcRatioY == 1.0 )
+        {
+            CPLAtomicInc(&(psInfo->psGridCache->nRefCount));
+        }
+        else
+        {
+            psClonedInfo->psGridCache =
+                GDALApproxGridCacheCreate(psInfo->psGridCache->dfStep);
+        }
+    }
+
     return psClonedInfo;
 }
 
@@ -2664,6 +3022,12 @@ GDALSerializeApproxTransformer( void *pTransformArg )
                         CPLString().Printf("%g", psInfo->dfMaxErrorReverse) );
     }
 
+    if( psInfo->psGridCache != nullptr )
+    {
+        CPLCreateXMLElementAndValue( psTree, "GridStep",
+                        CPLString().Printf("%g", psInfo->psGridCache->dfStep) );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Capture underlying transformer.                                 */
 /* -------------------------------------------------------------------- */
@@ -2710,6 +3074,17 @@ GDALSerializeApproxTransformer( void *pTransformArg )
  * circumstances as little internal validation is done, in order to keep things
  * fast.
  *
+ * Starting with GDAL 2.4, if the GDAL_APPROX_TRANSFORMER_GRID_STEP
+ * configuration option is set to a positive value, the input space is instead
+ * divided in cells of that size (in pixels, when approximating
+ * GDALGenImgProjTransform()), whose corners are exactly transformed on first
+ * use and then bilinearly interpolated. Cells where the interpolation error is
+ * over the threshold are adaptively split, and exact transformation is used
+ * where this is not sufficient. The cells are shared by all the clones of the
+ * transformer, such as the ones used by the warping threads, so each part of
+ * the grid is computed only once. This is mostly interesting for costly base
+ * transformers (GCP/TPS, RPC, geolocation arrays).
+ *
  * @param pfnBaseTransformer the high precision transformer which should be
  * approximated.
  * @param pBaseTransformArg the callback argument for the high precision
@@ -2746,6 +3121,12 @@ void *GDALCreateApproxTransformer2( GDALTransformerFunc pfnBaseTransformer,
     psATInfo->dfMaxErrorForward = dfMaxErrorForward;
     psATInfo->dfMaxErrorReverse = dfMaxErrorReverse;
     psATInfo->bOwnSubtransformer = FALSE;
+    psATInfo->psGridCache = nullptr;
+
+    const double dfGridStep =
+        CPLAtof(CPLGetConfigOption("GDAL_APPROX_TRANSFORMER_GRID_STEP", "0"));
+    if( dfGridStep > 0 )
+        psATInfo->psGridCache = GDALApproxGridCacheCreate(dfGridStep);
 
     memcpy(psATInfo->sTI.abySignature,
            GDAL_GTI2_SIGNATURE,
@@ -2796,6 +3177,8 @@ void GDALDestroyApproxTransformer( void * pCBData )
     if( psATInfo->bOwnSubtransformer )
         GDALDestroyTransformer( psATInfo->pBaseCBData );
 
+    GDALApproxGridCacheRelease( psATInfo->psGridCache );
+
     CPLFree( pCBData );
 }
 
@@ -3116,6 +3499,22 @@ int GDALApproxTransform( void *pCBData, int bDstToSrc, int nPoints,
 
     const int nMiddle = (nPoints - 1) / 2;
 
+/* -------------------------------------------------------------------- */
+/*      Use the grid cache if enabled. It ignores the input Z, which    */
+/*      is generally 0.                                                 */
+/* -------------------------------------------------------------------- */
+    const double dfMaxError = bDstToSrc ? psATInfo->dfMaxErrorReverse :
+                                          psATInfo->dfMaxErrorForward;
+    if( psATInfo->psGridCache != nullptr && dfMaxError > 0.0 )
+    {
+        bool bZIsZero = true;
+        for( int i = 0; bZIsZero && i < nPoints; i++ )
+            bZIsZero = z[i] == 0.0;
+        if( bZIsZero )
+            return GDALApproxTransformGrid( psATInfo, bDstToSrc, nPoints,
+                                            x, y, z, panSuccess );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Bail if our preconditions are not met, or if error is not       */
 /*      acceptable.                                                     */
@@ -3224,6 +3623,18 @@ GDALDeserializeApproxTransformer( CPLXMLNode *psTree )
                                                         dfMaxErrorReverse );
     GDALApproxTransformerOwnsSubtransformer( pApproxCBData, TRUE );
 
+    const char* pszGridStep = CPLGetXMLValue( psTree, "GridStep", nullptr );
+    if( pszGridStep != nullptr )
+    {
+        ApproxTransformInfo *psATInfo =
+            static_cast<ApproxTransformInfo *>(pApproxCBData);
+        GDALApproxGridCacheRelease( psATInfo->psGridCache );
+        psATInfo->psGridCache = nullptr;
+        const double dfGridStep = CPLAtof(pszGridStep);
+        if( dfGridStep > 0 )
+            psATInfo->psGridCache = GDALApproxGridCacheCreate(dfGridStep);
+    }
+
     return pApproxCBData;
 }
 
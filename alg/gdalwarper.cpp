@@ -1141,6 +1141,12 @@ GDALWarpDstAlphaMasker( void *pMaskFuncArg, int nBandCount,
  * set the number of threads to use to parallelize the computation part of the
  * warping. If not set, computation will be done in a single thread.</li>
  *
+ * <li>NUM_CHUNK_THREADS: Can be set to a numeric value or ALL_CPUS to set the
+ * number of chunks processed concurrently by
+ * GDALWarpOperation::ChunkAndWarpMulti(). Defaults to 2. Each chunk in
+ * flight uses up to dfWarpMemoryLimit bytes, and its computation is
+ * itself parallelized according to NUM_THREADS.</li>
+ *
  * <li>STREAMABLE_OUTPUT: (GDAL >= 2.0) This defaults to FALSE, but may
  * be set to TRUE typically when writing to a streamed file. The
  * gdalwarp utility automatically sets this option when writing to
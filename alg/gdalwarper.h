@@ -419,6 +419,20 @@ void* GWKThreadsCreate(char** papszWarpOptions,
                        GDALTransformerFunc pfnTransformer,
                        void* pTransformerArg);
 void GWKThreadsEnd(void* psThreadDataIn);
+
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+/* Implemented in gdalwarpkernel_avx2.cpp */
+bool GWKGetPixelRowAVX2( GDALWarpKernel *poWK, int iBand,
+                         int iSrcOffset, int nHalfSrcLen,
+                         double* padfDensity, double* padfReal );
+void GWKAccumulateRowDensityAVX2( const double* padfRowReal,
+                                  const double* padfRowDensity,
+                                  const double* padfWeightsX, int nCount,
+                                  double dfWeight1,
+                                  double* pdfAccumulatorReal,
+                                  double* pdfAccumulatorDensity,
+                                  double* pdfAccumulatorWeight );
+#endif
 /*! @endcond */
 
 /************************************************************************/
@@ -433,6 +447,7 @@ void GWKThreadsEnd(void* psThreadDataIn);
 
 /*! @cond Doxygen_Suppress */
 typedef struct _GDALWarpChunk GDALWarpChunk;
+typedef struct _GDALWarpChunkWorker GDALWarpChunkWorker;
 /*! @endcond */
 
 class CPL_DLL GDALWarpOperation {
@@ -471,6 +486,28 @@ private:
                                       int nDstXSize, int nDstYSize );
     void            ReportTiming( const char * );
 
+    CPLErr          WarpRegionInternal( int nDstXOff, int nDstYOff,
+                                        int nDstXSize, int nDstYSize,
+                                        int nSrcXOff, int nSrcYOff,
+                                        int nSrcXSize, int nSrcYSize,
+                                        double dfSrcXExtraSize,
+                                        double dfSrcYExtraSize,
+                                        double dfProgressBase,
+                                        double dfProgressScale,
+                                        GDALWarpChunkWorker* psWorker );
+    CPLErr          WarpRegionToBufferInternal( int nDstXOff, int nDstYOff,
+                                        int nDstXSize, int nDstYSize,
+                                        void *pDataBuf,
+                                        GDALDataType eBufDataType,
+                                        int nSrcXOff, int nSrcYOff,
+                                        int nSrcXSize, int nSrcYSize,
+                                        double dfSrcXExtraSize,
+                                        double dfSrcYExtraSize,
+                                        double dfProgressBase,
+                                        double dfProgressScale,
+                                        GDALWarpChunkWorker* psWorker );
+    static void     ChunkThreadMain( void *pThreadData );
+
 public:
                     GDALWarpOperation();
     virtual        ~GDALWarpOperation();
@@ -45,6 +45,7 @@
 
 #include "cpl_atomic_ops.h"
 #include "cpl_conv.h"
+#include "cpl_cpu_features.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_progress.h"
@@ -1975,6 +1976,20 @@ static bool GWKGetPixelValueReal( GDALWarpKernel *poWK, int iBand,
     return *pdfDensity != 0.0;
 }
 
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+/************************************************************************/
+/*                            GWKHaveAVX2()                             */
+/************************************************************************/
+
+static bool GWKHaveAVX2()
+{
+    static const bool bHaveAVX2 =
+        CPLHaveRuntimeAVX2() &&
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES"));
+    return bHaveAVX2;
+}
+#endif
+
 /************************************************************************/
 /*                          GWKGetPixelRow()                            */
 /************************************************************************/
@@ -1988,6 +2003,19 @@ static bool GWKGetPixelRow( GDALWarpKernel *poWK, int iBand,
                             double adfReal[],
                             double* padfImag )
 {
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+    // Rows of 2 pixels (bilinear) are too short to benefit from AVX2.
+    if( nHalfSrcLen >= 2 &&
+        (poWK->eWorkingDataType == GDT_Byte ||
+         poWK->eWorkingDataType == GDT_UInt16 ||
+         poWK->eWorkingDataType == GDT_Float32) &&
+        GWKHaveAVX2() )
+    {
+        return GWKGetPixelRowAVX2( poWK, iBand, iSrcOffset, nHalfSrcLen,
+                                   padfDensity, adfReal );
+    }
+#endif
+
     // We know that nSrcLen is even, so we can *always* unroll loops 2x.
     const int nSrcLen = nHalfSrcLen * 2;
     bool bHasValid = false;
@@ -3726,6 +3754,18 @@ static bool GWKResampleOptimizedLanczos( GDALWarpKernel *poWK, int iBand,
         const double dfWeight1 = padfWeightsY[j-poWK->nFiltInitY];
 
         // Iterate over pixels in row.
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+        if( padfRowDensity != nullptr && bIsNonComplex && GWKHaveAVX2() )
+        {
+            GWKAccumulateRowDensityAVX2(
+                padfRowReal, padfRowDensity,
+                padfWeightsX + iMin - poWK->nFiltInitX, iMax - iMin + 1,
+                dfWeight1,
+                &dfAccumulatorReal, &dfAccumulatorDensity,
+                &dfAccumulatorWeight );
+        }
+        else
+#endif
         if( padfRowDensity != nullptr )
         {
             for( int i = iMin; i <= iMax; ++i )
@@ -0,0 +1,346 @@
+/******************************************************************************
+ *
+ * Project:  High Performance Image Reprojector
+ * Purpose:  AVX2 optimized row fetching and accumulation for the masked
+ *           resampling paths of the warp kernel.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+#include "gdalwarper.h"
+
+#include <cstring>
+
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+#include <immintrin.h>
+
+CPL_CVSID("$Id$")
+
+// Must be kept in sync with the value in gdalwarpkernel.cpp.
+constexpr float SRC_DENSITY_THRESHOLD = 0.000000001f;
+
+/************************************************************************/
+/*                          GWKGetValidBits4()                          */
+/*                                                                      */
+/*      Return the validity bits of pixels iOffset to iOffset+3 in      */
+/*      the 4 lowest bits of the result.                                */
+/************************************************************************/
+
+static inline int GWKGetValidBits4( const GUInt32* panValid, int iOffset )
+{
+    const int iWord = iOffset >> 5;
+    const int iShift = iOffset & 0x1f;
+    GUInt32 nBits = panValid[iWord] >> iShift;
+    if( iShift > 28 )
+        nBits |= panValid[iWord + 1] << (32 - iShift);
+    return static_cast<int>(nBits & 0xf);
+}
+
+/************************************************************************/
+/*                        GWKValidBitsToMask()                          */
+/************************************************************************/
+
+static inline __m256d GWKValidBitsToMask( int nBits )
+{
+    const __m256i sel = _mm256_set_epi64x(8, 4, 2, 1);
+    const __m256i bits = _mm256_and_si256(_mm256_set1_epi64x(nBits), sel);
+    return _mm256_castsi256_pd(_mm256_cmpeq_epi64(bits, sel));
+}
+
+/************************************************************************/
+/*                         GWKGetPixelRowAVX2()                         */
+/*                                                                      */
+/*      Equivalent of GWKGetPixelRow() for the Byte, UInt16 and         */
+/*      Float32 working data types, processing 4 pixels at a time.      */
+/************************************************************************/
+
+bool GWKGetPixelRowAVX2( GDALWarpKernel *poWK, int iBand,
+                         int iSrcOffset, int nHalfSrcLen,
+                         double* padfDensity, double* padfReal )
+{
+    const int nSrcLen = nHalfSrcLen * 2;
+    const int nVecLen = nSrcLen & ~3;
+
+/* -------------------------------------------------------------------- */
+/*      Compute the density from the validity masks.                    */
+/* -------------------------------------------------------------------- */
+    if( padfDensity != nullptr )
+    {
+        const GUInt32* panUnifiedSrcValid = poWK->panUnifiedSrcValid;
+        const GUInt32* panBandSrcValid =
+            poWK->papanBandSrcValid != nullptr ?
+                poWK->papanBandSrcValid[iBand] : nullptr;
+        int nUnifiedValidAny = panUnifiedSrcValid == nullptr ? 1 : 0;
+        int nBandValidAny = panBandSrcValid == nullptr ? 1 : 0;
+        const __m256d one = _mm256_set1_pd(1.0);
+
+        int i = 0;
+        for( ; i < nVecLen; i += 4 )
+        {
+            __m256d dens = one;
+            if( panUnifiedSrcValid != nullptr )
+            {
+                const int nBits =
+                    GWKGetValidBits4(panUnifiedSrcValid, iSrcOffset + i);
+                nUnifiedValidAny |= nBits;
+                dens = _mm256_and_pd(dens, GWKValidBitsToMask(nBits));
+            }
+            if( panBandSrcValid != nullptr )
+            {
+                const int nBits =
+                    GWKGetValidBits4(panBandSrcValid, iSrcOffset + i);
+                nBandValidAny |= nBits;
+                dens = _mm256_and_pd(dens, GWKValidBitsToMask(nBits));
+            }
+            _mm256_storeu_pd(padfDensity + i, dens);
+        }
+        for( ; i < nSrcLen; ++i )
+        {
+            const int iOffset = iSrcOffset + i;
+            padfDensity[i] = 1.0;
+            if( panUnifiedSrcValid != nullptr )
+            {
+                if( panUnifiedSrcValid[iOffset >> 5] &
+                    (0x01 << (iOffset & 0x1f)) )
+                    nUnifiedValidAny = 1;
+                else
+                    padfDensity[i] = 0.0;
+            }
+            if( panBandSrcValid != nullptr )
+            {
+                if( panBandSrcValid[iOffset >> 5] &
+                    (0x01 << (iOffset & 0x1f)) )
+                    nBandValidAny = 1;
+                else
+                    padfDensity[i] = 0.0;
+            }
+        }
+
+        if( !nUnifiedValidAny || !nBandValidAny )
+        {
+#if defined(__GNUC__) && !defined(__clang__)
+            _mm256_zeroupper();
+#endif
+            return false;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fetch data.                                                     */
+/* -------------------------------------------------------------------- */
+    switch( poWK->eWorkingDataType )
+    {
+        case GDT_Byte:
+        {
+            const GByte* pSrc = poWK->papabySrcImage[iBand] + iSrcOffset;
+            int i = 0;
+            for( ; i < nVecLen; i += 4 )
+            {
+                int nFourBytes = 0;
+                memcpy(&nFourBytes, pSrc + i, sizeof(nFourBytes));
+                const __m128i v =
+                    _mm_cvtepu8_epi32(_mm_cvtsi32_si128(nFourBytes));
+                _mm256_storeu_pd(padfReal + i, _mm256_cvtepi32_pd(v));
+            }
+            for( ; i < nSrcLen; ++i )
+                padfReal[i] = pSrc[i];
+            break;
+        }
+
+        case GDT_UInt16:
+        {
+            const GUInt16* pSrc = reinterpret_cast<const GUInt16*>(
+                poWK->papabySrcImage[iBand]) + iSrcOffset;
+            int i = 0;
+            for( ; i < nVecLen; i += 4 )
+            {
+                const __m128i v = _mm_cvtepu16_epi32(_mm_loadl_epi64(
+                    reinterpret_cast<const __m128i*>(pSrc + i)));
+                _mm256_storeu_pd(padfReal + i, _mm256_cvtepi32_pd(v));
+            }
+            for( ; i < nSrcLen; ++i )
+                padfReal[i] = pSrc[i];
+            break;
+        }
+
+        case GDT_Float32:
+        {
+            const float* pSrc = reinterpret_cast<const float*>(
+                poWK->papabySrcImage[iBand]) + iSrcOffset;
+            int i = 0;
+            for( ; i < nVecLen; i += 4 )
+            {
+                _mm256_storeu_pd(padfReal + i,
+                                 _mm256_cvtps_pd(_mm_loadu_ps(pSrc + i)));
+            }
+            for( ; i < nSrcLen; ++i )
+                padfReal[i] = pSrc[i];
+            break;
+        }
+
+        default:
+            CPLAssert(false);
+            if( padfDensity )
+                memset( padfDensity, 0, nSrcLen * sizeof(double) );
+#if defined(__GNUC__) && !defined(__clang__)
+            _mm256_zeroupper();
+#endif
+            return false;
+    }
+
+    if( padfDensity == nullptr )
+    {
+#if defined(__GNUC__) && !defined(__clang__)
+        _mm256_zeroupper();
+#endif
+        return true;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Take into account the unified source density.                   */
+/* -------------------------------------------------------------------- */
+    bool bHasValid = false;
+    const float* pafUnifiedSrcDensity = poWK->pafUnifiedSrcDensity;
+    const __m256d threshold =
+        _mm256_set1_pd(static_cast<double>(SRC_DENSITY_THRESHOLD));
+    int i = 0;
+    if( pafUnifiedSrcDensity == nullptr )
+    {
+        __m256d anyValid = _mm256_setzero_pd();
+        for( ; i < nVecLen; i += 4 )
+        {
+            anyValid = _mm256_or_pd(anyValid,
+                _mm256_cmp_pd(_mm256_loadu_pd(padfDensity + i),
+                              threshold, _CMP_GT_OQ));
+        }
+        bHasValid = _mm256_movemask_pd(anyValid) != 0;
+        for( ; i < nSrcLen; ++i )
+        {
+            if( padfDensity[i] > SRC_DENSITY_THRESHOLD )
+                bHasValid = true;
+        }
+    }
+    else
+    {
+        pafUnifiedSrcDensity += iSrcOffset;
+        __m256d anyValid = _mm256_setzero_pd();
+        for( ; i < nVecLen; i += 4 )
+        {
+            __m256d dens = _mm256_loadu_pd(padfDensity + i);
+            const __m256d unified =
+                _mm256_cvtps_pd(_mm_loadu_ps(pafUnifiedSrcDensity + i));
+            dens = _mm256_blendv_pd(
+                dens, unified, _mm256_cmp_pd(dens, threshold, _CMP_GT_OQ));
+            anyValid = _mm256_or_pd(anyValid,
+                _mm256_cmp_pd(dens, threshold, _CMP_GT_OQ));
+            _mm256_storeu_pd(padfDensity + i, dens);
+        }
+        bHasValid = _mm256_movemask_pd(anyValid) != 0;
+        for( ; i < nSrcLen; ++i )
+        {
+            if( padfDensity[i] > SRC_DENSITY_THRESHOLD )
+                padfDensity[i] = pafUnifiedSrcDensity[i];
+            if( padfDensity[i] > SRC_DENSITY_THRESHOLD )
+                bHasValid = true;
+        }
+    }
+
+    // GCC needs explicit zeroing.
+#if defined(__GNUC__) && !defined(__clang__)
+    _mm256_zeroupper();
+#endif
+
+    return bHasValid;
+}
+
+/************************************************************************/
+/*                    GWKAccumulateRowDensityAVX2()                     */
+/*                                                                      */
+/*      Accumulate the contribution of a row of non-complex pixels,     */
+/*      skipping the ones whose density is below the threshold.         */
+/************************************************************************/
+
+void GWKAccumulateRowDensityAVX2( const double* padfRowReal,
+                                  const double* padfRowDensity,
+                                  const double* padfWeightsX, int nCount,
+                                  double dfWeight1,
+                                  double* pdfAccumulatorReal,
+                                  double* pdfAccumulatorDensity,
+                                  double* pdfAccumulatorWeight )
+{
+    const __m256d threshold =
+        _mm256_set1_pd(static_cast<double>(SRC_DENSITY_THRESHOLD));
+    const __m256d weight1 = _mm256_set1_pd(dfWeight1);
+    __m256d accReal = _mm256_setzero_pd();
+    __m256d accDensity = _mm256_setzero_pd();
+    __m256d accWeight = _mm256_setzero_pd();
+
+    int i = 0;
+    for( ; i + 4 <= nCount; i += 4 )
+    {
+        const __m256d dens = _mm256_loadu_pd(padfRowDensity + i);
+        // Invalid pixels may hold NaN values, so the products must be
+        // masked rather than the weights.
+        const __m256d mask = _mm256_cmp_pd(dens, threshold, _CMP_NLT_UQ);
+        const __m256d weight2 =
+            _mm256_mul_pd(weight1, _mm256_loadu_pd(padfWeightsX + i));
+        accReal = _mm256_add_pd(accReal, _mm256_and_pd(mask,
+            _mm256_mul_pd(_mm256_loadu_pd(padfRowReal + i), weight2)));
+        accDensity = _mm256_add_pd(accDensity, _mm256_and_pd(mask,
+            _mm256_mul_pd(dens, weight2)));
+        accWeight = _mm256_add_pd(accWeight, _mm256_and_pd(mask, weight2));
+    }
+
+    double adfReal[4];
+    double adfDensity[4];
+    double adfWeight[4];
+    _mm256_storeu_pd(adfReal, accReal);
+    _mm256_storeu_pd(adfDensity, accDensity);
+    _mm256_storeu_pd(adfWeight, accWeight);
+    double dfAccReal = (adfReal[0] + adfReal[1]) + (adfReal[2] + adfReal[3]);
+    double dfAccDensity =
+        (adfDensity[0] + adfDensity[1]) + (adfDensity[2] + adfDensity[3]);
+    double dfAccWeight =
+        (adfWeight[0] + adfWeight[1]) + (adfWeight[2] + adfWeight[3]);
+
+    for( ; i < nCount; ++i )
+    {
+        if( padfRowDensity[i] < SRC_DENSITY_THRESHOLD )
+            continue;
+        const double dfWeight2 = dfWeight1 * padfWeightsX[i];
+        dfAccReal += padfRowReal[i] * dfWeight2;
+        dfAccDensity += padfRowDensity[i] * dfWeight2;
+        dfAccWeight += dfWeight2;
+    }
+
+    *pdfAccumulatorReal += dfAccReal;
+    *pdfAccumulatorDensity += dfAccDensity;
+    *pdfAccumulatorWeight += dfAccWeight;
+
+    // GCC needs explicit zeroing.
+#if defined(__GNUC__) && !defined(__clang__)
+    _mm256_zeroupper();
+#endif
+}
+
+#endif /* HAVE_AVX2_AT_COMPILE_TIME */
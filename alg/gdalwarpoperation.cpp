@@ -38,6 +38,7 @@
 
 #include <algorithm>
 #include <limits>
+#include <vector>
 
 #include "cpl_config.h"
 #include "cpl_conv.h"
@@ -45,7 +46,9 @@
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
+#include "gdal_alg_priv.h"
 #include "gdal_priv.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
@@ -157,10 +160,9 @@ GDALWarpOperation::~GDALWarpOperation()
     WipeOptions();
 
     if( hIOMutex != nullptr )
-    {
         CPLDestroyMutex( hIOMutex );
+    if( hWarpMutex != nullptr )
         CPLDestroyMutex( hWarpMutex );
-    }
 
     WipeChunkList();
     if( psThreadData )
@@ -931,62 +933,143 @@ CPLErr GDALChunkAndWarpImage( GDALWarpOperationH hOperation,
 /*                          ChunkThreadMain()                           */
 /************************************************************************/
 
+// State shared by all the workers of ChunkAndWarpMulti().
 typedef struct
 {
-    GDALWarpOperation *poOperation;
-    GDALWarpChunk     *pasChunkInfo;
-    CPLJoinableThread *hThreadHandle;
-    CPLErr             eErr;
-    double             dfProgressBase;
-    double             dfProgressScale;
-    CPLMutex          *hIOMutex;
+    const GDALWarpChunk *pasChunkList;
+    int                  nChunkCount;
+    const double        *padfProgressBase;
+    double               dfTotalPixels;
+
+    // Protected by hMutex.
+    CPLMutex            *hMutex;
+    CPLCond             *hCond;
+    int                  nNextChunk;
+    int                  nNextChunkToWrite;
+    bool                 bAbort;
+    double               dfProgress;
+    GDALProgressFunc     pfnProgress;
+    void                *pProgressArg;
+} ChunkSchedulerData;
+
+struct _GDALWarpChunkWorker
+{
+    GDALWarpOperation  *poOperation;
+    ChunkSchedulerData *psScheduler;
+    CPLMutex           *hIOMutex;
+    // Whether hIOMutex is currently held by the worker thread.
+    bool                bIOMutexHeld;
+    // Private transformer and kernel thread data, or nullptr if the
+    // transformer could not be cloned and the warp mutex must be used.
+    void               *pTransformerArg;
+    void               *psThreadData;
+    CPLJoinableThread  *hThreadHandle;
+    int                 iChunk;
+    double              dfLastProgress;
+    CPLErr              eErr;
+};
 
-    CPLMutex          *hCondMutex;
-    volatile int       bIOMutexTaken;
-    CPLCond           *hCond;
-} ChunkThreadData;
+/************************************************************************/
+/*                          ChunkProgress()                             */
+/************************************************************************/
+
+// Accumulates the progress of the chunks being concurrently warped, and
+// forwards it to the user progress function in a serialized way.
+static int CPL_STDCALL ChunkProgress( double dfComplete, const char *pszMessage,
+                                      void *pProgressArg )
+{
+    GDALWarpChunkWorker *psWorker =
+        static_cast<GDALWarpChunkWorker *>(pProgressArg);
+    ChunkSchedulerData *psScheduler = psWorker->psScheduler;
+
+    CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+    psScheduler->dfProgress += dfComplete - psWorker->dfLastProgress;
+    psWorker->dfLastProgress = dfComplete;
+    int bRet = TRUE;
+    if( !psScheduler->pfnProgress(
+                std::min(1.0, psScheduler->dfProgress), pszMessage,
+                psScheduler->pProgressArg) )
+    {
+        psScheduler->bAbort = true;
+        CPLCondBroadcast(psScheduler->hCond);
+        bRet = FALSE;
+    }
+    CPLReleaseMutex(psScheduler->hMutex);
+    return bRet;
+}
 
-static void ChunkThreadMain( void *pThreadData )
+void GDALWarpOperation::ChunkThreadMain( void *pThreadData )
 
 {
-    volatile ChunkThreadData* psData =
-        static_cast<volatile ChunkThreadData*>(pThreadData);
+    GDALWarpChunkWorker* psWorker =
+        static_cast<GDALWarpChunkWorker*>(pThreadData);
+    ChunkSchedulerData* psScheduler = psWorker->psScheduler;
 
-    GDALWarpChunk *pasChunkInfo = psData->pasChunkInfo;
+    while( true )
+    {
+/* -------------------------------------------------------------------- */
+/*      Pick the next chunk to process.                                 */
+/* -------------------------------------------------------------------- */
+        CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+        const int iChunk = psScheduler->bAbort ? psScheduler->nChunkCount :
+                                                 psScheduler->nNextChunk++;
+        CPLReleaseMutex(psScheduler->hMutex);
+        if( iChunk >= psScheduler->nChunkCount )
+            break;
+
+        const GDALWarpChunk *pasChunkInfo = psScheduler->pasChunkList + iChunk;
+        const double dfProgressBase = psScheduler->padfProgressBase[iChunk];
+        const double dfProgressScale =
+            pasChunkInfo->dsx * static_cast<double>(pasChunkInfo->dsy) /
+            psScheduler->dfTotalPixels;
+        psWorker->iChunk = iChunk;
+        psWorker->dfLastProgress = dfProgressBase;
+
+        CPLDebug( "GDAL", "Start chunk %d.", iChunk );
 
 /* -------------------------------------------------------------------- */
 /*      Acquire IO mutex.                                               */
 /* -------------------------------------------------------------------- */
-    if( !CPLAcquireMutex( psData->hIOMutex, 600.0 ) )
-    {
-        CPLError( CE_Failure, CPLE_AppDefined,
-                    "Failed to acquire IOMutex in WarpRegion()." );
-        psData->eErr = CE_Failure;
-    }
-    else
-    {
-        if( psData->hCond != nullptr )
+        if( !CPLAcquireMutex( psWorker->hIOMutex, 600.0 ) )
         {
-            CPLAcquireMutex( psData->hCondMutex, 1.0 );
-            psData->bIOMutexTaken = TRUE;
-            CPLCondSignal(psData->hCond);
-            CPLReleaseMutex( psData->hCondMutex );
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Failed to acquire IOMutex in WarpRegion()." );
+            psWorker->eErr = CE_Failure;
         }
-
-        psData->eErr = psData->poOperation->WarpRegion(
+        else
+        {
+            psWorker->bIOMutexHeld = true;
+            psWorker->eErr = psWorker->poOperation->WarpRegionInternal(
                                     pasChunkInfo->dx, pasChunkInfo->dy,
                                     pasChunkInfo->dsx, pasChunkInfo->dsy,
                                     pasChunkInfo->sx, pasChunkInfo->sy,
                                     pasChunkInfo->ssx, pasChunkInfo->ssy,
                                     pasChunkInfo->sExtraSx,
                                     pasChunkInfo->sExtraSy,
-                                    psData->dfProgressBase,
-                                    psData->dfProgressScale);
+                                    dfProgressBase, dfProgressScale,
+                                    psWorker);
 
-    /* -------------------------------------------------------------------- */
-    /*      Release the IO mutex.                                           */
-    /* -------------------------------------------------------------------- */
-        CPLReleaseMutex( psData->hIOMutex );
+/* -------------------------------------------------------------------- */
+/*      Release the IO mutex, unless a failure to reacquire it made     */
+/*      WarpRegionInternal() return without it.                         */
+/* -------------------------------------------------------------------- */
+            if( psWorker->bIOMutexHeld )
+            {
+                CPLReleaseMutex( psWorker->hIOMutex );
+                psWorker->bIOMutexHeld = false;
+            }
+        }
+
+        if( psWorker->eErr != CE_None )
+        {
+            CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+            psScheduler->bAbort = true;
+            CPLCondBroadcast(psScheduler->hCond);
+            CPLReleaseMutex(psScheduler->hMutex);
+            break;
+        }
+
+        CPLDebug( "GDAL", "Finished chunk %d.", iChunk );
     }
 }
 
@@ -1004,7 +1087,14 @@ static void ChunkThreadMain( void *pThreadData )
  *
  * Externally this method operates the same as ChunkAndWarpImage(), but
  * internally this method uses multiple threads to interleave input/output
- * for one region while the processing is being done for another.
+ * for some regions while the processing is being done for other ones.
+ *
+ * The number of worker threads, and thus of chunks in flight, is set with
+ * the NUM_CHUNK_THREADS warping option (defaults to 2). Reading and writing
+ * of the datasets is serialized, and the warped chunks are written in the
+ * order of the chunk list. When the transformer can be cloned, each worker
+ * uses its own copy of it, so that the warping computation of the chunks
+ * runs in parallel.
  *
  * @param nDstXOff X offset to window of destination data to be produced.
  * @param nDstYOff Y offset to window of destination data to be produced.
@@ -1018,127 +1108,160 @@ CPLErr GDALWarpOperation::ChunkAndWarpMulti(
     int nDstXOff, int nDstYOff,  int nDstXSize, int nDstYSize )
 
 {
-    hIOMutex = CPLCreateMutex();
-    hWarpMutex = CPLCreateMutex();
-
-    CPLReleaseMutex( hIOMutex );
-    CPLReleaseMutex( hWarpMutex );
-
-    CPLCond* hCond = CPLCreateCond();
-    CPLMutex* hCondMutex = CPLCreateMutex();
-    CPLReleaseMutex(hCondMutex);
+    if( hIOMutex == nullptr )
+    {
+        hIOMutex = CPLCreateMutex();
+        CPLReleaseMutex( hIOMutex );
+    }
+    if( hWarpMutex == nullptr )
+    {
+        hWarpMutex = CPLCreateMutex();
+        CPLReleaseMutex( hWarpMutex );
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Collect the list of chunks to operate on.                       */
 /* -------------------------------------------------------------------- */
     CollectChunkList( nDstXOff, nDstYOff, nDstXSize, nDstYSize );
+    if( pasChunkList == nullptr || nChunkListCount == 0 )
+    {
+        WipeChunkList();
+        return CE_None;
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Process them one at a time, updating the progress               */
-/*      information for each region.                                    */
+/*      Compute the number of workers.                                  */
 /* -------------------------------------------------------------------- */
-    ChunkThreadData volatile asThreadData[2] = {};
-    memset(reinterpret_cast<void*>(
-        const_cast<ChunkThreadData(*)[2]>(&asThreadData)), 0, sizeof(asThreadData));
-    asThreadData[0].poOperation = this;
-    asThreadData[0].hIOMutex = hIOMutex;
-    asThreadData[1].poOperation = this;
-    asThreadData[1].hIOMutex = hIOMutex;
-
-    double dfPixelsProcessed = 0.0;
-    double dfTotalPixels = static_cast<double>(nDstXSize)*nDstYSize;
-
-    CPLErr eErr = CE_None;
-    for( int iChunk = 0; iChunk < nChunkListCount+1; iChunk++ )
-    {
-        int iThread = iChunk % 2;
+    const char* pszNumThreads =
+        CSLFetchNameValueDef(psOptions->papszWarpOptions,
+                             "NUM_CHUNK_THREADS", "2");
+    const int nWorkers = std::min(CPLGetNumThreads(pszNumThreads),
+                                  nChunkListCount);
 
 /* -------------------------------------------------------------------- */
-/*      Launch thread for this chunk.                                   */
+/*      Try to give each worker its own transformer and kernel thread   */
+/*      data, so that warping computations do not need to be            */
+/*      serialized.                                                     */
 /* -------------------------------------------------------------------- */
-        if( pasChunkList != nullptr && iChunk < nChunkListCount )
+    std::vector<GDALWarpChunkWorker> asWorkers(nWorkers);
+    bool bPrivateTransformers = nWorkers > 1;
+    for( int i = 0; i < nWorkers; i++ )
+    {
+        GDALWarpChunkWorker& sWorker = asWorkers[i];
+        memset(&sWorker, 0, sizeof(sWorker));
+        sWorker.poOperation = this;
+        sWorker.hIOMutex = hIOMutex;
+        sWorker.bIOMutexHeld = false;
+        sWorker.eErr = CE_None;
+        if( bPrivateTransformers )
         {
-            GDALWarpChunk *pasThisChunk = pasChunkList + iChunk;
-            const double dfChunkPixels =
-                pasThisChunk->dsx * static_cast<double>(pasThisChunk->dsy);
-
-            asThreadData[iThread].dfProgressBase =
-                dfPixelsProcessed / dfTotalPixels;
-            asThreadData[iThread].dfProgressScale =
-                dfChunkPixels / dfTotalPixels;
-
-            dfPixelsProcessed += dfChunkPixels;
-
-            asThreadData[iThread].pasChunkInfo = pasThisChunk;
-
-            if( iChunk == 0 )
-            {
-                asThreadData[iThread].hCond = hCond;
-                asThreadData[iThread].hCondMutex = hCondMutex;
-            }
-            else
-            {
-                asThreadData[iThread].hCond = nullptr;
-                asThreadData[iThread].hCondMutex = nullptr;
-            }
-            asThreadData[iThread].bIOMutexTaken = FALSE;
-
-            CPLDebug( "GDAL", "Start chunk %d.", iChunk );
-            asThreadData[iThread].hThreadHandle = CPLCreateJoinableThread(
-                ChunkThreadMain,
-                const_cast<ChunkThreadData *>(&asThreadData[iThread]));
-            if( asThreadData[iThread].hThreadHandle == nullptr )
-            {
-                CPLError(
-                    CE_Failure, CPLE_AppDefined,
-                    "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()");
-                eErr = CE_Failure;
-                break;
-            }
-
-            // Wait that the first thread has acquired the IO mutex before
-            // proceeding.  This will ensure that the first thread will run
-            // before the second one.
-            if( iChunk == 0 )
-            {
-                CPLAcquireMutex(hCondMutex, 1.0);
-                while( asThreadData[iThread].bIOMutexTaken == FALSE )
-                    CPLCondWait(hCond, hCondMutex);
-                CPLReleaseMutex(hCondMutex);
-            }
+            sWorker.pTransformerArg =
+                GDALCloneTransformer(psOptions->pTransformerArg);
+            if( sWorker.pTransformerArg == nullptr )
+                bPrivateTransformers = false;
+        }
+    }
+    if( bPrivateTransformers )
+    {
+        for( int i = 0; bPrivateTransformers && i < nWorkers; i++ )
+        {
+            asWorkers[i].psThreadData =
+                GWKThreadsCreate(psOptions->papszWarpOptions,
+                                 psOptions->pfnTransformer,
+                                 asWorkers[i].pTransformerArg);
+            if( asWorkers[i].psThreadData == nullptr )
+                bPrivateTransformers = false;
         }
+    }
+    if( !bPrivateTransformers )
+    {
+        if( nWorkers > 1 )
+            CPLDebug("WARP", "Cannot duplicate transformer function. "
+                     "Warping computations will be serialized");
+        for( int i = 0; i < nWorkers; i++ )
+        {
+            if( asWorkers[i].psThreadData )
+                GWKThreadsEnd(asWorkers[i].psThreadData);
+            if( asWorkers[i].pTransformerArg )
+                GDALDestroyTransformer(asWorkers[i].pTransformerArg);
+            asWorkers[i].psThreadData = nullptr;
+            asWorkers[i].pTransformerArg = nullptr;
+        }
+    }
 
 /* -------------------------------------------------------------------- */
-/*      Wait for previous chunks thread to complete.                    */
+/*      Setup the scheduler.                                            */
+/* -------------------------------------------------------------------- */
+    double dfTotalPixels = 0.0;
+    std::vector<double> adfProgressBase(nChunkListCount);
+    for( int iChunk = 0; iChunk < nChunkListCount; iChunk++ )
+    {
+        adfProgressBase[iChunk] = dfTotalPixels;
+        dfTotalPixels += pasChunkList[iChunk].dsx *
+                         static_cast<double>(pasChunkList[iChunk].dsy);
+    }
+    for( int iChunk = 0; iChunk < nChunkListCount; iChunk++ )
+        adfProgressBase[iChunk] /= dfTotalPixels;
+
+    ChunkSchedulerData sScheduler;
+    sScheduler.pasChunkList = pasChunkList;
+    sScheduler.nChunkCount = nChunkListCount;
+    sScheduler.padfProgressBase = &adfProgressBase[0];
+    sScheduler.dfTotalPixels = dfTotalPixels;
+    sScheduler.hMutex = CPLCreateMutex();
+    CPLReleaseMutex(sScheduler.hMutex);
+    sScheduler.hCond = CPLCreateCond();
+    sScheduler.nNextChunk = 0;
+    sScheduler.nNextChunkToWrite = 0;
+    sScheduler.bAbort = false;
+    sScheduler.dfProgress = 0.0;
+    sScheduler.pfnProgress = psOptions->pfnProgress;
+    sScheduler.pProgressArg = psOptions->pProgressArg;
+
+/* -------------------------------------------------------------------- */
+/*      Launch the workers. The calling thread acts as the first one.   */
 /* -------------------------------------------------------------------- */
-        if( iChunk > 0 )
+    CPLErr eErr = CE_None;
+    for( int i = 0; i < nWorkers; i++ )
+    {
+        asWorkers[i].psScheduler = &sScheduler;
+        if( i == 0 )
+            continue;
+        asWorkers[i].hThreadHandle =
+            CPLCreateJoinableThread(ChunkThreadMain, &asWorkers[i]);
+        if( asWorkers[i].hThreadHandle == nullptr )
         {
-            iThread = (iChunk-1) % 2;
-
-            // Wait for thread to finish.
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
-            asThreadData[iThread].hThreadHandle = nullptr;
-
-            CPLDebug( "GDAL", "Finished chunk %d.", iChunk-1 );
-
-            eErr = asThreadData[iThread].eErr;
-
-            if( eErr != CE_None )
-                break;
+            CPLError(
+                CE_Failure, CPLE_AppDefined,
+                "CPLCreateJoinableThread() failed in ChunkAndWarpMulti()");
+            CPLAcquireMutex(sScheduler.hMutex, 1000.0);
+            sScheduler.bAbort = true;
+            CPLCondBroadcast(sScheduler.hCond);
+            CPLReleaseMutex(sScheduler.hMutex);
+            eErr = CE_Failure;
+            break;
         }
     }
 
-    /* -------------------------------------------------------------------- */
-    /*      Wait for all threads to complete.                               */
-    /* -------------------------------------------------------------------- */
-    for( int iThread = 0; iThread < 2; iThread++ )
+    if( eErr == CE_None )
+        ChunkThreadMain(&asWorkers[0]);
+
+/* -------------------------------------------------------------------- */
+/*      Wait for all threads to complete.                               */
+/* -------------------------------------------------------------------- */
+    for( int i = 0; i < nWorkers; i++ )
     {
-        if( asThreadData[iThread].hThreadHandle )
-            CPLJoinThread(asThreadData[iThread].hThreadHandle);
+        if( asWorkers[i].hThreadHandle )
+            CPLJoinThread(asWorkers[i].hThreadHandle);
+        if( eErr == CE_None )
+            eErr = asWorkers[i].eErr;
+        if( asWorkers[i].psThreadData )
+            GWKThreadsEnd(asWorkers[i].psThreadData);
+        if( asWorkers[i].pTransformerArg )
+            GDALDestroyTransformer(asWorkers[i].pTransformerArg);
     }
-
-    CPLDestroyCond(hCond);
-    CPLDestroyMutex(hCondMutex);
+    CPLDestroyCond(sScheduler.hCond);
+    CPLDestroyMutex(sScheduler.hMutex);
 
     WipeChunkList();
 
@@ -1478,6 +1601,34 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
                                       double dfProgressBase,
                                       double dfProgressScale)
 
+{
+    return WarpRegionInternal(nDstXOff, nDstYOff,
+                              nDstXSize, nDstYSize,
+                              nSrcXOff, nSrcYOff,
+                              nSrcXSize, nSrcYSize,
+                              dfSrcXExtraSize, dfSrcYExtraSize,
+                              dfProgressBase, dfProgressScale,
+                              nullptr);
+}
+
+/************************************************************************/
+/*                         WarpRegionInternal()                         */
+/************************************************************************/
+
+// psWorker is set when called from a ChunkAndWarpMulti() worker, in which
+// case the IO mutex is held on entry and the chunks are written in order.
+// psWorker->bIOMutexHeld tells whether it is still held on return.
+
+CPLErr GDALWarpOperation::WarpRegionInternal( int nDstXOff, int nDstYOff,
+                                              int nDstXSize, int nDstYSize,
+                                              int nSrcXOff, int nSrcYOff,
+                                              int nSrcXSize, int nSrcYSize,
+                                              double dfSrcXExtraSize,
+                                              double dfSrcYExtraSize,
+                                              double dfProgressBase,
+                                              double dfProgressScale,
+                                              GDALWarpChunkWorker* psWorker )
+
 {
     ReportTiming( nullptr );
 
@@ -1535,11 +1686,47 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
 /*      Perform the warp.                                               */
 /* -------------------------------------------------------------------- */
     CPLErr eErr =
-        WarpRegionToBuffer(nDstXOff, nDstYOff, nDstXSize, nDstYSize,
-                           pDstBuffer, psOptions->eWorkingDataType,
-                           nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
-                           dfSrcXExtraSize, dfSrcYExtraSize,
-                           dfProgressBase, dfProgressScale);
+        WarpRegionToBufferInternal(nDstXOff, nDstYOff, nDstXSize, nDstYSize,
+                                   pDstBuffer, psOptions->eWorkingDataType,
+                                   nSrcXOff, nSrcYOff, nSrcXSize, nSrcYSize,
+                                   dfSrcXExtraSize, dfSrcYExtraSize,
+                                   dfProgressBase, dfProgressScale,
+                                   psWorker);
+
+/* -------------------------------------------------------------------- */
+/*      In multi-threaded mode, wait for the previous chunks to be      */
+/*      written, without holding the IO mutex meanwhile.                */
+/* -------------------------------------------------------------------- */
+    if( eErr == CE_None && psWorker != nullptr )
+    {
+        ChunkSchedulerData* psScheduler = psWorker->psScheduler;
+        CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+        if( psScheduler->nNextChunkToWrite != psWorker->iChunk &&
+            !psScheduler->bAbort )
+        {
+            CPLReleaseMutex( hIOMutex );
+            psWorker->bIOMutexHeld = false;
+            while( psScheduler->nNextChunkToWrite != psWorker->iChunk &&
+                   !psScheduler->bAbort )
+            {
+                CPLCondWait(psScheduler->hCond, psScheduler->hMutex);
+            }
+            CPLReleaseMutex(psScheduler->hMutex);
+            if( !CPLAcquireMutex( hIOMutex, 600.0 ) )
+            {
+                CPLError( CE_Failure, CPLE_AppDefined,
+                          "Failed to acquire IOMutex in WarpRegion()." );
+                DestroyDestinationBuffer( pDstBuffer );
+                return CE_Failure;
+            }
+            psWorker->bIOMutexHeld = true;
+            CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+        }
+        // Another chunk failed: no error of our own to report.
+        if( psScheduler->bAbort )
+            eErr = CE_Failure;
+        CPLReleaseMutex(psScheduler->hMutex);
+    }
 
 /* -------------------------------------------------------------------- */
 /*      Write the output data back to disk if all went well.            */
@@ -1581,6 +1768,15 @@ CPLErr GDALWarpOperation::WarpRegion( int nDstXOff, int nDstYOff,
         ReportTiming( "Output buffer write" );
     }
 
+    if( eErr == CE_None && psWorker != nullptr )
+    {
+        ChunkSchedulerData* psScheduler = psWorker->psScheduler;
+        CPLAcquireMutex(psScheduler->hMutex, 1000.0);
+        psScheduler->nNextChunkToWrite++;
+        CPLCondBroadcast(psScheduler->hCond);
+        CPLReleaseMutex(psScheduler->hMutex);
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Cleanup and return.                                             */
 /* -------------------------------------------------------------------- */
@@ -1688,13 +1884,36 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
  */
 
 CPLErr GDALWarpOperation::WarpRegionToBuffer(
+    int nDstXOff, int nDstYOff, int nDstXSize, int nDstYSize,
+    void *pDataBuf, GDALDataType eBufDataType,
+    int nSrcXOff, int nSrcYOff, int nSrcXSize, int nSrcYSize,
+    double dfSrcXExtraSize, double dfSrcYExtraSize,
+    double dfProgressBase, double dfProgressScale)
+
+{
+    return WarpRegionToBufferInternal(nDstXOff, nDstYOff,
+                                      nDstXSize, nDstYSize,
+                                      pDataBuf, eBufDataType,
+                                      nSrcXOff, nSrcYOff,
+                                      nSrcXSize, nSrcYSize,
+                                      dfSrcXExtraSize, dfSrcYExtraSize,
+                                      dfProgressBase, dfProgressScale,
+                                      nullptr);
+}
+
+/************************************************************************/
+/*                     WarpRegionToBufferInternal()                     */
+/************************************************************************/
+
+CPLErr GDALWarpOperation::WarpRegionToBufferInternal(
     int nDstXOff, int nDstYOff, int nDstXSize, int nDstYSize,
     void *pDataBuf,
     // Only in a CPLAssert.
     CPL_UNUSED GDALDataType eBufDataType,
     int nSrcXOff, int nSrcYOff, int nSrcXSize, int nSrcYSize,
     double dfSrcXExtraSize, double dfSrcYExtraSize,
-    double dfProgressBase, double dfProgressScale)
+    double dfProgressBase, double dfProgressScale,
+    GDALWarpChunkWorker* psWorker )
 
 {
     const int nWordSize = GDALGetDataTypeSizeBytes(psOptions->eWorkingDataType);
@@ -1735,16 +1954,31 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     oWK.nBands = psOptions->nBandCount;
     oWK.eWorkingDataType = psOptions->eWorkingDataType;
 
+    // Workers of ChunkAndWarpMulti() may have their own transformer, in
+    // which case the warping computation does not need to be serialized.
+    const bool bPrivateTransformer =
+        psWorker != nullptr && psWorker->pTransformerArg != nullptr;
+
     oWK.pfnTransformer = psOptions->pfnTransformer;
-    oWK.pTransformerArg = psOptions->pTransformerArg;
+    oWK.pTransformerArg = bPrivateTransformer ? psWorker->pTransformerArg :
+                                                psOptions->pTransformerArg;
 
-    oWK.pfnProgress = psOptions->pfnProgress;
-    oWK.pProgress = psOptions->pProgressArg;
+    if( psWorker != nullptr )
+    {
+        oWK.pfnProgress = ChunkProgress;
+        oWK.pProgress = psWorker;
+    }
+    else
+    {
+        oWK.pfnProgress = psOptions->pfnProgress;
+        oWK.pProgress = psOptions->pProgressArg;
+    }
     oWK.dfProgressBase = dfProgressBase;
     oWK.dfProgressScale = dfProgressScale;
 
     oWK.papszWarpOptions = psOptions->papszWarpOptions;
-    oWK.psThreadData = psThreadData;
+    oWK.psThreadData = bPrivateTransformer ? psWorker->psThreadData :
+                                             psThreadData;
 
     oWK.padfDstNoDataReal = psOptions->padfDstNoDataReal;
 
@@ -2125,7 +2359,9 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
     if( hIOMutex != nullptr )
     {
         CPLReleaseMutex( hIOMutex );
-        if( !CPLAcquireMutex( hWarpMutex, 600.0 ) )
+        if( psWorker != nullptr )
+            psWorker->bIOMutexHeld = false;
+        if( !bPrivateTransformer && !CPLAcquireMutex( hWarpMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
                       "Failed to acquire WarpMutex in WarpRegion()." );
@@ -2161,13 +2397,16 @@ CPLErr GDALWarpOperation::WarpRegionToBuffer(
 /* -------------------------------------------------------------------- */
     if( hIOMutex != nullptr )
     {
-        CPLReleaseMutex( hWarpMutex );
+        if( !bPrivateTransformer )
+            CPLReleaseMutex( hWarpMutex );
         if( !CPLAcquireMutex( hIOMutex, 600.0 ) )
         {
             CPLError( CE_Failure, CPLE_AppDefined,
                       "Failed to acquire IOMutex in WarpRegion()." );
             return CE_Failure;
         }
+        if( psWorker != nullptr )
+            psWorker->bIOMutexHeld = true;
     }
 
 /* -------------------------------------------------------------------- */
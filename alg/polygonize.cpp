@@ -35,7 +35,9 @@
 #include <string.h>
 
 #include <algorithm>
+#include <map>
 #include <memory>
+#include <utility>
 #include <vector>
 
 #include "gdal_alg_priv.h"
@@ -47,6 +49,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 
 CPL_CVSID("$Id: polygonize.cpp 9ff327806cd64df6d73a6c91f92d12ca0c5e07df 2018-04-07 20:25:06 +0200 Even Rouault $")
 
@@ -74,6 +77,7 @@ public:
     void             Dump() const;
     void             Coalesce();
     void             Merge( int iBaseString, int iSrcString, int iDirection );
+    void             RemoveSeamVertices( int nStripHeight );
 };
 
 /************************************************************************/
@@ -190,6 +194,46 @@ void RPolygon::Merge( int iBaseString, int iSrcString, int iDirection )
     aanXY.resize(nSize - 1);
 }
 
+/************************************************************************/
+/*                         RemoveSeamVertices()                         */
+/*                                                                      */
+/*      Remove, from coalesced rings, the vertices left in the middle   */
+/*      of vertical edges at the lines where strips polygonized         */
+/*      separately have been stitched together.                         */
+/************************************************************************/
+
+void RPolygon::RemoveSeamVertices( int nStripHeight )
+
+{
+    for( size_t iString = 0; iString < aanXY.size(); iString++ )
+    {
+        std::vector<int> &anString = aanXY[iString];
+
+        // Rings are closed, so do not consider the last vertex.
+        const int nVertices = static_cast<int>(anString.size()) / 2 - 1;
+        if( nVertices < 4 )
+            continue;
+
+        std::vector<int> anNew;
+        anNew.reserve(anString.size());
+        for( int i = 0; i < nVertices; i++ )
+        {
+            const int iPrev = (i + nVertices - 1) % nVertices;
+            const int iNext = (i + 1) % nVertices;
+            const int nX = anString[i*2];
+            const int nY = anString[i*2+1];
+            if( nY % nStripHeight == 0 &&
+                anString[iPrev*2] == nX && anString[iNext*2] == nX )
+                continue;
+            anNew.push_back( nX );
+            anNew.push_back( nY );
+        }
+        anNew.push_back( anNew[0] );
+        anNew.push_back( anNew[1] );
+        anString.swap(anNew);
+    }
+}
+
 /************************************************************************/
 /*                             AddSegment()                             */
 /************************************************************************/
@@ -328,18 +372,20 @@ static void AddEdges( GInt32 *panThisLineId, GInt32 *panLastLineId,
 }
 
 /************************************************************************/
-/*                         EmitPolygonToLayer()                         */
+/*                         RPolygonToGeometry()                         */
 /************************************************************************/
 
-static CPLErr
-EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
-                    RPolygon *poRPoly, double *padfGeoTransform )
+static OGRGeometryH
+RPolygonToGeometry( RPolygon *poRPoly, const double *padfGeoTransform,
+                    int nStripHeight = 0 )
 
 {
 /* -------------------------------------------------------------------- */
 /*      Turn bits of lines into coherent rings.                         */
 /* -------------------------------------------------------------------- */
     poRPoly->Coalesce();
+    if( nStripHeight > 0 )
+        poRPoly->RemoveSeamVertices( nStripHeight );
 
 /* -------------------------------------------------------------------- */
 /*      Create the polygon geometry.                                    */
@@ -375,6 +421,18 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
         OGR_G_AddGeometryDirectly( hPolygon, hRing );
     }
 
+    return hPolygon;
+}
+
+/************************************************************************/
+/*                         EmitGeometryToLayer()                        */
+/************************************************************************/
+
+static CPLErr
+EmitGeometryToLayer( OGRLayerH hOutLayer, int iPixValField,
+                     OGRGeometryH hPolygon, double dfPolyValue )
+
+{
 /* -------------------------------------------------------------------- */
 /*      Create the feature object.                                      */
 /* -------------------------------------------------------------------- */
@@ -383,7 +441,7 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
     OGR_F_SetGeometryDirectly( hFeat, hPolygon );
 
     if( iPixValField >= 0 )
-        OGR_F_SetFieldDouble( hFeat, iPixValField, poRPoly->dfPolyValue );
+        OGR_F_SetFieldDouble( hFeat, iPixValField, dfPolyValue );
 
 /* -------------------------------------------------------------------- */
 /*      Write the to the layer.                                         */
@@ -398,6 +456,21 @@ EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
     return eErr;
 }
 
+/************************************************************************/
+/*                         EmitPolygonToLayer()                         */
+/************************************************************************/
+
+static CPLErr
+EmitPolygonToLayer( OGRLayerH hOutLayer, int iPixValField,
+                    RPolygon *poRPoly, double *padfGeoTransform )
+
+{
+    return EmitGeometryToLayer( hOutLayer, iPixValField,
+                                RPolygonToGeometry( poRPoly,
+                                                    padfGeoTransform ),
+                                poRPoly->dfPolyValue );
+}
+
 /************************************************************************/
 /*                          GPMaskImageData()                           */
 /*                                                                      */
@@ -427,6 +500,705 @@ GPMaskImageData( GDALRasterBandH hMaskBand, GByte* pabyMaskLine,
     return CE_None;
 }
 
+/************************************************************************/
+/*                          GPGetGeoTransform()                         */
+/*                                                                      */
+/*      Get the geotransform, if there is one, so we can convert the    */
+/*      vectors into georeferenced coordinates.                         */
+/************************************************************************/
+
+static void GPGetGeoTransform( GDALRasterBandH hSrcBand, char **papszOptions,
+                               double *padfGeoTransform )
+
+{
+    const char* pszDatasetForGeoRef = CSLFetchNameValue(papszOptions,
+                                                        "DATASET_FOR_GEOREF");
+    if( pszDatasetForGeoRef )
+    {
+        GDALDatasetH hSrcDS = GDALOpen(pszDatasetForGeoRef, GA_ReadOnly);
+        if( hSrcDS )
+        {
+            GDALGetGeoTransform( hSrcDS, padfGeoTransform );
+            GDALClose(hSrcDS);
+        }
+    }
+    else
+    {
+        GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
+        if( hSrcDS )
+            GDALGetGeoTransform( hSrcDS, padfGeoTransform );
+    }
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                         Tiled polygonization                         */
+/*                                                                      */
+/*      The raster is split into strips of lines that are processed     */
+/*      independently by worker threads, in two passes like the         */
+/*      single-threaded algorithm:                                      */
+/*      - the first pass enumerates the polygons of each strip. The     */
+/*        calling thread then merges the polygons that continue from    */
+/*        one strip to the next one, giving global polygon ids.         */
+/*      - the second pass collects the edges of each strip. Polygons    */
+/*        fully contained in a strip are emitted right away, and the    */
+/*        edges of the others are gathered by the calling thread until  */
+/*        their last strip has been processed.                          */
+/*      Only as many strips as there are threads are held in memory at  */
+/*      a time.                                                         */
+/* ==================================================================== */
+/************************************************************************/
+
+// Runs of identical polygon ids along a line, as (first pixel, id) pairs.
+typedef std::vector< std::pair<int, GInt32> > GPLineRuns;
+
+template<class DataType, class EqualityTest>
+struct GPStripJob
+{
+    int         nConnectedness;
+    int         nXSize;
+    int         nYOff;
+    int         nLines;
+    int         iStrip;
+    bool        bLastStrip;
+    DataType   *panVal;
+
+    // First pass results. Polygon ids of a strip are renumbered to be
+    // consecutive, from 0.
+    std::vector<GInt32>   anRawToLocal;
+    std::vector<DataType> aLocalValue;
+    std::vector<GInt32>   anFirstLineId;
+    std::vector<GInt32>   anLastLineId;
+    GPLineRuns            aoLastLineRuns;
+
+    // Second pass input.
+    GInt32          nOffset;
+    const GInt32   *panGlobalId;
+    const DataType *paGlobalValue;
+    const int      *panMinStrip;
+    const int      *panMaxStrip;
+    const double   *padfGeoTransform;
+    std::vector<GInt32> anPrevLineId;
+
+    // Second pass results.
+    std::vector< std::pair<OGRGeometryH, double> > aoComplete;
+    std::vector< std::pair<GInt32, RPolygon*> >    aoPartial;
+
+    GPStripJob() :
+        nConnectedness(4), nXSize(0), nYOff(0), nLines(0), iStrip(0),
+        bLastStrip(false), panVal(nullptr), nOffset(0), panGlobalId(nullptr),
+        paGlobalValue(nullptr), panMinStrip(nullptr), panMaxStrip(nullptr),
+        padfGeoTransform(nullptr) {}
+};
+
+/************************************************************************/
+/*                          GPStripFirstPass()                          */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static void GPStripFirstPass( void* pData )
+
+{
+    GPStripJob<DataType, EqualityTest>* psJob =
+        static_cast<GPStripJob<DataType, EqualityTest>*>(pData);
+    const int nXSize = psJob->nXSize;
+
+    GDALRasterPolygonEnumeratorT<DataType,
+                                 EqualityTest> oEnum(psJob->nConnectedness);
+    std::vector<GInt32> anLastLineId(nXSize);
+    std::vector<GInt32> anThisLineId(nXSize);
+
+    for( int iLine = 0; iLine < psJob->nLines; iLine++ )
+    {
+        DataType* panThisLineVal =
+            psJob->panVal + static_cast<size_t>(iLine) * nXSize;
+        if( iLine == 0 )
+        {
+            oEnum.ProcessLine( nullptr, panThisLineVal,
+                               nullptr, &anThisLineId[0], nXSize );
+            psJob->anFirstLineId = anThisLineId;
+        }
+        else
+        {
+            oEnum.ProcessLine( panThisLineVal - nXSize, panThisLineVal,
+                               &anLastLineId[0], &anThisLineId[0], nXSize );
+        }
+        std::swap(anLastLineId, anThisLineId);
+    }
+    psJob->anLastLineId.swap(anLastLineId);
+
+    oEnum.CompleteMerges();
+
+    std::vector<GInt32> anFinalToLocal(oEnum.nNextPolygonId, -1);
+    psJob->aLocalValue.clear();
+    for( int iPoly = 0; iPoly < oEnum.nNextPolygonId; iPoly++ )
+    {
+        if( oEnum.panPolyIdMap[iPoly] == iPoly )
+        {
+            anFinalToLocal[iPoly] =
+                static_cast<GInt32>(psJob->aLocalValue.size());
+            psJob->aLocalValue.push_back( oEnum.panPolyValue[iPoly] );
+        }
+    }
+    psJob->anRawToLocal.resize(oEnum.nNextPolygonId);
+    for( int iPoly = 0; iPoly < oEnum.nNextPolygonId; iPoly++ )
+        psJob->anRawToLocal[iPoly] =
+            anFinalToLocal[oEnum.panPolyIdMap[iPoly]];
+
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        if( psJob->anFirstLineId[iX] >= 0 )
+            psJob->anFirstLineId[iX] =
+                psJob->anRawToLocal[psJob->anFirstLineId[iX]];
+        if( psJob->anLastLineId[iX] >= 0 )
+            psJob->anLastLineId[iX] =
+                psJob->anRawToLocal[psJob->anLastLineId[iX]];
+    }
+}
+
+/************************************************************************/
+/*                            AddEdgesTiled()                           */
+/*                                                                      */
+/*      Same as AddEdges(), with global polygon ids.                    */
+/************************************************************************/
+
+template<class DataType>
+static RPolygon* GPGetPolygon( std::map<GInt32, RPolygon*>& oPolys,
+                               GInt32 nId, const DataType *paValue )
+{
+    std::map<GInt32, RPolygon*>::iterator oIter = oPolys.find(nId);
+    if( oIter != oPolys.end() )
+        return oIter->second;
+    RPolygon* poPoly = new RPolygon( paValue[nId] );
+    oPolys[nId] = poPoly;
+    return poPoly;
+}
+
+template<class DataType>
+static void AddEdgesTiled( const GInt32 *panThisLineId,
+                           const GInt32 *panLastLineId,
+                           const DataType *paValue,
+                           std::map<GInt32, RPolygon*>& oPolys,
+                           int iX, int iY )
+
+{
+    const int nThisId = panThisLineId[iX];
+    const int nRightId = panThisLineId[iX+1];
+    const int nPreviousId = panLastLineId[iX];
+
+    const int iXReal = iX - 1;
+
+    if( nThisId != nPreviousId )
+    {
+        if( nThisId != -1 )
+            GPGetPolygon(oPolys, nThisId, paValue)->
+                AddSegment( iXReal, iY, iXReal+1, iY );
+        if( nPreviousId != -1 )
+            GPGetPolygon(oPolys, nPreviousId, paValue)->
+                AddSegment( iXReal, iY, iXReal+1, iY );
+    }
+
+    if( nThisId != nRightId )
+    {
+        if( nThisId != -1 )
+            GPGetPolygon(oPolys, nThisId, paValue)->
+                AddSegment( iXReal+1, iY, iXReal+1, iY+1 );
+        if( nRightId != -1 )
+            GPGetPolygon(oPolys, nRightId, paValue)->
+                AddSegment( iXReal+1, iY, iXReal+1, iY+1 );
+    }
+}
+
+/************************************************************************/
+/*                         GPStripSecondPass()                          */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static void GPStripSecondPass( void* pData )
+
+{
+    GPStripJob<DataType, EqualityTest>* psJob =
+        static_cast<GPStripJob<DataType, EqualityTest>*>(pData);
+    const int nXSize = psJob->nXSize;
+
+    // Redo the enumeration of the first pass, which gives the same ids.
+    GDALRasterPolygonEnumeratorT<DataType,
+                                 EqualityTest> oEnum(psJob->nConnectedness);
+    std::vector<GInt32> anLastLineRawId(nXSize);
+    std::vector<GInt32> anThisLineRawId(nXSize);
+
+    // Global ids, with -1 past the beginning and end of the lines.
+    std::vector<GInt32> anLastLineId;
+    anLastLineId.swap(psJob->anPrevLineId);
+    std::vector<GInt32> anThisLineId(nXSize + 2, -1);
+
+    std::map<GInt32, RPolygon*> oPolys;
+
+    const int nLines = psJob->nLines + (psJob->bLastStrip ? 1 : 0);
+    for( int iLine = 0; iLine < nLines; iLine++ )
+    {
+        if( iLine < psJob->nLines )
+        {
+            DataType* panThisLineVal =
+                psJob->panVal + static_cast<size_t>(iLine) * nXSize;
+            if( iLine == 0 )
+                oEnum.ProcessLine( nullptr, panThisLineVal,
+                                   nullptr, &anThisLineRawId[0], nXSize );
+            else
+                oEnum.ProcessLine( panThisLineVal - nXSize, panThisLineVal,
+                                   &anLastLineRawId[0], &anThisLineRawId[0],
+                                   nXSize );
+
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                const GInt32 nRawId = anThisLineRawId[iX];
+                anThisLineId[iX+1] = nRawId < 0 ? -1 :
+                    psJob->panGlobalId[psJob->nOffset +
+                                       psJob->anRawToLocal[nRawId]];
+            }
+            std::swap(anLastLineRawId, anThisLineRawId);
+        }
+        else
+        {
+            std::fill(anThisLineId.begin(), anThisLineId.end(), -1);
+        }
+
+        for( int iX = 0; iX < nXSize+1; iX++ )
+        {
+            AddEdgesTiled( &anThisLineId[0], &anLastLineId[0],
+                           psJob->paGlobalValue, oPolys,
+                           iX, psJob->nYOff + iLine );
+        }
+
+        std::swap(anLastLineId, anThisLineId);
+    }
+
+    for( std::map<GInt32, RPolygon*>::iterator oIter = oPolys.begin();
+         oIter != oPolys.end(); ++oIter )
+    {
+        const GInt32 nId = oIter->first;
+        if( psJob->panMinStrip[nId] == psJob->iStrip &&
+            psJob->panMaxStrip[nId] == psJob->iStrip )
+        {
+            psJob->aoComplete.push_back(
+                std::pair<OGRGeometryH, double>(
+                    RPolygonToGeometry(oIter->second,
+                                       psJob->padfGeoTransform),
+                    oIter->second->dfPolyValue) );
+            delete oIter->second;
+        }
+        else
+        {
+            psJob->aoPartial.push_back(
+                std::pair<GInt32, RPolygon*>(nId, oIter->second) );
+        }
+    }
+}
+
+/************************************************************************/
+/*                            GPReadStrip()                             */
+/************************************************************************/
+
+template<class DataType>
+static CPLErr GPReadStrip( GDALRasterBandH hSrcBand, GDALRasterBandH hMaskBand,
+                           GByte *pabyMask, int nXSize, int nYOff, int nLines,
+                           DataType *panVal, GDALDataType eDT )
+
+{
+    CPLErr eErr = GDALRasterIO( hSrcBand, GF_Read, 0, nYOff, nXSize, nLines,
+                                panVal, nXSize, nLines, eDT, 0, 0 );
+    if( eErr != CE_None || hMaskBand == nullptr )
+        return eErr;
+
+    eErr = GDALRasterIO( hMaskBand, GF_Read, 0, nYOff, nXSize, nLines,
+                         pabyMask, nXSize, nLines, GDT_Byte, 0, 0 );
+    if( eErr != CE_None )
+        return eErr;
+
+    const size_t nPixels = static_cast<size_t>(nXSize) * nLines;
+    for( size_t i = 0; i < nPixels; i++ )
+    {
+        if( pabyMask[i] == 0 )
+            panVal[i] = GP_NODATA_MARKER;
+    }
+    return CE_None;
+}
+
+/************************************************************************/
+/*                             GPFindRoot()                             */
+/************************************************************************/
+
+static GInt32 GPFindRoot( std::vector<GInt32>& anParent, GInt32 nId )
+{
+    while( anParent[nId] != nId )
+    {
+        anParent[nId] = anParent[anParent[nId]];
+        nId = anParent[nId];
+    }
+    return nId;
+}
+
+// The smallest id becomes the root, so that a parent always has a smaller
+// id than its children.
+static void GPUnion( std::vector<GInt32>& anParent, GInt32 nId1, GInt32 nId2 )
+{
+    nId1 = GPFindRoot(anParent, nId1);
+    nId2 = GPFindRoot(anParent, nId2);
+    if( nId1 < nId2 )
+        anParent[nId2] = nId1;
+    else if( nId2 < nId1 )
+        anParent[nId1] = nId2;
+}
+
+/************************************************************************/
+/*                        GDALPolygonizeTiledT()                        */
+/************************************************************************/
+
+template<class DataType, class EqualityTest>
+static CPLErr
+GDALPolygonizeTiledT( GDALRasterBandH hSrcBand,
+                      GDALRasterBandH hMaskBand,
+                      OGRLayerH hOutLayer, int iPixValField,
+                      int nConnectedness, int nThreads, int nStripHeight,
+                      double *padfGeoTransform,
+                      GDALProgressFunc pfnProgress,
+                      void * pProgressArg,
+                      GDALDataType eDT )
+
+{
+    typedef GPStripJob<DataType, EqualityTest> Job;
+
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+    nStripHeight = std::min(nStripHeight, nYSize);
+    const int nStrips = (nYSize + nStripHeight - 1) / nStripHeight;
+
+    CPLWorkerThreadPool* poThreadPool = CPLCreateWorkerThreadPool(nThreads);
+    const int nBatchSize = poThreadPool ? nThreads : 1;
+
+    CPLDebug("GDALPolygonize", "Polygonizing %d strips of %d lines with "
+             "%d thread(s)", nStrips, nStripHeight, nBatchSize);
+
+    DataType *panVal = static_cast<DataType *>(
+        VSI_MALLOC3_VERBOSE(sizeof(DataType), nXSize,
+                            static_cast<size_t>(nStripHeight) * nBatchSize));
+    GByte *pabyMask =
+        hMaskBand != nullptr
+        ? static_cast<GByte *>(VSI_MALLOC2_VERBOSE(nXSize, nStripHeight))
+        : nullptr;
+    if( panVal == nullptr || (hMaskBand != nullptr && pabyMask == nullptr) )
+    {
+        CPLFree( panVal );
+        CPLFree( pabyMask );
+        delete poThreadPool;
+        return CE_Failure;
+    }
+
+    std::vector<Job> asJobs(nStrips);
+    std::vector<void*> apJobs;
+
+    // Reads the strips of a batch, and runs fnJob on them.
+    auto RunBatch = [&]( int iFirstStrip, int nJobs,
+                         CPLThreadFunc pfnJob ) -> CPLErr
+    {
+        apJobs.clear();
+        for( int i = 0; i < nJobs; i++ )
+        {
+            Job& sJob = asJobs[iFirstStrip + i];
+            sJob.panVal = panVal +
+                static_cast<size_t>(i) * nStripHeight * nXSize;
+            const CPLErr eErr =
+                GPReadStrip( hSrcBand, hMaskBand, pabyMask, nXSize,
+                             sJob.nYOff, sJob.nLines, sJob.panVal, eDT );
+            if( eErr != CE_None )
+                return eErr;
+            apJobs.push_back(&sJob);
+        }
+        if( poThreadPool )
+        {
+            poThreadPool->SubmitJobs(pfnJob, apJobs);
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( size_t i = 0; i < apJobs.size(); i++ )
+                pfnJob(apJobs[i]);
+        }
+        return CE_None;
+    };
+
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+    {
+        Job& sJob = asJobs[iStrip];
+        sJob.nConnectedness = nConnectedness;
+        sJob.nXSize = nXSize;
+        sJob.nYOff = iStrip * nStripHeight;
+        sJob.nLines = std::min(nStripHeight, nYSize - sJob.nYOff);
+        sJob.iStrip = iStrip;
+        sJob.bLastStrip = iStrip == nStrips - 1;
+        sJob.padfGeoTransform = padfGeoTransform;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      First pass: enumerate the polygons of each strip, and merge     */
+/*      the ones that are connected across strip boundaries.            */
+/* -------------------------------------------------------------------- */
+    std::vector<GInt32> anGlobalId;
+    std::vector<DataType> aGlobalValue;
+    std::vector<DataType> aPrevLastLineVal(nXSize);
+    std::vector<GInt32> anPrevLastLineId;
+    EqualityTest eq;
+
+    CPLErr eErr = CE_None;
+    for( int iFirstStrip = 0;
+         eErr == CE_None && iFirstStrip < nStrips;
+         iFirstStrip += nBatchSize )
+    {
+        const int nJobs = std::min(nBatchSize, nStrips - iFirstStrip);
+        eErr = RunBatch( iFirstStrip, nJobs,
+                         GPStripFirstPass<DataType, EqualityTest> );
+
+        for( int iStrip = iFirstStrip;
+             eErr == CE_None && iStrip < iFirstStrip + nJobs;
+             iStrip++ )
+        {
+            Job& sJob = asJobs[iStrip];
+            const size_t nOffset = anGlobalId.size();
+            if( nOffset + sJob.aLocalValue.size() >
+                                static_cast<size_t>(INT_MAX) )
+            {
+                CPLError( CE_Failure, CPLE_NotSupported,
+                          "Too many polygons" );
+                eErr = CE_Failure;
+                break;
+            }
+            sJob.nOffset = static_cast<GInt32>(nOffset);
+            for( size_t i = 0; i < sJob.aLocalValue.size(); i++ )
+            {
+                anGlobalId.push_back( static_cast<GInt32>(nOffset + i) );
+                aGlobalValue.push_back( sJob.aLocalValue[i] );
+            }
+            std::vector<DataType>().swap(sJob.aLocalValue);
+
+            // Merge with the polygons of the last line of the previous strip,
+            // with the same rules as the enumerator.
+            if( iStrip > 0 )
+            {
+                const GInt32 nPrevOffset = asJobs[iStrip-1].nOffset;
+                for( int iX = 0; iX < nXSize; iX++ )
+                {
+                    const GInt32 nId = sJob.anFirstLineId[iX];
+                    if( nId < 0 )
+                        continue;
+                    const DataType nVal = sJob.panVal[iX];
+                    const int iXMin = nConnectedness == 8 ? iX - 1 : iX;
+                    const int iXMax = nConnectedness == 8 ? iX + 1 : iX;
+                    for( int iXPrev = std::max(0, iXMin);
+                         iXPrev <= std::min(nXSize - 1, iXMax); iXPrev++ )
+                    {
+                        if( anPrevLastLineId[iXPrev] >= 0 &&
+                            eq(aPrevLastLineVal[iXPrev], nVal) )
+                        {
+                            GPUnion( anGlobalId,
+                                     nPrevOffset + anPrevLastLineId[iXPrev],
+                                     sJob.nOffset + nId );
+                        }
+                    }
+                }
+            }
+            std::vector<GInt32>().swap(sJob.anFirstLineId);
+
+            memcpy( &aPrevLastLineVal[0],
+                    sJob.panVal + static_cast<size_t>(sJob.nLines - 1) *
+                                                                    nXSize,
+                    sizeof(DataType) * nXSize );
+            anPrevLastLineId.swap(sJob.anLastLineId);
+            std::vector<GInt32>().swap(sJob.anLastLineId);
+
+            // Keep the last line, compressed, for the second pass.
+            for( int iX = 0; iX < nXSize; iX++ )
+            {
+                if( iX == 0 || anPrevLastLineId[iX] != anPrevLastLineId[iX-1] )
+                    sJob.aoLastLineRuns.push_back(
+                        std::pair<int, GInt32>(iX, anPrevLastLineId[iX]) );
+            }
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress( 0.10 * (iFirstStrip + nJobs) / nStrips,
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Point every id to its root, and find the range of strips in     */
+/*      which the edges of each polygon will be collected: a polygon    */
+/*      touching the last line of a strip also has edges in the next.   */
+/* -------------------------------------------------------------------- */
+    const size_t nPolys = anGlobalId.size();
+    for( size_t i = 0; i < nPolys; i++ )
+        anGlobalId[i] = anGlobalId[anGlobalId[i]];
+
+    std::vector<int> anMinStrip;
+    std::vector<int> anMaxStrip;
+    if( eErr == CE_None )
+    {
+        anMinStrip.resize(nPolys, nStrips);
+        anMaxStrip.resize(nPolys, -1);
+        for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+        {
+            const size_t nEnd = iStrip + 1 < nStrips ?
+                asJobs[iStrip+1].nOffset : nPolys;
+            for( size_t i = asJobs[iStrip].nOffset; i < nEnd; i++ )
+            {
+                const GInt32 nRoot = anGlobalId[i];
+                anMinStrip[nRoot] = std::min(anMinStrip[nRoot], iStrip);
+                anMaxStrip[nRoot] = std::max(anMaxStrip[nRoot], iStrip);
+            }
+            if( iStrip + 1 < nStrips )
+            {
+                const GPLineRuns& aoRuns = asJobs[iStrip].aoLastLineRuns;
+                for( size_t i = 0; i < aoRuns.size(); i++ )
+                {
+                    if( aoRuns[i].second < 0 )
+                        continue;
+                    const GInt32 nRoot = anGlobalId[asJobs[iStrip].nOffset +
+                                                    aoRuns[i].second];
+                    anMaxStrip[nRoot] = std::max(anMaxStrip[nRoot],
+                                                 iStrip + 1);
+                }
+            }
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Second pass: collect edges, and write out polygons as soon as   */
+/*      they are complete.                                              */
+/* -------------------------------------------------------------------- */
+    std::map<GInt32, RPolygon*> oOpenPolys;
+
+    for( int iFirstStrip = 0;
+         eErr == CE_None && iFirstStrip < nStrips;
+         iFirstStrip += nBatchSize )
+    {
+        const int nJobs = std::min(nBatchSize, nStrips - iFirstStrip);
+        for( int iStrip = iFirstStrip; iStrip < iFirstStrip + nJobs; iStrip++ )
+        {
+            Job& sJob = asJobs[iStrip];
+            sJob.panGlobalId = anGlobalId.data();
+            sJob.paGlobalValue = aGlobalValue.data();
+            sJob.panMinStrip = anMinStrip.data();
+            sJob.panMaxStrip = anMaxStrip.data();
+            sJob.anPrevLineId.assign(nXSize + 2, -1);
+            if( iStrip > 0 )
+            {
+                GPLineRuns& aoRuns = asJobs[iStrip-1].aoLastLineRuns;
+                const GInt32 nPrevOffset = asJobs[iStrip-1].nOffset;
+                for( size_t i = 0; i < aoRuns.size(); i++ )
+                {
+                    const int iXEnd = i + 1 < aoRuns.size() ?
+                        aoRuns[i+1].first : nXSize;
+                    const GInt32 nId = aoRuns[i].second < 0 ? -1 :
+                        anGlobalId[nPrevOffset + aoRuns[i].second];
+                    for( int iX = aoRuns[i].first; iX < iXEnd; iX++ )
+                        sJob.anPrevLineId[iX+1] = nId;
+                }
+                GPLineRuns().swap(aoRuns);
+            }
+        }
+
+        eErr = RunBatch( iFirstStrip, nJobs,
+                         GPStripSecondPass<DataType, EqualityTest> );
+
+        for( int iStrip = iFirstStrip; iStrip < iFirstStrip + nJobs; iStrip++ )
+        {
+            Job& sJob = asJobs[iStrip];
+
+            for( size_t i = 0; i < sJob.aoComplete.size(); i++ )
+            {
+                if( eErr == CE_None )
+                    eErr = EmitGeometryToLayer( hOutLayer, iPixValField,
+                                                sJob.aoComplete[i].first,
+                                                sJob.aoComplete[i].second );
+                else
+                    OGR_G_DestroyGeometry( sJob.aoComplete[i].first );
+            }
+            sJob.aoComplete.clear();
+
+            // Gather the edges of polygons spanning several strips, and
+            // write them out once their last strip has been reached.
+            for( size_t i = 0; i < sJob.aoPartial.size(); i++ )
+            {
+                const GInt32 nId = sJob.aoPartial[i].first;
+                RPolygon* poPart = sJob.aoPartial[i].second;
+                std::map<GInt32, RPolygon*>::iterator oIter =
+                    oOpenPolys.find(nId);
+                RPolygon* poPoly = poPart;
+                if( oIter == oOpenPolys.end() )
+                {
+                    oOpenPolys[nId] = poPart;
+                }
+                else
+                {
+                    poPoly = oIter->second;
+                    poPoly->aanXY.insert( poPoly->aanXY.end(),
+                                          poPart->aanXY.begin(),
+                                          poPart->aanXY.end() );
+                    delete poPart;
+                }
+
+                if( anMaxStrip[nId] == iStrip )
+                {
+                    if( eErr == CE_None )
+                        eErr = EmitGeometryToLayer(
+                            hOutLayer, iPixValField,
+                            RPolygonToGeometry( poPoly, padfGeoTransform,
+                                                nStripHeight ),
+                            poPoly->dfPolyValue );
+                    delete poPoly;
+                    oOpenPolys.erase(nId);
+                }
+            }
+            sJob.aoPartial.clear();
+            std::vector<GInt32>().swap(sJob.anRawToLocal);
+        }
+
+        if( eErr == CE_None &&
+            !pfnProgress( 0.10 + 0.90 * (iFirstStrip + nJobs) / nStrips,
+                          "", pProgressArg ) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Cleanup                                                         */
+/* -------------------------------------------------------------------- */
+    CPLAssert( eErr != CE_None || oOpenPolys.empty() );
+    for( std::map<GInt32, RPolygon*>::iterator oIter = oOpenPolys.begin();
+         oIter != oOpenPolys.end(); ++oIter )
+    {
+        delete oIter->second;
+    }
+    for( int iStrip = 0; iStrip < nStrips; iStrip++ )
+    {
+        for( size_t i = 0; i < asJobs[iStrip].aoComplete.size(); i++ )
+            OGR_G_DestroyGeometry( asJobs[iStrip].aoComplete[i].first );
+        for( size_t i = 0; i < asJobs[iStrip].aoPartial.size(); i++ )
+            delete asJobs[iStrip].aoPartial[i].second;
+    }
+
+    CPLFree( panVal );
+    CPLFree( pabyMask );
+    delete poThreadPool;
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                           GDALPolygonizeT()                          */
 /************************************************************************/
@@ -462,11 +1234,42 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
+    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
+    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
+
+    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
+    GPGetGeoTransform( hSrcBand, papszOptions, adfGeoTransform );
+
+/* -------------------------------------------------------------------- */
+/*      Use the tiled algorithm if several threads are requested, or    */
+/*      a tile height is explicitly set.  As its output differs from    */
+/*      the one of the single pass algorithm (feature order, start of   */
+/*      the rings, collinear vertices on strip edges), it is only used  */
+/*      on request, and not merely because GDAL_NUM_THREADS is set.     */
+/* -------------------------------------------------------------------- */
+    const char* pszThreads = CSLFetchNameValue(papszOptions, "NUM_THREADS");
+    const int nThreads = pszThreads ? CPLGetNumThreads(pszThreads) : 1;
+    const char* pszTileHeight = CSLFetchNameValue(papszOptions, "TILE_HEIGHT");
+    if( nThreads > 1 || pszTileHeight != nullptr )
+    {
+        // By default, about 4 million pixels per strip.
+        const int nStripHeight = pszTileHeight ? atoi(pszTileHeight) :
+            std::max(64, 4 * 1024 * 1024 / std::max(1, nXSize));
+        if( nStripHeight <= 0 )
+        {
+            CPLError( CE_Failure, CPLE_IllegalArg,
+                      "Invalid value for TILE_HEIGHT: %s", pszTileHeight );
+            return CE_Failure;
+        }
+        return GDALPolygonizeTiledT<DataType, EqualityTest>(
+            hSrcBand, hMaskBand, hOutLayer, iPixValField, nConnectedness,
+            nThreads, nStripHeight, adfGeoTransform,
+            pfnProgress, pProgressArg, eDT );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Allocate working buffers.                                       */
 /* -------------------------------------------------------------------- */
-    const int nXSize = GDALGetRasterBandXSize( hSrcBand );
-    const int nYSize = GDALGetRasterBandYSize( hSrcBand );
 
     DataType *panLastLineVal = static_cast<DataType *>(
         VSI_MALLOC2_VERBOSE(sizeof(DataType), nXSize + 2));
@@ -494,30 +1297,6 @@ GDALPolygonizeT( GDALRasterBandH hSrcBand,
         return CE_Failure;
     }
 
-/* -------------------------------------------------------------------- */
-/*      Get the geotransform, if there is one, so we can convert the    */
-/*      vectors into georeferenced coordinates.                         */
-/* -------------------------------------------------------------------- */
-    double adfGeoTransform[6] = { 0.0, 1.0, 0.0, 0.0, 0.0, 1.0 };
-
-    const char* pszDatasetForGeoRef = CSLFetchNameValue(papszOptions,
-                                                        "DATASET_FOR_GEOREF");
-    if( pszDatasetForGeoRef )
-    {
-        GDALDatasetH hSrcDS = GDALOpen(pszDatasetForGeoRef, GA_ReadOnly);
-        if( hSrcDS )
-        {
-            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
-            GDALClose(hSrcDS);
-        }
-    }
-    else
-    {
-        GDALDatasetH hSrcDS = GDALGetBandDataset( hSrcBand );
-        if( hSrcDS )
-            GDALGetGeoTransform( hSrcDS, adfGeoTransform );
-    }
-
 /* -------------------------------------------------------------------- */
 /*      The first pass over the raster is only used to build up the     */
 /*      polygon id map so we will know in advance what polygons are     */
@@ -815,6 +1594,18 @@ GBool GDALFloatEquals( float A, float B )
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"NUM_THREADS":</dt> (GDAL >= 2.4) Number of worker threads, or
+ * ALL_CPUS. Defaults to 1: unlike other algorithms, the GDAL_NUM_THREADS
+ * configuration option is not used. With several threads, the raster is
+ * processed in strips of lines that are polygonized in parallel and stitched
+ * together. The resulting polygons cover the same areas as with a single
+ * thread, but they may be written in a different order, their rings may start
+ * at a different vertex, and collinear vertices on the edges of the strips
+ * are removed.
+ * <dt>"TILE_HEIGHT":</dt> (GDAL >= 2.4) Height, in lines, of the strips
+ * processed by each thread. Setting it also enables the strip based
+ * algorithm with a single thread. Defaults to about 4 million pixels per
+ * strip.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
@@ -891,6 +1682,18 @@ GDALPolygonize( GDALRasterBandH hSrcBand,
  * <dl>
  * <dt>"8CONNECTED":</dt> May be set to "8" to use 8 connectedness.
  * Otherwise 4 connectedness will be applied to the algorithm
+ * <dt>"NUM_THREADS":</dt> (GDAL >= 2.4) Number of worker threads, or
+ * ALL_CPUS. Defaults to 1: unlike other algorithms, the GDAL_NUM_THREADS
+ * configuration option is not used. With several threads, the raster is
+ * processed in strips of lines that are polygonized in parallel and stitched
+ * together. The resulting polygons cover the same areas as with a single
+ * thread, but they may be written in a different order, their rings may start
+ * at a different vertex, and collinear vertices on the edges of the strips
+ * are removed.
+ * <dt>"TILE_HEIGHT":</dt> (GDAL >= 2.4) Height, in lines, of the strips
+ * processed by each thread. Setting it also enables the strip based
+ * algorithm with a single thread. Defaults to about 4 million pixels per
+ * strip.
  * </dl>
  * @param pfnProgress callback for reporting algorithm progress matching the
  * GDALProgressFunc() semantics.  May be NULL.
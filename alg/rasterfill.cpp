@@ -37,16 +37,23 @@
 #include <algorithm>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
+#include "gdal_alg_priv.h"
 
 CPL_CVSID("$Id: rasterfill.cpp 9ff327806cd64df6d73a6c91f92d12ca0c5e07df 2018-04-07 20:25:06 +0200 Even Rouault $")
 
+// Maximum number of pixels of the lines kept in memory by the strip based
+// implementation of GDALFillNodata(), beyond which work files are used.
+static const GIntBig FILL_MAX_STRIP_BUFFER_PIXELS = 32 * 1024 * 1024;
+
 /************************************************************************/
 /*                           GDALFilterLine()                           */
 /*                                                                      */
@@ -362,127 +369,166 @@ if( quad_value != nNoDataVal )                                          \
     }                                                                   \
 }
 
+
 /************************************************************************/
-/*                           GDALFillNodata()                           */
+/*                         GDALFillUpdateNearest()                      */
+/*                                                                      */
+/*      Update, for each column, the line and value of the nearest      */
+/*      valid pixel found so far while scanning lines from top to       */
+/*      bottom (bTopDown) or from bottom to top, given the mask and     */
+/*      values of line iY.                                              */
 /************************************************************************/
 
-/**
- * Fill selected raster regions by interpolation from the edges.
- *
- * This algorithm will interpolate values for all designated
- * nodata pixels (marked by zeros in hMaskBand).  For each pixel
- * a four direction conic search is done to find values to interpolate
- * from (using inverse distance weighting).  Once all values are
- * interpolated, zero or more smoothing iterations (3x3 average
- * filters on interpolated pixels) are applied to smooth out
- * artifacts.
- *
- * This algorithm is generally suitable for interpolating missing
- * regions of fairly continuously varying rasters (such as elevation
- * models for instance).  It is also suitable for filling small holes
- * and cracks in more irregularly varying images (like airphotos).  It
- * is generally not so great for interpolating a raster from sparse
- * point data - see the algorithms defined in gdal_grid.h for that case.
- *
- * @param hTargetBand the raster band to be modified in place.
- * @param hMaskBand a mask band indicating pixels to be interpolated
- * (zero valued).
- * @param dfMaxSearchDist the maximum number of pixels to search in all
- * directions to find values to interpolate from.
- * @param bDeprecatedOption unused argument, should be zero.
- * @param nSmoothingIterations the number of 3x3 smoothing filter passes to
- * run (0 or more).
- * @param papszOptions additional name=value options in a string list (the
- * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM).
- * @param pfnProgress the progress function to report completion.
- * @param pProgressArg callback data for progress function.
- *
- * @return CE_None on success or CE_Failure if something goes wrong.
- */
-
-CPLErr CPL_STDCALL
-GDALFillNodata( GDALRasterBandH hTargetBand,
-                GDALRasterBandH hMaskBand,
-                double dfMaxSearchDist,
-                CPL_UNUSED int bDeprecatedOption,
-                int nSmoothingIterations,
-                char **papszOptions,
-                GDALProgressFunc pfnProgress,
-                void * pProgressArg )
-
+static void
+GDALFillUpdateNearest( int iY, bool bTopDown, int nXSize,
+                       const GByte *pabyMask, const float *pafScanline,
+                       GUInt32 *panNearY, float *pafNearValue,
+                       double dfMaxSearchDist, GUInt32 nNoDataVal )
 {
-    VALIDATE_POINTER1( hTargetBand, "GDALFillNodata", CE_Failure );
-
-    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
-    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        if( pabyMask[iX] )
+        {
+            pafNearValue[iX] = pafScanline[iX];
+            panNearY[iX] = iY;
+        }
+        else if( bTopDown ? iY <= dfMaxSearchDist + panNearY[iX] :
+                            panNearY[iX] - iY <= dfMaxSearchDist )
+        {
+            // Keep the previous nearest pixel.
+        }
+        else
+        {
+            panNearY[iX] = nNoDataVal;
+        }
+    }
+}
 
-    if( dfMaxSearchDist == 0.0 )
-        dfMaxSearchDist = std::max(nXSize, nYSize) + 1;
+/************************************************************************/
+/*                            GDALFillLine()                            */
+/*                                                                      */
+/*      Interpolate the pixels of line iY, between iXStart and iXEnd,   */
+/*      that are not valid according to pabyMask.  For each one, a     */
+/*      four direction conic search is done among the nearest valid     */
+/*      pixels on or above this line (panTopDownY) and below it         */
+/*      (panBottomUpY) in the neighbouring columns.  Interpolated       */
+/*      pixels are flagged in pabyFiltMask.                             */
+/************************************************************************/
 
+static void
+GDALFillLine( int iY, int nXSize, int iXStart, int iXEnd,
+              const GUInt32 *panTopDownY, const float *pafTopDownValue,
+              const GUInt32 *panBottomUpY, const float *pafBottomUpValue,
+              const GByte *pabyMask, float *pafScanline, GByte *pabyFiltMask,
+              double dfMaxSearchDist, GUInt32 nNoDataVal )
+{
     const int nMaxSearchDist = static_cast<int>(floor(dfMaxSearchDist));
 
-    // Special "x" pixel values identifying pixels as special.
-    GDALDataType eType = GDT_UInt16;
-    GUInt32 nNoDataVal = 65535;
-
-    if( nXSize > 65533 || nYSize > 65533 )
+    for( int iX = iXStart; iX < iXEnd; iX++ )
     {
-        eType = GDT_UInt32;
-        nNoDataVal = 4000002;
-    }
+        int nThisMaxSearchDist = nMaxSearchDist;
 
-    if( hMaskBand == nullptr )
-        hMaskBand = GDALGetMaskBand( hTargetBand );
+        // If this was a valid target - no change.
+        if( pabyMask[iX] )
+            continue;
 
-    // If there are smoothing iterations, reserve 10% of the progress for them.
-    const double dfProgressRatio = nSmoothingIterations > 0 ? 0.9 : 1.0;
+        // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
+        double adfQuadDist[4] = {};
+        double adfQuadValue[4] = {};
 
-/* -------------------------------------------------------------------- */
-/*      Initialize progress counter.                                    */
-/* -------------------------------------------------------------------- */
-    if( pfnProgress == nullptr )
-        pfnProgress = GDALDummyProgress;
+        for( int iQuad = 0; iQuad < 4; iQuad++ )
+        {
+            adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
+            adfQuadValue[iQuad] = 0.0;
+        }
 
-    if( !pfnProgress( 0.0, "Filling...", pProgressArg ) )
-    {
-        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
-        return CE_Failure;
-    }
+        // Step left and right by one pixel searching for the closest
+        // target value for each quadrant.
+        for( int iStep = 0; iStep < nThisMaxSearchDist; iStep++ )
+        {
+            const int iLeftX = std::max(0, iX - iStep);
+            const int iRightX = std::min(nXSize - 1, iX + iStep);
+
+            // Top left includes current line.
+            QUAD_CHECK(adfQuadDist[0], adfQuadValue[0],
+                       iLeftX, panTopDownY[iLeftX], iX, iY,
+                       pafTopDownValue[iLeftX] );
+
+            // Bottom left.
+            QUAD_CHECK(adfQuadDist[1], adfQuadValue[1],
+                       iLeftX, panBottomUpY[iLeftX], iX, iY,
+                       pafBottomUpValue[iLeftX] );
+
+            // Top right and bottom right do no include center pixel.
+            if( iStep == 0 )
+                 continue;
+
+            // Top right includes current line.
+            QUAD_CHECK(adfQuadDist[2], adfQuadValue[2],
+                       iRightX, panTopDownY[iRightX], iX, iY,
+                       pafTopDownValue[iRightX] );
+
+            // Bottom right.
+            QUAD_CHECK(adfQuadDist[3], adfQuadValue[3],
+                       iRightX, panBottomUpY[iRightX], iX, iY,
+                       pafBottomUpValue[iRightX] );
+
+            // Every four steps, recompute maximum distance.
+            if( (iStep & 0x3) == 0 )
+                nThisMaxSearchDist = static_cast<int>(floor(
+                    std::max(std::max(adfQuadDist[0], adfQuadDist[1]),
+                             std::max(adfQuadDist[2], adfQuadDist[3]))));
+        }
 
-/* -------------------------------------------------------------------- */
-/*      Determine format driver for temp work files.                    */
-/* -------------------------------------------------------------------- */
-    CPLString osTmpFileDriver = CSLFetchNameValueDef(
-            papszOptions, "TEMP_FILE_DRIVER", "GTiff");
-    GDALDriverH hDriver = GDALGetDriverByName(osTmpFileDriver.c_str());
+        double dfWeightSum = 0.0;
+        double dfValueSum = 0.0;
 
-    if( hDriver == nullptr )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "Given driver is not registered");
-        return CE_Failure;
-    }
+        for( int iQuad = 0; iQuad < 4; iQuad++ )
+        {
+            if( adfQuadDist[iQuad] <= dfMaxSearchDist )
+            {
+                const double dfWeight = 1.0 / adfQuadDist[iQuad];
 
-    if( GDALGetMetadataItem(hDriver, GDAL_DCAP_CREATE, nullptr) == nullptr )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "Given driver is incapable of creating temp work files");
-        return CE_Failure;
-    }
+                dfWeightSum += dfWeight;
+                dfValueSum += adfQuadValue[iQuad] * dfWeight;
+            }
+        }
 
-    char **papszWorkFileOptions = nullptr;
-    if( osTmpFileDriver == "GTiff" )
-    {
-        papszWorkFileOptions = CSLSetNameValue(
-                papszWorkFileOptions, "COMPRESS", "LZW");
-        papszWorkFileOptions = CSLSetNameValue(
-                papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
+        if( dfWeightSum > 0.0 )
+        {
+            pabyFiltMask[iX] = 255;
+            pafScanline[iX] = static_cast<float>(dfValueSum / dfWeightSum);
+        }
     }
+}
+
+/************************************************************************/
+/*                        GDALFillNodataWorkFiles()                     */
+/*                                                                      */
+/*      Fill the target band in two passes over the whole raster,       */
+/*      keeping the nearest valid pixel above each pixel in work        */
+/*      files between the passes.  This is used when the search         */
+/*      distance is too large for the strip based approach.             */
+/************************************************************************/
+
+static CPLErr
+GDALFillNodataWorkFiles( GDALRasterBandH hTargetBand,
+                         GDALRasterBandH hMaskBand,
+                         GDALRasterBandH hFiltMaskBand,
+                         double dfMaxSearchDist,
+                         GDALDataType eType, GUInt32 nNoDataVal,
+                         GDALDriverH hDriver, char **papszWorkFileOptions,
+                         const CPLString &osTmpFile,
+                         double dfProgressRatio,
+                         GDALProgressFunc pfnProgress,
+                         void * pProgressArg )
+{
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
 
 /* -------------------------------------------------------------------- */
 /*      Create a work file to hold the Y "last value" indices.          */
 /* -------------------------------------------------------------------- */
-    const CPLString osTmpFile = CPLGenerateTempFilename("");
     const CPLString osYTmpFile = osTmpFile + "fill_y_work.tif";
 
     GDALDatasetH hYDS =
@@ -514,43 +560,22 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
     {
         CPLError(CE_Failure, CPLE_AppDefined,
             "Could not create XY value work file. Check driver capabilities.");
+        GDALClose( hYDS );
+        GDALDeleteDataset( hDriver, osYTmpFile );
         return CE_Failure;
     }
 
     GDALRasterBandH hValBand = GDALGetRasterBand( hValDS, 1 );
 
 /* -------------------------------------------------------------------- */
-/*      Create a mask file to make it clear what pixels can be filtered */
-/*      on the filtering pass.                                          */
+/*      Allocate buffers for the nearest pixels and this scanline.      */
 /* -------------------------------------------------------------------- */
-    const CPLString osFiltMaskTmpFile = osTmpFile + "fill_filtmask_work.tif";
-
-    GDALDatasetH hFiltMaskDS =
-        GDALCreate( hDriver, osFiltMaskTmpFile, nXSize, nYSize, 1,
-                    GDT_Byte, papszWorkFileOptions );
-
-    if( hFiltMaskDS == nullptr )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-            "Could not create mask work file. Check driver capabilities.");
-        return CE_Failure;
-    }
-
-    GDALRasterBandH hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
 
-/* -------------------------------------------------------------------- */
-/*      Allocate buffers for last scanline and this scanline.           */
-/* -------------------------------------------------------------------- */
-
-    GUInt32 *panLastY =
-        static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
-    GUInt32 *panThisY =
+    GUInt32 *panNearY =
         static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
     GUInt32 *panTopDownY =
         static_cast<GUInt32 *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(GUInt32)));
-    float *pafLastValue =
-        static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
-    float *pafThisValue =
+    float *pafNearValue =
         static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
     float *pafTopDownValue =
         static_cast<float *>(VSI_CALLOC_VERBOSE(nXSize, sizeof(float)));
@@ -561,9 +586,8 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 
     CPLErr eErr = CE_None;
 
-    if( panLastY == nullptr || panThisY == nullptr || panTopDownY == nullptr ||
-        pafLastValue == nullptr || pafThisValue == nullptr ||
-        pafTopDownValue == nullptr ||
+    if( panNearY == nullptr || panTopDownY == nullptr ||
+        pafNearValue == nullptr || pafTopDownValue == nullptr ||
         pafScanline == nullptr || pabyMask == nullptr || pabyFiltMask == nullptr )
     {
         eErr = CE_Failure;
@@ -572,7 +596,7 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 
     for( int iX = 0; iX < nXSize; iX++ )
     {
-        panLastY[iX] = nNoDataVal;
+        panNearY[iX] = nNoDataVal;
     }
 
 /* ==================================================================== */
@@ -603,44 +627,23 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 /* -------------------------------------------------------------------- */
 /*      Figure out the most recent pixel for each column.               */
 /* -------------------------------------------------------------------- */
-
-        for( int iX = 0; iX < nXSize; iX++ )
-        {
-            if( pabyMask[iX] )
-            {
-                pafThisValue[iX] = pafScanline[iX];
-                panThisY[iX] = iY;
-            }
-            else if( iY <= dfMaxSearchDist + panLastY[iX] )
-            {
-                pafThisValue[iX] = pafLastValue[iX];
-                panThisY[iX] = panLastY[iX];
-            }
-            else
-            {
-                panThisY[iX] = nNoDataVal;
-            }
-        }
+        GDALFillUpdateNearest( iY, true, nXSize, pabyMask, pafScanline,
+                               panNearY, pafNearValue,
+                               dfMaxSearchDist, nNoDataVal );
 
 /* -------------------------------------------------------------------- */
 /*      Write out best index/value to working files.                    */
 /* -------------------------------------------------------------------- */
         eErr = GDALRasterIO( hYBand, GF_Write, 0, iY, nXSize, 1,
-                             panThisY, nXSize, 1, GDT_UInt32, 0, 0 );
+                             panNearY, nXSize, 1, GDT_UInt32, 0, 0 );
         if( eErr != CE_None )
             break;
 
         eErr = GDALRasterIO( hValBand, GF_Write, 0, iY, nXSize, 1,
-                             pafThisValue, nXSize, 1, GDT_Float32, 0, 0 );
+                             pafNearValue, nXSize, 1, GDT_Float32, 0, 0 );
         if( eErr != CE_None )
             break;
 
-/* -------------------------------------------------------------------- */
-/*      Flip this/last buffers.                                         */
-/* -------------------------------------------------------------------- */
-        std::swap(pafThisValue, pafLastValue);
-        std::swap(panThisY, panLastY);
-
 /* -------------------------------------------------------------------- */
 /*      report progress.                                                */
 /* -------------------------------------------------------------------- */
@@ -660,6 +663,11 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
 /*      bottom to top and use it in combination with the top to         */
 /*      bottom search info to interpolate.                              */
 /* ==================================================================== */
+    for( int iX = 0; iX < nXSize; iX++ )
+    {
+        panNearY[iX] = nNoDataVal;
+    }
+
     for( int iY = nYSize-1; iY >= 0 && eErr == CE_None; iY-- )
     {
         eErr =
@@ -676,28 +684,6 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
         if( eErr != CE_None )
             break;
 
-/* -------------------------------------------------------------------- */
-/*      Figure out the most recent pixel for each column.               */
-/* -------------------------------------------------------------------- */
-
-        for( int iX = 0; iX < nXSize; iX++ )
-        {
-            if( pabyMask[iX] )
-            {
-                pafThisValue[iX] = pafScanline[iX];
-                panThisY[iX] = iY;
-            }
-            else if( panLastY[iX] - iY <= dfMaxSearchDist )
-            {
-                pafThisValue[iX] = pafLastValue[iX];
-                panThisY[iX] = panLastY[iX];
-            }
-            else
-            {
-                panThisY[iX] = nNoDataVal;
-            }
-        }
-
 /* -------------------------------------------------------------------- */
 /*      Load the last y and corresponding value from the top down pass. */
 /* -------------------------------------------------------------------- */
@@ -716,86 +702,19 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
             break;
 
 /* -------------------------------------------------------------------- */
-/*      Attempt to interpolate any pixels that are nodata.              */
+/*      Attempt to interpolate any pixels that are nodata, from the     */
+/*      nearest pixels below this line, then take this line into        */
+/*      account for the next ones.                                      */
 /* -------------------------------------------------------------------- */
         memset( pabyFiltMask, 0, nXSize );
-        for( int iX = 0; iX < nXSize; iX++ )
-        {
-            int nThisMaxSearchDist = nMaxSearchDist;
-
-            // If this was a valid target - no change.
-            if( pabyMask[iX] )
-                continue;
-
-            // Quadrants 0:topleft, 1:bottomleft, 2:topright, 3:bottomright
-            double adfQuadDist[4] = {};
-            double adfQuadValue[4] = {};
-
-            for( int iQuad = 0; iQuad < 4; iQuad++ )
-            {
-                adfQuadDist[iQuad] = dfMaxSearchDist + 1.0;
-                adfQuadValue[iQuad] = 0.0;
-            }
-
-            // Step left and right by one pixel searching for the closest
-            // target value for each quadrant.
-            for( int iStep = 0; iStep < nThisMaxSearchDist; iStep++ )
-            {
-                const int iLeftX = std::max(0, iX - iStep);
-                const int iRightX = std::min(nXSize - 1, iX + iStep);
-
-                // Top left includes current line.
-                QUAD_CHECK(adfQuadDist[0], adfQuadValue[0],
-                           iLeftX, panTopDownY[iLeftX], iX, iY,
-                           pafTopDownValue[iLeftX] );
-
-                // Bottom left.
-                QUAD_CHECK(adfQuadDist[1], adfQuadValue[1],
-                           iLeftX, panLastY[iLeftX], iX, iY,
-                           pafLastValue[iLeftX] );
-
-                // Top right and bottom right do no include center pixel.
-                if( iStep == 0 )
-                     continue;
-
-                // Top right includes current line.
-                QUAD_CHECK(adfQuadDist[2], adfQuadValue[2],
-                           iRightX, panTopDownY[iRightX], iX, iY,
-                           pafTopDownValue[iRightX] );
-
-                // Bottom right.
-                QUAD_CHECK(adfQuadDist[3], adfQuadValue[3],
-                           iRightX, panLastY[iRightX], iX, iY,
-                           pafLastValue[iRightX] );
-
-                // Every four steps, recompute maximum distance.
-                if( (iStep & 0x3) == 0 )
-                    nThisMaxSearchDist = static_cast<int>(floor(
-                        std::max(std::max(adfQuadDist[0], adfQuadDist[1]),
-                                 std::max(adfQuadDist[2], adfQuadDist[3]))));
-            }
+        GDALFillLine( iY, nXSize, 0, nXSize,
+                      panTopDownY, pafTopDownValue, panNearY, pafNearValue,
+                      pabyMask, pafScanline, pabyFiltMask,
+                      dfMaxSearchDist, nNoDataVal );
 
-            double dfWeightSum = 0.0;
-            double dfValueSum = 0.0;
-
-            for( int iQuad = 0; iQuad < 4; iQuad++ )
-            {
-                if( adfQuadDist[iQuad] <= dfMaxSearchDist )
-                {
-                    const double dfWeight = 1.0 / adfQuadDist[iQuad];
-
-                    dfWeightSum += dfWeight;
-                    dfValueSum += adfQuadValue[iQuad] * dfWeight;
-                }
-            }
-
-            if( dfWeightSum > 0.0 )
-            {
-                pabyMask[iX] = 255;
-                pabyFiltMask[iX] = 255;
-                pafScanline[iX] = static_cast<float>(dfValueSum / dfWeightSum);
-            }
-        }
+        GDALFillUpdateNearest( iY, false, nXSize, pabyMask, pafScanline,
+                               panNearY, pafNearValue,
+                               dfMaxSearchDist, nNoDataVal );
 
 /* -------------------------------------------------------------------- */
 /*      Write out the updated data and mask information.                */
@@ -814,12 +733,6 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
         if( eErr != CE_None )
             break;
 
-/* -------------------------------------------------------------------- */
-/*      Flip this/last buffers.                                         */
-/* -------------------------------------------------------------------- */
-        std::swap(pafThisValue, pafLastValue);
-        std::swap(panThisY, panLastY);
-
 /* -------------------------------------------------------------------- */
 /*      report progress.                                                */
 /* -------------------------------------------------------------------- */
@@ -834,6 +747,527 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Close and clean up temporary files. Free working buffers        */
+/* -------------------------------------------------------------------- */
+end:
+    CPLFree(panNearY);
+    CPLFree(panTopDownY);
+    CPLFree(pafNearValue);
+    CPLFree(pafTopDownValue);
+    CPLFree(pafScanline);
+    CPLFree(pabyMask);
+    CPLFree(pabyFiltMask);
+
+    GDALClose( hYDS );
+    GDALClose( hValDS );
+
+    GDALDeleteDataset( hDriver, osYTmpFile );
+    GDALDeleteDataset( hDriver, osValTmpFile );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                          GDALFillTileJob                             */
+/*                                                                      */
+/*      A tile of a strip of lines to fill.  The strip buffer holds     */
+/*      the original mask and values of the strip lines, and of the     */
+/*      lines within the search distance above and below them.          */
+/************************************************************************/
+
+namespace {
+struct GDALFillTileJob
+{
+    int           nXSize;
+    int           nBufYOff;
+    int           nBufLines;
+    const GByte  *pabyMaskBuf;
+    const float  *pafValueBuf;
+
+    int           nStripYOff;
+    int           nStripLines;
+    int           iTileXOff;
+    int           nTileXSize;
+    int           nHalo;
+    double        dfMaxSearchDist;
+    GUInt32       nNoDataVal;
+
+    // nStripLines lines of nXSize pixels, of which the tile columns are
+    // written.
+    float        *pafOut;
+    GByte        *pabyFiltMaskOut;
+};
+}  // namespace
+
+/************************************************************************/
+/*                          GDALFillTileJobFunc()                       */
+/************************************************************************/
+
+static void GDALFillTileJobFunc( void *pData )
+{
+    const GDALFillTileJob *psJob = static_cast<GDALFillTileJob *>(pData);
+    const int nXSize = psJob->nXSize;
+
+    // Columns within the search distance of the tile.
+    const int iWinXOff = std::max(0, psJob->iTileXOff - psJob->nHalo);
+    const int iWinXEnd = std::min(nXSize, psJob->iTileXOff +
+                                          psJob->nTileXSize + psJob->nHalo);
+    const int nWinXSize = iWinXEnd - iWinXOff;
+    const size_t nWinPixels =
+        static_cast<size_t>(psJob->nStripLines) * nWinXSize;
+
+    std::vector<GUInt32> anNearY(nWinXSize, psJob->nNoDataVal);
+    std::vector<float> afNearValue(nWinXSize);
+    std::vector<GUInt32> anTopDownY(nWinPixels);
+    std::vector<float> afTopDownValue(nWinPixels);
+    std::vector<float> afScanline(nWinXSize);
+    std::vector<GByte> abyFiltMask(nWinXSize);
+
+/* -------------------------------------------------------------------- */
+/*      Top to bottom, keeping the nearest pixels of the strip lines.   */
+/* -------------------------------------------------------------------- */
+    const int iStripEnd = psJob->nStripYOff + psJob->nStripLines;
+    for( int iY = psJob->nBufYOff; iY < iStripEnd; iY++ )
+    {
+        const size_t nOffset =
+            static_cast<size_t>(iY - psJob->nBufYOff) * nXSize + iWinXOff;
+        GDALFillUpdateNearest( iY, true, nWinXSize,
+                               psJob->pabyMaskBuf + nOffset,
+                               psJob->pafValueBuf + nOffset,
+                               &anNearY[0], &afNearValue[0],
+                               psJob->dfMaxSearchDist, psJob->nNoDataVal );
+        if( iY >= psJob->nStripYOff )
+        {
+            const size_t nStripOffset =
+                static_cast<size_t>(iY - psJob->nStripYOff) * nWinXSize;
+            memcpy( &anTopDownY[nStripOffset], &anNearY[0],
+                    nWinXSize * sizeof(GUInt32) );
+            memcpy( &afTopDownValue[nStripOffset], &afNearValue[0],
+                    nWinXSize * sizeof(float) );
+        }
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Bottom to top, interpolating the strip lines.                   */
+/* -------------------------------------------------------------------- */
+    std::fill( anNearY.begin(), anNearY.end(), psJob->nNoDataVal );
+    for( int iY = psJob->nBufYOff + psJob->nBufLines - 1;
+         iY >= psJob->nStripYOff; iY-- )
+    {
+        const size_t nOffset =
+            static_cast<size_t>(iY - psJob->nBufYOff) * nXSize + iWinXOff;
+        if( iY < iStripEnd )
+        {
+            const size_t nStripOffset =
+                static_cast<size_t>(iY - psJob->nStripYOff) * nWinXSize;
+            memcpy( &afScanline[0], psJob->pafValueBuf + nOffset,
+                    nWinXSize * sizeof(float) );
+            std::fill( abyFiltMask.begin(), abyFiltMask.end(), 0 );
+
+            const int iTileStart = psJob->iTileXOff - iWinXOff;
+            GDALFillLine( iY, nWinXSize,
+                          iTileStart, iTileStart + psJob->nTileXSize,
+                          &anTopDownY[nStripOffset],
+                          &afTopDownValue[nStripOffset],
+                          &anNearY[0], &afNearValue[0],
+                          psJob->pabyMaskBuf + nOffset,
+                          &afScanline[0], &abyFiltMask[0],
+                          psJob->dfMaxSearchDist, psJob->nNoDataVal );
+
+            const size_t nOutOffset =
+                static_cast<size_t>(iY - psJob->nStripYOff) * nXSize +
+                psJob->iTileXOff;
+            memcpy( psJob->pafOut + nOutOffset, &afScanline[iTileStart],
+                    psJob->nTileXSize * sizeof(float) );
+            memcpy( psJob->pabyFiltMaskOut + nOutOffset,
+                    &abyFiltMask[iTileStart], psJob->nTileXSize );
+        }
+
+        GDALFillUpdateNearest( iY, false, nWinXSize,
+                               psJob->pabyMaskBuf + nOffset,
+                               psJob->pafValueBuf + nOffset,
+                               &anNearY[0], &afNearValue[0],
+                               psJob->dfMaxSearchDist, psJob->nNoDataVal );
+    }
+}
+
+/************************************************************************/
+/*                          GDALFillNodataStrips()                      */
+/*                                                                      */
+/*      Fill the target band strip by strip, keeping in memory the      */
+/*      original lines within the search distance of the current        */
+/*      strip.  Each strip is split in tiles of columns that are        */
+/*      interpolated in parallel.                                       */
+/************************************************************************/
+
+static CPLErr
+GDALFillNodataStrips( GDALRasterBandH hTargetBand,
+                      GDALRasterBandH hMaskBand,
+                      GDALRasterBandH hFiltMaskBand,
+                      double dfMaxSearchDist, GUInt32 nNoDataVal,
+                      int nHalo, int nStripHeight, int nThreads,
+                      double dfProgressRatio,
+                      GDALProgressFunc pfnProgress,
+                      void * pProgressArg )
+{
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+    const int nBufCapacity =
+        static_cast<int>(std::min(static_cast<GIntBig>(nYSize),
+                                  static_cast<GIntBig>(nStripHeight) +
+                                  2 * static_cast<GIntBig>(nHalo)));
+
+    GByte *pabyMaskBuf = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nBufCapacity));
+    float *pafValueBuf = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(sizeof(float), nXSize, nBufCapacity));
+    float *pafOut = static_cast<float *>(
+        VSI_MALLOC3_VERBOSE(sizeof(float), nXSize, nStripHeight));
+    GByte *pabyFiltMaskOut = static_cast<GByte *>(
+        VSI_MALLOC2_VERBOSE(nXSize, nStripHeight));
+    if( pabyMaskBuf == nullptr || pafValueBuf == nullptr ||
+        pafOut == nullptr || pabyFiltMaskOut == nullptr )
+    {
+        CPLFree( pabyMaskBuf );
+        CPLFree( pafValueBuf );
+        CPLFree( pafOut );
+        CPLFree( pabyFiltMaskOut );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Tiles are made at least as wide as the search distance, so      */
+/*      that the extra columns each of them scans stay reasonable.      */
+/* -------------------------------------------------------------------- */
+    const int nTiles = std::max(1,
+        std::min(nThreads, nXSize / std::max(1, nHalo)));
+    CPLWorkerThreadPool *poThreadPool = CPLCreateWorkerThreadPool(nTiles);
+
+    std::vector<GDALFillTileJob> asJobs(nTiles);
+    std::vector<void*> apJobs;
+    for( int iTile = 0; iTile < nTiles; iTile++ )
+    {
+        const int iTileXOff = static_cast<int>(
+            static_cast<GIntBig>(nXSize) * iTile / nTiles);
+        const int iTileXEnd = static_cast<int>(
+            static_cast<GIntBig>(nXSize) * (iTile + 1) / nTiles);
+        asJobs[iTile].nXSize = nXSize;
+        asJobs[iTile].pabyMaskBuf = pabyMaskBuf;
+        asJobs[iTile].pafValueBuf = pafValueBuf;
+        asJobs[iTile].iTileXOff = iTileXOff;
+        asJobs[iTile].nTileXSize = iTileXEnd - iTileXOff;
+        asJobs[iTile].nHalo = nHalo;
+        asJobs[iTile].dfMaxSearchDist = dfMaxSearchDist;
+        asJobs[iTile].nNoDataVal = nNoDataVal;
+        asJobs[iTile].pafOut = pafOut;
+        asJobs[iTile].pabyFiltMaskOut = pabyFiltMaskOut;
+        apJobs.push_back(&asJobs[iTile]);
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Process strips from top to bottom.  The lines of the buffer     */
+/*      above the current strip have already been filled in the         */
+/*      target band, so they are kept from the previous strip rather    */
+/*      than read again.                                                */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    int nBufYOff = 0;
+    int nBufLines = 0;
+
+    for( int iStrip = 0; eErr == CE_None && iStrip < nYSize;
+         iStrip += nStripHeight )
+    {
+        const int nStripLines = std::min(nStripHeight, nYSize - iStrip);
+        const int iWantedStart = std::max(0, iStrip - nHalo);
+        const int iWantedEnd = static_cast<int>(
+            std::min(static_cast<GIntBig>(nYSize),
+                     static_cast<GIntBig>(iStrip) + nStripLines + nHalo));
+
+        const int nDrop = iWantedStart - nBufYOff;
+        if( nDrop > 0 )
+        {
+            const size_t nKeptPixels =
+                static_cast<size_t>(nBufLines - nDrop) * nXSize;
+            const size_t nDropPixels = static_cast<size_t>(nDrop) * nXSize;
+            memmove( pabyMaskBuf, pabyMaskBuf + nDropPixels, nKeptPixels );
+            memmove( pafValueBuf, pafValueBuf + nDropPixels,
+                     nKeptPixels * sizeof(float) );
+            nBufYOff = iWantedStart;
+            nBufLines -= nDrop;
+        }
+
+        const int iReadStart = nBufYOff + nBufLines;
+        const int nReadLines = iWantedEnd - iReadStart;
+        if( nReadLines > 0 )
+        {
+            const size_t nOffset = static_cast<size_t>(nBufLines) * nXSize;
+            eErr = GDALRasterIO( hMaskBand, GF_Read,
+                                 0, iReadStart, nXSize, nReadLines,
+                                 pabyMaskBuf + nOffset, nXSize, nReadLines,
+                                 GDT_Byte, 0, 0 );
+            if( eErr != CE_None )
+                break;
+
+            eErr = GDALRasterIO( hTargetBand, GF_Read,
+                                 0, iReadStart, nXSize, nReadLines,
+                                 pafValueBuf + nOffset, nXSize, nReadLines,
+                                 GDT_Float32, 0, 0 );
+            if( eErr != CE_None )
+                break;
+
+            nBufLines += nReadLines;
+        }
+
+        for( int iTile = 0; iTile < nTiles; iTile++ )
+        {
+            asJobs[iTile].nBufYOff = nBufYOff;
+            asJobs[iTile].nBufLines = nBufLines;
+            asJobs[iTile].nStripYOff = iStrip;
+            asJobs[iTile].nStripLines = nStripLines;
+        }
+
+        if( poThreadPool != nullptr )
+        {
+            poThreadPool->SubmitJobs(GDALFillTileJobFunc, apJobs);
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            for( int iTile = 0; iTile < nTiles; iTile++ )
+                GDALFillTileJobFunc(apJobs[iTile]);
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Write out the updated data and mask information.                */
+/* -------------------------------------------------------------------- */
+        eErr =
+            GDALRasterIO( hTargetBand, GF_Write, 0, iStrip,
+                          nXSize, nStripLines, pafOut, nXSize, nStripLines,
+                          GDT_Float32, 0, 0 );
+        if( eErr != CE_None )
+            break;
+
+        if( hFiltMaskBand != nullptr )
+        {
+            eErr =
+                GDALRasterIO( hFiltMaskBand, GF_Write, 0, iStrip,
+                              nXSize, nStripLines, pabyFiltMaskOut,
+                              nXSize, nStripLines, GDT_Byte, 0, 0 );
+            if( eErr != CE_None )
+                break;
+        }
+
+        if( !pfnProgress(
+                dfProgressRatio * (iStrip + nStripLines) /
+                    static_cast<double>(nYSize),
+                "Filling...", pProgressArg) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    delete poThreadPool;
+    CPLFree( pabyMaskBuf );
+    CPLFree( pafValueBuf );
+    CPLFree( pafOut );
+    CPLFree( pabyFiltMaskOut );
+
+    return eErr;
+}
+
+/************************************************************************/
+/*                           GDALFillNodata()                           */
+/************************************************************************/
+
+/**
+ * Fill selected raster regions by interpolation from the edges.
+ *
+ * This algorithm will interpolate values for all designated
+ * nodata pixels (marked by zeros in hMaskBand).  For each pixel
+ * a four direction conic search is done to find values to interpolate
+ * from (using inverse distance weighting).  Once all values are
+ * interpolated, zero or more smoothing iterations (3x3 average
+ * filters on interpolated pixels) are applied to smooth out
+ * artifacts.
+ *
+ * This algorithm is generally suitable for interpolating missing
+ * regions of fairly continuously varying rasters (such as elevation
+ * models for instance).  It is also suitable for filling small holes
+ * and cracks in more irregularly varying images (like airphotos).  It
+ * is generally not so great for interpolating a raster from sparse
+ * point data - see the algorithms defined in gdal_grid.h for that case.
+ *
+ * When the lines within dfMaxSearchDist of a strip of lines fit in
+ * memory, the raster is processed strip by strip, each strip being split
+ * in tiles of columns interpolated in parallel, and the memory used is
+ * proportional to the search distance rather than to the raster height.
+ * Otherwise temporary work files of the size of the raster are used.
+ *
+ * @param hTargetBand the raster band to be modified in place.
+ * @param hMaskBand a mask band indicating pixels to be interpolated
+ * (zero valued).
+ * @param dfMaxSearchDist the maximum number of pixels to search in all
+ * directions to find values to interpolate from.
+ * @param bDeprecatedOption unused argument, should be zero.
+ * @param nSmoothingIterations the number of 3x3 smoothing filter passes to
+ * run (0 or more).
+ * @param papszOptions additional name=value options in a string list (the
+ * temporary file driver can be specified like TEMP_FILE_DRIVER=MEM, and the
+ * number of worker threads, or ALL_CPUS, like NUM_THREADS=4. NUM_THREADS
+ * defaults to the value of the GDAL_NUM_THREADS configuration option, or 1).
+ * @param pfnProgress the progress function to report completion.
+ * @param pProgressArg callback data for progress function.
+ *
+ * @return CE_None on success or CE_Failure if something goes wrong.
+ */
+
+CPLErr CPL_STDCALL
+GDALFillNodata( GDALRasterBandH hTargetBand,
+                GDALRasterBandH hMaskBand,
+                double dfMaxSearchDist,
+                CPL_UNUSED int bDeprecatedOption,
+                int nSmoothingIterations,
+                char **papszOptions,
+                GDALProgressFunc pfnProgress,
+                void * pProgressArg )
+
+{
+    VALIDATE_POINTER1( hTargetBand, "GDALFillNodata", CE_Failure );
+
+    const int nXSize = GDALGetRasterBandXSize(hTargetBand);
+    const int nYSize = GDALGetRasterBandYSize(hTargetBand);
+
+    if( dfMaxSearchDist == 0.0 )
+        dfMaxSearchDist = std::max(nXSize, nYSize) + 1;
+
+    // Special "x" pixel values identifying pixels as special.
+    GDALDataType eType = GDT_UInt16;
+    GUInt32 nNoDataVal = 65535;
+
+    if( nXSize > 65533 || nYSize > 65533 )
+    {
+        eType = GDT_UInt32;
+        nNoDataVal = 4000002;
+    }
+
+    if( hMaskBand == nullptr )
+        hMaskBand = GDALGetMaskBand( hTargetBand );
+
+    // If there are smoothing iterations, reserve 10% of the progress for them.
+    const double dfProgressRatio = nSmoothingIterations > 0 ? 0.9 : 1.0;
+
+/* -------------------------------------------------------------------- */
+/*      Initialize progress counter.                                    */
+/* -------------------------------------------------------------------- */
+    if( pfnProgress == nullptr )
+        pfnProgress = GDALDummyProgress;
+
+    if( !pfnProgress( 0.0, "Filling...", pProgressArg ) )
+    {
+        CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+        return CE_Failure;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Can we process the raster in strips?  Pixels only depend on     */
+/*      the pixels within the search distance (plus one line below,     */
+/*      as the search below a line starts from the next one), so each   */
+/*      strip of about one million pixels needs that many lines above   */
+/*      and below it.                                                   */
+/* -------------------------------------------------------------------- */
+    const int nThreads =
+        CPLGetNumThreads(CSLFetchNameValue(papszOptions, "NUM_THREADS"));
+
+    const int nHalo = static_cast<int>(
+        std::min(floor(dfMaxSearchDist) + 1.0, static_cast<double>(nYSize)));
+    const int nStripHeight = GDALGetStripHeight(nXSize, nYSize, 64);
+    const GIntBig nBufPixels =
+        std::min(static_cast<GIntBig>(nYSize),
+                 static_cast<GIntBig>(nStripHeight) + 2 * nHalo) * nXSize;
+    const bool bStrips = nBufPixels <= FILL_MAX_STRIP_BUFFER_PIXELS;
+
+    CPLDebug( "GDAL", "GDALFillNodata(): %s, %d thread(s)",
+              bStrips ? "strip based" : "work file based", nThreads );
+
+/* -------------------------------------------------------------------- */
+/*      Determine format driver for temp work files.                    */
+/* -------------------------------------------------------------------- */
+    CPLString osTmpFileDriver = CSLFetchNameValueDef(
+            papszOptions, "TEMP_FILE_DRIVER", "GTiff");
+    GDALDriverH hDriver = GDALGetDriverByName(osTmpFileDriver.c_str());
+
+    if( hDriver == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Given driver is not registered");
+        return CE_Failure;
+    }
+
+    if( GDALGetMetadataItem(hDriver, GDAL_DCAP_CREATE, nullptr) == nullptr )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Given driver is incapable of creating temp work files");
+        return CE_Failure;
+    }
+
+    char **papszWorkFileOptions = nullptr;
+    if( osTmpFileDriver == "GTiff" )
+    {
+        papszWorkFileOptions = CSLSetNameValue(
+                papszWorkFileOptions, "COMPRESS", "LZW");
+        papszWorkFileOptions = CSLSetNameValue(
+                papszWorkFileOptions, "BIGTIFF", "IF_SAFER");
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Create a mask file to make it clear what pixels can be filtered */
+/*      on the filtering pass.                                          */
+/* -------------------------------------------------------------------- */
+    const CPLString osTmpFile = CPLGenerateTempFilename("");
+    const CPLString osFiltMaskTmpFile = osTmpFile + "fill_filtmask_work.tif";
+
+    GDALDatasetH hFiltMaskDS = nullptr;
+    GDALRasterBandH hFiltMaskBand = nullptr;
+    if( !bStrips || nSmoothingIterations > 0 )
+    {
+        hFiltMaskDS =
+            GDALCreate( hDriver, osFiltMaskTmpFile, nXSize, nYSize, 1,
+                        GDT_Byte, papszWorkFileOptions );
+
+        if( hFiltMaskDS == nullptr )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                "Could not create mask work file. Check driver capabilities.");
+            CSLDestroy(papszWorkFileOptions);
+            return CE_Failure;
+        }
+
+        hFiltMaskBand = GDALGetRasterBand( hFiltMaskDS, 1 );
+    }
+
+/* ==================================================================== */
+/*      Interpolate the nodata pixels.                                  */
+/* ==================================================================== */
+    CPLErr eErr = CE_None;
+    if( bStrips )
+    {
+        eErr = GDALFillNodataStrips( hTargetBand, hMaskBand, hFiltMaskBand,
+                                     dfMaxSearchDist, nNoDataVal,
+                                     nHalo, nStripHeight, nThreads,
+                                     dfProgressRatio,
+                                     pfnProgress, pProgressArg );
+    }
+    else
+    {
+        eErr = GDALFillNodataWorkFiles( hTargetBand, hMaskBand, hFiltMaskBand,
+                                        dfMaxSearchDist, eType, nNoDataVal,
+                                        hDriver, papszWorkFileOptions,
+                                        osTmpFile, dfProgressRatio,
+                                        pfnProgress, pProgressArg );
+    }
+
 /* ==================================================================== */
 /*      Now we will do iterative average filters over the               */
 /*      interpolated values to smooth things out and make linear        */
@@ -855,28 +1289,15 @@ GDALFillNodata( GDALRasterBandH hTargetBand,
     }
 
 /* -------------------------------------------------------------------- */
-/*      Close and clean up temporary files. Free working buffers        */
+/*      Close and clean up temporary files.                             */
 /* -------------------------------------------------------------------- */
-end:
-    CPLFree(panLastY);
-    CPLFree(panThisY);
-    CPLFree(panTopDownY);
-    CPLFree(pafLastValue);
-    CPLFree(pafThisValue);
-    CPLFree(pafTopDownValue);
-    CPLFree(pafScanline);
-    CPLFree(pabyMask);
-    CPLFree(pabyFiltMask);
-
-    GDALClose( hYDS );
-    GDALClose( hValDS );
-    GDALClose( hFiltMaskDS );
-
     CSLDestroy(papszWorkFileOptions);
 
-    GDALDeleteDataset( hDriver, osYTmpFile );
-    GDALDeleteDataset( hDriver, osValTmpFile );
-    GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+    if( hFiltMaskDS != nullptr )
+    {
+        GDALClose( hFiltMaskDS );
+        GDALDeleteDataset( hDriver, osFiltMaskTmpFile );
+    }
 
     return eErr;
 }
@@ -0,0 +1,303 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Benchmark of the raster block cache under concurrent access.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_atomic_ops.h"
+#include "cpl_conv.h"
+#include "cpl_multiproc.h"
+#include "cpl_string.h"
+
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+static int nIterations = 100000;
+static int nBlockSize = 64;
+static int nRasterSize = 1024;
+static const char *pszFilename = nullptr;
+static volatile int nReadyThreads = 0;
+static volatile bool bGo = false;
+static volatile int nErrors = 0;
+static volatile int nThreadCounter = 0;
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+{
+    printf("blockcachebench [-t <thread#>] [-i <iterations>] [-ds <dataset#>]\n"
+           "                [-size <raster_size>] [-bs <block_size>]\n"
+           "                [-shards <shard#>|ALL_CPUS] [-cachemax <MB>]\n"
+           "                [-policy LRU|2Q]\n"
+           "                [filename]\n"
+           "\n"
+           "Each thread reads <iterations> randomly chosen blocks from its\n"
+           "own dataset handle. Without filename, <dataset#> synthetic\n"
+           "tiled GeoTIFF files are created in /vsimem/ and shared among\n"
+           "threads.\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                             WorkerFunc()                             */
+/************************************************************************/
+
+static void WorkerFunc( void *arg )
+{
+    const char* pszDSName = static_cast<const char*>(arg);
+    GDALDatasetH hDS = GDALOpen(pszDSName, GA_ReadOnly);
+    if( hDS == nullptr )
+    {
+        CPLAtomicInc(&nErrors);
+        CPLAtomicInc(&nReadyThreads);
+        return;
+    }
+    GDALRasterBandH hBand = GDALGetRasterBand(hDS, 1);
+    int nBlockXSize = 0;
+    int nBlockYSize = 0;
+    GDALGetBlockSize(hBand, &nBlockXSize, &nBlockYSize);
+    const int nXSize = GDALGetRasterXSize(hDS);
+    const int nYSize = GDALGetRasterYSize(hDS);
+    const int nBlocksX = (nXSize + nBlockXSize - 1) / nBlockXSize;
+    const int nBlocksY = (nYSize + nBlockYSize - 1) / nBlockYSize;
+    std::vector<GByte> abyBuffer(
+        static_cast<size_t>(nBlockXSize) * nBlockYSize);
+
+    // Simple per-thread LCG, as rand() is not required to be thread-safe.
+    GUInt32 nSeed =
+        static_cast<GUInt32>(CPLAtomicInc(&nThreadCounter)) * 2654435761U;
+
+    CPLAtomicInc(&nReadyThreads);
+    while( !bGo )
+        CPLSleep(0.001);
+
+    for( int iIter = 0; iIter < nIterations; iIter++ )
+    {
+        nSeed = nSeed * 1103515245U + 12345U;
+        const int nBlockX = static_cast<int>((nSeed >> 8) % nBlocksX);
+        nSeed = nSeed * 1103515245U + 12345U;
+        const int nBlockY = static_cast<int>((nSeed >> 8) % nBlocksY);
+        const int nXOff = nBlockX * nBlockXSize;
+        const int nYOff = nBlockY * nBlockYSize;
+        const int nReqXSize = std::min(nBlockXSize, nXSize - nXOff);
+        const int nReqYSize = std::min(nBlockYSize, nYSize - nYOff);
+        if( GDALRasterIO(hBand, GF_Read, nXOff, nYOff, nReqXSize, nReqYSize,
+                         &abyBuffer[0], nReqXSize, nReqYSize, GDT_Byte,
+                         0, 0) != CE_None )
+        {
+            CPLAtomicInc(&nErrors);
+            break;
+        }
+    }
+
+    GDALClose(hDS);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char ** argv )
+
+{
+/* -------------------------------------------------------------------- */
+/*      Process arguments.                                              */
+/* -------------------------------------------------------------------- */
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    int nThreadCount = 4;
+    int nDatasetCount = -1;
+
+    for( int iArg = 1; iArg < argc; iArg++ )
+    {
+        if( iArg < argc-1 && EQUAL(argv[iArg], "-i") )
+        {
+            nIterations = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-t") )
+        {
+            nThreadCount = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-ds") )
+        {
+            nDatasetCount = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-size") )
+        {
+            nRasterSize = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-bs") )
+        {
+            nBlockSize = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-shards") )
+        {
+            CPLSetConfigOption("GDAL_BLOCK_CACHE_SHARDS", argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-cachemax") )
+        {
+            CPLSetConfigOption("GDAL_CACHEMAX", argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-policy") )
+        {
+            CPLSetConfigOption("GDAL_BLOCK_CACHE_POLICY", argv[++iArg]);
+        }
+        else if( argv[iArg][0] == '-' )
+        {
+            Usage();
+        }
+        else if( pszFilename == nullptr )
+        {
+            pszFilename = argv[iArg];
+        }
+        else
+        {
+            printf("Unrecognized argument: %s\n", argv[iArg]);
+            Usage();
+        }
+    }
+
+    if( nThreadCount <= 0 || nIterations <= 0 || nRasterSize <= 0 ||
+        nBlockSize <= 0 || nBlockSize % 16 != 0 )
+    {
+        printf("Invalid arguments. Block size must be a multiple of 16.\n");
+        Usage();
+    }
+    if( nDatasetCount <= 0 )
+        nDatasetCount = nThreadCount;
+
+    GDALAllRegister();
+
+/* -------------------------------------------------------------------- */
+/*      Create the synthetic datasets if needed.                        */
+/* -------------------------------------------------------------------- */
+    std::vector<CPLString> aosDSNames;
+    if( pszFilename != nullptr )
+    {
+        aosDSNames.push_back(pszFilename);
+    }
+    else
+    {
+        GDALDriverH hDriver = GDALGetDriverByName("GTiff");
+        if( hDriver == nullptr )
+        {
+            printf("GTiff driver not available.\n");
+            exit(1);
+        }
+        char** papszOptions = nullptr;
+        papszOptions = CSLSetNameValue(papszOptions, "TILED", "YES");
+        papszOptions = CSLSetNameValue(papszOptions, "BLOCKXSIZE",
+                                       CPLSPrintf("%d", nBlockSize));
+        papszOptions = CSLSetNameValue(papszOptions, "BLOCKYSIZE",
+                                       CPLSPrintf("%d", nBlockSize));
+        for( int i = 0; i < nDatasetCount; i++ )
+        {
+            CPLString osName(CPLSPrintf("/vsimem/blockcachebench_%d.tif", i));
+            GDALDatasetH hDS = GDALCreate(hDriver, osName,
+                                          nRasterSize, nRasterSize, 1,
+                                          GDT_Byte, papszOptions);
+            if( hDS == nullptr )
+                exit(1);
+            CPL_IGNORE_RET_VAL(
+                GDALFillRaster(GDALGetRasterBand(hDS, 1), i % 256, 0));
+            GDALClose(hDS);
+            aosDSNames.push_back(osName);
+        }
+        CSLDestroy(papszOptions);
+    }
+
+    printf("Launching %d worker threads on %d dataset(s), "
+           "%d iterations, GDAL_BLOCK_CACHE_SHARDS=%s, "
+           "GDAL_BLOCK_CACHE_POLICY=%s, GDAL_CACHEMAX=" CPL_FRMT_GIB " MB.\n",
+           nThreadCount, static_cast<int>(aosDSNames.size()), nIterations,
+           CPLGetConfigOption("GDAL_BLOCK_CACHE_SHARDS", "1"),
+           CPLGetConfigOption("GDAL_BLOCK_CACHE_POLICY", "LRU"),
+           GDALGetCacheMax64() / (1024 * 1024));
+
+/* -------------------------------------------------------------------- */
+/*      Fire off worker threads, and wait for them to have opened       */
+/*      their dataset before starting the clock.                        */
+/* -------------------------------------------------------------------- */
+    std::vector<CPLJoinableThread*> ahThreads;
+    for( int iThread = 0; iThread < nThreadCount; iThread++ )
+    {
+        CPLJoinableThread* hThread = CPLCreateJoinableThread(
+            WorkerFunc,
+            const_cast<char*>(aosDSNames[iThread % aosDSNames.size()].c_str()));
+        if( hThread == nullptr )
+        {
+            printf("CPLCreateJoinableThread() failed.\n");
+            exit(1);
+        }
+        ahThreads.push_back(hThread);
+    }
+
+    while( nReadyThreads < nThreadCount )
+        CPLSleep(0.001);
+
+    GDALResetCacheStatistics();
+    const auto start = std::chrono::steady_clock::now();
+    bGo = true;
+    for( size_t i = 0; i < ahThreads.size(); ++i )
+        CPLJoinThread(ahThreads[i]);
+    const double dfElapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    const double dfTotalReads =
+        static_cast<double>(nIterations) * nThreadCount;
+    printf("Elapsed: %.3f s, %.0f block reads/s, cache used: " CPL_FRMT_GIB
+           " bytes.\n",
+           dfElapsed, dfElapsed > 0 ? dfTotalReads / dfElapsed : 0.0,
+           GDALGetCacheUsed64());
+    GIntBig nHits = 0;
+    GIntBig nMisses = 0;
+    GDALGetCacheStatistics(&nHits, &nMisses);
+    printf("Cache hits: " CPL_FRMT_GIB ", misses: " CPL_FRMT_GIB
+           " (hit ratio %.1f %%).\n",
+           nHits, nMisses,
+           nHits + nMisses > 0 ?
+                100.0 * nHits / static_cast<double>(nHits + nMisses) : 0.0);
+    if( nErrors )
+        printf("%d error(s) occurred.\n", nErrors);
+
+    if( pszFilename == nullptr )
+    {
+        for( size_t i = 0; i < aosDSNames.size(); ++i )
+            VSIUnlink(aosDSNames[i]);
+    }
+
+    CSLDestroy(argv);
+
+    GDALDestroyDriverManager();
+
+    return nErrors ? 1 : 0;
+}
@@ -0,0 +1,176 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Utilities
+ * Purpose:  Benchmark of GDALCopyWords() data type conversions.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "gdal.h"
+#include "cpl_conv.h"
+#include "cpl_string.h"
+
+#include <chrono>
+#include <vector>
+
+CPL_CVSID("$Id$")
+
+/************************************************************************/
+/*                               Usage()                                */
+/************************************************************************/
+
+static void Usage()
+{
+    printf("copywordsbench [-src <type>] [-dst <type>] [-n <word#>]\n"
+           "               [-i <iterations>] [-srcstride <word#>]\n"
+           "               [-dststride <word#>]\n"
+           "\n"
+           "Times GDALCopyWords() conversions from the -src type to the -dst\n"
+           "type, or between all the non-complex types if they are not\n"
+           "specified. Strides are expressed in words, e.g. -dststride 3 to\n"
+           "write one band of a pixel interleaved RGB buffer.\n"
+           "Use --config GDAL_USE_AVX2 NO to compare with the non-AVX2 code.\n");
+    exit(1);
+}
+
+/************************************************************************/
+/*                             Benchmark()                              */
+/************************************************************************/
+
+static void Benchmark( GDALDataType eSrcType, GDALDataType eDstType,
+                       int nWords, int nIterations,
+                       int nSrcStride, int nDstStride )
+{
+    const int nSrcSize = GDALGetDataTypeSizeBytes(eSrcType);
+    const int nDstSize = GDALGetDataTypeSizeBytes(eDstType);
+    std::vector<GByte> abySrc(
+        static_cast<size_t>(nWords) * nSrcStride * nSrcSize);
+    std::vector<GByte> abyDst(
+        static_cast<size_t>(nWords) * nDstStride * nDstSize);
+
+    // Values spanning and exceeding the range of the small types.
+    for( int i = 0; i < nWords; i++ )
+    {
+        const double dfValue = ((i * 37) % 70000) - 1000 + 0.25 * (i % 4);
+        GDALCopyWords(&dfValue, GDT_Float64, 0,
+                      &abySrc[static_cast<size_t>(i) * nSrcStride * nSrcSize],
+                      eSrcType, 0, 1);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for( int iIter = 0; iIter < nIterations; iIter++ )
+    {
+        GDALCopyWords(&abySrc[0], eSrcType, nSrcStride * nSrcSize,
+                      &abyDst[0], eDstType, nDstStride * nDstSize,
+                      nWords);
+    }
+    const double dfElapsed = std::chrono::duration<double>(
+        std::chrono::steady_clock::now() - start).count();
+
+    printf("%-8s -> %-8s: %8.3f s, %8.1f Mwords/s\n",
+           GDALGetDataTypeName(eSrcType), GDALGetDataTypeName(eDstType),
+           dfElapsed,
+           dfElapsed > 0 ?
+                static_cast<double>(nWords) * nIterations / dfElapsed / 1e6 :
+                0.0);
+}
+
+/************************************************************************/
+/*                                main()                                */
+/************************************************************************/
+
+int main( int argc, char ** argv )
+
+{
+    argc = GDALGeneralCmdLineProcessor(argc, &argv, 0);
+    if( argc < 1 )
+        exit(-argc);
+
+    GDALDataType eSrcType = GDT_Unknown;
+    GDALDataType eDstType = GDT_Unknown;
+    int nWords = 4096;
+    int nIterations = 10000;
+    int nSrcStride = 1;
+    int nDstStride = 1;
+
+    for( int iArg = 1; iArg < argc; iArg++ )
+    {
+        if( iArg < argc-1 && EQUAL(argv[iArg], "-src") )
+        {
+            eSrcType = GDALGetDataTypeByName(argv[++iArg]);
+            if( eSrcType == GDT_Unknown )
+                Usage();
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-dst") )
+        {
+            eDstType = GDALGetDataTypeByName(argv[++iArg]);
+            if( eDstType == GDT_Unknown )
+                Usage();
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-n") )
+        {
+            nWords = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-i") )
+        {
+            nIterations = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-srcstride") )
+        {
+            nSrcStride = atoi(argv[++iArg]);
+        }
+        else if( iArg < argc-1 && EQUAL(argv[iArg], "-dststride") )
+        {
+            nDstStride = atoi(argv[++iArg]);
+        }
+        else
+        {
+            Usage();
+        }
+    }
+
+    if( nWords <= 0 || nIterations <= 0 || nSrcStride <= 0 || nDstStride <= 0 )
+        Usage();
+
+    printf("%d words, %d iterations, source stride %d, "
+           "destination stride %d, GDAL_USE_AVX2=%s.\n",
+           nWords, nIterations, nSrcStride, nDstStride,
+           CPLGetConfigOption("GDAL_USE_AVX2", "YES"));
+
+    for( int iSrc = GDT_Byte; iSrc <= GDT_Float64; iSrc++ )
+    {
+        const GDALDataType eSrc = static_cast<GDALDataType>(iSrc);
+        if( eSrcType != GDT_Unknown && eSrc != eSrcType )
+            continue;
+        for( int iDst = GDT_Byte; iDst <= GDT_Float64; iDst++ )
+        {
+            const GDALDataType eDst = static_cast<GDALDataType>(iDst);
+            if( eDstType != GDT_Unknown && eDst != eDstType )
+                continue;
+            Benchmark(eSrc, eDst, nWords, nIterations, nSrcStride, nDstStride);
+        }
+    }
+
+    CSLDestroy(argv);
+
+    return 0;
+}
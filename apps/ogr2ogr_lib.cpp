@@ -39,6 +39,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <deque>
 #include <map>
 #include <set>
 #include <string>
@@ -48,6 +49,7 @@
 #include "commonutils.h"
 #include "cpl_conv.h"
 #include "cpl_error.h"
+#include "cpl_multiproc.h"
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
@@ -110,6 +112,10 @@ struct GDALVectorTranslateOptions
         be set to -1 to load the data into a single transaction */
     int nGroupTransactions;
 
+    /*! read, translate and write the features of each layer in separate threads
+        (GDAL >= 2.4) */
+    bool bPipeline;
+
     /*! If provided, only the feature with this feature id will be reported. Operates exclusive of
         the spatial or attribute queries. Note: if you want to select several features based on their
         feature id, you can also use the fact the 'fid' is a special field recognized by OGR SQL.
@@ -365,6 +371,29 @@ typedef struct
     TargetLayerInfo  *psInfo;
 } AssociatedLayers;
 
+/* State of the coordinate transformation of a target geometry field */
+/* when it has been done ahead, on a whole batch of features. */
+enum TransformState
+{
+    TS_PENDING,
+    TS_DONE,
+    TS_FAILED
+};
+
+/* Target feature (or one part of the source feature with */
+/* -explodecollections) translated but not written yet. */
+struct TranslatedPart
+{
+    OGRFeature         *poDstFeature = nullptr; /* nullptr if skipped */
+    bool                bSetFromFailed = false;
+    int                 nReprojectFailures = 0;
+    std::vector<int>    anTransformState{}; /* empty, or TransformState per target geometry field */
+};
+
+struct PipelineContext;
+struct PipelineBatch;
+struct CapturedError;
+
 class SetupTargetLayer
 {
 public:
@@ -434,6 +463,47 @@ public:
                                   GDALProgressFunc pfnProgress,
                                   void *pProgressArg,
                                   GDALVectorTranslateOptions *psOptions);
+
+    int                 CountParts(TargetLayerInfo* psInfo,
+                                   OGRFeature* poFeature,
+                                   int nDstGeomFieldCount,
+                                   int& nParts);
+    void                PreparePart(TargetLayerInfo* psInfo,
+                                    OGRFeatureDefn* poDstFDefn,
+                                    OGRFeature* poFeature,
+                                    int nParts, int iPart,
+                                    TranslatedPart& sPart);
+    void                FinishPart(TargetLayerInfo* psInfo,
+                                   OGRSpatialReference* poOutputSRS,
+                                   bool bSkipFailures,
+                                   TranslatedPart& sPart);
+    bool                SwitchTransactionIfNeeded(
+                                   TargetLayerInfo* psInfo,
+                                   int& nFeaturesInTransaction,
+                                   GIntBig& nTotalEventsDone,
+                                   GDALVectorTranslateOptions *psOptions);
+    bool                WritePart(TargetLayerInfo* psInfo,
+                                  OGRFeature* poFeature,
+                                  TranslatedPart& sPart,
+                                  GIntBig& nFeaturesWritten,
+                                  GDALVectorTranslateOptions *psOptions);
+
+    bool                TranslatePipelined(TargetLayerInfo* psInfo,
+                                           OGRFeatureDefn* poDstFDefn,
+                                           OGRSpatialReference* poOutputSRS,
+                                           GIntBig nCountLayerFeatures,
+                                           GIntBig* pnReadFeatureCount,
+                                           GIntBig& nCount,
+                                           int& nFeaturesInTransaction,
+                                           GIntBig& nFeaturesWritten,
+                                           GIntBig& nTotalEventsDone,
+                                           GDALProgressFunc pfnProgress,
+                                           void *pProgressArg,
+                                           GDALVectorTranslateOptions *psOptions,
+                                           bool& bRet);
+    void                TranslateBatch(PipelineContext* psCtxt,
+                                       PipelineBatch* poBatch,
+                                       std::vector<CapturedError>*& paoErrors);
 };
 
 static OGRLayer* GetLayerAndOverwriteIfNecessary(GDALDataset *poDstDS,
@@ -4333,17 +4403,13 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
                                 void *pProgressArg,
                                 GDALVectorTranslateOptions *psOptions )
 {
-    const int eGType = m_eGType;
     OGRSpatialReference* poOutputSRS = m_poOutputSRS;
 
     OGRLayer *poSrcLayer = psInfo->poSrcLayer;
     OGRLayer *poDstLayer = psInfo->poDstLayer;
-    int* const panMap = psInfo->panMap;
-    const int iSrcZField = psInfo->iSrcZField;
-    const bool bPreserveFID = psInfo->bPreserveFID;
+    OGRFeatureDefn *poDstFDefn = poDstLayer->GetLayerDefn();
     const int nSrcGeomFieldCount = poSrcLayer->GetLayerDefn()->GetGeomFieldCount();
-    const int nDstGeomFieldCount = poDstLayer->GetLayerDefn()->GetGeomFieldCount();
-    const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
+    const int nDstGeomFieldCount = poDstFDefn->GetGeomFieldCount();
 
     if( poOutputSRS == nullptr && !m_bNullifyOutputSRS )
     {
@@ -4370,6 +4436,18 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      With -pipeline, read, translate and write the features of the  */
+/*      layer in separate threads, once the first one has been         */
+/*      processed (and the coordinate transformation set up).          */
+/*      This is not possible when reading and writing the same         */
+/*      dataset, or when fetching a single feature.                    */
+/* -------------------------------------------------------------------- */
+    const bool bPipeline = poFeatureIn == nullptr &&
+                           psOptions->nFIDToFetch == OGRNullFID &&
+                           m_poSrcDS != m_poODS &&
+                           psOptions->bPipeline;
+
     OGRFeature *poFeature = nullptr;
     int         nFeaturesInTransaction = 0;
     GIntBig      nCount = 0; /* written + failed */
@@ -4414,364 +4492,1002 @@ int LayerTranslator::Translate( OGRFeature* poFeatureIn,
         psInfo->nFeaturesRead ++;
 
         int nParts = 0;
-        int nIters = 1;
-        if (bExplodeCollections)
-        {
-            OGRGeometry* poSrcGeometry;
-            if( psInfo->iRequestedSrcGeomField >= 0 )
-                poSrcGeometry = poFeature->GetGeomFieldRef(
-                                        psInfo->iRequestedSrcGeomField);
-            else
-                poSrcGeometry = poFeature->GetGeometryRef();
-            if (poSrcGeometry &&
-                OGR_GT_IsSubClassOf(poSrcGeometry->getGeometryType(), wkbGeometryCollection) )
-            {
-                nParts = poSrcGeometry->toGeometryCollection()->getNumGeometries();
-                nIters = nParts;
-                if (nIters == 0)
-                    nIters = 1;
-            }
-        }
+        const int nIters =
+            CountParts(psInfo, poFeature, nDstGeomFieldCount, nParts);
 
-        OGRFeature *poDstFeature = nullptr;
         for(int iPart = 0; iPart < nIters; iPart++)
         {
-            if( psOptions->nLayerTransaction &&
-                ++nFeaturesInTransaction == psOptions->nGroupTransactions )
+            if( !SwitchTransactionIfNeeded( psInfo, nFeaturesInTransaction,
+                                            nTotalEventsDone, psOptions ) )
             {
-                if( poDstLayer->CommitTransaction() == OGRERR_FAILURE ||
-                    poDstLayer->StartTransaction() == OGRERR_FAILURE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nFeaturesInTransaction = 0;
-            }
-            else if( !psOptions->nLayerTransaction &&
-                     psOptions->nGroupTransactions >= 0 &&
-                     ++nTotalEventsDone >= psOptions->nGroupTransactions )
-            {
-                if( m_poODS->CommitTransaction() == OGRERR_FAILURE ||
-                        m_poODS->StartTransaction(psOptions->bForceTransaction) == OGRERR_FAILURE )
-                {
-                    OGRFeature::DestroyFeature( poFeature );
-                    return false;
-                }
-                nTotalEventsDone = 0;
+                OGRFeature::DestroyFeature( poFeature );
+                return false;
             }
 
             CPLErrorReset();
-            poDstFeature = OGRFeature::CreateFeature( poDstLayer->GetLayerDefn() );
-
-            /* Optimization to avoid duplicating the source geometry in the */
-            /* target feature : we steal it from the source feature for now... */
-            OGRGeometry* poStolenGeometry = nullptr;
-            if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
-                nDstGeomFieldCount == 1 )
-            {
-                poStolenGeometry = poFeature->StealGeometry();
-            }
-            else if( !bExplodeCollections &&
-                     psInfo->iRequestedSrcGeomField >= 0 )
+            TranslatedPart sPart;
+            PreparePart( psInfo, poDstFDefn, poFeature, nParts, iPart, sPart );
+            FinishPart( psInfo, poOutputSRS, psOptions->bSkipFailures, sPart );
+            if( !WritePart( psInfo, poFeature, sPart, nFeaturesWritten,
+                            psOptions ) )
             {
-                poStolenGeometry = poFeature->StealGeometry(
-                    psInfo->iRequestedSrcGeomField);
+                OGRFeature::DestroyFeature( poFeature );
+                return false;
             }
+        }
 
-            if( poDstFeature->SetFrom( poFeature, panMap, TRUE ) != OGRERR_NONE )
-            {
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                    {
-                        if( poDstLayer->CommitTransaction() != OGRERR_NONE )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            OGRGeometryFactory::destroyGeometry( poStolenGeometry );
-                            return false;
-                        }
-                    }
-                }
+        OGRFeature::DestroyFeature( poFeature );
 
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
+        /* Report progress */
+        nCount ++;
+        bool bGoOn = true;
+        if (pfnProgress)
+        {
+            bGoOn = pfnProgress(nCountLayerFeatures ? nCount * 1.0 / nCountLayerFeatures: 1.0, "", pProgressArg) != FALSE;
+        }
+        if( !bGoOn )
+        {
+            bRet = false;
+            break;
+        }
 
-                OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
-                OGRGeometryFactory::destroyGeometry( poStolenGeometry );
-                return false;
-            }
+        if (pnReadFeatureCount)
+            *pnReadFeatureCount = nCount;
+
+        if( psOptions->nFIDToFetch != OGRNullFID )
+            break;
+        if( poFeatureIn != nullptr )
+            break;
 
-            /* ... and now we can attach the stolen geometry */
-            if( poStolenGeometry )
+        /* The coordinate transformation must be the same for all features */
+        /* of a batch. */
+        if( bPipeline && !psInfo->bPerFeatureCT )
+        {
+            if( !TranslatePipelined( psInfo, poDstFDefn, poOutputSRS,
+                                     nCountLayerFeatures, pnReadFeatureCount,
+                                     nCount, nFeaturesInTransaction,
+                                     nFeaturesWritten, nTotalEventsDone,
+                                     pfnProgress, pProgressArg, psOptions,
+                                     bRet ) )
             {
-                poDstFeature->SetGeometryDirectly(poStolenGeometry);
+                return false;
             }
+            break;
+        }
+    }
 
-            if( bPreserveFID )
-                poDstFeature->SetFID( poFeature->GetFID() );
-            else if( psInfo->iSrcFIDField >= 0 &&
-                     poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
-                poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+    if( psOptions->nGroupTransactions )
+    {
+        if( psOptions->nLayerTransaction )
+        {
+            if( poDstLayer->CommitTransaction() != OGRERR_NONE )
+                bRet = false;
+        }
+    }
 
-            /* Erase native data if asked explicitly */
-            if( !m_bNativeData )
-            {
-                poDstFeature->SetNativeData(nullptr);
-                poDstFeature->SetNativeMediaType(nullptr);
-            }
+    if( poFeatureIn == nullptr )
+    {
+        CPLDebug("GDALVectorTranslate", CPL_FRMT_GIB " features written in layer '%s'",
+                nFeaturesWritten, poDstLayer->GetName());
+    }
 
-            for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
-            {
-                OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
-                if (poDstGeometry == nullptr)
-                    continue;
+    return bRet;
+}
 
-                if (nParts > 0)
-                {
-                    /* For -explodecollections, extract the iPart(th) of the geometry */
-                    OGRGeometry* poPart = poDstGeometry->toGeometryCollection()->getGeometryRef(iPart);
-                    poDstGeometry->toGeometryCollection()->removeGeometry(iPart, FALSE);
-                    delete poDstGeometry;
-                    poDstGeometry = poPart;
-                    assert(poDstGeometry);
-                }
+/************************************************************************/
+/*                    LayerTranslator::CountParts()                     */
+/************************************************************************/
 
-                if (iSrcZField != -1)
-                {
-                    SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
-                    /* This will correct the coordinate dimension to 3 */
-                    OGRGeometry* poDupGeometry = poDstGeometry->clone();
-                    delete poDstGeometry;
-                    poDstGeometry = poDupGeometry;
-                }
+/* Return the number of target features to create from poFeature, and */
+/* set nParts to the number of parts of its geometry collection with */
+/* -explodecollections (or 0) */
+int LayerTranslator::CountParts( TargetLayerInfo* psInfo,
+                                 OGRFeature* poFeature,
+                                 int nDstGeomFieldCount,
+                                 int& nParts )
+{
+    nParts = 0;
+    int nIters = 1;
+    if( m_bExplodeCollections && nDstGeomFieldCount <= 1 )
+    {
+        OGRGeometry* poSrcGeometry;
+        if( psInfo->iRequestedSrcGeomField >= 0 )
+            poSrcGeometry = poFeature->GetGeomFieldRef(
+                                    psInfo->iRequestedSrcGeomField);
+        else
+            poSrcGeometry = poFeature->GetGeometryRef();
+        if (poSrcGeometry &&
+            OGR_GT_IsSubClassOf(poSrcGeometry->getGeometryType(), wkbGeometryCollection) )
+        {
+            nParts = poSrcGeometry->toGeometryCollection()->getNumGeometries();
+            nIters = nParts;
+            if (nIters == 0)
+                nIters = 1;
+        }
+    }
+    return nIters;
+}
 
-                if (m_nCoordDim == 2 || m_nCoordDim == 3)
-                {
-                    poDstGeometry->setCoordinateDimension( m_nCoordDim );
-                }
-                else if (m_nCoordDim == 4)
-                {
-                    poDstGeometry->set3D( TRUE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if (m_nCoordDim == COORD_DIM_XYM)
-                {
-                    poDstGeometry->set3D( FALSE );
-                    poDstGeometry->setMeasured( TRUE );
-                }
-                else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
-                {
-                    const OGRwkbGeometryType eDstLayerGeomType =
-                      poDstLayer->GetLayerDefn()->GetGeomFieldDefn(iGeom)->GetType();
-                    poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
-                    poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
-                }
+/************************************************************************/
+/*                    LayerTranslator::PreparePart()                    */
+/************************************************************************/
 
-                if (m_eGeomOp == GEOMOP_SEGMENTIZE)
-                {
-                    if (m_dfGeomOpParam > 0)
-                        poDstGeometry->segmentize(m_dfGeomOpParam);
-                }
-                else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
-                {
-                    if (m_dfGeomOpParam > 0)
-                    {
-                        OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
-                        if (poNewGeom)
-                        {
-                            delete poDstGeometry;
-                            poDstGeometry = poNewGeom;
-                        }
-                    }
-                }
+/* Create the target feature for the iPart(th) part of poFeature, and */
+/* apply to its geometries all the operations that come before the */
+/* coordinate transformation. */
+void LayerTranslator::PreparePart( TargetLayerInfo* psInfo,
+                                   OGRFeatureDefn* poDstFDefn,
+                                   OGRFeature* poFeature,
+                                   int nParts, int iPart,
+                                   TranslatedPart& sPart )
+{
+    const int iSrcZField = psInfo->iSrcZField;
+    const int nSrcGeomFieldCount = poFeature->GetDefnRef()->GetGeomFieldCount();
+    const int nDstGeomFieldCount = poDstFDefn->GetGeomFieldCount();
+    const bool bExplodeCollections = m_bExplodeCollections && nDstGeomFieldCount <= 1;
+
+    OGRFeature* poDstFeature = OGRFeature::CreateFeature( poDstFDefn );
+
+    /* Optimization to avoid duplicating the source geometry in the */
+    /* target feature : we steal it from the source feature for now... */
+    OGRGeometry* poStolenGeometry = nullptr;
+    if( !bExplodeCollections && nSrcGeomFieldCount == 1 &&
+        nDstGeomFieldCount == 1 )
+    {
+        poStolenGeometry = poFeature->StealGeometry();
+    }
+    else if( !bExplodeCollections &&
+             psInfo->iRequestedSrcGeomField >= 0 )
+    {
+        poStolenGeometry = poFeature->StealGeometry(
+            psInfo->iRequestedSrcGeomField);
+    }
+
+    if( poDstFeature->SetFrom( poFeature, psInfo->panMap, TRUE ) != OGRERR_NONE )
+    {
+        OGRFeature::DestroyFeature( poDstFeature );
+        OGRGeometryFactory::destroyGeometry( poStolenGeometry );
+        sPart.bSetFromFailed = true;
+        return;
+    }
+
+    /* ... and now we can attach the stolen geometry */
+    if( poStolenGeometry )
+    {
+        poDstFeature->SetGeometryDirectly(poStolenGeometry);
+    }
+
+    if( psInfo->bPreserveFID )
+        poDstFeature->SetFID( poFeature->GetFID() );
+    else if( psInfo->iSrcFIDField >= 0 &&
+             poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField))
+        poDstFeature->SetFID( poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField) );
+
+    /* Erase native data if asked explicitly */
+    if( !m_bNativeData )
+    {
+        poDstFeature->SetNativeData(nullptr);
+        poDstFeature->SetNativeMediaType(nullptr);
+    }
 
-                if (m_poClipSrc)
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
+    {
+        OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
+        if (poDstGeometry == nullptr)
+            continue;
+
+        if (nParts > 0)
+        {
+            /* For -explodecollections, extract the iPart(th) of the geometry */
+            OGRGeometry* poPart = poDstGeometry->toGeometryCollection()->getGeometryRef(iPart);
+            poDstGeometry->toGeometryCollection()->removeGeometry(iPart, FALSE);
+            delete poDstGeometry;
+            poDstGeometry = poPart;
+            assert(poDstGeometry);
+        }
+
+        if (iSrcZField != -1)
+        {
+            SetZ(poDstGeometry, poFeature->GetFieldAsDouble(iSrcZField));
+            /* This will correct the coordinate dimension to 3 */
+            OGRGeometry* poDupGeometry = poDstGeometry->clone();
+            delete poDstGeometry;
+            poDstGeometry = poDupGeometry;
+        }
+
+        if (m_nCoordDim == 2 || m_nCoordDim == 3)
+        {
+            poDstGeometry->setCoordinateDimension( m_nCoordDim );
+        }
+        else if (m_nCoordDim == 4)
+        {
+            poDstGeometry->set3D( TRUE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if (m_nCoordDim == COORD_DIM_XYM)
+        {
+            poDstGeometry->set3D( FALSE );
+            poDstGeometry->setMeasured( TRUE );
+        }
+        else if ( m_nCoordDim == COORD_DIM_LAYER_DIM )
+        {
+            const OGRwkbGeometryType eDstLayerGeomType =
+              poDstFDefn->GetGeomFieldDefn(iGeom)->GetType();
+            poDstGeometry->set3D( wkbHasZ(eDstLayerGeomType) );
+            poDstGeometry->setMeasured( wkbHasM(eDstLayerGeomType) );
+        }
+
+        if (m_eGeomOp == GEOMOP_SEGMENTIZE)
+        {
+            if (m_dfGeomOpParam > 0)
+                poDstGeometry->segmentize(m_dfGeomOpParam);
+        }
+        else if (m_eGeomOp == GEOMOP_SIMPLIFY_PRESERVE_TOPOLOGY)
+        {
+            if (m_dfGeomOpParam > 0)
+            {
+                OGRGeometry* poNewGeom = poDstGeometry->SimplifyPreserveTopology(m_dfGeomOpParam);
+                if (poNewGeom)
                 {
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
                     delete poDstGeometry;
-                    if (poClipped == nullptr || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
-                    poDstGeometry = poClipped;
+                    poDstGeometry = poNewGeom;
                 }
+            }
+        }
 
-                OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
-                if( !m_bTransform )
-                    poCT = m_poGCPCoordTrans;
-                char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+        if (m_poClipSrc)
+        {
+            OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipSrc);
+            delete poDstGeometry;
+            if (poClipped == nullptr || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                OGRFeature::DestroyFeature( poDstFeature );
+                return;
+            }
+            poDstGeometry = poClipped;
+        }
 
-                if( poCT != nullptr || papszTransformOptions != nullptr)
-                {
-                    OGRGeometry* poReprojectedGeom =
-                        OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
-                    if( poReprojectedGeom == nullptr )
-                    {
-                        if( psOptions->nGroupTransactions )
-                        {
-                            if( psOptions->nLayerTransaction )
-                            {
-                                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
-                                    !psOptions->bSkipFailures )
-                                {
-                                    OGRFeature::DestroyFeature( poFeature );
-                                    OGRFeature::DestroyFeature( poDstFeature );
-                                    delete poDstGeometry;
-                                    return false;
-                                }
-                            }
-                        }
+        poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+    }
 
-                        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
-                                  poFeature->GetFID() );
-                        if( !psOptions->bSkipFailures )
-                        {
-                            OGRFeature::DestroyFeature( poFeature );
-                            OGRFeature::DestroyFeature( poDstFeature );
-                            delete poDstGeometry;
-                            return false;
-                        }
-                    }
+    sPart.poDstFeature = poDstFeature;
+}
 
-                    delete poDstGeometry;
-                    poDstGeometry = poReprojectedGeom;
-                }
-                else if (poOutputSRS != nullptr)
-                {
-                    poDstGeometry->assignSpatialReference(poOutputSRS);
-                }
+/************************************************************************/
+/*                    LayerTranslator::FinishPart()                     */
+/************************************************************************/
 
-                if (m_poClipDst)
-                {
-                    if( poDstGeometry == nullptr )
-                        goto end_loop;
+/* Reproject the geometries of a target feature prepared by PreparePart() */
+/* (unless already done on the whole batch, as recorded by */
+/* anTransformState), and apply the operations that follow reprojection. */
+void LayerTranslator::FinishPart( TargetLayerInfo* psInfo,
+                                  OGRSpatialReference* poOutputSRS,
+                                  bool bSkipFailures,
+                                  TranslatedPart& sPart )
+{
+    OGRFeature* poDstFeature = sPart.poDstFeature;
+    if( poDstFeature == nullptr )
+        return;
 
-                    OGRGeometry* poClipped = poDstGeometry->Intersection(m_poClipDst);
-                    delete poDstGeometry;
-                    if (poClipped == nullptr || poClipped->IsEmpty())
-                    {
-                        delete poClipped;
-                        goto end_loop;
-                    }
+    const int eGType = m_eGType;
+    const int nDstGeomFieldCount = poDstFeature->GetGeomFieldCount();
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom ++ )
+    {
+        OGRGeometry* poDstGeometry = poDstFeature->StealGeometry(iGeom);
+        if (poDstGeometry == nullptr)
+            continue;
 
-                    poDstGeometry = poClipped;
-                }
+        OGRCoordinateTransformation* poCT = psInfo->papoCT[iGeom];
+        if( !m_bTransform )
+            poCT = m_poGCPCoordTrans;
+        char** papszTransformOptions = psInfo->papapszTransformOptions[iGeom];
+        const int eState = sPart.anTransformState.empty() ?
+            TS_PENDING : sPart.anTransformState[iGeom];
 
-                if( eGType != GEOMTYPE_UNCHANGED )
+        if( eState == TS_DONE )
+        {
+            /* Already reprojected in place */
+        }
+        else if( eState == TS_FAILED ||
+                 poCT != nullptr || papszTransformOptions != nullptr)
+        {
+            OGRGeometry* poReprojectedGeom = eState == TS_FAILED ? nullptr :
+                OGRGeometryFactory::transformWithOptions(poDstGeometry, poCT, papszTransformOptions);
+            delete poDstGeometry;
+            poDstGeometry = poReprojectedGeom;
+            if( poDstGeometry == nullptr )
+            {
+                sPart.nReprojectFailures ++;
+                if( !bSkipFailures )
                 {
-                    poDstGeometry = OGRGeometryFactory::forceTo(
-                            poDstGeometry, static_cast<OGRwkbGeometryType>(eGType));
-                }
-                else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
-                         m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
-                {
-                    if( poDstGeometry != nullptr )
-                    {
-                        OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
-                        eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
-                        poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
-                    }
+                    OGRFeature::DestroyFeature( poDstFeature );
+                    sPart.poDstFeature = nullptr;
+                    return;
                 }
+            }
+        }
+        else if (poOutputSRS != nullptr)
+        {
+            poDstGeometry->assignSpatialReference(poOutputSRS);
+        }
+
+        if (m_poClipDst)
+        {
+            OGRGeometry* poClipped = nullptr;
+            if( poDstGeometry != nullptr )
+            {
+                poClipped = poDstGeometry->Intersection(m_poClipDst);
+                delete poDstGeometry;
+            }
+            if (poClipped == nullptr || poClipped->IsEmpty())
+            {
+                delete poClipped;
+                OGRFeature::DestroyFeature( poDstFeature );
+                sPart.poDstFeature = nullptr;
+                return;
+            }
+
+            poDstGeometry = poClipped;
+        }
 
-                poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+        if( eGType != GEOMTYPE_UNCHANGED )
+        {
+            poDstGeometry = OGRGeometryFactory::forceTo(
+                    poDstGeometry, static_cast<OGRwkbGeometryType>(eGType));
+        }
+        else if( m_eGeomTypeConversion == GTC_PROMOTE_TO_MULTI ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_LINEAR ||
+                 m_eGeomTypeConversion == GTC_CONVERT_TO_CURVE )
+        {
+            if( poDstGeometry != nullptr )
+            {
+                OGRwkbGeometryType eTargetType = poDstGeometry->getGeometryType();
+                eTargetType = ConvertType(m_eGeomTypeConversion, eTargetType);
+                poDstGeometry = OGRGeometryFactory::forceTo(poDstGeometry, eTargetType);
             }
+        }
 
-            CPLErrorReset();
-            if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
+        poDstFeature->SetGeomFieldDirectly(iGeom, poDstGeometry);
+    }
+}
+
+/************************************************************************/
+/*             LayerTranslator::SwitchTransactionIfNeeded()             */
+/************************************************************************/
+
+/* Called before each target feature: commit the current transaction */
+/* and start a new one every nGroupTransactions features. */
+bool LayerTranslator::SwitchTransactionIfNeeded(
+                                    TargetLayerInfo* psInfo,
+                                    int& nFeaturesInTransaction,
+                                    GIntBig& nTotalEventsDone,
+                                    GDALVectorTranslateOptions *psOptions )
+{
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    if( psOptions->nLayerTransaction &&
+        ++nFeaturesInTransaction == psOptions->nGroupTransactions )
+    {
+        if( poDstLayer->CommitTransaction() == OGRERR_FAILURE ||
+            poDstLayer->StartTransaction() == OGRERR_FAILURE )
+        {
+            return false;
+        }
+        nFeaturesInTransaction = 0;
+    }
+    else if( !psOptions->nLayerTransaction &&
+             psOptions->nGroupTransactions >= 0 &&
+             ++nTotalEventsDone >= psOptions->nGroupTransactions )
+    {
+        if( m_poODS->CommitTransaction() == OGRERR_FAILURE ||
+                m_poODS->StartTransaction(psOptions->bForceTransaction) == OGRERR_FAILURE )
+        {
+            return false;
+        }
+        nTotalEventsDone = 0;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                    LayerTranslator::WritePart()                      */
+/************************************************************************/
+
+/* Report the failures that occurred while translating a target feature, */
+/* and write it. Returns false if the translation must stop. */
+bool LayerTranslator::WritePart( TargetLayerInfo* psInfo,
+                                 OGRFeature* poFeature,
+                                 TranslatedPart& sPart,
+                                 GIntBig& nFeaturesWritten,
+                                 GDALVectorTranslateOptions *psOptions )
+{
+    OGRLayer *poSrcLayer = psInfo->poSrcLayer;
+    OGRLayer *poDstLayer = psInfo->poDstLayer;
+    const bool bPreserveFID = psInfo->bPreserveFID;
+
+    if( sPart.bSetFromFailed )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
             {
-                nFeaturesWritten ++;
-                if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
-                    (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField) &&
-                     poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE )
                 {
-                    CPLError( CE_Warning, CPLE_AppDefined,
-                              "Feature id not preserved");
+                    return false;
                 }
             }
-            else if( !psOptions->bSkipFailures )
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to translate feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+        return false;
+    }
+
+    for( int i = 0; i < sPart.nReprojectFailures; i++ )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
             {
-                if( psOptions->nGroupTransactions )
+                if( poDstLayer->CommitTransaction() != OGRERR_NONE &&
+                    !psOptions->bSkipFailures )
                 {
-                    if( psOptions->nLayerTransaction )
-                        poDstLayer->RollbackTransaction();
+                    OGRFeature::DestroyFeature( sPart.poDstFeature );
+                    sPart.poDstFeature = nullptr;
+                    return false;
                 }
+            }
+        }
 
-                CPLError( CE_Failure, CPLE_AppDefined,
-                        "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
-                        poFeature->GetFID(), poSrcLayer->GetName() );
+        CPLError( CE_Failure, CPLE_AppDefined, "Failed to reproject feature " CPL_FRMT_GIB " (geometry probably out of source or destination SRS).",
+                  poFeature->GetFID() );
+        if( !psOptions->bSkipFailures )
+        {
+            OGRFeature::DestroyFeature( sPart.poDstFeature );
+            sPart.poDstFeature = nullptr;
+            return false;
+        }
+    }
 
-                OGRFeature::DestroyFeature( poFeature );
-                OGRFeature::DestroyFeature( poDstFeature );
-                return false;
+    OGRFeature* poDstFeature = sPart.poDstFeature;
+    sPart.poDstFeature = nullptr;
+    if( poDstFeature == nullptr )
+    {
+        /* Clipped out */
+        return true;
+    }
+
+    CPLErrorReset();
+    if( poDstLayer->CreateFeature( poDstFeature ) == OGRERR_NONE )
+    {
+        nFeaturesWritten ++;
+        if( (bPreserveFID && poDstFeature->GetFID() != poFeature->GetFID()) ||
+            (!bPreserveFID && psInfo->iSrcFIDField >= 0 && poFeature->IsFieldSetAndNotNull(psInfo->iSrcFIDField) &&
+             poDstFeature->GetFID() != poFeature->GetFieldAsInteger64(psInfo->iSrcFIDField)) )
+        {
+            CPLError( CE_Warning, CPLE_AppDefined,
+                      "Feature id not preserved");
+        }
+    }
+    else if( !psOptions->bSkipFailures )
+    {
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+                poDstLayer->RollbackTransaction();
+        }
+
+        CPLError( CE_Failure, CPLE_AppDefined,
+                "Unable to write feature " CPL_FRMT_GIB " from layer %s.",
+                poFeature->GetFID(), poSrcLayer->GetName() );
+
+        OGRFeature::DestroyFeature( poDstFeature );
+        return false;
+    }
+    else
+    {
+        CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
+                   poFeature->GetFID(), poSrcLayer->GetName() );
+        if( psOptions->nGroupTransactions )
+        {
+            if( psOptions->nLayerTransaction )
+            {
+                poDstLayer->RollbackTransaction();
+                CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
             }
             else
             {
-                CPLDebug( "GDALVectorTranslate", "Unable to write feature " CPL_FRMT_GIB " into layer %s.",
-                           poFeature->GetFID(), poSrcLayer->GetName() );
-                if( psOptions->nGroupTransactions )
-                {
-                    if( psOptions->nLayerTransaction )
-                    {
-                        poDstLayer->RollbackTransaction();
-                        CPL_IGNORE_RET_VAL(poDstLayer->StartTransaction());
-                    }
-                    else
-                    {
-                        m_poODS->RollbackTransaction();
-                        m_poODS->StartTransaction(psOptions->bForceTransaction);
-                    }
-                }
+                m_poODS->RollbackTransaction();
+                m_poODS->StartTransaction(psOptions->bForceTransaction);
             }
-
-end_loop:
-            OGRFeature::DestroyFeature( poDstFeature );
         }
+    }
 
-        OGRFeature::DestroyFeature( poFeature );
+    OGRFeature::DestroyFeature( poDstFeature );
+    return true;
+}
 
-        /* Report progress */
-        nCount ++;
-        bool bGoOn = true;
-        if (pfnProgress)
+/************************************************************************/
+/* ==================================================================== */
+/*                   Pipelined translation of a layer                   */
+/* ==================================================================== */
+/************************************************************************/
+
+/* Number of source features in a batch, and number of batches */
+/* that can wait in each queue of the pipeline. */
+constexpr size_t knPipelineBatchSize = 1024;
+constexpr size_t knPipelineQueueSize = 4;
+
+/* Error emitted by one of the threads of the pipeline, reported later */
+/* by the writing thread at the point it would have occurred in the */
+/* sequential translation. */
+struct CapturedError
+{
+    CPLErr       eErr;
+    CPLErrorNum  nNo;
+    CPLString    osMsg;
+};
+
+struct PipelineFeature
+{
+    OGRFeature                 *poSrcFeature = nullptr;
+    std::vector<TranslatedPart> asParts{};
+    std::vector<CapturedError>  aoErrors{};
+};
+
+struct PipelineBatch
+{
+    std::vector<PipelineFeature> asFeatures{};
+    std::vector<CapturedError>   aoErrors{}; /* emitted at end of layer */
+    bool                         bLast = false;
+    bool                         bReadFailed = false;
+
+    PipelineBatch() = default;
+    ~PipelineBatch();
+
+    CPL_DISALLOW_COPY_ASSIGN(PipelineBatch)
+};
+
+PipelineBatch::~PipelineBatch()
+{
+    for( auto& sFeature : asFeatures )
+    {
+        OGRFeature::DestroyFeature( sFeature.poSrcFeature );
+        for( auto& sPart : sFeature.asParts )
+            OGRFeature::DestroyFeature( sPart.poDstFeature );
+    }
+}
+
+/************************************************************************/
+/*                            PipelineQueue                             */
+/************************************************************************/
+
+/* Bounded queue of batches between two stages of the pipeline. */
+class PipelineQueue
+{
+    CPLMutex                   *m_hMutex = nullptr;
+    CPLCond                    *m_hCond = nullptr;
+    std::deque<PipelineBatch*>  m_apoBatches{};
+    bool                        m_bAborted = false;
+
+    CPL_DISALLOW_COPY_ASSIGN(PipelineQueue)
+
+  public:
+    PipelineQueue() : m_hCond(CPLCreateCond()) {}
+    ~PipelineQueue();
+
+    bool            Push( PipelineBatch* poBatch );
+    PipelineBatch  *Pop();
+    void            Abort();
+};
+
+PipelineQueue::~PipelineQueue()
+{
+    for( auto poBatch : m_apoBatches )
+        delete poBatch;
+    if( m_hCond )
+        CPLDestroyCond(m_hCond);
+    if( m_hMutex )
+        CPLDestroyMutex(m_hMutex);
+}
+
+/* Wait for a free slot and queue poBatch. Returns false if the pipeline */
+/* has been aborted, in which case the caller keeps ownership of poBatch. */
+bool PipelineQueue::Push( PipelineBatch* poBatch )
+{
+    CPLMutexHolderD(&m_hMutex);
+    while( !m_bAborted && m_apoBatches.size() >= knPipelineQueueSize )
+        CPLCondWait(m_hCond, m_hMutex);
+    if( m_bAborted )
+        return false;
+    m_apoBatches.push_back(poBatch);
+    CPLCondBroadcast(m_hCond);
+    return true;
+}
+
+/* Wait for a batch. Returns nullptr if the pipeline has been aborted. */
+PipelineBatch* PipelineQueue::Pop()
+{
+    CPLMutexHolderD(&m_hMutex);
+    while( !m_bAborted && m_apoBatches.empty() )
+        CPLCondWait(m_hCond, m_hMutex);
+    if( m_bAborted )
+        return nullptr;
+    PipelineBatch* poBatch = m_apoBatches.front();
+    m_apoBatches.pop_front();
+    CPLCondBroadcast(m_hCond);
+    return poBatch;
+}
+
+void PipelineQueue::Abort()
+{
+    CPLMutexHolderD(&m_hMutex);
+    m_bAborted = true;
+    CPLCondBroadcast(m_hCond);
+}
+
+/************************************************************************/
+/*                           PipelineContext                            */
+/************************************************************************/
+
+struct PipelineContext
+{
+    LayerTranslator            *poTranslator = nullptr;
+    TargetLayerInfo            *psInfo = nullptr;
+    OGRFeatureDefn             *poDstFDefn = nullptr;
+    OGRSpatialReference        *poOutputSRS = nullptr;
+    bool                        bSkipFailures = false;
+    GIntBig                     nFeaturesReadAtStart = 0;
+    std::vector<bool>           abBatchTransform{}; /* per target geometry field */
+    PipelineQueue               oReadQueue{};
+    PipelineQueue               oTranslatedQueue{};
+};
+
+/************************************************************************/
+/*                     PipelineCaptureErrorHandler()                    */
+/************************************************************************/
+
+/* The user data is the address of the pointer to the error list of the */
+/* feature being processed. */
+static void CPL_STDCALL PipelineCaptureErrorHandler( CPLErr eErr,
+                                                     CPLErrorNum nNo,
+                                                     const char* pszMsg )
+{
+    std::vector<CapturedError>* paoErrors =
+        *static_cast<std::vector<CapturedError>**>(
+                                            CPLGetErrorHandlerUserData());
+    if( paoErrors != nullptr )
+    {
+        CapturedError sError;
+        sError.eErr = eErr;
+        sError.nNo = nNo;
+        sError.osMsg = pszMsg;
+        paoErrors->push_back(sError);
+    }
+}
+
+static void EmitCapturedErrors( const std::vector<CapturedError>& aoErrors )
+{
+    for( const auto& sError : aoErrors )
+        CPLError( sError.eErr, sError.nNo, "%s", sError.osMsg.c_str() );
+}
+
+/************************************************************************/
+/*                        PipelineReaderThread()                        */
+/************************************************************************/
+
+static void PipelineReaderThread( void* pData )
+{
+    PipelineContext* psCtxt = static_cast<PipelineContext*>(pData);
+    OGRLayer* poSrcLayer = psCtxt->psInfo->poSrcLayer;
+    const GIntBig nLimit = psCtxt->poTranslator->m_nLimit;
+    GIntBig nFeaturesRead = psCtxt->nFeaturesReadAtStart;
+
+    std::vector<CapturedError>* paoErrors = nullptr;
+    CPLPushErrorHandlerEx(PipelineCaptureErrorHandler, &paoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+
+    bool bLast = false;
+    while( !bLast )
+    {
+        PipelineBatch* poBatch = new PipelineBatch();
+        /* No reallocation, so that paoErrors remains valid */
+        poBatch->asFeatures.reserve(knPipelineBatchSize);
+        while( poBatch->asFeatures.size() < knPipelineBatchSize )
         {
-            bGoOn = pfnProgress(nCountLayerFeatures ? nCount * 1.0 / nCountLayerFeatures: 1.0, "", pProgressArg) != FALSE;
+            if( nLimit >= 0 && nFeaturesRead >= nLimit )
+            {
+                bLast = true;
+                break;
+            }
+
+            poBatch->asFeatures.push_back(PipelineFeature());
+            PipelineFeature& sFeature = poBatch->asFeatures.back();
+            paoErrors = &sFeature.aoErrors;
+            CPLErrorReset();
+            OGRFeature* poFeature = poSrcLayer->GetNextFeature();
+            paoErrors = nullptr;
+            if( poFeature == nullptr )
+            {
+                poBatch->aoErrors = std::move(sFeature.aoErrors);
+                poBatch->asFeatures.pop_back();
+                poBatch->bReadFailed = CPLGetLastErrorType() == CE_Failure;
+                bLast = true;
+                break;
+            }
+            sFeature.poSrcFeature = poFeature;
+            nFeaturesRead ++;
         }
-        if( !bGoOn )
+
+        poBatch->bLast = bLast;
+        if( !psCtxt->oReadQueue.Push(poBatch) )
         {
-            bRet = false;
+            delete poBatch;
             break;
         }
+    }
 
-        if (pnReadFeatureCount)
-            *pnReadFeatureCount = nCount;
+    CPLPopErrorHandler();
+}
 
-        if( psOptions->nFIDToFetch != OGRNullFID )
+/************************************************************************/
+/*                      PipelineTranslatorThread()                      */
+/************************************************************************/
+
+static void PipelineTranslatorThread( void* pData )
+{
+    PipelineContext* psCtxt = static_cast<PipelineContext*>(pData);
+
+    std::vector<CapturedError>* paoErrors = nullptr;
+    CPLPushErrorHandlerEx(PipelineCaptureErrorHandler, &paoErrors);
+    CPLSetCurrentErrorHandlerCatchDebug(FALSE);
+
+    while( true )
+    {
+        PipelineBatch* poBatch = psCtxt->oReadQueue.Pop();
+        if( poBatch == nullptr )
             break;
-        if( poFeatureIn != nullptr )
+
+        psCtxt->poTranslator->TranslateBatch(psCtxt, poBatch, paoErrors);
+        paoErrors = nullptr;
+
+        const bool bLast = poBatch->bLast;
+        if( !psCtxt->oTranslatedQueue.Push(poBatch) )
+        {
+            delete poBatch;
+            break;
+        }
+        if( bLast )
             break;
     }
 
-    if( psOptions->nGroupTransactions )
+    CPLPopErrorHandler();
+}
+
+/************************************************************************/
+/*                  LayerTranslator::TranslateBatch()                   */
+/************************************************************************/
+
+/* Translate all the features of a batch. The coordinate transformations */
+/* that do not need any extra processing are done at once on all the */
+/* geometries of the batch. */
+void LayerTranslator::TranslateBatch( PipelineContext* psCtxt,
+                                      PipelineBatch* poBatch,
+                                      std::vector<CapturedError>*& paoErrors )
+{
+    TargetLayerInfo* psInfo = psCtxt->psInfo;
+    const int nDstGeomFieldCount = psCtxt->poDstFDefn->GetGeomFieldCount();
+
+    for( auto& sFeature : poBatch->asFeatures )
     {
-        if( psOptions->nLayerTransaction )
+        paoErrors = &sFeature.aoErrors;
+        psInfo->nFeaturesRead ++;
+
+        int nParts = 0;
+        const int nIters = CountParts(psInfo, sFeature.poSrcFeature,
+                                      nDstGeomFieldCount, nParts);
+        sFeature.asParts.resize(nIters);
+        for( int iPart = 0; iPart < nIters; iPart++ )
         {
-            if( poDstLayer->CommitTransaction() != OGRERR_NONE )
-                bRet = false;
+            CPLErrorReset();
+            PreparePart( psInfo, psCtxt->poDstFDefn, sFeature.poSrcFeature,
+                         nParts, iPart, sFeature.asParts[iPart] );
         }
     }
 
-    if( poFeatureIn == nullptr )
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
     {
-        CPLDebug("GDALVectorTranslate", CPL_FRMT_GIB " features written in layer '%s'",
-                nFeaturesWritten, poDstLayer->GetName());
+        if( !psCtxt->abBatchTransform[iGeom] )
+            continue;
+
+        std::vector<OGRGeometry*> apoGeoms;
+        std::vector<TranslatedPart*> apsParts;
+        std::vector<PipelineFeature*> apsFeatures;
+        for( auto& sFeature : poBatch->asFeatures )
+        {
+            for( auto& sPart : sFeature.asParts )
+            {
+                if( sPart.poDstFeature == nullptr )
+                    continue;
+                OGRGeometry* poGeom = sPart.poDstFeature->GetGeomFieldRef(iGeom);
+                if( poGeom == nullptr )
+                    continue;
+                apoGeoms.push_back(poGeom);
+                apsParts.push_back(&sPart);
+                apsFeatures.push_back(&sFeature);
+            }
+        }
+        if( apoGeoms.empty() )
+            continue;
+
+        OGRCoordinateTransformation* poCT = m_bTransform ?
+            psInfo->papoCT[iGeom] : m_poGCPCoordTrans;
+        std::vector<int> abTransformed(apoGeoms.size());
+        OGRGeometryBatchTransform( static_cast<int>(apoGeoms.size()),
+                                   &apoGeoms[0], poCT, &abTransformed[0] );
+
+        for( size_t i = 0; i < apoGeoms.size(); i++ )
+        {
+            TranslatedPart* psPart = apsParts[i];
+            if( psPart->anTransformState.empty() )
+                psPart->anTransformState.resize(nDstGeomFieldCount,
+                                                TS_PENDING);
+            if( abTransformed[i] )
+            {
+                psPart->anTransformState[iGeom] = TS_DONE;
+                continue;
+            }
+
+            /* The batch transformation does not emit errors: transform */
+            /* the geometry again so that they are reported with its own */
+            /* feature. */
+            paoErrors = &apsFeatures[i]->aoErrors;
+            psPart->anTransformState[iGeom] =
+                apoGeoms[i]->transform(poCT) == OGRERR_NONE ?
+                    TS_DONE : TS_FAILED;
+            paoErrors = nullptr;
+        }
     }
 
-    return bRet;
+    for( auto& sFeature : poBatch->asFeatures )
+    {
+        paoErrors = &sFeature.aoErrors;
+        for( auto& sPart : sFeature.asParts )
+        {
+            FinishPart( psInfo, psCtxt->poOutputSRS, psCtxt->bSkipFailures,
+                        sPart );
+        }
+    }
+}
+
+/************************************************************************/
+/*                LayerTranslator::TranslatePipelined()                 */
+/************************************************************************/
+
+/* Translate the remaining features of the layer with one thread reading */
+/* the source layer, one thread translating the features, and the */
+/* calling thread writing them in order, handling the transactions, the */
+/* failures and the progress exactly as Translate() does. */
+/* Returns false if Translate() must return false immediately, otherwise */
+/* bRet is set to false in case of a read error or interruption. */
+bool LayerTranslator::TranslatePipelined( TargetLayerInfo* psInfo,
+                                          OGRFeatureDefn* poDstFDefn,
+                                          OGRSpatialReference* poOutputSRS,
+                                          GIntBig nCountLayerFeatures,
+                                          GIntBig* pnReadFeatureCount,
+                                          GIntBig& nCount,
+                                          int& nFeaturesInTransaction,
+                                          GIntBig& nFeaturesWritten,
+                                          GIntBig& nTotalEventsDone,
+                                          GDALProgressFunc pfnProgress,
+                                          void *pProgressArg,
+                                          GDALVectorTranslateOptions *psOptions,
+                                          bool& bRet )
+{
+    PipelineContext sCtxt;
+    sCtxt.poTranslator = this;
+    sCtxt.psInfo = psInfo;
+    sCtxt.poDstFDefn = poDstFDefn;
+    sCtxt.poOutputSRS = poOutputSRS;
+    sCtxt.bSkipFailures = psOptions->bSkipFailures;
+    sCtxt.nFeaturesReadAtStart = psInfo->nFeaturesRead;
+
+    /* transformWithOptions() does extra processing around the poles and */
+    /* the antimeridian when reprojecting to WGS84 with GEOS. */
+    OGRSpatialReference oSRSWGS84;
+    oSRSWGS84.SetWellKnownGeogCS( "WGS84" );
+    const int nDstGeomFieldCount = poDstFDefn->GetGeomFieldCount();
+    for( int iGeom = 0; iGeom < nDstGeomFieldCount; iGeom++ )
+    {
+        OGRCoordinateTransformation* poCT = m_bTransform ?
+            psInfo->papoCT[iGeom] : m_poGCPCoordTrans;
+        sCtxt.abBatchTransform.push_back(
+            poCT != nullptr &&
+            psInfo->papapszTransformOptions[iGeom] == nullptr &&
+            !(OGRGeometryFactory::haveGEOS() &&
+              poCT->GetSourceCS() != nullptr &&
+              poCT->GetTargetCS() != nullptr &&
+              poCT->GetTargetCS()->IsSame(&oSRSWGS84)) );
+    }
+
+    CPLJoinableThread* hReaderThread =
+        CPLCreateJoinableThread(PipelineReaderThread, &sCtxt);
+    CPLJoinableThread* hTranslatorThread = hReaderThread ?
+        CPLCreateJoinableThread(PipelineTranslatorThread, &sCtxt) : nullptr;
+    if( hTranslatorThread == nullptr )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Cannot create the threads of the pipeline" );
+        sCtxt.oReadQueue.Abort();
+        if( hReaderThread )
+            CPLJoinThread(hReaderThread);
+        return false;
+    }
+
+    bool bFatal = false;
+    bool bStop = false;
+    while( !bFatal && !bStop )
+    {
+        PipelineBatch* poBatch = sCtxt.oTranslatedQueue.Pop();
+        if( poBatch == nullptr )
+            break;
+
+        for( auto& sFeature : poBatch->asFeatures )
+        {
+            EmitCapturedErrors(sFeature.aoErrors);
+
+            for( auto& sPart : sFeature.asParts )
+            {
+                if( !SwitchTransactionIfNeeded( psInfo, nFeaturesInTransaction,
+                                                nTotalEventsDone, psOptions ) ||
+                    !WritePart( psInfo, sFeature.poSrcFeature, sPart,
+                                nFeaturesWritten, psOptions ) )
+                {
+                    bFatal = true;
+                    break;
+                }
+            }
+            if( bFatal )
+                break;
+
+            OGRFeature::DestroyFeature( sFeature.poSrcFeature );
+            sFeature.poSrcFeature = nullptr;
+
+            /* Report progress */
+            nCount ++;
+            bool bGoOn = true;
+            if (pfnProgress)
+            {
+                bGoOn = pfnProgress(nCountLayerFeatures ? nCount * 1.0 / nCountLayerFeatures: 1.0, "", pProgressArg) != FALSE;
+            }
+            if( !bGoOn )
+            {
+                bRet = false;
+                bStop = true;
+                break;
+            }
+
+            if (pnReadFeatureCount)
+                *pnReadFeatureCount = nCount;
+        }
+
+        if( !bFatal && !bStop && poBatch->bLast )
+        {
+            EmitCapturedErrors(poBatch->aoErrors);
+            if( poBatch->bReadFailed )
+                bRet = false;
+            bStop = true;
+        }
+        delete poBatch;
+    }
+
+    sCtxt.oReadQueue.Abort();
+    sCtxt.oTranslatedQueue.Abort();
+    CPLJoinThread(hReaderThread);
+    CPLJoinThread(hTranslatorThread);
+
+    return !bFatal;
 }
 
 /************************************************************************/
@@ -4833,6 +5549,7 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
     psOptions->nLayerTransaction = -1;
     psOptions->bForceTransaction = false;
     psOptions->nGroupTransactions = 20000;
+    psOptions->bPipeline = false;
     psOptions->nFIDToFetch = OGRNullFID;
     psOptions->bQuiet = false;
     psOptions->pszFormat = nullptr;
@@ -5079,6 +5796,10 @@ GDALVectorTranslateOptions *GDALVectorTranslateOptionsNew(char** papszArgv,
         {
             psOptions->nLayerTransaction = TRUE;
         }
+        else if ( EQUAL(papszArgv[i],"-pipeline") )
+        {
+            psOptions->bPipeline = true;
+        }
         else if( i+1 < nArgc && EQUAL(papszArgv[i],"-s_srs") )
         {
             CPLFree(psOptions->pszSourceSRSDef);
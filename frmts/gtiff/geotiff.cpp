@@ -54,6 +54,7 @@
 #endif
 
 #include <algorithm>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -105,6 +106,8 @@ CPL_CVSID("$Id: geotiff.cpp 84c03d49546d24f13bc385b4f3bce905190814f5 2018-05-23
 static bool bGlobalInExternalOvr = false;
 static std::mutex gMutexThreadPool;
 CPLWorkerThreadPool *gpoCompressThreadPool = nullptr;
+// Shared by all the read-only datasets. See GetDecompressionThreadPool().
+static CPLWorkerThreadPool *gpoDecompressThreadPool = nullptr;
 
 // Only libtiff 4.0.4 can handle between 32768 and 65535 directories.
 #if TIFFLIB_VERSION >= 20120922
@@ -236,6 +239,58 @@ typedef struct
     int           nCompressedBufferSize;
     bool          bReady;
 } GTiffCompressionJob;
+
+// Jobs of a CacheMultiThreadedDecode() call still running. As the
+// decompression thread pool is shared by all datasets, each call waits
+// for its own jobs rather than for the whole pool.
+typedef struct
+{
+    std::mutex              oMutex;
+    std::condition_variable oCond;
+    size_t                  nPendingJobs;
+} GTiffDecompressionWait;
+
+typedef struct
+{
+    GTiffDecompressionWait *psWait;
+    GTiffDataset *poDS;
+    bool          bTIFFIsBigEndian;
+    char         *pszTmpFilename;
+    uint16        nPredictor;
+    int           nBlockId;
+    int           nBlockXOff;
+    int           nBlockYOff;
+    int           nBand;  // 0 for pixel-interleaved blocks.
+
+    vsi_l_offset  nOffset;
+    GByte        *pabyCompressedBuffer;  // Owned by the caller.
+    int           nCompressedBufferSize;
+
+    GByte        *pabyBuffer;  // Block cache data, or temporary buffer.
+    int           nBlockBufSize;
+    int           nBlockReqSize;
+    bool          bSuccess;
+} GTiffDecompressionJob;
+
+// Counts a decompression job as done when going out of scope.
+class GTiffDecompressionJobNotifier
+{
+    GTiffDecompressionWait *m_psWait;
+
+    CPL_DISALLOW_COPY_ASSIGN(GTiffDecompressionJobNotifier)
+
+  public:
+    explicit GTiffDecompressionJobNotifier( GTiffDecompressionWait *psWait ) :
+        m_psWait(psWait) {}
+
+    ~GTiffDecompressionJobNotifier()
+    {
+        std::lock_guard<std::mutex> oLock(m_psWait->oMutex);
+        m_psWait->nPendingJobs--;
+        if( m_psWait->nPendingJobs == 0 )
+            m_psWait->oCond.notify_one();
+    }
+};
 #if !defined(__MINGW32__)
 }
 #endif
@@ -465,6 +520,20 @@ class GTiffDataset final : public GDALPamDataset
     bool           SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
                                          int cc, int nHeight) ;
 
+    bool           m_bDecompressionThreadsInitialized = false;
+    CPLWorkerThreadPool *m_poDecompressThreadPool = nullptr;
+    std::vector<GByte> m_abyJPEGTables;
+    bool           AcquireThreadPool( int nThreads );
+    CPLWorkerThreadPool* GetDecompressionThreadPool();
+    bool           IsMultiThreadedDecodingCompatible();
+    static void    ThreadDecompressionFunc( void* pData );
+    void           CacheMultiThreadedDecode( int nXOff, int nYOff,
+                                             int nXSize, int nYSize,
+                                             int nBufXSize, int nBufYSize,
+                                             int nBandCount,
+                                             const int *panBandMap,
+                                             GDALRasterIOExtraArg* psExtraArg );
+
     int            GuessJPEGQuality( bool& bOutHasQuantizationTable,
                                      bool& bOutHasHuffmanTable );
 
@@ -2137,6 +2206,13 @@ CPLErr GTiffDataset::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( eAccess == GA_ReadOnly && eRWFlag == GF_Read )
+    {
+        CacheMultiThreadedDecode(nXOff, nYOff, nXSize, nYSize,
+                                 nBufXSize, nBufYSize,
+                                 nBandCount, panBandMap, psExtraArg);
+    }
+
     void* pBufferedData = nullptr;
     if( eAccess == GA_ReadOnly &&
         eRWFlag == GF_Read &&
@@ -4151,6 +4227,13 @@ CPLErr GTiffRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return static_cast<CPLErr>(nErr);
     }
 
+    if( poGDS->eAccess == GA_ReadOnly && eRWFlag == GF_Read )
+    {
+        poGDS->CacheMultiThreadedDecode(nXOff, nYOff, nXSize, nYSize,
+                                        nBufXSize, nBufYSize,
+                                        1, &nBand, psExtraArg);
+    }
+
     void* pBufferedData = nullptr;
     if( poGDS->eAccess == GA_ReadOnly &&
         eRWFlag == GF_Read &&
@@ -7447,7 +7530,8 @@ int GTiffDataset::Finalize()
                 CPLFree(asCompressionJobs[i].pszTmpFilename);
             }
         }
-        CPLDestroyMutex(hCompressThreadPoolMutex);
+        if( hCompressThreadPoolMutex )
+            CPLDestroyMutex(hCompressThreadPoolMutex);
     }
 
 /* -------------------------------------------------------------------- */
@@ -8406,6 +8490,50 @@ bool GTiffDataset::WriteEncodedStrip( uint32 strip, GByte* pabyData,
     return bRet;
 }
 
+/************************************************************************/
+/*                          GTiffGetNumThreads()                        */
+/************************************************************************/
+
+// Returns the number of worker threads requested with the NUM_THREADS
+// creation/open option or the GDAL_NUM_THREADS configuration option.
+static int GTiffGetNumThreads( char** papszOptions )
+{
+    return CPLGetNumThreads( CSLFetchNameValue( papszOptions, "NUM_THREADS" ) );
+}
+
+/************************************************************************/
+/*                          AcquireThreadPool()                         */
+/************************************************************************/
+
+bool GTiffDataset::AcquireThreadPool( int nThreads )
+{
+    // Try to reuse previously created thread pool
+    {
+        std::lock_guard<std::mutex> oLock(gMutexThreadPool);
+        if( gpoCompressThreadPool &&
+            gpoCompressThreadPool->GetThreadCount() == nThreads )
+        {
+            poCompressThreadPool = gpoCompressThreadPool;
+        }
+        else
+        {
+            delete gpoCompressThreadPool;
+        }
+        gpoCompressThreadPool = nullptr;
+    }
+
+    if( poCompressThreadPool == nullptr )
+    {
+        poCompressThreadPool = new CPLWorkerThreadPool();
+        if( !poCompressThreadPool->Setup(nThreads, nullptr, nullptr) )
+        {
+            delete poCompressThreadPool;
+            poCompressThreadPool = nullptr;
+        }
+    }
+    return poCompressThreadPool != nullptr;
+}
+
 /************************************************************************/
 /*                        InitCompressionThreads()                      */
 /************************************************************************/
@@ -8416,89 +8544,50 @@ void GTiffDataset::InitCompressionThreads( char** papszOptions )
     if( nBlockXSize == nRasterXSize && nBlockYSize == nRasterYSize )
         return;
 
-    const char* pszValue = CSLFetchNameValue( papszOptions, "NUM_THREADS" );
-    if( pszValue == nullptr )
-        pszValue = CPLGetConfigOption("GDAL_NUM_THREADS", nullptr);
-    if( pszValue )
+    const int nThreads = GTiffGetNumThreads(papszOptions);
+    if( nThreads > 1 )
     {
-        const int nThreads =
-            EQUAL(pszValue, "ALL_CPUS") ? CPLGetNumCPUs() : atoi(pszValue);
-        if( nThreads > 1 )
+        if( nCompression == COMPRESSION_NONE ||
+            nCompression == COMPRESSION_JPEG )
         {
-            if( nCompression == COMPRESSION_NONE ||
-                nCompression == COMPRESSION_JPEG )
-            {
-                CPLDebug( "GTiff",
-                          "NUM_THREADS ignored with uncompressed or JPEG" );
-            }
-            else
-            {
-                CPLDebug("GTiff", "Using %d threads for compression", nThreads);
+            CPLDebug( "GTiff",
+                      "NUM_THREADS ignored with uncompressed or JPEG" );
+        }
+        else
+        {
+            CPLDebug("GTiff", "Using %d threads for compression", nThreads);
 
-                // Try to reuse previously created thread pool
+            if( AcquireThreadPool(nThreads) )
+            {
+                // Add a margin of an extra job w.r.t thread number
+                // so as to optimize compression time (enables the main
+                // thread to do boring I/O while all CPUs are working).
+                asCompressionJobs.resize(nThreads + 1);
+                memset(&asCompressionJobs[0], 0,
+                       asCompressionJobs.size() *
+                       sizeof(GTiffCompressionJob));
+                for( int i = 0;
+                     i < static_cast<int>(asCompressionJobs.size());
+                     ++i )
                 {
-                    std::lock_guard<std::mutex> oLock(gMutexThreadPool);
-                    if( gpoCompressThreadPool &&
-                        gpoCompressThreadPool->GetThreadCount() == nThreads )
-                    {
-                        poCompressThreadPool = gpoCompressThreadPool;
-                    }
-                    else
-                    {
-                        delete gpoCompressThreadPool;
-                    }
-                    gpoCompressThreadPool = nullptr;
+                    asCompressionJobs[i].pszTmpFilename =
+                        CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
+                                             &asCompressionJobs[i]));
+                    asCompressionJobs[i].nStripOrTile = -1;
                 }
+                hCompressThreadPoolMutex = CPLCreateMutex();
+                CPLReleaseMutex(hCompressThreadPoolMutex);
 
-                if( poCompressThreadPool == nullptr )
-                {
-                    poCompressThreadPool = new CPLWorkerThreadPool();
-                    if( !poCompressThreadPool->Setup(nThreads, nullptr, nullptr) )
-                    {
-                        delete poCompressThreadPool;
-                        poCompressThreadPool = nullptr;
-                    }
-                }
-                if( poCompressThreadPool != nullptr )
-                {
-                    // Add a margin of an extra job w.r.t thread number
-                    // so as to optimize compression time (enables the main
-                    // thread to do boring I/O while all CPUs are working).
-                    asCompressionJobs.resize(nThreads + 1);
-                    memset(&asCompressionJobs[0], 0,
-                           asCompressionJobs.size() *
-                           sizeof(GTiffCompressionJob));
-                    for( int i = 0;
-                         i < static_cast<int>(asCompressionJobs.size());
-                         ++i )
-                    {
-                        asCompressionJobs[i].pszTmpFilename =
-                            CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/job/%p",
-                                                 &asCompressionJobs[i]));
-                        asCompressionJobs[i].nStripOrTile = -1;
-                    }
-                    hCompressThreadPoolMutex = CPLCreateMutex();
-                    CPLReleaseMutex(hCompressThreadPoolMutex);
-
-                    // This is kind of a hack, but basically using
-                    // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
-                    // does not work on a newly created file, because
-                    // TIFF_MYBUFFER is not set in tif_flags
-                    // (if using TIFFWriteEncodedStrip/Tile first,
-                    // TIFFWriteBufferSetup() is automatically called).
-                    // This should likely rather fixed in libtiff itself.
-                    TIFFWriteBufferSetup(hTIFF, nullptr, -1);
-                }
+                // This is kind of a hack, but basically using
+                // TIFFWriteRawStrip/Tile and then TIFFReadEncodedStrip/Tile
+                // does not work on a newly created file, because
+                // TIFF_MYBUFFER is not set in tif_flags
+                // (if using TIFFWriteEncodedStrip/Tile first,
+                // TIFFWriteBufferSetup() is automatically called).
+                // This should likely rather fixed in libtiff itself.
+                TIFFWriteBufferSetup(hTIFF, nullptr, -1);
             }
         }
-        else if( nThreads < 0 ||
-                 (!EQUAL(pszValue, "0") &&
-                  !EQUAL(pszValue, "1") &&
-                  !EQUAL(pszValue, "ALL_CPUS")) )
-        {
-            CPLError(CE_Warning, CPLE_AppDefined,
-                     "Invalid value for NUM_THREADS: %s", pszValue);
-        }
     }
 }
 
@@ -8752,6 +8841,475 @@ bool GTiffDataset::SubmitCompressionJob( int nStripOrTile, GByte* pabyData,
     return true;
 }
 
+/************************************************************************/
+/*                     GetDecompressionThreadPool()                     */
+/************************************************************************/
+
+// Lazily sets up the worker thread pool used to decode blocks of a
+// read-only dataset. The pool is shared by all the datasets, and has the
+// number of threads requested by the first one that uses it. Overview and
+// mask datasets use it when their base dataset does.
+CPLWorkerThreadPool* GTiffDataset::GetDecompressionThreadPool()
+{
+    if( poBaseDS != nullptr )
+        return poBaseDS->GetDecompressionThreadPool();
+
+    if( !m_bDecompressionThreadsInitialized )
+    {
+        m_bDecompressionThreadsInitialized = true;
+        const int nThreads = GTiffGetNumThreads(papszOpenOptions);
+        if( nThreads > 1 )
+        {
+            std::lock_guard<std::mutex> oLock(gMutexThreadPool);
+            if( gpoDecompressThreadPool == nullptr )
+            {
+                gpoDecompressThreadPool = CPLCreateWorkerThreadPool(nThreads);
+                if( gpoDecompressThreadPool != nullptr )
+                {
+                    CPLDebug("GTiff", "Using %d threads for decompression",
+                             nThreads);
+                }
+            }
+            m_poDecompressThreadPool = gpoDecompressThreadPool;
+        }
+    }
+    return m_poDecompressThreadPool;
+}
+
+/************************************************************************/
+/*                   IsMultiThreadedDecodingCompatible()                */
+/************************************************************************/
+
+bool GTiffDataset::IsMultiThreadedDecodingCompatible()
+{
+    if( eAccess != GA_ReadOnly || bStreamingIn || bTreatAsRGBA ||
+        bTreatAsSplit || bTreatAsSplitBitmap || bPromoteTo8Bits )
+        return false;
+
+    if( !(nCompression == COMPRESSION_ADOBE_DEFLATE ||
+          nCompression == COMPRESSION_DEFLATE ||
+          nCompression == COMPRESSION_LZW ||
+          nCompression == COMPRESSION_PACKBITS ||
+          nCompression == COMPRESSION_LZMA ||
+          nCompression == COMPRESSION_ZSTD ||
+          nCompression == COMPRESSION_JPEG) )
+        return false;
+
+    // YCbCr JPEG is upsampled to RGB by libtiff on the main handle.
+    if( nCompression == COMPRESSION_JPEG &&
+        nPhotometric == PHOTOMETRIC_YCBCR )
+        return false;
+
+    if( nPlanarConfig == PLANARCONFIG_CONTIG && nBands != nSamplesPerPixel )
+        return false;
+
+    // Only bands whose in-memory representation is the one of the TIFF
+    // samples (which excludes GTiffOddBitsBand and GTiffBitmapBand).
+    for( int i = 1; i <= nBands; ++i )
+    {
+        if( GDALGetDataTypeSizeBytes(
+                GetRasterBand(i)->GetRasterDataType()) * 8 != nBitsPerSample )
+            return false;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                      ThreadDecompressionFunc()                       */
+/************************************************************************/
+
+void GTiffDataset::ThreadDecompressionFunc( void* pData )
+{
+    GTiffDecompressionJob* psJob = static_cast<GTiffDecompressionJob *>(pData);
+    GTiffDataset* poDS = psJob->poDS;
+    GTiffDecompressionJobNotifier oNotifier(psJob->psWait);
+
+    // Errors are not reported from here: a block that fails to decode
+    // is read again by IReadBlock() which emits the appropriate error.
+    CPLErrorHandlerPusher oErrorHandler(CPLQuietErrorHandler);
+
+    // Wrap the raw strip/tile into a single strip temporary TIFF file,
+    // with the same characteristics as the source, and let libtiff
+    // decode it.
+    VSILFILE* fpTmp = VSIFOpenL(psJob->pszTmpFilename, "wb+");
+    TIFF* hTIFFTmp = VSI_TIFFOpen(psJob->pszTmpFilename,
+        psJob->bTIFFIsBigEndian ? "wb+" : "wl+", fpTmp);
+    if( hTIFFTmp == nullptr )
+    {
+        if( fpTmp )
+            VSIFCloseL(fpTmp);
+        VSIUnlink(psJob->pszTmpFilename);
+        psJob->bSuccess = false;
+        return;
+    }
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGEWIDTH, poDS->nBlockXSize);
+    TIFFSetField(hTIFFTmp, TIFFTAG_IMAGELENGTH, poDS->nBlockYSize);
+    TIFFSetField(hTIFFTmp, TIFFTAG_BITSPERSAMPLE, poDS->nBitsPerSample);
+    TIFFSetField(hTIFFTmp, TIFFTAG_COMPRESSION, poDS->nCompression);
+    if( psJob->nPredictor != PREDICTOR_NONE )
+        TIFFSetField(hTIFFTmp, TIFFTAG_PREDICTOR, psJob->nPredictor);
+    TIFFSetField(hTIFFTmp, TIFFTAG_PHOTOMETRIC, poDS->nPhotometric);
+    TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLEFORMAT, poDS->nSampleFormat);
+    TIFFSetField(hTIFFTmp, TIFFTAG_SAMPLESPERPIXEL, poDS->nSamplesPerPixel);
+    TIFFSetField(hTIFFTmp, TIFFTAG_ROWSPERSTRIP, poDS->nBlockYSize);
+    TIFFSetField(hTIFFTmp, TIFFTAG_PLANARCONFIG, poDS->nPlanarConfig);
+    if( poDS->nCompression == COMPRESSION_JPEG &&
+        !poDS->m_abyJPEGTables.empty() )
+    {
+        TIFFSetField(hTIFFTmp, TIFFTAG_JPEGTABLES,
+                     static_cast<uint32>(poDS->m_abyJPEGTables.size()),
+                     &poDS->m_abyJPEGTables[0]);
+    }
+
+    // See InitCompressionThreads() for the rationale.
+    TIFFWriteBufferSetup(hTIFFTmp, nullptr, -1);
+
+    if( psJob->nBlockReqSize < psJob->nBlockBufSize )
+        memset( psJob->pabyBuffer, 0, psJob->nBlockBufSize );
+
+    psJob->bSuccess =
+        TIFFWriteRawStrip(hTIFFTmp, 0, psJob->pabyCompressedBuffer,
+                          psJob->nCompressedBufferSize) ==
+                                        psJob->nCompressedBufferSize &&
+        TIFFReadEncodedStrip(hTIFFTmp, 0, psJob->pabyBuffer,
+                             psJob->nBlockReqSize) != -1;
+
+    XTIFFClose(hTIFFTmp);
+    VSIFCloseL(fpTmp);
+    VSIUnlink(psJob->pszTmpFilename);
+}
+
+/************************************************************************/
+/*                      CacheMultiThreadedDecode()                      */
+/************************************************************************/
+
+// Decodes, in the worker threads, the blocks intersecting the request
+// window that are not yet in the block cache, so that the generic
+// RasterIO() implementation then just picks them from there.
+void GTiffDataset::CacheMultiThreadedDecode( int nXOff, int nYOff,
+                                             int nXSize, int nYSize,
+                                             int nBufXSize, int nBufYSize,
+                                             int nBandCount,
+                                             const int *panBandMap,
+                                             GDALRasterIOExtraArg* psExtraArg )
+{
+    if( !IsMultiThreadedDecodingCompatible() )
+        return;
+    CPLWorkerThreadPool* poThreadPool = GetDecompressionThreadPool();
+    if( poThreadPool == nullptr || !SetDirectory() )
+        return;
+
+    // Same logic as in GTiffRasterBand::CacheMultiRange()
+    double dfXOff = nXOff;
+    double dfYOff = nYOff;
+    double dfXSize = nXSize;
+    double dfYSize = nYSize;
+    if( psExtraArg->bFloatingPointWindowValidity )
+    {
+        dfXOff = psExtraArg->dfXOff;
+        dfYOff = psExtraArg->dfYOff;
+        dfXSize = psExtraArg->dfXSize;
+        dfYSize = psExtraArg->dfYSize;
+    }
+    const double dfSrcXInc = dfXSize / static_cast<double>( nBufXSize );
+    const double dfSrcYInc = dfYSize / static_cast<double>( nBufYSize );
+    const double EPS = 1e-10;
+    const int nBlockX1 = static_cast<int>((0+0.5) * dfSrcXInc + dfXOff + EPS) / nBlockXSize;
+    const int nBlockY1 = static_cast<int>((0+0.5) * dfSrcYInc + dfYOff + EPS) / nBlockYSize;
+    const int nBlockX2 = static_cast<int>((nBufXSize-1+0.5) * dfSrcXInc + dfXOff + EPS) / nBlockXSize;
+    const int nBlockY2 = static_cast<int>((nBufYSize-1+0.5) * dfSrcYInc + dfYOff + EPS) / nBlockYSize;
+    if( nBlockX1 == nBlockX2 && nBlockY1 == nBlockY2 &&
+        (nBandCount == 1 || nPlanarConfig == PLANARCONFIG_CONTIG) )
+        return;
+
+    const bool bSeparate = nPlanarConfig == PLANARCONFIG_SEPARATE;
+
+    // In the pixel-interleaved case, all bands are decoded at once, so
+    // push them all in the block cache, as FillCacheForOtherBands() does.
+    std::vector<int> anBands;
+    if( !bSeparate && nBands < 128 )
+    {
+        for( int i = 1; i <= nBands; ++i )
+            anBands.push_back(i);
+    }
+    else
+    {
+        for( int i = 0; i < nBandCount; ++i )
+        {
+            if( std::find(anBands.begin(), anBands.end(), panBandMap[i]) ==
+                    anBands.end() )
+                anBands.push_back(panBandMap[i]);
+        }
+    }
+
+    const int nBlockBufSize = static_cast<int>(
+        TIFFIsTiled(hTIFF) ? TIFFTileSize(hTIFF) : TIFFStripSize(hTIFF));
+    if( nBlockBufSize <= 0 )
+        return;
+
+    if( nCompression == COMPRESSION_JPEG )
+    {
+        uint32 nJPEGTableSize = 0;
+        void* pJPEGTable = nullptr;
+        m_abyJPEGTables.clear();
+        if( TIFFGetField(hTIFF, TIFFTAG_JPEGTABLES,
+                         &nJPEGTableSize, &pJPEGTable) &&
+            pJPEGTable != nullptr && nJPEGTableSize > 0 )
+        {
+            m_abyJPEGTables.assign(
+                static_cast<GByte*>(pJPEGTable),
+                static_cast<GByte*>(pJPEGTable) + nJPEGTableSize);
+        }
+    }
+
+    uint16 nPredictor = PREDICTOR_NONE;
+    if( nCompression == COMPRESSION_LZW ||
+        nCompression == COMPRESSION_ADOBE_DEFLATE ||
+        nCompression == COMPRESSION_DEFLATE ||
+        nCompression == COMPRESSION_LZMA ||
+        nCompression == COMPRESSION_ZSTD )
+    {
+        TIFFGetField( hTIFF, TIFFTAG_PREDICTOR, &nPredictor );
+    }
+
+    // Do not decode more than what the block cache can reasonably hold,
+    // otherwise the first decoded blocks would be evicted before being used.
+    const GIntBig nMaxDecodedSize = GDALGetCacheMax64() / 2;
+    GIntBig nDecodedSize = 0;
+
+    const int l_nBlocksPerRow = DIV_ROUND_UP(nRasterXSize, nBlockXSize);
+    std::vector<GTiffDecompressionJob> asJobs;
+    std::vector<GDALRasterBlock*> apoBlocks;
+    size_t nTotalCompressedSize = 0;
+    const size_t nBandsPerJob = bSeparate ? 1 : anBands.size();
+    for( int iY = nBlockY1; iY <= nBlockY2 &&
+                            nDecodedSize < nMaxDecodedSize; ++iY )
+    {
+        // Bottom most partial tiles and strips may be partially encoded.
+        // See IReadBlock().
+        int nBlockReqSize = nBlockBufSize;
+        if( iY * nBlockYSize > nRasterYSize - nBlockYSize )
+        {
+            nBlockReqSize = (nBlockBufSize / nBlockYSize)
+                * (nBlockYSize - static_cast<int>(
+                    (static_cast<GIntBig>(iY + 1) * nBlockYSize)
+                        % nRasterYSize));
+        }
+
+        for( int iX = nBlockX1; iX <= nBlockX2 &&
+                                nDecodedSize < nMaxDecodedSize; ++iX )
+        {
+            for( size_t iJobBand = 0;
+                 iJobBand < anBands.size() &&
+                 nDecodedSize < nMaxDecodedSize;
+                 iJobBand += nBandsPerJob )
+            {
+                int nBlockId = iX + iY * l_nBlocksPerRow;
+                if( bSeparate )
+                    nBlockId += (anBands[iJobBand] - 1) * nBlocksPerBand;
+                if( !bSeparate && nBlockId == nLoadedBlock )
+                    continue;
+
+                // Skip blocks of which one band is already cached.
+                bool bAlreadyCached = false;
+                for( size_t i = iJobBand; i < iJobBand + nBandsPerJob; ++i )
+                {
+                    GTiffRasterBand* poBand =
+                        cpl::down_cast<GTiffRasterBand*>(
+                            GetRasterBand(anBands[i]));
+                    GDALRasterBlock* poBlock =
+                        poBand->TryGetLockedBlockRef(iX, iY);
+                    if( poBlock != nullptr )
+                    {
+                        poBlock->DropLock();
+                        bAlreadyCached = true;
+                        break;
+                    }
+                }
+                if( bAlreadyCached )
+                    continue;
+
+                vsi_l_offset nOffset = 0;
+                vsi_l_offset nSize = 0;
+                if( !IsBlockAvailable(nBlockId, &nOffset, &nSize) ||
+                    nSize == 0 || nSize > static_cast<vsi_l_offset>(INT_MAX) )
+                    continue;
+
+                // Reserve the block cache entries of the bands.
+                const size_t nFirstBlock = apoBlocks.size();
+                bool bOK = true;
+                for( size_t i = iJobBand; i < iJobBand + nBandsPerJob; ++i )
+                {
+                    GDALRasterBlock* poBlock =
+                        GetRasterBand(anBands[i])->GetLockedBlockRef(
+                            iX, iY, TRUE);
+                    if( poBlock == nullptr )
+                    {
+                        bOK = false;
+                        break;
+                    }
+                    apoBlocks.push_back(poBlock);
+                }
+                if( !bOK )
+                {
+                    for( size_t i = nFirstBlock; i < apoBlocks.size(); ++i )
+                    {
+                        apoBlocks[i]->DropLock();
+                        GetRasterBand(anBands[iJobBand + i - nFirstBlock])->
+                            FlushBlock(iX, iY, FALSE);
+                    }
+                    apoBlocks.resize(nFirstBlock);
+                    break;
+                }
+
+                GTiffDecompressionJob sJob;
+                memset(&sJob, 0, sizeof(sJob));
+                sJob.poDS = this;
+                sJob.bTIFFIsBigEndian = CPL_TO_BOOL( TIFFIsBigEndian(hTIFF) );
+                sJob.nPredictor = nPredictor;
+                sJob.nBlockId = nBlockId;
+                sJob.nBlockXOff = iX;
+                sJob.nBlockYOff = iY;
+                sJob.nBand = bSeparate ? anBands[iJobBand] : 0;
+                sJob.nOffset = nOffset;
+                sJob.nCompressedBufferSize = static_cast<int>(nSize);
+                sJob.nBlockBufSize = nBlockBufSize;
+                sJob.nBlockReqSize = nBlockReqSize;
+                asJobs.push_back(sJob);
+
+                nTotalCompressedSize += static_cast<size_t>(nSize);
+                nDecodedSize += nBlockBufSize;
+            }
+        }
+    }
+
+    if( asJobs.size() < 2 )
+    {
+        for( size_t i = 0; i < asJobs.size(); ++i )
+        {
+            for( size_t j = 0; j < nBandsPerJob; ++j )
+            {
+                GDALRasterBlock* poBlock = apoBlocks[i * nBandsPerJob + j];
+                poBlock->DropLock();
+                poBlock->GetBand()->FlushBlock(asJobs[i].nBlockXOff,
+                                               asJobs[i].nBlockYOff, FALSE);
+            }
+        }
+        return;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Fetch the compressed data of all blocks at once, in increasing  */
+/*      offset order.                                                   */
+/* -------------------------------------------------------------------- */
+    GByte* pabyCompressedData = static_cast<GByte*>(
+        VSI_MALLOC_VERBOSE(nTotalCompressedSize));
+    std::vector<size_t> anJobOrder;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+        anJobOrder.push_back(i);
+    std::sort(anJobOrder.begin(), anJobOrder.end(),
+              [&asJobs](size_t a, size_t b)
+              { return asJobs[a].nOffset < asJobs[b].nOffset; });
+
+    bool bReadOK = pabyCompressedData != nullptr;
+    if( bReadOK )
+    {
+        std::vector<vsi_l_offset> anOffsets;
+        std::vector<size_t> anSizes;
+        std::vector<void*> apData;
+        size_t nAccOffset = 0;
+        for( size_t i = 0; i < anJobOrder.size(); ++i )
+        {
+            GTiffDecompressionJob& sJob = asJobs[anJobOrder[i]];
+            sJob.pabyCompressedBuffer = pabyCompressedData + nAccOffset;
+            anOffsets.push_back(sJob.nOffset);
+            anSizes.push_back(sJob.nCompressedBufferSize);
+            apData.push_back(sJob.pabyCompressedBuffer);
+            nAccOffset += sJob.nCompressedBufferSize;
+        }
+        VSILFILE* fp = VSI_TIFFGetVSILFile(TIFFClientdata( hTIFF ));
+        bReadOK = VSIFReadMultiRangeL( static_cast<int>(anOffsets.size()),
+                                       &apData[0], &anOffsets[0],
+                                       &anSizes[0], fp ) == 0;
+    }
+
+/* -------------------------------------------------------------------- */
+/*      Decode in the worker threads.                                   */
+/* -------------------------------------------------------------------- */
+    std::vector<void*> apJobs;
+    if( bReadOK )
+    {
+        for( size_t i = 0; i < asJobs.size(); ++i )
+        {
+            GTiffDecompressionJob& sJob = asJobs[i];
+            sJob.pszTmpFilename =
+                CPLStrdup(CPLSPrintf("/vsimem/gtiff/thread/decompress/%p",
+                                     &sJob));
+            if( bSeparate || nBands == 1 )
+            {
+                sJob.pabyBuffer = static_cast<GByte*>(
+                    apoBlocks[i]->GetDataRef());
+            }
+            else
+            {
+                sJob.pabyBuffer = static_cast<GByte*>(
+                    VSI_MALLOC_VERBOSE(nBlockBufSize));
+                if( sJob.pabyBuffer == nullptr )
+                    continue;
+            }
+            apJobs.push_back(&sJob);
+        }
+        CPLDebug("GTiff", "Decoding %d blocks in worker threads",
+                 static_cast<int>(apJobs.size()));
+        GTiffDecompressionWait sWait;
+        sWait.nPendingJobs = apJobs.size();
+        for( size_t i = 0; i < apJobs.size(); ++i )
+            static_cast<GTiffDecompressionJob*>(apJobs[i])->psWait = &sWait;
+        if( !poThreadPool->SubmitJobs(ThreadDecompressionFunc, apJobs) )
+        {
+            for( size_t i = 0; i < apJobs.size(); ++i )
+                ThreadDecompressionFunc(apJobs[i]);
+        }
+        std::unique_lock<std::mutex> oLock(sWait.oMutex);
+        sWait.oCond.wait(oLock, [&sWait]{ return sWait.nPendingJobs == 0; });
+    }
+    VSIFree(pabyCompressedData);
+
+/* -------------------------------------------------------------------- */
+/*      Dispatch the decoded data into the block cache, and discard     */
+/*      the blocks that could not be decoded, so that IReadBlock()      */
+/*      handles (and reports) them.                                     */
+/* -------------------------------------------------------------------- */
+    const int nWordBytes = nBitsPerSample / 8;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        GTiffDecompressionJob& sJob = asJobs[i];
+        const bool bInterleaved = !(bSeparate || nBands == 1);
+        for( size_t j = 0; j < nBandsPerJob; ++j )
+        {
+            GDALRasterBlock* poBlock = apoBlocks[i * nBandsPerJob + j];
+            if( sJob.bSuccess && bInterleaved )
+            {
+                const int iBand = anBands[j];
+                GDALCopyWords(sJob.pabyBuffer + (iBand - 1) * nWordBytes,
+                              poBlock->GetDataType(), nBands * nWordBytes,
+                              poBlock->GetDataRef(), poBlock->GetDataType(),
+                              nWordBytes,
+                              nBlockXSize * nBlockYSize);
+            }
+            poBlock->DropLock();
+            if( !sJob.bSuccess )
+            {
+                poBlock->GetBand()->FlushBlock(sJob.nBlockXOff,
+                                               sJob.nBlockYOff, FALSE);
+            }
+        }
+        if( bInterleaved )
+            VSIFree(sJob.pabyBuffer);
+        CPLFree(sJob.pszTmpFilename);
+    }
+}
+
 /************************************************************************/
 /*                          DiscardLsb()                                */
 /************************************************************************/
@@ -18633,6 +19191,8 @@ void GDALDeregister_GTiff( GDALDriver * )
 
     delete gpoCompressThreadPool;
     gpoCompressThreadPool = nullptr;
+    delete gpoDecompressThreadPool;
+    gpoDecompressThreadPool = nullptr;
 }
 
 /************************************************************************/
@@ -18897,7 +19457,7 @@ void GDALRegister_GTiff()
     poDriver->SetMetadataItem( GDAL_DMD_CREATIONOPTIONLIST, osOptions );
     poDriver->SetMetadataItem( GDAL_DMD_OPENOPTIONLIST,
 "<OpenOptionList>"
-"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression. Can be set to ALL_CPUS' default='1'/>"
+"   <Option name='NUM_THREADS' type='string' description='Number of worker threads for compression/decompression. Can be set to ALL_CPUS' default='1'/>"
 "   <Option name='GEOTIFF_KEYS_FLAVOR' type='string-select' default='STANDARD' description='Which flavor of GeoTIFF keys must be used (for writing)'>"
 "       <Value>STANDARD</Value>"
 "       <Value>ESRI_PE</Value>"
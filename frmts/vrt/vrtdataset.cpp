@@ -31,6 +31,7 @@
 
 #include "cpl_minixml.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal_frmts.h"
 #include "ogr_spatialref.h"
 
@@ -1007,6 +1008,11 @@ CPLErr VRTDataset::AddBand( GDALDataType eType, char **papszOptions )
             if( pszLanguage != nullptr )
                 poDerivedBand->SetPixelFunctionLanguage(pszLanguage);
 
+            const char* pszCode =
+                CSLFetchNameValue(papszOptions, "PixelFunctionCode");
+            if( pszCode != nullptr )
+                poDerivedBand->SetPixelFunctionCode(pszCode);
+
             const char* pszTransferTypeName =
                 CSLFetchNameValue(papszOptions, "SourceTransferType");
             if( pszTransferTypeName != nullptr )
@@ -1584,20 +1590,34 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
         // they don't necessary instantiate all underlying rasterbands.
         VRTSourcedRasterBand* poBand = reinterpret_cast<VRTSourcedRasterBand *>(
             papoBands[nBands - 1] );
-        for( int iSource = 0;
-             eErr == CE_None && iSource < poBand->nSources;
-             iSource++ )
+        std::vector<int> anSources;
+        poBand->GetSourcesInWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+        if( poBand->ReadSourcesInParallel( nXOff, nYOff, nXSize, nYSize,
+                                           pData, nBufXSize, nBufYSize,
+                                           eBufType,
+                                           nBandCount, panBandMap,
+                                           nPixelSpace, nLineSpace,
+                                           nBandSpace, true,
+                                           psExtraArg, anSources, &eErr ) )
+        {
+            return eErr;
+        }
+
+        const int nCandidates = static_cast<int>(anSources.size());
+        for( int iCandidate = 0;
+             eErr == CE_None && iCandidate < nCandidates;
+             iCandidate++ )
         {
             psExtraArg->pfnProgress = GDALScaledProgress;
             psExtraArg->pProgressData =
                 GDALCreateScaledProgress(
-                    1.0 * iSource / poBand->nSources,
-                    1.0 * (iSource + 1) / poBand->nSources,
+                    1.0 * iCandidate / nCandidates,
+                    1.0 * (iCandidate + 1) / nCandidates,
                     pfnProgressGlobal,
                     pProgressDataGlobal );
 
             VRTSimpleSource* poSource = reinterpret_cast<VRTSimpleSource *>(
-                poBand->papoSources[iSource] );
+                poBand->papoSources[anSources[iCandidate]] );
 
             eErr = poSource->DatasetRasterIO( poBand->GetRasterDataType(),
                                               nXOff, nYOff, nXSize, nYSize,
@@ -1625,6 +1645,57 @@ CPLErr VRTDataset::IRasterIO( GDALRWFlag eRWFlag,
                                    psExtraArg );
 }
 
+/************************************************************************/
+/*                        GetSourceThreadPool()                         */
+/*                                                                      */
+/*      Return the pool used to read sources concurrently, or NULL      */
+/*      if the VRT_NUM_THREADS configuration option does not request    */
+/*      more than one thread. The pool is shared by all VRT datasets,   */
+/*      and sized by the value of VRT_NUM_THREADS when it is first      */
+/*      needed.                                                         */
+/************************************************************************/
+
+static CPLMutex* ghSourceThreadPoolMutex = nullptr;
+static bool gbSourceThreadPoolInitialized = false;
+static CPLWorkerThreadPool* gpoSourceThreadPool = nullptr;
+
+CPLWorkerThreadPool* VRTDataset::GetSourceThreadPool()
+{
+    const char* pszNumThreads =
+        CPLGetConfigOption("VRT_NUM_THREADS", nullptr);
+    if( pszNumThreads == nullptr )
+        return nullptr;
+
+    CPLMutexHolder oHolder(&ghSourceThreadPoolMutex);
+    if( !gbSourceThreadPoolInitialized )
+    {
+        gbSourceThreadPoolInitialized = true;
+        gpoSourceThreadPool =
+            CPLCreateWorkerThreadPool(CPLGetNumThreads(pszNumThreads));
+        if( gpoSourceThreadPool != nullptr )
+        {
+            CPLDebug("VRT", "Using %d threads to read sources",
+                     gpoSourceThreadPool->GetThreadCount());
+        }
+    }
+    return gpoSourceThreadPool;
+}
+
+/************************************************************************/
+/*                      CleanupSourceThreadPool()                       */
+/************************************************************************/
+
+void VRTDataset::CleanupSourceThreadPool()
+{
+    delete gpoSourceThreadPool;
+    gpoSourceThreadPool = nullptr;
+    gbSourceThreadPoolInitialized = false;
+
+    if( ghSourceThreadPoolMutex )
+        CPLDestroyMutex(ghSourceThreadPoolMutex);
+    ghSourceThreadPoolMutex = nullptr;
+}
+
 /************************************************************************/
 /*                  UnsetPreservedRelativeFilenames()                   */
 /************************************************************************/
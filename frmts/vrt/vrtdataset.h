@@ -34,6 +34,7 @@
 #ifndef DOXYGEN_SKIP
 
 #include "cpl_hash_set.h"
+#include "cpl_quad_tree.h"
 #include "gdal_pam.h"
 #include "gdal_priv.h"
 #include "gdal_rat.h"
@@ -131,6 +132,8 @@ VRTSource *VRTParseFilterSources( CPLXMLNode *psTree, const char *, void* pUniqu
 
 class VRTRasterBand;
 
+class CPLWorkerThreadPool;
+
 class CPL_DLL VRTDataset : public GDALDataset
 {
     friend class VRTRasterBand;
@@ -225,6 +228,9 @@ class CPL_DLL VRTDataset : public GDALDataset
 
     void                UnsetPreservedRelativeFilenames();
 
+    static CPLWorkerThreadPool *GetSourceThreadPool();
+    static void         CleanupSourceThreadPool();
+
     static int          Identify( GDALOpenInfo * );
     static GDALDataset *Open( GDALOpenInfo * );
     static GDALDataset *OpenXML( const char *, const char * = nullptr,
@@ -500,8 +506,14 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
     CPLString      m_osLastLocationInfo;
     char         **m_papszSourceList;
 
+    // Spatial index of the source destination windows, lazily built for
+    // bands with many sources.
+    CPLQuadTree   *m_hSourceIndex;
+    int            m_nSourceIndexCount;
+
     bool           CanUseSourcesMinMaxImplementations();
     void           CheckSource( VRTSimpleSource *poSS );
+    void           InvalidateSourceIndex();
 
   public:
     int            nSources;
@@ -521,6 +533,25 @@ class CPL_DLL VRTSourcedRasterBand : public VRTRasterBand
                               GSpacing nPixelSpace, GSpacing nLineSpace,
                               GDALRasterIOExtraArg* psExtraArg) override;
 
+    void           GetSourcesInWindow( int nXOff, int nYOff,
+                                       int nXSize, int nYSize,
+                                       std::vector<int>& anSources );
+
+    // Used by VRTDataset::IRasterIO() too, with bDatasetIO = true.
+    bool           ReadSourcesInParallel( int nXOff, int nYOff,
+                                          int nXSize, int nYSize,
+                                          void *pData,
+                                          int nBufXSize, int nBufYSize,
+                                          GDALDataType eBufType,
+                                          int nBandCount, int *panBandMap,
+                                          GSpacing nPixelSpace,
+                                          GSpacing nLineSpace,
+                                          GSpacing nBandSpace,
+                                          bool bDatasetIO,
+                                          GDALRasterIOExtraArg* psExtraArg,
+                                          const std::vector<int>& anSources,
+                                          CPLErr *peErr );
+
     virtual int IGetDataCoverageStatus( int nXOff, int nYOff,
                                         int nXSize, int nYSize,
                                         int nMaskFlagStop,
@@ -667,6 +698,7 @@ class CPL_DLL VRTDerivedRasterBand : public VRTSourcedRasterBand
 {
     VRTDerivedRasterBandPrivateData* m_poPrivate;
     bool InitializePython();
+    bool CompileExpression();
 
  public:
     char *pszFuncName;
@@ -694,6 +726,7 @@ class CPL_DLL VRTDerivedRasterBand : public VRTSourcedRasterBand
     void SetPixelFunctionName( const char *pszFuncName );
     void SetSourceTransferType( GDALDataType eDataType );
     void SetPixelFunctionLanguage( const char* pszLanguage );
+    void SetPixelFunctionCode( const char* pszCode );
 
     virtual CPLErr         XMLInit( CPLXMLNode *, const char *, void* ) override;
     virtual CPLXMLNode *   SerializeToXML( const char *pszVRTPath ) override;
@@ -815,7 +848,31 @@ protected:
     CPLString           m_osSourceFileNameOri;
     int                 m_nExplicitSharedStatus; // -1 unknown, 0 = unshared, 1 = shared
 
-    int                 NeedMaxValAdjustment() const;
+    // When XMLInit() finds complete SourceProperties, the creation of the
+    // proxy dataset is deferred until the source band is first needed.
+    bool                m_bDeferredSource;
+    CPLString           m_osDeferredDSName;
+    CPLString           m_osDeferredOwner;
+    char              **m_papszDeferredOpenOptions;
+    int                 m_nDeferredBand;
+    bool                m_bDeferredMaskBand;
+    bool                m_bDeferredShared;
+    int                 m_nDeferredRasterXSize;
+    int                 m_nDeferredRasterYSize;
+    GDALDataType        m_eDeferredDataType;
+    int                 m_nDeferredBlockXSize;
+    int                 m_nDeferredBlockYSize;
+
+    bool                OpenDeferredSource();
+
+    int                 NeedMaxValAdjustment();
+
+    GDALRasterBand     *GetRasterBand()
+        { return m_bDeferredSource && !OpenDeferredSource() ?
+                                            nullptr : m_poRasterBand; }
+    GDALRasterBand     *GetMaskBandMainBand()
+        { return m_bDeferredSource && !OpenDeferredSource() ?
+                                            nullptr : m_poMaskBandMainBand; }
 
 public:
             VRTSimpleSource();
@@ -31,6 +31,7 @@
 #include "cpl_minixml.h"
 #include "cpl_string.h"
 #include "vrtdataset.h"
+#include "vrtexpression.h"
 #include "cpl_multiproc.h"
 #include "cpl_spawn.h"
 
@@ -59,6 +60,10 @@ CPL_CVSID("$Id: vrtderivedrasterband.cpp 56578e74c2851abf597312e07504cfe639cceed
 #define GDAL_VRT_ENABLE_PYTHON_DEFAULT "TRUSTED_MODULES"
 #endif
 
+// Number of pixels an expression is evaluated on at a time, so that the
+// intermediate columns stay in cache.
+static const int VRT_EXPRESSION_CHUNK_SIZE = 1024;
+
 static std::map<CPLString, GDALDerivedPixelFunc> osMapPixelFunction;
 static bool gbHasInitializedPython = false;
 static int gnPythonInstanceCounter = 0;
@@ -858,6 +863,7 @@ class VRTDerivedRasterBandPrivateData
         bool      m_bExclusiveLock;
         bool      m_bFirstTime;
         std::vector< std::pair<CPLString,CPLString> > m_oFunctionArgs;
+        VRTExpression* m_poExpression;
 
         VRTDerivedRasterBandPrivateData():
             m_osLanguage("C"),
@@ -867,12 +873,14 @@ class VRTDerivedRasterBandPrivateData
             m_bPythonInitializationDone(false),
             m_bPythonInitializationSuccess(false),
             m_bExclusiveLock(false),
-            m_bFirstTime(true)
+            m_bFirstTime(true),
+            m_poExpression(nullptr)
         {
         }
 
         virtual ~VRTDerivedRasterBandPrivateData()
         {
+            delete m_poExpression;
             if( m_poGDALCreateNumpyArray )
                 Py_DecRef(m_poGDALCreateNumpyArray);
             if( m_poUserFunction )
@@ -1106,8 +1114,8 @@ void VRTDerivedRasterBand::SetPixelFunctionName( const char *pszFuncNameIn )
 /**
  * Set the language of the pixel function.
  *
- * @param pszLanguage Language of the pixel function (only "C" and "Python"
- * are supported currently)
+ * @param pszLanguage Language of the pixel function ("C", "Python" or
+ * "Expression")
  * @since GDAL 2.3
  */
 void VRTDerivedRasterBand::SetPixelFunctionLanguage( const char* pszLanguage )
@@ -1115,6 +1123,58 @@ void VRTDerivedRasterBand::SetPixelFunctionLanguage( const char* pszLanguage )
     m_poPrivate->m_osLanguage = pszLanguage;
 }
 
+/************************************************************************/
+/*                         SetPixelFunctionCode()                       */
+/************************************************************************/
+
+/**
+ * Set the code of the pixel function, that is the in-lined Python module
+ * or the expression, depending on the pixel function language.
+ *
+ * @param pszCode Code of the pixel function.
+ */
+void VRTDerivedRasterBand::SetPixelFunctionCode( const char* pszCode )
+{
+    m_poPrivate->m_osCode = pszCode ? pszCode : "";
+    delete m_poPrivate->m_poExpression;
+    m_poPrivate->m_poExpression = nullptr;
+}
+
+/************************************************************************/
+/*                          CompileExpression()                         */
+/************************************************************************/
+
+bool VRTDerivedRasterBand::CompileExpression()
+{
+    if( m_poPrivate->m_poExpression != nullptr )
+        return true;
+
+    if( m_poPrivate->m_osCode.empty() )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "PixelFunctionCode must be set with the Expression "
+                 "PixelFunctionLanguage");
+        return false;
+    }
+
+    VRTExpression* poExpression = new VRTExpression();
+    if( !poExpression->Compile(m_poPrivate->m_osCode) )
+    {
+        delete poExpression;
+        return false;
+    }
+    if( poExpression->GetMaxBand() > nSources )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Expression references B%d, but there are only %d sources",
+                 poExpression->GetMaxBand(), nSources);
+        delete poExpression;
+        return false;
+    }
+    m_poPrivate->m_poExpression = poExpression;
+    return true;
+}
+
 /************************************************************************/
 /*                         SetSourceTransferType()                      */
 /************************************************************************/
@@ -1551,10 +1611,26 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         return CE_Failure;
     }
 
+    const VRTExpression* poExpression = nullptr;
+    if( EQUAL(m_poPrivate->m_osLanguage, "Expression") )
+    {
+        if( !CompileExpression() )
+            return CE_Failure;
+        poExpression = m_poPrivate->m_poExpression;
+    }
+
     const int nBufTypeSize = GDALGetDataTypeSizeBytes(eBufType);
     GDALDataType eSrcType = eSourceTransferType;
     if( eSrcType == GDT_Unknown || eSrcType >= GDT_TypeCount ) {
-        eSrcType = eBufType;
+        // Expressions are evaluated on doubles, so fetch the sources as
+        // such: this avoids a conversion, and clamping to the buffer type.
+        eSrcType = poExpression ? GDT_Float64 : eBufType;
+    }
+    else if( poExpression && GDALDataTypeIsComplex(eSrcType) )
+    {
+        CPLError(CE_Failure, CPLE_NotSupported,
+                 "Complex SourceTransferType not supported with Expression");
+        return CE_Failure;
     }
     const int nSrcTypeSize = GDALGetDataTypeSizeBytes(eSrcType);
 
@@ -1633,6 +1709,13 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     void **pBuffers
         = reinterpret_cast<void **>( CPLMalloc(sizeof(void *) * nSources) );
     for( int iSource = 0; iSource < nSources; iSource++ ) {
+        // Sources not referenced by the expression are neither allocated
+        // nor read.
+        if( poExpression && !poExpression->IsBandUsed(iSource + 1) )
+        {
+            pBuffers[iSource] = nullptr;
+            continue;
+        }
         pBuffers[iSource] =
             VSI_MALLOC3_VERBOSE(nSrcTypeSize, nExtBufXSize, nExtBufYSize);
         if( pBuffers[iSource] == nullptr )
@@ -1732,6 +1815,8 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
     // Load values for sources into packed buffers.
     CPLErr eErr = CE_None;
     for( int iSource = 0; iSource < nSources && eErr == CE_None; iSource++ ) {
+        if( pBuffers[iSource] == nullptr )
+            continue;
         GByte* pabyBuffer = reinterpret_cast<GByte*>(pBuffers[iSource]);
         eErr = reinterpret_cast<VRTSource *>( papoSources[iSource] )->RasterIO(
             eSrcType,
@@ -1941,6 +2026,62 @@ CPLErr VRTDerivedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             VSIFree(pabyTmpBuffer);
         }
     }
+    else if( eErr == CE_None && poExpression != nullptr )
+    {
+        // Evaluate the expression on chunks of lines, fetching the source
+        // columns in place when they are already doubles.
+        const int nBands = poExpression->GetMaxBand();
+        const int nChunkSize = std::min(nBufXSize, VRT_EXPRESSION_CHUNK_SIZE);
+        std::vector<double> adfScratch(
+            static_cast<size_t>(std::max(1, poExpression->GetMaxStackDepth())) *
+                                                                nChunkSize);
+        std::vector<double> adfSrc;
+        if( eSrcType != GDT_Float64 )
+            adfSrc.resize(static_cast<size_t>(nBands) * nChunkSize);
+        std::vector<const double*> apadfBands(nBands);
+
+        for( int iY = 0; iY < nBufYSize; iY++ )
+        {
+            for( int iX = 0; iX < nBufXSize; iX += nChunkSize )
+            {
+                const int nCount = std::min(nChunkSize, nBufXSize - iX);
+                const size_t nOffset =
+                    static_cast<size_t>(iY) * nBufXSize + iX;
+                for( int iBand = 0; iBand < nBands; iBand++ )
+                {
+                    if( pBuffers[iBand] == nullptr )
+                        continue;
+                    if( eSrcType == GDT_Float64 )
+                    {
+                        apadfBands[iBand] =
+                            static_cast<const double*>(pBuffers[iBand]) +
+                                                                    nOffset;
+                    }
+                    else
+                    {
+                        double* padfSrc =
+                            &adfSrc[static_cast<size_t>(iBand) * nChunkSize];
+                        GDALCopyWords(
+                            static_cast<GByte*>(pBuffers[iBand]) +
+                                                    nOffset * nSrcTypeSize,
+                            eSrcType, nSrcTypeSize,
+                            padfSrc, GDT_Float64, sizeof(double),
+                            nCount);
+                        apadfBands[iBand] = padfSrc;
+                    }
+                }
+
+                const double* padfResult = poExpression->Evaluate(
+                    nBands ? &apadfBands[0] : nullptr, nCount,
+                    &adfScratch[0]);
+                GDALCopyWords(padfResult, GDT_Float64, sizeof(double),
+                              static_cast<GByte*>(pData) + iY * nLineSpace +
+                                                        iX * nPixelSpace,
+                              eBufType, static_cast<int>(nPixelSpace),
+                              nCount);
+            }
+        }
+    }
     else if( eErr == CE_None && pfnPixelFunc != nullptr ) {
         eErr = pfnPixelFunc( reinterpret_cast<void **>( pBuffers ), nSources,
                              pData, nBufXSize, nBufYSize,
@@ -1987,34 +2128,43 @@ CPLErr VRTDerivedRasterBand::XMLInit( CPLXMLNode *psTree,
     if( eErr != CE_None )
         return eErr;
 
-    // Read derived pixel function type.
-    SetPixelFunctionName( CPLGetXMLValue( psTree, "PixelFunctionType", nullptr ) );
-    if( pszFuncName == nullptr || EQUAL(pszFuncName, "") )
-    {
-        CPLError(CE_Failure, CPLE_AppDefined,
-                 "PixelFunctionType missing");
-        return CE_Failure;
-    }
-
     m_poPrivate->m_osLanguage = CPLGetXMLValue( psTree,
                                                 "PixelFunctionLanguage", "C" );
     if( !EQUAL(m_poPrivate->m_osLanguage, "C") &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") &&
+        !EQUAL(m_poPrivate->m_osLanguage, "Expression") )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
                  "Unsupported PixelFunctionLanguage");
         return CE_Failure;
     }
+    const bool bExpression = EQUAL(m_poPrivate->m_osLanguage, "Expression");
+
+    // Read derived pixel function type, which is purely informative for
+    // expressions.
+    const char* pszFuncType =
+        CPLGetXMLValue( psTree, "PixelFunctionType", nullptr );
+    if( pszFuncType != nullptr )
+        SetPixelFunctionName( pszFuncType );
+    if( !bExpression && (pszFuncName == nullptr || EQUAL(pszFuncName, "")) )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "PixelFunctionType missing");
+        return CE_Failure;
+    }
 
-    m_poPrivate->m_osCode =
-                        CPLGetXMLValue( psTree, "PixelFunctionCode", "" );
+    SetPixelFunctionCode( CPLGetXMLValue( psTree, "PixelFunctionCode", "" ) );
     if( !m_poPrivate->m_osCode.empty() &&
-        !EQUAL(m_poPrivate->m_osLanguage, "Python") )
+        !EQUAL(m_poPrivate->m_osLanguage, "Python") && !bExpression )
     {
         CPLError(CE_Failure, CPLE_NotSupported,
-                 "PixelFunctionCode can only be used with Python");
+                 "PixelFunctionCode can only be used with Python or "
+                 "Expression");
         return CE_Failure;
     }
+    // Compile now so that syntax errors are reported when opening.
+    if( bExpression && !CompileExpression() )
+        return CE_Failure;
 
     m_poPrivate->m_nBufferRadius =
                         atoi(CPLGetXMLValue( psTree, "BufferRadius", "0" ));
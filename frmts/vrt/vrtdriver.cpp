@@ -62,6 +62,7 @@ VRTDriver::~VRTDriver()
 {
     CSLDestroy( papszSourceParsers );
     VRTDerivedRasterBand::Cleanup();
+    VRTDataset::CleanupSourceThreadPool();
 #if 0
     if(  pDeserializerData )
     {
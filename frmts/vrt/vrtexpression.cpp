@@ -0,0 +1,839 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Arithmetic expressions evaluated by VRTDerivedRasterBand.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "vrtexpression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "cpl_conv.h"
+#include "cpl_error.h"
+#include "cpl_string.h"
+
+CPL_CVSID("$Id$")
+
+// Bounds protecting the recursive descent parser and the fixed size
+// evaluation stack against pathological expressions.
+static const int MAX_NESTING_DEPTH = 64;
+static const int MAX_STACK_DEPTH = 64;
+
+/************************************************************************/
+/*                          Math functions                              */
+/*                                                                      */
+/*      Wrapped so that we get a single, non overloaded, address.       */
+/************************************************************************/
+
+static double VRTExprAbs( double x ) { return fabs(x); }
+static double VRTExprSqrt( double x ) { return sqrt(x); }
+static double VRTExprExp( double x ) { return exp(x); }
+static double VRTExprLog( double x ) { return log(x); }
+static double VRTExprLog10( double x ) { return log10(x); }
+static double VRTExprSin( double x ) { return sin(x); }
+static double VRTExprCos( double x ) { return cos(x); }
+static double VRTExprTan( double x ) { return tan(x); }
+static double VRTExprAsin( double x ) { return asin(x); }
+static double VRTExprAcos( double x ) { return acos(x); }
+static double VRTExprAtan( double x ) { return atan(x); }
+static double VRTExprFloor( double x ) { return floor(x); }
+static double VRTExprCeil( double x ) { return ceil(x); }
+static double VRTExprRound( double x ) { return std::round(x); }
+static double VRTExprIsNan( double x ) { return CPLIsNan(x) ? 1.0 : 0.0; }
+
+static double VRTExprMin( double x, double y ) { return std::fmin(x, y); }
+static double VRTExprMax( double x, double y ) { return std::fmax(x, y); }
+static double VRTExprPow( double x, double y ) { return pow(x, y); }
+static double VRTExprAtan2( double x, double y ) { return atan2(x, y); }
+static double VRTExprFmod( double x, double y ) { return fmod(x, y); }
+static double VRTExprHypot( double x, double y ) { return std::hypot(x, y); }
+
+typedef struct
+{
+    const char *pszName;
+    double (*pfnFunc1)(double);
+    double (*pfnFunc2)(double, double);
+} VRTExprFunction;
+
+static const VRTExprFunction asFunctions[] =
+{
+    { "abs", VRTExprAbs, nullptr },
+    { "sqrt", VRTExprSqrt, nullptr },
+    { "exp", VRTExprExp, nullptr },
+    { "log", VRTExprLog, nullptr },
+    { "log10", VRTExprLog10, nullptr },
+    { "sin", VRTExprSin, nullptr },
+    { "cos", VRTExprCos, nullptr },
+    { "tan", VRTExprTan, nullptr },
+    { "asin", VRTExprAsin, nullptr },
+    { "acos", VRTExprAcos, nullptr },
+    { "atan", VRTExprAtan, nullptr },
+    { "floor", VRTExprFloor, nullptr },
+    { "ceil", VRTExprCeil, nullptr },
+    { "round", VRTExprRound, nullptr },
+    { "isnan", VRTExprIsNan, nullptr },
+    { "min", nullptr, VRTExprMin },
+    { "max", nullptr, VRTExprMax },
+    { "pow", nullptr, VRTExprPow },
+    { "atan2", nullptr, VRTExprAtan2 },
+    { "fmod", nullptr, VRTExprFmod },
+    { "hypot", nullptr, VRTExprHypot },
+};
+
+/************************************************************************/
+/*                            Column kernels                            */
+/************************************************************************/
+
+namespace {
+
+struct AddOp { static double Calc(double a, double b) { return a + b; } };
+struct SubOp { static double Calc(double a, double b) { return a - b; } };
+struct MulOp { static double Calc(double a, double b) { return a * b; } };
+struct DivOp { static double Calc(double a, double b) { return a / b; } };
+struct LtOp { static double Calc(double a, double b) { return a < b; } };
+struct LeOp { static double Calc(double a, double b) { return a <= b; } };
+struct GtOp { static double Calc(double a, double b) { return a > b; } };
+struct GeOp { static double Calc(double a, double b) { return a >= b; } };
+struct EqOp { static double Calc(double a, double b) { return a == b; } };
+struct NeOp { static double Calc(double a, double b) { return a != b; } };
+struct AndOp
+{
+    static double Calc(double a, double b) { return a != 0.0 && b != 0.0; }
+};
+struct OrOp
+{
+    static double Calc(double a, double b) { return a != 0.0 || b != 0.0; }
+};
+
+} // namespace
+
+// padfOut may alias padfA, but not padfB.
+template<class Op> static void ApplyBinary( const double* padfA,
+                                            const double* padfB,
+                                            double* padfOut, int nCount )
+{
+    for( int i = 0; i < nCount; i++ )
+        padfOut[i] = Op::Calc(padfA[i], padfB[i]);
+}
+
+/************************************************************************/
+/*                          VRTExprParser                               */
+/************************************************************************/
+
+namespace {
+
+class VRTExprParser
+{
+    const char* m_pszExpr;
+    const char* m_pszCur;
+    std::vector<VRTExpression::Instruction>& m_aoProgram;
+    int         m_nNesting;
+    int         m_nStackDepth;
+    bool        m_bError;
+
+  public:
+    int         m_nMaxStackDepth;
+    int         m_nMaxBand;
+
+    VRTExprParser( const char* pszExpr,
+                   std::vector<VRTExpression::Instruction>& aoProgram ) :
+        m_pszExpr(pszExpr), m_pszCur(pszExpr), m_aoProgram(aoProgram),
+        m_nNesting(0), m_nStackDepth(0), m_bError(false),
+        m_nMaxStackDepth(0), m_nMaxBand(0) {}
+
+    bool Parse();
+
+  private:
+    void Error( const char* pszMsg );
+    void SkipSpaces();
+    bool Accept( const char* pszToken );
+    void Emit( VRTExpression::Opcode eOp, double dfValue = 0.0,
+               int nBand = 0, double (*pfnFunc1)(double) = nullptr,
+               double (*pfnFunc2)(double, double) = nullptr );
+    void FoldConstants( int nArity );
+
+    void ParseTernary();
+    void ParseOr();
+    void ParseAnd();
+    void ParseEquality();
+    void ParseRelational();
+    void ParseAdditive();
+    void ParseMultiplicative();
+    void ParseUnary();
+    void ParsePower();
+    void ParsePrimary();
+    void ParseIdentifier();
+    int  ParseArguments();
+};
+
+} // namespace
+
+void VRTExprParser::Error( const char* pszMsg )
+{
+    if( m_bError )
+        return;
+    m_bError = true;
+    CPLError(CE_Failure, CPLE_AppDefined,
+             "Invalid expression \"%s\": %s at offset %d",
+             m_pszExpr, pszMsg, static_cast<int>(m_pszCur - m_pszExpr));
+}
+
+void VRTExprParser::SkipSpaces()
+{
+    while( *m_pszCur == ' ' || *m_pszCur == '\t' ||
+           *m_pszCur == '\r' || *m_pszCur == '\n' )
+        m_pszCur++;
+}
+
+bool VRTExprParser::Accept( const char* pszToken )
+{
+    SkipSpaces();
+    const size_t nLen = strlen(pszToken);
+    if( strncmp(m_pszCur, pszToken, nLen) != 0 )
+        return false;
+    m_pszCur += nLen;
+    return true;
+}
+
+/************************************************************************/
+/*                                Emit()                                */
+/************************************************************************/
+
+void VRTExprParser::Emit( VRTExpression::Opcode eOp, double dfValue,
+                          int nBand, double (*pfnFunc1)(double),
+                          double (*pfnFunc2)(double, double) )
+{
+    if( m_bError )
+        return;
+
+    VRTExpression::Instruction sInstr;
+    sInstr.eOp = eOp;
+    sInstr.dfValue = dfValue;
+    sInstr.nBand = nBand;
+    sInstr.pfnFunc1 = pfnFunc1;
+    sInstr.pfnFunc2 = pfnFunc2;
+    m_aoProgram.push_back(sInstr);
+
+    int nArity = 0;
+    switch( eOp )
+    {
+        case VRTExpression::OP_CONST:
+        case VRTExpression::OP_BAND:
+            m_nStackDepth++;
+            if( m_nStackDepth > MAX_STACK_DEPTH )
+            {
+                Error("expression too complex");
+                return;
+            }
+            m_nMaxStackDepth = std::max(m_nMaxStackDepth, m_nStackDepth);
+            return;
+
+        case VRTExpression::OP_NEG:
+        case VRTExpression::OP_NOT:
+        case VRTExpression::OP_FUNC1:
+            nArity = 1;
+            break;
+
+        case VRTExpression::OP_SELECT:
+            nArity = 3;
+            break;
+
+        default:
+            nArity = 2;
+            break;
+    }
+    m_nStackDepth -= nArity - 1;
+    FoldConstants(nArity);
+}
+
+/************************************************************************/
+/*                           FoldConstants()                            */
+/*                                                                      */
+/*      If all the operands of the instruction just emitted are         */
+/*      constants, evaluate it now and replace it, and its operands,    */
+/*      by a single constant.                                           */
+/************************************************************************/
+
+void VRTExprParser::FoldConstants( int nArity )
+{
+    const size_t nInstr = m_aoProgram.size();
+    if( nInstr < static_cast<size_t>(nArity) + 1 )
+        return;
+    for( int i = 1; i <= nArity; i++ )
+    {
+        if( m_aoProgram[nInstr - 1 - i].eOp != VRTExpression::OP_CONST )
+            return;
+    }
+
+    const VRTExpression::Instruction* pasOperands =
+        &m_aoProgram[nInstr - 1 - nArity];
+    const double a = pasOperands[0].dfValue;
+    const double b = nArity >= 2 ? pasOperands[1].dfValue : 0.0;
+    const double c = nArity >= 3 ? pasOperands[2].dfValue : 0.0;
+    const VRTExpression::Instruction& sOp = m_aoProgram[nInstr - 1];
+    double dfRes = 0.0;
+    switch( sOp.eOp )
+    {
+        case VRTExpression::OP_NEG: dfRes = -a; break;
+        case VRTExpression::OP_NOT: dfRes = a == 0.0; break;
+        case VRTExpression::OP_ADD: dfRes = AddOp::Calc(a, b); break;
+        case VRTExpression::OP_SUB: dfRes = SubOp::Calc(a, b); break;
+        case VRTExpression::OP_MUL: dfRes = MulOp::Calc(a, b); break;
+        case VRTExpression::OP_DIV: dfRes = DivOp::Calc(a, b); break;
+        case VRTExpression::OP_MOD: dfRes = fmod(a, b); break;
+        case VRTExpression::OP_POW: dfRes = pow(a, b); break;
+        case VRTExpression::OP_LT: dfRes = LtOp::Calc(a, b); break;
+        case VRTExpression::OP_LE: dfRes = LeOp::Calc(a, b); break;
+        case VRTExpression::OP_GT: dfRes = GtOp::Calc(a, b); break;
+        case VRTExpression::OP_GE: dfRes = GeOp::Calc(a, b); break;
+        case VRTExpression::OP_EQ: dfRes = EqOp::Calc(a, b); break;
+        case VRTExpression::OP_NE: dfRes = NeOp::Calc(a, b); break;
+        case VRTExpression::OP_AND: dfRes = AndOp::Calc(a, b); break;
+        case VRTExpression::OP_OR: dfRes = OrOp::Calc(a, b); break;
+        case VRTExpression::OP_SELECT: dfRes = a != 0.0 ? b : c; break;
+        case VRTExpression::OP_FUNC1: dfRes = sOp.pfnFunc1(a); break;
+        case VRTExpression::OP_FUNC2: dfRes = sOp.pfnFunc2(a, b); break;
+        default:
+            return;
+    }
+
+    m_aoProgram.resize(nInstr - (nArity + 1));
+    VRTExpression::Instruction sInstr;
+    sInstr.eOp = VRTExpression::OP_CONST;
+    sInstr.dfValue = dfRes;
+    sInstr.nBand = 0;
+    sInstr.pfnFunc1 = nullptr;
+    sInstr.pfnFunc2 = nullptr;
+    m_aoProgram.push_back(sInstr);
+}
+
+/************************************************************************/
+/*                               Parse()                                */
+/************************************************************************/
+
+bool VRTExprParser::Parse()
+{
+    ParseTernary();
+    SkipSpaces();
+    if( !m_bError && *m_pszCur != '\0' )
+        Error("unexpected character");
+    if( !m_bError && m_aoProgram.empty() )
+        Error("empty expression");
+    return !m_bError;
+}
+
+// expr := or [ '?' expr ':' expr ]
+void VRTExprParser::ParseTernary()
+{
+    if( ++m_nNesting > MAX_NESTING_DEPTH )
+    {
+        Error("expression too deeply nested");
+        return;
+    }
+    ParseOr();
+    if( !m_bError && Accept("?") )
+    {
+        ParseTernary();
+        if( !m_bError && !Accept(":") )
+            Error("':' expected");
+        ParseTernary();
+        Emit(VRTExpression::OP_SELECT);
+    }
+    m_nNesting--;
+}
+
+void VRTExprParser::ParseOr()
+{
+    ParseAnd();
+    while( !m_bError && Accept("||") )
+    {
+        ParseAnd();
+        Emit(VRTExpression::OP_OR);
+    }
+}
+
+void VRTExprParser::ParseAnd()
+{
+    ParseEquality();
+    while( !m_bError && Accept("&&") )
+    {
+        ParseEquality();
+        Emit(VRTExpression::OP_AND);
+    }
+}
+
+void VRTExprParser::ParseEquality()
+{
+    ParseRelational();
+    while( !m_bError )
+    {
+        if( Accept("==") )
+        {
+            ParseRelational();
+            Emit(VRTExpression::OP_EQ);
+        }
+        else if( Accept("!=") )
+        {
+            ParseRelational();
+            Emit(VRTExpression::OP_NE);
+        }
+        else
+            break;
+    }
+}
+
+void VRTExprParser::ParseRelational()
+{
+    ParseAdditive();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("<=") )
+            eOp = VRTExpression::OP_LE;
+        else if( Accept(">=") )
+            eOp = VRTExpression::OP_GE;
+        else if( Accept("<") )
+            eOp = VRTExpression::OP_LT;
+        else if( Accept(">") )
+            eOp = VRTExpression::OP_GT;
+        else
+            break;
+        ParseAdditive();
+        Emit(eOp);
+    }
+}
+
+void VRTExprParser::ParseAdditive()
+{
+    ParseMultiplicative();
+    while( !m_bError )
+    {
+        if( Accept("+") )
+        {
+            ParseMultiplicative();
+            Emit(VRTExpression::OP_ADD);
+        }
+        else if( Accept("-") )
+        {
+            ParseMultiplicative();
+            Emit(VRTExpression::OP_SUB);
+        }
+        else
+            break;
+    }
+}
+
+void VRTExprParser::ParseMultiplicative()
+{
+    ParseUnary();
+    while( !m_bError )
+    {
+        VRTExpression::Opcode eOp;
+        if( Accept("*") )
+            eOp = VRTExpression::OP_MUL;
+        else if( Accept("/") )
+            eOp = VRTExpression::OP_DIV;
+        else if( Accept("%") )
+            eOp = VRTExpression::OP_MOD;
+        else
+            break;
+        ParseUnary();
+        Emit(eOp);
+    }
+}
+
+// Unary operators bind less tightly than '^', so that -2^2 == -4.
+void VRTExprParser::ParseUnary()
+{
+    if( ++m_nNesting > MAX_NESTING_DEPTH )
+    {
+        Error("expression too deeply nested");
+        return;
+    }
+    SkipSpaces();
+    if( m_pszCur[0] == '!' && m_pszCur[1] != '=' )
+    {
+        m_pszCur++;
+        ParseUnary();
+        Emit(VRTExpression::OP_NOT);
+    }
+    else if( Accept("-") )
+    {
+        ParseUnary();
+        Emit(VRTExpression::OP_NEG);
+    }
+    else if( Accept("+") )
+    {
+        ParseUnary();
+    }
+    else
+    {
+        ParsePower();
+    }
+    m_nNesting--;
+}
+
+// Right associative: 2^3^2 == 2^9.
+void VRTExprParser::ParsePower()
+{
+    ParsePrimary();
+    if( !m_bError && Accept("^") )
+    {
+        ParseUnary();
+        Emit(VRTExpression::OP_POW);
+    }
+}
+
+void VRTExprParser::ParsePrimary()
+{
+    SkipSpaces();
+    const char ch = *m_pszCur;
+    if( (ch >= '0' && ch <= '9') ||
+        (ch == '.' && m_pszCur[1] >= '0' && m_pszCur[1] <= '9') )
+    {
+        char* pszEnd = nullptr;
+        const double dfValue = CPLStrtod(m_pszCur, &pszEnd);
+        m_pszCur = pszEnd;
+        Emit(VRTExpression::OP_CONST, dfValue);
+    }
+    else if( (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') ||
+             ch == '_' )
+    {
+        ParseIdentifier();
+    }
+    else if( Accept("(") )
+    {
+        ParseTernary();
+        if( !m_bError && !Accept(")") )
+            Error("')' expected");
+    }
+    else
+    {
+        Error(ch == '\0' ? "unexpected end of expression" :
+                           "unexpected character");
+    }
+}
+
+/************************************************************************/
+/*                          ParseIdentifier()                           */
+/*                                                                      */
+/*      Band references (B1, B2...), constants and function calls.      */
+/************************************************************************/
+
+void VRTExprParser::ParseIdentifier()
+{
+    const char* pszStart = m_pszCur;
+    while( (*m_pszCur >= 'a' && *m_pszCur <= 'z') ||
+           (*m_pszCur >= 'A' && *m_pszCur <= 'Z') ||
+           (*m_pszCur >= '0' && *m_pszCur <= '9') || *m_pszCur == '_' )
+        m_pszCur++;
+    const CPLString osName(pszStart, m_pszCur - pszStart);
+
+    if( (osName[0] == 'B' || osName[0] == 'b') && osName.size() > 1 &&
+        osName.size() <= 6 &&
+        osName.find_first_not_of("0123456789", 1) == std::string::npos )
+    {
+        const int nBand = atoi(osName.c_str() + 1);
+        if( nBand < 1 )
+        {
+            m_pszCur = pszStart;
+            Error("band references start at B1");
+            return;
+        }
+        m_nMaxBand = std::max(m_nMaxBand, nBand);
+        Emit(VRTExpression::OP_BAND, 0.0, nBand);
+        return;
+    }
+
+    if( EQUAL(osName, "pi") )
+    {
+        Emit(VRTExpression::OP_CONST, M_PI);
+        return;
+    }
+    if( EQUAL(osName, "nan") )
+    {
+        Emit(VRTExpression::OP_CONST,
+             std::numeric_limits<double>::quiet_NaN());
+        return;
+    }
+
+    SkipSpaces();
+    if( *m_pszCur != '(' )
+    {
+        m_pszCur = pszStart;
+        Error("unknown identifier");
+        return;
+    }
+    m_pszCur++;
+
+    if( EQUAL(osName, "if") )
+    {
+        if( ParseArguments() != 3 )
+        {
+            Error("if() takes 3 arguments");
+            return;
+        }
+        Emit(VRTExpression::OP_SELECT);
+        return;
+    }
+
+    for( size_t i = 0; i < CPL_ARRAYSIZE(asFunctions); i++ )
+    {
+        if( !EQUAL(osName, asFunctions[i].pszName) )
+            continue;
+        const int nExpected = asFunctions[i].pfnFunc1 ? 1 : 2;
+        if( ParseArguments() != nExpected )
+        {
+            Error(CPLSPrintf("%s() takes %d argument%s",
+                             asFunctions[i].pszName, nExpected,
+                             nExpected > 1 ? "s" : ""));
+            return;
+        }
+        if( nExpected == 1 )
+            Emit(VRTExpression::OP_FUNC1, 0.0, 0, asFunctions[i].pfnFunc1);
+        else
+            Emit(VRTExpression::OP_FUNC2, 0.0, 0, nullptr,
+                 asFunctions[i].pfnFunc2);
+        return;
+    }
+
+    m_pszCur = pszStart;
+    Error("unknown function");
+}
+
+// Parses "arg[, arg]*)" after the opening parenthesis.
+int VRTExprParser::ParseArguments()
+{
+    int nArgs = 0;
+    if( Accept(")") )
+        return 0;
+    while( !m_bError )
+    {
+        ParseTernary();
+        nArgs++;
+        if( m_bError || Accept(")") )
+            break;
+        if( !Accept(",") )
+        {
+            Error("',' or ')' expected");
+            break;
+        }
+    }
+    return m_bError ? -1 : nArgs;
+}
+
+/************************************************************************/
+/* ==================================================================== */
+/*                            VRTExpression                             */
+/* ==================================================================== */
+/************************************************************************/
+
+VRTExpression::VRTExpression() :
+    m_nMaxStackDepth(0),
+    m_nMaxBand(0)
+{}
+
+/************************************************************************/
+/*                              Compile()                               */
+/************************************************************************/
+
+bool VRTExpression::Compile( const char* pszExpression )
+{
+    m_aoProgram.clear();
+    m_nMaxStackDepth = 0;
+    m_nMaxBand = 0;
+    m_abBandUsed.clear();
+
+    VRTExprParser oParser(pszExpression, m_aoProgram);
+    if( !oParser.Parse() )
+    {
+        m_aoProgram.clear();
+        return false;
+    }
+    m_nMaxStackDepth = oParser.m_nMaxStackDepth;
+    m_nMaxBand = oParser.m_nMaxBand;
+    m_abBandUsed.resize(m_nMaxBand, false);
+    for( size_t iInstr = 0; iInstr < m_aoProgram.size(); iInstr++ )
+    {
+        if( m_aoProgram[iInstr].eOp == OP_BAND )
+            m_abBandUsed[m_aoProgram[iInstr].nBand - 1] = true;
+    }
+
+    CPLDebug("VRT", "Expression \"%s\" compiled into %d instructions",
+             pszExpression, static_cast<int>(m_aoProgram.size()));
+    return true;
+}
+
+/************************************************************************/
+/*                              Evaluate()                              */
+/*                                                                      */
+/*      papadfBands[i] points to nCount values of source i+1.           */
+/*      padfScratch must have room for GetMaxStackDepth() * nCount      */
+/*      values. The returned column of nCount values points either      */
+/*      into padfScratch or into one of the source columns.             */
+/************************************************************************/
+
+const double* VRTExpression::Evaluate( const double* const* papadfBands,
+                                       int nCount,
+                                       double* padfScratch ) const
+{
+    const double* apadfStack[MAX_STACK_DEPTH];
+    int nTop = 0;
+
+    for( size_t iInstr = 0; iInstr < m_aoProgram.size(); iInstr++ )
+    {
+        const Instruction& sInstr = m_aoProgram[iInstr];
+        switch( sInstr.eOp )
+        {
+            case OP_CONST:
+            {
+                double* padfOut = padfScratch +
+                                  static_cast<size_t>(nTop) * nCount;
+                const double dfValue = sInstr.dfValue;
+                for( int i = 0; i < nCount; i++ )
+                    padfOut[i] = dfValue;
+                apadfStack[nTop++] = padfOut;
+                break;
+            }
+
+            case OP_BAND:
+                apadfStack[nTop++] = papadfBands[sInstr.nBand - 1];
+                break;
+
+            case OP_NEG:
+            case OP_NOT:
+            case OP_FUNC1:
+            {
+                const double* padfA = apadfStack[nTop - 1];
+                double* padfOut = padfScratch +
+                                  static_cast<size_t>(nTop - 1) * nCount;
+                if( sInstr.eOp == OP_NEG )
+                {
+                    for( int i = 0; i < nCount; i++ )
+                        padfOut[i] = -padfA[i];
+                }
+                else if( sInstr.eOp == OP_NOT )
+                {
+                    for( int i = 0; i < nCount; i++ )
+                        padfOut[i] = padfA[i] == 0.0;
+                }
+                else
+                {
+                    double (*pfnFunc)(double) = sInstr.pfnFunc1;
+                    for( int i = 0; i < nCount; i++ )
+                        padfOut[i] = pfnFunc(padfA[i]);
+                }
+                apadfStack[nTop - 1] = padfOut;
+                break;
+            }
+
+            case OP_SELECT:
+            {
+                const double* padfCond = apadfStack[nTop - 3];
+                const double* padfA = apadfStack[nTop - 2];
+                const double* padfB = apadfStack[nTop - 1];
+                nTop -= 2;
+                double* padfOut = padfScratch +
+                                  static_cast<size_t>(nTop - 1) * nCount;
+                for( int i = 0; i < nCount; i++ )
+                    padfOut[i] = padfCond[i] != 0.0 ? padfA[i] : padfB[i];
+                apadfStack[nTop - 1] = padfOut;
+                break;
+            }
+
+            default:
+            {
+                const double* padfB = apadfStack[--nTop];
+                const double* padfA = apadfStack[nTop - 1];
+                double* padfOut = padfScratch +
+                                  static_cast<size_t>(nTop - 1) * nCount;
+                switch( sInstr.eOp )
+                {
+                    case OP_ADD:
+                        ApplyBinary<AddOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_SUB:
+                        ApplyBinary<SubOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_MUL:
+                        ApplyBinary<MulOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_DIV:
+                        ApplyBinary<DivOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_MOD:
+                        for( int i = 0; i < nCount; i++ )
+                            padfOut[i] = fmod(padfA[i], padfB[i]);
+                        break;
+                    case OP_POW:
+                        for( int i = 0; i < nCount; i++ )
+                            padfOut[i] = pow(padfA[i], padfB[i]);
+                        break;
+                    case OP_LT:
+                        ApplyBinary<LtOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_LE:
+                        ApplyBinary<LeOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_GT:
+                        ApplyBinary<GtOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_GE:
+                        ApplyBinary<GeOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_EQ:
+                        ApplyBinary<EqOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_NE:
+                        ApplyBinary<NeOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_AND:
+                        ApplyBinary<AndOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_OR:
+                        ApplyBinary<OrOp>(padfA, padfB, padfOut, nCount);
+                        break;
+                    case OP_FUNC2:
+                    {
+                        double (*pfnFunc)(double, double) = sInstr.pfnFunc2;
+                        for( int i = 0; i < nCount; i++ )
+                            padfOut[i] = pfnFunc(padfA[i], padfB[i]);
+                        break;
+                    }
+                    default:
+                        CPLAssert(false);
+                        break;
+                }
+                apadfStack[nTop - 1] = padfOut;
+                break;
+            }
+        }
+    }
+
+    CPLAssert(nTop == 1);
+    return apadfStack[0];
+}
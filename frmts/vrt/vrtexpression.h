@@ -0,0 +1,113 @@
+/******************************************************************************
+ *
+ * Project:  Virtual GDAL Datasets
+ * Purpose:  Arithmetic expressions evaluated by VRTDerivedRasterBand.
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef VRTEXPRESSION_H_INCLUDED
+#define VRTEXPRESSION_H_INCLUDED
+
+#ifndef DOXYGEN_SKIP
+
+#include "cpl_port.h"
+
+#include <vector>
+
+/************************************************************************/
+/*                            VRTExpression                             */
+/*                                                                      */
+/*      An expression such as "(B1 - B2) / (B1 + B2)" is compiled once  */
+/*      into a postfix program. Each instruction of the program is then */
+/*      applied to a whole column of pixels at a time, rather than the  */
+/*      whole program being interpreted for each pixel.                */
+/************************************************************************/
+
+class VRTExpression
+{
+  public:
+    enum Opcode
+    {
+        OP_CONST,
+        OP_BAND,
+        OP_NEG,
+        OP_NOT,
+        OP_ADD,
+        OP_SUB,
+        OP_MUL,
+        OP_DIV,
+        OP_MOD,
+        OP_POW,
+        OP_LT,
+        OP_LE,
+        OP_GT,
+        OP_GE,
+        OP_EQ,
+        OP_NE,
+        OP_AND,
+        OP_OR,
+        OP_SELECT,
+        OP_FUNC1,
+        OP_FUNC2
+    };
+
+    struct Instruction
+    {
+        Opcode   eOp;
+        double   dfValue;
+        int      nBand;
+        double (*pfnFunc1)(double);
+        double (*pfnFunc2)(double, double);
+    };
+
+  private:
+    std::vector<Instruction> m_aoProgram;
+    int      m_nMaxStackDepth;
+    int      m_nMaxBand;
+    std::vector<bool> m_abBandUsed;
+
+    CPL_DISALLOW_COPY_ASSIGN(VRTExpression)
+
+  public:
+    VRTExpression();
+
+    bool     Compile( const char* pszExpression );
+
+    /** Highest 1-based source index referenced, or 0 if none. */
+    int      GetMaxBand() const { return m_nMaxBand; }
+
+    /** Whether the 1-based source nBand is referenced by the expression. */
+    bool     IsBandUsed( int nBand ) const
+        { return nBand >= 1 && nBand <= m_nMaxBand &&
+                 m_abBandUsed[nBand - 1]; }
+
+    /** Number of doubles Evaluate() needs as scratch per pixel. */
+    int      GetMaxStackDepth() const { return m_nMaxStackDepth; }
+
+    const double* Evaluate( const double* const* papadfBands,
+                            int nCount, double* padfScratch ) const;
+};
+
+#endif /* #ifndef DOXYGEN_SKIP */
+
+#endif /* #ifndef VRTEXPRESSION_H_INCLUDED */
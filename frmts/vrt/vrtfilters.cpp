@@ -146,6 +146,10 @@ VRTFilteredSource::RasterIO( GDALDataType eBandDataType,
                                            psExtraArg );
     }
 
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -184,8 +188,8 @@ VRTFilteredSource::RasterIO( GDALDataType eBandDataType,
         eOperDataType = eBufType;
 
     if( eOperDataType == GDT_Unknown
-        && IsTypeSupported( m_poRasterBand->GetRasterDataType() ) )
-        eOperDataType = m_poRasterBand->GetRasterDataType();
+        && IsTypeSupported( poBand->GetRasterDataType() ) )
+        eOperDataType = poBand->GetRasterDataType();
 
     if( eOperDataType == GDT_Unknown )
     {
@@ -276,15 +280,15 @@ VRTFilteredSource::RasterIO( GDALDataType eBandDataType,
         nFileYSize -= nTopFill;
     }
 
-    if( nFileXOff + nFileXSize > m_poRasterBand->GetXSize() )
+    if( nFileXOff + nFileXSize > poBand->GetXSize() )
     {
-        nRightFill = nFileXOff + nFileXSize - m_poRasterBand->GetXSize();
+        nRightFill = nFileXOff + nFileXSize - poBand->GetXSize();
         nFileXSize -= nRightFill;
     }
 
-    if( nFileYOff + nFileYSize > m_poRasterBand->GetYSize() )
+    if( nFileYOff + nFileYSize > poBand->GetYSize() )
     {
-        nBottomFill = nFileYOff + nFileYSize - m_poRasterBand->GetYSize();
+        nBottomFill = nFileYOff + nFileYSize - poBand->GetYSize();
         nFileYSize -= nBottomFill;
     }
 
@@ -484,6 +488,10 @@ CPLErr VRTKernelFilteredSource::FilterData( int nXSize, int nYSize,
     CPLAssert( m_nExtraEdgePixels*2 + 1 == m_nKernelSize ||
                (m_nKernelSize == 0 && m_nExtraEdgePixels == 0) );
 
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
 /* -------------------------------------------------------------------- */
 /*      Float32 case.                                                   */
 /* -------------------------------------------------------------------- */
@@ -494,7 +502,7 @@ CPLErr VRTKernelFilteredSource::FilterData( int nXSize, int nYSize,
 
         int bHasNoData = FALSE;
         const float fNoData =
-            static_cast<float>( m_poRasterBand->GetNoDataValue(&bHasNoData) );
+            static_cast<float>( poBand->GetNoDataValue(&bHasNoData) );
 
         const int nAxisCount = m_bSeparable ? 2 : 1;
 
@@ -31,12 +31,16 @@
 #include "gdal_vrt.h"
 #include "vrtdataset.h"
 
+#include <algorithm>
 #include <cmath>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <mutex>
 #include <string>
+#include <vector>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -45,6 +49,7 @@
 #include "cpl_progress.h"
 #include "cpl_string.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdal_priv.h"
 #include "ogr_geometry.h"
@@ -66,6 +71,8 @@ CPL_CVSID("$Id: vrtsourcedrasterband.cpp 22f8ae3bf7bc3cccd970992655c63fc5254d320
 VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nSourceIndexCount(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -85,6 +92,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataType eType,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nSourceIndexCount(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -103,6 +112,8 @@ VRTSourcedRasterBand::VRTSourcedRasterBand( GDALDataset *poDSIn, int nBandIn,
                                             int nXSize, int nYSize ) :
     m_nRecursionCounter(0),
     m_papszSourceList(nullptr),
+    m_hSourceIndex(nullptr),
+    m_nSourceIndexCount(0),
     nSources(0),
     papoSources(nullptr),
     bSkipBufferInitialization(FALSE)
@@ -124,6 +135,409 @@ VRTSourcedRasterBand::~VRTSourcedRasterBand()
 {
     VRTSourcedRasterBand::CloseDependentDatasets();
     CSLDestroy(m_papszSourceList);
+    InvalidateSourceIndex();
+}
+
+/************************************************************************/
+/*                       InvalidateSourceIndex()                        */
+/************************************************************************/
+
+void VRTSourcedRasterBand::InvalidateSourceIndex()
+{
+    if( m_hSourceIndex != nullptr )
+        CPLQuadTreeDestroy(m_hSourceIndex);
+    m_hSourceIndex = nullptr;
+    m_nSourceIndexCount = 0;
+}
+
+/************************************************************************/
+/*                         GetSourcesInWindow()                         */
+/*                                                                      */
+/*      Return the indices, in increasing order, of the sources that    */
+/*      may write into the passed window. Bands with many simple        */
+/*      sources use a quad tree of the source destination windows,      */
+/*      built on first use, instead of returning all the sources.       */
+/************************************************************************/
+
+static const int VRT_MIN_SOURCES_FOR_INDEX = 64;
+
+void VRTSourcedRasterBand::GetSourcesInWindow( int nXOff, int nYOff,
+                                               int nXSize, int nYSize,
+                                               std::vector<int>& anSources )
+{
+    anSources.clear();
+
+    // m_nSourceIndexCount is also set when the sources cannot be indexed,
+    // so that this is only attempted once.
+    if( nSources >= VRT_MIN_SOURCES_FOR_INDEX &&
+        m_nSourceIndexCount != nSources )
+    {
+        InvalidateSourceIndex();
+        m_nSourceIndexCount = nSources;
+
+        CPLRectObj sGlobalBounds;
+        sGlobalBounds.minx = 0;
+        sGlobalBounds.miny = 0;
+        sGlobalBounds.maxx = nRasterXSize;
+        sGlobalBounds.maxy = nRasterYSize;
+        CPLQuadTree* hIndex = CPLQuadTreeCreate(&sGlobalBounds, nullptr);
+        CPLQuadTreeSetMaxDepth(hIndex,
+                               CPLQuadTreeGetAdvisedMaxDepth(nSources));
+        bool bIndexable = true;
+        for( int iSource = 0; iSource < nSources; iSource++ )
+        {
+            if( !papoSources[iSource]->IsSimpleSource() )
+            {
+                bIndexable = false;
+                break;
+            }
+            // Sources without a destination window cover the whole band.
+            VRTSimpleSource* const poSS =
+                reinterpret_cast<VRTSimpleSource *>( papoSources[iSource] );
+            if( poSS->m_dfDstXOff == -1 && poSS->m_dfDstYOff == -1 &&
+                poSS->m_dfDstXSize == -1 && poSS->m_dfDstYSize == -1 )
+            {
+                bIndexable = false;
+                break;
+            }
+            CPLRectObj sBounds;
+            sBounds.minx = poSS->m_dfDstXOff;
+            sBounds.miny = poSS->m_dfDstYOff;
+            sBounds.maxx = poSS->m_dfDstXOff + poSS->m_dfDstXSize;
+            sBounds.maxy = poSS->m_dfDstYOff + poSS->m_dfDstYSize;
+            CPLQuadTreeInsertWithBounds(
+                hIndex,
+                reinterpret_cast<void*>(static_cast<size_t>(iSource)),
+                &sBounds);
+        }
+        if( bIndexable )
+            m_hSourceIndex = hIndex;
+        else
+            CPLQuadTreeDestroy(hIndex);
+    }
+
+    if( m_hSourceIndex == nullptr || m_nSourceIndexCount != nSources )
+    {
+        anSources.resize(nSources);
+        for( int iSource = 0; iSource < nSources; iSource++ )
+            anSources[iSource] = iSource;
+        return;
+    }
+
+    CPLRectObj sAoi;
+    sAoi.minx = nXOff;
+    sAoi.miny = nYOff;
+    sAoi.maxx = static_cast<double>(nXOff) + nXSize;
+    sAoi.maxy = static_cast<double>(nYOff) + nYSize;
+    int nFeatureCount = 0;
+    void** pahFeatures =
+        CPLQuadTreeSearch(m_hSourceIndex, &sAoi, &nFeatureCount);
+    anSources.resize(nFeatureCount);
+    for( int i = 0; i < nFeatureCount; i++ )
+    {
+        anSources[i] = static_cast<int>(
+            reinterpret_cast<size_t>(pahFeatures[i]));
+    }
+    CPLFree(pahFeatures);
+    std::sort(anSources.begin(), anSources.end());
+}
+
+/************************************************************************/
+/*                          VRTSourceReadWave                           */
+/*                                                                      */
+/*      Jobs of a wave still running. The source thread pool is shared  */
+/*      by all VRT datasets, so a request waits for its own jobs rather */
+/*      than for the whole pool.                                        */
+/************************************************************************/
+
+typedef struct
+{
+    std::mutex              oMutex;
+    std::condition_variable oCond;
+    size_t                  nPendingJobs;
+} VRTSourceReadWave;
+
+// Set on the threads of the source thread pool while they read a source.
+// A nested VRT read there is done serially, as waiting on the pool from
+// one of its own threads could deadlock.
+static thread_local bool gbInSourceReadJob = false;
+
+/************************************************************************/
+/*                          VRTSourceReadJob                            */
+/************************************************************************/
+
+typedef struct
+{
+    VRTSourceReadWave    *psWave;
+    VRTSimpleSource      *poSource;
+    GDALDataType          eBandDataType;
+    int                   nXOff;
+    int                   nYOff;
+    int                   nXSize;
+    int                   nYSize;
+    void                 *pData;
+    int                   nBufXSize;
+    int                   nBufYSize;
+    GDALDataType          eBufType;
+    int                   nBandCount;
+    int                  *panBandMap;
+    GSpacing              nPixelSpace;
+    GSpacing              nLineSpace;
+    GSpacing              nBandSpace;
+    bool                  bDatasetIO;
+    GDALRasterIOExtraArg  sExtraArg;
+
+    // Output window of the source within pData, and the dataset it reads.
+    int                   nOutXOff;
+    int                   nOutYOff;
+    int                   nOutXSize;
+    int                   nOutYSize;
+    GDALDataset          *poSrcDS;
+    bool                  bExclusive;
+    int                   iWave;
+
+    CPLErr                eErr;
+} VRTSourceReadJob;
+
+static void VRTSourceReadJobFunc( void* pData )
+{
+    VRTSourceReadJob* psJob = static_cast<VRTSourceReadJob*>(pData);
+    gbInSourceReadJob = true;
+    if( psJob->bDatasetIO )
+    {
+        psJob->eErr = psJob->poSource->DatasetRasterIO(
+            psJob->eBandDataType,
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nBandCount, psJob->panBandMap,
+            psJob->nPixelSpace, psJob->nLineSpace, psJob->nBandSpace,
+            &psJob->sExtraArg );
+    }
+    else
+    {
+        psJob->eErr = psJob->poSource->RasterIO(
+            psJob->eBandDataType,
+            psJob->nXOff, psJob->nYOff, psJob->nXSize, psJob->nYSize,
+            psJob->pData, psJob->nBufXSize, psJob->nBufYSize,
+            psJob->eBufType, psJob->nPixelSpace, psJob->nLineSpace,
+            &psJob->sExtraArg );
+    }
+    gbInSourceReadJob = false;
+
+    VRTSourceReadWave* psWave = psJob->psWave;
+    std::lock_guard<std::mutex> oLock(psWave->oMutex);
+    psWave->nPendingJobs--;
+    if( psWave->nPendingJobs == 0 )
+        psWave->oCond.notify_one();
+}
+
+/************************************************************************/
+/*                      VRTSourceReadJobsConflict()                     */
+/*                                                                      */
+/*      Two sources cannot be read at the same time if they write       */
+/*      overlapping parts of the output buffer (the later one must      */
+/*      win), or if they read the same dataset, which is not safe to    */
+/*      use from several threads.                                       */
+/************************************************************************/
+
+static bool VRTSourceReadJobsConflict( const VRTSourceReadJob& sA,
+                                       const VRTSourceReadJob& sB )
+{
+    if( sA.bExclusive || sB.bExclusive )
+        return true;
+    if( sA.nOutXOff < sB.nOutXOff + sB.nOutXSize &&
+        sB.nOutXOff < sA.nOutXOff + sA.nOutXSize &&
+        sA.nOutYOff < sB.nOutYOff + sB.nOutYSize &&
+        sB.nOutYOff < sA.nOutYOff + sA.nOutYSize )
+        return true;
+    if( sA.poSrcDS == sB.poSrcDS )
+        return true;
+    // Different proxy datasets on the same file share the underlying
+    // dataset through the proxy pool.
+    const char* pszA = sA.poSrcDS->GetDescription();
+    return pszA[0] != '\0' && strcmp(pszA, sB.poSrcDS->GetDescription()) == 0;
+}
+
+/************************************************************************/
+/*                       ReadSourcesInParallel()                        */
+/*                                                                      */
+/*      Read the sources on the source thread pool, when the            */
+/*      VRT_NUM_THREADS configuration option is set. Sources are        */
+/*      scheduled in waves: a source runs in the wave following the     */
+/*      last earlier source it conflicts with, so the z-order of        */
+/*      overlapping sources is preserved. Returns false, without        */
+/*      doing any I/O, when the request must be done serially.          */
+/*      anSources are the candidate sources from GetSourcesInWindow().  */
+/************************************************************************/
+
+bool VRTSourcedRasterBand::ReadSourcesInParallel( int nXOff, int nYOff,
+                                                  int nXSize, int nYSize,
+                                                  void *pData,
+                                                  int nBufXSize,
+                                                  int nBufYSize,
+                                                  GDALDataType eBufType,
+                                                  int nBandCount,
+                                                  int *panBandMap,
+                                                  GSpacing nPixelSpace,
+                                                  GSpacing nLineSpace,
+                                                  GSpacing nBandSpace,
+                                                  bool bDatasetIO,
+                                                  GDALRasterIOExtraArg* psExtraArg,
+                                                  const std::vector<int>& anSources,
+                                                  CPLErr *peErr )
+{
+    if( poDS == nullptr || anSources.size() < 2 || gbInSourceReadJob )
+        return false;
+    CPLWorkerThreadPool* poPool = VRTDataset::GetSourceThreadPool();
+    if( poPool == nullptr )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Collect the sources intersecting the request. Only simple,      */
+/*      complex and averaged sources are known to write nothing         */
+/*      outside of their output window.                                 */
+/* -------------------------------------------------------------------- */
+    std::vector<VRTSourceReadJob> asJobs;
+    for( size_t i = 0; i < anSources.size(); i++ )
+    {
+        const int iSource = anSources[i];
+        if( !papoSources[iSource]->IsSimpleSource() )
+            return false;
+        VRTSimpleSource* const poSource
+            = reinterpret_cast<VRTSimpleSource *>( papoSources[iSource] );
+        const char* pszType = poSource->GetType();
+        if( !EQUAL(pszType, "SimpleSource") &&
+            !EQUAL(pszType, "ComplexSource") &&
+            !EQUAL(pszType, "AveragedSource") )
+            return false;
+
+        VRTSourceReadJob sJob;
+        double dfReqXOff = 0.0;
+        double dfReqYOff = 0.0;
+        double dfReqXSize = 0.0;
+        double dfReqYSize = 0.0;
+        int nReqXOff = 0;
+        int nReqYOff = 0;
+        int nReqXSize = 0;
+        int nReqYSize = 0;
+        if( !poSource->GetSrcDstWindow( nXOff, nYOff, nXSize, nYSize,
+                                        nBufXSize, nBufYSize,
+                                        &dfReqXOff, &dfReqYOff,
+                                        &dfReqXSize, &dfReqYSize,
+                                        &nReqXOff, &nReqYOff,
+                                        &nReqXSize, &nReqYSize,
+                                        &sJob.nOutXOff, &sJob.nOutYOff,
+                                        &sJob.nOutXSize, &sJob.nOutYSize ) )
+        {
+            continue;
+        }
+
+        GDALRasterBand* poSrcBand = poSource->GetMaskBandMainBand() != nullptr ?
+            poSource->GetMaskBandMainBand() : poSource->GetBand();
+        if( poSrcBand == nullptr )
+            return false;
+        sJob.poSrcDS = poSrcBand->GetDataset();
+        // Nested VRTs may themselves reference any file, so read them alone.
+        sJob.bExclusive = sJob.poSrcDS == nullptr ||
+            EQUAL(CPLGetExtension(sJob.poSrcDS->GetDescription()), "vrt") ||
+            STARTS_WITH_CI(sJob.poSrcDS->GetDescription(), "<VRTDataset");
+
+        sJob.poSource = poSource;
+        sJob.eBandDataType = eDataType;
+        sJob.nXOff = nXOff;
+        sJob.nYOff = nYOff;
+        sJob.nXSize = nXSize;
+        sJob.nYSize = nYSize;
+        sJob.pData = pData;
+        sJob.nBufXSize = nBufXSize;
+        sJob.nBufYSize = nBufYSize;
+        sJob.eBufType = eBufType;
+        sJob.nBandCount = nBandCount;
+        sJob.panBandMap = panBandMap;
+        sJob.nPixelSpace = nPixelSpace;
+        sJob.nLineSpace = nLineSpace;
+        sJob.nBandSpace = nBandSpace;
+        sJob.bDatasetIO = bDatasetIO;
+        sJob.sExtraArg = *psExtraArg;
+        sJob.sExtraArg.pfnProgress = nullptr;
+        sJob.sExtraArg.pProgressData = nullptr;
+        sJob.psWave = nullptr;
+        sJob.iWave = 0;
+        sJob.eErr = CE_None;
+        asJobs.push_back(sJob);
+    }
+    if( asJobs.size() < 2 )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Assign waves.                                                   */
+/* -------------------------------------------------------------------- */
+    int nWaves = 0;
+    for( size_t i = 0; i < asJobs.size(); i++ )
+    {
+        for( size_t j = 0; j < i; j++ )
+        {
+            if( asJobs[j].iWave >= asJobs[i].iWave &&
+                VRTSourceReadJobsConflict(asJobs[i], asJobs[j]) )
+            {
+                asJobs[i].iWave = asJobs[j].iWave + 1;
+            }
+        }
+        nWaves = std::max(nWaves, asJobs[i].iWave + 1);
+    }
+    if( static_cast<size_t>(nWaves) == asJobs.size() )
+        return false;
+
+/* -------------------------------------------------------------------- */
+/*      Run them.                                                       */
+/* -------------------------------------------------------------------- */
+    m_nRecursionCounter++;
+
+    CPLErr eErr = CE_None;
+    for( int iWave = 0; eErr == CE_None && iWave < nWaves; iWave++ )
+    {
+        VRTSourceReadWave sWave;
+        std::vector<void*> apJobs;
+        for( size_t i = 0; i < asJobs.size(); i++ )
+        {
+            if( asJobs[i].iWave == iWave )
+            {
+                asJobs[i].psWave = &sWave;
+                apJobs.push_back(&asJobs[i]);
+            }
+        }
+        sWave.nPendingJobs = apJobs.size();
+        if( !poPool->SubmitJobs(VRTSourceReadJobFunc, apJobs) )
+        {
+            // Run the jobs that could not be queued here.
+            for( size_t i = 0; i < apJobs.size(); i++ )
+                VRTSourceReadJobFunc(apJobs[i]);
+        }
+        {
+            std::unique_lock<std::mutex> oLock(sWave.oMutex);
+            sWave.oCond.wait(oLock,
+                             [&sWave]{ return sWave.nPendingJobs == 0; });
+        }
+
+        for( size_t i = 0; i < apJobs.size(); i++ )
+        {
+            if( static_cast<VRTSourceReadJob*>(apJobs[i])->eErr != CE_None )
+                eErr = CE_Failure;
+        }
+
+        if( eErr == CE_None && psExtraArg->pfnProgress != nullptr &&
+            !psExtraArg->pfnProgress(1.0 * (iWave + 1) / nWaves, "",
+                                     psExtraArg->pProgressData) )
+        {
+            CPLError( CE_Failure, CPLE_UserInterrupt, "User terminated" );
+            eErr = CE_Failure;
+        }
+    }
+
+    m_nRecursionCounter--;
+
+    *peErr = eErr;
+    return true;
 }
 
 /************************************************************************/
@@ -176,6 +590,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
             return CE_None;
     }
 
+    std::vector<int> anSources;
+    GetSourcesInWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+
     // If resampling with non-nearest neighbour, we need to be careful
     // if the VRT band exposes a nodata value, but the sources do not have it
     if( eRWFlag == GF_Read &&
@@ -183,8 +600,9 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         psExtraArg->eResampleAlg != GRIORA_NearestNeighbour &&
         m_bNoDataValueSet )
     {
-        for( int i = 0; i < nSources; i++ )
+        for( size_t iCandidate = 0; iCandidate < anSources.size(); iCandidate++ )
         {
+            const int i = anSources[iCandidate];
             bool bFallbackToBase = false;
             if( !papoSources[i]->IsSimpleSource() )
             {
@@ -278,6 +696,18 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Overlay the sources concurrently if requested and possible.     */
+/* -------------------------------------------------------------------- */
+    CPLErr eErr = CE_None;
+    if( ReadSourcesInParallel( nXOff, nYOff, nXSize, nYSize,
+                               pData, nBufXSize, nBufYSize, eBufType,
+                               1, nullptr, nPixelSpace, nLineSpace, 0,
+                               false, psExtraArg, anSources, &eErr ) )
+    {
+        return eErr;
+    }
+
     m_nRecursionCounter++;
 
     GDALProgressFunc const pfnProgressGlobal = psExtraArg->pfnProgress;
@@ -286,18 +716,20 @@ CPLErr VRTSourcedRasterBand::IRasterIO( GDALRWFlag eRWFlag,
 /* -------------------------------------------------------------------- */
 /*      Overlay each source in turn over top this.                      */
 /* -------------------------------------------------------------------- */
-    CPLErr eErr = CE_None;
-    for( int iSource = 0; eErr == CE_None && iSource < nSources; iSource++ )
+    const int nCandidates = static_cast<int>(anSources.size());
+    for( int iCandidate = 0; eErr == CE_None && iCandidate < nCandidates;
+         iCandidate++ )
     {
         psExtraArg->pfnProgress = GDALScaledProgress;
         psExtraArg->pProgressData =
-            GDALCreateScaledProgress( 1.0 * iSource / nSources,
-                                      1.0 * (iSource + 1) / nSources,
+            GDALCreateScaledProgress( 1.0 * iCandidate / nCandidates,
+                                      1.0 * (iCandidate + 1) / nCandidates,
                                       pfnProgressGlobal,
                                       pProgressDataGlobal );
         if( psExtraArg->pProgressData == nullptr )
             psExtraArg->pfnProgress = nullptr;
 
+        const int iSource = anSources[iCandidate];
         eErr =
             papoSources[iSource]->RasterIO( eDataType,
                                             nXOff, nYOff, nXSize, nYSize,
@@ -354,8 +786,11 @@ int  VRTSourcedRasterBand::IGetDataCoverageStatus( int nXOff,
     poLR->addPoint( nXOff, nYOff );
     poPolyNonCoveredBySources->addRingDirectly(poLR);
 
-    for( int iSource = 0; iSource < nSources; iSource++ )
+    std::vector<int> anSources;
+    GetSourcesInWindow( nXOff, nYOff, nXSize, nYSize, anSources );
+    for( size_t iCandidate = 0; iCandidate < anSources.size(); iCandidate++ )
     {
+        const int iSource = anSources[iCandidate];
         if( !papoSources[iSource]->IsSimpleSource() )
         {
             delete poPolyNonCoveredBySources;
@@ -899,6 +1334,7 @@ CPLErr VRTSourcedRasterBand::AddSource( VRTSource *poNewSource )
         CPLRealloc( papoSources, sizeof(void*) * nSources ) );
     papoSources[nSources-1] = poNewSource;
 
+    InvalidateSourceIndex();
     reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
 
     if( poNewSource->IsSimpleSource() )
@@ -1034,15 +1470,18 @@ void VRTSourcedRasterBand::CheckSource( VRTSimpleSource *poSS )
 /* -------------------------------------------------------------------- */
 
     // Note: if one day we do alpha compositing, we will need to check that.
+    // The source band is looked at last, so as not to open deferred sources
+    // that do not cover the whole band.
     if( strcmp(poSS->GetType(), "SimpleSource") == 0 &&
         poSS->m_dfSrcXOff >= 0.0 &&
         poSS->m_dfSrcYOff >= 0.0 &&
-        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->m_poRasterBand->GetXSize() &&
-        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->m_poRasterBand->GetYSize() &&
         poSS->m_dfDstXOff <= 0.0 &&
         poSS->m_dfDstYOff <= 0.0 &&
         poSS->m_dfDstXOff + poSS->m_dfDstXSize >= nRasterXSize &&
-        poSS->m_dfDstYOff + poSS->m_dfDstYSize >= nRasterYSize )
+        poSS->m_dfDstYOff + poSS->m_dfDstYSize >= nRasterYSize &&
+        poSS->GetRasterBand() != nullptr &&
+        poSS->m_dfSrcXOff + poSS->m_dfSrcXSize <= poSS->GetRasterBand()->GetXSize() &&
+        poSS->m_dfSrcYOff + poSS->m_dfSrcYSize <= poSS->GetRasterBand()->GetYSize() )
     {
         bSkipBufferInitialization = TRUE;
     }
@@ -1426,8 +1865,12 @@ const char *VRTSourcedRasterBand::GetMetadataItem( const char * pszName,
                                                       CPLHashSetEqualStr,
                                                       nullptr );
 
-        for( int iSource = 0; iSource < nSources; iSource++ )
+        std::vector<int> anSources;
+        GetSourcesInWindow( iPixel, iLine, 1, 1, anSources );
+        for( size_t iCandidate = 0; iCandidate < anSources.size();
+             iCandidate++ )
         {
+            const int iSource = anSources[iCandidate];
             if( !papoSources[iSource]->IsSimpleSource() )
                 continue;
 
@@ -1595,6 +2038,7 @@ CPLErr VRTSourcedRasterBand::SetMetadataItem( const char *pszName,
         {
             delete papoSources[iSource];
             papoSources[iSource] = poSource;
+            InvalidateSourceIndex();
             reinterpret_cast<VRTDataset *>( poDS )->SetNeedsFlush();
             return CE_None;
         }
@@ -1626,6 +2070,7 @@ CPLErr VRTSourcedRasterBand::SetMetadata( char **papszNewMD, const char *pszDoma
             CPLFree( papoSources );
             papoSources = nullptr;
             nSources = 0;
+            InvalidateSourceIndex();
         }
 
         for( int i = 0; i < CSLCount(papszNewMD); i++ )
@@ -1687,6 +2132,7 @@ int VRTSourcedRasterBand::CloseDependentDatasets()
     CPLFree( papoSources );
     papoSources = nullptr;
     nSources = 0;
+    InvalidateSourceIndex();
 
     return TRUE;
 }
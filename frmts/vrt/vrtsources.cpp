@@ -110,13 +110,24 @@ VRTSimpleSource::VRTSimpleSource() :
     m_dfNoDataValue(VRT_NODATA_UNSET),
     m_nMaxValue(0),
     m_bRelativeToVRTOri(-1),
-    m_nExplicitSharedStatus(-1)
+    m_nExplicitSharedStatus(-1),
+    m_bDeferredSource(false),
+    m_papszDeferredOpenOptions(nullptr),
+    m_nDeferredBand(0),
+    m_bDeferredMaskBand(false),
+    m_bDeferredShared(true),
+    m_nDeferredRasterXSize(0),
+    m_nDeferredRasterYSize(0),
+    m_eDeferredDataType(GDT_Unknown),
+    m_nDeferredBlockXSize(0),
+    m_nDeferredBlockYSize(0)
 {}
 
 /************************************************************************/
 /*                          VRTSimpleSource()                           */
 /************************************************************************/
 
+// poSrcSource must have been opened, through GetBand() for example.
 VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
                                   double dfXDstRatio, double dfYDstRatio ) :
     m_poRasterBand(poSrcSource->m_poRasterBand),
@@ -133,7 +144,17 @@ VRTSimpleSource::VRTSimpleSource( const VRTSimpleSource* poSrcSource,
     m_dfNoDataValue(poSrcSource->m_dfNoDataValue),
     m_nMaxValue(poSrcSource->m_nMaxValue),
     m_bRelativeToVRTOri(-1),
-    m_nExplicitSharedStatus(poSrcSource->m_nExplicitSharedStatus)
+    m_nExplicitSharedStatus(poSrcSource->m_nExplicitSharedStatus),
+    m_bDeferredSource(false),
+    m_papszDeferredOpenOptions(nullptr),
+    m_nDeferredBand(0),
+    m_bDeferredMaskBand(false),
+    m_bDeferredShared(true),
+    m_nDeferredRasterXSize(0),
+    m_nDeferredRasterYSize(0),
+    m_eDeferredDataType(GDT_Unknown),
+    m_nDeferredBlockXSize(0),
+    m_nDeferredBlockYSize(0)
 {}
 
 /************************************************************************/
@@ -154,6 +175,7 @@ VRTSimpleSource::~VRTSimpleSource()
     {
         m_poRasterBand->GetDataset()->ReleaseRef();
     }
+    CSLDestroy( m_papszDeferredOpenOptions );
 }
 
 /************************************************************************/
@@ -279,7 +301,8 @@ static const char* const apszSpecialSyntax[] = {
 CPLXMLNode *VRTSimpleSource::SerializeToXML( const char *pszVRTPath )
 
 {
-    if( m_poRasterBand == nullptr )
+    GDALRasterBand* poRasterBand = GetRasterBand();
+    if( poRasterBand == nullptr )
         return nullptr;
 
     GDALDataset *poDS = nullptr;
@@ -292,8 +315,8 @@ CPLXMLNode *VRTSimpleSource::SerializeToXML( const char *pszVRTPath )
     }
     else
     {
-        poDS = m_poRasterBand->GetDataset();
-        if( poDS == nullptr || m_poRasterBand->GetBand() < 1 )
+        poDS = poRasterBand->GetDataset();
+        if( poDS == nullptr || poRasterBand->GetBand() < 1 )
             return nullptr;
     }
 
@@ -423,21 +446,21 @@ CPLXMLNode *VRTSimpleSource::SerializeToXML( const char *pszVRTPath )
                         CPLSPrintf("mask,%d",m_poMaskBandMainBand->GetBand()) );
     else
         CPLSetXMLValue( psSrc, "SourceBand",
-                        CPLSPrintf("%d",m_poRasterBand->GetBand()) );
+                        CPLSPrintf("%d",poRasterBand->GetBand()) );
 
     /* Write a few additional useful properties of the dataset */
     /* so that we can use a proxy dataset when re-opening. See XMLInit() */
     /* below */
     CPLSetXMLValue( psSrc, "SourceProperties.#RasterXSize",
-                    CPLSPrintf("%d",m_poRasterBand->GetXSize()) );
+                    CPLSPrintf("%d",poRasterBand->GetXSize()) );
     CPLSetXMLValue( psSrc, "SourceProperties.#RasterYSize",
-                    CPLSPrintf("%d",m_poRasterBand->GetYSize()) );
+                    CPLSPrintf("%d",poRasterBand->GetYSize()) );
     CPLSetXMLValue( psSrc, "SourceProperties.#DataType",
-                GDALGetDataTypeName( m_poRasterBand->GetRasterDataType() ) );
+                GDALGetDataTypeName( poRasterBand->GetRasterDataType() ) );
 
     int nBlockXSize = 0;
     int nBlockYSize = 0;
-    m_poRasterBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
+    poRasterBand->GetBlockSize(&nBlockXSize, &nBlockYSize);
 
     CPLSetXMLValue( psSrc, "SourceProperties.#BlockXSize",
                     CPLSPrintf("%d",nBlockXSize) );
@@ -661,7 +684,6 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
         papszOpenOptions =
             CSLSetNameValue(papszOpenOptions, "ROOT_PATH", pszVRTPath);
 
-    GDALDataset *poSrcDS = nullptr;
     if( nRasterXSize == 0 || nRasterYSize == 0 ||
         eDataType == static_cast<GDALDataType>(-1) ||
         nBlockXSize == 0 || nBlockYSize == 0 )
@@ -672,70 +694,59 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
         int nOpenFlags = GDAL_OF_RASTER | GDAL_OF_VERBOSE_ERROR;
         if( bShared )
             nOpenFlags |= GDAL_OF_SHARED;
-        poSrcDS = static_cast<GDALDataset *>( GDALOpenEx(
+        GDALDataset* poSrcDS = static_cast<GDALDataset *>( GDALOpenEx(
                     pszSrcDSName, nOpenFlags, nullptr,
                     (const char* const* )papszOpenOptions, nullptr ) );
-    }
-    else
-    {
-        /* ----------------------------------------------------------------- */
-        /*      Create a proxy dataset                                       */
-        /* ----------------------------------------------------------------- */
-        CPLString osUniqueHandle( CPLSPrintf("%p", pUniqueHandle) );
-        GDALProxyPoolDataset * const proxyDS =
-            new GDALProxyPoolDataset( pszSrcDSName, nRasterXSize, nRasterYSize,
-                                      GA_ReadOnly, bShared, nullptr, nullptr,
-                                      osUniqueHandle.c_str() );
-        proxyDS->SetOpenOptions(papszOpenOptions);
-        poSrcDS = proxyDS;
-
-        // Only the information of rasterBand nSrcBand will be accurate
-        // but that's OK since we only use that band afterwards.
-        for( int i = 1; i <= nSrcBand; i++ )
-            proxyDS->AddSrcBandDescription(eDataType, nBlockXSize, nBlockYSize);
 
-        if( bGetMaskBand )
-        {
-          GDALProxyPoolRasterBand *poMaskBand =
-              dynamic_cast<GDALProxyPoolRasterBand *>(
-              proxyDS->GetRasterBand(nSrcBand) );
-          if( poMaskBand == nullptr )
-          {
-              CPLError(
-                  CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
-          }
-          else
-          {
-              poMaskBand->AddSrcMaskBandDescription(
-                  eDataType, nBlockXSize, nBlockYSize );
-          }
-        }
-    }
+        CSLDestroy(papszOpenOptions);
 
-    CSLDestroy(papszOpenOptions);
+        CPLFree( pszSrcDSName );
 
-    CPLFree( pszSrcDSName );
+        if( poSrcDS == nullptr )
+            return CE_Failure;
 
-    if( poSrcDS == nullptr )
-        return CE_Failure;
+    /* -------------------------------------------------------------------- */
+    /*      Get the raster band.                                            */
+    /* -------------------------------------------------------------------- */
 
-/* -------------------------------------------------------------------- */
-/*      Get the raster band.                                            */
-/* -------------------------------------------------------------------- */
-
-    m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
-    if( m_poRasterBand == nullptr )
-    {
-        if( poSrcDS->GetShared() )
-            GDALClose( poSrcDS );
-        return CE_Failure;
-    }
-    if( bGetMaskBand )
-    {
-        m_poMaskBandMainBand = m_poRasterBand;
-        m_poRasterBand = m_poRasterBand->GetMaskBand();
+        m_poRasterBand = poSrcDS->GetRasterBand(nSrcBand);
         if( m_poRasterBand == nullptr )
+        {
+            if( poSrcDS->GetShared() )
+                GDALClose( poSrcDS );
             return CE_Failure;
+        }
+        if( bGetMaskBand )
+        {
+            m_poMaskBandMainBand = m_poRasterBand;
+            m_poRasterBand = m_poRasterBand->GetMaskBand();
+            if( m_poRasterBand == nullptr )
+                return CE_Failure;
+        }
+    }
+    else
+    {
+        /* ----------------------------------------------------------------- */
+        /*      Remember what is needed to create a proxy dataset. This is   */
+        /*      done by OpenDeferredSource() when the band is first used,    */
+        /*      which saves time and memory when opening VRTs with many      */
+        /*      sources.                                                     */
+        /* ----------------------------------------------------------------- */
+        m_bDeferredSource = true;
+        m_osDeferredDSName = pszSrcDSName;
+        m_osDeferredOwner = CPLSPrintf("%p", pUniqueHandle);
+        CSLDestroy(m_papszDeferredOpenOptions);
+        m_papszDeferredOpenOptions = papszOpenOptions;
+        m_nDeferredBand = nSrcBand;
+        m_bDeferredMaskBand = bGetMaskBand;
+        m_bDeferredShared = bShared;
+        m_nDeferredRasterXSize = nRasterXSize;
+        m_nDeferredRasterYSize = nRasterYSize;
+        m_eDeferredDataType = eDataType;
+        m_nDeferredBlockXSize = nBlockXSize;
+        m_nDeferredBlockYSize = nBlockYSize;
+
+        CPLFree( pszSrcDSName );
     }
 
 /* -------------------------------------------------------------------- */
@@ -776,6 +787,66 @@ CPLErr VRTSimpleSource::XMLInit( CPLXMLNode *psSrc, const char *pszVRTPath,
     return CE_None;
 }
 
+/************************************************************************/
+/*                        OpenDeferredSource()                          */
+/************************************************************************/
+
+bool VRTSimpleSource::OpenDeferredSource()
+{
+    if( !m_bDeferredSource )
+        return m_poRasterBand != nullptr;
+    m_bDeferredSource = false;
+
+    GDALProxyPoolDataset * const proxyDS =
+        new GDALProxyPoolDataset( m_osDeferredDSName,
+                                  m_nDeferredRasterXSize,
+                                  m_nDeferredRasterYSize,
+                                  GA_ReadOnly, m_bDeferredShared,
+                                  nullptr, nullptr,
+                                  m_osDeferredOwner.c_str() );
+    proxyDS->SetOpenOptions(m_papszDeferredOpenOptions);
+    CSLDestroy(m_papszDeferredOpenOptions);
+    m_papszDeferredOpenOptions = nullptr;
+
+    // Only the information of rasterBand m_nDeferredBand will be accurate
+    // but that's OK since we only use that band afterwards.
+    for( int i = 1; i <= m_nDeferredBand; i++ )
+        proxyDS->AddSrcBandDescription(m_eDeferredDataType,
+                                       m_nDeferredBlockXSize,
+                                       m_nDeferredBlockYSize);
+
+    if( m_bDeferredMaskBand )
+    {
+      GDALProxyPoolRasterBand *poMaskBand =
+          dynamic_cast<GDALProxyPoolRasterBand *>(
+          proxyDS->GetRasterBand(m_nDeferredBand) );
+      if( poMaskBand == nullptr )
+      {
+          CPLError(
+              CE_Fatal, CPLE_AssertionFailed, "dynamic_cast failed." );
+      }
+      else
+      {
+          poMaskBand->AddSrcMaskBandDescription(
+              m_eDeferredDataType, m_nDeferredBlockXSize,
+              m_nDeferredBlockYSize );
+      }
+    }
+
+    m_poRasterBand = proxyDS->GetRasterBand(m_nDeferredBand);
+    if( m_poRasterBand == nullptr )
+    {
+        delete proxyDS;
+        return false;
+    }
+    if( m_bDeferredMaskBand )
+    {
+        m_poMaskBandMainBand = m_poRasterBand;
+        m_poRasterBand = m_poRasterBand->GetMaskBand();
+    }
+    return m_poRasterBand != nullptr;
+}
+
 /************************************************************************/
 /*                             GetFileList()                            */
 /************************************************************************/
@@ -784,8 +855,9 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
                                    int *pnMaxSize, CPLHashSet* hSetFiles )
 {
     const char* pszFilename = nullptr;
-    if( m_poRasterBand != nullptr && m_poRasterBand->GetDataset() != nullptr &&
-        (pszFilename = m_poRasterBand->GetDataset()->GetDescription()) != nullptr )
+    GDALRasterBand* poRasterBand = GetRasterBand();
+    if( poRasterBand != nullptr && poRasterBand->GetDataset() != nullptr &&
+        (pszFilename = poRasterBand->GetDataset()->GetDescription()) != nullptr )
     {
 /* -------------------------------------------------------------------- */
 /*      Is the filename even a real filesystem object?                  */
@@ -836,7 +908,8 @@ void VRTSimpleSource::GetFileList( char*** ppapszFileList, int *pnSize,
 
 GDALRasterBand* VRTSimpleSource::GetBand()
 {
-    return m_poMaskBandMainBand ? nullptr : m_poRasterBand;
+    GDALRasterBand* poRasterBand = GetRasterBand();
+    return m_poMaskBandMainBand ? nullptr : poRasterBand;
 }
 
 /************************************************************************/
@@ -905,6 +978,10 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
                                   int *pnOutXSize, int *pnOutYSize )
 
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return FALSE;
+
     if( m_dfSrcXSize == 0.0 || m_dfSrcYSize == 0.0 ||
         m_dfDstXSize == 0.0 || m_dfDstYSize == 0.0 )
     {
@@ -1049,26 +1126,26 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
         *pnReqYSize = 1;
 
     if( *pnReqXSize > INT_MAX - *pnReqXOff ||
-        *pnReqXOff + *pnReqXSize > m_poRasterBand->GetXSize() )
+        *pnReqXOff + *pnReqXSize > poBand->GetXSize() )
     {
-        *pnReqXSize = m_poRasterBand->GetXSize() - *pnReqXOff;
+        *pnReqXSize = poBand->GetXSize() - *pnReqXOff;
         bModifiedX = true;
     }
-    if( *pdfReqXOff + *pdfReqXSize > m_poRasterBand->GetXSize() )
+    if( *pdfReqXOff + *pdfReqXSize > poBand->GetXSize() )
     {
-        *pdfReqXSize = m_poRasterBand->GetXSize() - *pdfReqXOff;
+        *pdfReqXSize = poBand->GetXSize() - *pdfReqXOff;
         bModifiedX = true;
     }
 
     if( *pnReqYSize > INT_MAX - *pnReqYOff ||
-        *pnReqYOff + *pnReqYSize > m_poRasterBand->GetYSize() )
+        *pnReqYOff + *pnReqYSize > poBand->GetYSize() )
     {
-        *pnReqYSize = m_poRasterBand->GetYSize() - *pnReqYOff;
+        *pnReqYSize = poBand->GetYSize() - *pnReqYOff;
         bModifiedY = true;
     }
-    if( *pdfReqYOff + *pdfReqYSize > m_poRasterBand->GetYSize() )
+    if( *pdfReqYOff + *pdfReqYSize > poBand->GetYSize() )
     {
-        *pdfReqYSize = m_poRasterBand->GetYSize() - *pdfReqYOff;
+        *pdfReqYSize = poBand->GetYSize() - *pdfReqYOff;
         bModifiedY = true;
     }
 
@@ -1076,8 +1153,8 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
 /*      Don't do anything if the requesting region is completely off    */
 /*      the source image.                                               */
 /* -------------------------------------------------------------------- */
-    if( *pnReqXOff >= m_poRasterBand->GetXSize()
-        || *pnReqYOff >= m_poRasterBand->GetYSize()
+    if( *pnReqXOff >= poBand->GetXSize()
+        || *pnReqYOff >= poBand->GetYSize()
         || *pnReqXSize <= 0 || *pnReqYSize <= 0 )
     {
         return FALSE;
@@ -1169,9 +1246,9 @@ VRTSimpleSource::GetSrcDstWindow( int nXOff, int nYOff, int nXSize, int nYSize,
 /*                          NeedMaxValAdjustment()                      */
 /************************************************************************/
 
-int VRTSimpleSource::NeedMaxValAdjustment() const
+int VRTSimpleSource::NeedMaxValAdjustment()
 {
-    if( !m_nMaxValue )
+    if( !m_nMaxValue || GetRasterBand() == nullptr )
         return FALSE;
 
     const char* pszNBITS =
@@ -1199,6 +1276,10 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
                            GDALRasterIOExtraArg* psExtraArgIn )
 
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
@@ -1265,7 +1346,7 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
 
     CPLErr eErr = CE_Failure;
 
-    if( GDALDataTypeIsConversionLossy(m_poRasterBand->GetRasterDataType(),
+    if( GDALDataTypeIsConversionLossy(poBand->GetRasterDataType(),
                                       eBandDataType) )
     {
         const int nBandDTSize = GDALGetDataTypeSizeBytes(eBandDataType);
@@ -1273,7 +1354,7 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
         if( pTemp )
         {
             eErr =
-                m_poRasterBand->RasterIO(
+                poBand->RasterIO(
                     GF_Read,
                     nReqXOff, nReqYOff, nReqXSize, nReqYSize,
                     pTemp,
@@ -1300,7 +1381,7 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
     else
     {
         eErr =
-            m_poRasterBand->RasterIO(
+            poBand->RasterIO(
                 GF_Read,
                 nReqXOff, nReqYOff, nReqXSize, nReqYSize,
                 pabyOut,
@@ -1338,6 +1419,13 @@ VRTSimpleSource::RasterIO( GDALDataType eBandDataType,
 
 double VRTSimpleSource::GetMinimum( int nXSize, int nYSize, int *pbSuccess )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+    {
+        *pbSuccess = FALSE;
+        return 0.0;
+    }
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1360,14 +1448,14 @@ double VRTSimpleSource::GetMinimum( int nXSize, int nYSize, int *pbSuccess )
                           &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
                           &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) ||
         nReqXOff != 0 || nReqYOff != 0 ||
-        nReqXSize != m_poRasterBand->GetXSize() ||
-        nReqYSize != m_poRasterBand->GetYSize())
+        nReqXSize != poBand->GetXSize() ||
+        nReqYSize != poBand->GetYSize())
     {
         *pbSuccess = FALSE;
         return 0;
     }
 
-    const double dfVal = m_poRasterBand->GetMinimum(pbSuccess);
+    const double dfVal = poBand->GetMinimum(pbSuccess);
     if( NeedMaxValAdjustment() && dfVal > m_nMaxValue )
         return m_nMaxValue;
     return dfVal;
@@ -1379,6 +1467,13 @@ double VRTSimpleSource::GetMinimum( int nXSize, int nYSize, int *pbSuccess )
 
 double VRTSimpleSource::GetMaximum( int nXSize, int nYSize, int *pbSuccess )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+    {
+        *pbSuccess = FALSE;
+        return 0.0;
+    }
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1401,14 +1496,14 @@ double VRTSimpleSource::GetMaximum( int nXSize, int nYSize, int *pbSuccess )
                           &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
                           &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) ||
         nReqXOff != 0 || nReqYOff != 0 ||
-        nReqXSize != m_poRasterBand->GetXSize() ||
-        nReqYSize != m_poRasterBand->GetYSize())
+        nReqXSize != poBand->GetXSize() ||
+        nReqYSize != poBand->GetYSize())
     {
         *pbSuccess = FALSE;
         return 0;
     }
 
-    const double dfVal = m_poRasterBand->GetMaximum(pbSuccess);
+    const double dfVal = poBand->GetMaximum(pbSuccess);
     if( NeedMaxValAdjustment() && dfVal > m_nMaxValue )
         return m_nMaxValue;
     return dfVal;
@@ -1421,6 +1516,10 @@ double VRTSimpleSource::GetMaximum( int nXSize, int nYSize, int *pbSuccess )
 CPLErr VRTSimpleSource::ComputeRasterMinMax( int nXSize, int nYSize,
                                              int bApproxOK, double* adfMinMax )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1443,14 +1542,14 @@ CPLErr VRTSimpleSource::ComputeRasterMinMax( int nXSize, int nYSize,
                           &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
                           &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) ||
         nReqXOff != 0 || nReqYOff != 0 ||
-        nReqXSize != m_poRasterBand->GetXSize() ||
-        nReqYSize != m_poRasterBand->GetYSize())
+        nReqXSize != poBand->GetXSize() ||
+        nReqYSize != poBand->GetYSize())
     {
         return CE_Failure;
     }
 
     const CPLErr eErr =
-        m_poRasterBand->ComputeRasterMinMax( bApproxOK, adfMinMax );
+        poBand->ComputeRasterMinMax( bApproxOK, adfMinMax );
     if( NeedMaxValAdjustment() )
     {
         if( adfMinMax[0] > m_nMaxValue )
@@ -1472,6 +1571,10 @@ CPLErr VRTSimpleSource::ComputeStatistics(
     double *pdfMean, double *pdfStdDev,
     GDALProgressFunc pfnProgress, void *pProgressData )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1495,15 +1598,15 @@ CPLErr VRTSimpleSource::ComputeStatistics(
                           &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
                           &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) ||
         nReqXOff != 0 || nReqYOff != 0 ||
-        nReqXSize != m_poRasterBand->GetXSize() ||
-        nReqYSize != m_poRasterBand->GetYSize())
+        nReqXSize != poBand->GetXSize() ||
+        nReqYSize != poBand->GetYSize())
     {
         return CE_Failure;
     }
 
-    return m_poRasterBand->ComputeStatistics( bApproxOK, pdfMin, pdfMax,
-                                              pdfMean, pdfStdDev,
-                                              pfnProgress, pProgressData );
+    return poBand->ComputeStatistics( bApproxOK, pdfMin, pdfMax,
+                                      pdfMean, pdfStdDev,
+                                      pfnProgress, pProgressData );
 }
 
 /************************************************************************/
@@ -1517,6 +1620,10 @@ CPLErr VRTSimpleSource::GetHistogram(
     int bIncludeOutOfRange, int bApproxOK,
     GDALProgressFunc pfnProgress, void *pProgressData )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     // The window we will actually request from the source raster band.
     double dfReqXOff = 0.0;
     double dfReqYOff = 0.0;
@@ -1540,16 +1647,16 @@ CPLErr VRTSimpleSource::GetHistogram(
                           &nReqXOff, &nReqYOff, &nReqXSize, &nReqYSize,
                           &nOutXOff, &nOutYOff, &nOutXSize, &nOutYSize ) ||
         nReqXOff != 0 || nReqYOff != 0 ||
-        nReqXSize != m_poRasterBand->GetXSize() ||
-        nReqYSize != m_poRasterBand->GetYSize())
+        nReqXSize != poBand->GetXSize() ||
+        nReqYSize != poBand->GetYSize())
     {
         return CE_Failure;
     }
 
-    return m_poRasterBand->GetHistogram( dfMin, dfMax, nBuckets,
-                                         panHistogram,
-                                         bIncludeOutOfRange, bApproxOK,
-                                         pfnProgress, pProgressData );
+    return poBand->GetHistogram( dfMin, dfMax, nBuckets,
+                                 panHistogram,
+                                 bIncludeOutOfRange, bApproxOK,
+                                 pfnProgress, pProgressData );
 }
 
 /************************************************************************/
@@ -1573,6 +1680,10 @@ CPLErr VRTSimpleSource::DatasetRasterIO(
         return CE_Failure;
     }
 
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
@@ -1602,7 +1713,7 @@ CPLErr VRTSimpleSource::DatasetRasterIO(
         return CE_None;
     }
 
-    GDALDataset* poDS = m_poRasterBand->GetDataset();
+    GDALDataset* poDS = poBand->GetDataset();
     if( poDS == nullptr )
         return CE_Failure;
 
@@ -1627,7 +1738,7 @@ CPLErr VRTSimpleSource::DatasetRasterIO(
 
     CPLErr eErr = CE_Failure;
 
-    if( GDALDataTypeIsConversionLossy(m_poRasterBand->GetRasterDataType(),
+    if( GDALDataTypeIsConversionLossy(poBand->GetRasterDataType(),
                                       eBandDataType) )
     {
         const int nBandDTSize = GDALGetDataTypeSizeBytes(eBandDataType);
@@ -1762,6 +1873,10 @@ VRTAveragedSource::RasterIO( GDALDataType /*eBandDataType*/,
                              GDALRasterIOExtraArg* psExtraArgIn )
 
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
     GDALRasterIOExtraArg sExtraArg;
     INIT_RASTERIO_EXTRA_ARG(sExtraArg);
     GDALRasterIOExtraArg* psExtraArg = &sExtraArg;
@@ -1818,10 +1933,10 @@ VRTAveragedSource::RasterIO( GDALDataType /*eBandDataType*/,
     psExtraArg->dfYSize = dfReqYSize;
 
     const CPLErr eErr =
-        m_poRasterBand->RasterIO( GF_Read,
-                                  nReqXOff, nReqYOff, nReqXSize, nReqYSize,
-                                  pafSrc, nReqXSize, nReqYSize, GDT_Float32,
-                                  0, 0, psExtraArg );
+        poBand->RasterIO( GF_Read,
+                          nReqXOff, nReqYOff, nReqXSize, nReqYSize,
+                          pafSrc, nReqXSize, nReqYSize, GDT_Float32,
+                          0, 0, psExtraArg );
 
     if( eErr != CE_None )
     {
@@ -2493,6 +2608,10 @@ CPLErr VRTComplexSource::RasterIOInternal( int nReqXOff, int nReqYOff,
                                            GDALRasterIOExtraArg* psExtraArg,
                                            GDALDataType eWrkDataType )
 {
+    GDALRasterBand* poBand = GetRasterBand();
+    if( poBand == nullptr )
+        return CE_Failure;
+
 /* -------------------------------------------------------------------- */
 /*      Read into a temporary buffer.                                   */
 /* -------------------------------------------------------------------- */
@@ -2531,16 +2650,16 @@ CPLErr VRTComplexSource::RasterIOInternal( int nReqXOff, int nReqYOff,
         }
 
         const CPLErr eErr =
-            m_poRasterBand->RasterIO( GF_Read,
-                                      nReqXOff, nReqYOff,
-                                      nReqXSize, nReqYSize,
-                                      pafData,
-                                      nOutXSize, nOutYSize,
-                                      eWrkDataType,
-                                      nWordSize,
-                                      nWordSize *
-                                      static_cast<GSpacing>(nOutXSize),
-                                      psExtraArg );
+            poBand->RasterIO( GF_Read,
+                              nReqXOff, nReqYOff,
+                              nReqXSize, nReqYSize,
+                              pafData,
+                              nOutXSize, nOutYSize,
+                              eWrkDataType,
+                              nWordSize,
+                              nWordSize *
+                              static_cast<GSpacing>(nOutXSize),
+                              psExtraArg );
         if( !m_osResampling.empty() )
             psExtraArg->eResampleAlg = eResampleAlgBack;
 
@@ -2552,7 +2671,7 @@ CPLErr VRTComplexSource::RasterIOInternal( int nReqXOff, int nReqYOff,
 
         if( m_nColorTableComponent != 0 )
         {
-            poColorTable = m_poRasterBand->GetColorTable();
+            poColorTable = poBand->GetColorTable();
             if( poColorTable == nullptr )
             {
                 CPLError( CE_Failure, CPLE_AppDefined,
@@ -2627,11 +2746,11 @@ CPLErr VRTComplexSource::RasterIOInternal( int nReqXOff, int nReqYOff,
                         int bSuccessMin = FALSE;
                         int bSuccessMax = FALSE;
                         double adfMinMax[2] = {
-                            m_poRasterBand->GetMinimum(&bSuccessMin),
-                            m_poRasterBand->GetMaximum(&bSuccessMax) };
+                            poBand->GetMinimum(&bSuccessMin),
+                            poBand->GetMaximum(&bSuccessMax) };
                         if( (bSuccessMin && bSuccessMax) ||
-                            m_poRasterBand->ComputeRasterMinMax( TRUE,
-                                                                 adfMinMax )
+                            poBand->ComputeRasterMinMax( TRUE,
+                                                         adfMinMax )
                             == CE_None )
                         {
                             m_dfSrcMin = adfMinMax[0];
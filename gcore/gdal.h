@@ -1181,6 +1181,9 @@ int CPL_DLL CPL_STDCALL GDALGetCacheUsed(void);
 void CPL_DLL CPL_STDCALL GDALSetCacheMax64( GIntBig nBytes );
 GIntBig CPL_DLL CPL_STDCALL GDALGetCacheMax64(void);
 GIntBig CPL_DLL CPL_STDCALL GDALGetCacheUsed64(void);
+void CPL_DLL CPL_STDCALL GDALGetCacheStatistics( GIntBig* pnHits,
+                                                 GIntBig* pnMisses );
+void CPL_DLL CPL_STDCALL GDALResetCacheStatistics(void);
 
 int CPL_DLL CPL_STDCALL GDALFlushCacheBlock(void);
 
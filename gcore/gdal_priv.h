@@ -854,6 +854,7 @@ class CPL_DLL GDALRasterBlock
     GDALRasterBlock     *poPrevious;
 
     bool                 bMustDetach;
+    bool                 bInProtectedList;
 
     void        Detach_unlocked( void );
     void        Touch_unlocked( void );
@@ -925,6 +926,10 @@ class CPL_DLL GDALRasterBlock
     static void EnterDisableDirtyBlockFlush();
     static void LeaveDisableDirtyBlockFlush();
 
+//! @cond Doxygen_Suppress
+    static void ForgetGhosts(GDALRasterBand* poBand);
+//! @endcond
+
 #ifdef notdef
     static void CheckNonOrphanedBlocks(GDALRasterBand* poBand);
     void        DumpBlock();
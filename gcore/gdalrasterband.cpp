@@ -1042,6 +1042,8 @@ CPLErr GDALRasterBand::FlushCache()
         eFlushBlockErr = CE_None;
     }
 
+    GDALRasterBlock::ForgetGhosts(this);
+
     if (poBandBlockCache == nullptr || !poBandBlockCache->IsInitOK())
         return eGlobalErr;
 
@@ -33,8 +33,12 @@
 #include "gdal_priv.h"
 
 #include <algorithm>
+#include <atomic>
 #include <climits>
 #include <cstring>
+#include <deque>
+#include <set>
+#include <tuple>
 
 #include "cpl_atomic_ops.h"
 #include "cpl_conv.h"
@@ -48,21 +52,78 @@ CPL_CVSID("$Id: gdalrasterblock.cpp ec7b85e6bb8f9737693a31f0bf7166e31e10992e 201
 static bool bCacheMaxInitialized = false;
 // Will later be overridden by the default 5% if GDAL_CACHEMAX not defined.
 static GIntBig nCacheMax = 40 * 1024 * 1024;
-static volatile GIntBig nCacheUsed = 0;
-
-static GDALRasterBlock *poOldest = nullptr;  // Tail.
-static GDALRasterBlock *poNewest = nullptr;  // Head.
 
 static int nDisableDirtyBlockFlushCounter = 0;
 
-#if 0
-static CPLMutex *hRBLock = nullptr;
-#define INITIALIZE_LOCK CPLMutexHolderD( &hRBLock )
-#define TAKE_LOCK       CPLMutexHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK    CPLDestroyMutex( hRBLock )
-#else
+/* -------------------------------------------------------------------- */
+/*      The cache is split in one or several shards, each one with its  */
+/*      own lock, LRU list and memory accounting. A block is assigned   */
+/*      to a shard from a hash of its band and block coordinates, so    */
+/*      that threads working on different datasets/blocks mostly do     */
+/*      not contend for the same lock. Each shard is allowed            */
+/*      1/nShardCount of the GDAL_CACHEMAX budget, so the global usage  */
+/*      remains bounded by GDAL_CACHEMAX, although blocks may be        */
+/*      evicted a bit earlier than with a single LRU list.              */
+/*      The number of shards is set with GDAL_BLOCK_CACHE_SHARDS, and   */
+/*      defaults to 1, that is a single global LRU list.                */
+/*                                                                      */
+/*      The eviction policy is set with GDAL_BLOCK_CACHE_POLICY:        */
+/*      - LRU (default): a single least-recently-used list per shard.   */
+/*      - 2Q: scan resistant variant, after "2Q: A Low Overhead High    */
+/*        Performance Buffer Management Replacement Algorithm" from     */
+/*        T. Johnson and D. Shasha. Newly loaded blocks enter a FIFO    */
+/*        probation list (A1in), and are evicted from it first when it  */
+/*        exceeds a quarter of the shard budget. The coordinates of     */
+/*        blocks evicted from the probation list are remembered in a    */
+/*        bounded ghost list (A1out). A block that is loaded again      */
+/*        while in the ghost list is considered as part of the working  */
+/*        set and enters the protected LRU list (Am). A single full     */
+/*        scan thus only cycles through the probation list.             */
+/* -------------------------------------------------------------------- */
+
+namespace {
+
+typedef enum
+{
+    BLOCK_CACHE_POLICY_LRU,
+    BLOCK_CACHE_POLICY_2Q
+} GDALRasterBlockCachePolicy;
+
+constexpr int PROBATION_LIST = 0;  // Single list of the LRU policy.
+constexpr int PROTECTED_LIST = 1;
+
+typedef struct
+{
+    GDALRasterBlock *poOldest;  // Tail.
+    GDALRasterBlock *poNewest;  // Head.
+    GIntBig          nUsed;
+} GDALRasterBlockList;
+
+typedef std::tuple<GDALRasterBand*, int, int> GDALRasterBlockKey;
+
+struct GDALRasterBlockCacheShard
+{
+    CPLLock         *hLock;
+    GDALRasterBlockList asLists[2];
+    volatile GIntBig nCacheUsed;
+
+    // Ghost list of the 2Q policy.
+    std::set<GDALRasterBlockKey>   oSetGhosts{};
+    std::deque<GDALRasterBlockKey> oQueueGhosts{};
+
+    std::atomic<GIntBig> nHits;
+    std::atomic<GIntBig> nMisses;
+};
+
+}  // namespace
+
+constexpr int MAX_BLOCK_CACHE_SHARDS = 256;
+static GDALRasterBlockCacheShard asShards[MAX_BLOCK_CACHE_SHARDS];
+static int nShardCount = 1;
+static GDALRasterBlockCachePolicy eCachePolicy = BLOCK_CACHE_POLICY_LRU;
+static bool bShardsInitialized = false;
+static volatile int nNextShardToFlush = 0;
 
-static CPLLock* hRBLock = nullptr;
 static bool bDebugContention = false;
 static bool bSleepsForBockCacheDebug = false;
 static CPLLockType GetLockType()
@@ -92,12 +153,137 @@ static CPLLockType GetLockType()
     return static_cast<CPLLockType>(nLockType);
 }
 
-#define INITIALIZE_LOCK         CPLLockHolderD( &hRBLock, GetLockType() ); \
-                                CPLLockSetDebugPerf(hRBLock, bDebugContention)
-#define TAKE_LOCK               CPLLockHolderOptionalLockD( hRBLock )
-#define DESTROY_LOCK            CPLDestroyLock( hRBLock )
+#define INITIALIZE_LOCK(psShard) \
+    CPLLockHolderD( &((psShard)->hLock), GetLockType() ); \
+    CPLLockSetDebugPerf((psShard)->hLock, bDebugContention)
+#define TAKE_LOCK(psShard)      CPLLockHolderOptionalLockD( (psShard)->hLock )
+#define DESTROY_LOCK(psShard)   CPLDestroyLock( (psShard)->hLock )
 
-#endif
+/************************************************************************/
+/*                          InitializeShards()                          */
+/************************************************************************/
+
+static void InitializeShards()
+{
+    INITIALIZE_LOCK(&asShards[0]);
+    if( bShardsInitialized )
+        return;
+
+    const char* pszShards =
+        CPLGetConfigOption("GDAL_BLOCK_CACHE_SHARDS", "1");
+    int nShards = EQUAL(pszShards, "ALL_CPUS") ? CPLGetNumCPUs() :
+                                                  atoi(pszShards);
+    if( nShards < 1 || nShards > MAX_BLOCK_CACHE_SHARDS )
+    {
+        CPLError(CE_Warning, CPLE_NotSupported,
+                 "GDAL_BLOCK_CACHE_SHARDS=%s not supported. "
+                 "Must be between 1 and %d",
+                 pszShards, MAX_BLOCK_CACHE_SHARDS);
+        nShards = std::max(1, std::min(nShards, MAX_BLOCK_CACHE_SHARDS));
+    }
+    for( int i = 1; i < nShards; ++i )
+    {
+        asShards[i].hLock = CPLCreateLock(GetLockType());
+        CPLLockSetDebugPerf(asShards[i].hLock, bDebugContention);
+    }
+    if( nShards > 1 )
+        CPLDebug("GDAL", "Using %d block cache shards", nShards);
+    nShardCount = nShards;
+
+    const char* pszPolicy =
+        CPLGetConfigOption("GDAL_BLOCK_CACHE_POLICY", "LRU");
+    if( EQUAL(pszPolicy, "2Q") )
+    {
+        CPLDebug("GDAL", "Using 2Q block cache policy");
+        eCachePolicy = BLOCK_CACHE_POLICY_2Q;
+    }
+    else
+    {
+        if( !EQUAL(pszPolicy, "LRU") )
+        {
+            CPLError(CE_Warning, CPLE_NotSupported,
+                     "GDAL_BLOCK_CACHE_POLICY=%s not supported. "
+                     "Falling back to LRU", pszPolicy);
+        }
+        eCachePolicy = BLOCK_CACHE_POLICY_LRU;
+    }
+    bShardsInitialized = true;
+}
+
+/************************************************************************/
+/*                              GetShard()                              */
+/************************************************************************/
+
+static GDALRasterBlockCacheShard* GetShard( GDALRasterBlock* poBlock )
+{
+    if( nShardCount == 1 )
+        return &asShards[0];
+
+    GUIntBig nHash = static_cast<GUIntBig>(
+        reinterpret_cast<GUIntptr_t>(poBlock->GetBand()));
+    nHash ^= (static_cast<GUIntBig>(poBlock->GetXOff()) << 32) |
+             static_cast<GUInt32>(poBlock->GetYOff());
+    // Fibonacci hashing, to mix the low and high bits.
+    nHash *= static_cast<GUIntBig>(0x9E3779B97F4A7C15ULL);
+    return &asShards[(nHash >> 32) % static_cast<GUIntBig>(nShardCount)];
+}
+
+/************************************************************************/
+/*                            GetCacheUsed()                            */
+/************************************************************************/
+
+// Only approximate when there are several shards, as they are summed
+// without taking their lock.
+static GIntBig GetCacheUsed()
+{
+    GIntBig nCacheUsed = 0;
+    for( int i = 0; i < nShardCount; ++i )
+        nCacheUsed += asShards[i].nCacheUsed;
+    return nCacheUsed;
+}
+
+/************************************************************************/
+/*                         SelectEvictionList()                         */
+/************************************************************************/
+
+// Returns the list from which blocks should be evicted first.
+static int SelectEvictionList( const GDALRasterBlockCacheShard* psShard,
+                               GIntBig nShardCacheMax )
+{
+    if( eCachePolicy == BLOCK_CACHE_POLICY_2Q &&
+        psShard->asLists[PROBATION_LIST].nUsed <= nShardCacheMax / 4 &&
+        psShard->asLists[PROTECTED_LIST].poOldest != nullptr )
+    {
+        return PROTECTED_LIST;
+    }
+    return PROBATION_LIST;
+}
+
+/************************************************************************/
+/*                            RememberGhost()                           */
+/************************************************************************/
+
+// Records the coordinates of a block evicted from the probation list of
+// the 2Q policy. The ghost list is bounded to half of the number of
+// blocks of that size that the shard can hold.
+static void RememberGhost( GDALRasterBlockCacheShard* psShard,
+                           GDALRasterBlock* poBlock,
+                           GIntBig nShardCacheMax,
+                           size_t nEffectiveBlockSize )
+{
+    const size_t nMaxGhosts = static_cast<size_t>(std::max(
+        static_cast<GIntBig>(1),
+        nShardCacheMax / static_cast<GIntBig>(2 * nEffectiveBlockSize)));
+    const GDALRasterBlockKey oKey(poBlock->GetBand(),
+                                  poBlock->GetXOff(), poBlock->GetYOff());
+    if( psShard->oSetGhosts.insert(oKey).second )
+        psShard->oQueueGhosts.push_back(oKey);
+    while( psShard->oQueueGhosts.size() > nMaxGhosts )
+    {
+        psShard->oSetGhosts.erase(psShard->oQueueGhosts.front());
+        psShard->oQueueGhosts.pop_front();
+    }
+}
 
 //#define ENABLE_DEBUG
 
@@ -154,9 +340,7 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
     }
 #endif
 
-    {
-        INITIALIZE_LOCK;
-    }
+    InitializeShards();
     bCacheMaxInitialized = true;
     nCacheMax = nNewSizeInBytes;
 
@@ -164,13 +348,13 @@ void CPL_STDCALL GDALSetCacheMax64( GIntBig nNewSizeInBytes )
 /*      Flush blocks till we are under the new limit or till we         */
 /*      can't seem to flush anymore.                                    */
 /* -------------------------------------------------------------------- */
-    while( nCacheUsed > nCacheMax )
+    while( GetCacheUsed() > nCacheMax )
     {
-        const GIntBig nOldCacheUsed = nCacheUsed;
+        const GIntBig nOldCacheUsed = GetCacheUsed();
 
         GDALFlushCacheBlock();
 
-        if( nCacheUsed == nOldCacheUsed )
+        if( GetCacheUsed() == nOldCacheUsed )
             break;
     }
 }
@@ -240,9 +424,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 {
     if( !bCacheMaxInitialized )
     {
-        {
-            INITIALIZE_LOCK;
-        }
+        InitializeShards();
         bSleepsForBockCacheDebug = CPLTestBool(
             CPLGetConfigOption("GDAL_DEBUG_BLOCK_CACHE", "NO"));
 
@@ -324,6 +506,7 @@ GIntBig CPL_STDCALL GDALGetCacheMax64()
 
 int CPL_STDCALL GDALGetCacheUsed()
 {
+    const GIntBig nCacheUsed = GetCacheUsed();
     if (nCacheUsed > INT_MAX)
     {
         static bool bHasWarned = false;
@@ -352,7 +535,60 @@ int CPL_STDCALL GDALGetCacheUsed()
  * @since GDAL 1.8.0
  */
 
-GIntBig CPL_STDCALL GDALGetCacheUsed64() { return nCacheUsed; }
+GIntBig CPL_STDCALL GDALGetCacheUsed64() { return GetCacheUsed(); }
+
+/************************************************************************/
+/*                       GDALGetCacheStatistics()                       */
+/************************************************************************/
+
+/**
+ * \brief Get the block cache hit and miss counters.
+ *
+ * A hit is counted each time a block is found in the cache, and a miss
+ * each time a block must be allocated (and generally read from its
+ * dataset) in the cache.
+ *
+ * @param pnHits pointer to the number of hits, or NULL.
+ * @param pnMisses pointer to the number of misses, or NULL.
+ *
+ * @since GDAL 2.4
+ */
+
+void CPL_STDCALL GDALGetCacheStatistics( GIntBig* pnHits, GIntBig* pnMisses )
+{
+    GIntBig nHits = 0;
+    GIntBig nMisses = 0;
+    for( int i = 0; i < nShardCount; ++i )
+    {
+        nHits += asShards[i].nHits;
+        nMisses += asShards[i].nMisses;
+    }
+    if( pnHits )
+        *pnHits = nHits;
+    if( pnMisses )
+        *pnMisses = nMisses;
+}
+
+/************************************************************************/
+/*                      GDALResetCacheStatistics()                      */
+/************************************************************************/
+
+/**
+ * \brief Reset the block cache hit and miss counters.
+ *
+ * @see GDALGetCacheStatistics()
+ *
+ * @since GDAL 2.4
+ */
+
+void CPL_STDCALL GDALResetCacheStatistics()
+{
+    for( int i = 0; i < MAX_BLOCK_CACHE_SHARDS; ++i )
+    {
+        asShards[i].nHits = 0;
+        asShards[i].nMisses = 0;
+    }
+}
 
 /************************************************************************/
 /*                        GDALFlushCacheBlock()                         */
@@ -391,6 +627,16 @@ int CPL_STDCALL GDALFlushCacheBlock()
  * a least recently used (LRU) list and an upper cache limit (see
  * GDALSetCacheMax()) under which the cache size is normally kept.
  *
+ * The GDAL_BLOCK_CACHE_SHARDS configuration option (default 1) can be set to
+ * split the cache in several shards, each with its own LRU list, lock and
+ * share of the cache limit, to reduce lock contention when many threads
+ * read concurrently. It can be set to ALL_CPUS.
+ *
+ * The GDAL_BLOCK_CACHE_POLICY configuration option can be set to 2Q instead
+ * of the default LRU, so that a single scan of a large dataset does not
+ * evict the blocks that are repeatedly accessed by other readers. Hit and
+ * miss counters are available with GDALGetCacheStatistics().
+ *
  * Some blocks in the cache may be modified relative to the state on disk
  * (they are marked "Dirty") and must be flushed to disk before they can
  * be discarded.  Other (Clean) blocks may just be discarded if their memory
@@ -431,26 +677,43 @@ int CPL_STDCALL GDALFlushCacheBlock()
 int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
 {
-    GDALRasterBlock *poTarget;
+    if( !bShardsInitialized )
+        InitializeShards();
 
-    {
-        INITIALIZE_LOCK;
-        poTarget = poOldest;
+    GDALRasterBlock *poTarget = nullptr;
 
-        while( poTarget != nullptr )
+    // Visit the shards in a round-robin way, starting after the one
+    // flushed by the previous call, so that they are evenly trimmed.
+    const int nFirstShard =
+        (CPLAtomicInc(&nNextShardToFlush) & INT_MAX) % nShardCount;
+    const GIntBig nShardCacheMax = GDALGetCacheMax64() / nShardCount;
+    for( int iShard = 0; iShard < nShardCount; ++iShard )
+    {
+        GDALRasterBlockCacheShard* psShard =
+            &asShards[(nFirstShard + iShard) % nShardCount];
+        TAKE_LOCK(psShard);
+        const int iFirstList = SelectEvictionList(psShard, nShardCacheMax);
+        for( int iList = 0; iList < 2 && poTarget == nullptr; ++iList )
         {
-            if( !bDirtyBlocksOnly ||
-                (poTarget->GetDirty() && nDisableDirtyBlockFlushCounter == 0) )
+            poTarget = psShard->asLists[iList == 0 ? iFirstList :
+                                        1 - iFirstList].poOldest;
+
+            while( poTarget != nullptr )
             {
-                if( CPLAtomicCompareAndExchange(
-                        &(poTarget->nLockCount), 0, -1) )
-                    break;
+                if( !bDirtyBlocksOnly ||
+                    (poTarget->GetDirty() &&
+                     nDisableDirtyBlockFlushCounter == 0) )
+                {
+                    if( CPLAtomicCompareAndExchange(
+                            &(poTarget->nLockCount), 0, -1) )
+                        break;
+                }
+                poTarget = poTarget->poPrevious;
             }
-            poTarget = poTarget->poPrevious;
         }
 
         if( poTarget == nullptr )
-            return FALSE;
+            continue;
         if( bSleepsForBockCacheDebug )
             CPLSleep(CPLAtof(
                 CPLGetConfigOption(
@@ -458,8 +721,12 @@ int GDALRasterBlock::FlushCacheBlock( int bDirtyBlocksOnly )
 
         poTarget->Detach_unlocked();
         poTarget->GetBand()->UnreferenceBlock(poTarget);
+        break;
     }
 
+    if( poTarget == nullptr )
+        return FALSE;
+
     if( bSleepsForBockCacheDebug )
         CPLSleep(CPLAtof(
             CPLGetConfigOption("GDAL_RB_FLUSHBLOCK_SLEEP_AFTER_RB_LOCK", "0")));
@@ -583,7 +850,8 @@ GDALRasterBlock::GDALRasterBlock( GDALRasterBand *poBandIn,
     poBand(poBandIn),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(true)
+    bMustDetach(true),
+    bInProtectedList(false)
 {
     CPLAssert( poBandIn != nullptr );
     poBand->GetBlockSize( &nXSize, &nYSize );
@@ -619,7 +887,8 @@ GDALRasterBlock::GDALRasterBlock( int nXOffIn, int nYOffIn ) :
     poBand(nullptr),
     poNext(nullptr),
     poPrevious(nullptr),
-    bMustDetach(false)
+    bMustDetach(false),
+    bInProtectedList(false)
 {}
 
 /************************************************************************/
@@ -645,6 +914,7 @@ void GDALRasterBlock::RecycleFor( int nXOffIn, int nYOffIn )
     nXOff = nXOffIn;
     nYOff = nYOffIn;
     bMustDetach = true;
+    bInProtectedList = false;
 }
 
 /************************************************************************/
@@ -707,19 +977,22 @@ void GDALRasterBlock::Detach()
 {
     if( bMustDetach )
     {
-        TAKE_LOCK;
+        TAKE_LOCK(GetShard(this));
         Detach_unlocked();
     }
 }
 
 void GDALRasterBlock::Detach_unlocked()
 {
-    if( poOldest == this )
-        poOldest = poPrevious;
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
+    GDALRasterBlockList* psList =
+        &psShard->asLists[bInProtectedList ? PROTECTED_LIST : PROBATION_LIST];
+    if( psList->poOldest == this )
+        psList->poOldest = poPrevious;
 
-    if( poNewest == this )
+    if( psList->poNewest == this )
     {
-        poNewest = poNext;
+        psList->poNewest = poNext;
     }
 
     if( poPrevious != nullptr )
@@ -733,7 +1006,11 @@ void GDALRasterBlock::Detach_unlocked()
     bMustDetach = false;
 
     if( pData )
-        nCacheUsed -= GetEffectiveBlockSize(GetBlockSize());
+    {
+        const size_t nEffectiveSize = GetEffectiveBlockSize(GetBlockSize());
+        psShard->nCacheUsed -= nEffectiveSize;
+        psList->nUsed -= nEffectiveSize;
+    }
 
 #ifdef ENABLE_DEBUG
     Verify();
@@ -753,27 +1030,39 @@ void GDALRasterBlock::Detach_unlocked()
 void GDALRasterBlock::Verify()
 
 {
-    TAKE_LOCK;
-
-    CPLAssert( (poNewest == nullptr && poOldest == nullptr)
-               || (poNewest != nullptr && poOldest != nullptr) );
-
-    if( poNewest != nullptr )
+    for( int iShard = 0; iShard < nShardCount; ++iShard )
     {
-        CPLAssert( poNewest->poPrevious == nullptr );
-        CPLAssert( poOldest->poNext == nullptr );
+        GDALRasterBlockCacheShard* psShard = &asShards[iShard];
+        TAKE_LOCK(psShard);
 
-        GDALRasterBlock* poLast = nullptr;
-        for( GDALRasterBlock *poBlock = poNewest;
-             poBlock != nullptr;
-             poBlock = poBlock->poNext )
+        for( int iList = 0; iList < 2; ++iList )
         {
-            CPLAssert( poBlock->poPrevious == poLast );
+            GDALRasterBlockList* psList = &psShard->asLists[iList];
+            CPLAssert( (psList->poNewest == nullptr &&
+                        psList->poOldest == nullptr)
+                       || (psList->poNewest != nullptr &&
+                           psList->poOldest != nullptr) );
 
-            poLast = poBlock;
-        }
+            if( psList->poNewest != nullptr )
+            {
+                CPLAssert( psList->poNewest->poPrevious == nullptr );
+                CPLAssert( psList->poOldest->poNext == nullptr );
+
+                GDALRasterBlock* poLast = nullptr;
+                for( GDALRasterBlock *poBlock = psList->poNewest;
+                     poBlock != nullptr;
+                     poBlock = poBlock->poNext )
+                {
+                    CPLAssert( poBlock->poPrevious == poLast );
+                    CPLAssert( poBlock->bInProtectedList ==
+                               (iList == PROTECTED_LIST) );
+
+                    poLast = poBlock;
+                }
 
-        CPLAssert( poOldest == poLast );
+                CPLAssert( psList->poOldest == poLast );
+            }
+        }
     }
 }
 
@@ -784,13 +1073,17 @@ void GDALRasterBlock::Verify() {}
 #ifdef notdef
 void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
 {
-    TAKE_LOCK;
-    for( GDALRasterBlock *poBlock = poNewest;
-                          poBlock != nullptr;
-                          poBlock = poBlock->poNext )
+    for( int iShard = 0; iShard < nShardCount; ++iShard )
     {
-        if ( poBlock->GetBand() == poBand )
+      TAKE_LOCK(&asShards[iShard]);
+      for( int iList = 0; iList < 2; ++iList )
+      {
+        for( GDALRasterBlock *poBlock = asShards[iShard].asLists[iList].poNewest;
+                              poBlock != nullptr;
+                              poBlock = poBlock->poNext )
         {
+          if ( poBlock->GetBand() == poBand )
+          {
             printf("Cache has still blocks of band %p\n", poBand);/*ok*/
             printf("Band : %d\n", poBand->GetBand());/*ok*/
             printf("nRasterXSize = %d\n", poBand->GetXSize());/*ok*/
@@ -803,7 +1096,9 @@ void GDALRasterBlock::CheckNonOrphanedBlocks( GDALRasterBand* poBand )
             if( poBand->GetDataset() )
                 printf("Dataset : %s\n",/*ok*/
                        poBand->GetDataset()->GetDescription());
+          }
         }
+      }
     }
 }
 #endif
@@ -858,11 +1153,18 @@ CPLErr GDALRasterBlock::Write()
 void GDALRasterBlock::Touch()
 
 {
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
+
     // Can be safely tested outside the lock
-    if( poNewest == this )
+    if( psShard->asLists[bInProtectedList ? PROTECTED_LIST :
+                                            PROBATION_LIST].poNewest == this )
+        return;
+
+    // Blocks of the probation list of the 2Q policy are kept in FIFO order.
+    if( eCachePolicy == BLOCK_CACHE_POLICY_2Q && !bInProtectedList )
         return;
 
-    TAKE_LOCK;
+    TAKE_LOCK(psShard);
     Touch_unlocked();
 }
 
@@ -875,15 +1177,29 @@ void GDALRasterBlock::Touch_unlocked()
     // 1. Thread 1 calls Touch() and poNewest != this at that point
     // 2. Thread 2 detaches poNewest
     // 3. Thread 1 arrives here
-    if( poNewest == this )
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
+    GDALRasterBlockList* psList =
+        &psShard->asLists[bInProtectedList ? PROTECTED_LIST : PROBATION_LIST];
+    if( psList->poNewest == this )
         return;
 
     // We should not try to touch a block that has been detached.
     // If that happen, corruption has already occurred.
     CPLAssert(bMustDetach);
 
-    if( poOldest == this )
-        poOldest = this->poPrevious;
+    const bool bInList = poPrevious != nullptr || poNext != nullptr;
+    if( !bInList )
+    {
+        // New block, coming from Internalize().
+        psList->nUsed += GetEffectiveBlockSize(GetBlockSize());
+    }
+    else if( eCachePolicy == BLOCK_CACHE_POLICY_2Q && !bInProtectedList )
+    {
+        return;
+    }
+
+    if( psList->poOldest == this )
+        psList->poOldest = this->poPrevious;
 
     if( poPrevious != nullptr )
         poPrevious->poNext = poNext;
@@ -892,19 +1208,19 @@ void GDALRasterBlock::Touch_unlocked()
         poNext->poPrevious = poPrevious;
 
     poPrevious = nullptr;
-    poNext = poNewest;
+    poNext = psList->poNewest;
 
-    if( poNewest != nullptr )
+    if( psList->poNewest != nullptr )
     {
-        CPLAssert( poNewest->poPrevious == nullptr );
-        poNewest->poPrevious = this;
+        CPLAssert( psList->poNewest->poPrevious == nullptr );
+        psList->poNewest->poPrevious = this;
     }
-    poNewest = this;
+    psList->poNewest = this;
 
-    if( poOldest == nullptr )
+    if( psList->poOldest == nullptr )
     {
         CPLAssert( poPrevious == nullptr && poNext == nullptr );
-        poOldest = this;
+        psList->poOldest = this;
     }
 #ifdef ENABLE_DEBUG
     Verify();
@@ -921,7 +1237,9 @@ void GDALRasterBlock::Touch_unlocked()
  * This method allocates memory for the block, and attempts to flush other
  * blocks, if necessary, to bring the total cache size back within the limits.
  * The newly allocated block is touched and will be considered most recently
- * used in the LRU list.
+ * used in the LRU list. With the 2Q policy, it is added to the probation
+ * list, or to the protected list if it has been recently evicted from the
+ * probation list.
  *
  * @return CE_None on success or CE_Failure if memory allocation fails.
  */
@@ -933,9 +1251,10 @@ CPLErr GDALRasterBlock::Internalize()
 
     void        *pNewData = nullptr;
 
-    // This call will initialize the hRBLock mutex. Other call places can
+    // This call will initialize the shard locks. Other call places can
     // only be called if we have go through there.
-    const GIntBig nCurCacheMax = GDALGetCacheMax64();
+    const GIntBig nCurCacheMax = GDALGetCacheMax64() / nShardCount;
+    GDALRasterBlockCacheShard* psShard = GetShard(this);
 
     // No risk of overflow as it is checked in GDALRasterBand::InitBlockInfo().
     const int nSizeInBytes = GetBlockSize();
@@ -951,13 +1270,23 @@ CPLErr GDALRasterBlock::Internalize()
         GDALRasterBlock* apoBlocksToFree[64] = { nullptr };
         int nBlocksToFree = 0;
         {
-            TAKE_LOCK;
+            TAKE_LOCK(psShard);
 
             if( bFirstIter )
-                nCacheUsed += GetEffectiveBlockSize(nSizeInBytes);
-            GDALRasterBlock *poTarget = poOldest;
-            while( nCacheUsed > nCurCacheMax )
             {
+                psShard->nCacheUsed += GetEffectiveBlockSize(nSizeInBytes);
+                psShard->nMisses.fetch_add(1, std::memory_order_relaxed);
+            }
+            // Cursors in the probation and protected lists.
+            GDALRasterBlock *apoTargets[2] = {
+                psShard->asLists[PROBATION_LIST].poOldest,
+                psShard->asLists[PROTECTED_LIST].poOldest };
+            while( psShard->nCacheUsed > nCurCacheMax )
+            {
+                int iList = SelectEvictionList(psShard, nCurCacheMax);
+                if( apoTargets[iList] == nullptr )
+                    iList = 1 - iList;
+                GDALRasterBlock *poTarget = apoTargets[iList];
                 while( poTarget != nullptr )
                 {
                     if( !poTarget->GetDirty() ||
@@ -978,7 +1307,15 @@ CPLErr GDALRasterBlock::Internalize()
                                 "GDAL_RB_INTERNALIZE_SLEEP_AFTER_DROP_LOCK",
                                 "0")));
 
-                    GDALRasterBlock* _poPrevious = poTarget->poPrevious;
+                    apoTargets[iList] = poTarget->poPrevious;
+
+                    if( eCachePolicy == BLOCK_CACHE_POLICY_2Q &&
+                        !poTarget->bInProtectedList )
+                    {
+                        RememberGhost(psShard, poTarget, nCurCacheMax,
+                                      GetEffectiveBlockSize(
+                                          poTarget->GetBlockSize()));
+                    }
 
                     poTarget->Detach_unlocked();
                     poTarget->GetBand()->UnreferenceBlock(poTarget);
@@ -989,20 +1326,20 @@ CPLErr GDALRasterBlock::Internalize()
                         // Only free one dirty block at a time so that
                         // other dirty blocks of other bands with the same
                         // coordinates can be found with TryGetLockedBlock()
-                        bLoopAgain = nCacheUsed > nCurCacheMax;
+                        bLoopAgain = psShard->nCacheUsed > nCurCacheMax;
                         break;
                     }
                     if( nBlocksToFree == 64 )
                     {
-                        bLoopAgain = ( nCacheUsed > nCurCacheMax );
+                        bLoopAgain = ( psShard->nCacheUsed > nCurCacheMax );
                         break;
                     }
-
-                    poTarget = _poPrevious;
                 }
                 else
                 {
-                    break;
+                    apoTargets[iList] = nullptr;
+                    if( apoTargets[1 - iList] == nullptr )
+                        break;
                 }
             }
 
@@ -1010,7 +1347,19 @@ CPLErr GDALRasterBlock::Internalize()
         /*      Add this block to the list.                                   */
         /* ------------------------------------------------------------------ */
             if( !bLoopAgain )
+            {
+                if( eCachePolicy == BLOCK_CACHE_POLICY_2Q )
+                {
+                    // The ghost entry is left to expire on its own.
+                    if( psShard->oSetGhosts.find(GDALRasterBlockKey(
+                            poBand, nXOff, nYOff)) !=
+                        psShard->oSetGhosts.end() )
+                    {
+                        bInProtectedList = true;
+                    }
+                }
                 Touch_unlocked();
+            }
         }
 
         bFirstIter = false;
@@ -1100,9 +1449,54 @@ void GDALRasterBlock::MarkClean() { bDirty = false; }
 /*! @cond Doxygen_Suppress */
 void GDALRasterBlock::DestroyRBMutex()
 {
-    if( hRBLock != nullptr )
-        DESTROY_LOCK;
-    hRBLock = nullptr;
+    for( int i = 0; i < MAX_BLOCK_CACHE_SHARDS; ++i )
+    {
+        if( asShards[i].hLock != nullptr )
+            DESTROY_LOCK(&asShards[i]);
+        asShards[i].hLock = nullptr;
+        asShards[i].oSetGhosts.clear();
+        asShards[i].oQueueGhosts.clear();
+    }
+    nShardCount = 1;
+    bShardsInitialized = false;
+}
+/*! @endcond */
+
+/************************************************************************/
+/*                            ForgetGhosts()                            */
+/************************************************************************/
+
+/*! @cond Doxygen_Suppress */
+// Removes the ghost entries of the 2Q policy that refer to poBand, so
+// that a band later allocated at the same address does not get false hits.
+void GDALRasterBlock::ForgetGhosts( GDALRasterBand* poBand )
+{
+    if( !bShardsInitialized || eCachePolicy != BLOCK_CACHE_POLICY_2Q )
+        return;
+
+    for( int i = 0; i < nShardCount; ++i )
+    {
+        GDALRasterBlockCacheShard* psShard = &asShards[i];
+        TAKE_LOCK(psShard);
+        auto oIter = psShard->oSetGhosts.lower_bound(
+            GDALRasterBlockKey(poBand, INT_MIN, INT_MIN));
+        if( oIter == psShard->oSetGhosts.end() ||
+            std::get<0>(*oIter) != poBand )
+        {
+            continue;
+        }
+        while( oIter != psShard->oSetGhosts.end() &&
+               std::get<0>(*oIter) == poBand )
+        {
+            oIter = psShard->oSetGhosts.erase(oIter);
+        }
+        psShard->oQueueGhosts.erase(
+            std::remove_if(psShard->oQueueGhosts.begin(),
+                           psShard->oQueueGhosts.end(),
+                           [poBand](const GDALRasterBlockKey& oKey)
+                           { return std::get<0>(oKey) == poBand; }),
+            psShard->oQueueGhosts.end());
+    }
 }
 /*! @endcond */
 
@@ -1144,6 +1538,7 @@ int GDALRasterBlock::TakeLock()
 
         return FALSE;
     }
+    GetShard(this)->nHits.fetch_add(1, std::memory_order_relaxed);
     Touch();
     return TRUE;
 }
@@ -1176,7 +1571,7 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 #endif
 
     // Wait for the block for having been unreferenced.
-    TAKE_LOCK;
+    TAKE_LOCK(GetShard(this));
 
     return FALSE;
 }
@@ -1185,14 +1580,21 @@ int GDALRasterBlock::DropLockForRemovalFromStorage()
 void GDALRasterBlock::DumpAll()
 {
     int iBlock = 0;
-    for( GDALRasterBlock *poBlock = poNewest;
-         poBlock != nullptr;
-         poBlock = poBlock->poNext )
+    for( int iShard = 0; iShard < nShardCount; ++iShard )
     {
-        printf("Block %d\n", iBlock);/*ok*/
-        poBlock->DumpBlock();
-        printf("\n");/*ok*/
-        iBlock++;
+        for( int iList = 0; iList < 2; ++iList )
+        {
+            for( GDALRasterBlock *poBlock =
+                                    asShards[iShard].asLists[iList].poNewest;
+                 poBlock != nullptr;
+                 poBlock = poBlock->poNext )
+            {
+                printf("Block %d\n", iBlock);/*ok*/
+                poBlock->DumpBlock();
+                printf("\n");/*ok*/
+                iBlock++;
+            }
+        }
     }
 }
 
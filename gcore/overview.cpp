@@ -42,6 +42,7 @@
 #include "cpl_error.h"
 #include "cpl_progress.h"
 #include "cpl_vsi.h"
+#include "cpl_worker_thread_pool.h"
 #include "gdal.h"
 #include "gdalwarper.h"
 
@@ -2762,6 +2763,371 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
     return GDT_Float32;
 }
 
+/************************************************************************/
+/*                        GDALOverviewChunkBand                         */
+/************************************************************************/
+
+// Stand-in for an overview band while one of its chunks is resampled by a
+// worker thread. The lines written by the resampling functions are kept in
+// memory and replayed, in order, on the real overview band by the calling
+// thread with Flush(), as GDALRasterBand objects are not thread-safe.
+
+namespace {
+
+class GDALOverviewChunkBand final: public GDALRasterBand
+{
+    struct WriteRequest
+    {
+        int nXOff;
+        int nYOff;
+        int nXSize;
+        int nYSize;
+    };
+
+    GDALRasterBand *poOverview;
+    int             nWinXOff;
+    int             nWinYOff;
+    int             nWinXSize;
+    int             nWinYSize;
+    GByte          *pabyData;
+    CPLString       osNBITS;
+    std::vector<WriteRequest> aoRequests{};
+
+    CPL_DISALLOW_COPY_ASSIGN(GDALOverviewChunkBand)
+
+  protected:
+    CPLErr IReadBlock( int, int, void * ) override;
+    CPLErr IRasterIO( GDALRWFlag, int, int, int, int,
+                      void *, int, int, GDALDataType,
+                      GSpacing, GSpacing,
+                      GDALRasterIOExtraArg* psExtraArg ) override;
+
+  public:
+    GDALOverviewChunkBand( GDALRasterBand* poOverviewIn,
+                           int nXOff, int nYOff, int nXSize, int nYSize );
+    ~GDALOverviewChunkBand() override;
+
+    bool IsValid() const { return pabyData != nullptr; }
+
+    // Window content, with lines of nWinXSize words of the overview data
+    // type. Lines not written by the resampling function are zero.
+    const GByte *GetData() const { return pabyData; }
+
+    const char *GetMetadataItem( const char * pszName,
+                                 const char * pszDomain = "" ) override;
+
+    CPLErr Flush();
+};
+
+}  // namespace
+
+/************************************************************************/
+/*                       GDALOverviewChunkBand()                        */
+/************************************************************************/
+
+GDALOverviewChunkBand::GDALOverviewChunkBand( GDALRasterBand* poOverviewIn,
+                                              int nXOff, int nYOff,
+                                              int nXSize, int nYSize ) :
+    GDALRasterBand(FALSE),
+    poOverview(poOverviewIn),
+    nWinXOff(nXOff),
+    nWinYOff(nYOff),
+    nWinXSize(nXSize),
+    nWinYSize(nYSize),
+    pabyData(nullptr)
+{
+    nRasterXSize = poOverview->GetXSize();
+    nRasterYSize = poOverview->GetYSize();
+    eDataType = poOverview->GetRasterDataType();
+    nBlockXSize = nRasterXSize;
+    nBlockYSize = 1;
+
+    // Fetched here as the resampling functions query it from the worker
+    // threads.
+    const char* pszNBITS =
+        poOverview->GetMetadataItem("NBITS", "IMAGE_STRUCTURE");
+    if( pszNBITS )
+        osNBITS = pszNBITS;
+
+    if( nWinXSize > 0 && nWinYSize > 0 )
+    {
+        pabyData = static_cast<GByte*>(VSI_CALLOC_VERBOSE(
+            static_cast<size_t>(nWinXSize) * nWinYSize,
+            GDALGetDataTypeSizeBytes(eDataType)));
+    }
+}
+
+/************************************************************************/
+/*                      ~GDALOverviewChunkBand()                        */
+/************************************************************************/
+
+GDALOverviewChunkBand::~GDALOverviewChunkBand()
+{
+    VSIFree(pabyData);
+}
+
+/************************************************************************/
+/*                            IReadBlock()                              */
+/************************************************************************/
+
+CPLErr GDALOverviewChunkBand::IReadBlock( int, int, void * )
+{
+    CPLError(CE_Failure, CPLE_NotSupported,
+             "GDALOverviewChunkBand::IReadBlock() not supported");
+    return CE_Failure;
+}
+
+/************************************************************************/
+/*                             IRasterIO()                              */
+/************************************************************************/
+
+CPLErr GDALOverviewChunkBand::IRasterIO( GDALRWFlag eRWFlag,
+                                         int nXOff, int nYOff,
+                                         int nXSize, int nYSize,
+                                         void * pData,
+                                         int nBufXSize, int nBufYSize,
+                                         GDALDataType eBufType,
+                                         GSpacing nPixelSpace,
+                                         GSpacing nLineSpace,
+                                         GDALRasterIOExtraArg* )
+{
+    if( eRWFlag != GF_Write || nXSize != nBufXSize || nYSize != nBufYSize ||
+        nXOff < nWinXOff || nXOff + nXSize > nWinXOff + nWinXSize ||
+        nYOff < nWinYOff || nYOff + nYSize > nWinYOff + nWinYSize )
+    {
+        CPLError(CE_Failure, CPLE_AppDefined,
+                 "Unexpected request (%d,%d)x%dx%d on overview chunk "
+                 "(%d,%d)x%dx%d",
+                 nXOff, nYOff, nXSize, nYSize,
+                 nWinXOff, nWinYOff, nWinXSize, nWinYSize);
+        return CE_Failure;
+    }
+
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    for( int iLine = 0; iLine < nYSize; ++iLine )
+    {
+        GDALCopyWords(
+            static_cast<GByte*>(pData) + iLine * nLineSpace,
+            eBufType, static_cast<int>(nPixelSpace),
+            pabyData + (static_cast<size_t>(nYOff - nWinYOff + iLine) *
+                            nWinXSize + (nXOff - nWinXOff)) * nDTSize,
+            eDataType, nDTSize,
+            nXSize);
+    }
+
+    WriteRequest oRequest;
+    oRequest.nXOff = nXOff;
+    oRequest.nYOff = nYOff;
+    oRequest.nXSize = nXSize;
+    oRequest.nYSize = nYSize;
+    aoRequests.push_back(oRequest);
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*                          GetMetadataItem()                           */
+/************************************************************************/
+
+const char *GDALOverviewChunkBand::GetMetadataItem( const char * pszName,
+                                                    const char * pszDomain )
+{
+    if( pszDomain != nullptr && EQUAL(pszDomain, "IMAGE_STRUCTURE") &&
+        EQUAL(pszName, "NBITS") )
+    {
+        return osNBITS.empty() ? nullptr : osNBITS.c_str();
+    }
+    return nullptr;
+}
+
+/************************************************************************/
+/*                               Flush()                                */
+/************************************************************************/
+
+CPLErr GDALOverviewChunkBand::Flush()
+{
+    const int nDTSize = GDALGetDataTypeSizeBytes(eDataType);
+    CPLErr eErr = CE_None;
+    for( size_t i = 0; i < aoRequests.size() && eErr == CE_None; ++i )
+    {
+        const WriteRequest& oRequest = aoRequests[i];
+        eErr = poOverview->RasterIO(
+            GF_Write, oRequest.nXOff, oRequest.nYOff,
+            oRequest.nXSize, oRequest.nYSize,
+            pabyData + (static_cast<size_t>(oRequest.nYOff - nWinYOff) *
+                            nWinXSize + (oRequest.nXOff - nWinXOff)) * nDTSize,
+            oRequest.nXSize, oRequest.nYSize, eDataType,
+            nDTSize, static_cast<GSpacing>(nWinXSize) * nDTSize, nullptr);
+    }
+    aoRequests.clear();
+    return eErr;
+}
+
+/************************************************************************/
+/*                       GDALOverviewResampleJob                        */
+/************************************************************************/
+
+typedef struct
+{
+    GDALResampleFunction pfnResampleFn;  // nullptr for complex data.
+    double          dfXRatioDstToSrc;
+    double          dfYRatioDstToSrc;
+    GDALDataType    eWrkDataType;
+    void           *pChunk;
+    GByte          *pabyChunkNodataMask;
+    int             nSrcWidth;
+    int             nSrcHeight;
+    int             nChunkXOff;
+    int             nChunkXSize;
+    int             nChunkYOff;
+    int             nChunkYSize;
+    int             nDstXOff;
+    int             nDstXOff2;
+    int             nDstYOff;
+    int             nDstYOff2;
+    GDALRasterBand *poOverview;
+    GDALOverviewChunkBand *poChunkBand;  // Used instead of poOverview if set.
+    const char     *pszResampling;
+    int             bHasNoData;
+    float           fNoDataValue;
+    GDALColorTable *poColorTable;
+    GDALDataType    eSrcDataType;
+    bool            bPropagateNoData;
+    CPLErr          eErr;
+} GDALOverviewResampleJob;
+
+static void GDALOverviewResampleJobFunc( void* pData )
+{
+    GDALOverviewResampleJob* psJob =
+        static_cast<GDALOverviewResampleJob*>(pData);
+    GDALRasterBand* poDstBand = psJob->poChunkBand != nullptr ?
+        psJob->poChunkBand : psJob->poOverview;
+
+    if( psJob->pfnResampleFn != nullptr )
+    {
+        psJob->eErr = psJob->pfnResampleFn(
+            psJob->dfXRatioDstToSrc, psJob->dfYRatioDstToSrc,
+            0.0, 0.0,
+            psJob->eWrkDataType,
+            psJob->pChunk,
+            psJob->pabyChunkNodataMask,
+            psJob->nChunkXOff, psJob->nChunkXSize,
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstXOff, psJob->nDstXOff2,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            poDstBand, psJob->pszResampling,
+            psJob->bHasNoData, psJob->fNoDataValue, psJob->poColorTable,
+            psJob->eSrcDataType,
+            psJob->bPropagateNoData);
+    }
+    else
+    {
+        psJob->eErr = GDALResampleChunkC32R(
+            psJob->nSrcWidth, psJob->nSrcHeight,
+            static_cast<float*>(psJob->pChunk),
+            psJob->nChunkYOff, psJob->nChunkYSize,
+            psJob->nDstYOff, psJob->nDstYOff2,
+            poDstBand, psJob->pszResampling);
+    }
+}
+
+/************************************************************************/
+/*                   GDALOverviewRunResampleJobs()                      */
+/************************************************************************/
+
+// Runs the jobs, either directly on the overview bands if there is no
+// thread pool, or on the pool through chunk bands which are then flushed
+// to the overview bands in the order of the jobs.
+// With bKeepChunkBands, chunk bands are always used, and are left to the
+// caller to flush and destroy.
+
+static CPLErr
+GDALOverviewRunResampleJobs( CPLWorkerThreadPool* poThreadPool,
+                             std::vector<GDALOverviewResampleJob>& asJobs,
+                             bool bKeepChunkBands = false )
+{
+    CPLErr eErr = CE_None;
+    if( poThreadPool == nullptr && !bKeepChunkBands )
+    {
+        for( size_t i = 0; i < asJobs.size() && eErr == CE_None; ++i )
+        {
+            asJobs[i].poChunkBand = nullptr;
+            GDALOverviewResampleJobFunc(&asJobs[i]);
+            eErr = asJobs[i].eErr;
+        }
+        asJobs.clear();
+        return eErr;
+    }
+
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        GDALOverviewResampleJob& sJob = asJobs[i];
+        sJob.poChunkBand = new GDALOverviewChunkBand(
+            sJob.poOverview,
+            sJob.nDstXOff, sJob.nDstYOff,
+            sJob.nDstXOff2 - sJob.nDstXOff, sJob.nDstYOff2 - sJob.nDstYOff);
+        sJob.eErr = CE_None;
+        if( !sJob.poChunkBand->IsValid() )
+            eErr = CE_Failure;
+        apJobs.push_back(&sJob);
+    }
+
+    if( eErr == CE_None )
+    {
+        if( poThreadPool == nullptr )
+        {
+            for( size_t i = 0; i < asJobs.size(); ++i )
+                GDALOverviewResampleJobFunc(&asJobs[i]);
+        }
+        else if( poThreadPool->SubmitJobs(GDALOverviewResampleJobFunc,
+                                          apJobs) )
+        {
+            poThreadPool->WaitCompletion();
+        }
+        else
+        {
+            eErr = CE_Failure;
+        }
+    }
+
+    if( bKeepChunkBands )
+    {
+        for( size_t i = 0; i < asJobs.size() && eErr == CE_None; ++i )
+            eErr = asJobs[i].eErr;
+        return eErr;
+    }
+
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        if( eErr == CE_None )
+            eErr = asJobs[i].eErr;
+        if( eErr == CE_None )
+            eErr = asJobs[i].poChunkBand->Flush();
+        delete asJobs[i].poChunkBand;
+        asJobs[i].poChunkBand = nullptr;
+    }
+    asJobs.clear();
+    return eErr;
+}
+
+/************************************************************************/
+/*                  GDALOverviewCreateThreadPool()                      */
+/************************************************************************/
+
+// Returns a thread pool sized according to GDAL_NUM_THREADS, or nullptr if
+// overviews must be computed by the calling thread only (the default).
+
+static CPLWorkerThreadPool* GDALOverviewCreateThreadPool()
+{
+    const int nThreads = CPLGetNumThreads(nullptr);
+    if( nThreads <= 1 )
+        return nullptr;
+
+    CPLDebug("GDAL", "Computing overviews with %d threads", nThreads);
+    return CPLCreateWorkerThreadPool(nThreads);
+}
+
 /************************************************************************/
 /*                      GDALRegenerateOverviews()                       */
 /************************************************************************/
@@ -2785,6 +3151,11 @@ GDALDataType GDALGetOvrWorkDataType( const char* pszResampling,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * Starting with GDAL 2.4, several chunks and overview levels are resampled in
+ * parallel according to the \ref gdal_utilities_num_threads "GDAL_NUM_THREADS"
+ * configuration option. Reading and writing are still done by the calling
+ * thread, and in the same order as in the single-threaded case.
+ *
  * @param hSrcBand the source (base level) band.
  * @param nOverviewCount the number of downsampled bands being generated.
  * @param pahOvrBands the list of downsampled bands to be generated.
@@ -2946,20 +3317,38 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     const int nMaxChunkYSizeQueried =
         nFullResYChunk + 2 * nKernelRadius * nMaxOvrFactor;
 
-    GByte *pabyChunkNodataMask = nullptr;
-    void *pChunk =
-        VSI_MALLOC3_VERBOSE(
-            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
-    if( bUseNoDataMask )
+/* -------------------------------------------------------------------- */
+/*      With several threads, chunks are read in batches, each one in   */
+/*      its own buffer, resampled in parallel and written in order.     */
+/* -------------------------------------------------------------------- */
+    CPLWorkerThreadPool* poThreadPool = GDALOverviewCreateThreadPool();
+    const int nChunkBuffers =
+        poThreadPool != nullptr ? poThreadPool->GetThreadCount() : 1;
+
+    std::vector<void*> apChunk(nChunkBuffers, nullptr);
+    std::vector<GByte*> apabyChunkNodataMask(nChunkBuffers, nullptr);
+    bool bAllocOK = true;
+    for( int i = 0; i < nChunkBuffers && bAllocOK; ++i )
     {
-        pabyChunkNodataMask =
-            static_cast<GByte*>(VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth ));
+        apChunk[i] = VSI_MALLOC3_VERBOSE(
+            GDALGetDataTypeSizeBytes(eType), nMaxChunkYSizeQueried, nWidth );
+        if( bUseNoDataMask )
+        {
+            apabyChunkNodataMask[i] = static_cast<GByte*>(
+                VSI_MALLOC2_VERBOSE( nMaxChunkYSizeQueried, nWidth ));
+        }
+        bAllocOK = apChunk[i] != nullptr &&
+                   (!bUseNoDataMask || apabyChunkNodataMask[i] != nullptr);
     }
 
-    if( pChunk == nullptr || (bUseNoDataMask && pabyChunkNodataMask == nullptr))
+    if( !bAllocOK )
     {
-        CPLFree(pChunk);
-        CPLFree(pabyChunkNodataMask);
+        for( int i = 0; i < nChunkBuffers; ++i )
+        {
+            CPLFree(apChunk[i]);
+            CPLFree(apabyChunkNodataMask[i]);
+        }
+        delete poThreadPool;
         return CE_Failure;
     }
 
@@ -2974,6 +3363,8 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
 /* -------------------------------------------------------------------- */
     int nChunkYOff = 0;
     CPLErr eErr = CE_None;
+    std::vector<GDALOverviewResampleJob> asJobs;
+    int iChunkBuffer = 0;
 
     for( nChunkYOff = 0;
          nChunkYOff < nHeight && eErr == CE_None;
@@ -3000,6 +3391,9 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
         if( nChunkYOffQueried + nChunkYSizeQueried > nHeight )
             nChunkYSizeQueried = nHeight - nChunkYOffQueried;
 
+        void* const pChunk = apChunk[iChunkBuffer];
+        GByte* const pabyChunkNodataMask = apabyChunkNodataMask[iChunkBuffer];
+
         // Read chunk.
         if( eErr == CE_None )
             eErr = poSrcBand->RasterIO(
@@ -3118,35 +3512,54 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
                 0, nDstYOff, nDstWidth, nDstYOff2 - nDstYOff );
 #endif
 
-            if( eType == GDT_Byte ||
-                eType == GDT_UInt16 ||
-                eType == GDT_Float32 )
-                eErr = pfnResampleFn(
-                    dfXRatioDstToSrc, dfYRatioDstToSrc,
-                    0.0, 0.0,
-                    eType,
-                    pChunk,
-                    pabyChunkNodataMask,
-                    0, nWidth,
-                    nChunkYOffQueried, nChunkYSizeQueried,
-                    0, nDstWidth,
-                    nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling,
-                    bHasNoData, fNoDataValue, poColorTable,
-                    poSrcBand->GetRasterDataType(),
-                    bPropagateNoData);
-            else
-                eErr = GDALResampleChunkC32R(
-                    nWidth, nHeight,
-                    static_cast<float*>(pChunk),
-                    nChunkYOffQueried, nChunkYSizeQueried,
-                    nDstYOff, nDstYOff2,
-                    papoOvrBands[iOverview], pszResampling);
+            GDALOverviewResampleJob sJob;
+            sJob.pfnResampleFn =
+                ( eType == GDT_Byte ||
+                  eType == GDT_UInt16 ||
+                  eType == GDT_Float32 ) ? pfnResampleFn : nullptr;
+            sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+            sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+            sJob.eWrkDataType = eType;
+            sJob.pChunk = pChunk;
+            sJob.pabyChunkNodataMask = pabyChunkNodataMask;
+            sJob.nSrcWidth = nWidth;
+            sJob.nSrcHeight = nHeight;
+            sJob.nChunkXOff = 0;
+            sJob.nChunkXSize = nWidth;
+            sJob.nChunkYOff = nChunkYOffQueried;
+            sJob.nChunkYSize = nChunkYSizeQueried;
+            sJob.nDstXOff = 0;
+            sJob.nDstXOff2 = nDstWidth;
+            sJob.nDstYOff = nDstYOff;
+            sJob.nDstYOff2 = nDstYOff2;
+            sJob.poOverview = papoOvrBands[iOverview];
+            sJob.poChunkBand = nullptr;
+            sJob.pszResampling = pszResampling;
+            sJob.bHasNoData = bHasNoData;
+            sJob.fNoDataValue = fNoDataValue;
+            sJob.poColorTable = poColorTable;
+            sJob.eSrcDataType = poSrcBand->GetRasterDataType();
+            sJob.bPropagateNoData = bPropagateNoData;
+            sJob.eErr = CE_None;
+            asJobs.push_back(sJob);
+        }
+
+        if( eErr == CE_None && ++iChunkBuffer == nChunkBuffers )
+        {
+            eErr = GDALOverviewRunResampleJobs(poThreadPool, asJobs);
+            iChunkBuffer = 0;
         }
     }
 
-    VSIFree( pChunk );
-    VSIFree( pabyChunkNodataMask );
+    if( eErr == CE_None )
+        eErr = GDALOverviewRunResampleJobs(poThreadPool, asJobs);
+
+    for( int i = 0; i < nChunkBuffers; ++i )
+    {
+        VSIFree( apChunk[i] );
+        VSIFree( apabyChunkNodataMask[i] );
+    }
+    delete poThreadPool;
 
 /* -------------------------------------------------------------------- */
 /*      Renormalized overview mean / stddev if needed.                  */
@@ -3176,6 +3589,432 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
     return eErr;
 }
 
+/************************************************************************/
+/*                      GDALOverviewPyramidLevel                        */
+/************************************************************************/
+
+// State of one overview level in the single pass pyramid used by
+// GDALRegenerateOverviewsMultiBand(): each level is computed strip by strip
+// (a strip being a row of overview blocks) as soon as the lines it needs
+// from the previous level are available in memory.
+
+struct GDALOverviewPyramidLevel
+{
+    int     nSrcWidth;
+    int     nSrcHeight;
+    int     nDstWidth;
+    int     nDstHeight;
+    int     nDstBlockXSize;
+    int     nDstBlockYSize;
+    double  dfXRatioDstToSrc;
+    double  dfYRatioDstToSrc;
+    int     nOvrFactor;
+    int     nNextDstYOff;  // First line of the next strip to compute.
+
+    // Lines [nWinYOff, nNextDstYOff) of the level, one buffer per band, in
+    // the working data type, kept until the next level no longer needs them.
+    int     nWinYOff;
+    std::vector<std::vector<GByte>> aabyWin;
+};
+
+struct GDALOverviewPyramid
+{
+    int                  nBands;
+    GDALRasterBand     **papoSrcBands;
+    GDALRasterBand    ***papapoOverviewBands;
+    const char          *pszResampling;
+    GDALResampleFunction pfnResampleFn;
+    int                  nKernelRadius;
+    GDALDataType         eDataType;
+    GDALDataType         eWrkDataType;
+    const int           *pabHasNoData;
+    const float         *pafNoDataValue;
+    bool                 bPropagateNoData;
+    CPLWorkerThreadPool *poThreadPool;
+    int                  nChunkBuffers;
+    std::vector<void*>   apaChunk;  // nChunkBuffers * nBands buffers.
+    std::vector<GDALOverviewPyramidLevel> asLevels;
+};
+
+/************************************************************************/
+/*                    GDALOverviewPyramidGetStrip()                     */
+/************************************************************************/
+
+// Computes the source lines needed for the strip starting at nDstYOff, the
+// same way as the per level code of GDALRegenerateOverviewsMultiBand().
+
+static void GDALOverviewPyramidGetStrip( const GDALOverviewPyramidLevel& sLevel,
+                                         int nKernelRadius, int nDstYOff,
+                                         int* pnDstYCount, int* pnYCount,
+                                         int* pnChunkYOffQueried,
+                                         int* pnChunkYSizeQueried )
+{
+    const int nDstYCount =
+        std::min(sLevel.nDstBlockYSize, sLevel.nDstHeight - nDstYOff);
+
+    const int nChunkYOff =
+        static_cast<int>(nDstYOff * sLevel.dfYRatioDstToSrc);
+    int nChunkYOff2 = static_cast<int>(
+        ceil((nDstYOff + nDstYCount) * sLevel.dfYRatioDstToSrc) );
+    if( nChunkYOff2 > sLevel.nSrcHeight ||
+        nDstYOff + nDstYCount == sLevel.nDstHeight )
+        nChunkYOff2 = sLevel.nSrcHeight;
+    const int nYCount = nChunkYOff2 - nChunkYOff;
+
+    int nChunkYOffQueried = nChunkYOff - nKernelRadius * sLevel.nOvrFactor;
+    int nChunkYSizeQueried = nYCount + 2 * nKernelRadius * sLevel.nOvrFactor;
+    if( nChunkYOffQueried < 0 )
+    {
+        nChunkYSizeQueried += nChunkYOffQueried;
+        nChunkYOffQueried = 0;
+    }
+    if( nChunkYSizeQueried + nChunkYOffQueried > sLevel.nSrcHeight )
+        nChunkYSizeQueried = sLevel.nSrcHeight - nChunkYOffQueried;
+
+    *pnDstYCount = nDstYCount;
+    *pnYCount = nYCount;
+    *pnChunkYOffQueried = nChunkYOffQueried;
+    *pnChunkYSizeQueried = nChunkYSizeQueried;
+}
+
+/************************************************************************/
+/*                   GDALOverviewPyramidIsReady()                       */
+/************************************************************************/
+
+// Returns whether the next strip of level iLevel can be computed.
+
+static bool GDALOverviewPyramidIsReady( const GDALOverviewPyramid& sPyr,
+                                        int iLevel )
+{
+    const GDALOverviewPyramidLevel& sLevel = sPyr.asLevels[iLevel];
+    if( sLevel.nNextDstYOff >= sLevel.nDstHeight )
+        return false;
+    if( iLevel == 0 )
+        return true;
+
+    int nDstYCount = 0;
+    int nYCount = 0;
+    int nChunkYOffQueried = 0;
+    int nChunkYSizeQueried = 0;
+    GDALOverviewPyramidGetStrip( sLevel, sPyr.nKernelRadius,
+                                 sLevel.nNextDstYOff,
+                                 &nDstYCount, &nYCount,
+                                 &nChunkYOffQueried, &nChunkYSizeQueried );
+    return nChunkYOffQueried + nChunkYSizeQueried <=
+           sPyr.asLevels[iLevel - 1].nNextDstYOff;
+}
+
+/************************************************************************/
+/*                  GDALOverviewPyramidFlushJobs()                      */
+/************************************************************************/
+
+// Runs the jobs of a batch of blocks of level iLevel, keeps their result in
+// the window of the level if the next one needs it, and writes them.
+
+static CPLErr GDALOverviewPyramidFlushJobs(
+    GDALOverviewPyramid& sPyr, int iLevel,
+    std::vector<GDALOverviewResampleJob>& asJobs )
+{
+    GDALOverviewPyramidLevel& sLevel = sPyr.asLevels[iLevel];
+    const bool bKeepWindow =
+        iLevel + 1 < static_cast<int>(sPyr.asLevels.size());
+    const int nDTSize = GDALGetDataTypeSizeBytes(sPyr.eDataType);
+    const int nWrkDTSize = GDALGetDataTypeSizeBytes(sPyr.eWrkDataType);
+
+    CPLErr eErr = GDALOverviewRunResampleJobs(sPyr.poThreadPool, asJobs, true);
+
+    for( size_t i = 0; i < asJobs.size(); ++i )
+    {
+        const GDALOverviewResampleJob& sJob = asJobs[i];
+        GDALOverviewChunkBand* poChunkBand = sJob.poChunkBand;
+        if( eErr == CE_None && bKeepWindow )
+        {
+            // Jobs are queued band after band for each block.
+            std::vector<GByte>& abyWin =
+                sLevel.aabyWin[i % static_cast<size_t>(sPyr.nBands)];
+            const int nXSize = sJob.nDstXOff2 - sJob.nDstXOff;
+            for( int iY = sJob.nDstYOff; iY < sJob.nDstYOff2; ++iY )
+            {
+                GDALCopyWords(
+                    poChunkBand->GetData() +
+                        static_cast<size_t>(iY - sJob.nDstYOff) *
+                            nXSize * nDTSize,
+                    sPyr.eDataType, nDTSize,
+                    &abyWin[(static_cast<size_t>(iY - sLevel.nWinYOff) *
+                                sLevel.nDstWidth + sJob.nDstXOff) *
+                            nWrkDTSize],
+                    sPyr.eWrkDataType, nWrkDTSize,
+                    nXSize);
+            }
+        }
+        if( eErr == CE_None )
+            eErr = poChunkBand->Flush();
+        delete poChunkBand;
+    }
+    asJobs.clear();
+    return eErr;
+}
+
+/************************************************************************/
+/*                 GDALOverviewPyramidComputeStrip()                    */
+/************************************************************************/
+
+static CPLErr GDALOverviewPyramidComputeStrip( GDALOverviewPyramid& sPyr,
+                                               int iLevel )
+{
+    GDALOverviewPyramidLevel& sLevel = sPyr.asLevels[iLevel];
+    const int nBands = sPyr.nBands;
+    const int nKernelRadius = sPyr.nKernelRadius;
+    const int nWrkDTSize = GDALGetDataTypeSizeBytes(sPyr.eWrkDataType);
+    const int nDstYOff = sLevel.nNextDstYOff;
+
+    int nDstYCount = 0;
+    int nYCount = 0;
+    int nChunkYOffQueried = 0;
+    int nChunkYSizeQueried = 0;
+    GDALOverviewPyramidGetStrip( sLevel, nKernelRadius, nDstYOff,
+                                 &nDstYCount, &nYCount,
+                                 &nChunkYOffQueried, &nChunkYSizeQueried );
+
+    if( iLevel + 1 < static_cast<int>(sPyr.asLevels.size()) )
+    {
+        try
+        {
+            for( int iBand = 0; iBand < nBands; ++iBand )
+            {
+                sLevel.aabyWin[iBand].resize(
+                    static_cast<size_t>(nDstYOff + nDstYCount -
+                                        sLevel.nWinYOff) *
+                    sLevel.nDstWidth * nWrkDTSize );
+            }
+        }
+        catch( const std::bad_alloc& )
+        {
+            CPLError(CE_Failure, CPLE_OutOfMemory,
+                     "Cannot allocate overview lines");
+            return CE_Failure;
+        }
+    }
+
+    CPLErr eErr = CE_None;
+    std::vector<GDALOverviewResampleJob> asJobs;
+    int iChunkBuffer = 0;
+    for( int nDstXOff = 0;
+         nDstXOff < sLevel.nDstWidth && eErr == CE_None;
+         nDstXOff += sLevel.nDstBlockXSize )
+    {
+        const int nDstXCount =
+            std::min(sLevel.nDstBlockXSize, sLevel.nDstWidth - nDstXOff);
+
+        const int nChunkXOff =
+            static_cast<int>(nDstXOff * sLevel.dfXRatioDstToSrc);
+        int nChunkXOff2 = static_cast<int>(
+            ceil((nDstXOff + nDstXCount) * sLevel.dfXRatioDstToSrc) );
+        if( nChunkXOff2 > sLevel.nSrcWidth ||
+            nDstXOff + nDstXCount == sLevel.nDstWidth )
+            nChunkXOff2 = sLevel.nSrcWidth;
+        const int nXCount = nChunkXOff2 - nChunkXOff;
+
+        int nChunkXOffQueried = nChunkXOff - nKernelRadius * sLevel.nOvrFactor;
+        int nChunkXSizeQueried =
+            nXCount + 2 * nKernelRadius * sLevel.nOvrFactor;
+        if( nChunkXOffQueried < 0 )
+        {
+            nChunkXSizeQueried += nChunkXOffQueried;
+            nChunkXOffQueried = 0;
+        }
+        if( nChunkXSizeQueried + nChunkXOffQueried > sLevel.nSrcWidth )
+            nChunkXSizeQueried = sLevel.nSrcWidth - nChunkXOffQueried;
+
+        void** const papaChunk =
+            &sPyr.apaChunk[static_cast<size_t>(iChunkBuffer) * nBands];
+
+        // Read the source buffers for all the bands, from the base image
+        // for the first level, and from memory for the next ones.
+        for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
+        {
+            if( iLevel == 0 )
+            {
+                eErr = sPyr.papoSrcBands[iBand]->RasterIO(
+                    GF_Read,
+                    nChunkXOffQueried, nChunkYOffQueried,
+                    nChunkXSizeQueried, nChunkYSizeQueried,
+                    papaChunk[iBand],
+                    nChunkXSizeQueried, nChunkYSizeQueried,
+                    sPyr.eWrkDataType, 0, 0, nullptr );
+                continue;
+            }
+
+            const GDALOverviewPyramidLevel& sPrevLevel =
+                sPyr.asLevels[iLevel - 1];
+            const GByte* pabyWin = sPrevLevel.aabyWin[iBand].data();
+            for( int iY = 0; iY < nChunkYSizeQueried; ++iY )
+            {
+                memcpy( static_cast<GByte*>(papaChunk[iBand]) +
+                            static_cast<size_t>(iY) * nChunkXSizeQueried *
+                                nWrkDTSize,
+                        pabyWin +
+                            (static_cast<size_t>(nChunkYOffQueried + iY -
+                                                 sPrevLevel.nWinYOff) *
+                                 sPrevLevel.nDstWidth + nChunkXOffQueried) *
+                                nWrkDTSize,
+                        static_cast<size_t>(nChunkXSizeQueried) * nWrkDTSize );
+            }
+        }
+
+        for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
+        {
+            GDALOverviewResampleJob sJob;
+            sJob.pfnResampleFn = sPyr.pfnResampleFn;
+            sJob.dfXRatioDstToSrc = sLevel.dfXRatioDstToSrc;
+            sJob.dfYRatioDstToSrc = sLevel.dfYRatioDstToSrc;
+            sJob.eWrkDataType = sPyr.eWrkDataType;
+            sJob.pChunk = papaChunk[iBand];
+            sJob.pabyChunkNodataMask = nullptr;
+            sJob.nSrcWidth = sLevel.nSrcWidth;
+            sJob.nSrcHeight = sLevel.nSrcHeight;
+            sJob.nChunkXOff = nChunkXOffQueried;
+            sJob.nChunkXSize = nChunkXSizeQueried;
+            sJob.nChunkYOff = nChunkYOffQueried;
+            sJob.nChunkYSize = nChunkYSizeQueried;
+            sJob.nDstXOff = nDstXOff;
+            sJob.nDstXOff2 = nDstXOff + nDstXCount;
+            sJob.nDstYOff = nDstYOff;
+            sJob.nDstYOff2 = nDstYOff + nDstYCount;
+            sJob.poOverview = sPyr.papapoOverviewBands[iBand][iLevel];
+            sJob.poChunkBand = nullptr;
+            sJob.pszResampling = sPyr.pszResampling;
+            sJob.bHasNoData = sPyr.pabHasNoData[iBand];
+            sJob.fNoDataValue = sPyr.pafNoDataValue[iBand];
+            sJob.poColorTable = nullptr;
+            sJob.eSrcDataType = sPyr.eDataType;
+            sJob.bPropagateNoData = sPyr.bPropagateNoData;
+            sJob.eErr = CE_None;
+            asJobs.push_back(sJob);
+        }
+
+        if( eErr == CE_None && ++iChunkBuffer == sPyr.nChunkBuffers )
+        {
+            eErr = GDALOverviewPyramidFlushJobs(sPyr, iLevel, asJobs);
+            iChunkBuffer = 0;
+        }
+    }
+
+    if( eErr == CE_None && !asJobs.empty() )
+        eErr = GDALOverviewPyramidFlushJobs(sPyr, iLevel, asJobs);
+    if( eErr != CE_None )
+        return eErr;
+
+    sLevel.nNextDstYOff += nDstYCount;
+
+    // Release the lines of the previous level that are no longer needed.
+    if( iLevel > 0 )
+    {
+        GDALOverviewPyramidLevel& sPrevLevel = sPyr.asLevels[iLevel - 1];
+        int nKeepYOff = sPrevLevel.nNextDstYOff;
+        if( sLevel.nNextDstYOff < sLevel.nDstHeight )
+        {
+            GDALOverviewPyramidGetStrip( sLevel, nKernelRadius,
+                                         sLevel.nNextDstYOff,
+                                         &nDstYCount, &nYCount,
+                                         &nChunkYOffQueried,
+                                         &nChunkYSizeQueried );
+            nKeepYOff = std::min(nKeepYOff, nChunkYOffQueried);
+        }
+        if( nKeepYOff > sPrevLevel.nWinYOff )
+        {
+            const size_t nDropSize =
+                static_cast<size_t>(nKeepYOff - sPrevLevel.nWinYOff) *
+                sPrevLevel.nDstWidth * nWrkDTSize;
+            for( int iBand = 0; iBand < nBands; ++iBand )
+            {
+                std::vector<GByte>& abyWin = sPrevLevel.aabyWin[iBand];
+                abyWin.erase(abyWin.begin(), abyWin.begin() + nDropSize);
+            }
+            sPrevLevel.nWinYOff = nKeepYOff;
+        }
+    }
+
+    return CE_None;
+}
+
+/************************************************************************/
+/*             GDALRegenerateOverviewsMultiBandSinglePass()             */
+/************************************************************************/
+
+// Computes all the overview levels in a single pass over the base image:
+// each strip of a level is pushed to the next level as soon as it is
+// computed, instead of reading back the previous level from the overview
+// bands. Only used when no mask is involved and each level is smaller than
+// the previous one.
+
+static CPLErr GDALRegenerateOverviewsMultiBandSinglePass(
+    GDALOverviewPyramid& sPyr,
+    double dfTotalPixelCount,
+    GDALProgressFunc pfnProgress,
+    void * pProgressData )
+{
+    const int nBands = sPyr.nBands;
+    const int nOverviews = static_cast<int>(sPyr.asLevels.size());
+    double dfCurPixelCount = 0;
+    CPLErr eErr = CE_None;
+
+    // Process the first level strip after strip, and after each strip, all
+    // the strips of the next levels that have become computable.
+    while( eErr == CE_None &&
+           sPyr.asLevels[nOverviews - 1].nNextDstYOff <
+                sPyr.asLevels[nOverviews - 1].nDstHeight )
+    {
+        for( int iLevel = 0; iLevel < nOverviews && eErr == CE_None; ++iLevel )
+        {
+            GDALOverviewPyramidLevel& sLevel = sPyr.asLevels[iLevel];
+            while( eErr == CE_None &&
+                   GDALOverviewPyramidIsReady(sPyr, iLevel) )
+            {
+                if( !pfnProgress( dfCurPixelCount / dfTotalPixelCount,
+                                  nullptr, pProgressData ) )
+                {
+                    CPLError( CE_Failure, CPLE_UserInterrupt,
+                              "User terminated" );
+                    eErr = CE_Failure;
+                    break;
+                }
+
+                int nDstYCount = 0;
+                int nYCount = 0;
+                int nChunkYOffQueried = 0;
+                int nChunkYSizeQueried = 0;
+                GDALOverviewPyramidGetStrip( sLevel, sPyr.nKernelRadius,
+                                             sLevel.nNextDstYOff,
+                                             &nDstYCount, &nYCount,
+                                             &nChunkYOffQueried,
+                                             &nChunkYSizeQueried );
+
+                eErr = GDALOverviewPyramidComputeStrip(sPyr, iLevel);
+                dfCurPixelCount +=
+                    static_cast<double>(nYCount) * sLevel.nSrcWidth;
+
+                if( eErr == CE_None &&
+                    sLevel.nNextDstYOff == sLevel.nDstHeight )
+                {
+                    for( int iBand = 0; iBand < nBands; ++iBand )
+                    {
+                        sPyr.papapoOverviewBands[iBand][iLevel]->
+                            FlushCache();
+                    }
+                }
+
+                // Only one strip of the first level at a time, so that
+                // the next levels can make progress.
+                if( iLevel == 0 )
+                    break;
+            }
+        }
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*            GDALRegenerateOverviewsMultiBand()                        */
 /************************************************************************/
@@ -3208,6 +4047,18 @@ GDALRegenerateOverviews( GDALRasterBandH hSrcBand,
  * considered as the nodata value and not each value of the triplet
  * independently per band.
  *
+ * When several overview levels are requested, each one smaller than the
+ * previous one, and no mask is involved, all the levels are computed in a
+ * single pass over the source: each row of blocks of a level is kept in memory
+ * and used to compute the next level as soon as possible, instead of reading
+ * the previous level back. Setting the GDAL_OVR_SINGLE_PASS configuration
+ * option to NO restores the level by level computation.
+ *
+ * Starting with GDAL 2.4, several blocks and bands are resampled in parallel
+ * according to the \ref gdal_utilities_num_threads "GDAL_NUM_THREADS"
+ * configuration option. Reading and writing are still done by the calling
+ * thread, and in the same order as in the single-threaded case.
+ *
  * @param nBands the number of bands, size of papoSrcBands and size of
  *               first dimension of papapoOverviewBands
  * @param papoSrcBands the list of source bands to downsample
@@ -3362,6 +4213,110 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
     const bool bPropagateNoData =
         CPLTestBool( CPLGetConfigOption("GDAL_OVR_PROPAGATE_NODATA", "NO") );
 
+    CPLWorkerThreadPool* poThreadPool = GDALOverviewCreateThreadPool();
+    const int nChunkBuffers =
+        poThreadPool != nullptr ? poThreadPool->GetThreadCount() : 1;
+
+    // Compute all the levels in a single pass over the base image if each
+    // one can be computed from the previous one. Not done with a mask, as
+    // the masks of the overview levels are not kept in memory.
+    bool bSinglePass =
+        nOverviews > 1 && !bUseNoDataMask &&
+        CPLTestBool( CPLGetConfigOption("GDAL_OVR_SINGLE_PASS", "YES") );
+    for( int iOverview = 1; bSinglePass && iOverview < nOverviews;
+         ++iOverview )
+    {
+        if( papapoOverviewBands[0][iOverview - 1]->GetXSize() <=
+            papapoOverviewBands[0][iOverview]->GetXSize() )
+            bSinglePass = false;
+    }
+    if( bSinglePass )
+    {
+        GDALOverviewPyramid sPyr;
+        sPyr.nBands = nBands;
+        sPyr.papoSrcBands = papoSrcBands;
+        sPyr.papapoOverviewBands = papapoOverviewBands;
+        sPyr.pszResampling = pszResampling;
+        sPyr.pfnResampleFn = pfnResampleFn;
+        sPyr.nKernelRadius = nKernelRadius;
+        sPyr.eDataType = eDataType;
+        sPyr.eWrkDataType = eWrkDataType;
+        sPyr.pabHasNoData = pabHasNoData;
+        sPyr.pafNoDataValue = pafNoDataValue;
+        sPyr.bPropagateNoData = bPropagateNoData;
+        sPyr.poThreadPool = poThreadPool;
+        sPyr.nChunkBuffers = nChunkBuffers;
+
+        size_t nMaxChunkSize = 0;
+        sPyr.asLevels.resize(nOverviews);
+        for( int iOverview = 0; iOverview < nOverviews; ++iOverview )
+        {
+            GDALOverviewPyramidLevel& sLevel = sPyr.asLevels[iOverview];
+            GDALRasterBand* poOvrBand = papapoOverviewBands[0][iOverview];
+            if( iOverview == 0 )
+            {
+                sLevel.nSrcWidth = nSrcWidth;
+                sLevel.nSrcHeight = nSrcHeight;
+            }
+            else
+            {
+                sLevel.nSrcWidth = sPyr.asLevels[iOverview - 1].nDstWidth;
+                sLevel.nSrcHeight = sPyr.asLevels[iOverview - 1].nDstHeight;
+            }
+            sLevel.nDstWidth = poOvrBand->GetXSize();
+            sLevel.nDstHeight = poOvrBand->GetYSize();
+            poOvrBand->GetBlockSize( &sLevel.nDstBlockXSize,
+                                     &sLevel.nDstBlockYSize );
+            sLevel.dfXRatioDstToSrc =
+                static_cast<double>(sLevel.nSrcWidth) / sLevel.nDstWidth;
+            sLevel.dfYRatioDstToSrc =
+                static_cast<double>(sLevel.nSrcHeight) / sLevel.nDstHeight;
+            sLevel.nOvrFactor = std::max(
+                static_cast<int>(0.5 + sLevel.dfXRatioDstToSrc),
+                static_cast<int>(0.5 + sLevel.dfYRatioDstToSrc) );
+            if( sLevel.nOvrFactor == 0 ) sLevel.nOvrFactor = 1;
+            sLevel.nNextDstYOff = 0;
+            sLevel.nWinYOff = 0;
+            sLevel.aabyWin.resize(nBands);
+
+            const size_t nFullResXChunkQueried =
+                2 + static_cast<int>(sLevel.nDstBlockXSize *
+                                     sLevel.dfXRatioDstToSrc) +
+                2 * nKernelRadius * sLevel.nOvrFactor;
+            const size_t nFullResYChunkQueried =
+                2 + static_cast<int>(sLevel.nDstBlockYSize *
+                                     sLevel.dfYRatioDstToSrc) +
+                2 * nKernelRadius * sLevel.nOvrFactor;
+            nMaxChunkSize = std::max(
+                nMaxChunkSize, nFullResXChunkQueried * nFullResYChunkQueried);
+        }
+
+        CPLErr eErr = CE_None;
+        sPyr.apaChunk.resize(static_cast<size_t>(nChunkBuffers) * nBands);
+        for( size_t i = 0; i < sPyr.apaChunk.size() && eErr == CE_None; ++i )
+        {
+            sPyr.apaChunk[i] = VSI_MALLOC2_VERBOSE(
+                nMaxChunkSize, GDALGetDataTypeSizeBytes(eWrkDataType) );
+            if( sPyr.apaChunk[i] == nullptr )
+                eErr = CE_Failure;
+        }
+
+        if( eErr == CE_None )
+            eErr = GDALRegenerateOverviewsMultiBandSinglePass(
+                sPyr, dfTotalPixelCount, pfnProgress, pProgressData );
+
+        for( size_t i = 0; i < sPyr.apaChunk.size(); ++i )
+            CPLFree(sPyr.apaChunk[i]);
+        delete poThreadPool;
+        CPLFree(pabHasNoData);
+        CPLFree(pafNoDataValue);
+
+        if( eErr == CE_None )
+            pfnProgress( 1.0, nullptr, pProgressData );
+
+        return eErr;
+    }
+
     // Second pass to do the real job.
     double dfCurPixelCount = 0;
     CPLErr eErr = CE_None;
@@ -3409,48 +4364,40 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
         const int nFullResYChunkQueried =
             nFullResYChunk + 2 * nKernelRadius * nOvrFactor;
 
-        void** papaChunk = static_cast<void **>(
-            VSI_MALLOC_VERBOSE(nBands * sizeof(void*)) );
-        if( papaChunk == nullptr )
-        {
-            CPLFree(pabHasNoData);
-            CPLFree(pafNoDataValue);
-            return CE_Failure;
-        }
-        GByte* pabyChunkNoDataMask = nullptr;
-        for( int iBand = 0; iBand < nBands; ++iBand )
+        // With several threads, blocks are read in batches, each one in its
+        // own set of buffers, resampled in parallel and written in order.
+        std::vector<void*> apaChunk(
+            static_cast<size_t>(nChunkBuffers) * nBands, nullptr);
+        std::vector<GByte*> apabyChunkNoDataMask(nChunkBuffers, nullptr);
+        bool bAllocOK = true;
+        for( size_t i = 0; i < apaChunk.size() && bAllocOK; ++i )
         {
-            papaChunk[iBand] = VSI_MALLOC3_VERBOSE(
+            apaChunk[i] = VSI_MALLOC3_VERBOSE(
                 nFullResXChunkQueried,
                 nFullResYChunkQueried,
                 GDALGetDataTypeSizeBytes(eWrkDataType) );
-            if( papaChunk[iBand] == nullptr )
-            {
-                while ( --iBand >= 0)
-                    CPLFree(papaChunk[iBand]);
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
+            bAllocOK = apaChunk[i] != nullptr;
         }
-        if( bUseNoDataMask )
+        for( int i = 0; i < nChunkBuffers && bAllocOK && bUseNoDataMask; ++i )
         {
-            pabyChunkNoDataMask = static_cast<GByte *>(
+            apabyChunkNoDataMask[i] = static_cast<GByte *>(
                 VSI_MALLOC2_VERBOSE( nFullResXChunkQueried,
                                      nFullResYChunkQueried ) );
-            if( pabyChunkNoDataMask == nullptr )
-            {
-                for( int iBand = 0; iBand < nBands; ++iBand )
-                {
-                    CPLFree(papaChunk[iBand]);
-                }
-                CPLFree(papaChunk);
-                CPLFree(pabHasNoData);
-                CPLFree(pafNoDataValue);
-                return CE_Failure;
-            }
+            bAllocOK = apabyChunkNoDataMask[i] != nullptr;
+        }
+        if( !bAllocOK )
+        {
+            for( size_t i = 0; i < apaChunk.size(); ++i )
+                CPLFree(apaChunk[i]);
+            for( int i = 0; i < nChunkBuffers; ++i )
+                CPLFree(apabyChunkNoDataMask[i]);
+            CPLFree(pabHasNoData);
+            CPLFree(pafNoDataValue);
+            delete poThreadPool;
+            return CE_Failure;
         }
+        std::vector<GDALOverviewResampleJob> asJobs;
+        int iChunkBuffer = 0;
 
         int nDstYOff = 0;
         // Iterate on destination overview, block by block.
@@ -3534,6 +4481,11 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                     nDstXOff, nDstYOff, nDstXCount, nDstYCount );
 #endif
 
+                void** const papaChunk = &apaChunk[
+                    static_cast<size_t>(iChunkBuffer) * nBands];
+                GByte* const pabyChunkNoDataMask =
+                    apabyChunkNoDataMask[iChunkBuffer];
+
                 // Read the source buffers for all the bands.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
@@ -3570,39 +4522,61 @@ GDALRegenerateOverviewsMultiBand( int nBands, GDALRasterBand** papoSrcBands,
                 // Compute the resulting overview block.
                 for( int iBand = 0; iBand < nBands && eErr == CE_None; ++iBand )
                 {
-                    eErr = pfnResampleFn(
-                        dfXRatioDstToSrc, dfYRatioDstToSrc,
-                        0.0, 0.0,
-                        eWrkDataType,
-                        papaChunk[iBand],
-                        pabyChunkNoDataMask,
-                        nChunkXOffQueried, nChunkXSizeQueried,
-                        nChunkYOffQueried, nChunkYSizeQueried,
-                        nDstXOff, nDstXOff + nDstXCount,
-                        nDstYOff, nDstYOff + nDstYCount,
-                        papapoOverviewBands[iBand][iOverview],
-                        pszResampling,
-                        pabHasNoData[iBand],
-                        pafNoDataValue[iBand],
-                        /*poColorTable*/ nullptr,
-                        eDataType,
-                        bPropagateNoData);
+                    GDALOverviewResampleJob sJob;
+                    sJob.pfnResampleFn = pfnResampleFn;
+                    sJob.dfXRatioDstToSrc = dfXRatioDstToSrc;
+                    sJob.dfYRatioDstToSrc = dfYRatioDstToSrc;
+                    sJob.eWrkDataType = eWrkDataType;
+                    sJob.pChunk = papaChunk[iBand];
+                    sJob.pabyChunkNodataMask = pabyChunkNoDataMask;
+                    sJob.nSrcWidth = nSrcWidth;
+                    sJob.nSrcHeight = nSrcHeight;
+                    sJob.nChunkXOff = nChunkXOffQueried;
+                    sJob.nChunkXSize = nChunkXSizeQueried;
+                    sJob.nChunkYOff = nChunkYOffQueried;
+                    sJob.nChunkYSize = nChunkYSizeQueried;
+                    sJob.nDstXOff = nDstXOff;
+                    sJob.nDstXOff2 = nDstXOff + nDstXCount;
+                    sJob.nDstYOff = nDstYOff;
+                    sJob.nDstYOff2 = nDstYOff + nDstYCount;
+                    sJob.poOverview = papapoOverviewBands[iBand][iOverview];
+                    sJob.poChunkBand = nullptr;
+                    sJob.pszResampling = pszResampling;
+                    sJob.bHasNoData = pabHasNoData[iBand];
+                    sJob.fNoDataValue = pafNoDataValue[iBand];
+                    sJob.poColorTable = nullptr;
+                    sJob.eSrcDataType = eDataType;
+                    sJob.bPropagateNoData = bPropagateNoData;
+                    sJob.eErr = CE_None;
+                    asJobs.push_back(sJob);
+                }
+
+                if( eErr == CE_None && ++iChunkBuffer == nChunkBuffers )
+                {
+                    eErr = GDALOverviewRunResampleJobs(poThreadPool, asJobs);
+                    iChunkBuffer = 0;
                 }
             }
 
             dfCurPixelCount += static_cast<double>(nYCount) * nSrcWidth;
         }
 
+        if( eErr == CE_None )
+            eErr = GDALOverviewRunResampleJobs(poThreadPool, asJobs);
+
         // Flush the data to overviews.
         for( int iBand = 0; iBand < nBands; ++iBand )
         {
-            CPLFree(papaChunk[iBand]);
             papapoOverviewBands[iBand][iOverview]->FlushCache();
         }
-        CPLFree(papaChunk);
-        CPLFree(pabyChunkNoDataMask);
+        for( size_t i = 0; i < apaChunk.size(); ++i )
+            CPLFree(apaChunk[i]);
+        for( int i = 0; i < nChunkBuffers; ++i )
+            CPLFree(apabyChunkNoDataMask[i]);
     }
 
+    delete poThreadPool;
+
     CPLFree(pabHasNoData);
     CPLFree(pafNoDataValue);
 
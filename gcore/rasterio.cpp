@@ -3022,6 +3022,30 @@ static inline void GDALFastCopy( T* CPL_RESTRICT pDest,
     }
 }
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && (defined(__x86_64) || defined(_M_X64))
+
+bool GDALCopyWordsAVX2( const void * CPL_RESTRICT pSrcData,
+                        GDALDataType eSrcType,
+                        int nSrcPixelStride,
+                        void * CPL_RESTRICT pDstData,
+                        GDALDataType eDstType,
+                        int nDstPixelStride,
+                        int nWordCount );
+
+/************************************************************************/
+/*                       GDALCopyWordsHaveAVX2()                        */
+/************************************************************************/
+
+static bool GDALCopyWordsHaveAVX2()
+{
+    static const bool bHaveAVX2 =
+        CPLHaveRuntimeAVX2() &&
+        CPLTestBool(CPLGetConfigOption("GDAL_USE_AVX2", "YES"));
+    return bHaveAVX2;
+}
+
+#endif
+
 /************************************************************************/
 /*                           GDALCopyWords()                            */
 /************************************************************************/
@@ -3180,6 +3204,18 @@ GDALCopyWords( const void * CPL_RESTRICT pSrcData,
         }
     }
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && (defined(__x86_64) || defined(_M_X64))
+    // Conversions between non-complex types.
+    if( nWordCount >= 8 && eSrcType != eDstType &&
+        GDALCopyWordsHaveAVX2() &&
+        GDALCopyWordsAVX2( pSrcData, eSrcType, nSrcPixelStride,
+                           pDstData, eDstType, nDstPixelStride,
+                           nWordCount ) )
+    {
+        return;
+    }
+#endif
+
     // Handle the more general case -- deals with conversion of data types
     // directly.
     switch (eSrcType)
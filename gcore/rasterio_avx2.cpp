@@ -0,0 +1,576 @@
+/******************************************************************************
+ *
+ * Project:  GDAL Core
+ * Purpose:  AVX2 specializations of GDALCopyWords()
+ *
+ ******************************************************************************
+ * Copyright (c) 2018, GDAL contributors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ ****************************************************************************/
+
+#include "cpl_port.h"
+
+CPL_CVSID("$Id$")
+
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
+
+#include <immintrin.h>
+
+#include <cstring>
+#include <limits>
+
+#include "gdal.h"
+#include "gdal_priv_templates.hpp"
+
+bool GDALCopyWordsAVX2( const void * CPL_RESTRICT pSrcData,
+                        GDALDataType eSrcType,
+                        int nSrcPixelStride,
+                        void * CPL_RESTRICT pDstData,
+                        GDALDataType eDstType,
+                        int nDstPixelStride,
+                        int nWordCount );
+
+// All the conversions below process 8 words at a time, and must give the
+// same results as GDALCopyWord() in gdal_priv_templates.hpp.
+
+namespace {
+
+/************************************************************************/
+/*                               Load8()                                */
+/*                                                                      */
+/*      Load 8 integer words as 32 bit lanes. UInt32 words are kept as  */
+/*      their bit pattern.                                              */
+/************************************************************************/
+
+inline __m256i Load8( const GByte* pIn )
+{
+    return _mm256_cvtepu8_epi32(
+        _mm_loadl_epi64(reinterpret_cast<const __m128i*>(pIn)));
+}
+
+inline __m256i Load8( const GUInt16* pIn )
+{
+    return _mm256_cvtepu16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn)));
+}
+
+inline __m256i Load8( const GInt16* pIn )
+{
+    return _mm256_cvtepi16_epi32(
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(pIn)));
+}
+
+inline __m256i Load8( const GInt32* pIn )
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn));
+}
+
+inline __m256i Load8( const GUInt32* pIn )
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pIn));
+}
+
+/************************************************************************/
+/*                              Store8()                                */
+/*                                                                      */
+/*      Store 8 32 bit lanes, whose values are already in the range of  */
+/*      the output type.                                                */
+/************************************************************************/
+
+inline void Store8( __m256i ymm, GByte* pOut )
+{
+    __m128i xmm = _mm_packs_epi32(_mm256_castsi256_si128(ymm),
+                                  _mm256_extracti128_si256(ymm, 1));
+    xmm = _mm_packus_epi16(xmm, xmm);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(pOut), xmm);
+}
+
+inline void Store8( __m256i ymm, GUInt16* pOut )
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut),
+                     _mm_packus_epi32(_mm256_castsi256_si128(ymm),
+                                      _mm256_extracti128_si256(ymm, 1)));
+}
+
+inline void Store8( __m256i ymm, GInt16* pOut )
+{
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(pOut),
+                     _mm_packs_epi32(_mm256_castsi256_si128(ymm),
+                                     _mm256_extracti128_si256(ymm, 1)));
+}
+
+inline void Store8( __m256i ymm, GInt32* pOut )
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut), ymm);
+}
+
+inline void Store8( __m256i ymm, GUInt32* pOut )
+{
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(pOut), ymm);
+}
+
+/************************************************************************/
+/*                         Combine2x128()                               */
+/************************************************************************/
+
+inline __m256i Combine2x128( __m128i xmmLow, __m128i xmmHigh )
+{
+    return _mm256_inserti128_si256(_mm256_castsi128_si256(xmmLow),
+                                   xmmHigh, 1);
+}
+
+/************************************************************************/
+/*                    Integer to integer conversions.                   */
+/************************************************************************/
+
+template<class Tin, class Tout>
+inline void Convert8( const Tin* pIn, Tout* pOut )
+{
+    __m256i ymm = Load8(pIn);
+    if( std::numeric_limits<Tin>::is_signed )
+    {
+        // Clamp to the intersection of the input and output ranges.
+        const GIntBig nInMin = std::numeric_limits<Tin>::min();
+        const GIntBig nInMax = std::numeric_limits<Tin>::max();
+        const GIntBig nOutMin = std::numeric_limits<Tout>::min();
+        const GIntBig nOutMax = std::numeric_limits<Tout>::max();
+        if( nOutMin > nInMin )
+            ymm = _mm256_max_epi32(ymm,
+                                   _mm256_set1_epi32(static_cast<int>(nOutMin)));
+        if( nOutMax < nInMax )
+            ymm = _mm256_min_epi32(ymm,
+                                   _mm256_set1_epi32(static_cast<int>(nOutMax)));
+    }
+    else
+    {
+        const GUIntBig nInMax = std::numeric_limits<Tin>::max();
+        const GUIntBig nOutMax = std::numeric_limits<Tout>::max();
+        if( nOutMax < nInMax )
+            ymm = _mm256_min_epu32(ymm,
+                                   _mm256_set1_epi32(static_cast<int>(nOutMax)));
+    }
+    Store8(ymm, pOut);
+}
+
+/************************************************************************/
+/*                      Integer to float conversions.                   */
+/************************************************************************/
+
+template<class Tin>
+inline void Convert8( const Tin* pIn, float* pOut )
+{
+    _mm256_storeu_ps(pOut, _mm256_cvtepi32_ps(Load8(pIn)));
+}
+
+template<class Tin>
+inline void Convert8( const Tin* pIn, double* pOut )
+{
+    const __m256i ymm = Load8(pIn);
+    _mm256_storeu_pd(pOut, _mm256_cvtepi32_pd(_mm256_castsi256_si128(ymm)));
+    _mm256_storeu_pd(pOut + 4,
+                     _mm256_cvtepi32_pd(_mm256_extracti128_si256(ymm, 1)));
+}
+
+inline void Convert8( const GUInt32* pIn, float* pOut )
+{
+    // Both halves are exactly representable, so there is a single rounding,
+    // as with a scalar cast.
+    const __m256i ymm = Load8(pIn);
+    const __m256 ymmHigh =
+        _mm256_cvtepi32_ps(_mm256_srli_epi32(ymm, 16));
+    const __m256 ymmLow = _mm256_cvtepi32_ps(
+        _mm256_and_si256(ymm, _mm256_set1_epi32(0xFFFF)));
+    _mm256_storeu_ps(pOut, _mm256_add_ps(
+        _mm256_mul_ps(ymmHigh, _mm256_set1_ps(65536.0f)), ymmLow));
+}
+
+inline void Convert8( const GUInt32* pIn, double* pOut )
+{
+    // Flip the sign bit and add back 2^31: exact in double precision.
+    const __m256i ymm = _mm256_xor_si256(
+        Load8(pIn), _mm256_set1_epi32(std::numeric_limits<int>::min()));
+    const __m256d ymm2p31 = _mm256_set1_pd(2147483648.0);
+    _mm256_storeu_pd(pOut, _mm256_add_pd(
+        _mm256_cvtepi32_pd(_mm256_castsi256_si128(ymm)), ymm2p31));
+    _mm256_storeu_pd(pOut + 4, _mm256_add_pd(
+        _mm256_cvtepi32_pd(_mm256_extracti128_si256(ymm, 1)), ymm2p31));
+}
+
+/************************************************************************/
+/*                      Float32 to other conversions.                   */
+/************************************************************************/
+
+// Byte and UInt16: NaN -> 0, otherwise clamp(f + 0.5, 0, max).
+inline __m256i Float32ToUnsignedSmall( __m256 ymm, float fMax )
+{
+    ymm = _mm256_add_ps(ymm, _mm256_set1_ps(0.5f));
+    // max_ps() returns its second operand if either is NaN.
+    ymm = _mm256_max_ps(ymm, _mm256_setzero_ps());
+    ymm = _mm256_min_ps(ymm, _mm256_set1_ps(fMax));
+    return _mm256_cvttps_epi32(ymm);
+}
+
+inline void Float32ToInt8( __m256 ymm, GByte* pOut )
+{
+    Store8(Float32ToUnsignedSmall(ymm, 255.0f), pOut);
+}
+
+inline void Float32ToInt8( __m256 ymm, GUInt16* pOut )
+{
+    Store8(Float32ToUnsignedSmall(ymm, 65535.0f), pOut);
+}
+
+inline void Float32ToInt8( __m256 ymm, GInt16* pOut )
+{
+    // NaN -> 0, otherwise round half away from zero and clamp.
+    ymm = _mm256_and_ps(ymm, _mm256_cmp_ps(ymm, ymm, _CMP_ORD_Q));
+    const __m256 ymmPositive =
+        _mm256_cmp_ps(ymm, _mm256_setzero_ps(), _CMP_GE_OQ);
+    ymm = _mm256_add_ps(ymm, _mm256_blendv_ps(_mm256_set1_ps(-0.5f),
+                                              _mm256_set1_ps(0.5f),
+                                              ymmPositive));
+    ymm = _mm256_max_ps(ymm, _mm256_set1_ps(-32768.0f));
+    ymm = _mm256_min_ps(ymm, _mm256_set1_ps(32767.0f));
+    Store8(_mm256_cvttps_epi32(ymm), pOut);
+}
+
+inline void Float32ToInt8( __m256 ymm, GInt32* pOut )
+{
+    // Round half away from zero. Overflows and NaN are converted to
+    // INT_MIN by cvttps, as by the scalar code, and positive overflows
+    // are then fixed.
+    const __m256 ymmPositive =
+        _mm256_cmp_ps(ymm, _mm256_setzero_ps(), _CMP_GT_OQ);
+    __m256i ymmRes = _mm256_cvttps_epi32(
+        _mm256_add_ps(ymm, _mm256_blendv_ps(_mm256_set1_ps(-0.5f),
+                                            _mm256_set1_ps(0.5f),
+                                            ymmPositive)));
+    const __m256i ymmTooLarge = _mm256_castps_si256(
+        _mm256_cmp_ps(ymm, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ));
+    ymmRes = _mm256_blendv_epi8(
+        ymmRes, _mm256_set1_epi32(std::numeric_limits<int>::max()),
+        ymmTooLarge);
+    Store8(ymmRes, pOut);
+}
+
+inline void Float32ToInt8( __m256 ymm, GUInt32* pOut )
+{
+    // f + 0.5 is at most 4294967040 when f < 2^32. Values >= 2^31 are
+    // converted after being shifted in the int32 range.
+    const __m256 ymmRounded = _mm256_add_ps(ymm, _mm256_set1_ps(0.5f));
+    const __m256 ymm2p31 = _mm256_set1_ps(2147483648.0f);
+    const __m256i ymmLow = _mm256_cvttps_epi32(ymmRounded);
+    const __m256i ymmHigh = _mm256_xor_si256(
+        _mm256_cvttps_epi32(_mm256_sub_ps(ymmRounded, ymm2p31)),
+        _mm256_set1_epi32(std::numeric_limits<int>::min()));
+    __m256i ymmRes = _mm256_blendv_epi8(
+        ymmLow, ymmHigh,
+        _mm256_castps_si256(_mm256_cmp_ps(ymmRounded, ymm2p31, _CMP_GE_OQ)));
+    // f <= 0 and NaN -> 0, f >= 2^32 -> UINT_MAX.
+    ymmRes = _mm256_and_si256(ymmRes, _mm256_castps_si256(
+        _mm256_cmp_ps(ymm, _mm256_setzero_ps(), _CMP_GT_OQ)));
+    ymmRes = _mm256_or_si256(ymmRes, _mm256_castps_si256(
+        _mm256_cmp_ps(ymm, _mm256_set1_ps(4294967296.0f), _CMP_GE_OQ)));
+    Store8(ymmRes, pOut);
+}
+
+template<class Tout>
+inline void Convert8( const float* pIn, Tout* pOut )
+{
+    Float32ToInt8(_mm256_loadu_ps(pIn), pOut);
+}
+
+inline void Convert8( const float* pIn, double* pOut )
+{
+    const __m256 ymm = _mm256_loadu_ps(pIn);
+    _mm256_storeu_pd(pOut, _mm256_cvtps_pd(_mm256_castps256_ps128(ymm)));
+    _mm256_storeu_pd(pOut + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(ymm, 1)));
+}
+
+/************************************************************************/
+/*                      Float64 to other conversions.                   */
+/************************************************************************/
+
+// Byte, UInt16: NaN -> 0, otherwise clamp(d + 0.5, 0, max).
+inline __m128i Float64ToUnsignedSmall4( __m256d ymm, double dfMax )
+{
+    ymm = _mm256_add_pd(ymm, _mm256_set1_pd(0.5));
+    // max_pd() returns its second operand if either is NaN.
+    ymm = _mm256_max_pd(ymm, _mm256_setzero_pd());
+    ymm = _mm256_min_pd(ymm, _mm256_set1_pd(dfMax));
+    return _mm256_cvttpd_epi32(ymm);
+}
+
+// Int16 (bStrictPositive) and Int32: NaN -> 0, otherwise round half away
+// from zero and clamp.
+inline __m128i Float64ToSigned4( __m256d ymm, bool bStrictPositive,
+                                 double dfMin, double dfMax )
+{
+    ymm = _mm256_and_pd(ymm, _mm256_cmp_pd(ymm, ymm, _CMP_ORD_Q));
+    const __m256d ymmPositive = bStrictPositive ?
+        _mm256_cmp_pd(ymm, _mm256_setzero_pd(), _CMP_GT_OQ) :
+        _mm256_cmp_pd(ymm, _mm256_setzero_pd(), _CMP_GE_OQ);
+    ymm = _mm256_add_pd(ymm, _mm256_blendv_pd(_mm256_set1_pd(-0.5),
+                                              _mm256_set1_pd(0.5),
+                                              ymmPositive));
+    ymm = _mm256_max_pd(ymm, _mm256_set1_pd(dfMin));
+    ymm = _mm256_min_pd(ymm, _mm256_set1_pd(dfMax));
+    return _mm256_cvttpd_epi32(ymm);
+}
+
+inline __m128i Float64ToUInt32_4( __m256d ymm )
+{
+    ymm = _mm256_add_pd(ymm, _mm256_set1_pd(0.5));
+    ymm = _mm256_max_pd(ymm, _mm256_setzero_pd());
+    ymm = _mm256_min_pd(ymm, _mm256_set1_pd(4294967295.0));
+    // Once truncated, shifting by 2^31 is exact, and brings the value in
+    // the int32 range.
+    ymm = _mm256_round_pd(ymm, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC);
+    return _mm_xor_si128(
+        _mm256_cvttpd_epi32(_mm256_sub_pd(ymm, _mm256_set1_pd(2147483648.0))),
+        _mm_set1_epi32(std::numeric_limits<int>::min()));
+}
+
+inline void Float64ToInt8( const double* pIn, GByte* pOut )
+{
+    Store8(Combine2x128(
+        Float64ToUnsignedSmall4(_mm256_loadu_pd(pIn), 255.0),
+        Float64ToUnsignedSmall4(_mm256_loadu_pd(pIn + 4), 255.0)), pOut);
+}
+
+inline void Float64ToInt8( const double* pIn, GUInt16* pOut )
+{
+    Store8(Combine2x128(
+        Float64ToUnsignedSmall4(_mm256_loadu_pd(pIn), 65535.0),
+        Float64ToUnsignedSmall4(_mm256_loadu_pd(pIn + 4), 65535.0)), pOut);
+}
+
+inline void Float64ToInt8( const double* pIn, GInt16* pOut )
+{
+    Store8(Combine2x128(
+        Float64ToSigned4(_mm256_loadu_pd(pIn), true, -32768.0, 32767.0),
+        Float64ToSigned4(_mm256_loadu_pd(pIn + 4), true, -32768.0, 32767.0)),
+        pOut);
+}
+
+inline void Float64ToInt8( const double* pIn, GInt32* pOut )
+{
+    const double dfMin = std::numeric_limits<int>::min();
+    const double dfMax = std::numeric_limits<int>::max();
+    Store8(Combine2x128(
+        Float64ToSigned4(_mm256_loadu_pd(pIn), false, dfMin, dfMax),
+        Float64ToSigned4(_mm256_loadu_pd(pIn + 4), false, dfMin, dfMax)),
+        pOut);
+}
+
+inline void Float64ToInt8( const double* pIn, GUInt32* pOut )
+{
+    Store8(Combine2x128(Float64ToUInt32_4(_mm256_loadu_pd(pIn)),
+                        Float64ToUInt32_4(_mm256_loadu_pd(pIn + 4))), pOut);
+}
+
+template<class Tout>
+inline void Convert8( const double* pIn, Tout* pOut )
+{
+    Float64ToInt8(pIn, pOut);
+}
+
+inline __m128 Float64ToFloat32_4( __m256d ymm )
+{
+    // Values out of the float range become infinite, even if they would
+    // round to FLT_MAX.
+    const __m256d ymmMax = _mm256_set1_pd(std::numeric_limits<float>::max());
+    const __m256d ymmMin = _mm256_set1_pd(-std::numeric_limits<float>::max());
+    const __m256d ymmInf =
+        _mm256_set1_pd(std::numeric_limits<double>::infinity());
+    ymm = _mm256_blendv_pd(ymm, ymmInf,
+                           _mm256_cmp_pd(ymm, ymmMax, _CMP_GT_OQ));
+    ymm = _mm256_blendv_pd(ymm, _mm256_sub_pd(_mm256_setzero_pd(), ymmInf),
+                           _mm256_cmp_pd(ymm, ymmMin, _CMP_LT_OQ));
+    return _mm256_cvtpd_ps(ymm);
+}
+
+inline void Convert8( const double* pIn, float* pOut )
+{
+    _mm_storeu_ps(pOut, Float64ToFloat32_4(_mm256_loadu_pd(pIn)));
+    _mm_storeu_ps(pOut + 4, Float64ToFloat32_4(_mm256_loadu_pd(pIn + 4)));
+}
+
+/************************************************************************/
+/*                        GDALCopyWordsAVX2T()                          */
+/************************************************************************/
+
+template<class Tin, class Tout>
+void GDALCopyWordsAVX2T( const void * CPL_RESTRICT pSrcData,
+                         int nSrcPixelStride,
+                         void * CPL_RESTRICT pDstData,
+                         int nDstPixelStride,
+                         int nWordCount )
+{
+    const GByte* const pabySrc = static_cast<const GByte*>(pSrcData);
+    GByte* const pabyDst = static_cast<GByte*>(pDstData);
+    const bool bSrcPacked = nSrcPixelStride == static_cast<int>(sizeof(Tin));
+    const bool bDstPacked = nDstPixelStride == static_cast<int>(sizeof(Tout));
+
+    // Strided (pixel interleaved) words are gathered in and scattered out
+    // from small contiguous buffers.
+    Tin aIn[8];
+    Tout aOut[8];
+
+    std::ptrdiff_t n = 0;
+    for( ; n + 8 <= nWordCount; n += 8 )
+    {
+        const GByte* pabySrcWords = pabySrc + n * nSrcPixelStride;
+        GByte* pabyDstWords = pabyDst + n * nDstPixelStride;
+        const Tin* pIn = reinterpret_cast<const Tin*>(pabySrcWords);
+        if( !bSrcPacked )
+        {
+            for( int i = 0; i < 8; i++ )
+                memcpy(&aIn[i], pabySrcWords + i * nSrcPixelStride,
+                       sizeof(Tin));
+            pIn = aIn;
+        }
+        if( bDstPacked )
+        {
+            Convert8(pIn, reinterpret_cast<Tout*>(pabyDstWords));
+        }
+        else
+        {
+            Convert8(pIn, aOut);
+            for( int i = 0; i < 8; i++ )
+                memcpy(pabyDstWords + i * nDstPixelStride, &aOut[i],
+                       sizeof(Tout));
+        }
+    }
+
+    for( ; n < nWordCount; n++ )
+    {
+        Tin tIn;
+        Tout tOut;
+        memcpy(&tIn, pabySrc + n * nSrcPixelStride, sizeof(Tin));
+        GDALCopyWord(tIn, tOut);
+        memcpy(pabyDst + n * nDstPixelStride, &tOut, sizeof(Tout));
+    }
+
+    // GCC needs explicit zeroing.
+#if defined(__GNUC__) && !defined(__clang__)
+    _mm256_zeroupper();
+#endif
+}
+
+typedef void (*GDALCopyWordsAVX2Func)( const void * CPL_RESTRICT pSrcData,
+                                       int nSrcPixelStride,
+                                       void * CPL_RESTRICT pDstData,
+                                       int nDstPixelStride,
+                                       int nWordCount );
+
+// Indexed by source and destination GDALDataType, up to GDT_Float64.
+// Same type copies are handled elsewhere and are left unset.
+const GDALCopyWordsAVX2Func apfnCopyWordsAVX2[GDT_Float64 + 1][GDT_Float64 + 1] =
+{
+    { nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr, nullptr },
+    { nullptr,
+      nullptr,
+      GDALCopyWordsAVX2T<GByte, GUInt16>,
+      GDALCopyWordsAVX2T<GByte, GInt16>,
+      GDALCopyWordsAVX2T<GByte, GUInt32>,
+      GDALCopyWordsAVX2T<GByte, GInt32>,
+      GDALCopyWordsAVX2T<GByte, float>,
+      GDALCopyWordsAVX2T<GByte, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<GUInt16, GByte>,
+      nullptr,
+      GDALCopyWordsAVX2T<GUInt16, GInt16>,
+      GDALCopyWordsAVX2T<GUInt16, GUInt32>,
+      GDALCopyWordsAVX2T<GUInt16, GInt32>,
+      GDALCopyWordsAVX2T<GUInt16, float>,
+      GDALCopyWordsAVX2T<GUInt16, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<GInt16, GByte>,
+      GDALCopyWordsAVX2T<GInt16, GUInt16>,
+      nullptr,
+      GDALCopyWordsAVX2T<GInt16, GUInt32>,
+      GDALCopyWordsAVX2T<GInt16, GInt32>,
+      GDALCopyWordsAVX2T<GInt16, float>,
+      GDALCopyWordsAVX2T<GInt16, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<GUInt32, GByte>,
+      GDALCopyWordsAVX2T<GUInt32, GUInt16>,
+      GDALCopyWordsAVX2T<GUInt32, GInt16>,
+      nullptr,
+      GDALCopyWordsAVX2T<GUInt32, GInt32>,
+      GDALCopyWordsAVX2T<GUInt32, float>,
+      GDALCopyWordsAVX2T<GUInt32, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<GInt32, GByte>,
+      GDALCopyWordsAVX2T<GInt32, GUInt16>,
+      GDALCopyWordsAVX2T<GInt32, GInt16>,
+      GDALCopyWordsAVX2T<GInt32, GUInt32>,
+      nullptr,
+      GDALCopyWordsAVX2T<GInt32, float>,
+      GDALCopyWordsAVX2T<GInt32, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<float, GByte>,
+      GDALCopyWordsAVX2T<float, GUInt16>,
+      GDALCopyWordsAVX2T<float, GInt16>,
+      GDALCopyWordsAVX2T<float, GUInt32>,
+      GDALCopyWordsAVX2T<float, GInt32>,
+      nullptr,
+      GDALCopyWordsAVX2T<float, double> },
+    { nullptr,
+      GDALCopyWordsAVX2T<double, GByte>,
+      GDALCopyWordsAVX2T<double, GUInt16>,
+      GDALCopyWordsAVX2T<double, GInt16>,
+      GDALCopyWordsAVX2T<double, GUInt32>,
+      GDALCopyWordsAVX2T<double, GInt32>,
+      GDALCopyWordsAVX2T<double, float>,
+      nullptr }
+};
+
+} // end anonymous namespace
+
+/************************************************************************/
+/*                          GDALCopyWordsAVX2()                         */
+/************************************************************************/
+
+/* Returns false if the pair of data types is not handled. */
+
+bool GDALCopyWordsAVX2( const void * CPL_RESTRICT pSrcData,
+                        GDALDataType eSrcType,
+                        int nSrcPixelStride,
+                        void * CPL_RESTRICT pDstData,
+                        GDALDataType eDstType,
+                        int nDstPixelStride,
+                        int nWordCount )
+{
+    if( eSrcType < GDT_Byte || eSrcType > GDT_Float64 ||
+        eDstType < GDT_Byte || eDstType > GDT_Float64 )
+    {
+        return false;
+    }
+    GDALCopyWordsAVX2Func pfnCopyWords = apfnCopyWordsAVX2[eSrcType][eDstType];
+    if( pfnCopyWords == nullptr )
+        return false;
+    pfnCopyWords(pSrcData, nSrcPixelStride, pDstData, nDstPixelStride,
+                 nWordCount);
+    return true;
+}
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME) && ( defined(__x86_64) || defined(_M_X64) )
@@ -2874,6 +2874,11 @@ class CPL_DLL OGRGeometryFactory
                                               OGRCoordinateTransformation *poCT,
                                               char** papszOptions );
 
+    static OGRErr transformGeometries( int nGeomCount,
+                                       OGRGeometry **papoGeoms,
+                                       OGRCoordinateTransformation *poCT,
+                                       OGRErr *paeErrors = nullptr );
+
     static OGRGeometry*
         approximateArcAngles( double dfX, double dfY, double dfZ,
                               double dfPrimaryRadius, double dfSecondaryAxis,
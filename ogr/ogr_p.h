@@ -137,6 +137,18 @@ extern const swq_field_type SpecialFieldTypes[SPECIAL_FIELD_COUNT];
 
 OGRErr CPL_DLL OSRGetEllipsoidInfo( int, char **, double *, double *);
 
+/* Cache of transformation objects, keyed by SRS pair. */
+OGRCoordinateTransformation CPL_DLL *
+OGRAcquireCachedCoordinateTransformation( OGRSpatialReference *poSource,
+                                          OGRSpatialReference *poTarget );
+void CPL_DLL OGRReleaseCachedCoordinateTransformation(
+                                    OGRCoordinateTransformation *poCT );
+
+/* Batched transform() of several geometries. */
+void OGRGeometryBatchTransform( int nGeomCount, OGRGeometry * const *papoGeoms,
+                                OGRCoordinateTransformation *poCT,
+                                int *pabTransformed );
+
 /* Fast atof function */
 double OGRFastAtof(const char* pszStr);
 
@@ -730,6 +730,10 @@ public:
                              double *x, double *y, double *z = nullptr,
                              int *pabSuccess = nullptr ) = 0;
 
+    int TransformBatch( size_t nCount,
+                        double *x, double *y, double *z = nullptr,
+                        int *pabSuccess = nullptr );
+
     /** Convert a OGRCoordinateTransformation* to a OGRCoordinateTransformationH.
      * @since GDAL 2.3
      */
@@ -950,6 +950,11 @@ OCTTransformEx( OGRCoordinateTransformationH hCT,
                 int nCount, double *x, double *y, double *z,
                 int *pabSuccess );
 
+int CPL_DLL CPL_STDCALL
+OCTTransformBatch( OGRCoordinateTransformationH hCT,
+                   size_t nCount, double *x, double *y, double *z,
+                   int *pabSuccess );
+
 /*! @cond Doxygen_Suppress */
 /* this is really private to OGR. */
 char *OCTProj4Normalize( const char *pszProj4Src );
@@ -33,11 +33,17 @@
 #include <cmath>
 #include <cstring>
 
+#include <algorithm>
+#include <map>
+#include <vector>
+
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_multiproc.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_core.h"
+#include "ogr_p.h"
 #include "ogr_srs_api.h"
 
 #ifndef PROJ_VERSION
@@ -129,12 +135,16 @@ static bool      bProjLocaleSafe = false;
 
 #endif // PROJ_VERSION == 4
 
+static void OGRProj4CTCacheCleanup();
+
 /************************************************************************/
 /*                         OCTCleanupProjMutex()                        */
 /************************************************************************/
 
 void OCTCleanupProjMutex()
 {
+    OGRProj4CTCacheCleanup();
+
 #if PROJ_VERSION == 4
     if( hPROJMutex != nullptr )
     {
@@ -194,6 +204,8 @@ class OGRProj4CT : public OGRCoordinateTransformation
 
     bool        bNoTransform = false;
 
+    CPLString   m_osCacheKey{};
+
 public:
     OGRProj4CT();
     ~OGRProj4CT() override;
@@ -201,6 +213,9 @@ public:
     int         Initialize( OGRSpatialReference *poSource,
                             OGRSpatialReference *poTarget );
 
+    const CPLString& GetCacheKey() const { return m_osCacheKey; }
+    bool        CanRunConcurrently() const;
+
     virtual OGRSpatialReference *GetSourceCS() override;
     virtual OGRSpatialReference *GetTargetCS() override;
     virtual int Transform( int nCount,
@@ -549,6 +564,212 @@ OCTNewCoordinateTransformation(
             reinterpret_cast<OGRSpatialReference *>(hTargetSRS)));
 }
 
+/************************************************************************/
+/*                        OGRProj4CTGetCacheKey()                       */
+/*                                                                      */
+/*      Two transformations with the same key are interchangeable:      */
+/*      the key holds the WKT of both SRS and the configuration         */
+/*      options read by InitializeNoLock().                             */
+/************************************************************************/
+
+static CPLString OGRProj4CTGetCacheKey( OGRSpatialReference *poSource,
+                                        OGRSpatialReference *poTarget )
+
+{
+    char *pszSrcWKT = nullptr;
+    char *pszDstWKT = nullptr;
+    if( poSource->exportToWkt( &pszSrcWKT ) != OGRERR_NONE ||
+        poTarget->exportToWkt( &pszDstWKT ) != OGRERR_NONE )
+    {
+        CPLFree( pszSrcWKT );
+        CPLFree( pszDstWKT );
+        return CPLString();
+    }
+
+    CPLString osKey( pszSrcWKT );
+    osKey += '\n';
+    osKey += pszDstWKT;
+    osKey += '\n';
+    osKey += CPLGetConfigOption( "CENTER_LONG", "" );
+    osKey += '\n';
+    osKey += CPLGetConfigOption( "CHECK_WITH_INVERT_PROJ", "NO" );
+    osKey += '\n';
+    osKey += CPLGetConfigOption( "THRESHOLD", "" );
+
+    CPLFree( pszSrcWKT );
+    CPLFree( pszDstWKT );
+    return osKey;
+}
+
+/* ==================================================================== */
+/*      Cache of idle transformation objects, keyed by SRS pair.        */
+/*                                                                      */
+/*      Each OGRProj4CT owns its PROJ context, so instances taken       */
+/*      from the cache can be used concurrently from several threads    */
+/*      without paying for the initialization of the PROJ objects       */
+/*      again.                                                          */
+/* ==================================================================== */
+
+constexpr int knMaxCachedCT = 64;
+
+static CPLMutex *hCTCacheMutex = nullptr;
+static std::map<CPLString, std::vector<OGRProj4CT *>> *poCTCache = nullptr;
+static int nCTCacheSize = 0;
+
+/************************************************************************/
+/*                       OGRProj4CTCacheAcquire()                       */
+/************************************************************************/
+
+static OGRProj4CT *OGRProj4CTCacheAcquire( const CPLString &osKey,
+                                           OGRSpatialReference *poSource,
+                                           OGRSpatialReference *poTarget )
+
+{
+    if( osKey.empty() )
+        return nullptr;
+
+    {
+        CPLMutexHolderD( &hCTCacheMutex );
+        if( poCTCache != nullptr )
+        {
+            auto oIter = poCTCache->find( osKey );
+            if( oIter != poCTCache->end() )
+            {
+                OGRProj4CT *poCT = oIter->second.back();
+                oIter->second.pop_back();
+                if( oIter->second.empty() )
+                    poCTCache->erase( oIter );
+                nCTCacheSize--;
+                return poCT;
+            }
+        }
+    }
+
+    // OGRCreateCoordinateTransformation() only instantiates OGRProj4CT,
+    // whose key is computed by Initialize().
+    return static_cast<OGRProj4CT *>(
+        OGRCreateCoordinateTransformation( poSource, poTarget ));
+}
+
+/************************************************************************/
+/*                       OGRProj4CTCacheRelease()                       */
+/************************************************************************/
+
+static void OGRProj4CTCacheRelease( OGRProj4CT *poCT )
+
+{
+    poCT->SetEmitErrors( true );
+
+    {
+        CPLMutexHolderD( &hCTCacheMutex );
+        if( nCTCacheSize < knMaxCachedCT )
+        {
+            if( poCTCache == nullptr )
+                poCTCache = new std::map<CPLString, std::vector<OGRProj4CT *>>;
+            (*poCTCache)[poCT->GetCacheKey()].push_back( poCT );
+            nCTCacheSize++;
+            return;
+        }
+    }
+
+    delete poCT;
+}
+
+/************************************************************************/
+/*                       OGRProj4CTCacheCleanup()                       */
+/************************************************************************/
+
+static void OGRProj4CTCacheCleanup()
+
+{
+    if( poCTCache != nullptr )
+    {
+        for( auto &oIter : *poCTCache )
+        {
+            for( OGRProj4CT *poCT : oIter.second )
+                delete poCT;
+        }
+        delete poCTCache;
+        poCTCache = nullptr;
+        nCTCacheSize = 0;
+    }
+
+    if( hCTCacheMutex != nullptr )
+    {
+        CPLDestroyMutex( hCTCacheMutex );
+        hCTCacheMutex = nullptr;
+    }
+}
+
+/************************************************************************/
+/*                OGRAcquireCachedCoordinateTransformation()            */
+/************************************************************************/
+
+/**
+ * Fetch a transformation object from the cache of idle transformations.
+ *
+ * Behaves like OGRCreateCoordinateTransformation(), except that an idle
+ * transformation between the same SRS, previously given back with
+ * OGRReleaseCachedCoordinateTransformation(), is reused instead of
+ * initializing new PROJ objects.  This is meant for code that creates
+ * short lived transformations repeatedly.
+ *
+ * The returned object must be given back with
+ * OGRReleaseCachedCoordinateTransformation(), and not deleted.  It must not
+ * be used concurrently by several threads.
+ *
+ * @param poSource source spatial reference system.
+ * @param poTarget target spatial reference system.
+ * @return NULL on failure or a ready to use transformation object.
+ *
+ * @since GDAL 2.3.1
+ */
+
+OGRCoordinateTransformation *
+OGRAcquireCachedCoordinateTransformation( OGRSpatialReference *poSource,
+                                          OGRSpatialReference *poTarget )
+
+{
+    if( poSource == nullptr || poTarget == nullptr )
+        return nullptr;
+
+    const CPLString osKey( OGRProj4CTGetCacheKey( poSource, poTarget ) );
+    if( osKey.empty() )
+        return OGRCreateCoordinateTransformation( poSource, poTarget );
+
+    return OGRProj4CTCacheAcquire( osKey, poSource, poTarget );
+}
+
+/************************************************************************/
+/*                OGRReleaseCachedCoordinateTransformation()            */
+/************************************************************************/
+
+/**
+ * Give back a transformation object obtained with
+ * OGRAcquireCachedCoordinateTransformation().
+ *
+ * @param poCT the transformation object, may be NULL.
+ *
+ * @since GDAL 2.3.1
+ */
+
+void OGRReleaseCachedCoordinateTransformation(
+    OGRCoordinateTransformation *poCT )
+
+{
+    if( poCT == nullptr )
+        return;
+
+    OGRProj4CT *poProj4CT = dynamic_cast<OGRProj4CT *>( poCT );
+    if( poProj4CT == nullptr || poProj4CT->GetCacheKey().empty() )
+    {
+        delete poCT;
+        return;
+    }
+
+    OGRProj4CTCacheRelease( poProj4CT );
+}
+
 /************************************************************************/
 /*                             OGRProj4CT()                             */
 /************************************************************************/
@@ -656,6 +877,10 @@ int OGRProj4CT::InitializeNoLock( OGRSpatialReference * poSourceIn,
     poSRSSource = poSourceIn->Clone();
     poSRSTarget = poTargetIn->Clone();
 
+    // Computed now, as the key also holds the configuration options read
+    // below.
+    m_osCacheKey = OGRProj4CTGetCacheKey( poSRSSource, poSRSTarget );
+
     bSourceLatLong = CPL_TO_BOOL(poSRSSource->IsGeographic());
     bTargetLatLong = CPL_TO_BOOL(poSRSTarget->IsGeographic());
 
@@ -1002,6 +1227,25 @@ OGRSpatialReference *OGRProj4CT::GetTargetCS()
     return poSRSTarget;
 }
 
+/************************************************************************/
+/*                         CanRunConcurrently()                         */
+/*                                                                      */
+/*      Whether several instances can transform at the same time,       */
+/*      from different threads.  Without PROJ contexts,                 */
+/*      pj_transform() is serialized on hPROJMutex.                     */
+/************************************************************************/
+
+bool OGRProj4CT::CanRunConcurrently() const
+
+{
+#if PROJ_VERSION == 4
+    return pjctx != nullptr || bNoTransform || bIdentityTransform ||
+           bWebMercatorToWGS84;
+#else
+    return true;
+#endif
+}
+
 /************************************************************************/
 /*                             Transform()                              */
 /*                                                                      */
@@ -1435,3 +1679,214 @@ int CPL_STDCALL OCTTransformEx( OGRCoordinateTransformationH hTransform,
     return OGRCoordinateTransformation::FromHandle(hTransform)->
         TransformEx( nCount, x, y, z, pabSuccess );
 }
+
+/************************************************************************/
+/*                        OGRCTTransformChunks()                        */
+/*                                                                      */
+/*      Transform with several TransformEx() calls on chunks of a       */
+/*      bounded size, as TransformEx() takes an int count.              */
+/************************************************************************/
+
+static bool OGRCTTransformChunks( OGRCoordinateTransformation *poCT,
+                                  size_t nCount,
+                                  double *x, double *y, double *z,
+                                  int *pabSuccess )
+
+{
+    constexpr size_t knChunkSize = 65536;
+
+    bool bOK = true;
+    for( size_t i = 0; i < nCount; i += knChunkSize )
+    {
+        const int nChunk = static_cast<int>(
+            std::min( knChunkSize, nCount - i ));
+        if( !poCT->TransformEx( nChunk, x + i, y + i,
+                                z ? z + i : nullptr,
+                                pabSuccess ? pabSuccess + i : nullptr ) )
+        {
+            bOK = false;
+        }
+    }
+    return bOK;
+}
+
+/************************************************************************/
+/*                          OGRCTBatchJobFunc()                         */
+/************************************************************************/
+
+namespace {
+struct OGRCTBatchJob
+{
+    OGRCoordinateTransformation *poCT = nullptr;
+    size_t      nCount = 0;
+    double     *x = nullptr;
+    double     *y = nullptr;
+    double     *z = nullptr;
+    int        *pabSuccess = nullptr;
+    bool        bOK = false;
+};
+} // namespace
+
+static void OGRCTBatchJobFunc( void *pData )
+
+{
+    OGRCTBatchJob *psJob = static_cast<OGRCTBatchJob *>(pData);
+    psJob->bOK = OGRCTTransformChunks( psJob->poCT, psJob->nCount,
+                                       psJob->x, psJob->y, psJob->z,
+                                       psJob->pabSuccess );
+}
+
+/************************************************************************/
+/*                           TransformBatch()                           */
+/************************************************************************/
+
+/**
+ * \brief Transform a large array of points.
+ *
+ * This method is the same as the C function OCTTransformBatch().
+ *
+ * It is meant to transform at once the vertices of many geometries, and
+ * behaves like TransformEx() on the whole array, but with a size_t count.
+ *
+ * When the GDAL_NUM_THREADS configuration option is set to a number of
+ * threads greater than 1 (or ALL_CPUS), large arrays are split among the
+ * threads, each one transforming its part with its own transformation object
+ * and PROJ context.  Those objects are taken from a cache of idle
+ * transformations keyed by the SRS pair, so that they are only initialized
+ * once.  This is only done for the transformations created by
+ * OGRCreateCoordinateTransformation(), and when the PROJ library supports
+ * contexts.  Errors emitted by the worker threads go through the global
+ * error handler.
+ *
+ * @param nCount number of points to transform.
+ * @param x array of nCount X vertices, modified in place.
+ * @param y array of nCount Y vertices, modified in place.
+ * @param z array of nCount Z vertices, modified in place, or NULL.
+ * @param pabSuccess array of per-point flags set to TRUE if that point
+ * transforms, or FALSE if it does not, or NULL.
+ *
+ * @return TRUE if TransformEx() succeeded on every part of the array, FALSE
+ * otherwise.
+ *
+ * @since GDAL 2.3.1
+ */
+
+int OGRCoordinateTransformation::TransformBatch( size_t nCount,
+                                                 double *x, double *y,
+                                                 double *z,
+                                                 int *pabSuccess )
+
+{
+    // Below that, the thread synchronization is not worth it.
+    constexpr size_t knMinPointsPerThread = 100000;
+
+    OGRProj4CT *poProj4CT = dynamic_cast<OGRProj4CT *>( this );
+    int nThreads = 1;
+    if( poProj4CT != nullptr && nCount >= 2 * knMinPointsPerThread &&
+        poProj4CT->CanRunConcurrently() )
+    {
+        nThreads = static_cast<int>(
+            std::min( static_cast<size_t>(CPLGetNumThreads(nullptr)),
+                      nCount / knMinPointsPerThread ));
+    }
+
+    if( nThreads <= 1 )
+        return OGRCTTransformChunks( this, nCount, x, y, z, pabSuccess );
+
+/* -------------------------------------------------------------------- */
+/*      Get a transformation object for each worker thread.  The        */
+/*      calling thread uses this one.                                   */
+/* -------------------------------------------------------------------- */
+    std::vector<OGRCoordinateTransformation *> apoCT( 1, this );
+    for( int i = 1; i < nThreads; i++ )
+    {
+        OGRProj4CT *poWorkerCT =
+            OGRProj4CTCacheAcquire( poProj4CT->GetCacheKey(),
+                                    GetSourceCS(), GetTargetCS() );
+        if( poWorkerCT == nullptr )
+            break;
+        poWorkerCT->SetEmitErrors( GetEmitErrors() );
+        apoCT.push_back( poWorkerCT );
+    }
+
+    CPLWorkerThreadPool oThreadPool;
+    if( apoCT.size() > 1 &&
+        !oThreadPool.Setup( static_cast<int>(apoCT.size()) - 1,
+                            nullptr, nullptr ) )
+    {
+        for( size_t i = 1; i < apoCT.size(); i++ )
+            OGRProj4CTCacheRelease( static_cast<OGRProj4CT *>(apoCT[i]) );
+        apoCT.resize( 1 );
+    }
+
+    if( apoCT.size() == 1 )
+        return OGRCTTransformChunks( this, nCount, x, y, z, pabSuccess );
+
+/* -------------------------------------------------------------------- */
+/*      Split the array in one contiguous part per thread.              */
+/* -------------------------------------------------------------------- */
+    const size_t nJobs = apoCT.size();
+    std::vector<OGRCTBatchJob> asJobs( nJobs );
+    size_t nStart = 0;
+    for( size_t i = 0; i < nJobs; i++ )
+    {
+        const size_t nEnd = nCount / nJobs * (i + 1) +
+                            (i + 1 == nJobs ? nCount % nJobs : 0);
+        asJobs[i].poCT = apoCT[i];
+        asJobs[i].nCount = nEnd - nStart;
+        asJobs[i].x = x + nStart;
+        asJobs[i].y = y + nStart;
+        asJobs[i].z = z ? z + nStart : nullptr;
+        asJobs[i].pabSuccess = pabSuccess ? pabSuccess + nStart : nullptr;
+        nStart = nEnd;
+    }
+
+    for( size_t i = 1; i < nJobs; i++ )
+    {
+        if( !oThreadPool.SubmitJob( OGRCTBatchJobFunc, &asJobs[i] ) )
+            OGRCTBatchJobFunc( &asJobs[i] );
+    }
+    OGRCTBatchJobFunc( &asJobs[0] );
+    oThreadPool.WaitCompletion();
+
+    bool bOK = true;
+    for( size_t i = 0; i < nJobs; i++ )
+    {
+        if( !asJobs[i].bOK )
+            bOK = false;
+        if( i > 0 )
+            OGRProj4CTCacheRelease( static_cast<OGRProj4CT *>(apoCT[i]) );
+    }
+
+    return bOK;
+}
+
+/************************************************************************/
+/*                         OCTTransformBatch()                          */
+/************************************************************************/
+
+/** Transform a large array of points
+ *
+ * This function is the same as OGRCoordinateTransformation::TransformBatch()
+ *
+ * @param hTransform Transformation object
+ * @param nCount Number of points
+ * @param x Array of nCount x values.
+ * @param y Array of nCount y values.
+ * @param z Array of nCount z values, or NULL.
+ * @param pabSuccess Output array of nCount value that will be set to
+ * TRUE/FALSE, or NULL.
+ * @return TRUE or FALSE
+ * @since GDAL 2.3.1
+ */
+int CPL_STDCALL OCTTransformBatch( OGRCoordinateTransformationH hTransform,
+                                   size_t nCount,
+                                   double *x, double *y, double *z,
+                                   int *pabSuccess )
+
+{
+    VALIDATE_POINTER1( hTransform, "OCTTransformBatch", FALSE );
+
+    return OGRCoordinateTransformation::FromHandle(hTransform)->
+        TransformBatch( nCount, x, y, z, pabSuccess );
+}
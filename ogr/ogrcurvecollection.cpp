@@ -679,6 +679,15 @@ OGRCurve* OGRCurveCollection::stealCurve( int i )
 OGRErr OGRCurveCollection::transform( OGRGeometry* poGeom,
                                       OGRCoordinateTransformation *poCT )
 {
+    // Transform the vertices of all the curves at once when possible.
+    if( nCurveCount > 1 )
+    {
+        int bTransformed = FALSE;
+        OGRGeometryBatchTransform( 1, &poGeom, poCT, &bTransformed );
+        if( bTransformed )
+            return OGRERR_NONE;
+    }
+
     for( int iGeom = 0; iGeom < nCurveCount; iGeom++ )
     {
         const OGRErr eErr = papoCurves[iGeom]->transform( poCT );
@@ -1063,6 +1063,16 @@ OGRBoolean OGRGeometryCollection::Equals( const OGRGeometry * poOther ) const
 OGRErr OGRGeometryCollection::transform( OGRCoordinateTransformation *poCT )
 
 {
+    // Transform the vertices of all the parts at once when possible.
+    if( nGeomCount > 1 )
+    {
+        OGRGeometry* poThis = this;
+        int bTransformed = FALSE;
+        OGRGeometryBatchTransform( 1, &poThis, poCT, &bTransformed );
+        if( bTransformed )
+            return OGRERR_NONE;
+    }
+
     int iGeom  = 0;
     for( auto&& poSubGeom: *this )
     {
@@ -33,6 +33,7 @@
 #include "cpl_conv.h"
 #include "cpl_error.h"
 #include "cpl_string.h"
+#include "cpl_worker_thread_pool.h"
 #include "ogr_geometry.h"
 #include "ogr_api.h"
 #include "ogr_core.h"
@@ -3647,6 +3648,273 @@ static void SnapCoordsCloseToLatLongBounds(OGRGeometry* poGeom)
 
 #endif
 
+/************************************************************************/
+/*                    OGRBatchTransformVisitor                          */
+/*                                                                      */
+/*      Gathers the vertices of a geometry into arrays, or writes       */
+/*      them back.                                                      */
+/************************************************************************/
+
+namespace {
+class OGRBatchTransformVisitor final: public OGRDefaultGeometryVisitor
+{
+    std::vector<double> &m_adfX;
+    std::vector<double> &m_adfY;
+    std::vector<double> &m_adfZ;
+    size_t               m_nOffset;
+    bool                 m_bWrite;
+    bool                 m_bSupported = true;
+
+    void                 VisitCurve( OGRSimpleCurve *poCurve );
+
+  public:
+    OGRBatchTransformVisitor( std::vector<double> &adfX,
+                              std::vector<double> &adfY,
+                              std::vector<double> &adfZ,
+                              size_t nOffset, bool bWrite ) :
+        m_adfX(adfX), m_adfY(adfY), m_adfZ(adfZ),
+        m_nOffset(nOffset), m_bWrite(bWrite) {}
+
+    using OGRDefaultGeometryVisitor::visit;
+
+    void visit( OGRPoint *poPoint ) override;
+    void visit( OGRLineString *poLS ) override { VisitCurve(poLS); }
+    void visit( OGRLinearRing *poLR ) override;
+    void visit( OGRCircularString *poCS ) override { VisitCurve(poCS); }
+
+    // OGRPolyhedralSurface::transform() does not assign the target SRS to
+    // the surface itself: leave those to it.
+    void visit( OGRPolyhedralSurface * ) override { m_bSupported = false; }
+    void visit( OGRTriangulatedSurface * ) override { m_bSupported = false; }
+
+    bool IsSupported() const { return m_bSupported; }
+};
+
+void OGRBatchTransformVisitor::visit( OGRPoint *poPoint )
+{
+    // Like OGRPoint::transform(), except that empty points are skipped.
+    if( poPoint->IsEmpty() )
+        return;
+
+    if( m_bWrite )
+    {
+        poPoint->setX( m_adfX[m_nOffset] );
+        poPoint->setY( m_adfY[m_nOffset] );
+        if( poPoint->Is3D() )
+            poPoint->setZ( m_adfZ[m_nOffset] );
+    }
+    else
+    {
+        m_adfX.push_back( poPoint->getX() );
+        m_adfY.push_back( poPoint->getY() );
+        m_adfZ.push_back( poPoint->getZ() );
+    }
+    m_nOffset++;
+}
+
+void OGRBatchTransformVisitor::VisitCurve( OGRSimpleCurve *poCurve )
+{
+    // Like OGRSimpleCurve::transform() when all the points transform.
+    const int nPoints = poCurve->getNumPoints();
+    if( m_bWrite )
+    {
+        poCurve->setPoints( nPoints, &m_adfX[0] + m_nOffset,
+                            &m_adfY[0] + m_nOffset,
+                            poCurve->Is3D() ? &m_adfZ[0] + m_nOffset :
+                                              nullptr );
+    }
+    else if( nPoints > 0 )
+    {
+        m_adfX.resize( m_nOffset + nPoints );
+        m_adfY.resize( m_nOffset + nPoints );
+        m_adfZ.resize( m_nOffset + nPoints );
+        poCurve->getPoints( &m_adfX[m_nOffset], sizeof(double),
+                            &m_adfY[m_nOffset], sizeof(double),
+                            &m_adfZ[m_nOffset], sizeof(double) );
+    }
+    m_nOffset += nPoints;
+}
+
+void OGRBatchTransformVisitor::visit( OGRLinearRing *poLR )
+{
+    // Like OGRLinearRing::transform().
+    const bool bIsClosed = m_bWrite && poLR->getNumPoints() > 2 &&
+                           CPL_TO_BOOL(poLR->get_IsClosed());
+    VisitCurve( poLR );
+    if( bIsClosed && !poLR->get_IsClosed() )
+    {
+        OGRPoint oStartPoint;
+        poLR->StartPoint( &oStartPoint );
+        poLR->setPoint( poLR->getNumPoints() - 1, &oStartPoint );
+    }
+}
+} // namespace
+
+/************************************************************************/
+/*                     OGRGeometryBatchTransform()                      */
+/*                                                                      */
+/*      Transform the vertices of several geometries with a few         */
+/*      TransformBatch() calls.  Only the geometries whose vertices all */
+/*      transform are modified, and flagged in pabTransformed: this     */
+/*      is equivalent to their transform() method.  The others are      */
+/*      left untouched, for the caller to run transform() on them and   */
+/*      get its handling of partial reprojection and its errors.        */
+/************************************************************************/
+
+void OGRGeometryBatchTransform( int nGeomCount, OGRGeometry * const *papoGeoms,
+                                OGRCoordinateTransformation *poCT,
+                                int *pabTransformed )
+
+{
+    // On a single thread, keep the arrays small enough to stay in the CPU
+    // cache.  Otherwise, give TransformBatch() enough points to split them
+    // among the threads.
+    const size_t nMaxBatchPoints =
+        CPLGetNumThreads(nullptr) > 1 ? 1024 * 1024 : 65536;
+
+    std::vector<double> adfX;
+    std::vector<double> adfY;
+    std::vector<double> adfZ;
+    std::vector<int> abSuccess;
+    std::vector<size_t> anOffsets;
+    std::vector<bool> abSupported;
+
+    const bool bEmitErrors = poCT->GetEmitErrors();
+
+    int iFirst = 0;
+    while( iFirst < nGeomCount )
+    {
+/* -------------------------------------------------------------------- */
+/*      Gather the vertices of the next geometries.                     */
+/* -------------------------------------------------------------------- */
+        adfX.clear();
+        adfY.clear();
+        adfZ.clear();
+        anOffsets.clear();
+        abSupported.clear();
+
+        int iLast = iFirst;
+        for( ; iLast < nGeomCount && adfX.size() < nMaxBatchPoints; iLast++ )
+        {
+            pabTransformed[iLast] = FALSE;
+            const size_t nOffset = adfX.size();
+            anOffsets.push_back( nOffset );
+            bool bSupported = false;
+            if( papoGeoms[iLast] != nullptr )
+            {
+                OGRBatchTransformVisitor oVisitor( adfX, adfY, adfZ,
+                                                   nOffset, false );
+                papoGeoms[iLast]->accept( &oVisitor );
+                bSupported = oVisitor.IsSupported();
+                if( !bSupported )
+                {
+                    adfX.resize( nOffset );
+                    adfY.resize( nOffset );
+                    adfZ.resize( nOffset );
+                }
+            }
+            abSupported.push_back( bSupported );
+        }
+        anOffsets.push_back( adfX.size() );
+
+/* -------------------------------------------------------------------- */
+/*      Transform without emitting errors: the geometries that fail     */
+/*      are transformed again by their transform() method, which        */
+/*      reports them.                                                   */
+/* -------------------------------------------------------------------- */
+        abSuccess.assign( adfX.size(), FALSE );
+        if( !adfX.empty() )
+        {
+            poCT->SetEmitErrors( false );
+            poCT->TransformBatch( adfX.size(), &adfX[0], &adfY[0], &adfZ[0],
+                                  &abSuccess[0] );
+            poCT->SetEmitErrors( bEmitErrors );
+        }
+
+/* -------------------------------------------------------------------- */
+/*      Write back the geometries whose vertices all transformed.       */
+/* -------------------------------------------------------------------- */
+        for( int i = iFirst; i < iLast; i++ )
+        {
+            const size_t k = static_cast<size_t>(i - iFirst);
+            if( !abSupported[k] )
+                continue;
+
+            bool bAllSuccess = true;
+            for( size_t j = anOffsets[k]; j < anOffsets[k+1]; j++ )
+            {
+                if( !abSuccess[j] )
+                {
+                    bAllSuccess = false;
+                    break;
+                }
+            }
+            if( !bAllSuccess )
+                continue;
+
+            OGRBatchTransformVisitor oVisitor( adfX, adfY, adfZ,
+                                               anOffsets[k], true );
+            papoGeoms[i]->accept( &oVisitor );
+            papoGeoms[i]->assignSpatialReference( poCT->GetTargetCS() );
+            pabTransformed[i] = TRUE;
+        }
+
+        iFirst = iLast;
+    }
+}
+
+/************************************************************************/
+/*                        transformGeometries()                         */
+/************************************************************************/
+
+/** Transform several geometries.
+ *
+ * This is equivalent to calling the transform() method on each geometry,
+ * but the vertices of all the geometries are transformed at once with
+ * OGRCoordinateTransformation::TransformBatch(), which avoids the overhead
+ * of a transformation call per part, and can use several threads for large
+ * batches (see the GDAL_NUM_THREADS configuration option).  The geometries
+ * that have a vertex that cannot be transformed are then transformed again
+ * by their transform() method, so that their result and the errors emitted
+ * are the same.
+ *
+ * @param nGeomCount number of geometries.
+ * @param papoGeoms array of nGeomCount geometries, modified in place.  NULL
+ * entries are skipped.
+ * @param poCT coordinate transformation object.
+ * @param paeErrors array of nGeomCount values set to the result of the
+ * transformation of each geometry, or NULL.
+ * @return OGRERR_NONE if all the geometries were transformed, or the first
+ * error.
+ *
+ * @since GDAL 2.3.1
+ */
+
+OGRErr OGRGeometryFactory::transformGeometries(
+    int nGeomCount, OGRGeometry **papoGeoms,
+    OGRCoordinateTransformation *poCT, OGRErr *paeErrors )
+
+{
+    std::vector<int> abTransformed( nGeomCount, FALSE );
+    if( nGeomCount > 0 )
+        OGRGeometryBatchTransform( nGeomCount, papoGeoms, poCT,
+                                   &abTransformed[0] );
+
+    OGRErr eErr = OGRERR_NONE;
+    for( int i = 0; i < nGeomCount; i++ )
+    {
+        OGRErr eGeomErr = OGRERR_NONE;
+        if( papoGeoms[i] != nullptr && !abTransformed[i] )
+            eGeomErr = papoGeoms[i]->transform( poCT );
+        if( paeErrors )
+            paeErrors[i] = eGeomErr;
+        if( eErr == OGRERR_NONE )
+            eErr = eGeomErr;
+    }
+
+    return eErr;
+}
+
 /************************************************************************/
 /*                       transformWithOptions()                         */
 /************************************************************************/
@@ -3675,9 +3943,11 @@ OGRGeometry* OGRGeometryFactory::transformWithOptions(
             oSRSWGS84.SetWellKnownGeogCS( "WGS84" );
             if( poCT->GetTargetCS()->IsSame(&oSRSWGS84) )
             {
+                // Reuse the reverse transformation from one call to the
+                // next, as initializing it costs more than transforming.
                 OGRCoordinateTransformation* poRevCT =
-                    OGRCreateCoordinateTransformation( &oSRSWGS84,
-                                                       poCT->GetSourceCS() );
+                    OGRAcquireCachedCoordinateTransformation(
+                        &oSRSWGS84, poCT->GetSourceCS() );
                 if( poRevCT != nullptr )
                 {
                     bool bIsNorthPolar = false;
@@ -3695,7 +3965,7 @@ OGRGeometry* OGRGeometryFactory::transformWithOptions(
                                         bNeedPostCorrection);
                     }
 
-                    delete poRevCT;
+                    OGRReleaseCachedCoordinateTransformation( poRevCT );
                 }
             }
         }
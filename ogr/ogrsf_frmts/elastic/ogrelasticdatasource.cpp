@@ -718,6 +718,7 @@ OGRLayer* OGRElasticDataSource::ExecuteSQL( const char *pszSQLCommand,
             (iLayer =
                 GetLayerIndex( psSelectInfo->table_defs[0].table_name )) >= 0 &&
             psSelectInfo->join_count == 0 &&
+            psSelectInfo->group_specs == 0 &&
             psSelectInfo->order_specs > 0 &&
             psSelectInfo->poOtherSelect == nullptr )
         {
@@ -29,11 +29,17 @@
 
 #include "swq.h"
 #include "ogr_p.h"
+#include "ogr_attrind.h"
 #include "ogr_gensql.h"
 #include "cpl_string.h"
 #include "ogr_api.h"
 #include "cpl_time.h"
+#include "cpl_worker_thread_pool.h"
 #include <algorithm>
+#include <climits>
+#include <limits>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 //! @cond Doxygen_Suppress
@@ -81,6 +87,2113 @@ int OGRGenSQLResultsLayerHasSpecialField(swq_expr_node* expr,
     return FALSE;
 }
 
+/************************************************************************/
+/*                       OGRGenSQLGetMaxMemory()                        */
+/*                                                                      */
+/*      Memory that the SQL engine may use for the data it has to keep  */
+/*      around, beyond which it is spilled to temporary files.          */
+/************************************************************************/
+
+static GIntBig OGRGenSQLGetMaxMemory()
+{
+    const char *pszMaxMemory = CPLGetConfigOption("OGR_SQL_MAX_MEMORY", nullptr);
+    if( pszMaxMemory != nullptr )
+        return std::max(static_cast<GIntBig>(1),
+                        CPLAtoGIntBig(pszMaxMemory)) * 1024 * 1024;
+    return std::max(GDALGetCacheMax64(),
+                    static_cast<GIntBig>(64) * 1024 * 1024);
+}
+
+/************************************************************************/
+/*                     OGRGenSQLSerializeFeature()                      */
+/*                                                                      */
+/*      Append a feature to a buffer, in a native binary encoding only  */
+/*      meant to be read back by OGRGenSQLDeserializeFeature() in the   */
+/*      same process.                                                   */
+/************************************************************************/
+
+static void OGRGenSQLAppend( std::vector<GByte> &abyBuffer,
+                             const void *pData, size_t nSize )
+{
+    const GByte *pabyData = static_cast<const GByte *>(pData);
+    abyBuffer.insert( abyBuffer.end(), pabyData, pabyData + nSize );
+}
+
+static void OGRGenSQLAppendCount( std::vector<GByte> &abyBuffer, size_t nCount )
+{
+    const GUInt32 nCount32 = static_cast<GUInt32>(nCount);
+    OGRGenSQLAppend( abyBuffer, &nCount32, sizeof(nCount32) );
+}
+
+static void OGRGenSQLAppendString( std::vector<GByte> &abyBuffer,
+                                   const char *pszStr )
+{
+    // The terminating nul character is stored, 0 standing for nullptr.
+    const size_t nLen = pszStr ? strlen(pszStr) + 1 : 0;
+    OGRGenSQLAppendCount( abyBuffer, nLen );
+    OGRGenSQLAppend( abyBuffer, pszStr, nLen );
+}
+
+static void OGRGenSQLAppendField( std::vector<GByte> &abyBuffer,
+                                  OGRFieldType eType,
+                                  const OGRField *psField )
+{
+    GByte byState = 0;
+    if( OGR_RawField_IsNull(psField) )
+        byState = 1;
+    else if( !OGR_RawField_IsUnset(psField) )
+        byState = 2;
+    OGRGenSQLAppend( abyBuffer, &byState, 1 );
+    if( byState != 2 )
+        return;
+
+    switch( eType )
+    {
+      case OFTInteger:
+        OGRGenSQLAppend( abyBuffer, &psField->Integer,
+                         sizeof(psField->Integer) );
+        break;
+
+      case OFTInteger64:
+        OGRGenSQLAppend( abyBuffer, &psField->Integer64,
+                         sizeof(psField->Integer64) );
+        break;
+
+      case OFTReal:
+        OGRGenSQLAppend( abyBuffer, &psField->Real,
+                         sizeof(psField->Real) );
+        break;
+
+      case OFTDate:
+      case OFTTime:
+      case OFTDateTime:
+        OGRGenSQLAppend( abyBuffer, &psField->Date,
+                         sizeof(psField->Date) );
+        break;
+
+      case OFTBinary:
+        OGRGenSQLAppendCount( abyBuffer, psField->Binary.nCount );
+        OGRGenSQLAppend( abyBuffer, psField->Binary.paData,
+                         psField->Binary.nCount );
+        break;
+
+      case OFTIntegerList:
+        OGRGenSQLAppendCount( abyBuffer, psField->IntegerList.nCount );
+        OGRGenSQLAppend( abyBuffer, psField->IntegerList.paList,
+                         sizeof(int) * psField->IntegerList.nCount );
+        break;
+
+      case OFTInteger64List:
+        OGRGenSQLAppendCount( abyBuffer, psField->Integer64List.nCount );
+        OGRGenSQLAppend( abyBuffer, psField->Integer64List.paList,
+                         sizeof(GIntBig) * psField->Integer64List.nCount );
+        break;
+
+      case OFTRealList:
+        OGRGenSQLAppendCount( abyBuffer, psField->RealList.nCount );
+        OGRGenSQLAppend( abyBuffer, psField->RealList.paList,
+                         sizeof(double) * psField->RealList.nCount );
+        break;
+
+      case OFTStringList:
+        OGRGenSQLAppendCount( abyBuffer, psField->StringList.nCount );
+        for( int i = 0; i < psField->StringList.nCount; i++ )
+            OGRGenSQLAppendString( abyBuffer,
+                                   psField->StringList.paList[i] );
+        break;
+
+      default:
+        OGRGenSQLAppendString( abyBuffer, psField->String );
+        break;
+    }
+}
+
+static void OGRGenSQLSerializeFeature( const OGRFeature *poFeature,
+                                       std::vector<GByte> &abyBuffer )
+{
+    const OGRFeatureDefn *poDefn = poFeature->GetDefnRef();
+
+    const GIntBig nFID = poFeature->GetFID();
+    OGRGenSQLAppend( abyBuffer, &nFID, sizeof(nFID) );
+    OGRGenSQLAppendString(
+        abyBuffer, const_cast<OGRFeature *>(poFeature)->GetStyleString() );
+
+    for( int iField = 0; iField < poDefn->GetFieldCount(); iField++ )
+    {
+        OGRGenSQLAppendField( abyBuffer,
+                              poDefn->GetFieldDefn(iField)->GetType(),
+                              poFeature->GetRawFieldRef( iField ) );
+    }
+
+    for( int iGeom = 0; iGeom < poDefn->GetGeomFieldCount(); iGeom++ )
+    {
+        const OGRGeometry *poGeom = poFeature->GetGeomFieldRef( iGeom );
+        const size_t nWkbSize = poGeom ? poGeom->WkbSize() : 0;
+        OGRGenSQLAppendCount( abyBuffer, nWkbSize );
+        if( nWkbSize > 0 )
+        {
+            const size_t nOffset = abyBuffer.size();
+            abyBuffer.resize( nOffset + nWkbSize );
+            poGeom->exportToWkb( wkbNDR, &abyBuffer[nOffset], wkbVariantIso );
+        }
+    }
+}
+
+/************************************************************************/
+/*                    OGRGenSQLDeserializeFeature()                     */
+/************************************************************************/
+
+namespace {
+struct OGRGenSQLReader
+{
+    const GByte *pabyCur;
+    const GByte *pabyEnd;
+
+    bool Read( void *pData, size_t nSize )
+    {
+        if( static_cast<size_t>(pabyEnd - pabyCur) < nSize )
+            return false;
+        memcpy( pData, pabyCur, nSize );
+        pabyCur += nSize;
+        return true;
+    }
+
+    // Return a pointer to the next nSize bytes, and skip them.
+    const GByte *Skip( size_t nSize )
+    {
+        if( static_cast<size_t>(pabyEnd - pabyCur) < nSize )
+            return nullptr;
+        const GByte *pabyRet = pabyCur;
+        pabyCur += nSize;
+        return pabyRet;
+    }
+
+    bool ReadCount( int *pnCount )
+    {
+        GUInt32 nCount = 0;
+        if( !Read( &nCount, sizeof(nCount) ) || nCount > INT_MAX )
+            return false;
+        *pnCount = static_cast<int>(nCount);
+        return true;
+    }
+
+    bool ReadString( const char **ppszStr )
+    {
+        int nLen = 0;
+        if( !ReadCount( &nLen ) )
+            return false;
+        const GByte *pabyStr = Skip( nLen );
+        if( pabyStr == nullptr || (nLen > 0 && pabyStr[nLen - 1] != '\0') )
+            return false;
+        *ppszStr = nLen > 0 ? reinterpret_cast<const char *>(pabyStr) : nullptr;
+        return true;
+    }
+};
+} // namespace
+
+static bool OGRGenSQLReadField( OGRGenSQLReader &oReader,
+                                OGRFeature *poFeature, int iField )
+{
+    GByte byState = 0;
+    if( !oReader.Read( &byState, 1 ) )
+        return false;
+    if( byState == 0 )
+        return true;
+    if( byState == 1 )
+    {
+        poFeature->SetFieldNull( iField );
+        return true;
+    }
+
+    bool bOK = true;
+    int nCount = 0;
+    switch( poFeature->GetFieldDefnRef(iField)->GetType() )
+    {
+      case OFTInteger:
+      {
+        int nValue = 0;
+        bOK = oReader.Read( &nValue, sizeof(nValue) );
+        poFeature->SetField( iField, nValue );
+        break;
+      }
+
+      case OFTInteger64:
+      {
+        GIntBig nValue = 0;
+        bOK = oReader.Read( &nValue, sizeof(nValue) );
+        poFeature->SetField( iField, nValue );
+        break;
+      }
+
+      case OFTReal:
+      {
+        double dfValue = 0.0;
+        bOK = oReader.Read( &dfValue, sizeof(dfValue) );
+        poFeature->SetField( iField, dfValue );
+        break;
+      }
+
+      case OFTDate:
+      case OFTTime:
+      case OFTDateTime:
+      {
+        OGRField sField;
+        bOK = oReader.Read( &sField.Date, sizeof(sField.Date) );
+        if( bOK )
+            poFeature->SetField( iField, &sField );
+        break;
+      }
+
+      case OFTBinary:
+      {
+        const GByte *pabyValue = nullptr;
+        bOK = oReader.ReadCount( &nCount ) &&
+              (pabyValue = oReader.Skip( nCount )) != nullptr;
+        if( bOK )
+            poFeature->SetField( iField, nCount,
+                                 const_cast<GByte *>(pabyValue) );
+        break;
+      }
+
+      case OFTIntegerList:
+      {
+        bOK = oReader.ReadCount( &nCount );
+        std::vector<int> anValues( bOK ? nCount : 0 );
+        bOK = bOK && oReader.Read( anValues.data(), sizeof(int) * nCount );
+        if( bOK )
+            poFeature->SetField( iField, nCount, anValues.data() );
+        break;
+      }
+
+      case OFTInteger64List:
+      {
+        bOK = oReader.ReadCount( &nCount );
+        std::vector<GIntBig> anValues( bOK ? nCount : 0 );
+        bOK = bOK &&
+              oReader.Read( anValues.data(), sizeof(GIntBig) * nCount );
+        if( bOK )
+            poFeature->SetField( iField, nCount, anValues.data() );
+        break;
+      }
+
+      case OFTRealList:
+      {
+        bOK = oReader.ReadCount( &nCount );
+        std::vector<double> adfValues( bOK ? nCount : 0 );
+        bOK = bOK &&
+              oReader.Read( adfValues.data(), sizeof(double) * nCount );
+        if( bOK )
+            poFeature->SetField( iField, nCount, adfValues.data() );
+        break;
+      }
+
+      case OFTStringList:
+      {
+        bOK = oReader.ReadCount( &nCount );
+        CPLStringList aosValues;
+        for( int i = 0; bOK && i < nCount; i++ )
+        {
+            const char *pszValue = nullptr;
+            bOK = oReader.ReadString( &pszValue );
+            if( bOK )
+                aosValues.AddString( pszValue ? pszValue : "" );
+        }
+        if( bOK )
+            poFeature->SetField( iField, aosValues.List() );
+        break;
+      }
+
+      default:
+      {
+        const char *pszValue = nullptr;
+        bOK = oReader.ReadString( &pszValue );
+        if( bOK && pszValue != nullptr )
+            poFeature->SetField( iField, pszValue );
+        break;
+      }
+    }
+    return bOK;
+}
+
+static OGRFeature *OGRGenSQLDeserializeFeature( OGRFeatureDefn *poDefn,
+                                                const GByte *pabyData,
+                                                size_t nSize )
+{
+    OGRGenSQLReader oReader;
+    oReader.pabyCur = pabyData;
+    oReader.pabyEnd = pabyData + nSize;
+
+    OGRFeature *poFeature = new OGRFeature( poDefn );
+
+    GIntBig nFID = OGRNullFID;
+    const char *pszStyle = nullptr;
+    bool bOK = oReader.Read( &nFID, sizeof(nFID) ) &&
+               oReader.ReadString( &pszStyle );
+    poFeature->SetFID( nFID );
+    if( pszStyle != nullptr )
+        poFeature->SetStyleString( pszStyle );
+
+    for( int iField = 0; bOK && iField < poDefn->GetFieldCount(); iField++ )
+        bOK = OGRGenSQLReadField( oReader, poFeature, iField );
+
+    for( int iGeom = 0; bOK && iGeom < poDefn->GetGeomFieldCount(); iGeom++ )
+    {
+        int nWkbSize = 0;
+        const GByte *pabyWkb = nullptr;
+        bOK = oReader.ReadCount( &nWkbSize ) &&
+              (pabyWkb = oReader.Skip( nWkbSize )) != nullptr;
+        if( !bOK || nWkbSize == 0 )
+            continue;
+
+        OGRGeometry *poGeom = nullptr;
+        bOK = OGRGeometryFactory::createFromWkb(
+            pabyWkb,
+            poDefn->GetGeomFieldDefn(iGeom)->GetSpatialRef(),
+            &poGeom, nWkbSize, wkbVariantIso ) == OGRERR_NONE;
+        if( bOK )
+            poFeature->SetGeomFieldDirectly( iGeom, poGeom );
+    }
+
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Corrupted temporary feature record" );
+        delete poFeature;
+        return nullptr;
+    }
+
+    return poFeature;
+}
+
+/************************************************************************/
+/*                        OGRGenSQLFeatureStore                         */
+/*                                                                      */
+/*      Each record is the size of the serialized feature, followed by  */
+/*      the serialized feature.                                         */
+/************************************************************************/
+
+OGRGenSQLFeatureStore::OGRGenSQLFeatureStore( GIntBig nMaxMemory ) :
+    m_nMaxMemory(nMaxMemory),
+    m_fp(nullptr),
+    m_nFileSize(0)
+{
+}
+
+OGRGenSQLFeatureStore::~OGRGenSQLFeatureStore()
+{
+    if( m_fp != nullptr )
+    {
+        VSIFCloseL( m_fp );
+        VSIUnlink( m_osFilename );
+    }
+}
+
+/************************************************************************/
+/*                   OGRGenSQLFeatureStore::Spill()                     */
+/************************************************************************/
+
+bool OGRGenSQLFeatureStore::Spill()
+{
+    if( m_fp == nullptr )
+    {
+        m_osFilename = CPLGenerateTempFilename( "ogr_gensql" );
+        m_fp = VSIFOpenL( m_osFilename, "wb+" );
+        if( m_fp == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot create temporary file %s",
+                      m_osFilename.c_str() );
+            return false;
+        }
+        CPLDebug( "GenSQL", "Spilling features to %s", m_osFilename.c_str() );
+    }
+
+    if( VSIFSeekL( m_fp, m_nFileSize, SEEK_SET ) != 0 ||
+        VSIFWriteL( m_abyBuffer.data(), 1, m_abyBuffer.size(), m_fp ) !=
+                                                        m_abyBuffer.size() )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write temporary file %s", m_osFilename.c_str() );
+        return false;
+    }
+
+    m_nFileSize += m_abyBuffer.size();
+    m_abyBuffer.clear();
+    return true;
+}
+
+/************************************************************************/
+/*                    OGRGenSQLFeatureStore::Add()                      */
+/************************************************************************/
+
+bool OGRGenSQLFeatureStore::Add( const OGRFeature *poFeature,
+                                 vsi_l_offset *pnOffset )
+{
+    const size_t nRecordOffset = m_abyBuffer.size();
+    try
+    {
+        OGRGenSQLAppendCount( m_abyBuffer, 0 );
+        OGRGenSQLSerializeFeature( poFeature, m_abyBuffer );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate temporary feature record" );
+        m_abyBuffer.resize( nRecordOffset );
+        return false;
+    }
+
+    const size_t nSize = m_abyBuffer.size() - nRecordOffset - sizeof(GUInt32);
+    if( nSize > UINT_MAX )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported, "Too large feature" );
+        m_abyBuffer.resize( nRecordOffset );
+        return false;
+    }
+    const GUInt32 nSize32 = static_cast<GUInt32>(nSize);
+    memcpy( &m_abyBuffer[nRecordOffset], &nSize32, sizeof(nSize32) );
+
+    *pnOffset = m_nFileSize + nRecordOffset;
+
+    if( static_cast<GIntBig>(m_abyBuffer.size()) > m_nMaxMemory )
+        return Spill();
+    return true;
+}
+
+/************************************************************************/
+/*                    OGRGenSQLFeatureStore::Get()                      */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLFeatureStore::Get( OGRFeatureDefn *poDefn,
+                                        vsi_l_offset nOffset )
+{
+    GUInt32 nSize = 0;
+    if( nOffset >= m_nFileSize )
+    {
+        const size_t nBufOffset = static_cast<size_t>(nOffset - m_nFileSize);
+        memcpy( &nSize, &m_abyBuffer[nBufOffset], sizeof(nSize) );
+        return OGRGenSQLDeserializeFeature(
+            poDefn, &m_abyBuffer[nBufOffset + sizeof(nSize)], nSize );
+    }
+
+    if( VSIFSeekL( m_fp, nOffset, SEEK_SET ) != 0 ||
+        VSIFReadL( &nSize, sizeof(nSize), 1, m_fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read temporary file %s", m_osFilename.c_str() );
+        return nullptr;
+    }
+    try
+    {
+        m_abyReadBuffer.resize( nSize );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate temporary feature record" );
+        return nullptr;
+    }
+    if( nSize > 0 && VSIFReadL( m_abyReadBuffer.data(), nSize, 1, m_fp ) != 1 )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot read temporary file %s", m_osFilename.c_str() );
+        return nullptr;
+    }
+    return OGRGenSQLDeserializeFeature( poDefn, m_abyReadBuffer.data(),
+                                        nSize );
+}
+
+/************************************************************************/
+/*                          OGRGenSQLJoinIndex                          */
+/*                                                                      */
+/*      Hash table of the features of a secondary layer, keyed by the   */
+/*      values of its fields compared by the join.  It is only used     */
+/*      when the ON clause is a conjunction of equalities between a     */
+/*      field of the primary table and a field of the secondary table,  */
+/*      and gives the same result as the attribute filter built by      */
+/*      GetFilterForJoin(): the first matching feature in the reading   */
+/*      order of the secondary layer, with the comparison rules of the  */
+/*      OGR SQL engine.  It is thus only used for secondary layers      */
+/*      whose attribute filters are evaluated by that engine, and that  */
+/*      have no attribute index on the key fields.                      */
+/************************************************************************/
+
+class OGRGenSQLJoinIndex
+{
+    struct KeyField
+    {
+        int  iPrimaryField;
+        int  iSecondaryField;
+        char chType;  // 'I'nteger, 'R'eal or 'S'tring.
+    };
+
+    std::vector<KeyField>   m_asKeyFields;
+    OGRFeatureDefn         *m_poDefn;
+    OGRGenSQLFeatureStore   m_oStore;
+    std::unordered_map<std::string, vsi_l_offset> m_oMap;
+
+    static bool CollectKeyFields( swq_expr_node *poExpr, int nSecondaryTable,
+                                  OGRFeatureDefn *poPrimaryDefn,
+                                  OGRFeatureDefn *poSecondaryDefn,
+                                  std::vector<KeyField> &asKeyFields );
+    bool        GetKey( const OGRFeature *poFeature, bool bPrimary,
+                        std::string &osKey ) const;
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLJoinIndex)
+
+    OGRGenSQLJoinIndex( const std::vector<KeyField> &asKeyFields,
+                        OGRFeatureDefn *poDefn ) :
+        m_asKeyFields(asKeyFields),
+        m_poDefn(poDefn),
+        m_oStore(OGRGenSQLGetMaxMemory())
+    {
+        m_poDefn->Reference();
+    }
+
+  public:
+    ~OGRGenSQLJoinIndex() { m_poDefn->Release(); }
+
+    static OGRGenSQLJoinIndex *Create( swq_join_def *psJoinInfo,
+                                       OGRLayer *poPrimaryLayer,
+                                       OGRLayer *poJoinLayer );
+
+    OGRFeature *Fetch( const OGRFeature *poSrcFeat );
+};
+
+/************************************************************************/
+/*                 OGRGenSQLJoinIndex::CollectKeyFields()               */
+/************************************************************************/
+
+bool OGRGenSQLJoinIndex::CollectKeyFields( swq_expr_node *poExpr,
+                                           int nSecondaryTable,
+                                           OGRFeatureDefn *poPrimaryDefn,
+                                           OGRFeatureDefn *poSecondaryDefn,
+                                           std::vector<KeyField> &asKeyFields )
+{
+    if( poExpr->eNodeType != SNT_OPERATION )
+        return false;
+
+    if( poExpr->nOperation == SWQ_AND && poExpr->nSubExprCount == 2 )
+    {
+        return CollectKeyFields( poExpr->papoSubExpr[0], nSecondaryTable,
+                                 poPrimaryDefn, poSecondaryDefn,
+                                 asKeyFields ) &&
+               CollectKeyFields( poExpr->papoSubExpr[1], nSecondaryTable,
+                                 poPrimaryDefn, poSecondaryDefn,
+                                 asKeyFields );
+    }
+
+    if( poExpr->nOperation != SWQ_EQ || poExpr->nSubExprCount != 2 )
+        return false;
+
+    swq_expr_node *poPrimary = poExpr->papoSubExpr[0];
+    swq_expr_node *poSecondary = poExpr->papoSubExpr[1];
+    if( poPrimary->eNodeType != SNT_COLUMN ||
+        poSecondary->eNodeType != SNT_COLUMN )
+        return false;
+    if( poPrimary->table_index != 0 )
+        std::swap( poPrimary, poSecondary );
+    if( poPrimary->table_index != 0 ||
+        poSecondary->table_index != nSecondaryTable )
+        return false;
+
+    // Regular fields only.
+    if( poPrimary->field_index < 0 ||
+        poPrimary->field_index >= poPrimaryDefn->GetFieldCount() ||
+        poSecondary->field_index < 0 ||
+        poSecondary->field_index >= poSecondaryDefn->GetFieldCount() )
+        return false;
+
+    const OGRFieldType ePrimaryType =
+        poPrimaryDefn->GetFieldDefn(poPrimary->field_index)->GetType();
+    const OGRFieldType eSecondaryType =
+        poSecondaryDefn->GetFieldDefn(poSecondary->field_index)->GetType();
+
+    KeyField sKeyField;
+    sKeyField.iPrimaryField = poPrimary->field_index;
+    sKeyField.iSecondaryField = poSecondary->field_index;
+    const bool bPrimaryInteger =
+        ePrimaryType == OFTInteger || ePrimaryType == OFTInteger64;
+    const bool bSecondaryInteger =
+        eSecondaryType == OFTInteger || eSecondaryType == OFTInteger64;
+    if( bPrimaryInteger && bSecondaryInteger )
+        sKeyField.chType = 'I';
+    else if( (bPrimaryInteger || ePrimaryType == OFTReal) &&
+             (bSecondaryInteger || eSecondaryType == OFTReal) )
+        sKeyField.chType = 'R';
+    else if( ePrimaryType == OFTString && eSecondaryType == OFTString )
+        sKeyField.chType = 'S';
+    else
+        return false;
+
+    asKeyFields.push_back( sKeyField );
+    return true;
+}
+
+/************************************************************************/
+/*                      OGRGenSQLJoinIndex::GetKey()                    */
+/*                                                                      */
+/*      Compute the key of a primary or secondary feature.  Return      */
+/*      false if it cannot match, due to a null value.                  */
+/************************************************************************/
+
+bool OGRGenSQLJoinIndex::GetKey( const OGRFeature *poFeature, bool bPrimary,
+                                 std::string &osKey ) const
+{
+    osKey.clear();
+    for( size_t i = 0; i < m_asKeyFields.size(); i++ )
+    {
+        const KeyField &sKeyField = m_asKeyFields[i];
+        const int iField = bPrimary ? sKeyField.iPrimaryField :
+                                      sKeyField.iSecondaryField;
+        if( !poFeature->IsFieldSetAndNotNull( iField ) )
+            return false;
+
+        const OGRFieldType eType =
+            poFeature->GetFieldDefnRef(iField)->GetType();
+        const OGRField *psField = poFeature->GetRawFieldRef( iField );
+        if( sKeyField.chType == 'I' )
+        {
+            const GIntBig nValue = eType == OFTInteger ?
+                psField->Integer : psField->Integer64;
+            osKey.append( reinterpret_cast<const char *>(&nValue),
+                          sizeof(nValue) );
+        }
+        else if( sKeyField.chType == 'R' )
+        {
+            double dfValue = eType == OFTInteger ? psField->Integer :
+                             eType == OFTInteger64 ?
+                                static_cast<double>(psField->Integer64) :
+                                psField->Real;
+            // The primary value is formatted in the attribute filter.
+            if( bPrimary && eType == OFTReal )
+                dfValue = CPLAtof( CPLSPrintf("%.16g", dfValue) );
+            if( CPLIsNan(dfValue) )
+                return false;
+            if( dfValue == 0.0 )
+                dfValue = 0.0;  // No negative zero.
+            osKey.append( reinterpret_cast<const char *>(&dfValue),
+                          sizeof(dfValue) );
+        }
+        else
+        {
+            // Strings are compared case insensitively.
+            for( const char *pszIter = psField->String; *pszIter; ++pszIter )
+                osKey += static_cast<char>(
+                    toupper(static_cast<unsigned char>(*pszIter)));
+            osKey += '\0';
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                      OGRGenSQLJoinIndex::Create()                    */
+/*                                                                      */
+/*      Build the hash table of the secondary layer of a join, or       */
+/*      return nullptr if the join cannot use one.                      */
+/************************************************************************/
+
+OGRGenSQLJoinIndex *OGRGenSQLJoinIndex::Create( swq_join_def *psJoinInfo,
+                                                OGRLayer *poPrimaryLayer,
+                                                OGRLayer *poJoinLayer )
+{
+    // Reading the secondary layer must not disturb the primary one.
+    if( poJoinLayer == poPrimaryLayer )
+        return nullptr;
+
+    std::vector<KeyField> asKeyFields;
+    if( !CollectKeyFields( psJoinInfo->poExpr, psJoinInfo->secondary_table,
+                           poPrimaryLayer->GetLayerDefn(),
+                           poJoinLayer->GetLayerDefn(), asKeyFields ) )
+        return nullptr;
+
+    // An attribute index makes each filtered lookup cheap, without
+    // reading the whole secondary layer.
+    OGRLayerAttrIndex *poAttrIndex = poJoinLayer->GetIndex();
+    if( poAttrIndex != nullptr )
+    {
+        for( size_t i = 0; i < asKeyFields.size(); i++ )
+        {
+            if( poAttrIndex->GetFieldIndex(
+                    asKeyFields[i].iSecondaryField ) != nullptr )
+                return nullptr;
+        }
+    }
+
+    // The keys follow the comparison rules of the OGR SQL engine (strings
+    // are compared case insensitively).  Drivers that translate attribute
+    // filters into their own SQL (SQLite, GPKG, PostgreSQL...) compare
+    // values with their own rules, and do not install an OGR SQL query.
+    CPLPushErrorHandler( CPLQuietErrorHandler );
+    poJoinLayer->SetAttributeFilter( CPLSPrintf(
+        "\"%s\" IS NULL",
+        poJoinLayer->GetLayerDefn()->GetFieldDefn(
+            asKeyFields[0].iSecondaryField)->GetNameRef() ) );
+    const bool bGenericFilter = poJoinLayer->GetAttrQuery() != nullptr;
+    poJoinLayer->SetAttributeFilter( nullptr );
+    CPLPopErrorHandler();
+    if( !bGenericFilter )
+        return nullptr;
+
+    OGRGenSQLJoinIndex *poIndex =
+        new OGRGenSQLJoinIndex( asKeyFields, poJoinLayer->GetLayerDefn() );
+
+    poJoinLayer->ResetReading();
+
+    bool bOK = true;
+    std::string osKey;
+    OGRFeature *poFeature = nullptr;
+    while( bOK && (poFeature = poJoinLayer->GetNextFeature()) != nullptr )
+    {
+        if( poIndex->GetKey( poFeature, false, osKey ) &&
+            poIndex->m_oMap.find( osKey ) == poIndex->m_oMap.end() )
+        {
+            vsi_l_offset nOffset = 0;
+            bOK = poIndex->m_oStore.Add( poFeature, &nOffset );
+            if( bOK )
+            {
+                try
+                {
+                    poIndex->m_oMap[osKey] = nOffset;
+                }
+                catch( const std::bad_alloc& )
+                {
+                    bOK = false;
+                }
+            }
+        }
+        delete poFeature;
+    }
+
+    poJoinLayer->ResetReading();
+
+    if( !bOK )
+    {
+        CPLDebug( "GenSQL",
+                  "Cannot build the hash table of %s, "
+                  "using attribute filters instead",
+                  poJoinLayer->GetName() );
+        delete poIndex;
+        return nullptr;
+    }
+
+    CPLDebug( "GenSQL", "Hash join on %s: %d distinct keys",
+              poJoinLayer->GetName(),
+              static_cast<int>(poIndex->m_oMap.size()) );
+    return poIndex;
+}
+
+/************************************************************************/
+/*                      OGRGenSQLJoinIndex::Fetch()                     */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLJoinIndex::Fetch( const OGRFeature *poSrcFeat )
+{
+    std::string osKey;
+    if( !GetKey( poSrcFeat, true, osKey ) )
+        return nullptr;
+
+    std::unordered_map<std::string, vsi_l_offset>::const_iterator oIter =
+        m_oMap.find( osKey );
+    if( oIter == m_oMap.end() )
+        return nullptr;
+
+    return m_oStore.Get( m_poDefn, oIter->second );
+}
+
+/************************************************************************/
+/*                         PrepareJoinIndexes()                         */
+/************************************************************************/
+
+void OGRGenSQLResultsLayer::PrepareJoinIndexes()
+
+{
+    if( m_bJoinIndexesPrepared )
+        return;
+    m_bJoinIndexesPrepared = true;
+
+    swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
+    m_apoJoinIndexes.resize( psSelectInfo->join_count, nullptr );
+    if( !CPLTestBool(CPLGetConfigOption("OGR_SQL_HASH_JOIN", "YES")) )
+        return;
+
+    for( int iJoin = 0; iJoin < psSelectInfo->join_count; iJoin++ )
+    {
+        swq_join_def *psJoinInfo = psSelectInfo->join_defs + iJoin;
+        m_apoJoinIndexes[iJoin] = OGRGenSQLJoinIndex::Create(
+            psJoinInfo, poSrcLayer,
+            papoTableLayers[psJoinInfo->secondary_table] );
+    }
+}
+
+/************************************************************************/
+/*                         OGRGenSQLSortedRows                          */
+/*                                                                      */
+/*      Rows of an ORDER BY query, with their sort keys, sorted by      */
+/*      runs that fit in the memory limit.  When there is more than     */
+/*      one run, the runs are written to a temporary file and merged    */
+/*      while the rows are read back, in sequence.                      */
+/************************************************************************/
+
+class OGRGenSQLSortedRows
+{
+    struct Run
+    {
+        vsi_l_offset nStart;
+        vsi_l_offset nEnd;
+    };
+
+    // Sequential reader of a run of the temporary file.  Each record is
+    // its size, the sort keys, and the serialized row.
+    struct RunReader
+    {
+        vsi_l_offset          nPos;
+        vsi_l_offset          nEnd;
+        std::vector<GByte>    abyBuffer;
+        size_t                nBufStart;
+        size_t                nBufEnd;
+        size_t                nRecordSize;
+        std::vector<OGRField> asKeys;
+        const GByte          *pabyRow;
+        size_t                nRowSize;
+    };
+
+    // Sort, or merge, of a slice of the current run, in a thread.
+    struct SortJob
+    {
+        OGRGenSQLResultsLayer *poLayer;
+        const OGRField        *pasKeys;
+        int                    nOrderItems;
+        size_t                *panBegin;
+        size_t                *panMiddle;  // nullptr to sort, not merge.
+        size_t                *panEnd;
+    };
+
+    OGRGenSQLResultsLayer *m_poLayer;
+    OGRFeatureDefn        *m_poDefn;
+    const int              m_nOrderItems;
+    const GIntBig          m_nMaxMemory;
+    std::vector<bool>      m_abKeyIsString;
+
+    // Current run, in memory.
+    std::vector<OGRField>  m_asKeys;
+    std::vector<GByte>     m_abyRows;
+    std::vector<size_t>    m_anRowOffsets;
+    std::vector<size_t>    m_anOrder;
+    GIntBig                m_nMemory;
+
+    CPLWorkerThreadPool   *m_poThreadPool;
+    int                    m_nThreads;
+
+    VSILFILE              *m_fp;
+    CPLString              m_osFilename;
+    vsi_l_offset           m_nFileSize;
+    std::vector<Run>       m_asRuns;
+
+    GIntBig                m_nCount;
+
+    // Merge of the runs.
+    std::vector<RunReader> m_aoReaders;
+    std::vector<int>       m_anHeap;
+    GIntBig                m_nMergePos;
+
+    static void            SortJobFunc( void *pData );
+    bool                   SortRun();
+    bool                   SpillRun();
+    void                   ClearRun();
+    bool                   StartMerge();
+    bool                   ReadRecord( RunReader &oReader );
+    bool                   AdvanceMerge();
+    bool                   IsAfter( int iFirst, int iSecond );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLSortedRows)
+
+  public:
+                           OGRGenSQLSortedRows( OGRGenSQLResultsLayer *poLayer,
+                                                OGRFeatureDefn *poDefn );
+                           ~OGRGenSQLSortedRows();
+
+    bool                   Add( OGRFeature *poSrcFeat, const OGRFeature *poRow );
+    bool                   Finish();
+
+    GIntBig                GetCount() const { return m_nCount; }
+    bool                   IsInMemory() const { return m_asRuns.empty(); }
+    OGRFeature            *GetRow( GIntBig nIndex );
+};
+
+/************************************************************************/
+/*                        OGRGenSQLSortedRows()                         */
+/************************************************************************/
+
+OGRGenSQLSortedRows::OGRGenSQLSortedRows( OGRGenSQLResultsLayer *poLayer,
+                                          OGRFeatureDefn *poDefn ) :
+    m_poLayer(poLayer),
+    m_poDefn(poDefn),
+    m_nOrderItems(static_cast<swq_select*>(poLayer->pSelectInfo)->order_specs),
+    m_nMaxMemory(OGRGenSQLGetMaxMemory()),
+    m_nMemory(0),
+    m_poThreadPool(nullptr),
+    m_nThreads(1),
+    m_fp(nullptr),
+    m_nFileSize(0),
+    m_nCount(0),
+    m_nMergePos(0)
+{
+    m_poDefn->Reference();
+
+    swq_select *psSelectInfo =
+        static_cast<swq_select*>(poLayer->pSelectInfo);
+    for( int iKey = 0; iKey < m_nOrderItems; iKey++ )
+    {
+        const swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        const OGRFieldDefn *poFDefn = poLayer->GetOrderByFieldDefn(psKeyDef);
+        if( poFDefn == nullptr )
+            m_abKeyIsString.push_back(
+                SpecialFieldTypes[psKeyDef->field_index -
+                                  poLayer->iFIDFieldIndex] == SWQ_STRING );
+        else
+            m_abKeyIsString.push_back( poFDefn->GetType() == OFTString );
+    }
+
+    m_nThreads = CPLGetNumThreads(nullptr);
+}
+
+/************************************************************************/
+/*                        ~OGRGenSQLSortedRows()                        */
+/************************************************************************/
+
+OGRGenSQLSortedRows::~OGRGenSQLSortedRows()
+{
+    ClearRun();
+    delete m_poThreadPool;
+    if( m_fp != nullptr )
+    {
+        VSIFCloseL( m_fp );
+        VSIUnlink( m_osFilename );
+    }
+    m_poDefn->Release();
+}
+
+/************************************************************************/
+/*                             ClearRun()                               */
+/************************************************************************/
+
+void OGRGenSQLSortedRows::ClearRun()
+{
+    if( m_nOrderItems > 0 && !m_asKeys.empty() )
+        m_poLayer->FreeIndexFields( m_asKeys.data(),
+                                    m_asKeys.size() / m_nOrderItems, false );
+    m_asKeys.clear();
+    m_abyRows.clear();
+    m_anRowOffsets.clear();
+    m_anOrder.clear();
+    m_nMemory = 0;
+}
+
+/************************************************************************/
+/*                               Add()                                  */
+/*                                                                      */
+/*      Add a row, with the sort keys read from its source feature,     */
+/*      or from the row itself for GROUP BY.                            */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::Add( OGRFeature *poSrcFeat, const OGRFeature *poRow )
+{
+    const size_t nRows = m_anRowOffsets.size();
+    const size_t nRowOffset = m_abyRows.size();
+    try
+    {
+        OGRGenSQLSerializeFeature( poRow, m_abyRows );
+        m_anRowOffsets.push_back( nRowOffset );
+        m_asKeys.resize( m_asKeys.size() + m_nOrderItems );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate ORDER BY buffers" );
+        m_abyRows.resize( nRowOffset );
+        m_anRowOffsets.resize( nRows );
+        m_asKeys.resize( nRows * m_nOrderItems );
+        return false;
+    }
+
+    OGRField *pasKeys = m_asKeys.data() + m_asKeys.size() - m_nOrderItems;
+    memset( pasKeys, 0, sizeof(OGRField) * m_nOrderItems );
+    m_poLayer->ReadIndexFields( poSrcFeat, m_nOrderItems, pasKeys );
+
+    m_nMemory += (m_abyRows.size() - nRowOffset) +
+                 sizeof(OGRField) * m_nOrderItems + 2 * sizeof(size_t);
+    for( int iKey = 0; iKey < m_nOrderItems; iKey++ )
+    {
+        if( m_abKeyIsString[iKey] && !OGR_RawField_IsUnset(&pasKeys[iKey]) &&
+            !OGR_RawField_IsNull(&pasKeys[iKey]) )
+            m_nMemory += strlen(pasKeys[iKey].String) + 1;
+    }
+
+    m_nCount++;
+
+    if( m_nMemory > m_nMaxMemory )
+        return SortRun() && SpillRun();
+    return true;
+}
+
+/************************************************************************/
+/*                            SortJobFunc()                             */
+/************************************************************************/
+
+void OGRGenSQLSortedRows::SortJobFunc( void *pData )
+{
+    SortJob *psJob = static_cast<SortJob *>(pData);
+    OGRGenSQLResultsLayer *poLayer = psJob->poLayer;
+    const OGRField *pasKeys = psJob->pasKeys;
+    const int nOrderItems = psJob->nOrderItems;
+    const auto oLess = [poLayer, pasKeys, nOrderItems](size_t i, size_t j)
+    {
+        return poLayer->Compare( pasKeys + i * nOrderItems,
+                                 pasKeys + j * nOrderItems ) < 0;
+    };
+
+    if( psJob->panMiddle == nullptr )
+        std::stable_sort( psJob->panBegin, psJob->panEnd, oLess );
+    else
+        std::inplace_merge( psJob->panBegin, psJob->panMiddle, psJob->panEnd,
+                            oLess );
+}
+
+/************************************************************************/
+/*                              SortRun()                               */
+/*                                                                      */
+/*      Stable sort of the rows of the current run.  With several       */
+/*      threads, slices of the run are sorted concurrently, and then    */
+/*      merged by pairs.                                                */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::SortRun()
+{
+    const size_t nRows = m_anRowOffsets.size();
+    try
+    {
+        m_anOrder.resize( nRows );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate ORDER BY buffers" );
+        return false;
+    }
+    for( size_t i = 0; i < nRows; i++ )
+        m_anOrder[i] = i;
+    // Without keys, as for GROUP BY without ORDER BY, rows are kept in
+    // the order they were added.
+    if( nRows < 2 || m_nOrderItems == 0 )
+        return true;
+
+    // Not worth threads below some tens of thousands of rows.
+    const size_t nSlices = std::min(static_cast<size_t>(m_nThreads),
+                                    std::max(static_cast<size_t>(1),
+                                             nRows / 16384));
+    if( nSlices > 1 && m_poThreadPool == nullptr )
+        m_poThreadPool = CPLCreateWorkerThreadPool( m_nThreads );
+
+    SortJob sJob;
+    sJob.poLayer = m_poLayer;
+    sJob.pasKeys = m_asKeys.data();
+    sJob.nOrderItems = m_nOrderItems;
+    sJob.panMiddle = nullptr;
+
+    if( nSlices == 1 || m_poThreadPool == nullptr )
+    {
+        sJob.panBegin = m_anOrder.data();
+        sJob.panEnd = m_anOrder.data() + nRows;
+        OGRGenSQLSortedRows::SortJobFunc( &sJob );
+        return true;
+    }
+
+    std::vector<size_t> anBounds;
+    for( size_t i = 0; i <= nSlices; i++ )
+        anBounds.push_back( nRows * i / nSlices );
+
+    std::vector<SortJob> asJobs( nSlices, sJob );
+    std::vector<void*> apJobs;
+    for( size_t i = 0; i < nSlices; i++ )
+    {
+        asJobs[i].panBegin = m_anOrder.data() + anBounds[i];
+        asJobs[i].panEnd = m_anOrder.data() + anBounds[i + 1];
+        apJobs.push_back( &asJobs[i] );
+    }
+    m_poThreadPool->SubmitJobs( OGRGenSQLSortedRows::SortJobFunc, apJobs );
+    m_poThreadPool->WaitCompletion();
+
+    // Merge adjacent slices until there is only one left.
+    while( anBounds.size() > 2 )
+    {
+        std::vector<size_t> anNewBounds;
+        asJobs.clear();
+        apJobs.clear();
+        size_t i = 0;
+        for( ; i + 2 < anBounds.size(); i += 2 )
+        {
+            sJob.panBegin = m_anOrder.data() + anBounds[i];
+            sJob.panMiddle = m_anOrder.data() + anBounds[i + 1];
+            sJob.panEnd = m_anOrder.data() + anBounds[i + 2];
+            asJobs.push_back( sJob );
+            anNewBounds.push_back( anBounds[i] );
+        }
+        for( ; i < anBounds.size(); i++ )
+            anNewBounds.push_back( anBounds[i] );
+        for( size_t j = 0; j < asJobs.size(); j++ )
+            apJobs.push_back( &asJobs[j] );
+        m_poThreadPool->SubmitJobs( OGRGenSQLSortedRows::SortJobFunc,
+                                    apJobs );
+        m_poThreadPool->WaitCompletion();
+        anBounds = anNewBounds;
+    }
+
+    return true;
+}
+
+/************************************************************************/
+/*                             SpillRun()                               */
+/*                                                                      */
+/*      Write the sorted current run at the end of the temporary file.  */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::SpillRun()
+{
+    if( m_fp == nullptr )
+    {
+        m_osFilename = CPLGenerateTempFilename( "ogr_gensql_sort" );
+        m_fp = VSIFOpenL( m_osFilename, "wb+" );
+        if( m_fp == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot create temporary file %s",
+                      m_osFilename.c_str() );
+            return false;
+        }
+        CPLDebug( "GenSQL", "Sorting features with %s",
+                  m_osFilename.c_str() );
+    }
+
+    Run sRun;
+    sRun.nStart = m_nFileSize;
+
+    const size_t nRows = m_anRowOffsets.size();
+    std::vector<GByte> abyBuffer;
+    bool bOK = VSIFSeekL( m_fp, m_nFileSize, SEEK_SET ) == 0;
+    for( size_t i = 0; bOK && i < nRows; i++ )
+    {
+        const size_t iRow = m_anOrder[i];
+        const OGRField *pasKeys = m_asKeys.data() + iRow * m_nOrderItems;
+        const size_t nRowStart = m_anRowOffsets[iRow];
+        const size_t nRowEnd = iRow + 1 < nRows ? m_anRowOffsets[iRow + 1] :
+                                                  m_abyRows.size();
+
+        const size_t nRecordOffset = abyBuffer.size();
+        OGRGenSQLAppendCount( abyBuffer, 0 );
+        for( int iKey = 0; iKey < m_nOrderItems; iKey++ )
+        {
+            OGRGenSQLAppend( abyBuffer, &pasKeys[iKey], sizeof(OGRField) );
+            if( m_abKeyIsString[iKey] &&
+                !OGR_RawField_IsUnset(&pasKeys[iKey]) &&
+                !OGR_RawField_IsNull(&pasKeys[iKey]) )
+                OGRGenSQLAppendString( abyBuffer, pasKeys[iKey].String );
+        }
+        OGRGenSQLAppend( abyBuffer, &m_abyRows[nRowStart],
+                         nRowEnd - nRowStart );
+        const GUInt32 nRecordSize = static_cast<GUInt32>(
+            abyBuffer.size() - nRecordOffset - sizeof(GUInt32));
+        memcpy( &abyBuffer[nRecordOffset], &nRecordSize, sizeof(GUInt32) );
+
+        if( abyBuffer.size() >= 1024 * 1024 || i + 1 == nRows )
+        {
+            bOK = VSIFWriteL( abyBuffer.data(), 1, abyBuffer.size(), m_fp ) ==
+                                                            abyBuffer.size();
+            m_nFileSize += abyBuffer.size();
+            abyBuffer.clear();
+        }
+    }
+    if( !bOK )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write temporary file %s", m_osFilename.c_str() );
+        return false;
+    }
+
+    sRun.nEnd = m_nFileSize;
+    m_asRuns.push_back( sRun );
+    ClearRun();
+    return true;
+}
+
+/************************************************************************/
+/*                              Finish()                                */
+/*                                                                      */
+/*      Called when all the rows have been added.                       */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::Finish()
+{
+    if( !SortRun() )
+        return false;
+    if( m_asRuns.empty() )
+        return true;
+
+    CPLDebug( "GenSQL", "Merging %d sorted runs",
+              static_cast<int>(m_asRuns.size()) + 1 );
+    return SpillRun() && StartMerge();
+}
+
+/************************************************************************/
+/*                            ReadRecord()                              */
+/*                                                                      */
+/*      Read the next record of a run, or set nRecordSize to 0 at the   */
+/*      end of the run.                                                 */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::ReadRecord( RunReader &oReader )
+{
+    oReader.nBufStart += oReader.nRecordSize;
+    oReader.nRecordSize = 0;
+
+    for( size_t nNeeded = sizeof(GUInt32); ; )
+    {
+        const size_t nAvailable = oReader.nBufEnd - oReader.nBufStart;
+        if( nAvailable >= nNeeded )
+        {
+            if( nNeeded > sizeof(GUInt32) )
+                break;
+            GUInt32 nSize = 0;
+            memcpy( &nSize, &oReader.abyBuffer[oReader.nBufStart],
+                    sizeof(nSize) );
+            nNeeded = sizeof(GUInt32) + nSize;
+            continue;
+        }
+
+        if( oReader.nPos == oReader.nEnd )
+        {
+            if( nAvailable == 0 )
+                return true;
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Truncated temporary file %s", m_osFilename.c_str() );
+            return false;
+        }
+
+        // Move what is left to the beginning of the buffer and fill it.
+        memmove( oReader.abyBuffer.data(),
+                 oReader.abyBuffer.data() + oReader.nBufStart, nAvailable );
+        oReader.nBufStart = 0;
+        oReader.nBufEnd = nAvailable;
+        if( oReader.abyBuffer.size() < nNeeded )
+            oReader.abyBuffer.resize( nNeeded );
+        const size_t nToRead = static_cast<size_t>(std::min(
+            static_cast<vsi_l_offset>(oReader.abyBuffer.size() - nAvailable),
+            oReader.nEnd - oReader.nPos));
+        if( VSIFSeekL( m_fp, oReader.nPos, SEEK_SET ) != 0 ||
+            VSIFReadL( oReader.abyBuffer.data() + nAvailable, 1, nToRead,
+                       m_fp ) != nToRead )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot read temporary file %s", m_osFilename.c_str() );
+            return false;
+        }
+        oReader.nPos += nToRead;
+        oReader.nBufEnd += nToRead;
+    }
+
+    GUInt32 nSize = 0;
+    memcpy( &nSize, &oReader.abyBuffer[oReader.nBufStart], sizeof(nSize) );
+    oReader.nRecordSize = sizeof(GUInt32) + nSize;
+
+    OGRGenSQLReader oRecord;
+    oRecord.pabyCur = &oReader.abyBuffer[oReader.nBufStart + sizeof(GUInt32)];
+    oRecord.pabyEnd = oRecord.pabyCur + nSize;
+    for( int iKey = 0; iKey < m_nOrderItems; iKey++ )
+    {
+        OGRField *psKey = &oReader.asKeys[iKey];
+        if( !oRecord.Read( psKey, sizeof(OGRField) ) )
+            return false;
+        if( m_abKeyIsString[iKey] && !OGR_RawField_IsUnset(psKey) &&
+            !OGR_RawField_IsNull(psKey) )
+        {
+            const char *pszValue = nullptr;
+            if( !oRecord.ReadString( &pszValue ) || pszValue == nullptr )
+                return false;
+            psKey->String = const_cast<char *>(pszValue);
+        }
+    }
+    oReader.pabyRow = oRecord.pabyCur;
+    oReader.nRowSize = oRecord.pabyEnd - oRecord.pabyCur;
+    return true;
+}
+
+/************************************************************************/
+/*                             IsAfter()                                */
+/*                                                                      */
+/*      Whether the current record of a reader comes after the one of   */
+/*      another reader.  Ties are ordered by run, that is by reading    */
+/*      order of the source layer, for a stable sort.                   */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::IsAfter( int iFirst, int iSecond )
+{
+    const int nResult =
+        m_poLayer->Compare( m_aoReaders[iFirst].asKeys.data(),
+                            m_aoReaders[iSecond].asKeys.data() );
+    return nResult > 0 || (nResult == 0 && iFirst > iSecond);
+}
+
+/************************************************************************/
+/*                            StartMerge()                              */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::StartMerge()
+{
+    // Share about the memory limit between the read buffers.
+    const size_t nBufferSize = static_cast<size_t>(std::max(
+        static_cast<GIntBig>(64 * 1024),
+        std::min(static_cast<GIntBig>(16 * 1024 * 1024),
+                 m_nMaxMemory / static_cast<GIntBig>(m_asRuns.size()))));
+
+    m_aoReaders.resize( m_asRuns.size() );
+    m_anHeap.clear();
+    for( size_t i = 0; i < m_asRuns.size(); i++ )
+    {
+        RunReader &oReader = m_aoReaders[i];
+        oReader.nPos = m_asRuns[i].nStart;
+        oReader.nEnd = m_asRuns[i].nEnd;
+        oReader.abyBuffer.resize( nBufferSize );
+        oReader.nBufStart = 0;
+        oReader.nBufEnd = 0;
+        oReader.nRecordSize = 0;
+        oReader.asKeys.resize( m_nOrderItems );
+        oReader.pabyRow = nullptr;
+        oReader.nRowSize = 0;
+        if( !ReadRecord( oReader ) )
+            return false;
+        if( oReader.nRecordSize > 0 )
+            m_anHeap.push_back( static_cast<int>(i) );
+    }
+
+    const auto oAfter = [this](int i, int j) { return IsAfter(i, j); };
+    std::make_heap( m_anHeap.begin(), m_anHeap.end(), oAfter );
+    m_nMergePos = 0;
+    return true;
+}
+
+/************************************************************************/
+/*                           AdvanceMerge()                             */
+/*                                                                      */
+/*      Skip the current smallest record.                               */
+/************************************************************************/
+
+bool OGRGenSQLSortedRows::AdvanceMerge()
+{
+    const auto oAfter = [this](int i, int j) { return IsAfter(i, j); };
+    std::pop_heap( m_anHeap.begin(), m_anHeap.end(), oAfter );
+    const int iReader = m_anHeap.back();
+    m_anHeap.pop_back();
+    if( !ReadRecord( m_aoReaders[iReader] ) )
+        return false;
+    if( m_aoReaders[iReader].nRecordSize > 0 )
+    {
+        m_anHeap.push_back( iReader );
+        std::push_heap( m_anHeap.begin(), m_anHeap.end(), oAfter );
+    }
+    m_nMergePos++;
+    return true;
+}
+
+/************************************************************************/
+/*                              GetRow()                                */
+/*                                                                      */
+/*      Return the row of rank nIndex in the sorted order.  Accessing   */
+/*      the rows in sequence is cheap, while going back restarts the    */
+/*      merge of the runs, if any.                                      */
+/************************************************************************/
+
+OGRFeature *OGRGenSQLSortedRows::GetRow( GIntBig nIndex )
+{
+    if( nIndex < 0 || nIndex >= m_nCount )
+        return nullptr;
+
+    if( m_asRuns.empty() )
+    {
+        const size_t iRow = m_anOrder[static_cast<size_t>(nIndex)];
+        const size_t nRowStart = m_anRowOffsets[iRow];
+        const size_t nRowEnd = iRow + 1 < m_anRowOffsets.size() ?
+            m_anRowOffsets[iRow + 1] : m_abyRows.size();
+        return OGRGenSQLDeserializeFeature( m_poDefn, &m_abyRows[nRowStart],
+                                            nRowEnd - nRowStart );
+    }
+
+    if( nIndex < m_nMergePos && !StartMerge() )
+        return nullptr;
+    while( m_nMergePos < nIndex )
+    {
+        if( m_anHeap.empty() || !AdvanceMerge() )
+            return nullptr;
+    }
+    if( m_anHeap.empty() )
+        return nullptr;
+
+    const RunReader &oReader = m_aoReaders[m_anHeap.front()];
+    OGRFeature *poRow = OGRGenSQLDeserializeFeature( m_poDefn, oReader.pabyRow,
+                                                     oReader.nRowSize );
+    if( poRow != nullptr && !AdvanceMerge() )
+    {
+        delete poRow;
+        return nullptr;
+    }
+    return poRow;
+}
+
+/************************************************************************/
+/*                          OGRGenSQLGroupBy                            */
+/*                                                                      */
+/*      Hash aggregation of the source features for GROUP BY.  The      */
+/*      groups, keyed by the encoded values of the grouping fields,     */
+/*      are kept in a hash table up to OGR_SQL_MAX_MEMORY.  Once it is  */
+/*      full, the features falling in new groups are written, as        */
+/*      partial aggregates, to temporary partition files chosen by a    */
+/*      hash of their key.  Each partition is then aggregated in turn,  */
+/*      with a different hash, and so on, so the source layer is read   */
+/*      only once.                                                      */
+/************************************************************************/
+
+class OGRGenSQLGroupBy
+{
+    // Partial value of an aggregate over the features of a group.
+    struct Aggregate
+    {
+        GIntBig   nCount;
+        double    dfValue;   // Sum, minimum or maximum.
+        CPLString osValue;   // Minimum or maximum of a date/time field.
+
+        Aggregate() : nCount(0), dfValue(0.0) {}
+    };
+
+    struct Partition
+    {
+        CPLString          osFilename;
+        VSILFILE          *fp;
+        std::vector<GByte> abyBuffer;
+
+        Partition() : fp(nullptr) {}
+    };
+
+    static const int       knPartitions = 16;
+    static const int       knMaxLevel = 6;
+
+    OGRGenSQLResultsLayer *m_poLayer;
+    swq_select            *m_psSelectInfo;
+    OGRFeatureDefn        *m_poSrcDefn;
+    OGRGenSQLSortedRows   *m_poRows;
+    const GIntBig          m_nMaxMemory;
+
+    // Result columns of the aggregates.
+    std::vector<int>       m_anAggColumns;
+
+    // Groups of the current pass, in order of appearance.
+    std::unordered_map<std::string, size_t> m_oMapGroups;
+    std::vector<const std::string *> m_apoKeys;
+    std::vector<Aggregate> m_asAggregates;
+    GIntBig                m_nMemory;
+    GIntBig                m_nGroups;
+
+    bool                   IsDateColumn( int iCol ) const;
+    void                   BuildKey( OGRFeature *poSrcFeat,
+                                     std::string &osKey ) const;
+    void                   ReadAggregates( OGRFeature *poSrcFeat,
+                                           std::vector<Aggregate> &asAggs )
+                                                                    const;
+    void                   Merge( Aggregate *pasDst,
+                                  const Aggregate *pasSrc ) const;
+    bool                   Accumulate( const std::string &osKey,
+                                       const Aggregate *pasAggs,
+                                       std::vector<Partition> &aoPartitions,
+                                       int nLevel );
+    bool                   Spill( const std::string &osKey,
+                                  const Aggregate *pasAggs,
+                                  Partition &oPartition, bool bFlush );
+    bool                   EmitGroups();
+    bool                   FinishPass( std::vector<Partition> &aoPartitions,
+                                       int nLevel );
+    bool                   ProcessPartition( Partition &oPartition,
+                                             int nLevel );
+    static void            ClosePartitions(
+                                    std::vector<Partition> &aoPartitions );
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLGroupBy)
+
+  public:
+                           OGRGenSQLGroupBy( OGRGenSQLResultsLayer *poLayer,
+                                             OGRGenSQLSortedRows *poRows );
+
+    bool                   Run();
+};
+
+/************************************************************************/
+/*                          OGRGenSQLGroupBy()                          */
+/************************************************************************/
+
+OGRGenSQLGroupBy::OGRGenSQLGroupBy( OGRGenSQLResultsLayer *poLayer,
+                                    OGRGenSQLSortedRows *poRows ) :
+    m_poLayer(poLayer),
+    m_psSelectInfo(static_cast<swq_select*>(poLayer->pSelectInfo)),
+    m_poSrcDefn(poLayer->poSrcLayer->GetLayerDefn()),
+    m_poRows(poRows),
+    m_nMaxMemory(OGRGenSQLGetMaxMemory()),
+    m_nMemory(0),
+    m_nGroups(0)
+{
+    for( int iCol = 0; iCol < m_psSelectInfo->result_columns; iCol++ )
+    {
+        const swq_col_def *psColDef = m_psSelectInfo->column_defs + iCol;
+        if( psColDef->col_func != SWQCF_NONE &&
+            psColDef->col_func != SWQCF_CUSTOM )
+            m_anAggColumns.push_back( iCol );
+    }
+}
+
+/************************************************************************/
+/*                            IsDateColumn()                            */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::IsDateColumn( int iCol ) const
+{
+    const swq_col_def *psColDef = m_psSelectInfo->column_defs + iCol;
+    return psColDef->field_type == SWQ_DATE ||
+           psColDef->field_type == SWQ_TIME ||
+           psColDef->field_type == SWQ_TIMESTAMP;
+}
+
+/************************************************************************/
+/*                              BuildKey()                              */
+/*                                                                      */
+/*      Encode the values of the grouping fields, so that equal values  */
+/*      give equal keys.  Unset fields are grouped with null ones.      */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::BuildKey( OGRFeature *poSrcFeat,
+                                 std::string &osKey ) const
+{
+    std::vector<GByte> abyKey;
+    for( int iGroup = 0; iGroup < m_psSelectInfo->group_specs; iGroup++ )
+    {
+        const int iField = m_psSelectInfo->group_defs[iGroup].field_index;
+        const OGRFieldType eType =
+            m_poSrcDefn->GetFieldDefn(iField)->GetType();
+        OGRField sField = *(poSrcFeat->GetRawFieldRef(iField));
+        if( OGR_RawField_IsUnset(&sField) )
+            OGR_RawField_SetNull(&sField);
+        else if( eType == OFTReal && !OGR_RawField_IsNull(&sField) )
+        {
+            if( sField.Real == 0.0 )
+                sField.Real = 0.0;
+            else if( CPLIsNan(sField.Real) )
+                sField.Real = std::numeric_limits<double>::quiet_NaN();
+        }
+        else if( (eType == OFTDate || eType == OFTTime ||
+                  eType == OFTDateTime) && !OGR_RawField_IsNull(&sField) )
+        {
+            sField.Date.Reserved = 0;
+        }
+        OGRGenSQLAppendField( abyKey, eType, &sField );
+    }
+    osKey.assign( reinterpret_cast<const char *>(abyKey.data()),
+                  abyKey.size() );
+}
+
+/************************************************************************/
+/*                           ReadAggregates()                           */
+/*                                                                      */
+/*      Aggregates of a single source feature, with the same rules as   */
+/*      swq_select_summarize() for the null values and the date/time    */
+/*      fields.                                                         */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::ReadAggregates( OGRFeature *poSrcFeat,
+                                       std::vector<Aggregate> &asAggs ) const
+{
+    for( size_t iAgg = 0; iAgg < m_anAggColumns.size(); iAgg++ )
+    {
+        const int iCol = m_anAggColumns[iAgg];
+        const swq_col_def *psColDef = m_psSelectInfo->column_defs + iCol;
+        const int iField = psColDef->field_index;
+        Aggregate &sAgg = asAggs[iAgg];
+        sAgg.nCount = 0;
+        sAgg.dfValue = 0.0;
+        sAgg.osValue.clear();
+
+        if( psColDef->col_func == SWQCF_COUNT )
+        {
+            // psColDef->field_index can be -1 in the case of a COUNT(*)
+            if( iField < 0 )
+                sAgg.nCount = 1;
+            else if( IS_GEOM_FIELD_INDEX(m_poSrcDefn, iField) )
+                sAgg.nCount = poSrcFeat->GetGeomFieldRef(
+                    ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(m_poSrcDefn,
+                                                        iField)) ? 1 : 0;
+            else
+                sAgg.nCount = poSrcFeat->IsFieldSetAndNotNull(iField) ? 1 : 0;
+            continue;
+        }
+
+        if( !poSrcFeat->IsFieldSetAndNotNull(iField) )
+            continue;
+
+        sAgg.nCount = 1;
+        if( !IsDateColumn(iCol) )
+            sAgg.dfValue = poSrcFeat->GetFieldAsDouble(iField);
+        else if( psColDef->col_func == SWQCF_MIN ||
+                 psColDef->col_func == SWQCF_MAX )
+            sAgg.osValue = poSrcFeat->GetFieldAsString(iField);
+        else
+        {
+            const OGRField *psField = poSrcFeat->GetRawFieldRef(iField);
+            struct tm brokendowntime;
+            brokendowntime.tm_year = psField->Date.Year - 1900;
+            brokendowntime.tm_mon = psField->Date.Month - 1;
+            brokendowntime.tm_mday = psField->Date.Day;
+            brokendowntime.tm_hour = psField->Date.Hour;
+            brokendowntime.tm_min = psField->Date.Minute;
+            brokendowntime.tm_sec = static_cast<int>(psField->Date.Second);
+            sAgg.dfValue =
+                static_cast<double>(CPLYMDHMSToUnixTime(&brokendowntime)) +
+                fmod(static_cast<double>(psField->Date.Second), 1.0);
+        }
+    }
+}
+
+/************************************************************************/
+/*                               Merge()                                */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::Merge( Aggregate *pasDst,
+                              const Aggregate *pasSrc ) const
+{
+    for( size_t iAgg = 0; iAgg < m_anAggColumns.size(); iAgg++ )
+    {
+        Aggregate &sDst = pasDst[iAgg];
+        const Aggregate &sSrc = pasSrc[iAgg];
+        if( sSrc.nCount == 0 )
+            continue;
+        if( sDst.nCount == 0 )
+        {
+            sDst = sSrc;
+            continue;
+        }
+
+        const int iCol = m_anAggColumns[iAgg];
+        switch( m_psSelectInfo->column_defs[iCol].col_func )
+        {
+          case SWQCF_MIN:
+            if( IsDateColumn(iCol) )
+            {
+                if( sSrc.osValue < sDst.osValue )
+                    sDst.osValue = sSrc.osValue;
+            }
+            else
+                sDst.dfValue = std::min(sDst.dfValue, sSrc.dfValue);
+            break;
+
+          case SWQCF_MAX:
+            if( IsDateColumn(iCol) )
+            {
+                if( sSrc.osValue > sDst.osValue )
+                    sDst.osValue = sSrc.osValue;
+            }
+            else
+                sDst.dfValue = std::max(sDst.dfValue, sSrc.dfValue);
+            break;
+
+          case SWQCF_AVG:
+          case SWQCF_SUM:
+            sDst.dfValue += sSrc.dfValue;
+            break;
+
+          default:
+            break;
+        }
+        sDst.nCount += sSrc.nCount;
+    }
+}
+
+/************************************************************************/
+/*                             Accumulate()                             */
+/*                                                                      */
+/*      Add the aggregates of a feature, or of a partial group, to its  */
+/*      group.  When the hash table is full, those of a new group are   */
+/*      sent to a partition instead.                                    */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::Accumulate( const std::string &osKey,
+                                   const Aggregate *pasAggs,
+                                   std::vector<Partition> &aoPartitions,
+                                   int nLevel )
+{
+    const size_t nAggs = m_anAggColumns.size();
+    const auto oIter = m_oMapGroups.find( osKey );
+    if( oIter != m_oMapGroups.end() )
+    {
+        Merge( &m_asAggregates[oIter->second * nAggs], pasAggs );
+        return true;
+    }
+
+    if( m_nMemory > m_nMaxMemory && nLevel < knMaxLevel )
+    {
+        if( aoPartitions.empty() )
+        {
+            aoPartitions.resize( knPartitions );
+            CPLDebug( "GenSQL",
+                      "GROUP BY: spilling groups of level %d to partitions",
+                      nLevel );
+        }
+
+        // Mix the hash with the level, so that the groups of a partition
+        // spread over the partitions of the next level.
+        GUIntBig nHash = std::hash<std::string>()( osKey );
+        nHash ^= static_cast<GUIntBig>(nLevel + 1) * 0x9E3779B97F4A7C15ULL;
+        nHash ^= nHash >> 33;
+        nHash *= 0xFF51AFD7ED558CCDULL;
+        nHash ^= nHash >> 33;
+        return Spill( osKey, pasAggs, aoPartitions[nHash % knPartitions],
+                      false );
+    }
+
+    try
+    {
+        const auto oRes =
+            m_oMapGroups.insert( std::make_pair( osKey, m_apoKeys.size() ) );
+        m_apoKeys.push_back( &(oRes.first->first) );
+        m_asAggregates.insert( m_asAggregates.end(), pasAggs,
+                               pasAggs + nAggs );
+    }
+    catch( const std::bad_alloc& )
+    {
+        CPLError( CE_Failure, CPLE_OutOfMemory,
+                  "Cannot allocate GROUP BY hash table" );
+        return false;
+    }
+
+    m_nMemory += osKey.size() + sizeof(std::string) + 4 * sizeof(void *) +
+                 nAggs * sizeof(Aggregate);
+    for( size_t iAgg = 0; iAgg < nAggs; iAgg++ )
+        m_nMemory += pasAggs[iAgg].osValue.size();
+    return true;
+}
+
+/************************************************************************/
+/*                               Spill()                                */
+/*                                                                      */
+/*      Append a partial group to a partition, or just flush its        */
+/*      buffer.  Each record is its size, the key, and the aggregates.  */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::Spill( const std::string &osKey,
+                              const Aggregate *pasAggs,
+                              Partition &oPartition, bool bFlush )
+{
+    if( !bFlush )
+    {
+        std::vector<GByte> &abyBuffer = oPartition.abyBuffer;
+        const size_t nRecordOffset = abyBuffer.size();
+        OGRGenSQLAppendCount( abyBuffer, 0 );
+        OGRGenSQLAppendCount( abyBuffer, osKey.size() );
+        OGRGenSQLAppend( abyBuffer, osKey.data(), osKey.size() );
+        for( size_t iAgg = 0; iAgg < m_anAggColumns.size(); iAgg++ )
+        {
+            OGRGenSQLAppend( abyBuffer, &pasAggs[iAgg].nCount,
+                             sizeof(GIntBig) );
+            OGRGenSQLAppend( abyBuffer, &pasAggs[iAgg].dfValue,
+                             sizeof(double) );
+            OGRGenSQLAppendString( abyBuffer, pasAggs[iAgg].osValue.c_str() );
+        }
+        const GUInt32 nRecordSize = static_cast<GUInt32>(
+            abyBuffer.size() - nRecordOffset - sizeof(GUInt32));
+        memcpy( &abyBuffer[nRecordOffset], &nRecordSize, sizeof(GUInt32) );
+        if( abyBuffer.size() < 1024 * 1024 )
+            return true;
+    }
+
+    if( oPartition.abyBuffer.empty() )
+        return true;
+
+    if( oPartition.fp == nullptr )
+    {
+        oPartition.osFilename = CPLGenerateTempFilename( "ogr_gensql_group" );
+        oPartition.fp = VSIFOpenL( oPartition.osFilename, "wb+" );
+        if( oPartition.fp == nullptr )
+        {
+            CPLError( CE_Failure, CPLE_FileIO,
+                      "Cannot create temporary file %s",
+                      oPartition.osFilename.c_str() );
+            return false;
+        }
+    }
+
+    if( VSIFWriteL( oPartition.abyBuffer.data(), 1,
+                    oPartition.abyBuffer.size(), oPartition.fp ) !=
+                                                oPartition.abyBuffer.size() )
+    {
+        CPLError( CE_Failure, CPLE_FileIO,
+                  "Cannot write temporary file %s",
+                  oPartition.osFilename.c_str() );
+        return false;
+    }
+    oPartition.abyBuffer.clear();
+    return true;
+}
+
+/************************************************************************/
+/*                          ClosePartitions()                           */
+/************************************************************************/
+
+void OGRGenSQLGroupBy::ClosePartitions( std::vector<Partition> &aoPartitions )
+{
+    for( size_t i = 0; i < aoPartitions.size(); i++ )
+    {
+        if( aoPartitions[i].fp != nullptr )
+        {
+            VSIFCloseL( aoPartitions[i].fp );
+            VSIUnlink( aoPartitions[i].osFilename );
+            aoPartitions[i].fp = nullptr;
+        }
+    }
+    aoPartitions.clear();
+}
+
+/************************************************************************/
+/*                             EmitGroups()                             */
+/*                                                                      */
+/*      Turn the groups of the hash table into result rows, and empty   */
+/*      it.  The columns that are not aggregates are evaluated on a     */
+/*      feature of the source layer holding the grouping values.        */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::EmitGroups()
+{
+    const size_t nAggs = m_anAggColumns.size();
+    bool bOK = true;
+
+    for( size_t iGroup = 0; bOK && iGroup < m_apoKeys.size(); iGroup++ )
+    {
+        const std::string &osKey = *m_apoKeys[iGroup];
+        OGRGenSQLReader oReader;
+        oReader.pabyCur = reinterpret_cast<const GByte *>(osKey.data());
+        oReader.pabyEnd = oReader.pabyCur + osKey.size();
+
+        OGRFeature oKeyFeat( m_poSrcDefn );
+        oKeyFeat.SetFID( m_nGroups++ );
+        for( int i = 0; bOK && i < m_psSelectInfo->group_specs; i++ )
+            bOK = OGRGenSQLReadField( oReader, &oKeyFeat,
+                                m_psSelectInfo->group_defs[i].field_index );
+        if( !bOK )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Corrupted temporary group record" );
+            break;
+        }
+
+        OGRFeature *poRow = m_poLayer->TranslateFeature( &oKeyFeat );
+        if( poRow == nullptr )
+        {
+            bOK = false;
+            break;
+        }
+
+        // There is no geometry column in GROUP BY results, so the
+        // result columns are the fields of the rows.
+        const Aggregate *pasAggs = &m_asAggregates[iGroup * nAggs];
+        for( size_t iAgg = 0; iAgg < nAggs; iAgg++ )
+        {
+            const int iCol = m_anAggColumns[iAgg];
+            const Aggregate &sAgg = pasAggs[iAgg];
+            const swq_col_def *psColDef = m_psSelectInfo->column_defs + iCol;
+
+            if( psColDef->col_func == SWQCF_COUNT )
+                poRow->SetField( iCol, sAgg.nCount );
+            else if( sAgg.nCount == 0 )
+                continue;
+            else if( psColDef->col_func == SWQCF_AVG && IsDateColumn(iCol) )
+            {
+                struct tm brokendowntime;
+                const double dfAvg = sAgg.dfValue / sAgg.nCount;
+                CPLUnixTimeToYMDHMS( static_cast<GIntBig>(dfAvg),
+                                     &brokendowntime );
+                poRow->SetField( iCol,
+                                 brokendowntime.tm_year + 1900,
+                                 brokendowntime.tm_mon + 1,
+                                 brokendowntime.tm_mday,
+                                 brokendowntime.tm_hour,
+                                 brokendowntime.tm_min,
+                                 static_cast<float>(brokendowntime.tm_sec +
+                                                    fmod(dfAvg, 1)),
+                                 0 );
+            }
+            else if( psColDef->col_func == SWQCF_AVG )
+                poRow->SetField( iCol, sAgg.dfValue / sAgg.nCount );
+            else if( psColDef->col_func != SWQCF_SUM && IsDateColumn(iCol) )
+                poRow->SetField( iCol, sAgg.osValue.c_str() );
+            else
+                poRow->SetField( iCol, sAgg.dfValue );
+        }
+
+        bOK = m_poRows->Add( poRow, poRow );
+        delete poRow;
+    }
+
+    m_oMapGroups.clear();
+    m_apoKeys.clear();
+    m_asAggregates.clear();
+    m_nMemory = 0;
+    return bOK;
+}
+
+/************************************************************************/
+/*                             FinishPass()                             */
+/*                                                                      */
+/*      Emit the groups of the hash table, and then process the         */
+/*      partitions spilled during the pass.                             */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::FinishPass( std::vector<Partition> &aoPartitions,
+                                   int nLevel )
+{
+    bool bOK = EmitGroups();
+    for( size_t i = 0; bOK && i < aoPartitions.size(); i++ )
+        bOK = Spill( std::string(), nullptr, aoPartitions[i], true );
+    for( size_t i = 0; bOK && i < aoPartitions.size(); i++ )
+    {
+        if( aoPartitions[i].fp != nullptr )
+            bOK = ProcessPartition( aoPartitions[i], nLevel + 1 );
+    }
+    ClosePartitions( aoPartitions );
+    return bOK;
+}
+
+/************************************************************************/
+/*                          ProcessPartition()                          */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::ProcessPartition( Partition &oPartition, int nLevel )
+{
+    const size_t nAggs = m_anAggColumns.size();
+    std::vector<Partition> aoPartitions;
+    std::vector<Aggregate> asAggs( nAggs );
+    std::string osKey;
+
+    std::vector<GByte> abyBuffer( 1024 * 1024 );
+    size_t nBufStart = 0;
+    size_t nBufEnd = 0;
+    bool bEOF = VSIFSeekL( oPartition.fp, 0, SEEK_SET ) != 0;
+    bool bOK = !bEOF;
+
+    while( bOK )
+    {
+        // Make sure that the next record is in the buffer.
+        GUInt32 nSize = 0;
+        size_t nAvailable = nBufEnd - nBufStart;
+        if( nAvailable >= sizeof(GUInt32) )
+            memcpy( &nSize, &abyBuffer[nBufStart], sizeof(nSize) );
+        const size_t nNeeded = sizeof(GUInt32) + nSize;
+        if( nAvailable < sizeof(GUInt32) || nAvailable < nNeeded )
+        {
+            if( bEOF )
+            {
+                if( nAvailable != 0 )
+                {
+                    CPLError( CE_Failure, CPLE_FileIO,
+                              "Truncated temporary file %s",
+                              oPartition.osFilename.c_str() );
+                    bOK = false;
+                }
+                break;
+            }
+            memmove( abyBuffer.data(), abyBuffer.data() + nBufStart,
+                     nAvailable );
+            nBufStart = 0;
+            nBufEnd = nAvailable;
+            if( abyBuffer.size() < nNeeded )
+                abyBuffer.resize( nNeeded );
+            const size_t nRead =
+                VSIFReadL( abyBuffer.data() + nBufEnd, 1,
+                           abyBuffer.size() - nBufEnd, oPartition.fp );
+            bEOF = nRead < abyBuffer.size() - nBufEnd;
+            nBufEnd += nRead;
+            continue;
+        }
+
+        OGRGenSQLReader oReader;
+        oReader.pabyCur = &abyBuffer[nBufStart + sizeof(GUInt32)];
+        oReader.pabyEnd = oReader.pabyCur + nSize;
+        nBufStart += nNeeded;
+
+        int nKeySize = 0;
+        const GByte *pabyKey = nullptr;
+        bOK = oReader.ReadCount( &nKeySize ) &&
+              (pabyKey = oReader.Skip( nKeySize )) != nullptr;
+        for( size_t iAgg = 0; bOK && iAgg < nAggs; iAgg++ )
+        {
+            const char *pszValue = nullptr;
+            bOK = oReader.Read( &asAggs[iAgg].nCount, sizeof(GIntBig) ) &&
+                  oReader.Read( &asAggs[iAgg].dfValue, sizeof(double) ) &&
+                  oReader.ReadString( &pszValue );
+            if( bOK )
+                asAggs[iAgg].osValue = pszValue ? pszValue : "";
+        }
+        if( !bOK )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Corrupted temporary group record" );
+            break;
+        }
+
+        osKey.assign( reinterpret_cast<const char *>(pabyKey), nKeySize );
+        bOK = Accumulate( osKey, asAggs.data(), aoPartitions, nLevel );
+    }
+
+    if( !bOK )
+    {
+        ClosePartitions( aoPartitions );
+        return false;
+    }
+    return FinishPass( aoPartitions, nLevel );
+}
+
+/************************************************************************/
+/*                                Run()                                 */
+/*                                                                      */
+/*      Read the source features, and add one row per group.            */
+/************************************************************************/
+
+bool OGRGenSQLGroupBy::Run()
+{
+    std::vector<Partition> aoPartitions;
+    std::vector<Aggregate> asAggs( m_anAggColumns.size() );
+    std::string osKey;
+    bool bOK = true;
+
+    OGRFeature *poSrcFeat = nullptr;
+    while( bOK &&
+           (poSrcFeat = m_poLayer->poSrcLayer->GetNextFeature()) != nullptr )
+    {
+        BuildKey( poSrcFeat, osKey );
+        ReadAggregates( poSrcFeat, asAggs );
+        delete poSrcFeat;
+        bOK = Accumulate( osKey, asAggs.data(), aoPartitions, 0 );
+    }
+
+    if( !bOK )
+    {
+        ClosePartitions( aoPartitions );
+        return false;
+    }
+    return FinishPass( aoPartitions, 0 );
+}
+
 /************************************************************************/
 /*                       OGRGenSQLResultsLayer()                        */
 /************************************************************************/
@@ -97,15 +2210,15 @@ OGRGenSQLResultsLayer::OGRGenSQLResultsLayer( GDALDataset *poSrcDSIn,
     papoTableLayers(nullptr),
     poDefn(nullptr),
     panGeomFieldToSrcGeomField(nullptr),
-    nIndexSize(0),
-    panFIDIndex(nullptr),
+    m_poSortedRows(nullptr),
     bOrderByValid(FALSE),
     nNextIndexFID(0),
     poSummaryFeature(nullptr),
     iFIDFieldIndex(),
     nExtraDSCount(0),
     papoExtraDS(nullptr),
-    nIteratedFeatures(-1)
+    nIteratedFeatures(-1),
+    m_bJoinIndexesPrepared(false)
 {
     swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfoIn);
 
@@ -513,9 +2626,12 @@ OGRGenSQLResultsLayer::~OGRGenSQLResultsLayer()
     CPLFree( papoTableLayers );
     papoTableLayers = nullptr;
 
-    CPLFree( panFIDIndex );
+    delete m_poSortedRows;
     CPLFree( panGeomFieldToSrcGeomField );
 
+    for( size_t i = 0; i < m_apoJoinIndexes.size(); i++ )
+        delete m_apoJoinIndexes[i];
+
     delete poSummaryFeature;
     delete static_cast<swq_select*>(pSelectInfo);
 
@@ -660,7 +2776,8 @@ OGRErr OGRGenSQLResultsLayer::SetNextByIndex( GIntBig nIndex )
 
     if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
         || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
-        || panFIDIndex != nullptr )
+        || psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET
+        || m_poSortedRows != nullptr )
     {
         nNextIndexFID = nIndex + psSelectInfo->offset;
         return OGRERR_NONE;
@@ -729,6 +2846,13 @@ GIntBig OGRGenSQLResultsLayer::GetFeatureCount( int bForce )
 
         nRet = psSelectInfo->column_summary[0].count;
     }
+    else if( psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET )
+    {
+        if( m_poAttrQuery != nullptr )
+            nRet = OGRLayer::GetFeatureCount( bForce );
+        else if( m_poSortedRows != nullptr )
+            nRet = m_poSortedRows->GetCount();
+    }
     else if( psSelectInfo->query_mode != SWQM_RECORDSET )
         return 1;
     else if( m_poAttrQuery == nullptr && !MustEvaluateSpatialFilterOnGenSQL() )
@@ -759,7 +2883,7 @@ int OGRGenSQLResultsLayer::TestCapability( const char *pszCap )
     {
         if( psSelectInfo->query_mode == SWQM_SUMMARY_RECORD
             || psSelectInfo->query_mode == SWQM_DISTINCT_LIST
-            || panFIDIndex != nullptr )
+            || (m_poSortedRows != nullptr && m_poSortedRows->IsInMemory()) )
             return TRUE;
         else
             return poSrcLayer->TestCapability( pszCap );
@@ -813,6 +2937,47 @@ int OGRGenSQLResultsLayer::ContainGeomSpecialField(swq_expr_node* expr)
     return FALSE;
 }
 
+/************************************************************************/
+/*                       IsSourceGeometryNeeded()                       */
+/*                                                                      */
+/*      Whether the geometry of the source features is needed to        */
+/*      compute a summary: either a spatial filter is in place, or the  */
+/*      where clause or a column references the geometry, or the        */
+/*      OGR_GEOMETRY, OGR_GEOM_WKT or OGR_GEOM_AREA special fields.     */
+/************************************************************************/
+
+int OGRGenSQLResultsLayer::IsSourceGeometryNeeded()
+
+{
+    swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
+
+    if( m_poFilterGeom != nullptr || ( psSelectInfo->where_expr != nullptr &&
+                ContainGeomSpecialField(psSelectInfo->where_expr) ) )
+        return TRUE;
+
+    for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
+    {
+        swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+        if (psColDef->table_index == 0 && psColDef->field_index != -1)
+        {
+            OGRLayer* poLayer = papoTableLayers[psColDef->table_index];
+            int nSpecialFieldIdx = psColDef->field_index -
+                            poLayer->GetLayerDefn()->GetFieldCount();
+            if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
+                nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
+                nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
+                return TRUE;
+            if( psColDef->field_index ==
+                    GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
+                return TRUE;
+        }
+        if (psColDef->expr != nullptr && ContainGeomSpecialField(psColDef->expr))
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
 /************************************************************************/
 /*                           PrepareSummary()                           */
 /************************************************************************/
@@ -840,41 +3005,8 @@ int OGRGenSQLResultsLayer::PrepareSummary()
 /*      OGR_GEOM_WKT or OGR_GEOM_AREA special fields.                   */
 /* -------------------------------------------------------------------- */
     int bSaveIsGeomIgnored = poSrcLayer->GetLayerDefn()->IsGeometryIgnored();
-    if ( m_poFilterGeom == nullptr && ( psSelectInfo->where_expr == nullptr ||
-                !ContainGeomSpecialField(psSelectInfo->where_expr) ) )
-    {
-        int bFoundGeomExpr = FALSE;
-        for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
-        {
-            swq_col_def *psColDef = psSelectInfo->column_defs + iField;
-            if (psColDef->table_index == 0 && psColDef->field_index != -1)
-            {
-                OGRLayer* poLayer = papoTableLayers[psColDef->table_index];
-                int nSpecialFieldIdx = psColDef->field_index -
-                                poLayer->GetLayerDefn()->GetFieldCount();
-                if (nSpecialFieldIdx == SPF_OGR_GEOMETRY ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_WKT ||
-                    nSpecialFieldIdx == SPF_OGR_GEOM_AREA)
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-                if( psColDef->field_index ==
-                        GEOM_FIELD_INDEX_TO_ALL_FIELD_INDEX(poLayer->GetLayerDefn(), 0) )
-                {
-                    bFoundGeomExpr = TRUE;
-                    break;
-                }
-            }
-            if (psColDef->expr != nullptr && ContainGeomSpecialField(psColDef->expr))
-            {
-                bFoundGeomExpr = TRUE;
-                break;
-            }
-        }
-        if (!bFoundGeomExpr)
-            poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
-    }
+    if( !IsSourceGeometryNeeded() )
+        poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
 
 /* -------------------------------------------------------------------- */
 /*      We treat COUNT(*) as a special case, and fill with              */
@@ -1286,6 +3418,8 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
 
     apoFeatures.push_back( poSrcFeat );
 
+    PrepareJoinIndexes();
+
 /* -------------------------------------------------------------------- */
 /*      Fetch the corresponding features from any jointed tables.       */
 /* -------------------------------------------------------------------- */
@@ -1300,6 +3434,12 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
         /* we have taken care of this */
         CPLAssert(psJoinInfo->secondary_table == iJoin + 1);
 
+        if( m_apoJoinIndexes[iJoin] != nullptr )
+        {
+            apoFeatures.push_back( m_apoJoinIndexes[iJoin]->Fetch(poSrcFeat) );
+            continue;
+        }
+
         OGRLayer *poJoinLayer = papoTableLayers[psJoinInfo->secondary_table];
 
         osFilter = GetFilterForJoin(psJoinInfo->poExpr, poSrcFeat, poJoinLayer,
@@ -1341,6 +3481,15 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
     for( int iField = 0; iField < psSelectInfo->result_columns; iField++ )
     {
         swq_col_def *psColDef = psSelectInfo->column_defs + iField;
+
+        // Aggregates of GROUP BY rows are set by the caller.
+        if( psColDef->col_func != SWQCF_NONE &&
+            psColDef->col_func != SWQCF_CUSTOM )
+        {
+            iRegularField++;
+            continue;
+        }
+
         if( psColDef->field_index != -1 )
         {
             if( psColDef->field_type == SWQ_GEOMETRY ||
@@ -1438,6 +3587,13 @@ OGRFeature *OGRGenSQLResultsLayer::TranslateFeature( OGRFeature *poSrcFeat )
     {
         swq_col_def *psColDef = psSelectInfo->column_defs + iField;
 
+        if( psColDef->col_func != SWQCF_NONE &&
+            psColDef->col_func != SWQCF_CUSTOM )
+        {
+            iRegularField++;
+            continue;
+        }
+
         if( psColDef->table_index != 0 )
         {
             if( psColDef->field_type == SWQ_GEOMETRY ||
@@ -1559,7 +3715,7 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
         return nullptr;
 
     CreateOrderByIndex();
-    if( panFIDIndex == nullptr &&
+    if( m_poSortedRows == nullptr &&
         nIteratedFeatures < 0 && psSelectInfo->offset > 0 &&
         psSelectInfo->query_mode == SWQM_RECORDSET )
     {
@@ -1578,6 +3734,11 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
         return GetFeature( nNextIndexFID++ );
     }
 
+    // The groups could not be computed.
+    if( psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET &&
+        m_poSortedRows == nullptr )
+        return nullptr;
+
     int bEvaluateSpatialFilter = MustEvaluateSpatialFilterOnGenSQL();
 
 /* -------------------------------------------------------------------- */
@@ -1587,7 +3748,7 @@ OGRFeature *OGRGenSQLResultsLayer::GetNextFeature()
     {
         OGRFeature *poFeature = nullptr;
 
-        if( panFIDIndex != nullptr )
+        if( m_poSortedRows != nullptr )
             poFeature = GetFeature( nNextIndexFID++ );
         else
         {
@@ -1709,17 +3870,22 @@ OGRFeature *OGRGenSQLResultsLayer::GetFeature( GIntBig nFID )
     }
 
 /* -------------------------------------------------------------------- */
-/*      Are we running in sorted mode?  If so, run the fid through      */
-/*      the index.                                                      */
+/*      Are we running in sorted mode?  If so, the fid is the rank of   */
+/*      the row in the sorted rows.  The rows of a GROUP BY query take  */
+/*      it as their FID, as those of DISTINCT lists.                    */
 /* -------------------------------------------------------------------- */
-    if( panFIDIndex != nullptr )
+    if( m_poSortedRows != nullptr )
     {
-        if( nFID < 0 || nFID >= static_cast<GIntBig>(nIndexSize) )
-            return nullptr;
-        else
-            nFID = panFIDIndex[nFID];
+        OGRFeature *poRow = m_poSortedRows->GetRow( nFID );
+        if( poRow != nullptr &&
+            psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET )
+            poRow->SetFID( nFID );
+        return poRow;
     }
 
+    if( psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET )
+        return nullptr;
+
 /* -------------------------------------------------------------------- */
 /*      Handle request for random record.                               */
 /* -------------------------------------------------------------------- */
@@ -1773,6 +3939,26 @@ OGRFeatureDefn *OGRGenSQLResultsLayer::GetLayerDefn()
     return poDefn;
 }
 
+/************************************************************************/
+/*                        GetOrderByFieldDefn()                         */
+/*                                                                      */
+/*      Definition of an ORDER BY field in the features its values are  */
+/*      read from: the source features, or the result rows of a GROUP   */
+/*      BY query.  nullptr for the special fields.                      */
+/************************************************************************/
+
+OGRFieldDefn *
+OGRGenSQLResultsLayer::GetOrderByFieldDefn( const swq_order_def *psKeyDef )
+{
+    swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
+
+    if( psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET )
+        return poDefn->GetFieldDefn( psKeyDef->field_index );
+    if( psKeyDef->field_index >= iFIDFieldIndex )
+        return nullptr;
+    return poSrcLayer->GetLayerDefn()->GetFieldDefn( psKeyDef->field_index );
+}
+
 /************************************************************************/
 /*                         FreeIndexFields()                            */
 /************************************************************************/
@@ -1790,8 +3976,9 @@ void OGRGenSQLResultsLayer::FreeIndexFields(OGRField *pasIndexFields,
     for( int iKey = 0; iKey < nOrderItems; iKey++ )
     {
         swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
+        OGRFieldDefn *poFDefn = GetOrderByFieldDefn( psKeyDef );
 
-        if ( psKeyDef->field_index >= iFIDFieldIndex )
+        if ( poFDefn == nullptr )
         {
             CPLAssert( psKeyDef->field_index <
                                     iFIDFieldIndex + SPECIAL_FIELD_COUNT );
@@ -1807,9 +3994,6 @@ void OGRGenSQLResultsLayer::FreeIndexFields(OGRField *pasIndexFields,
             continue;
         }
 
-        OGRFieldDefn *poFDefn =
-            poSrcLayer->GetLayerDefn()->GetFieldDefn( psKeyDef->field_index );
-
         if( poFDefn->GetType() == OFTString )
         {
             for( size_t i = 0; i < l_nIndexSize; i++ )
@@ -1840,8 +4024,9 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
     {
         const swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
         OGRField *psDstField = pasIndexFields + iKey;
+        OGRFieldDefn *poFDefn = GetOrderByFieldDefn( psKeyDef );
 
-        if ( psKeyDef->field_index >= iFIDFieldIndex)
+        if ( poFDefn == nullptr )
         {
             CPLAssert( psKeyDef->field_index <
                                 iFIDFieldIndex + SPECIAL_FIELD_COUNT );
@@ -1873,9 +4058,6 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
             continue;
         }
 
-        OGRFieldDefn *poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
-            psKeyDef->field_index );
-
         OGRField *psSrcField =
             poSrcFeat->GetRawFieldRef( psKeyDef->field_index );
 
@@ -1899,18 +4081,15 @@ void OGRGenSQLResultsLayer::ReadIndexFields( OGRFeature* poSrcFeat,
 /************************************************************************/
 /*                         CreateOrderByIndex()                         */
 /*                                                                      */
-/*      This method is responsible for creating an index providing      */
-/*      ordered access to the features according to the supplied        */
-/*      ORDER BY clauses.                                               */
+/*      This method is responsible for sorting the result rows          */
+/*      according to the supplied ORDER BY clauses.                     */
 /*                                                                      */
 /*      This is accomplished by making one pass through all the         */
 /*      eligible source features, and capturing the order by fields     */
-/*      of all records in memory.  A quick sort is then applied to      */
-/*      this in memory copy of the order-by fields to create the        */
-/*      required index.                                                 */
-/*                                                                      */
-/*      Keeping all the key values in memory will *not* scale up to     */
-/*      very large input datasets.                                      */
+/*      with the translated row of each of them.  The rows are kept     */
+/*      in memory up to OGR_SQL_MAX_MEMORY, and then written by sorted  */
+/*      runs to a temporary file.  The runs are merged while the rows   */
+/*      are read back, so the source layer is never read randomly.      */
 /************************************************************************/
 
 void OGRGenSQLResultsLayer::CreateOrderByIndex()
@@ -1919,6 +4098,13 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
     swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
     const int nOrderItems = psSelectInfo->order_specs;
 
+    if( psSelectInfo->query_mode == SWQM_GROUPED_RECORDSET )
+    {
+        if( !bOrderByValid )
+            CreateGroups();
+        return;
+    }
+
     if( ! (psSelectInfo->order_specs > 0
            && psSelectInfo->query_mode == SWQM_RECORDSET
            && nOrderItems != 0 ) )
@@ -1931,16 +4117,17 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
 
     ResetReading();
 
+    m_poSortedRows = new OGRGenSQLSortedRows( this, poDefn );
+
 /* -------------------------------------------------------------------- */
 /*      Optimize (memory-wise) ORDER BY ... LIMIT 1 [OFFSET 0] case.    */
 /* -------------------------------------------------------------------- */
     if( psSelectInfo->offset == 0 && psSelectInfo->limit == 1 )
     {
-        OGRFeature* poSrcFeat = poSrcLayer->GetNextFeature();
-        if( poSrcFeat == nullptr )
+        OGRFeature* poBestFeat = poSrcLayer->GetNextFeature();
+        if( poBestFeat == nullptr )
         {
-            panFIDIndex = nullptr;
-            nIndexSize = 0;
+            m_poSortedRows->Finish();
             return;
         }
 
@@ -1948,15 +4135,14 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
                                     CPLCalloc(sizeof(OGRField), nOrderItems));
         OGRField *pasBestFields = static_cast<OGRField *>(
                                     CPLCalloc(sizeof(OGRField), nOrderItems));
-        GIntBig nBestFID = poSrcFeat->GetFID();
-        ReadIndexFields( poSrcFeat, nOrderItems, pasBestFields);
-        delete poSrcFeat;
+        ReadIndexFields( poBestFeat, nOrderItems, pasBestFields);
+        OGRFeature* poSrcFeat = nullptr;
         while( (poSrcFeat = poSrcLayer->GetNextFeature()) != nullptr )
         {
             ReadIndexFields( poSrcFeat, nOrderItems, pasCurrentFields);
             if( Compare( pasCurrentFields, pasBestFields ) < 0 )
             {
-                nBestFID = poSrcFeat->GetFID();
+                std::swap( poBestFeat, poSrcFeat );
                 FreeIndexFields( pasBestFields, 1, false);
                 memcpy( pasBestFields, pasCurrentFields,
                         sizeof(OGRField) * nOrderItems );
@@ -1970,217 +4156,86 @@ void OGRGenSQLResultsLayer::CreateOrderByIndex()
         }
         VSIFree( pasCurrentFields );
         FreeIndexFields( pasBestFields, 1 );
-        panFIDIndex = static_cast<GIntBig *>(CPLMalloc(sizeof(GIntBig)));
-        panFIDIndex[0] = nBestFID;
-        nIndexSize = 1;
-        return;
-    }
-
-/* -------------------------------------------------------------------- */
-/*      Allocate set of key values, and the output index.               */
-/* -------------------------------------------------------------------- */
-    size_t nFeaturesAlloc = 100;
-
-    panFIDIndex = nullptr;
-    OGRField *pasIndexFields = static_cast<OGRField *>(
-        CPLCalloc(sizeof(OGRField), nOrderItems * nFeaturesAlloc));
-    GIntBig *panFIDList = static_cast<GIntBig *>(
-        CPLMalloc(sizeof(GIntBig) * nFeaturesAlloc));
-
-/* -------------------------------------------------------------------- */
-/*      Read in all the key values.                                     */
-/* -------------------------------------------------------------------- */
-    OGRFeature *poSrcFeat = nullptr;
-    nIndexSize = 0;
 
-    while( (poSrcFeat = poSrcLayer->GetNextFeature()) != nullptr )
-    {
-        if (nIndexSize == nFeaturesAlloc)
+        OGRFeature *poRow = TranslateFeature( poBestFeat );
+        const bool bOK = m_poSortedRows->Add( poBestFeat, poRow ) &&
+                         m_poSortedRows->Finish();
+        delete poRow;
+        delete poBestFeat;
+        if( !bOK )
         {
-            GUIntBig nNewFeaturesAlloc = static_cast<GUIntBig>(nFeaturesAlloc)
-                                                        + nFeaturesAlloc / 3;
-            if( static_cast<size_t>(nNewFeaturesAlloc) != nNewFeaturesAlloc ||
-                static_cast<size_t>(sizeof(OGRField) * nOrderItems *
-                                    nNewFeaturesAlloc) !=
-                static_cast<GUIntBig>(sizeof(OGRField)) * nOrderItems *
-                nNewFeaturesAlloc )
-            {
-                CPLError(CE_Failure, CPLE_AppDefined,
-                         "Cannot allocate pasIndexFields");
-                FreeIndexFields( pasIndexFields, nIndexSize );
-                VSIFree(panFIDList);
-                nIndexSize = 0;
-                delete poSrcFeat;
-                return;
-            }
-            OGRField* pasNewIndexFields = static_cast<OGRField *>(
-                VSI_REALLOC_VERBOSE(pasIndexFields,
-                           sizeof(OGRField) * nOrderItems *
-                           static_cast<size_t>(nNewFeaturesAlloc)));
-            if (pasNewIndexFields == nullptr)
-            {
-                CPLError(CE_Failure, CPLE_AppDefined,
-                         "Cannot allocate pasIndexFields");
-                FreeIndexFields( pasIndexFields, nIndexSize );
-                VSIFree(panFIDList);
-                nIndexSize = 0;
-                delete poSrcFeat;
-                return;
-            }
-            pasIndexFields = pasNewIndexFields;
-
-            GIntBig* panNewFIDList = static_cast<GIntBig *>(
-                VSI_REALLOC_VERBOSE(panFIDList, sizeof(GIntBig) *
-                                    static_cast<size_t>(nNewFeaturesAlloc)));
-            if (panNewFIDList == nullptr)
-            {
-                FreeIndexFields( pasIndexFields, nIndexSize );
-                VSIFree(panFIDList);
-                nIndexSize = 0;
-                delete poSrcFeat;
-                return;
-            }
-            panFIDList = panNewFIDList;
-
-            memset(pasIndexFields + nFeaturesAlloc, 0,
-                   sizeof(OGRField) * nOrderItems *
-                   static_cast<size_t>(nNewFeaturesAlloc - nFeaturesAlloc));
-
-            nFeaturesAlloc = static_cast<size_t>(nNewFeaturesAlloc);
+            InvalidateOrderByIndex();
+            bOrderByValid = TRUE;
         }
-
-        ReadIndexFields( poSrcFeat, nOrderItems,
-                         pasIndexFields + nIndexSize * nOrderItems );
-
-        panFIDList[nIndexSize] = poSrcFeat->GetFID();
-        delete poSrcFeat;
-
-        nIndexSize++;
-    }
-
-    //CPLDebug("GenSQL", "CreateOrderByIndex() = %d features", nIndexSize);
-
-/* -------------------------------------------------------------------- */
-/*      Initialize panFIDIndex                                          */
-/* -------------------------------------------------------------------- */
-    panFIDIndex = static_cast<GIntBig *>(
-        VSI_MALLOC_VERBOSE(sizeof(GIntBig) * nIndexSize));
-    if( panFIDIndex == nullptr )
-    {
-        FreeIndexFields( pasIndexFields, nIndexSize );
-        VSIFree(panFIDList);
-        nIndexSize = 0;
+        ResetReading();
         return;
     }
-    for( size_t i = 0; i < nIndexSize; i++ )
-        panFIDIndex[i] = static_cast<GIntBig>(i);
 
 /* -------------------------------------------------------------------- */
-/*      Quick sort the records.                                         */
+/*      Read in all the key values and rows, and sort them.             */
 /* -------------------------------------------------------------------- */
+    OGRFeature *poSrcFeat = nullptr;
+    bool bOK = true;
 
-    GIntBig *panMerged = static_cast<GIntBig *>(
-        VSI_MALLOC_VERBOSE( sizeof(GIntBig) * nIndexSize ));
-    if( panMerged == nullptr )
+    while( bOK && (poSrcFeat = poSrcLayer->GetNextFeature()) != nullptr )
     {
-        FreeIndexFields( pasIndexFields, nIndexSize );
-        VSIFree(panFIDList);
-        nIndexSize = 0;
-        VSIFree(panFIDIndex);
-        panFIDIndex = nullptr;
-        return;
+        OGRFeature *poRow = TranslateFeature( poSrcFeat );
+        bOK = m_poSortedRows->Add( poSrcFeat, poRow );
+        delete poRow;
+        delete poSrcFeat;
     }
 
-    SortIndexSection( pasIndexFields, panMerged, 0, nIndexSize );
-    VSIFree( panMerged );
-
-/* -------------------------------------------------------------------- */
-/*      Rework the FID map to map to real FIDs.                         */
-/* -------------------------------------------------------------------- */
-    bool bAlreadySorted = true;
-    for( size_t i = 0; i < nIndexSize; i++ )
+    if( !bOK || !m_poSortedRows->Finish() )
     {
-        if (panFIDIndex[i] != static_cast<GIntBig>(i))
-            bAlreadySorted = false;
-        panFIDIndex[i] = panFIDList[panFIDIndex[i]];
+        // Fall back to unsorted reading, as when the index could not be
+        // allocated.
+        InvalidateOrderByIndex();
+        bOrderByValid = TRUE;
     }
 
-    CPLFree( panFIDList );
-    FreeIndexFields( pasIndexFields, nIndexSize );
-
-    /* If it is already sorted, then free than panFIDIndex array */
-    /* so that GetNextFeature() can call a sequential GetNextFeature() */
-    /* on the source array. Very useful for layers where random access */
-    /* is slow. */
-    /* Use case: the GML result of a WFS GetFeature with a SORTBY */
-    if (bAlreadySorted)
-    {
-        CPLFree( panFIDIndex );
-        panFIDIndex = nullptr;
-
-        nIndexSize = 0;
-    }
+    CPLDebug( "GenSQL", "CreateOrderByIndex() = " CPL_FRMT_GIB " features",
+              m_poSortedRows ? m_poSortedRows->GetCount() : 0 );
 
     ResetReading();
 }
 
 /************************************************************************/
-/*                          SortIndexSection()                          */
+/*                            CreateGroups()                            */
 /*                                                                      */
-/*      Sort the records in a section of the index.                     */
+/*      Aggregate the source features of a GROUP BY query, in a single  */
+/*      pass, into result rows that are then read as those of an ORDER  */
+/*      BY query, sorted if there is an ORDER BY clause.                */
 /************************************************************************/
 
-void OGRGenSQLResultsLayer::SortIndexSection( const OGRField *pasIndexFields,
-                                              GIntBig *panMerged,
-                                              size_t nStart, size_t nEntries )
+void OGRGenSQLResultsLayer::CreateGroups()
 
 {
-    if( nEntries < 2 )
-        return;
+    bOrderByValid = TRUE;
 
-    swq_select *psSelectInfo = static_cast<swq_select*>(pSelectInfo);
-    const int   nOrderItems = psSelectInfo->order_specs;
+    m_poSortedRows = new OGRGenSQLSortedRows( this, poDefn );
 
-    size_t nFirstGroup = nEntries / 2;
-    size_t nFirstStart = nStart;
-    size_t nSecondGroup = nEntries - nFirstGroup;
-    size_t nSecondStart = nStart + nFirstGroup;
+    ApplyFiltersToSource();
 
-    SortIndexSection( pasIndexFields, panMerged, nFirstStart,
-                      nFirstGroup );
-    SortIndexSection( pasIndexFields, panMerged, nSecondStart,
-                      nSecondGroup );
+    int bSaveIsGeomIgnored = poSrcLayer->GetLayerDefn()->IsGeometryIgnored();
+    if( !IsSourceGeometryNeeded() )
+        poSrcLayer->GetLayerDefn()->SetGeometryIgnored(TRUE);
 
-    for( size_t iMerge = 0; iMerge < nEntries; ++iMerge )
-    {
-        int  nResult = 0;
+    OGRGenSQLGroupBy oGroupBy( this, m_poSortedRows );
+    const bool bOK = oGroupBy.Run() && m_poSortedRows->Finish();
 
-        if( nFirstGroup == 0 )
-            nResult = 1;
-        else if( nSecondGroup == 0 )
-            nResult = -1;
-        else
-            nResult = Compare( pasIndexFields
-                               + panFIDIndex[nFirstStart] * nOrderItems,
-                               pasIndexFields
-                               + panFIDIndex[nSecondStart] * nOrderItems );
+    poSrcLayer->GetLayerDefn()->SetGeometryIgnored(bSaveIsGeomIgnored);
+    ClearFilters();
 
-        if( nResult > 0 )
-        {
-            panMerged[iMerge] = panFIDIndex[nSecondStart];
-            nSecondStart++;
-            nSecondGroup--;
-        }
-        else
-        {
-            panMerged[iMerge] = panFIDIndex[nFirstStart];
-            nFirstStart++;
-            nFirstGroup--;
-        }
+    if( !bOK )
+    {
+        InvalidateOrderByIndex();
+        bOrderByValid = TRUE;
     }
 
-    /* Copy the merge list back into the main index */
-    memcpy( panFIDIndex + nStart, panMerged, sizeof(GIntBig) * nEntries );
+    CPLDebug( "GenSQL", "CreateGroups() = " CPL_FRMT_GIB " groups",
+              m_poSortedRows ? m_poSortedRows->GetCount() : 0 );
+
+    ResetReading();
 }
 
 /************************************************************************/
@@ -2210,13 +4265,7 @@ int OGRGenSQLResultsLayer::Compare( const OGRField *pasFirstTuple,
     for( iKey = 0; nResult == 0 && iKey < psSelectInfo->order_specs; iKey++ )
     {
         swq_order_def *psKeyDef = psSelectInfo->order_defs + iKey;
-        OGRFieldDefn *poFDefn = nullptr;
-
-        if( psKeyDef->field_index >= iFIDFieldIndex )
-            poFDefn = nullptr;
-        else
-            poFDefn = poSrcLayer->GetLayerDefn()->GetFieldDefn(
-                psKeyDef->field_index );
+        OGRFieldDefn *poFDefn = GetOrderByFieldDefn( psKeyDef );
 
         if( OGR_RawField_IsUnset(&pasFirstTuple[iKey]) ||
             OGR_RawField_IsNull(&pasFirstTuple[iKey]) )
@@ -2363,6 +4412,12 @@ void OGRGenSQLResultsLayer::FindAndSetIgnoredFields()
         ExploreExprForIgnoredFields(psJoinDef->poExpr, hSet);
     }
 
+    for( int iGroup = 0; iGroup < psSelectInfo->group_specs; iGroup++ )
+    {
+        swq_group_def *psGroupDef = psSelectInfo->group_defs + iGroup;
+        AddFieldDefnToSet(psGroupDef->table_index, psGroupDef->field_index, hSet);
+    }
+
     for( int iOrder = 0; iOrder < psSelectInfo->order_specs; iOrder++ )
     {
         swq_order_def *psOrderDef = psSelectInfo->order_defs + iOrder;
@@ -2402,10 +4457,9 @@ void OGRGenSQLResultsLayer::FindAndSetIgnoredFields()
 
 void OGRGenSQLResultsLayer::InvalidateOrderByIndex()
 {
-    CPLFree( panFIDIndex );
-    panFIDIndex = nullptr;
+    delete m_poSortedRows;
+    m_poSortedRows = nullptr;
 
-    nIndexSize = 0;
     bOrderByValid = FALSE;
 }
 
@@ -35,6 +35,7 @@
 #include "swq.h"
 #include "cpl_hash_set.h"
 #include "cpl_string.h"
+#include "cpl_vsi.h"
 
 #include <vector>
 
@@ -50,12 +51,52 @@
 #define ALL_FIELD_INDEX_TO_GEOM_FIELD_INDEX(poFDefn, idx) \
     ((idx) - ((poFDefn)->GetFieldCount() + SPECIAL_FIELD_COUNT))
 
+/************************************************************************/
+/*                        OGRGenSQLFeatureStore                         */
+/*                                                                      */
+/*      Append-only store of serialized features, kept in memory up to  */
+/*      a limit, and then spilled to a temporary file.                  */
+/************************************************************************/
+
+class OGRGenSQLFeatureStore
+{
+    GIntBig             m_nMaxMemory;
+
+    // Records after m_nFileSize, not yet written to the file.
+    std::vector<GByte>  m_abyBuffer;
+
+    VSILFILE           *m_fp;
+    CPLString           m_osFilename;
+    vsi_l_offset        m_nFileSize;
+
+    std::vector<GByte>  m_abyReadBuffer;
+
+    bool                Spill();
+
+    CPL_DISALLOW_COPY_ASSIGN(OGRGenSQLFeatureStore)
+
+  public:
+    explicit            OGRGenSQLFeatureStore( GIntBig nMaxMemory );
+                        ~OGRGenSQLFeatureStore();
+
+    bool                Add( const OGRFeature *poFeature,
+                             vsi_l_offset *pnOffset );
+    OGRFeature         *Get( OGRFeatureDefn *poDefn, vsi_l_offset nOffset );
+};
+
+class OGRGenSQLJoinIndex;
+class OGRGenSQLSortedRows;
+class OGRGenSQLGroupBy;
+
 /************************************************************************/
 /*                        OGRGenSQLResultsLayer                         */
 /************************************************************************/
 
 class OGRGenSQLResultsLayer final: public OGRLayer
 {
+    friend class OGRGenSQLSortedRows;
+    friend class OGRGenSQLGroupBy;
+
   private:
     GDALDataset *poSrcDS;
     OGRLayer    *poSrcLayer;
@@ -69,8 +110,8 @@ class OGRGenSQLResultsLayer final: public OGRLayer
 
     int        *panGeomFieldToSrcGeomField;
 
-    size_t      nIndexSize;
-    GIntBig    *panFIDIndex;
+    // Rows of an ORDER BY query, once sorted, or of a GROUP BY query.
+    OGRGenSQLSortedRows *m_poSortedRows;
     int         bOrderByValid;
 
     GIntBig      nNextIndexFID;
@@ -84,16 +125,22 @@ class OGRGenSQLResultsLayer final: public OGRLayer
     GIntBig     nIteratedFeatures;
     std::vector<CPLString> m_oDistinctList;
 
+    // Hash tables of the secondary layers, or nullptr for the joins
+    // evaluated with attribute filters.
+    bool        m_bJoinIndexesPrepared;
+    std::vector<OGRGenSQLJoinIndex*> m_apoJoinIndexes;
+
     int         PrepareSummary();
+    int         IsSourceGeometryNeeded();
 
+    void        PrepareJoinIndexes();
     OGRFeature *TranslateFeature( OGRFeature * );
     void        CreateOrderByIndex();
+    void        CreateGroups();
+    OGRFieldDefn *GetOrderByFieldDefn( const swq_order_def *psKeyDef );
     void        ReadIndexFields( OGRFeature* poSrcFeat,
                                  int nOrderItems,
                                  OGRField *pasIndexFields );
-    void        SortIndexSection( const OGRField *pasIndexFields,
-                                  GIntBig *panMerged,
-                                  size_t nStart, size_t nEntries );
     void        FreeIndexFields(OGRField *pasIndexFields,
                                 size_t l_nIndexSize,
                                 bool bFreeArray = true);
@@ -2252,6 +2252,7 @@ OGRLayer * OGRWFSDataSource::ExecuteSQL( const char *pszSQLCommand,
             psSelectInfo->table_defs[0].data_source == nullptr &&
             (iLayer = GetLayerIndex( psSelectInfo->table_defs[0].table_name )) >= 0 &&
             psSelectInfo->join_count == 0 &&
+            psSelectInfo->group_specs == 0 &&
             psSelectInfo->order_specs > 0 &&
             psSelectInfo->poOtherSelect == nullptr )
         {
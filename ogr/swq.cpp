@@ -66,6 +66,24 @@ void swqerror( swq_parse_context *context, const char *msg )
     CPLError( CE_Failure, CPLE_AppDefined, "%s", osMsg.c_str() );
 }
 
+/************************************************************************/
+/*                          swq_is_next_word()                          */
+/*                                                                      */
+/*      Check if the next word of the input is pszWord.                 */
+/************************************************************************/
+
+static bool swq_is_next_word( const char *pszNext, const char *pszWord )
+{
+    while( *pszNext == ' ' || *pszNext == '\t'
+           || *pszNext == 10 || *pszNext == 13 )
+        pszNext++;
+
+    const size_t nLen = strlen(pszWord);
+    return EQUALN(pszNext, pszWord, nLen) &&
+           !isalnum( pszNext[nLen] ) && pszNext[nLen] != '_' &&
+           static_cast<unsigned char>(pszNext[nLen]) <= 127;
+}
+
 /************************************************************************/
 /*                               swqlex()                               */
 /*                                                                      */
@@ -266,6 +284,10 @@ int swqlex( YYSTYPE *ppNode, swq_parse_context *context )
             nReturn = SWQT_ON;
         else if( EQUAL(osToken, "ORDER") )
             nReturn = SWQT_ORDER;
+        // GROUP is only a keyword in GROUP BY, so that it remains usable
+        // as a field name, for example in "group = 1".
+        else if( EQUAL(osToken, "GROUP") && swq_is_next_word(pszNext, "BY") )
+            nReturn = SWQT_GROUP;
         else if( EQUAL(osToken, "BY") )
             nReturn = SWQT_BY;
         else if( EQUAL(osToken, "FROM") )
@@ -265,6 +265,7 @@ const char*    SWQFieldTypeToString( swq_field_type field_type );
 #define SWQM_SUMMARY_RECORD  1
 #define SWQM_RECORDSET       2
 #define SWQM_DISTINCT_LIST   3
+#define SWQM_GROUPED_RECORDSET 4
 
 typedef enum {
     SWQCF_NONE = 0,
@@ -327,6 +328,13 @@ typedef struct {
     int   ascending_flag;
 } swq_order_def;
 
+typedef struct {
+    char *table_name;
+    char *field_name;
+    int   table_index;
+    int   field_index;
+} swq_group_def;
+
 typedef struct {
     int        secondary_table;
     swq_expr_node  *poExpr;
@@ -353,6 +361,10 @@ public:
 class swq_select
 {
     void        postpreparse();
+    int         IsGroupedColumn( int table_index, int field_index );
+    int         IsGroupedExpr( swq_expr_node *expr );
+    int         IdentifyGroupedOrderBy( swq_order_def *def,
+                                        swq_field_list *field_list );
 
 public:
     swq_select();
@@ -380,6 +392,10 @@ public:
 
     swq_expr_node *where_expr;
 
+    void        PushGroupBy( const char* pszTableName, const char *pszFieldName );
+    int         group_specs;
+    swq_group_def *group_defs;
+
     void        PushOrderBy( const char* pszTableName, const char *pszFieldName, int bAscending );
     int         order_specs;
     swq_order_def *order_defs;
@@ -62,24 +62,25 @@ extern int swqdebug;
     SWQT_WHERE = 271,
     SWQT_ON = 272,
     SWQT_ORDER = 273,
-    SWQT_BY = 274,
-    SWQT_FROM = 275,
-    SWQT_AS = 276,
-    SWQT_ASC = 277,
-    SWQT_DESC = 278,
-    SWQT_DISTINCT = 279,
-    SWQT_CAST = 280,
-    SWQT_UNION = 281,
-    SWQT_ALL = 282,
-    SWQT_LIMIT = 283,
-    SWQT_OFFSET = 284,
-    SWQT_VALUE_START = 285,
-    SWQT_SELECT_START = 286,
-    SWQT_NOT = 287,
-    SWQT_OR = 288,
-    SWQT_AND = 289,
-    SWQT_UMINUS = 290,
-    SWQT_RESERVED_KEYWORD = 291
+    SWQT_GROUP = 274,
+    SWQT_BY = 275,
+    SWQT_FROM = 276,
+    SWQT_AS = 277,
+    SWQT_ASC = 278,
+    SWQT_DESC = 279,
+    SWQT_DISTINCT = 280,
+    SWQT_CAST = 281,
+    SWQT_UNION = 282,
+    SWQT_ALL = 283,
+    SWQT_LIMIT = 284,
+    SWQT_OFFSET = 285,
+    SWQT_VALUE_START = 286,
+    SWQT_SELECT_START = 287,
+    SWQT_NOT = 288,
+    SWQT_OR = 289,
+    SWQT_AND = 290,
+    SWQT_UMINUS = 291,
+    SWQT_RESERVED_KEYWORD = 292
   };
 #endif
 
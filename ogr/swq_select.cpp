@@ -39,6 +39,7 @@
 #include "cpl_string.h"
 #include "ogr_core.h"
 #include "ogr_geometry.h"
+#include "ogr_p.h"
 #include "swq_parser.hpp"
 
 CPL_CVSID("$Id: swq_select.cpp 971ad299681ca1ea2e1b800e88209f426b77e9aa 2018-04-17 12:14:43 +0200 Even Rouault $")
@@ -58,6 +59,8 @@ swq_select::swq_select() :
     join_count(0),
     join_defs(nullptr),
     where_expr(nullptr),
+    group_specs(0),
+    group_defs(nullptr),
     order_specs(0),
     order_defs(nullptr),
     limit(-1),
@@ -96,6 +99,14 @@ swq_select::~swq_select()
 
     CPLFree( column_defs );
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        CPLFree( group_defs[i].table_name );
+        CPLFree( group_defs[i].field_name );
+    }
+
+    CPLFree( group_defs );
+
     for( int i = 0; i < order_specs; i++ )
     {
         CPLFree( order_defs[i].table_name );
@@ -197,6 +208,8 @@ void swq_select::Dump( FILE *fp )
         fprintf( fp, "  QUERY MODE: RECORDSET\n" );
     else if( query_mode == SWQM_DISTINCT_LIST )
         fprintf( fp, "  QUERY MODE: DISTINCT LIST\n" );
+    else if( query_mode == SWQM_GROUPED_RECORDSET )
+        fprintf( fp, "  QUERY MODE: GROUPED RECORDSET\n" );
     else
         fprintf( fp, "  QUERY MODE: %d/unknown\n", query_mode );
 
@@ -285,6 +298,18 @@ void swq_select::Dump( FILE *fp )
         where_expr->Dump( fp, 2 );
     }
 
+/* -------------------------------------------------------------------- */
+/*      Group by                                                        */
+/* -------------------------------------------------------------------- */
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        fprintf( fp, "  GROUP BY: %s (%d/%d)\n",
+                 group_defs[i].field_name,
+                 group_defs[i].table_index,
+                 group_defs[i].field_index );
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Order by                                                        */
 /* -------------------------------------------------------------------- */
@@ -412,6 +437,19 @@ char* swq_select::Unparse()
         CPLFree(pszTmp);
     }
 
+    for( int i = 0; i < group_specs; i++ )
+    {
+        osSelect += (i == 0) ? " GROUP BY " : ", ";
+        if( group_defs[i].table_name[0] != '\0' )
+        {
+            osSelect += swq_expr_node::QuoteIfNecessary(
+                group_defs[i].table_name, '"');
+            osSelect += ".";
+        }
+        osSelect +=
+            swq_expr_node::QuoteIfNecessary(group_defs[i].field_name, '"');
+    }
+
     for( int i = 0; i < order_specs; i++ )
     {
         osSelect += " ORDER BY ";
@@ -740,6 +778,25 @@ int swq_select::PushTableDef( const char *pszDataSource,
     return table_count-1;
 }
 
+/************************************************************************/
+/*                            PushGroupBy()                             */
+/************************************************************************/
+
+void swq_select::PushGroupBy( const char* pszTableName,
+                              const char *pszFieldName )
+
+{
+    group_specs++;
+    group_defs = static_cast<swq_group_def *>(
+        CPLRealloc(group_defs, sizeof(swq_group_def) * group_specs));
+
+    group_defs[group_specs-1].table_name =
+        CPLStrdup(pszTableName ? pszTableName : "");
+    group_defs[group_specs-1].field_name = CPLStrdup(pszFieldName);
+    group_defs[group_specs-1].table_index = -1;
+    group_defs[group_specs-1].field_index = -1;
+}
+
 /************************************************************************/
 /*                            PushOrderBy()                             */
 /************************************************************************/
@@ -1035,6 +1092,117 @@ static bool CheckCompatibleJoinExpr( swq_expr_node* poExpr,
     return false;
 }
 
+/************************************************************************/
+/*                          IsGroupedColumn()                           */
+/************************************************************************/
+
+int swq_select::IsGroupedColumn( int table_index, int field_index )
+{
+    for( int i = 0; i < group_specs; i++ )
+    {
+        if( group_defs[i].table_index == table_index &&
+            group_defs[i].field_index == field_index )
+            return TRUE;
+    }
+    return FALSE;
+}
+
+/************************************************************************/
+/*                           IsGroupedExpr()                            */
+/*                                                                      */
+/*      Whether an expression only references grouping fields, and so  */
+/*      has a single value in each group.                               */
+/************************************************************************/
+
+int swq_select::IsGroupedExpr( swq_expr_node *expr )
+{
+    if( expr->eNodeType == SNT_COLUMN )
+        return IsGroupedColumn( expr->table_index, expr->field_index );
+
+    if( expr->eNodeType == SNT_OPERATION )
+    {
+        for( int i = 0; i < expr->nSubExprCount; i++ )
+        {
+            if( !IsGroupedExpr( expr->papoSubExpr[i] ) )
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+/************************************************************************/
+/*                      IdentifyGroupedOrderBy()                        */
+/*                                                                      */
+/*      The ORDER BY of a GROUP BY query applies to the result rows,    */
+/*      so its fields are result columns, by alias, aggregate name      */
+/*      (such as COUNT_field) or source field.  field_index is set to   */
+/*      the index of the result column, and table_index to -1.          */
+/************************************************************************/
+
+int swq_select::IdentifyGroupedOrderBy( swq_order_def *def,
+                                        swq_field_list *field_list )
+{
+    int iCol = -1;
+
+    if( def->table_name[0] == '\0' )
+    {
+        for( int i = 0; iCol < 0 && i < result_columns; i++ )
+        {
+            const swq_col_def *col_def = column_defs + i;
+            if( col_def->field_alias != nullptr )
+            {
+                if( EQUAL(col_def->field_alias, def->field_name) )
+                    iCol = i;
+            }
+            else if( col_def->col_func != SWQCF_NONE &&
+                     col_def->col_func != SWQCF_CUSTOM )
+            {
+                const swq_operation *op = swq_op_registrar::GetOperator(
+                    static_cast<swq_op>(col_def->col_func) );
+                if( EQUAL(CPLSPrintf("%s_%s", op->pszName,
+                                     col_def->field_name),
+                          def->field_name) )
+                    iCol = i;
+            }
+        }
+    }
+
+    if( iCol < 0 )
+    {
+        swq_field_type field_type;
+        int table_index = -1;
+        const int field_index =
+            swq_identify_field(def->table_name, def->field_name, field_list,
+                               &field_type, &table_index);
+        for( int i = 0; field_index >= 0 && iCol < 0 && i < result_columns;
+             i++ )
+        {
+            const swq_col_def *col_def = column_defs + i;
+            if( col_def->col_func == SWQCF_NONE &&
+                col_def->expr != nullptr &&
+                col_def->expr->eNodeType == SNT_COLUMN &&
+                col_def->table_index == table_index &&
+                col_def->field_index == field_index )
+                iCol = i;
+        }
+    }
+
+    if( iCol < 0 )
+    {
+        CPLError( CE_Failure, CPLE_AppDefined,
+                  "Field %s in ORDER BY is not a result column of the "
+                  "GROUP BY query.",
+                  def->table_name[0] ?
+                  CPLSPrintf("%s.%s", def->table_name, def->field_name)
+                  : def->field_name );
+        return FALSE;
+    }
+
+    def->table_index = -1;
+    def->field_index = iCol;
+    return TRUE;
+}
+
 /************************************************************************/
 /*                               parse()                                */
 /*                                                                      */
@@ -1116,10 +1284,91 @@ CPLErr swq_select::parse( swq_field_list *field_list,
         }
     }
 
+/* -------------------------------------------------------------------- */
+/*      Process column names in group specs.                            */
+/*                                                                      */
+/*      The special fields (FID, OGR_GEOMETRY, ...) of the main table   */
+/*      are numbered after its attribute fields, from the FID one.      */
+/* -------------------------------------------------------------------- */
+    int nFirstSpecialField = -1;
+    for( int i = 0; group_specs > 0 && i < field_list->count; i++ )
+    {
+        if( (field_list->table_ids == nullptr ||
+             field_list->table_ids[i] == 0) &&
+            EQUAL(field_list->names[i], SpecialFieldNames[SPF_FID]) )
+        {
+            nFirstSpecialField =
+                field_list->ids == nullptr ? i : field_list->ids[i];
+        }
+    }
+
+    for( int i = 0; i < group_specs; i++ )
+    {
+        swq_group_def *def = group_defs + i;
+
+        // Identify field.
+        swq_field_type field_type;
+        def->field_index = swq_identify_field(def->table_name,
+                                              def->field_name, field_list,
+                                              &field_type, &(def->table_index));
+        if( def->field_index == -1 )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Unrecognized field name %s in GROUP BY.",
+                      def->table_name[0] ?
+                      CPLSPrintf("%s.%s", def->table_name, def->field_name)
+                      : def->field_name );
+            return CE_Failure;
+        }
+
+        if( def->table_index != 0 )
+        {
+            CPLError(CE_Failure, CPLE_AppDefined,
+                     "Cannot use field '%s' of a secondary table in "
+                     "a GROUP BY clause",
+                     def->field_name );
+            return CE_Failure;
+        }
+
+        if( field_type == SWQ_GEOMETRY || field_type == SWQ_OTHER )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot use %s field '%s' in a GROUP BY clause",
+                      SWQFieldTypeToString(field_type), def->field_name );
+            return CE_Failure;
+        }
+
+        if( nFirstSpecialField >= 0 &&
+            def->field_index >= nFirstSpecialField &&
+            def->field_index < nFirstSpecialField + SPECIAL_FIELD_COUNT )
+        {
+            CPLError( CE_Failure, CPLE_AppDefined,
+                      "Cannot use special field '%s' in a GROUP BY clause",
+                      def->field_name );
+            return CE_Failure;
+        }
+    }
+
+    if( group_specs > 0 && query_mode == SWQM_DISTINCT_LIST )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "SELECT DISTINCT and GROUP BY not supported together." );
+        return CE_Failure;
+    }
+
+    if( group_specs > 0 && join_count > 0 )
+    {
+        CPLError( CE_Failure, CPLE_NotSupported,
+                  "GROUP BY not supported with JOIN." );
+        return CE_Failure;
+    }
+
 /* -------------------------------------------------------------------- */
 /*      Check if we are producing a one row summary result or a set     */
 /*      of records.  Generate an error if we get conflicting            */
-/*      indications.                                                    */
+/*      indications.  With a GROUP BY clause, we produce one record     */
+/*      per group, and the columns that are not aggregates must be      */
+/*      made of the grouping fields.                                    */
 /* -------------------------------------------------------------------- */
 
     int bAllowDistinctOnMultipleFields = (
@@ -1165,6 +1414,17 @@ CPLErr swq_select::parse( swq_field_list *field_list,
                          "SELECT COUNT DISTINCT on a geometry not supported.");
                 return CE_Failure;
             }
+            if( group_specs > 0 )
+            {
+                if( def->distinct_flag )
+                {
+                    CPLError(CE_Failure, CPLE_NotSupported,
+                             "COUNT(DISTINCT...) not supported with "
+                             "GROUP BY.");
+                    return CE_Failure;
+                }
+                this_indicator = SWQM_GROUPED_RECORDSET;
+            }
         }
         else if( def->col_func == SWQCF_NONE )
         {
@@ -1173,6 +1433,33 @@ CPLErr swq_select::parse( swq_field_list *field_list,
                 def->distinct_flag = TRUE;
                 this_indicator = SWQM_DISTINCT_LIST;
             }
+            else if( group_specs > 0 )
+            {
+                const int bGrouped =
+                    def->expr->eNodeType == SNT_COLUMN ?
+                    IsGroupedColumn( def->table_index, def->field_index ) :
+                    IsGroupedExpr( def->expr );
+                if( !bGrouped )
+                {
+                    CPLError(CE_Failure, CPLE_AppDefined,
+                             "Column %s must appear in the GROUP BY clause "
+                             "or be used in an aggregate function.",
+                             def->field_name[0] ? def->field_name :
+                             CPLSPrintf("%d", i + 1));
+                    return CE_Failure;
+                }
+                if( def->field_type == SWQ_GEOMETRY ||
+                    def->target_type == SWQ_GEOMETRY )
+                {
+                    CPLError(CE_Failure, CPLE_NotSupported,
+                             "Geometry column %s not supported with "
+                             "GROUP BY.",
+                             def->field_name[0] ? def->field_name :
+                             CPLSPrintf("%d", i + 1));
+                    return CE_Failure;
+                }
+                this_indicator = SWQM_GROUPED_RECORDSET;
+            }
             else
                 this_indicator = SWQM_RECORDSET;
         }
@@ -1193,7 +1480,7 @@ CPLErr swq_select::parse( swq_field_list *field_list,
 
     if( result_columns == 0 )
     {
-        query_mode = SWQM_RECORDSET;
+        query_mode = group_specs > 0 ? SWQM_GROUPED_RECORDSET : SWQM_RECORDSET;
     }
 
 /* -------------------------------------------------------------------- */
@@ -1217,6 +1504,13 @@ CPLErr swq_select::parse( swq_field_list *field_list,
     {
         swq_order_def *def = order_defs + i;
 
+        if( query_mode == SWQM_GROUPED_RECORDSET )
+        {
+            if( !IdentifyGroupedOrderBy( def, field_list ) )
+                return CE_Failure;
+            continue;
+        }
+
         // Identify field.
         swq_field_type field_type;
         def->field_index = swq_identify_field(def->table_name,
@@ -37,6 +37,7 @@ CPL_CVSID("$Id: cpl_cpu_features.cpp 540948cdfa0c6eb49a4477cbb3ba076740beec52 20
 #define CPUID_SSSE3_ECX_BIT     9
 #define CPUID_OSXSAVE_ECX_BIT   27
 #define CPUID_AVX_ECX_BIT       28
+#define CPUID_AVX2_EBX_BIT      5
 
 #define CPUID_SSE_EDX_BIT       25
 
@@ -188,4 +189,62 @@ bool CPLHaveRuntimeAVX()
 
 #endif // defined(HAVE_AVX_AT_COMPILE_TIME) && !defined(CPLHaveRuntimeAVX)
 
+#if defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
+/************************************************************************/
+/*                         CPLHaveRuntimeAVX2()                         */
+/************************************************************************/
+
+#if defined(CPL_CPUID)
+
+bool CPLHaveRuntimeAVX2()
+{
+    // AVX2 requires the OS support of the YMM state checked by
+    // CPLHaveRuntimeAVX().
+    if( !CPLHaveRuntimeAVX() )
+        return false;
+
+    int cpuinfo[4] = { 0, 0, 0, 0 };
+    CPL_CPUID(0, cpuinfo);
+    if( cpuinfo[REG_EAX] < 7 )
+        return false;
+
+    // Extended features. Sub-leaf 0 is selected by ECX, which is
+    // normally 0 at this point, but not guaranteed by CPL_CPUID().
+#if defined(__GNUC__)
+    unsigned int nEAX = 7;
+    unsigned int nEBX = 0;
+    unsigned int nECX = 0;
+    unsigned int nEDX = 0;
+#if defined(__x86_64)
+    __asm__ ("xchgq %%rbx, %q1\n"
+             "cpuid\n"
+             "xchgq %%rbx, %q1"
+         : "=a" (nEAX), "=r" (nEBX), "=c" (nECX), "=d" (nEDX)
+         : "0" (nEAX), "2" (nECX));
+#else
+    __asm__ ("xchgl %%ebx, %1\n"
+             "cpuid\n"
+             "xchgl %%ebx, %1"
+         : "=a" (nEAX), "=r" (nEBX), "=c" (nECX), "=d" (nEDX)
+         : "0" (nEAX), "2" (nECX));
+#endif
+    return (nEBX & (1U << CPUID_AVX2_EBX_BIT)) != 0;
+#else
+    __cpuidex(cpuinfo, 7, 0);
+    return (cpuinfo[REG_EBX] & (1 << CPUID_AVX2_EBX_BIT)) != 0;
+#endif
+}
+
+#else
+
+bool CPLHaveRuntimeAVX2()
+{
+    return false;
+}
+
+#endif
+
+#endif // defined(HAVE_AVX2_AT_COMPILE_TIME) && !defined(HAVE_INLINE_AVX2)
+
 //! @endcond
@@ -68,6 +68,15 @@ bool CPLHaveRuntimeAVX();
 #endif
 #endif
 
+#ifdef HAVE_AVX2_AT_COMPILE_TIME
+#if __AVX2__
+#define HAVE_INLINE_AVX2
+static bool inline CPLHaveRuntimeAVX2() { return true; }
+#else
+bool CPLHaveRuntimeAVX2();
+#endif
+#endif
+
 //! @endcond
 
 #endif // CPL_CPU_FEATURES_H
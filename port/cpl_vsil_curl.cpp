@@ -455,6 +455,11 @@ class VSICurlHandle : public VSIVirtualHandle
                                          const size_t* panSizes );
     CPLString    GetRedirectURLIfValid(CachedFileProp* cachedFileProp,
                                                bool& bHasExpired);
+    bool         ReadRangeFromCache( vsi_l_offset nOffset, size_t nSize,
+                                     void* pData );
+    void         AddRangeToCache( vsi_l_offset nOffset, size_t nSize,
+                                  const char* pData,
+                                  int& nRemainingRegions );
 
   protected:
     virtual struct curl_slist* GetCurlHeaders( const CPLString& /*osVerb*/,
@@ -1978,33 +1983,86 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     }
 #endif
 
-    std::vector<CURL*> aHandles;
-    std::vector<WriteFuncStruct> asWriteFuncData;
-    std::vector<WriteFuncStruct> asWriteFuncHeaderData;
-    std::vector<char*> apszRanges;
-    std::vector<struct curl_slist*> aHeaders;
-
-    asWriteFuncData.resize(nRanges);
-    asWriteFuncHeaderData.resize(nRanges);
+/* -------------------------------------------------------------------- */
+/*      Serve the ranges already in the region cache, for example       */
+/*      because a previous multi-range read has populated it.           */
+/* -------------------------------------------------------------------- */
+    std::vector<int> anRangesToFetch;
+    for( int i = 0; i < nRanges; i++ )
+    {
+        if( panSizes[i] == 0 )
+            continue;
+        if( !ReadRangeFromCache(panOffsets[i], panSizes[i], ppData[i]) )
+            anRangesToFetch.push_back(i);
+    }
+    if( anRangesToFetch.empty() )
+        return 0;
 
+/* -------------------------------------------------------------------- */
+/*      Coalesce consecutive ranges, or ranges separated by less than   */
+/*      GDAL_HTTP_MULTIRANGE_MAX_GAP bytes, and issue one GET per       */
+/*      group, all of them in parallel.                                 */
+/* -------------------------------------------------------------------- */
     const bool bMergeConsecutiveRanges = CPLTestBool(CPLGetConfigOption(
         "GDAL_HTTP_MERGE_CONSECUTIVE_RANGES", "TRUE"));
+    vsi_l_offset nMaxGap = 0;
+    if( bMergeConsecutiveRanges )
+    {
+        const char* pszMaxGap =
+            CPLGetConfigOption("GDAL_HTTP_MULTIRANGE_MAX_GAP", "0");
+        const GIntBig nMaxGapOption = CPLAtoGIntBig(pszMaxGap);
+        if( nMaxGapOption < 0 )
+        {
+            CPLError(CE_Warning, CPLE_AppDefined,
+                     "Invalid value for GDAL_HTTP_MULTIRANGE_MAX_GAP: %s. "
+                     "Using 0 instead", pszMaxGap);
+        }
+        else
+        {
+            nMaxGap = static_cast<vsi_l_offset>(nMaxGapOption);
+        }
+    }
 
-    for( int i = 0, iRequest = 0; i < nRanges; )
+    // Indices in anRangesToFetch of the first and last range of each group.
+    std::vector<size_t> anFirstRange;
+    std::vector<size_t> anLastRange;
+    for( size_t i = 0; i < anRangesToFetch.size(); )
     {
-        size_t nSize = 0;
-        int iNext = i;
-        // Identify consecutive ranges
-        while( bMergeConsecutiveRanges &&
-               iNext + 1 < nRanges &&
-               panOffsets[iNext] + panSizes[iNext] == panOffsets[iNext+1] )
+        const int iRange = anRangesToFetch[i];
+        vsi_l_offset nEnd = panOffsets[iRange] + panSizes[iRange];
+        size_t iNext = i;
+        while( bMergeConsecutiveRanges && iNext + 1 < anRangesToFetch.size() )
         {
-            nSize += panSizes[iNext];
+            const int iNextRange = anRangesToFetch[iNext + 1];
+            if( panOffsets[iNextRange] < panOffsets[iRange] ||
+                panOffsets[iNextRange] > nEnd + nMaxGap )
+                break;
+            nEnd = std::max(nEnd,
+                            panOffsets[iNextRange] + panSizes[iNextRange]);
             iNext++;
         }
-        nSize += panSizes[iNext];
-        if( nSize == 0 )
-            continue;
+        anFirstRange.push_back(i);
+        anLastRange.push_back(iNext);
+        i = iNext + 1;
+    }
+
+    const size_t nRequests = anFirstRange.size();
+    std::vector<CURL*> aHandles;
+    std::vector<WriteFuncStruct> asWriteFuncData(nRequests);
+    std::vector<WriteFuncStruct> asWriteFuncHeaderData(nRequests);
+    std::vector<char*> apszRanges;
+    std::vector<struct curl_slist*> aHeaders;
+
+    for( size_t iRequest = 0; iRequest < nRequests; iRequest++ )
+    {
+        vsi_l_offset nStart = panOffsets[anRangesToFetch[anFirstRange[iRequest]]];
+        vsi_l_offset nEnd = nStart;
+        for( size_t i = anFirstRange[iRequest]; i <= anLastRange[iRequest];
+             i++ )
+        {
+            nEnd = std::max(nEnd, panOffsets[anRangesToFetch[i]] +
+                                  panSizes[anRangesToFetch[i]]);
+        }
 
         CURL* hCurlHandle = curl_easy_init();
         aHandles.push_back(hCurlHandle);
@@ -2031,9 +2089,8 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
         curl_easy_setopt(hCurlHandle, CURLOPT_HEADERFUNCTION,
                          VSICurlHandleWriteFunc);
         asWriteFuncHeaderData[iRequest].bIsHTTP = STARTS_WITH(m_pszURL, "http");
-        asWriteFuncHeaderData[iRequest].nStartOffset = panOffsets[i];
-
-        asWriteFuncHeaderData[iRequest].nEndOffset = panOffsets[i] + nSize-1;
+        asWriteFuncHeaderData[iRequest].nStartOffset = nStart;
+        asWriteFuncHeaderData[iRequest].nEndOffset = nEnd - 1;
 
         char rangeStr[512] = {};
         snprintf(rangeStr, sizeof(rangeStr),
@@ -2064,40 +2121,29 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
         curl_easy_setopt(hCurlHandle, CURLOPT_HTTPHEADER, headers);
         aHeaders.push_back(headers);
         curl_multi_add_handle(hMultiHandle, hCurlHandle);
-
-        i = iNext + 1;
-        iRequest ++;
     }
 
-    if( !aHandles.empty() )
-    {
-        MultiPerform(hMultiHandle);
-    }
+    MultiPerform(hMultiHandle);
+
+    // Only use a small part of the region cache, so that a large
+    // ReadMultiRange() does not evict the header/index regions it keeps.
+    int nRemainingRegions = std::max(1, N_MAX_REGIONS / 16);
 
     int nRet = 0;
-    size_t iReq = 0;
-    int iRange = 0;
-    for( ; iReq < aHandles.size(); iReq++, iRange++ )
+    for( size_t iReq = 0; iReq < nRequests; iReq++ )
     {
-        while( iRange < nRanges && panSizes[iRange] == 0 )
-        {
-            iRange ++;
-        }
-        if( iRange == nRanges )
-            break;
+        const vsi_l_offset nStart = asWriteFuncHeaderData[iReq].nStartOffset;
+        const vsi_l_offset nEnd = asWriteFuncHeaderData[iReq].nEndOffset + 1;
 
         long response_code = 0;
         curl_easy_getinfo(aHandles[iReq], CURLINFO_HTTP_CODE, &response_code);
         if( (response_code != 206 && response_code != 225) ||
-            asWriteFuncHeaderData[iReq].nEndOffset+1 !=
-                asWriteFuncHeaderData[iReq].nStartOffset +
-                    asWriteFuncData[iReq].nSize )
+            nEnd != nStart + asWriteFuncData[iReq].nSize )
         {
             char rangeStr[512] = {};
             snprintf(rangeStr, sizeof(rangeStr),
                     CPL_FRMT_GUIB "-" CPL_FRMT_GUIB,
-                    asWriteFuncHeaderData[iReq].nStartOffset,
-                    asWriteFuncHeaderData[iReq].nEndOffset);
+                    nStart, nEnd - 1);
 
             CPLError(CE_Failure, CPLE_AppDefined,
                      "Request for %s failed", rangeStr);
@@ -2105,38 +2151,18 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
         }
         else if( nRet == 0 )
         {
-            size_t nOffset = 0;
-            size_t nRemainingSize = asWriteFuncData[iReq].nSize;
-            CPLAssert( iRange < nRanges );
-            while( true )
+            for( size_t i = anFirstRange[iReq]; i <= anLastRange[iReq]; i++ )
             {
-                if( nRemainingSize < panSizes[iRange] )
-                {
-                    nRet = -1;
-                    break;
-                }
-
-                if( panSizes[iRange] > 0 )
-                {
-                    memcpy( ppData[iRange],
-                            asWriteFuncData[iReq].pBuffer + nOffset,
-                            panSizes[iRange] );
-                }
-
-                if( bMergeConsecutiveRanges &&
-                    iRange + 1 < nRanges &&
-                    panOffsets[iRange] + panSizes[iRange] ==
-                                                    panOffsets[iRange + 1] )
-                {
-                    nOffset += panSizes[iRange];
-                    nRemainingSize -= panSizes[iRange];
-                    iRange++;
-                }
-                else
-                {
-                    break;
-                }
+                const int iRange = anRangesToFetch[i];
+                memcpy( ppData[iRange],
+                        asWriteFuncData[iReq].pBuffer +
+                            (panOffsets[iRange] - nStart),
+                        panSizes[iRange] );
             }
+
+            AddRangeToCache(nStart, asWriteFuncData[iReq].nSize,
+                            asWriteFuncData[iReq].pBuffer,
+                            nRemainingRegions);
         }
 
         curl_multi_remove_handle(hMultiHandle, aHandles[iReq]);
@@ -2154,6 +2180,96 @@ int VSICurlHandle::ReadMultiRange( int const nRanges, void ** const ppData,
     return nRet;
 }
 
+/************************************************************************/
+/*                         ReadRangeFromCache()                         */
+/************************************************************************/
+
+// Fills pData with the nSize bytes at nOffset if they are all in the region
+// cache.
+
+bool VSICurlHandle::ReadRangeFromCache( vsi_l_offset nOffset, size_t nSize,
+                                        void* pData )
+{
+    vsi_l_offset nIterOffset = nOffset;
+    const vsi_l_offset nEnd = nOffset + nSize;
+    while( nIterOffset < nEnd )
+    {
+        const CachedRegion* psRegion = poFS->GetRegion(m_pszURL, nIterOffset);
+        if( psRegion == nullptr || psRegion->pData == nullptr ||
+            psRegion->nFileOffsetStart + psRegion->nSize <= nIterOffset )
+        {
+            return false;
+        }
+        nIterOffset = std::min(nEnd,
+                               psRegion->nFileOffsetStart + psRegion->nSize);
+    }
+
+    nIterOffset = nOffset;
+    while( nIterOffset < nEnd )
+    {
+        // Regions may have been evicted by another thread in the meantime.
+        const CachedRegion* psRegion = poFS->GetRegion(m_pszURL, nIterOffset);
+        if( psRegion == nullptr || psRegion->pData == nullptr ||
+            psRegion->nFileOffsetStart + psRegion->nSize <= nIterOffset )
+        {
+            return false;
+        }
+        const size_t nToCopy = static_cast<size_t>(
+            std::min(nEnd, psRegion->nFileOffsetStart + psRegion->nSize) -
+            nIterOffset);
+        memcpy(static_cast<GByte*>(pData) + (nIterOffset - nOffset),
+               psRegion->pData + (nIterOffset - psRegion->nFileOffsetStart),
+               nToCopy);
+        nIterOffset += nToCopy;
+    }
+    return true;
+}
+
+/************************************************************************/
+/*                          AddRangeToCache()                           */
+/************************************************************************/
+
+// Adds the DOWNLOAD_CHUNK_SIZE aligned regions entirely contained in the
+// downloaded data, or ending at the end of the file, to the region cache,
+// so that later Read() and ReadMultiRange() calls do not fetch them again.
+// Ranges that would need more than nRemainingRegions regions are not
+// cached: they are bulk data, unlikely to be read again, and would push
+// out of the cache the small regions that benefit from it.
+
+void VSICurlHandle::AddRangeToCache( vsi_l_offset nOffset, size_t nSize,
+                                     const char* pData,
+                                     int& nRemainingRegions )
+{
+    CachedFileProp* cachedFileProp = poFS->GetCachedFileProp(m_pszURL);
+    const vsi_l_offset nEnd = nOffset + nSize;
+    vsi_l_offset nChunkOffset =
+        ((nOffset + DOWNLOAD_CHUNK_SIZE - 1) / DOWNLOAD_CHUNK_SIZE) *
+        DOWNLOAD_CHUNK_SIZE;
+    if( nChunkOffset >= nEnd ||
+        (nEnd - nChunkOffset) / DOWNLOAD_CHUNK_SIZE >
+            static_cast<vsi_l_offset>(nRemainingRegions) )
+    {
+        return;
+    }
+    for( ; nChunkOffset < nEnd; nChunkOffset += DOWNLOAD_CHUNK_SIZE )
+    {
+        size_t nChunkSize = DOWNLOAD_CHUNK_SIZE;
+        if( nChunkOffset + nChunkSize > nEnd )
+        {
+            if( !cachedFileProp->bHasComputedFileSize ||
+                nEnd != cachedFileProp->fileSize )
+                break;
+            nChunkSize = static_cast<size_t>(nEnd - nChunkOffset);
+        }
+        if( poFS->GetRegion(m_pszURL, nChunkOffset) == nullptr )
+        {
+            poFS->AddRegion(m_pszURL, nChunkOffset, nChunkSize,
+                            pData + (nChunkOffset - nOffset));
+            nRemainingRegions--;
+        }
+    }
+}
+
 /************************************************************************/
 /*                       ReadMultiRangeSingleGet()                      */
 /************************************************************************/
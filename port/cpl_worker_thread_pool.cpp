@@ -29,8 +29,11 @@
 #include "cpl_port.h"
 #include "cpl_worker_thread_pool.h"
 
+#include <algorithm>
 #include <cstddef>
+#include <cstdlib>
 #include <memory>
+#include <new>
 
 #include "cpl_conv.h"
 #include "cpl_error.h"
@@ -39,6 +42,9 @@
 
 CPL_CVSID("$Id: cpl_worker_thread_pool.cpp 0f654dda9faabf9d86a44293f0f89903a8e97dd7 2018-04-15 20:18:32 +0200 Even Rouault $")
 
+// Upper bound of the number of threads returned by CPLGetNumThreads().
+static const int CPL_MAX_NUM_THREADS = 128;
+
 /************************************************************************/
 /*                         CPLWorkerThreadPool()                        */
 /************************************************************************/
@@ -506,3 +512,64 @@ CPLWorkerThreadPool::GetNextJob( CPLWorkerThread* psWorkerThread )
         //    return psJob;
     }
 }
+
+/************************************************************************/
+/*                          CPLGetNumThreads()                          */
+/************************************************************************/
+
+/** Return the number of worker threads requested by a NUM_THREADS option.
+ *
+ * An invalid value (not a number, or a negative one) emits a warning and
+ * is taken as 1.
+ *
+ * @param pszNumThreads Value of the option: a number of threads, or ALL_CPUS
+ * to use all the CPUs. If NULL, the value of the GDAL_NUM_THREADS
+ * configuration option is used instead, which defaults to 1.
+ * @return the number of threads, between 1 and 128.
+ * @since GDAL 2.4
+ */
+int CPLGetNumThreads( const char* pszNumThreads )
+{
+    if( pszNumThreads == nullptr )
+        pszNumThreads = CPLGetConfigOption("GDAL_NUM_THREADS", "1");
+    const int nThreads = EQUAL(pszNumThreads, "ALL_CPUS") ?
+        CPLGetNumCPUs() : atoi(pszNumThreads);
+    if( nThreads <= 1 &&
+        (nThreads < 0 ||
+         (!EQUAL(pszNumThreads, "0") &&
+          !EQUAL(pszNumThreads, "1") &&
+          !EQUAL(pszNumThreads, "ALL_CPUS"))) )
+    {
+        CPLError(CE_Warning, CPLE_AppDefined,
+                 "Invalid value for NUM_THREADS: %s", pszNumThreads);
+        return 1;
+    }
+    return std::max(1, std::min(nThreads, CPL_MAX_NUM_THREADS));
+}
+
+/************************************************************************/
+/*                      CPLCreateWorkerThreadPool()                     */
+/************************************************************************/
+
+/** Create and setup a pool of worker threads.
+ *
+ * @param nThreads Number of threads to launch.
+ * @return a new pool, to be destroyed with delete, or NULL if nThreads is not
+ * greater than 1, or the pool could not be setup. The caller is then expected
+ * to do the work itself.
+ * @since GDAL 2.4
+ */
+CPLWorkerThreadPool* CPLCreateWorkerThreadPool( int nThreads )
+{
+    if( nThreads <= 1 )
+        return nullptr;
+
+    CPLWorkerThreadPool* poThreadPool = new (std::nothrow) CPLWorkerThreadPool();
+    if( poThreadPool != nullptr &&
+        !poThreadPool->Setup( nThreads, nullptr, nullptr ) )
+    {
+        delete poThreadPool;
+        poThreadPool = nullptr;
+    }
+    return poThreadPool;
+}
@@ -104,4 +104,7 @@ class CPL_DLL CPLWorkerThreadPool
         int GetThreadCount() const { return static_cast<int>(aWT.size()); }
 };
 
+int CPL_DLL CPLGetNumThreads( const char* pszNumThreads );
+CPLWorkerThreadPool CPL_DLL *CPLCreateWorkerThreadPool( int nThreads );
+
 #endif // CPL_WORKER_THREAD_POOL_H_INCLUDED_